@@ -13,6 +13,11 @@ stable firmware ignores serial input). Command grammar:
     expr.set <json>                                     apply expressions section JSON
                                                         (array of entries, or a single
                                                         {"op":...} object)
+    pace.get                                            frame jitter histogram + paced
+                                                        drain costs
+    pace.reset                                          clear pace.get counters
+    metrics.get                                         metrics registry as text
+    metrics.reset                                       new histogram / gauge window
 
 Every command is ACKed on the lamp's serial output as '[cmd] ok ...' or
 '[cmd] err <reason>'.
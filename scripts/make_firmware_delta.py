@@ -0,0 +1,272 @@
+#!/usr/bin/env python3
+"""Build a delta OTA patch between two signed lamp firmware images.
+
+  python3 scripts/make_firmware_delta.py base-signed.bin image-signed.bin \\
+      -o image-from-base.ldlt
+
+Both inputs are firmware-signed.bin outputs of sign_firmware.py (image ||
+96-byte LSIG footer). The patch rebuilds the second image from the first; a
+lamp running the base takes it as a delta OFFER, rebuilds the image into its
+inactive slot and runs the usual LSIG verify over the result, so the patch
+itself carries no signature of its own: the image digest in the trailer is
+the one the OFFER's signature covers.
+
+Patch byte layout (canonical: see
+software/lamp-os/src/components/firmware/ota_delta.hpp):
+
+  ops || trailer(80 B)
+
+  ops: records of zigzag-varint seek, varint copyLen, varint addLen, then
+       addLen literal bytes. seek moves the base cursor, copyLen bytes are
+       copied from the base there, then the literals follow.
+
+  trailer (LE):
+    0   4   magic "LDLT"
+    4   1   format (1)
+    8   4   base firmware version
+    12  4   base image length (with footer)
+    16  4   image version
+    20  4   image length (with footer)
+    24  4   ops length
+    32  16  base LSIG signature, first 16 bytes (the base id)
+    48  32  SHA-256 of the image's signed region
+
+A lamp serves the patch out of its running slot's tail, where the patch ends
+at the slot's end. A lamp updated by delta OTA keeps the patch it got; to seed
+one flashed over USB (which runs app0), write the patch so it ends at app0's
+end: the script also writes <out>.app0 (the patch behind 0xFF padding out to
+a 4 KB sector boundary) and prints the esptool command for it, taken from
+partitions.csv.
+
+The matcher is greedy: it first tries to resume copying at the base cursor
+(the common case after a relinked address or a small edit), then looks up a
+16-byte anchor indexed every 4 base bytes. It runs in a few seconds on a
+1.5 MB image and self-checks the patch by applying it before writing.
+"""
+
+from __future__ import annotations
+
+import argparse
+import hashlib
+import struct
+import sys
+from pathlib import Path
+
+LSIG_FOOTER_LEN = 96
+LSIG_MAGIC = b"LSIG"
+LSIG_CHANNEL_OFFSET = 4
+LSIG_CHANNEL_LEN = 16
+LSIG_VERSION_OFFSET = 20
+LSIG_SIGNED_LEN_OFFSET = 24
+LSIG_SIGNATURE_OFFSET = 32
+
+TRAILER_LEN = 80
+TRAILER_MAGIC = b"LDLT"
+TRAILER_FORMAT = 1
+BASE_ID_LEN = 16
+FLASH_SECTOR = 4096
+
+ANCHOR_LEN = 16     # bytes a fresh match must share
+ANCHOR_STRIDE = 4   # base positions indexed
+RESUME_MIN = 8      # bytes a cursor-resumed copy must share
+
+REPO_ROOT = Path(__file__).resolve().parent.parent
+PARTITIONS_CSV = REPO_ROOT / "software" / "lamp-os" / "partitions.csv"
+
+
+def _fail(msg: str) -> None:
+    print(f"[delta] FATAL: {msg}", file=sys.stderr)
+    sys.exit(1)
+
+
+def _read_footer(image: bytes, name: str) -> dict:
+    if len(image) <= LSIG_FOOTER_LEN:
+        _fail(f"{name} is too short to hold an LSIG footer")
+    footer = image[-LSIG_FOOTER_LEN:]
+    if footer[:4] != LSIG_MAGIC:
+        _fail(f"{name} has no LSIG footer (sign it with sign_firmware.py first)")
+    (signed_len,) = struct.unpack_from("<I", footer, LSIG_SIGNED_LEN_OFFSET)
+    if signed_len != len(image) - LSIG_FOOTER_LEN:
+        _fail(f"{name}: footer signedRegionLen {signed_len} != image length - 96")
+    (version,) = struct.unpack_from("<I", footer, LSIG_VERSION_OFFSET)
+    channel = footer[LSIG_CHANNEL_OFFSET:LSIG_CHANNEL_OFFSET + LSIG_CHANNEL_LEN]
+    return {
+        "version": version,
+        "channel": channel.rstrip(b"\x00").decode("ascii", errors="replace"),
+        "signature": footer[LSIG_SIGNATURE_OFFSET:],
+        "digest": hashlib.sha256(image[:signed_len]).digest(),
+    }
+
+
+def _varint(v: int) -> bytes:
+    out = bytearray()
+    while True:
+        b = v & 0x7F
+        v >>= 7
+        if v:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def _zigzag(v: int) -> int:
+    return (v << 1) if v >= 0 else ((-v << 1) - 1)
+
+
+def _match_len(base: bytes, q: int, new: bytes, p: int) -> int:
+    limit = min(len(base) - q, len(new) - p)
+    if limit <= 0:
+        return 0
+    n = 0
+    step = 256
+    while n + step <= limit and base[q + n:q + n + step] == new[p + n:p + n + step]:
+        n += step
+    while n < limit and base[q + n] == new[p + n]:
+        n += 1
+    return n
+
+
+def build_ops(base: bytes, new: bytes) -> bytes:
+    index: dict[bytes, int] = {}
+    for q in range(0, len(base) - ANCHOR_LEN + 1, ANCHOR_STRIDE):
+        index.setdefault(base[q:q + ANCHOR_LEN], q)
+
+    ops = bytearray()
+    cursor = 0        # base position after the last copy
+    lit_start = 0     # first new byte not yet covered by a record
+    pending = None    # (seek, copy_len) of the record awaiting its literals
+    p = 0
+    n = len(new)
+    while p < n:
+        q = cursor + (p - lit_start)
+        length = _match_len(base, q, new, p) if q < len(base) else 0
+        if length < RESUME_MIN:
+            q = index.get(new[p:p + ANCHOR_LEN], -1)
+            length = _match_len(base, q, new, p) if q >= 0 else 0
+            if length < ANCHOR_LEN:
+                p += 1
+                continue
+        # Grow the match back over literals it can absorb.
+        back = 0
+        while p - back > lit_start and q - back > 0 and new[p - back - 1] == base[q - back - 1]:
+            back += 1
+        start_new, start_base, length = p - back, q - back, length + back
+        if pending is None and start_new > 0:
+            pending = (0, 0)
+        if pending is not None:
+            _emit(ops, pending, new[lit_start:start_new])
+        pending = (start_base - cursor, length)
+        cursor = start_base + length
+        lit_start = p = start_new + length
+    if pending is None:
+        pending = (0, 0)
+    if pending != (0, 0) or lit_start < n:
+        _emit(ops, pending, new[lit_start:n])
+    return bytes(ops)
+
+
+def _emit(ops: bytearray, record: tuple[int, int], literals: bytes) -> None:
+    seek, copy_len = record
+    ops += _varint(_zigzag(seek))
+    ops += _varint(copy_len)
+    ops += _varint(len(literals))
+    ops += literals
+
+
+def apply_ops(base: bytes, ops: bytes, image_len: int) -> bytes:
+    """Reference decoder, same rules as ota_delta::apply."""
+    out = bytearray()
+    pos = 0
+    cursor = 0
+
+    def varint() -> int:
+        nonlocal pos
+        v = 0
+        shift = 0
+        while True:
+            b = ops[pos]
+            pos += 1
+            v |= (b & 0x7F) << shift
+            if not b & 0x80:
+                return v
+            shift += 7
+
+    while len(out) < image_len:
+        zz = varint()
+        seek = (zz >> 1) ^ -(zz & 1)
+        copy_len = varint()
+        add_len = varint()
+        cursor += seek
+        out += base[cursor:cursor + copy_len]
+        cursor += copy_len
+        out += ops[pos:pos + add_len]
+        pos += add_len
+    if pos != len(ops) or len(out) != image_len:
+        raise ValueError("ops do not end with the image")
+    return bytes(out)
+
+
+def build_trailer(base_meta: dict, base_len: int, image_meta: dict,
+                  image_len: int, ops_len: int) -> bytes:
+    t = bytearray(TRAILER_LEN)
+    t[0:4] = TRAILER_MAGIC
+    t[4] = TRAILER_FORMAT
+    struct.pack_into("<IIIII", t, 8, base_meta["version"], base_len,
+                     image_meta["version"], image_len, ops_len)
+    t[32:32 + BASE_ID_LEN] = base_meta["signature"][:BASE_ID_LEN]
+    t[48:80] = image_meta["digest"]
+    return bytes(t)
+
+
+def _app0_end() -> int | None:
+    if not PARTITIONS_CSV.exists():
+        return None
+    for line in PARTITIONS_CSV.read_text().splitlines():
+        cols = [c.strip() for c in line.split(",")]
+        if len(cols) >= 5 and cols[0] == "app0":
+            return int(cols[3], 0) + int(cols[4], 0)
+    return None
+
+
+def main(argv: list[str] | None = None) -> int:
+    ap = argparse.ArgumentParser(
+        description="Build a delta OTA patch between two signed lamp images.")
+    ap.add_argument("base", type=Path, help="signed image the lamps run now")
+    ap.add_argument("image", type=Path, help="signed image to rebuild")
+    ap.add_argument("-o", "--out", type=Path, required=True,
+                    help="patch output path")
+    args = ap.parse_args(argv)
+
+    base = args.base.read_bytes()
+    image = args.image.read_bytes()
+    base_meta = _read_footer(base, str(args.base))
+    image_meta = _read_footer(image, str(args.image))
+    base_type = base_meta["channel"].rsplit("-", 1)[0]
+    image_type = image_meta["channel"].rsplit("-", 1)[0]
+    if base_type != image_type:
+        _fail(f"lamp types differ: {base_meta['channel']!r} vs {image_meta['channel']!r}")
+    if image_meta["version"] <= base_meta["version"]:
+        _fail("the image must be newer than the base")
+
+    ops = build_ops(base, image)
+    if apply_ops(base, ops, len(image)) != image:
+        _fail("self-check failed: patch does not rebuild the image")
+    patch = ops + build_trailer(base_meta, len(base), image_meta, len(image), len(ops))
+    args.out.write_bytes(patch)
+
+    print(f"[delta] {args.out.name}: {len(patch)} bytes rebuilds "
+          f"{len(image)} bytes ({100.0 * len(patch) / len(image):.1f}%), "
+          f"base 0x{base_meta['version']:06x} -> 0x{image_meta['version']:06x}")
+    end = _app0_end()
+    if end is not None:
+        start = (end - len(patch)) // FLASH_SECTOR * FLASH_SECTOR
+        seed = args.out.with_name(args.out.name + ".app0")
+        seed.write_bytes(b"\xff" * (end - len(patch) - start) + patch)
+        print(f"[delta] to seed a USB-flashed lamp (app0): "
+              f"esptool.py write_flash 0x{start:x} {seed}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,13 +0,0 @@
-#pragma once
-// Generated by npm run catalog:gen (scripts/gen_expr_catalog.py). Do not edit.
-// Expression catalog for the loaf build, held in .rodata (flash), served by reference.
-#include <cstddef>
-#include <cstdint>
-
-namespace lamp {
-
-inline constexpr char kExprCatalog[] = "{\"schemaVersion\":1,\"expressions\":[{\"id\":\"glitchy\",\"name\":\"Glitchy\",\"continuous\":false,\"colors\":{\"max\":8,\"label\":\"Colors\"},\"interval\":{\"min\":300,\"max\":18000,\"step\":30,\"unit\":\"s\",\"default\":[1800,7200],\"minGap\":1800,\"help\":\"A random time in this range is picked before each trigger.\"},\"duration\":{\"min\":30,\"max\":1000,\"step\":30,\"unit\":\"ms\",\"default\":[30,120],\"label\":\"Glitch duration\",\"help\":\"Each glitch lasts a random time in this range.\",\"minKey\":\"durationMin\",\"maxKey\":\"durationMax\"},\"zone\":{\"optional\":true},\"params\":[{\"key\":\"scatter\",\"type\":\"int\",\"label\":\"Scatter\",\"min\":0,\"max\":5,\"step\":1,\"default\":0,\"help\":\"0 is a solid glitch; higher scatters it into finer, sparser flecks.\"},{\"key\":\"opacity\",\"type\":\"int\",\"label\":\"Opacity\",\"min\":10,\"max\":100,\"step\":5,\"default\":100,\"unit\":\"%\",\"help\":\"Caps how strong the effect gets at its peak. 100% is full colour.\"}]},{\"id\":\"pulse\",\"name\":\"Pulse\",\"continuous\":false,\"colors\":{\"max\":8,\"label\":\"Colors\"},\"interval\":{\"min\":300,\"max\":18000,\"step\":30,\"unit\":\"s\",\"default\":[300,900],\"help\":\"A random time in this range is picked before each trigger.\"},\"zone\":{\"optional\":true},\"params\":[{\"key\":\"pulseSpeed\",\"type\":\"int\",\"label\":\"Pulse speed\",\"min\":1,\"max\":20,\"step\":1,\"default\":3,\"unit\":\"s\",\"invert\":true,\"leftLabel\":\"slow\",\"rightLabel\":\"fast\",\"help\":\"How fast the wave travels the strip\"},{\"key\":\"size\",\"type\":\"int\",\"label\":\"Size\",\"min\":1,\"max\":10,\"step\":1,\"default\":4,\"leftLabel\":\"small\",\"rightLabel\":\"large\",\"help\":\"How wide the pulse is, small to large\"},{\"key\":\"easing\",\"type\":\"enum\",\"label\":\"Motion\",\"min\":0,\"max\":17,\"step\":1,\"default\":0,\"help\":\"Shape of the motion: Linear steady, Smooth eased ends, Snap fast then coast, Float lava drift, Overshoot blows past and eases back, Spring wobbles in, Bounce hops before it settles, Random rolls a new curve each fire.\",\"options\":[{\"value\":0,\"label\":\"Linear\",\"group\":\"Linear\"},{\"value\":4,\"label\":\"In\",\"group\":\"Smooth\"},{\"value\":3,\"label\":\"Out\",\"group\":\"Smooth\"},{\"value\":1,\"label\":\"In-out\",\"group\":\"Smooth\"},{\"value\":5,\"label\":\"In\",\"group\":\"Snap\"},{\"value\":6,\"label\":\"Out\",\"group\":\"Snap\"},{\"value\":7,\"label\":\"In-out\",\"group\":\"Snap\"},{\"value\":2,\"label\":\"Float\",\"group\":\"Float\"},{\"value\":8,\"label\":\"In\",\"group\":\"Overshoot\"},{\"value\":9,\"label\":\"Out\",\"group\":\"Overshoot\"},{\"value\":10,\"label\":\"In-out\",\"group\":\"Overshoot\"},{\"value\":11,\"label\":\"In\",\"group\":\"Spring\"},{\"value\":12,\"label\":\"Out\",\"group\":\"Spring\"},{\"value\":13,\"label\":\"In-out\",\"group\":\"Spring\"},{\"value\":14,\"label\":\"In\",\"group\":\"Bounce\"},{\"value\":15,\"label\":\"Out\",\"group\":\"Bounce\"},{\"value\":16,\"label\":\"In-out\",\"group\":\"Bounce\"},{\"value\":17,\"label\":\"Random\",\"group\":\"Random\"}]},{\"key\":\"loop\",\"type\":\"enum\",\"label\":\"Loop\",\"min\":0,\"max\":1,\"step\":1,\"default\":0,\"help\":\"Trigger runs one sweep then stops. Continuous ping-pongs back and forth forever.\",\"options\":[{\"value\":0,\"label\":\"Trigger\"},{\"value\":1,\"label\":\"Continuous\"}]},{\"key\":\"opacity\",\"type\":\"int\",\"label\":\"Opacity\",\"min\":10,\"max\":100,\"step\":5,\"default\":100,\"unit\":\"%\",\"help\":\"Caps how strong the effect gets at its peak. 100% is full colour.\"}]},{\"id\":\"breathing\",\"name\":\"Breathing\",\"continuous\":true,\"colors\":{\"max\":8,\"label\":\"Colors\"},\"zone\":{\"optional\":true},\"params\":[{\"key\":\"breathSpeed\",\"type\":\"int\",\"label\":\"Breath cycle length\",\"min\":8,\"max\":60,\"step\":1,\"default\":10,\"unit\":\"s\",\"invert\":true,\"leftLabel\":\"slow\",\"rightLabel\":\"fast\",\"help\":\"How long one full fade in and out takes\"},{\"key\":\"easing\",\"type\":\"enum\",\"label\":\"Motion\",\"min\":0,\"max\":17,\"step\":1,\"default\":1,\"help\":\"Shape of the motion: Linear steady, Smooth eased ends, Snap fast then coast, Float lava drift, Overshoot blows past and eases back, Spring wobbles in, Bounce hops before it settles, Random rolls a new curve each fire.\",\"options\":[{\"value\":0,\"label\":\"Linear\",\"group\":\"Linear\"},{\"value\":4,\"label\":\"In\",\"group\":\"Smooth\"},{\"value\":3,\"label\":\"Out\",\"group\":\"Smooth\"},{\"value\":1,\"label\":\"In-out\",\"group\":\"Smooth\"},{\"value\":5,\"label\":\"In\",\"group\":\"Snap\"},{\"value\":6,\"label\":\"Out\",\"group\":\"Snap\"},{\"value\":7,\"label\":\"In-out\",\"group\":\"Snap\"},{\"value\":2,\"label\":\"Float\",\"group\":\"Float\"},{\"value\":8,\"label\":\"In\",\"group\":\"Overshoot\"},{\"value\":9,\"label\":\"Out\",\"group\":\"Overshoot\"},{\"value\":10,\"label\":\"In-out\",\"group\":\"Overshoot\"},{\"value\":11,\"label\":\"In\",\"group\":\"Spring\"},{\"value\":12,\"label\":\"Out\",\"group\":\"Spring\"},{\"value\":13,\"label\":\"In-out\",\"group\":\"Spring\"},{\"value\":14,\"label\":\"In\",\"group\":\"Bounce\"},{\"value\":15,\"label\":\"Out\",\"group\":\"Bounce\"},{\"value\":16,\"label\":\"In-out\",\"group\":\"Bounce\"},{\"value\":17,\"label\":\"Random\",\"group\":\"Random\"}]},{\"key\":\"opacity\",\"type\":\"int\",\"label\":\"Opacity\",\"min\":10,\"max\":100,\"step\":5,\"default\":100,\"unit\":\"%\",\"help\":\"Caps how strong the effect gets at its peak. 100% is full colour.\"}]},{\"id\":\"shifty\",\"name\":\"Shifty\",\"continuous\":true,\"colors\":{\"max\":8,\"label\":\"Colors\"},\"interval\":{\"min\":300,\"max\":18000,\"step\":30,\"unit\":\"s\",\"default\":[300,900],\"help\":\"A random time in this range is picked before each trigger.\"},\"duration\":{\"min\":60,\"max\":1800,\"step\":30,\"unit\":\"s\",\"default\":[300,600],\"label\":\"Hold time\",\"help\":\"How long each color holds before the next shift (a random time in this range).\",\"minKey\":\"shiftDurationMin\",\"maxKey\":\"shiftDurationMax\"},\"zone\":{\"optional\":true},\"params\":[{\"key\":\"fillMode\",\"type\":\"enum\",\"label\":\"Fill\",\"min\":0,\"max\":3,\"step\":1,\"default\":0,\"help\":\"How the new color spreads: Uniform all at once, Up/Down from one end, Bloom outward from the center.\",\"options\":[{\"value\":0,\"label\":\"Uniform\"},{\"value\":1,\"label\":\"Up\"},{\"value\":2,\"label\":\"Down\"},{\"value\":3,\"label\":\"Bloom\"}]},{\"key\":\"fadeDuration\",\"type\":\"int\",\"label\":\"Fade duration\",\"min\":30,\"max\":600,\"step\":1,\"default\":60,\"unit\":\"s\",\"leftLabel\":\"quick\",\"rightLabel\":\"slow\",\"help\":\"How long each color transition takes\"},{\"key\":\"easing\",\"type\":\"enum\",\"label\":\"Motion\",\"min\":0,\"max\":17,\"step\":1,\"default\":0,\"help\":\"Shape of the motion: Linear steady, Smooth eased ends, Snap fast then coast, Float lava drift, Overshoot blows past and eases back, Spring wobbles in, Bounce hops before it settles, Random rolls a new curve each fire.\",\"options\":[{\"value\":0,\"label\":\"Linear\",\"group\":\"Linear\"},{\"value\":4,\"label\":\"In\",\"group\":\"Smooth\"},{\"value\":3,\"label\":\"Out\",\"group\":\"Smooth\"},{\"value\":1,\"label\":\"In-out\",\"group\":\"Smooth\"},{\"value\":5,\"label\":\"In\",\"group\":\"Snap\"},{\"value\":6,\"label\":\"Out\",\"group\":\"Snap\"},{\"value\":7,\"label\":\"In-out\",\"group\":\"Snap\"},{\"value\":2,\"label\":\"Float\",\"group\":\"Float\"},{\"value\":8,\"label\":\"In\",\"group\":\"Overshoot\"},{\"value\":9,\"label\":\"Out\",\"group\":\"Overshoot\"},{\"value\":10,\"label\":\"In-out\",\"group\":\"Overshoot\"},{\"value\":11,\"label\":\"In\",\"group\":\"Spring\"},{\"value\":12,\"label\":\"Out\",\"group\":\"Spring\"},{\"value\":13,\"label\":\"In-out\",\"group\":\"Spring\"},{\"value\":14,\"label\":\"In\",\"group\":\"Bounce\"},{\"value\":15,\"label\":\"Out\",\"group\":\"Bounce\"},{\"value\":16,\"label\":\"In-out\",\"group\":\"Bounce\"},{\"value\":17,\"label\":\"Random\",\"group\":\"Random\"}]},{\"key\":\"opacity\",\"type\":\"int\",\"label\":\"Opacity\",\"min\":10,\"max\":100,\"step\":5,\"default\":100,\"unit\":\"%\",\"help\":\"Caps how strong the effect gets at its peak. 100% is full colour.\"}]},{\"id\":\"spotty\",\"name\":\"Spotty\",\"continuous\":true,\"colors\":{\"max\":8,\"label\":\"Colors\"},\"zone\":{\"optional\":true},\"params\":[{\"key\":\"count\",\"type\":\"int\",\"label\":\"Points\",\"min\":1,\"max\":{\"rel\":\"pixels\",\"cap\":5},\"step\":1,\"default\":3,\"help\":\"How many spots appear at once\"},{\"key\":\"size\",\"type\":\"int\",\"label\":\"Size\",\"min\":1,\"max\":{\"rel\":\"pixels\",\"cap\":6},\"step\":1,\"default\":3,\"leftLabel\":\"Small\",\"rightLabel\":\"Large\",\"help\":\"Width of each spot\"},{\"key\":\"spotSpeed\",\"type\":\"int\",\"label\":\"Speed\",\"min\":1,\"max\":10,\"step\":1,\"default\":3,\"invert\":true,\"leftLabel\":\"Dreamy\",\"rightLabel\":\"Gentle\",\"help\":\"Gentle: calm fades over a few seconds. Dreamy: slow drifting fades up to tens of seconds.\"},{\"key\":\"easing\",\"type\":\"enum\",\"label\":\"Motion\",\"min\":0,\"max\":17,\"step\":1,\"default\":0,\"help\":\"Shape of the motion: Linear steady, Smooth eased ends, Snap fast then coast, Float lava drift, Overshoot blows past and eases back, Spring wobbles in, Bounce hops before it settles, Random rolls a new curve each fire.\",\"options\":[{\"value\":0,\"label\":\"Linear\",\"group\":\"Linear\"},{\"value\":4,\"label\":\"In\",\"group\":\"Smooth\"},{\"value\":3,\"label\":\"Out\",\"group\":\"Smooth\"},{\"value\":1,\"label\":\"In-out\",\"group\":\"Smooth\"},{\"value\":5,\"label\":\"In\",\"group\":\"Snap\"},{\"value\":6,\"label\":\"Out\",\"group\":\"Snap\"},{\"value\":7,\"label\":\"In-out\",\"group\":\"Snap\"},{\"value\":2,\"label\":\"Float\",\"group\":\"Float\"},{\"value\":8,\"label\":\"In\",\"group\":\"Overshoot\"},{\"value\":9,\"label\":\"Out\",\"group\":\"Overshoot\"},{\"value\":10,\"label\":\"In-out\",\"group\":\"Overshoot\"},{\"value\":11,\"label\":\"In\",\"group\":\"Spring\"},{\"value\":12,\"label\":\"Out\",\"group\":\"Spring\"},{\"value\":13,\"label\":\"In-out\",\"group\":\"Spring\"},{\"value\":14,\"label\":\"In\",\"group\":\"Bounce\"},{\"value\":15,\"label\":\"Out\",\"group\":\"Bounce\"},{\"value\":16,\"label\":\"In-out\",\"group\":\"Bounce\"},{\"value\":17,\"label\":\"Random\",\"group\":\"Random\"}]},{\"key\":\"opacity\",\"type\":\"int\",\"label\":\"Opacity\",\"min\":10,\"max\":100,\"step\":5,\"default\":100,\"unit\":\"%\",\"help\":\"Caps how strong the effect gets at its peak. 100% is full colour.\"}]},{\"id\":\"flicker\",\"name\":\"Shimmer\",\"continuous\":true,\"colors\":{\"max\":0},\"zone\":{\"optional\":true},\"params\":[{\"key\":\"fire\",\"type\":\"enum\",\"label\":\"Style\",\"min\":0,\"max\":3,\"step\":1,\"default\":1,\"help\":\"From sparse Twinkle stars to a lively Campfire blaze.\",\"options\":[{\"value\":0,\"label\":\"Twinkle\"},{\"value\":1,\"label\":\"Coals\"},{\"value\":2,\"label\":\"Candle\"},{\"value\":3,\"label\":\"Campfire\"}]},{\"key\":\"opacity\",\"type\":\"int\",\"label\":\"Opacity\",\"min\":10,\"max\":100,\"step\":5,\"default\":100,\"unit\":\"%\",\"help\":\"Caps how strong the effect gets at its peak. 100% is full colour.\"}]}]}";
-inline constexpr size_t kExprCatalogLen = sizeof(kExprCatalog) - 1;
-inline constexpr uint32_t kExprCatalogHash = 0xa2207d10u;
-
-}  // namespace lamp
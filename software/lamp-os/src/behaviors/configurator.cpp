@@ -7,6 +7,7 @@
 
 #include "util/color.hpp"
 #include "util/fade.hpp"
+#include "util/gradient_cache.hpp"
 
 namespace lamp {
 
@@ -17,6 +18,27 @@ bool ConfiguratorBehavior::fadeActive(uint32_t nowMs) const {
 
 void ConfiguratorBehavior::beginFade(const std::vector<Color>& targetColors,
                                      uint32_t fadeDurationMs) {
+  snapshotFadeFrom();
+  // Assign the target colors. Callers (ColorOverride::apply, the BLE
+  // colors drain) have already done the gradient expansion to pixelCount
+  // length, so this just copies.
+  colors = targetColors;
+  fadeDurationMs_ = fadeDurationMs;
+}
+
+void ConfiguratorBehavior::beginFadeToStops(const Color* stops,
+                                            size_t numStops,
+                                            uint32_t fadeDurationMs) {
+  snapshotFadeFrom();
+  // Expand straight into `colors`; resize only reallocates when the pixel
+  // count changes.
+  const uint8_t n = fb ? fb->pixelCount : 0;
+  colors.resize(n);
+  renderGradient(colors.data(), n, stops, numStops);
+  fadeDurationMs_ = fadeDurationMs;
+}
+
+void ConfiguratorBehavior::snapshotFadeFrom() {
   // Snapshot the fade-FROM endpoint from the configurator's PREVIOUS
   // intended output (the `colors` field, optionally lerped when
   // interrupting a fade in flight), NOT from fb->buffer. fb->buffer
@@ -37,8 +59,11 @@ void ConfiguratorBehavior::beginFade(const std::vector<Color>& targetColors,
   const uint32_t now = millis();
   const bool wasFading = fadeActive(now);
   // Stash the pre-mutation source so the mid-fade branch can read it
-  // without aliasing the destination assignment below.
-  std::vector<Color> prevFromColors = fadeFromColors_;
+  // without aliasing the destination assignment below. A swap, not a copy:
+  // both buffers keep their capacity, so a drag's beginFade per write
+  // doesn't allocate.
+  std::vector<Color>& prevFromColors = fadeFromScratch_;
+  prevFromColors.swap(fadeFromColors_);
   fadeFromColors_.assign(n, Color());
   if (n > 0) {
     if (wasFading && !prevFromColors.empty() && !colors.empty()) {
@@ -71,12 +96,7 @@ void ConfiguratorBehavior::beginFade(const std::vector<Color>& targetColors,
       }
     }
   }
-  // Assign the target colors. Callers (ColorOverride::apply, the BLE
-  // colors drain) have already done the gradient expansion to pixelCount
-  // length, so this just copies.
-  colors = targetColors;
   fadeStartMs_ = now;
-  fadeDurationMs_ = fadeDurationMs;
 }
 
 void ConfiguratorBehavior::setSolid(Color c) {
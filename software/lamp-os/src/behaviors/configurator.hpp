@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -49,6 +50,12 @@ class ConfiguratorBehavior : public AnimatedBehavior {
   void beginFade(const std::vector<Color>& targetColors,
                  uint32_t fadeDurationMs);
 
+  // beginFade to the gradient of `stops` across pixelCount, expanded in
+  // place into `colors` through the gradient cache. The color-write hot
+  // path: no temporary gradient vector per call.
+  void beginFadeToStops(const Color* stops, size_t numStops,
+                        uint32_t fadeDurationMs);
+
   // Non-allocating instant solid fill. Fills `colors` in place (no per-call
   // vector alloc, unlike beginFade) and keeps the configurator playing so
   // draw() writes it. The mood scrub calls this per step; a raw beginFade
@@ -64,11 +71,18 @@ class ConfiguratorBehavior : public AnimatedBehavior {
   bool fadeActive(uint32_t nowMs) const;
 
  private:
+  // beginFade's first half: snapshot the fade-from endpoint and stamp the
+  // start time. The caller then sets `colors` and the duration.
+  void snapshotFadeFrom();
+
   // The buffer snapshot taken at beginFade() time. Allocated once per
   // beginFade(); per-pixel interp in draw() walks it alongside `colors`.
   // Sized to pixelCount on first beginFade() and resized only when the
   // pixel count changes (rare; only on configuration boot).
   std::vector<Color> fadeFromColors_;
+  // The previous fadeFromColors_, swapped in by snapshotFadeFrom() for the
+  // mid-fade lerp. Kept so the swap reuses its capacity.
+  std::vector<Color> fadeFromScratch_;
   uint32_t fadeStartMs_ = 0;
   uint32_t fadeDurationMs_ = 0;
 };
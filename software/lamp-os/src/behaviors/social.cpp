@@ -199,7 +199,9 @@ void SocialBehavior::control() {
   // Two throttles to keep this cheap:
   //   (1) Skip entirely while distributor.isInProgress(); the single-
   //       source mutex blocks concurrent sessions, so scanning during
-  //       OTA finds nothing actionable.
+  //       OTA finds nothing actionable. The exception is a group session
+  //       still gathering: its distributor takes more members, and only
+  //       that distributor is fed.
   //   (2) Throttle the ESP-NOW vector snapshot to kOtaScanIntervalMs,
   //       collapsing the 60 Hz tick rate.
   //
@@ -214,9 +216,11 @@ void SocialBehavior::control() {
   //       this lamp's. This lamp is about to be the receiver, so any
   //       outbound started now is just chunks to re-send under the
   //       new image.
-  if (!firmwareDistributor.isInProgress() &&
+  const bool fwGathering = firmwareDistributor.isGathering();
+  const bool fsGathering = fs_ota::distributorGathering();
+  if ((fwGathering || fsGathering ||
+       (!firmwareDistributor.isInProgress() && !fs_ota::fsPathBusy())) &&
       !::firmwareReceiver.isInProgress() &&
-      !fs_ota::fsPathBusy() &&
       (lastOtaScanMs_ == 0 ||
        static_cast<int32_t>(now - lastOtaScanMs_) >=
            static_cast<int32_t>(kOtaScanIntervalMs))) {
@@ -234,6 +238,7 @@ void SocialBehavior::control() {
     }
     if (!peerHigherSeen) {
       for (const auto& p : espNowPeers) {
+        if (fsGathering) break;
         if (!p.hasMac) continue;
         if (p.firmwareVersion == 0) continue;
         // Don't stomp a transfer another lamp already owns: the peer is
@@ -255,7 +260,8 @@ void SocialBehavior::control() {
         firmwareDistributor.considerPeerForOta(p.mac, p.firmwareVersion,
                                                 p.protocolVersion, now,
                                                 p.fwChannel, p.maxChunk,
-                                                p.espnowRssi, peerBeingServed);
+                                                p.espnowRssi, peerBeingServed,
+                                                p.caps);
       }
       // FS-image OTA: offer the local UI image to same-firmware-version peers
       // whose FS digest differs. fs_ota::considerPeer does the staleness +
@@ -264,7 +270,7 @@ void SocialBehavior::control() {
         if (!p.hasMac) continue;
         fs_ota::considerPeer(p.mac, p.firmwareVersion, p.protocolVersion, now,
                              p.fwChannel, p.fsDigest, p.hasFsDigest, p.needsFs,
-                             p.espnowRssi);
+                             p.espnowRssi, p.caps);
       }
     }
   }
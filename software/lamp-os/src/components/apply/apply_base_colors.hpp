@@ -26,6 +26,7 @@ namespace lamp {
 // (ConfiguratorBehavior beginFade + ColorOverride rebaseline + BLE advert
 // update).
 void renderBaseColors(JsonArray arr);
+void renderBaseColors(const std::vector<Color>& colors);
 
 namespace apply {
 
@@ -50,5 +51,11 @@ inline void baseColorsToRender(JsonArray arr) {
   ::lamp::renderBaseColors(arr);
 }
 
+// Cascade-source variant for already-decoded stops (binary CONTROL_OP).
+inline void baseColorsToRender(const Color* colors, size_t count) {
+  if (!colors || count == 0) return;
+  ::lamp::renderBaseColors(std::vector<Color>(colors, colors + count));
+}
+
 }  // namespace apply
 }  // namespace lamp
@@ -26,6 +26,7 @@ namespace lamp {
 // (ConfiguratorBehavior beginFade + ColorOverride rebaseline + BLE advert
 // update).
 void renderShadeColors(JsonArray arr);
+void renderShadeColors(const std::vector<Color>& colors);
 
 namespace apply {
 
@@ -65,5 +66,11 @@ inline void shadeColorsToRender(JsonArray arr) {
   ::lamp::renderShadeColors(arr);
 }
 
+// Cascade-source variant for already-decoded stops (binary CONTROL_OP).
+inline void shadeColorsToRender(const Color* colors, size_t count) {
+  if (!colors || count == 0) return;
+  ::lamp::renderShadeColors(std::vector<Color>(colors, colors + count));
+}
+
 }  // namespace apply
 }  // namespace lamp
@@ -1,10 +1,14 @@
 #include "firmware_distributor.hpp"
 
 #include <cstring>
+#include <new>
 
 #include "firmware_receiver.hpp"  // FirmwareTransport interface
 #include "firmware_signature.hpp"  // kLsigFooterLen
 #include "ota_channel.hpp"
+#include "ota_delta.hpp"
+#include "ota_fec.hpp"
+#include "ota_pack.hpp"
 #include "components/network/ble/ble_control.hpp"  // pauseRadioForOta / resumeRadioAfterOta
 #include "components/firmware/ota_quiet_mode.hpp"     // enterQuiet / exitQuiet
 #include "components/network/protocol/lamp_protocol.hpp"
@@ -15,6 +19,7 @@
 #include <esp_ota_ops.h>
 #include <esp_partition.h>
 #include <mbedtls/sha256.h>
+#include <spi_flash_mmap.h>  // SPI_FLASH_SEC_SIZE
 #endif
 
 #if defined(LAMP_DEBUG) && (defined(ARDUINO) || defined(ESP_PLATFORM))
@@ -34,6 +39,7 @@ FirmwareDistributor* FirmwareDistributor::s_streamers[2] = {nullptr, nullptr};
 uint8_t              FirmwareDistributor::s_streamerCount = 0;
 SemaphoreHandle_t    FirmwareDistributor::s_sharedWake = nullptr;
 TaskHandle_t         FirmwareDistributor::s_sharedTask = nullptr;
+ota_pack::Workspace* FirmwareDistributor::s_packWorkspace = nullptr;
 #endif
 
 namespace {
@@ -151,6 +157,7 @@ void FirmwareDistributor::begin(FirmwareTransport* transport) {
     }
     authReady_ = true;
   }
+  deltaReady_ = discoverDeltaPatch();
   }  // else: firmware distribution
 #else
   // Native test path: tests bypass begin() or stub these fields directly.
@@ -227,6 +234,120 @@ bool FirmwareDistributor::discoverImageLength(uint32_t* outLen) const {
       runningPartition_->size, outLen);
 }
 
+bool FirmwareDistributor::discoverDeltaPatch() {
+  if (!runningPartition_ || firmwareTotalLen_ == 0) return false;
+  const uint32_t slotLen = static_cast<uint32_t>(runningPartition_->size);
+  if (slotLen <= ota_delta::kTrailerLen) return false;
+  uint8_t raw[ota_delta::kTrailerLen];
+  ota_delta::Trailer t;
+  if (!readPartitionBytes(slotLen - ota_delta::kTrailerLen, sizeof(raw), raw) ||
+      !ota_delta::parseTrailer(raw, sizeof(raw), t)) {
+    return false;
+  }
+  // Only a patch for exactly this image: the tail of a slot last written with
+  // a full image keeps whatever patch an older install left there.
+  uint32_t patchOffset = 0;
+  if (t.imageLen != firmwareTotalLen_ ||
+      t.imageVersion != lamp::FIRMWARE_VERSION ||
+      std::memcmp(t.imageDigest, sha256Full_, sizeof(sha256Full_)) != 0 ||
+      t.opsLen > slotLen - ota_delta::kTrailerLen ||
+      !ota_delta::slotLayout(slotLen, t.imageLen,
+                             t.opsLen + static_cast<uint32_t>(ota_delta::kTrailerLen),
+                             SPI_FLASH_SEC_SIZE, patchOffset)) {
+    return false;
+  }
+  deltaLen_         = t.opsLen + static_cast<uint32_t>(ota_delta::kTrailerLen);
+  deltaOffset_      = patchOffset;
+  deltaBaseVersion_ = t.baseVersion;
+  deltaBaseLen_     = t.baseLen;
+  std::memcpy(deltaBaseId_, t.baseId, sizeof(deltaBaseId_));
+  FWDIST_LOGF("[fwdist] delta patch: %u bytes from base v=0x%08lx\n",
+              (unsigned)deltaLen_, (unsigned long)deltaBaseVersion_);
+  return true;
+}
+
+bool FirmwareDistributor::packPlanFor(uint32_t base, uint32_t len) {
+  if (!runningPartition_ || len == 0) return false;
+  portENTER_CRITICAL(&stateMux_);
+  const bool built = packBuildDone_;
+  portEXIT_CRITICAL(&stateMux_);
+  if (built) {
+    // A failed build leaves packBuild_ empty and the held plan standing.
+    if (!packBuild_.empty()) {
+      packStarts_.swap(packBuild_);
+      packPlanBase_      = packBuildBase_;
+      packPlanLen_       = packBuildLen_;
+      packPlanChunkSize_ = packBuildChunkSize_;
+      FWDIST_LOGF("[fwdist] pack plan: %u bytes in %u units of <=%u\n",
+                  (unsigned)packPlanLen_, (unsigned)(packStarts_.size() - 1),
+                  (unsigned)packPlanChunkSize_);
+    }
+    packBuild_.clear();
+    packBuild_.shrink_to_fit();
+    portENTER_CRITICAL(&stateMux_);
+    if (packWantBase_ == packBuildBase_ && packWantLen_ == packBuildLen_ &&
+        packWantChunkSize_ == packBuildChunkSize_) {
+      packWantChunkSize_ = 0;
+    }
+    packBuildChunkSize_ = 0;
+    packBuildDone_      = false;
+    portEXIT_CRITICAL(&stateMux_);
+  }
+  if (packStarts_.size() >= 2 && packPlanBase_ == base && packPlanLen_ == len &&
+      packPlanChunkSize_ == sessionChunkSize_) {
+    return true;
+  }
+  portENTER_CRITICAL(&stateMux_);
+  packWantBase_      = base;
+  packWantLen_       = len;
+  packWantChunkSize_ = sessionChunkSize_;
+  portEXIT_CRITICAL(&stateMux_);
+  wakeStreamingTask();
+  return false;
+}
+
+bool FirmwareDistributor::packPlanStep() {
+  uint32_t base;
+  uint32_t len;
+  uint16_t chunkSize;
+  portENTER_CRITICAL(&stateMux_);
+  const bool built = packBuildDone_;
+  base      = packWantBase_;
+  len       = packWantLen_;
+  chunkSize = packWantChunkSize_;
+  portEXIT_CRITICAL(&stateMux_);
+  if (built || chunkSize == 0) return false;
+  if (base != packBuildBase_ || len != packBuildLen_ ||
+      chunkSize != packBuildChunkSize_) {
+    packBuild_.clear();
+    packBuildBase_      = base;
+    packBuildLen_       = len;
+    packBuildChunkSize_ = chunkSize;
+    packBuildPos_       = 0;
+  }
+  if (!s_packWorkspace) {
+    s_packWorkspace = new (std::nothrow) ota_pack::Workspace;
+  }
+  const ota_pack::PlanStep r =
+      s_packWorkspace
+          ? ota_pack::planSome(
+                [this, base](size_t off, size_t want, uint8_t* out) -> int {
+                  return readPartitionBytes(base + static_cast<uint32_t>(off),
+                                            want, out)
+                             ? static_cast<int>(want)
+                             : -1;
+                },
+                len, chunkSize, *s_packWorkspace, packBuild_, packBuildPos_,
+                kPackPlanUnitsPerStep)
+          : ota_pack::PlanStep::Failed;
+  if (r == ota_pack::PlanStep::More) return true;
+  if (r == ota_pack::PlanStep::Failed) packBuild_.clear();
+  portENTER_CRITICAL(&stateMux_);
+  packBuildDone_ = true;
+  portEXIT_CRITICAL(&stateMux_);
+  return false;
+}
+
 bool FirmwareDistributor::computeShaPrefixOnce(uint32_t totalLen) {
   if (!runningPartition_) return false;
   if (totalLen <= kFwFooterLenV1) return false;
@@ -301,9 +422,16 @@ void FirmwareDistributor::streamingTaskLoop() {
       while (s_streamers[i]->streamingTaskStep(millis())) {
         // Yield so the WiFi task can push frames over the air before the next
         // one is queued (see kStreamingChunkSpacingMs).
-        vTaskDelay(pdMS_TO_TICKS(kStreamingChunkSpacingMs));
+        vTaskDelay(pdMS_TO_TICKS(s_streamers[i]->chunkSpacingMs()));
       }
     }
+    // Pack plans fill in between sessions, a slice per pass, and come back
+    // after kPackPlanStepMs rather than the idle poll while one is unfinished.
+    bool planning = false;
+    for (uint8_t i = 0; i < s_streamerCount; ++i) {
+      if (s_streamers[i]->packPlanStep()) planning = true;
+    }
+    if (planning) vTaskDelay(pdMS_TO_TICKS(kPackPlanStepMs));
   }
 }
 
@@ -318,18 +446,25 @@ bool FirmwareDistributor::streamingTaskStep(uint32_t nowMs) {
   uint16_t totalChunksLocal = 0;
   bool     quietHeldLocal = false;
   bool     sessionQuietArmedLocal = false;
+  uint8_t  fecRowsDueLocal = 0;
+  uint16_t offerSeqLocal = 0;
+  bool     groupLocal = false;
   portENTER_CRITICAL(&stateMux_);
   s = state_;
   std::memcpy(targetMacLocal, targetMac_, 6);
+  offerSeqLocal      = sessionOfferSeq_;
+  groupLocal         = groupSession_;
   lastOfferLocal     = lastOfferSendMs_;
   offerRetriesLocal  = offerRetryCount_;
   nextChunkLocal     = nextChunkIdx_;
   totalChunksLocal   = totalChunks_;
   quietHeldLocal     = quietHeld_;
   sessionQuietArmedLocal = sessionQuietArmed_;
+  fecRowsDueLocal    = fecRowsDue_;
   portEXIT_CRITICAL(&stateMux_);
 
   if (s == State::OfferSent) {
+    if (groupLocal) return groupOfferStep(nowMs);
     if (offerRetriesLocal >= kMaxOfferRetries) {
       // Out of retries; wait for ACCEPT (recv task) or kAcceptTimeoutMs (tick).
       return false;
@@ -340,7 +475,7 @@ bool FirmwareDistributor::streamingTaskStep(uint32_t nowMs) {
       portENTER_CRITICAL(&stateMux_);
       offerRetryCount_++;
       portEXIT_CRITICAL(&stateMux_);
-      sendOfferFrame(targetMacLocal, nowMs, /*isRetry=*/true);
+      sendOfferFrame(targetMacLocal, offerSeqLocal, nowMs, /*isRetry=*/true);
       return true;
     }
     const uint32_t waitMs = kOfferRetryIntervalMs - sinceLast;
@@ -373,29 +508,56 @@ bool FirmwareDistributor::streamingTaskStep(uint32_t nowMs) {
                   (unsigned)hwmBytes);
 #endif
     }
+    // A finished block's repair rows go out before the next chunk (or DONE),
+    // while the receiver still holds the block's neighbours.
+    const int rc = fecRowsDueLocal != 0 ? streamOneRepair(nowMs) : -1;
+    if (rc == 1) {
+      vTaskDelay(pdMS_TO_TICKS(kStreamingQueueBackoffMs));
+      return true;
+    }
+    if (rc == 2) return false;
+    if (rc == 0) return true;
     if (nextChunkLocal >= totalChunksLocal) {
       // Drained: transition to Finalizing and emit DONE outside the mux.
       bool needFinalize = false;
+      bool replay = false;
       portENTER_CRITICAL(&stateMux_);
       if (state_ == State::Streaming &&
           nextChunkIdx_ >= totalChunks_) {
-        state_ = State::Finalizing;
-        stateEnteredMs_ = nowMs;
-        needFinalize = true;
+        if (lateJoinEnd_ != 0) {
+          // A group member accepted mid-stream: replay what it missed once,
+          // through the REQ resume cursor, then finalize on the next drain. A
+          // hole REQ served meanwhile cuts the replay short; the member's
+          // DONE-time REQs name what's left.
+          resumeChunkIdx_ = totalChunks_;
+          reqEndIdx_      = lateJoinEnd_;
+          nextChunkIdx_   = 0;
+          lateJoinEnd_    = 0;
+          lastSentMs_     = nowMs;
+          replay = true;
+        } else {
+          state_ = State::Finalizing;
+          stateEnteredMs_ = nowMs;
+          needFinalize = true;
+        }
       }
       portEXIT_CRITICAL(&stateMux_);
+      if (replay) {
+        FWDIST_LOGLN("[fwdist] forward pass out; replaying for late members");
+        return true;
+      }
       if (needFinalize) emitDone(nowMs);
       // No more chunk work; idle. tick() owns the FINALIZE timeout, the recv
       // task wakes the streamer on RESULT.
       return false;
     }
-    const int rc = streamOneChunk(nowMs);
-    if (rc == 1) {
+    const int chunkRc = streamOneChunk(nowMs);
+    if (chunkRc == 1) {
       // NO_MEM.
       vTaskDelay(pdMS_TO_TICKS(kStreamingQueueBackoffMs));
       return true;
     }
-    if (rc == 2) {
+    if (chunkRc == 2) {
       // Partition read failure already aborted the session.
       return false;
     }
@@ -418,7 +580,7 @@ int FirmwareDistributor::streamOneChunk(uint32_t nowMs) {
     return 0;
   }
   chunkIdx = nextChunkIdx_;
-  std::memcpy(targetMacLocal, targetMac_, 6);
+  streamTarget(targetMacLocal);
   portEXIT_CRITICAL(&stateMux_);
 
   if (!transport_ || !runningPartition_) return 2;
@@ -428,17 +590,40 @@ int FirmwareDistributor::streamOneChunk(uint32_t nowMs) {
   // never runs re-entrantly or concurrently and both instances can share one
   // buffer. Keeps ~2.9 KB off the streaming-task stack.
   static uint8_t scratch[lamp_protocol::FW_CHUNK_SIZE_MAX];
-  const uint32_t offset =
-      static_cast<uint32_t>(chunkIdx) * sessionChunkSize_;
-  // Last chunk is short when totalLen isn't a multiple of sessionChunkSize_.
-  size_t want = sessionChunkSize_;
-  if (offset >= firmwareTotalLen_) {
-    return 2;
-  }
-  if (offset + want > firmwareTotalLen_) {
-    want = firmwareTotalLen_ - offset;
+  const uint8_t* payload = scratch;
+  uint32_t offset;
+  size_t want;
+  bool readOk;
+  if (packSession_) {
+    // Re-pack the unit from the slot. The encoder is deterministic, so it
+    // covers exactly the span the plan recorded; anything else is a flash
+    // read gone wrong.
+    if (static_cast<size_t>(chunkIdx) + 1 >= packStarts_.size()) return 2;
+    offset = packStarts_[chunkIdx];
+    const uint32_t base = sessionBase_;
+    size_t consumed = 0;
+    want = ota_pack::packAt(
+        [this, base](size_t off, size_t len, uint8_t* out) -> int {
+          return readPartitionBytes(base + static_cast<uint32_t>(off), len, out)
+                     ? static_cast<int>(len)
+                     : -1;
+        },
+        sessionTotalLen_, offset, sessionChunkSize_, *s_packWorkspace, consumed);
+    readOk  = want != 0 && consumed == packStarts_[chunkIdx + 1] - offset;
+    payload = s_packWorkspace->out;
+  } else {
+    offset = static_cast<uint32_t>(chunkIdx) * sessionChunkSize_;
+    // Last chunk is short when totalLen isn't a multiple of sessionChunkSize_.
+    want = sessionChunkSize_;
+    if (offset >= sessionTotalLen_) {
+      return 2;
+    }
+    if (offset + want > sessionTotalLen_) {
+      want = sessionTotalLen_ - offset;
+    }
+    readOk = readPartitionBytes(sessionBase_ + offset, want, scratch);
   }
-  if (!readPartitionBytes(offset, want, scratch)) {
+  if (!readOk) {
     FWDIST_LOGF("[fwdist] readPartitionBytes(off=%u len=%u) failed; aborting\n",
                   (unsigned)offset, (unsigned)want);
     portENTER_CRITICAL(&stateMux_);
@@ -462,7 +647,7 @@ int FirmwareDistributor::streamOneChunk(uint32_t nowMs) {
   const size_t framed = lamp_protocol::buildFwChunk(
       buf, sizeof(buf), seq,
       cachedSrcMac_, targetMacLocal,
-      chunkIdx, offset, scratch, static_cast<uint16_t>(want),
+      chunkIdx, offset, payload, static_cast<uint16_t>(want),
       targetProtocolVersion_,
       fsHooks_ ? fsHooks_->chunkType : lamp_protocol::MSG_FW_CHUNK);
   if (!framed) return 1;
@@ -496,11 +681,39 @@ int FirmwareDistributor::streamOneChunk(uint32_t nowMs) {
     currentChunkRetries_ = 0;
     lastSentMs_ = nowMs;
     lastBurstSentChunks_++;
-    // Smart-REQ resume: after serving the requested chunks, jump back to the
-    // forward-progress position so the stream doesn't repeat what the receiver
-    // has (set up in onReq).
-    if (resumeChunkIdx_ != 0 && nextChunkIdx_ >= reqEndIdx_ &&
+    if (fecPeer_ && chunkIdx == fecNext_) {
+      // Forward progress closes a block once its last chunk is out (or the
+      // image's, for a short final block); queue the block's repair rows.
+      ++fecNext_;
+      const uint16_t block = static_cast<uint16_t>(ota_fec::kStride) *
+                             lamp_protocol::FW_FEC_WINDOW_CHUNKS;
+      if (fecNext_ % block == 0 || fecNext_ == totalChunks_) {
+        fecBlock_    = static_cast<uint16_t>(chunkIdx - chunkIdx % block);
+        const uint16_t span = static_cast<uint16_t>(totalChunks_ - fecBlock_);
+        fecLanes_    = static_cast<uint8_t>(span < ota_fec::kStride ? span
+                                                                    : ota_fec::kStride);
+        fecRowsDue_  = static_cast<uint8_t>(fecLanes_ * ota_fec::kRowsPerWindow);
+        fecRowsSent_ = 0;
+      }
+    }
+    uint16_t nextHole = 0;
+    if (reqHoles_.active()) {
+      // Exact-hole REQ: step to the next named hole, or once they're all out,
+      // straight back to the forward position.
+      if (reqHoles_.served(chunkIdx, nextHole)) {
+        nextChunkIdx_ = nextHole;
+      } else if (resumeChunkIdx_ != 0) {
+        resumeToLog     = resumeChunkIdx_;
+        nextChunkIdx_   = resumeChunkIdx_;
+        resumeChunkIdx_ = 0;
+        reqEndIdx_      = 0;
+        resumedToFwd    = true;
+      }
+    } else if (resumeChunkIdx_ != 0 && nextChunkIdx_ >= reqEndIdx_ &&
         nextChunkIdx_ < resumeChunkIdx_) {
+      // Smart-REQ resume: after serving the requested chunks, jump back to the
+      // forward-progress position so the stream doesn't repeat what the
+      // receiver has (set up in onReq).
       resumeToLog       = resumeChunkIdx_;
       nextChunkIdx_     = resumeChunkIdx_;
       resumeChunkIdx_   = 0;
@@ -527,6 +740,131 @@ int FirmwareDistributor::streamOneChunk(uint32_t nowMs) {
   return 0;
 }
 
+// Single repair-row emit. Returns 0 = queued (or nothing due); 1 = NO_MEM,
+// caller delays + retries the same row; 2 = partition read failure, session
+// aborted.
+int FirmwareDistributor::streamOneRepair(uint32_t nowMs) {
+  // Rows go out row-major across the block's lanes (row 0 of every window,
+  // then row 1), so a burst here also lands on different windows.
+  uint8_t  sentBefore;
+  uint8_t  row;
+  uint16_t windowStart;
+  uint16_t totalChunksLocal;
+  uint8_t  targetMacLocal[6];
+  portENTER_CRITICAL(&stateMux_);
+  if (state_ != State::Streaming || fecRowsDue_ == 0 || fecLanes_ == 0) {
+    portEXIT_CRITICAL(&stateMux_);
+    return 0;
+  }
+  sentBefore       = fecRowsSent_;
+  row              = static_cast<uint8_t>(fecRowsSent_ / fecLanes_);
+  windowStart      = static_cast<uint16_t>(fecBlock_ + fecRowsSent_ % fecLanes_);
+  totalChunksLocal = totalChunks_;
+  streamTarget(targetMacLocal);
+  portEXIT_CRITICAL(&stateMux_);
+
+  if (!transport_ || !runningPartition_) return 2;
+
+  const uint8_t windowLen =
+      ota_fec::windowLen(windowStart, ota_fec::kStride, totalChunksLocal);
+  const uint32_t windowOffset =
+      static_cast<uint32_t>(windowStart) * sessionChunkSize_;
+  if (windowLen == 0 || windowOffset >= sessionTotalLen_) return 2;
+  // The row is as long as the window's longest chunk, its first: only the
+  // image's last chunk is short.
+  const size_t rowLen =
+      sessionTotalLen_ - windowOffset < sessionChunkSize_
+          ? sessionTotalLen_ - windowOffset
+          : sessionChunkSize_;
+
+  // Off-stack like streamOneChunk's buffers (one shared streaming task). Each
+  // window chunk is read into the frame's payload area, folded into acc, and
+  // then buildFwRepair copies acc over it.
+  static uint8_t acc[lamp_protocol::FW_CHUNK_SIZE_MAX];
+  static uint8_t buf[lamp_protocol::FW_REPAIR_MAX_SIZE];
+  uint8_t* chunk = buf + lamp_protocol::FW_REPAIR_FIXED_SIZE;
+  std::memset(acc, 0, rowLen);
+  for (uint8_t col = 0; col < windowLen; ++col) {
+    const uint32_t idx =
+        static_cast<uint32_t>(windowStart) + static_cast<uint32_t>(col) * ota_fec::kStride;
+    const uint32_t offset = idx * sessionChunkSize_;
+    size_t want = sessionChunkSize_;
+    if (offset + want > sessionTotalLen_) want = sessionTotalLen_ - offset;
+    if (!readPartitionBytes(sessionBase_ + offset, want, chunk)) {
+      FWDIST_LOGF("[fwdist] readPartitionBytes(off=%u len=%u) failed; aborting\n",
+                  (unsigned)offset, (unsigned)want);
+      portENTER_CRITICAL(&stateMux_);
+      recordPeerFailure(nowMs);
+      resetSession();
+      state_ = State::Failed;
+      stateEnteredMs_ = nowMs;
+      portEXIT_CRITICAL(&stateMux_);
+      return 2;
+    }
+    ota_fec::accumulate(acc, rowLen, row, col, chunk, want);
+  }
+
+  uint16_t seq;
+  portENTER_CRITICAL(&stateMux_);
+  seq = seqCounter_++;
+  portEXIT_CRITICAL(&stateMux_);
+
+  const size_t framed = lamp_protocol::buildFwRepair(
+      buf, sizeof(buf), seq, cachedSrcMac_, targetMacLocal,
+      windowStart, windowLen, ota_fec::kStride, row,
+      acc, static_cast<uint16_t>(rowLen), targetProtocolVersion_,
+      fsHooks_ ? fsHooks_->repairType : lamp_protocol::MSG_FW_REPAIR);
+  if (!framed) return 1;
+  if (!transport_->sendFrame(buf, framed)) return 1;
+
+  // Advance only if no other path moved the row cursor meanwhile (a session
+  // reset zeroes it).
+  portENTER_CRITICAL(&stateMux_);
+  if (state_ == State::Streaming && fecRowsDue_ != 0 &&
+      fecRowsSent_ == sentBefore) {
+    ++fecRowsSent_;
+    --fecRowsDue_;
+  }
+  portEXIT_CRITICAL(&stateMux_);
+  return 0;
+}
+
+bool FirmwareDistributor::groupOfferStep(uint32_t nowMs) {
+  uint8_t  macs[kMaxGroupMembers][6];
+  uint16_t seqs[kMaxGroupMembers];
+  uint8_t  due = 0;
+  bool     waiting = false;
+  uint32_t sinceLast;
+  // Members share the retry cadence: every due OFFER goes out in one pass, so
+  // a member that joined late retries on the group's beat.
+  portENTER_CRITICAL(&stateMux_);
+  sinceLast = nowMs - lastOfferSendMs_;
+  for (uint8_t i = 0; i < memberCount_; ++i) {
+    GroupMember& m = members_[i];
+    if (m.state != MemberState::Offered || m.offerRetries >= kMaxOfferRetries) {
+      continue;
+    }
+    waiting = true;
+    if (sinceLast < kOfferRetryIntervalMs) continue;
+    ++m.offerRetries;
+    std::memcpy(macs[due], m.mac, 6);
+    seqs[due] = m.offerSeq;
+    ++due;
+  }
+  portEXIT_CRITICAL(&stateMux_);
+  // Out of retries everywhere; ACCEPTs land on the recv task, the gather and
+  // ACCEPT timeouts in tick().
+  if (!waiting) return false;
+  if (due == 0) {
+    xSemaphoreTake(s_sharedWake, pdMS_TO_TICKS(kOfferRetryIntervalMs - sinceLast));
+    return true;
+  }
+  for (uint8_t i = 0; i < due; ++i) {
+    sendOfferFrame(macs[i], seqs[i], nowMs, /*isRetry=*/true);
+  }
+  return true;
+}
+
 #endif  // ARDUINO || ESP_PLATFORM
 
 // Drives ACCEPT/FINALIZE timeouts, the stall watchdog, and the tombstone reaper.
@@ -579,6 +917,23 @@ void FirmwareDistributor::tick(uint32_t nowMs) {
     }
 
     case State::OfferSent: {
+      if (groupSession_) {
+        // Members time out one by one; the group as a whole starts streaming
+        // or fails in tickGroup.
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+        portENTER_CRITICAL(&stateMux_);
+        const bool wake = tickGroup(nowMs);
+        portEXIT_CRITICAL(&stateMux_);
+        if (wake) {
+          FWDIST_LOGF("[fwdist] group gathered; streaming to %u member(s)\n",
+                      (unsigned)memberCount_);
+          wakeStreamingTask();
+        }
+#else
+        tickGroup(nowMs);
+#endif
+        break;
+      }
       if (nowMs >= stateEnteredMsLocal &&
           (nowMs - stateEnteredMsLocal) > kAcceptTimeoutMs) {
         FWDIST_LOGLN("[fwdist] OFFER timeout; backing off peer");
@@ -623,23 +978,41 @@ void FirmwareDistributor::tick(uint32_t nowMs) {
       uint16_t totalChunksLocal    = totalChunks_;
       uint16_t lastSentChunkLocal  = lastSentChunk_;
 #endif
+      if (groupSession_) {
+        // Expiring the last unanswered OFFER can settle the whole group.
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+        portENTER_CRITICAL(&stateMux_);
+        tickGroup(nowMs);
+        const bool settled = !isInProgress();
+        portEXIT_CRITICAL(&stateMux_);
+#else
+        tickGroup(nowMs);
+        const bool settled = !isInProgress();
+#endif
+        if (settled) break;
+      }
       if (nextChunkLocal >= totalChunksLocal) break;
       if (nowMs >= lastSentMsLocal &&
           (nowMs - lastSentMsLocal) > kChunkResendMs) {
         if (currentRetriesLocal >= kRetriesPerChunk) {
           FWDIST_LOGLN("[fwdist] chunk retry budget exhausted; failing peer");
+          // A group that already has a verified member still ends Done.
 #if defined(ARDUINO) || defined(ESP_PLATFORM)
           portENTER_CRITICAL(&stateMux_);
           recordPeerFailure(nowMs);
-          resetSession();
-          state_ = State::Failed;
-          stateEnteredMs_ = nowMs;
+          if (!settleGroup(nowMs)) {
+            resetSession();
+            state_ = State::Failed;
+            stateEnteredMs_ = nowMs;
+          }
           portEXIT_CRITICAL(&stateMux_);
 #else
           recordPeerFailure(nowMs);
-          resetSession();
-          state_ = State::Failed;
-          stateEnteredMs_ = nowMs;
+          if (!settleGroup(nowMs)) {
+            resetSession();
+            state_ = State::Failed;
+            stateEnteredMs_ = nowMs;
+          }
 #endif
           break;
         }
@@ -661,18 +1034,32 @@ void FirmwareDistributor::tick(uint32_t nowMs) {
       if (nowMs >= stateEnteredMsLocal &&
           (nowMs - stateEnteredMsLocal) > kFinalizeTimeoutMs) {
         FWDIST_LOGLN("[fwdist] FINALIZE timeout; short-backing off peer");
+        // Members that never sent RESULT get the short backoff; a group with
+        // a verified member still ends Done.
 #if defined(ARDUINO) || defined(ESP_PLATFORM)
         portENTER_CRITICAL(&stateMux_);
         recordPeerFailureFinalize(nowMs);
-        resetSession();
-        state_ = State::Failed;
-        stateEnteredMs_ = nowMs;
+        if (!settleGroup(nowMs)) {
+          resetSession();
+          state_ = State::Failed;
+          stateEnteredMs_ = nowMs;
+        }
         portEXIT_CRITICAL(&stateMux_);
 #else
         recordPeerFailureFinalize(nowMs);
-        resetSession();
-        state_ = State::Failed;
-        stateEnteredMs_ = nowMs;
+        if (!settleGroup(nowMs)) {
+          resetSession();
+          state_ = State::Failed;
+          stateEnteredMs_ = nowMs;
+        }
+#endif
+      } else if (groupSession_) {
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+        portENTER_CRITICAL(&stateMux_);
+        tickGroup(nowMs);
+        portEXIT_CRITICAL(&stateMux_);
+#else
+        tickGroup(nowMs);
 #endif
       }
       break;
@@ -713,8 +1100,13 @@ void FirmwareDistributor::considerPeerForOta(const uint8_t peerMac[6],
                                              const char* peerFwChannel,
                                              uint16_t peerMaxChunk,
                                              int8_t peerRssi,
-                                             bool peerBeingServed) {
-  if (state_ != State::Idle) {
+                                             bool peerBeingServed,
+                                             uint8_t peerCaps) {
+  // A gathering group session keeps taking group-capable peers; joinGroup
+  // checks the rest of the fit.
+  const bool joining = state_ == State::OfferSent && groupSession_ &&
+                       (peerCaps & lamp_protocol::HELLO_CAP_FW_GROUP) != 0;
+  if (state_ != State::Idle && !joining) {
     FWDIST_LOGF("[fwdist] consider %02X:%02X:%02X:%02X:%02X:%02X v=0x%08X skip: "
                 "state=%u (not Idle)\n",
                 peerMac[0], peerMac[1], peerMac[2],
@@ -793,6 +1185,11 @@ void FirmwareDistributor::considerPeerForOta(const uint8_t peerMac[6],
                 (unsigned)peerVersion);
     return;
   }
+  if (joining) {
+    joinGroup(peerMac, peerVersion, peerProtocolVersion, peerMaxChunk, peerCaps,
+              nowMs);
+    return;
+  }
   FWDIST_LOGF("[fwdist] consider %02X:%02X:%02X:%02X:%02X:%02X v=0x%08X "
               "our=0x%08X → OFFER\n",
               peerMac[0], peerMac[1], peerMac[2],
@@ -810,9 +1207,153 @@ void FirmwareDistributor::considerPeerForOta(const uint8_t peerMac[6],
           : lamp_protocol::FW_CHUNK_SIZE_MAX;
   sessionChunkSize_ = peerMaxChunk > 0 ? cappedPeerMaxChunk
                                        : lamp_protocol::FW_CHUNK_SIZE_BASELINE;
+  reqMaskPeer_ = (peerCaps & lamp_protocol::HELLO_CAP_FW_REQ_BITMAP) != 0;
+  groupSession_ = (peerCaps & lamp_protocol::HELLO_CAP_FW_GROUP) != 0;
+  deltaSession_ = deltaFor(peerMac, peerVersion, peerCaps);
+  // The pack trailer rides behind the auth one. Until the streaming task has
+  // planned this stream at this chunk size, or if it can't, the session
+  // streams raw; a later session packs.
+  packSession_ = false;
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  if ((peerCaps & lamp_protocol::HELLO_CAP_FW_PACKED) != 0 && authReady_ &&
+      sessionChunkSize_ >= ota_pack::kMinChunkSize) {
+    packSession_ = packPlanFor(deltaSession_ ? deltaOffset_ : 0,
+                               deltaSession_ ? deltaLen_ : firmwareTotalLen_);
+  }
+#endif
+  // Repair rows are XORs of equal-offset chunk slices, which packed units
+  // aren't; a packed session leans on the mask REQ alone.
+  fecPeer_ = (peerCaps & lamp_protocol::kOtaFecCap) != 0 && !packSession_;
   emitOffer(peerMac, peerVersion, nowMs);
 }
 
+void FirmwareDistributor::joinGroup(const uint8_t peerMac[6],
+                                    uint32_t peerVersion,
+                                    uint8_t peerProtocolVersion,
+                                    uint16_t peerMaxChunk, uint8_t peerCaps,
+                                    uint32_t nowMs) {
+  // One stream serves every member, so each must parse the session's wire
+  // version, take its chunk size, REQ/decode the way the stream expects, and
+  // want the same bytes (the patch or the image) in the same chunk form.
+  const uint16_t peerChunk =
+      peerMaxChunk == 0 ? lamp_protocol::FW_CHUNK_SIZE_BASELINE
+      : peerMaxChunk < lamp_protocol::FW_CHUNK_SIZE_MAX
+          ? peerMaxChunk
+          : lamp_protocol::FW_CHUNK_SIZE_MAX;
+  const bool peerReqMask = (peerCaps & lamp_protocol::HELLO_CAP_FW_REQ_BITMAP) != 0;
+  const bool peerFec     = (peerCaps & lamp_protocol::kOtaFecCap) != 0 &&
+                           !packSession_;
+  const bool peerPacked  = (peerCaps & lamp_protocol::HELLO_CAP_FW_PACKED) != 0;
+  const bool peerDelta   = deltaFor(peerMac, peerVersion, peerCaps);
+  bool admitted = false;
+  uint16_t offerSeq = 0;
+  uint8_t count = 0;
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  portENTER_CRITICAL(&stateMux_);
+#endif
+  if (state_ == State::OfferSent && groupSession_ &&
+      memberCount_ < kMaxGroupMembers && !findMember(peerMac) &&
+      peerProtocolVersion == targetProtocolVersion_ &&
+      peerChunk >= sessionChunkSize_ &&
+      peerReqMask == reqMaskPeer_ && peerFec == fecPeer_ &&
+      peerDelta == deltaSession_ && (peerPacked || !packSession_)) {
+    offerSeq = seqCounter_++;
+    GroupMember& m = members_[memberCount_++];
+    std::memcpy(m.mac, peerMac, 6);
+    m.offerSeq     = offerSeq;
+    m.offerRetries = 0;
+    m.offeredMs    = nowMs;
+    m.state        = MemberState::Offered;
+    count    = memberCount_;
+    admitted = true;
+  }
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  portEXIT_CRITICAL(&stateMux_);
+#endif
+  if (!admitted) return;
+  FWDIST_LOGF("[fwdist] group join %02X:%02X:%02X:%02X:%02X:%02X (%u/%u)\n",
+              peerMac[0], peerMac[1], peerMac[2],
+              peerMac[3], peerMac[4], peerMac[5],
+              (unsigned)count, (unsigned)kMaxGroupMembers);
+  (void)count;
+  // A failed first send is retried on the group's beat (groupOfferStep).
+  sendOfferFrame(peerMac, offerSeq, nowMs, /*isRetry=*/false);
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  wakeStreamingTask();
+#endif
+}
+
+FirmwareDistributor::GroupMember* FirmwareDistributor::findMember(
+    const uint8_t mac[6]) {
+  for (uint8_t i = 0; i < memberCount_; ++i) {
+    if (macsEqual(members_[i].mac, mac)) return &members_[i];
+  }
+  return nullptr;
+}
+
+void FirmwareDistributor::streamTarget(uint8_t out[6]) const {
+  if (groupSession_) {
+    lamp_protocol::fwGroupMac(cachedSrcMac_, out);
+  } else {
+    std::memcpy(out, targetMac_, 6);
+  }
+}
+
+bool FirmwareDistributor::isStreamPeer(const uint8_t mac[6]) {
+  if (!groupSession_) return macsEqual(mac, targetMac_);
+  const GroupMember* m = findMember(mac);
+  return m && m->state == MemberState::Accepted;
+}
+
+bool FirmwareDistributor::tickGroup(uint32_t nowMs) {
+  if (!groupSession_ || !isInProgress()) return false;
+  bool accepted = false;
+  bool retrying = false;
+  for (uint8_t i = 0; i < memberCount_; ++i) {
+    GroupMember& m = members_[i];
+    if (m.state == MemberState::Offered &&
+        nowMs - m.offeredMs > kAcceptTimeoutMs) {
+      m.state = MemberState::Failed;
+      notePeerBackoff(m.mac, nowMs, kPeerBackoffMs);
+    }
+    if (m.state == MemberState::Accepted) accepted = true;
+    if (m.state == MemberState::Offered && m.offerRetries < kMaxOfferRetries) {
+      retrying = true;
+    }
+  }
+  if (settleGroup(nowMs)) return false;
+  if (state_ != State::OfferSent || !accepted || retrying ||
+      nowMs - stateEnteredMs_ < kGroupGatherMs) {
+    return false;
+  }
+  state_ = State::Streaming;
+  stateEnteredMs_ = nowMs;
+  // Same fair first-chunk window as the single-peer ACCEPT.
+  lastSentMs_ = nowMs;
+  return true;
+}
+
+bool FirmwareDistributor::settleGroup(uint32_t nowMs) {
+  if (!groupSession_) return false;
+  const GroupMember* verified = nullptr;
+  for (uint8_t i = 0; i < memberCount_; ++i) {
+    const GroupMember& m = members_[i];
+    if (m.state == MemberState::Offered || m.state == MemberState::Accepted) {
+      return false;
+    }
+    if (m.state == MemberState::Succeeded && !verified) verified = &m;
+  }
+  if (verified) {
+    // The indicator's hold shows a member that actually took the image.
+    std::memcpy(targetMac_, verified->mac, 6);
+    captureLastSession();
+  }
+  resetSession();
+  state_ = verified ? State::Done : State::Failed;
+  stateEnteredMs_ = nowMs;
+  return true;
+}
+
 void FirmwareDistributor::resetSession() {
   std::memset(targetMac_, 0, 6);
   targetProtocolVersion_ = 0;
@@ -826,12 +1367,26 @@ void FirmwareDistributor::resetSession() {
   sessionOfferSeq_ = 0;
   sessionVersion_  = 0;
   sessionTotalLen_ = 0;
+  sessionBase_     = 0;
+  deltaSession_    = false;
+  packSession_     = false;
   lastOfferSendMs_ = 0;
   offerRetryCount_ = 0;
   lastBurstSentChunks_ = 0;
   reqCountThisSession_ = 0;
   resumeChunkIdx_  = 0;
   reqEndIdx_       = 0;
+  reqHoles_.clear();
+  reqMaskPeer_     = false;
+  fecPeer_         = false;
+  fecNext_         = 0;
+  fecBlock_        = 0;
+  fecLanes_        = 0;
+  fecRowsDue_      = 0;
+  fecRowsSent_     = 0;
+  groupSession_    = false;
+  memberCount_     = 0;
+  lateJoinEnd_     = 0;
   sessionQuietArmed_ = false;
 }
 
@@ -861,6 +1416,27 @@ bool FirmwareDistributor::peerIsInBackoff(const uint8_t mac[6],
   return false;
 }
 
+bool FirmwareDistributor::deltaFor(const uint8_t mac[6], uint32_t peerVersion,
+                                   uint8_t peerCaps) const {
+  if (fsHooks_ || !deltaReady_ || peerVersion != deltaBaseVersion_ ||
+      (peerCaps & lamp_protocol::HELLO_CAP_FW_DELTA) == 0) {
+    return false;
+  }
+  for (size_t i = 0; i < kDeltaRefusedRingSize; ++i) {
+    if (macsEqual(deltaRefused_[i], mac)) return false;
+  }
+  return true;
+}
+
+void FirmwareDistributor::noteDeltaRefused(const uint8_t mac[6]) {
+  for (size_t i = 0; i < kDeltaRefusedRingSize; ++i) {
+    if (macsEqual(deltaRefused_[i], mac)) return;
+  }
+  std::memcpy(deltaRefused_[deltaRefusedNext_], mac, 6);
+  deltaRefusedNext_ =
+      static_cast<uint8_t>((deltaRefusedNext_ + 1) % kDeltaRefusedRingSize);
+}
+
 void FirmwareDistributor::notePeerBackoff(const uint8_t mac[6], uint32_t nowMs,
                                           uint32_t durationMs,
                                           bool persistent) {
@@ -910,6 +1486,10 @@ void FirmwareDistributor::notePeerBackoff(const uint8_t mac[6], uint32_t nowMs,
 }
 
 void FirmwareDistributor::recordPeerFailure(uint32_t nowMs) {
+  if (groupSession_) {
+    penalizeMembers(nowMs, kPeerBackoffMs);
+    return;
+  }
   bool nonzero = false;
   for (int i = 0; i < 6; ++i) {
     if (targetMac_[i] != 0) { nonzero = true; break; }
@@ -918,6 +1498,10 @@ void FirmwareDistributor::recordPeerFailure(uint32_t nowMs) {
 }
 
 void FirmwareDistributor::recordPeerFailureFinalize(uint32_t nowMs) {
+  if (groupSession_) {
+    penalizeMembers(nowMs, kPeerFinalizeBackoffMs);
+    return;
+  }
   bool nonzero = false;
   for (int i = 0; i < 6; ++i) {
     if (targetMac_[i] != 0) { nonzero = true; break; }
@@ -925,6 +1509,17 @@ void FirmwareDistributor::recordPeerFailureFinalize(uint32_t nowMs) {
   if (nonzero) notePeerBackoff(targetMac_, nowMs, kPeerFinalizeBackoffMs);
 }
 
+void FirmwareDistributor::penalizeMembers(uint32_t nowMs, uint32_t durationMs) {
+  for (uint8_t i = 0; i < memberCount_; ++i) {
+    GroupMember& m = members_[i];
+    if (m.state != MemberState::Offered && m.state != MemberState::Accepted) {
+      continue;
+    }
+    m.state = MemberState::Failed;
+    notePeerBackoff(m.mac, nowMs, durationMs);
+  }
+}
+
 void FirmwareDistributor::recordPeerBlocklist(uint32_t nowMs) {
   bool nonzero = false;
   for (int i = 0; i < 6; ++i) {
@@ -956,17 +1551,32 @@ void FirmwareDistributor::emitOffer(const uint8_t targetMac[6],
   }
   std::memcpy(targetMac_, targetMac, 6);
   sessionOfferSeq_  = seqCounter_++;
+  const uint16_t offerSeq = sessionOfferSeq_;
+  memberCount_      = 0;
+  lateJoinEnd_      = 0;
+  if (groupSession_) {
+    GroupMember& lead = members_[memberCount_++];
+    std::memcpy(lead.mac, targetMac, 6);
+    lead.offerSeq     = offerSeq;
+    lead.offerRetries = 0;
+    lead.offeredMs    = nowMs;
+    lead.state        = MemberState::Offered;
+  }
   // Recomputed per session: sessionChunkSize_ (set just before this call, in
   // considerPeerForOta) can differ from the chunk size begin() assumed, so
-  // firmwareTotalChunks_ (that stale baseline count) isn't reused here.
+  // firmwareTotalChunks_ (that stale baseline count) isn't reused here. A
+  // delta session streams the patch out of the slot's tail; a packed one
+  // sends the units its plan counted.
+  sessionTotalLen_  = deltaSession_ ? deltaLen_ : firmwareTotalLen_;
+  sessionBase_      = deltaSession_ ? deltaOffset_ : 0;
   totalChunks_      = static_cast<uint16_t>(
-      (firmwareTotalLen_ + sessionChunkSize_ - 1) / sessionChunkSize_);
+      packSession_ ? packStarts_.size() - 1
+                   : (sessionTotalLen_ + sessionChunkSize_ - 1) / sessionChunkSize_);
   nextChunkIdx_     = 0;
   lastSentChunk_    = 0;
   lastSentMs_       = 0;
   currentChunkRetries_ = 0;
   sessionVersion_   = lamp::FIRMWARE_VERSION;
-  sessionTotalLen_  = firmwareTotalLen_;
   offerRetryCount_  = 0;
   lastOfferSendMs_  = nowMs;
   lastBurstSentChunks_ = 0;
@@ -988,7 +1598,7 @@ void FirmwareDistributor::emitOffer(const uint8_t targetMac[6],
   quietHoldUntilMs_ = 0;
   lastSessionValid_ = false;  // new session takes over the indicator
 
-  if (!sendOfferFrame(targetMac, nowMs, /*isRetry=*/false)) {
+  if (!sendOfferFrame(targetMac, offerSeq, nowMs, /*isRetry=*/false)) {
 #if defined(ARDUINO) || defined(ESP_PLATFORM)
     portENTER_CRITICAL(&stateMux_);
     resetSession();
@@ -1017,29 +1627,32 @@ void FirmwareDistributor::emitOffer(const uint8_t targetMac[6],
 }
 
 bool FirmwareDistributor::sendOfferFrame(const uint8_t targetMac[6],
-                                         uint32_t nowMs, bool isRetry) {
+                                         uint16_t offerSeq, uint32_t nowMs,
+                                         bool isRetry) {
   if (!transport_) return false;
 
-  uint16_t sessionOfferSeqLocal;
   uint32_t sessionVersionLocal;
   uint32_t sessionTotalLenLocal;
   uint16_t totalChunksLocal;
   uint16_t chunkSizeLocal;
+  bool     deltaLocal;
+  bool     packLocal;
   uint8_t  sha[8];
 #if defined(ARDUINO) || defined(ESP_PLATFORM)
   portENTER_CRITICAL(&stateMux_);
 #endif
-  sessionOfferSeqLocal = sessionOfferSeq_;
   sessionVersionLocal  = sessionVersion_;
   sessionTotalLenLocal = sessionTotalLen_;
   totalChunksLocal     = totalChunks_;
   chunkSizeLocal       = sessionChunkSize_;
+  deltaLocal           = deltaSession_;
+  packLocal            = packSession_;
   std::memcpy(sha, sha256Prefix_, 8);
 #if defined(ARDUINO) || defined(ESP_PLATFORM)
   portEXIT_CRITICAL(&stateMux_);
 #endif
 
-  uint8_t buf[lamp_protocol::FW_OFFER_AUTH_SIZE];
+  uint8_t buf[lamp_protocol::FW_OFFER_PACK_SIZE];
   const char* channel = lamp::FIRMWARE_CHANNEL_STR;
   const size_t channelLen = channel ? std::strlen(channel) : 0;
   // Firmware and FS OTA both emit the auth trailer (digest + signature) once
@@ -1048,8 +1661,8 @@ bool FirmwareDistributor::sendOfferFrame(const uint8_t targetMac[6],
   // legacy trailerless OFFER.
   const uint8_t* digestArg = authReady_ ? sha256Full_ : nullptr;
   const uint8_t* sigArg    = authReady_ ? imageSignature_ : nullptr;
-  const size_t n = lamp_protocol::buildFwOffer(
-      buf, sizeof(buf), sessionOfferSeqLocal,
+  size_t n = lamp_protocol::buildFwOffer(
+      buf, sizeof(buf), offerSeq,
       cachedSrcMac_, targetMac,
       sessionVersionLocal, sessionTotalLenLocal, chunkSizeLocal,
       channel, channelLen,
@@ -1057,6 +1670,15 @@ bool FirmwareDistributor::sendOfferFrame(const uint8_t targetMac[6],
       targetProtocolVersion_,
       fsHooks_ ? fsHooks_->offerType : lamp_protocol::MSG_FW_OFFER,
       digestArg, sigArg);
+  // A delta session's OFFER names the image it rebuilds and the base it
+  // rebuilds it from; the fields above then describe the patch.
+  if (n && deltaLocal) {
+    n = lamp_protocol::appendFwOfferDelta(buf, sizeof(buf), n, firmwareTotalLen_,
+                                          deltaBaseLen_, deltaBaseId_);
+  }
+  if (n && packLocal) {
+    n = lamp_protocol::appendFwOfferPack(buf, sizeof(buf), n, ota_pack::kFormat);
+  }
   if (!n) {
 #if defined(ARDUINO) || defined(ESP_PLATFORM)
     FWDIST_LOGLN("[fwdist] buildFwOffer failed");
@@ -1087,7 +1709,7 @@ bool FirmwareDistributor::sendOfferFrame(const uint8_t targetMac[6],
                 targetMac[0], targetMac[1], targetMac[2],
                 targetMac[3], targetMac[4], targetMac[5],
                 (unsigned long)sessionVersionLocal, (unsigned)totalChunksLocal,
-                (unsigned)sessionOfferSeqLocal);
+                (unsigned)offerSeq);
 #else
   (void)isRetry;
 #endif
@@ -1110,7 +1732,7 @@ void FirmwareDistributor::emitDone(uint32_t nowMs) {
   sessionVersionLocal  = sessionVersion_;
   sessionTotalLenLocal = sessionTotalLen_;
   std::memcpy(sha, sha256Prefix_, 8);
-  std::memcpy(targetMacLocal, targetMac_, 6);
+  streamTarget(targetMacLocal);
   seq = seqCounter_++;
 #if defined(ARDUINO) || defined(ESP_PLATFORM)
   portEXIT_CRITICAL(&stateMux_);
@@ -1201,14 +1823,21 @@ void FirmwareDistributor::onAccept(const lamp_protocol::ParsedFwAccept& a,
   bool wake = false;
   bool logAccept = false;
   bool logBackoff = false;
+  bool logDeltaDecline = false;
   uint8_t logStatus = 0;
 #if defined(ARDUINO) || defined(ESP_PLATFORM)
   portENTER_CRITICAL(&stateMux_);
 #endif
-  if (state_ != State::OfferSent ||
-      !macsEqual(a.sourceMac, targetMac_) ||
-      a.offerSeq != sessionOfferSeq_ ||
-      a.version != sessionVersion_) {
+  // A group member answers its own OFFER (its own seq), and may answer after
+  // the stream has started.
+  GroupMember* member = groupSession_ ? findMember(a.sourceMac) : nullptr;
+  const bool answersOffer =
+      groupSession_
+          ? isInProgress() && member && member->state == MemberState::Offered &&
+                a.offerSeq == member->offerSeq
+          : state_ == State::OfferSent && macsEqual(a.sourceMac, targetMac_) &&
+                a.offerSeq == sessionOfferSeq_;
+  if (!answersOffer || a.version != sessionVersion_) {
     // Snapshot reasons under the mux for a consistent post-exit log.
     const uint8_t  logState        = static_cast<uint8_t>(state_);
     const bool     logMacMismatch  = !macsEqual(a.sourceMac, targetMac_);
@@ -1232,21 +1861,60 @@ void FirmwareDistributor::onAccept(const lamp_protocol::ParsedFwAccept& a,
 #endif
     return;
   }
-  if (a.status != lamp_protocol::FwAcceptStatus::Accept) {
+  if (a.status == lamp_protocol::FwAcceptStatus::DeclineDeltaBase) {
+    // The peer isn't on the patch's base after all. No backoff: the next
+    // consider offers it the full image.
+    logDeltaDecline = true;
+    noteDeltaRefused(a.sourceMac);
+    if (member) {
+      member->state = MemberState::Failed;
+      settleGroup(nowMs);
+    } else {
+      resetSession();
+      state_ = State::Failed;
+      stateEnteredMs_ = nowMs;
+    }
+  } else if (a.status != lamp_protocol::FwAcceptStatus::Accept) {
     logBackoff = true;
     logStatus = static_cast<uint8_t>(a.status);
     // Offers go only to peers read as behind; DeclineAlreadyCurrent from one
     // of them means it can't actually accept the local variant (a genuine
     // same-variant behind peer replies Accept). Block it instead of retrying
     // on a timer.
-    if (a.status == lamp_protocol::FwAcceptStatus::DeclineAlreadyCurrent) {
-      recordPeerBlocklist(nowMs);
+    const bool block =
+        a.status == lamp_protocol::FwAcceptStatus::DeclineAlreadyCurrent;
+    if (member) {
+      // One member out; the group carries on without it.
+      member->state = MemberState::Failed;
+      notePeerBackoff(member->mac, nowMs, block ? 0 : kPeerBackoffMs, block);
+      settleGroup(nowMs);
     } else {
-      recordPeerFailure(nowMs);
+      if (block) {
+        recordPeerBlocklist(nowMs);
+      } else {
+        recordPeerFailure(nowMs);
+      }
+      resetSession();
+      state_ = State::Failed;
+      stateEnteredMs_ = nowMs;
+    }
+  } else if (member) {
+    // Gathering members wait for tickGroup to start the stream. A member that
+    // accepts after it started has missed everything below the forward
+    // position; the drain replays that before DONE.
+    member->state = MemberState::Accepted;
+    logAccept = true;
+    if (state_ != State::OfferSent) {
+      const uint16_t forward =
+          resumeChunkIdx_ != 0 ? resumeChunkIdx_ : nextChunkIdx_;
+      if (forward > lateJoinEnd_) lateJoinEnd_ = forward;
+      if (state_ == State::Finalizing) {
+        state_ = State::Streaming;
+        stateEnteredMs_ = nowMs;
+        lastSentMs_ = nowMs;
+      }
+      wake = true;
     }
-    resetSession();
-    state_ = State::Failed;
-    stateEnteredMs_ = nowMs;
   } else {
     state_ = State::Streaming;
     stateEnteredMs_ = nowMs;
@@ -1265,8 +1933,11 @@ void FirmwareDistributor::onAccept(const lamp_protocol::ParsedFwAccept& a,
     FWDIST_LOGF("[fwdist] ACCEPT status=%u; backing off\n",
                   (unsigned)logStatus);
   }
+  if (logDeltaDecline) {
+    FWDIST_LOGLN("[fwdist] ACCEPT declined the delta base; full image next");
+  }
   if (logAccept) {
-    FWDIST_LOGF("[fwdist] ACCEPT from %02X:%02X:%02X:%02X:%02X:%02X; streaming\n",
+    FWDIST_LOGF("[fwdist] ACCEPT from %02X:%02X:%02X:%02X:%02X:%02X\n",
                   a.sourceMac[0], a.sourceMac[1], a.sourceMac[2],
                   a.sourceMac[3], a.sourceMac[4], a.sourceMac[5]);
   }
@@ -1275,6 +1946,7 @@ void FirmwareDistributor::onAccept(const lamp_protocol::ParsedFwAccept& a,
   (void)wake;
   (void)logAccept;
   (void)logBackoff;
+  (void)logDeltaDecline;
   (void)logStatus;
 #endif
 }
@@ -1284,15 +1956,20 @@ void FirmwareDistributor::onReq(const lamp_protocol::ParsedFwReq& r,
   bool wake = false;
   bool log = false;
   bool abort = false;
+  // A group serves every member from one hole queue, so a run REQ joins it as
+  // the mask of its run.
+  uint8_t runMask[lamp_protocol::FW_REQ_MASK_MAX_BYTES] = {0};
+  const uint8_t* mask = r.mask;
+  size_t maskLen = r.maskLen;
 #if defined(ARDUINO) || defined(ESP_PLATFORM)
   portENTER_CRITICAL(&stateMux_);
 #endif
   if ((state_ != State::Streaming && state_ != State::Finalizing) ||
-      !macsEqual(r.sourceMac, targetMac_) ||
+      !isStreamPeer(r.sourceMac) ||
       r.firstChunkIdx >= totalChunks_) {
     // Snapshot reasons under the mux for a consistent post-exit log.
     const uint8_t  logState         = static_cast<uint8_t>(state_);
-    const bool     logMacMismatch   = !macsEqual(r.sourceMac, targetMac_);
+    const bool     logMacMismatch   = !isStreamPeer(r.sourceMac);
     const bool     logIdxOob        = r.firstChunkIdx >= totalChunks_;
 #if defined(ARDUINO) || defined(ESP_PLATFORM)
     portEXIT_CRITICAL(&stateMux_);
@@ -1327,22 +2004,56 @@ void FirmwareDistributor::onReq(const lamp_protocol::ParsedFwReq& r,
     return;
   }
   ++reqCountThisSession_;
-  // Smart rewind: save the forward-progress position in resumeChunkIdx_ so the
-  // streaming task can jump back to forward emit after serving the requested
-  // chunks, instead of re-streaming everything from firstChunkIdx the receiver
-  // already has. Saved only on the FIRST rewind after a forward run.
-  const uint16_t newReqEnd = r.firstChunkIdx + r.chunkCount;
-  if (resumeChunkIdx_ == 0 &&
-      nextChunkIdx_ > newReqEnd) {
-    resumeChunkIdx_ = nextChunkIdx_;
-    reqEndIdx_      = newReqEnd;
-  } else if (resumeChunkIdx_ != 0 && newReqEnd > reqEndIdx_) {
-    // Stacked REQ during an in-flight rewind: extend the window end so the
-    // jump-forward waits for the new REQ's tail, otherwise the gap between
-    // ranges gets re-REQ'd by the receiver's stall watchdog.
-    reqEndIdx_ = newReqEnd;
-  }
-  nextChunkIdx_        = r.firstChunkIdx;
+  if (groupSession_ && maskLen == 0) {
+    const size_t run = r.chunkCount < lamp_protocol::FW_REQ_MASK_MAX_CHUNKS
+                           ? r.chunkCount
+                           : lamp_protocol::FW_REQ_MASK_MAX_CHUNKS;
+    for (size_t i = 0; i < run; ++i) {
+      runMask[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+    }
+    mask    = runMask;
+    maskLen = (run + 7) / 8;
+  }
+  // Exact-hole REQ: queue just the chunks the mask names below the forward
+  // position (later ones are still coming in order) and serve those, replacing
+  // any earlier mask since the newest one is the receiver's current view. The
+  // stream then jumps straight back to the forward position. A mask with
+  // nothing left to serve falls through to the run path. A group merges every
+  // member's mask into the queue instead, and a merge into a queue already in
+  // service leaves the cursor where it is.
+  const uint16_t forward = resumeChunkIdx_ != 0 ? resumeChunkIdx_ : nextChunkIdx_;
+  const bool wasQueued = reqHoles_.active();
+  const bool queued =
+      maskLen != 0 &&
+      (groupSession_
+           ? reqHoles_.merge(r.firstChunkIdx, mask, maskLen, forward, totalChunks_)
+           : reqHoles_.load(r.firstChunkIdx, mask, maskLen, forward, totalChunks_));
+  if (queued) {
+    if (!groupSession_ || !wasQueued) {
+      resumeChunkIdx_ = forward;
+      reqEndIdx_      = 0;
+      nextChunkIdx_   = reqHoles_.front();
+    }
+  } else if (!groupSession_) {
+    reqHoles_.clear();
+    // Smart rewind: save the forward-progress position in resumeChunkIdx_ so
+    // the streaming task can jump back to forward emit after serving the
+    // requested chunks, instead of re-streaming everything from firstChunkIdx
+    // the receiver already has. Saved only on the FIRST rewind after a forward
+    // run.
+    const uint16_t newReqEnd = r.firstChunkIdx + r.chunkCount;
+    if (resumeChunkIdx_ == 0 &&
+        nextChunkIdx_ > newReqEnd) {
+      resumeChunkIdx_ = nextChunkIdx_;
+      reqEndIdx_      = newReqEnd;
+    } else if (resumeChunkIdx_ != 0 && newReqEnd > reqEndIdx_) {
+      // Stacked REQ during an in-flight rewind: extend the window end so the
+      // jump-forward waits for the new REQ's tail, otherwise the gap between
+      // ranges gets re-REQ'd by the receiver's stall watchdog.
+      reqEndIdx_ = newReqEnd;
+    }
+    nextChunkIdx_ = r.firstChunkIdx;
+  }
   currentChunkRetries_ = 0;
   lastSentMs_          = nowMs;
   if (state_ == State::Finalizing) {
@@ -1351,12 +2062,15 @@ void FirmwareDistributor::onReq(const lamp_protocol::ParsedFwReq& r,
   }
   wake = true;
   log  = true;
+  const uint16_t logHoles = reqHoles_.remaining();
 #if defined(ARDUINO) || defined(ESP_PLATFORM)
   portEXIT_CRITICAL(&stateMux_);
 
   if (log) {
-    FWDIST_LOGF("[fwdist] REQ first=%u count=%u reason=%u; rewinding (%u/%u)\n",
+    FWDIST_LOGF("[fwdist] REQ first=%u count=%u holes=%u reason=%u; "
+                "rewinding (%u/%u)\n",
                   (unsigned)r.firstChunkIdx, (unsigned)r.chunkCount,
+                  (unsigned)logHoles,
                   (unsigned)static_cast<uint8_t>(r.reason),
                   (unsigned)reqCountThisSession_,
                   (unsigned)kMaxReqPerSession);
@@ -1366,6 +2080,7 @@ void FirmwareDistributor::onReq(const lamp_protocol::ParsedFwReq& r,
   (void)wake;
   (void)log;
   (void)abort;
+  (void)logHoles;
 #endif
 }
 
@@ -1379,9 +2094,15 @@ void FirmwareDistributor::onResult(const lamp_protocol::ParsedFwResult& r,
 #if defined(ARDUINO) || defined(ESP_PLATFORM)
   portENTER_CRITICAL(&stateMux_);
 #endif
-  if (state_ != State::Finalizing ||
-      !macsEqual(r.sourceMac, targetMac_) ||
-      r.version != sessionVersion_) {
+  // A group member can verify while another member's REQ has the stream
+  // back in Streaming.
+  GroupMember* member = groupSession_ ? findMember(r.sourceMac) : nullptr;
+  const bool fromPeer =
+      groupSession_
+          ? (state_ == State::Streaming || state_ == State::Finalizing) &&
+                member && member->state == MemberState::Accepted
+          : state_ == State::Finalizing && macsEqual(r.sourceMac, targetMac_);
+  if (!fromPeer || r.version != sessionVersion_) {
 #if defined(ARDUINO) || defined(ESP_PLATFORM)
     portEXIT_CRITICAL(&stateMux_);
 #endif
@@ -1390,19 +2111,32 @@ void FirmwareDistributor::onResult(const lamp_protocol::ParsedFwResult& r,
   const uint8_t status = static_cast<uint8_t>(r.status);
   std::memcpy(logMac, r.sourceMac, 6);
   if (status == static_cast<uint8_t>(lamp_protocol::FwResultStatus::Success)) {
-    captureLastSession();
-    resetSession();
-    state_ = State::Done;
-    stateEnteredMs_ = nowMs;
+    if (member) {
+      member->state = MemberState::Succeeded;
+      settleGroup(nowMs);
+    } else {
+      captureLastSession();
+      resetSession();
+      state_ = State::Done;
+      stateEnteredMs_ = nowMs;
+    }
     logSuccess = true;
   } else {
     logFailure = true;
     logStatus = status;
     logDetail = r.detail;
-    recordPeerFailure(nowMs);
-    resetSession();
-    state_ = State::Failed;
-    stateEnteredMs_ = nowMs;
+    // A failed delta (a bad patch, say) is retried with the full image.
+    if (deltaSession_) noteDeltaRefused(r.sourceMac);
+    if (member) {
+      member->state = MemberState::Failed;
+      notePeerBackoff(member->mac, nowMs, kPeerBackoffMs);
+      settleGroup(nowMs);
+    } else {
+      recordPeerFailure(nowMs);
+      resetSession();
+      state_ = State::Failed;
+      stateEnteredMs_ = nowMs;
+    }
   }
 #if defined(ARDUINO) || defined(ESP_PLATFORM)
   portEXIT_CRITICAL(&stateMux_);
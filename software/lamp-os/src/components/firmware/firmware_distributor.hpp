@@ -15,16 +15,18 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <vector>
 
+#include "components/firmware/ota_pack.hpp"
+#include "components/firmware/req_holes.hpp"
 #include "components/network/protocol/fw_ota.hpp"  // FW_CHUNK_SIZE_BASELINE/_MAX
+#include "util/high_water.hpp"
 
 #if defined(ARDUINO) || defined(ESP_PLATFORM)
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
 #include <freertos/task.h>
 #include <esp_partition.h>
-
-#include "util/high_water.hpp"
 #endif
 
 namespace lamp_protocol {
@@ -53,6 +55,7 @@ struct FsDistributorHooks {
   uint8_t offerType;
   uint8_t chunkType;
   uint8_t doneType;
+  uint8_t repairType;
 };
 
 class FirmwareDistributor {
@@ -107,12 +110,27 @@ class FirmwareDistributor {
   // the peer reports otaState receiving, or some roster peer reports sending to
   // it. The caller computes it from the roster; the offer is skipped so
   // concurrent senders don't stomp a legacy receiver's erase+accept.
+  // peerCaps is the peer's HELLO caps: HELLO_CAP_FW_REQ_BITMAP means it REQs
+  // exact holes, so the session streams at kStreamingChunkSpacingMaskMs;
+  // HELLO_CAP_FW_FEC means it decodes repair rows, so each finished block of
+  // chunks is followed by its ota_fec::kRowsPerWindow rows per window (only
+  // in LAMP_OTA_FEC builds; see kOtaFecCap).
+  // HELLO_CAP_FW_GROUP on the first peer makes the session a group: while its
+  // OFFERs are out, further group-capable peers with the same wire version,
+  // REQ form and FEC cap (and room for the session chunk size) that pass the
+  // same gates join it with an OFFER of their own.
+  // HELLO_CAP_FW_DELTA on a peer at the base version of the patch this lamp
+  // holds (see discoverDeltaPatch) makes the session stream that patch instead
+  // of the image; a group then only takes peers that qualify the same way.
+  // HELLO_CAP_FW_PACKED makes each chunk an ota_pack unit (no repair rows);
+  // a packed group only takes peers that set it too.
   void considerPeerForOta(const uint8_t peerMac[6], uint32_t peerVersion,
                           uint8_t peerProtocolVersion, uint32_t nowMs,
                           const char* peerFwChannel = nullptr,
                           uint16_t peerMaxChunk = 0,
                           int8_t peerRssi = -127,
-                          bool peerBeingServed = false);
+                          bool peerBeingServed = false,
+                          uint8_t peerCaps = 0);
 
   // Inbound packet hooks: mesh_link dispatches MSG_FW_ACCEPT/REQ/RESULT
   // from its WiFi recv task. Idempotent on irrelevant packets (wrong target
@@ -128,6 +146,12 @@ class FirmwareDistributor {
   // isn't rejected before the reaping tick runs.
   bool isInProgress() const;
 
+  // True while a group session is still admitting members (OfferSent). The
+  // social scan keeps calling considerPeerForOta through it.
+  bool isGathering() const {
+    return state_ == State::OfferSent && groupSession_;
+  }
+
   // Snapshot the active OTA target's MAC into out[6]. True while mid-flow. Used
   // by the OTA indicator to look up the receiver's base color from LampRoster.
   bool getPeerMac(uint8_t out[6]) const {
@@ -155,6 +179,11 @@ class FirmwareDistributor {
   // drain the TX queue. Below ~15ms the ESP-NOW RX queue overruns under RF
   // loss and burst density drives LED flicker. Sender-side only.
   static constexpr uint32_t kStreamingChunkSpacingMs   = 30;
+  // Toward an exact-hole peer. The run REQ re-sends every chunk between a
+  // session's first and last hole, so its duplicate load grows with the loss
+  // a tighter cadence brings; the hole mask costs one frame per lost chunk
+  // and leaves the margin to run closer to the overrun floor.
+  static constexpr uint32_t kStreamingChunkSpacingMaskMs = 20;
   static constexpr uint32_t kStreamingQueueBackoffMs   = 5;
   // Sized for the partition-read + esp_now_send call chain (plus the first
   // Streaming step's radio teardown). streamOneChunk's two max-size chunk
@@ -165,6 +194,11 @@ class FirmwareDistributor {
   static constexpr uint32_t kStreamingTaskPriority     = 5;
   // Re-check state this often in case a wake give was lost.
   static constexpr uint32_t kStreamingIdlePollMs       = 250;
+  // Pack plans are built on the streaming task a few units at a time (each
+  // one a sector read plus an encode), with a rest between slices, so the
+  // task never holds the CPU from the loop for long.
+  static constexpr size_t   kPackPlanUnitsPerStep      = 4;
+  static constexpr uint32_t kPackPlanStepMs            = 20;
   static constexpr uint16_t kStreamProgressLogEvery    = 256;
   // OFFER retry. ESP-NOW unicast over a BLE-coex'd radio drops ~50% of initial
   // OFFER attempts at the MAC layer; resend reusing sessionOfferSeq_ so the
@@ -191,21 +225,69 @@ class FirmwareDistributor {
   // Per-session REQ budget. Far above any reasonable peer's amplification, so
   // the receiver's 10-min hard cap (not this) bounds a stuck session.
   static constexpr uint16_t kMaxReqPerSession   = 4096;
+  // Group sessions: CHUNK/REPAIR/DONE go once to fwGroupMac(ours) for every
+  // member. Streaming starts once a member has accepted, kGroupGatherMs has
+  // passed since the first OFFER, and no member's OFFER retries are still
+  // running; a member accepting after that gets the chunks it missed replayed
+  // once the forward pass is out. One receiver's REQs and RESULT settle only
+  // that receiver.
+  static constexpr uint8_t  kMaxGroupMembers    = 8;
+  static constexpr uint32_t kGroupGatherMs      = 3000;
 
  private:
   void emitOffer(const uint8_t targetMac[6], uint32_t peerVersion, uint32_t nowMs);
   // Build + send OFFER frame from current session state (initial + retries).
-  // Returns false on build/send failure.
-  bool sendOfferFrame(const uint8_t targetMac[6], uint32_t nowMs, bool isRetry);
+  // offerSeq is the target's: sessionOfferSeq_, or its group member's own (all
+  // OTA frames are broadcast on air, so a shared seq would let the OFFER to
+  // one member dedup the next member's). Returns false on build/send failure.
+  bool sendOfferFrame(const uint8_t targetMac[6], uint16_t offerSeq,
+                      uint32_t nowMs, bool isRetry);
   void emitDone(uint32_t nowMs);
 
+  // Group session member. The lead (targetMac_) is members_[0].
+  enum class MemberState : uint8_t { Offered = 0, Accepted, Succeeded, Failed };
+  struct GroupMember {
+    uint8_t     mac[6];
+    uint16_t    offerSeq;
+    uint8_t     offerRetries;
+    uint32_t    offeredMs;
+    MemberState state;
+  };
+  // Admits a peer to the gathering group session and sends its OFFER. No-op
+  // when it doesn't fit the session (see considerPeerForOta).
+  void joinGroup(const uint8_t peerMac[6], uint32_t peerVersion,
+                 uint8_t peerProtocolVersion, uint16_t peerMaxChunk,
+                 uint8_t peerCaps, uint32_t nowMs);
+  GroupMember* findMember(const uint8_t mac[6]);
+  // Where CHUNK/REPAIR/DONE go: the group MAC, or the single peer. Caller
+  // holds the mux.
+  void streamTarget(uint8_t out[6]) const;
+  // The peer may REQ this session: the single peer, or an accepted member.
+  bool isStreamPeer(const uint8_t mac[6]);
+  // Group bookkeeping under the mux, from tick: drops members whose ACCEPT
+  // window passed and starts streaming once the gather is over.
+  // Returns true to wake the streaming task.
+  bool tickGroup(uint32_t nowMs);
+  // Ends the group session once no member is left waiting or streaming: Done
+  // if any succeeded, else Failed. Returns true if it ended.
+  bool settleGroup(uint32_t nowMs);
+
+  // Backs off the session peer, or every unresolved member of a group.
   void recordPeerFailure(uint32_t nowMs);
   void recordPeerFailureFinalize(uint32_t nowMs);
+  void penalizeMembers(uint32_t nowMs, uint32_t durationMs);
   // An offered peer replying already-current contradicts the below-version
   // read of it; that mismatch is the cross-variant tell (same-variant behind
   // peers reply Accept), so block it for the rest of the session instead of
   // the usual timed backoff.
   void recordPeerBlocklist(uint32_t nowMs);
+  // A peer takes the delta patch: one is held, the peer advertised
+  // HELLO_CAP_FW_DELTA at the patch's base version, and it hasn't refused one.
+  bool deltaFor(const uint8_t mac[6], uint32_t peerVersion,
+                uint8_t peerCaps) const;
+  // Remembers a peer that declined or failed a delta session, so the next
+  // OFFER to it is the full image.
+  void noteDeltaRefused(const uint8_t mac[6]);
   void resetSession();
   // Snapshot the just-completed peer + total for the indicator's inter-session
   // hold. Call on the Done transition under stateMux_ before resetSession()
@@ -234,13 +316,36 @@ class FirmwareDistributor {
   // One inner-loop iteration: send one OFFER retry if due, OR one chunk if
   // streaming. Returns false to put the task back on the wake semaphore.
   bool        streamingTaskStep(uint32_t nowMs);
+  // OfferSent step of a group session: one retry to every member whose OFFER
+  // is due. Same return as streamingTaskStep.
+  bool        groupOfferStep(uint32_t nowMs);
   // Single-chunk emit. Returns 0 = sent, advance; 1 = NO_MEM, back off + retry
   // same chunk; 2 = partition read failure, session aborted in-place.
   int         streamOneChunk(uint32_t nowMs);
+  // Single repair-row emit for the block the stream just finished, same
+  // return codes. The row is re-encoded from the partition per frame, so the
+  // encoder holds one row, not a block's worth.
+  int         streamOneRepair(uint32_t nowMs);
   // Wake the streaming task. Safe from recv task + tick().
   void        wakeStreamingTask();
+  // Delay after each chunk for the active session's peer.
+  uint32_t    chunkSpacingMs() const {
+    return reqMaskPeer_ ? kStreamingChunkSpacingMaskMs : kStreamingChunkSpacingMs;
+  }
   // Signed length of the running image into outLen. False if no valid footer.
   bool        discoverImageLength(uint32_t* outLen) const;
+  // Looks for a delta patch (ota_delta.hpp) in the running slot's tail that
+  // rebuilds the running image, left there by the delta OTA that installed
+  // it or written over USB. Sets the delta* fields; false when there is none.
+  bool        discoverDeltaPatch();
+  // True when packStarts_ holds the plan for the stream at [base, base + len)
+  // at sessionChunkSize_. Otherwise asks the streaming task to build it and
+  // returns false, and the session goes raw. Loop task, Idle only: that is
+  // when a finished build is adopted into packStarts_.
+  bool        packPlanFor(uint32_t base, uint32_t len);
+  // Streaming task: packs the next slice of the wanted plan into packBuild_.
+  // True while more of it remains.
+  bool        packPlanStep();
 #endif
 
   // Peer backoff ring.
@@ -301,6 +406,58 @@ class FirmwareDistributor {
   // instead of re-streaming everything the receiver already has. 0 = no rewind.
   uint16_t resumeChunkIdx_         = 0;
   uint16_t reqEndIdx_              = 0;
+  // Exact-hole REQ in service: the chunks its mask named, re-sent in order
+  // before the stream jumps back to resumeChunkIdx_. Empty for run REQs.
+  ReqHoleQueue reqHoles_;
+  // Session peer advertised HELLO_CAP_FW_REQ_BITMAP (set with the chunk size
+  // in considerPeerForOta).
+  bool     reqMaskPeer_            = false;
+  // Session peer advertised HELLO_CAP_FW_FEC. fecNext_ is the first chunk the
+  // forward stream hasn't sent yet (rewinds don't move it); crossing a block
+  // boundary queues fecRowsDue_ repair rows for the block at fecBlock_, sent
+  // ahead of the next chunk.
+  bool     fecPeer_                = false;
+  uint16_t fecNext_                = 0;
+  uint16_t fecBlock_               = 0;
+  uint8_t  fecLanes_               = 0;
+  uint8_t  fecRowsDue_             = 0;
+  uint8_t  fecRowsSent_            = 0;
+  // First peer advertised HELLO_CAP_FW_GROUP (set with the chunk size in
+  // considerPeerForOta). members_ holds every receiver of the session.
+  // lateJoinEnd_ is the forward position when the latest late member
+  // accepted: [0, lateJoinEnd_) is replayed before DONE. 0 = none.
+  bool     groupSession_           = false;
+  GroupMember members_[kMaxGroupMembers] = {};
+  uint8_t  memberCount_            = 0;
+  uint16_t lateJoinEnd_            = 0;
+  // Session streams the delta patch (set with the chunk size in
+  // considerPeerForOta): sessionTotalLen_ is the patch length, read from
+  // sessionBase_ in the running slot. sessionBase_ is 0 for the image.
+  bool     deltaSession_           = false;
+  uint32_t sessionBase_            = 0;
+  // Session streams ota_pack units (set with the chunk size in
+  // considerPeerForOta): chunk i carries [packStarts_[i], packStarts_[i+1])
+  // of the session stream, so totalChunks_ is packStarts_.size() - 1. The
+  // plan outlives the session, keyed by the stream and chunk size it was made
+  // for (~4 bytes a unit, ~3.7 KB for a 1.5 MB image at the max chunk size).
+  bool     packSession_            = false;
+  std::vector<uint32_t> packStarts_;
+  uint32_t packPlanBase_           = 0;
+  uint32_t packPlanLen_            = 0;
+  uint16_t packPlanChunkSize_      = 0;
+  // The plan being built. packWant* names it (posted by packPlanFor, 0 chunk
+  // size = none). The streaming task owns packBuild* until it sets
+  // packBuildDone_, then packPlanFor owns them until it adopts the result and
+  // clears it. packWant* and packBuildDone_ are under stateMux_.
+  uint32_t packWantBase_           = 0;
+  uint32_t packWantLen_            = 0;
+  uint16_t packWantChunkSize_      = 0;
+  bool     packBuildDone_          = false;
+  std::vector<uint32_t> packBuild_;
+  uint32_t packBuildBase_          = 0;
+  uint32_t packBuildLen_           = 0;
+  uint16_t packBuildChunkSize_     = 0;
+  uint32_t packBuildPos_           = 0;
 
   // First 8 bytes of SHA-256(signed region), computed once in begin() and
   // reused across every OFFER + DONE.
@@ -318,6 +475,19 @@ class FirmwareDistributor {
   uint32_t firmwareTotalLen_   = 0;
   uint16_t firmwareTotalChunks_ = 0;
   uint8_t  cachedSrcMac_[6]    = {0};
+  // Delta patch held in the running slot's tail (discoverDeltaPatch): deltaLen_
+  // bytes at deltaOffset_, rebuilding this image from the one identified by
+  // deltaBaseVersion_ / deltaBaseLen_ / deltaBaseId_.
+  bool     deltaReady_         = false;
+  uint32_t deltaLen_           = 0;
+  uint32_t deltaOffset_        = 0;
+  uint32_t deltaBaseVersion_   = 0;
+  uint32_t deltaBaseLen_       = 0;
+  uint8_t  deltaBaseId_[lamp_protocol::FW_DELTA_BASE_ID_LEN] = {0};
+  // Peers that refused a delta (noteDeltaRefused). Oldest entry overwritten.
+  static constexpr size_t kDeltaRefusedRingSize = 8;
+  uint8_t  deltaRefused_[kDeltaRefusedRingSize][6] = {};
+  uint8_t  deltaRefusedNext_   = 0;
 
 #if defined(ARDUINO) || defined(ESP_PLATFORM)
   // Guards all session state shared between recv task (Core 0), loop task
@@ -334,6 +504,10 @@ class FirmwareDistributor {
   static uint8_t              s_streamerCount;
   static SemaphoreHandle_t    s_sharedWake;
   static TaskHandle_t         s_sharedTask;
+  // Unit encoder scratch for the shared streaming task, which both plans and
+  // streams packed units. Allocated with the first plan slice and kept
+  // (~9.6 KB).
+  static ota_pack::Workspace* s_packWorkspace;
 #endif
 
   PeerPenalty penalties_[kPenaltyRingSize] = {};
@@ -7,7 +7,9 @@
 #include "firmware_signature.hpp"
 #include "components/network/protocol/fw_ota.hpp"
 #include "components/network/ble/ble_control.hpp"  // pauseRadioForOta / resumeRadioAfterOta
+#include "components/firmware/ota_delta.hpp"
 #include "components/firmware/ota_quiet_mode.hpp"     // enterQuiet / exitQuiet
+#include "components/firmware/req_holes.hpp"
 #include "components/network/mesh/mesh_link.hpp"
 #include "util/heap_probe.hpp"
 #include "../../version.hpp"
@@ -140,6 +142,11 @@ void FirmwareReceiver::tick(uint32_t nowMs) {
         std::vector<uint8_t>().swap(bitmap_);
         bitmapTotalChunks_ = 0;
       }
+      if (!repairBuf_.empty()) {
+        std::vector<uint8_t>().swap(repairBuf_);
+        repairPool_.clear();
+      }
+      if (!packBuf_.empty()) std::vector<uint8_t>().swap(packBuf_);
       return;
     case State::Apply:
       return;
@@ -161,7 +168,8 @@ void FirmwareReceiver::tick(uint32_t nowMs) {
       }
 
       // No per-chunk erase: the image region was erased upfront in
-      // onOfferOnLoop. Lost chunks converge via REQs.
+      // onOfferOnLoop. Lost chunks converge via repairs, then REQs.
+      decodeRepairsOnLoop();
 #endif
       // Hard cap on the whole Accepted -> DONE window. On exceed, abort and
       // report PartitionWriteFail with sentinel detail 0xFE so the wisp can
@@ -349,6 +357,34 @@ void FirmwareReceiver::onOfferOnLoop(const PendingFirmwareControl& ctrl,
     return;
   }
 
+  // A delta OFFER is only good against the image it was built from. Decline
+  // with DeclineDeltaBase so the distributor falls back to the full image.
+  uint32_t patchOffset = 0;
+  if (ctrl.offer.isDelta && !deltaBaseOk(ctrl, patchOffset)) {
+#ifdef LAMP_DEBUG
+    Serial.printf("[fw_receiver] delta OFFER v=0x%08X base len=%u not ours "
+                  "or no room, declining\n",
+                  (unsigned)ctrl.offer.version, (unsigned)ctrl.offer.deltaBaseLen);
+#endif
+    sendAccept(ctrl, lamp_protocol::FwAcceptStatus::DeclineDeltaBase);
+    return;
+  }
+
+  // A packed OFFER needs a format this build decodes and chunks big enough to
+  // carry a unit. Over BLE the trailer is ignored and chunks are raw.
+  const bool packed = ctrl.transportKind == FirmwareTransportKind::EspNow &&
+                      ctrl.offer.packFormat != 0;
+  if (packed && (ctrl.offer.packFormat != ota_pack::kFormat ||
+                 ctrl.offer.chunkSize < ota_pack::kMinChunkSize)) {
+#ifdef LAMP_DEBUG
+    Serial.printf("[fw_receiver] packed OFFER format=%u chunkSize=%u "
+                  "unsupported, declining\n",
+                  (unsigned)ctrl.offer.packFormat, (unsigned)ctrl.offer.chunkSize);
+#endif
+    sendAccept(ctrl, lamp_protocol::FwAcceptStatus::DeclineBusy);
+    return;
+  }
+
   // Begin a new OTA flow. Erase the entire image region synchronously here on
   // Core 1 before arming the gate or sending ACCEPT, so the recv path is a pure
   // write. Order matters: snapshot all OFFER fields into members first (Core 0
@@ -365,11 +401,19 @@ void FirmwareReceiver::onOfferOnLoop(const PendingFirmwareControl& ctrl,
   activeTransportKind_ = ctrl.transportKind;
   activeBleConnHandle_ = ctrl.bleConnHandle;
   activeWireVersion_   = ctrl.wireVersion;
+  reqMask_ = ctrl.transportKind == FirmwareTransportKind::EspNow &&
+             (ctrl.peerCaps & lamp_protocol::HELLO_CAP_FW_REQ_BITMAP) != 0;
+  pack_ = packed;
+  fec_ = ctrl.transportKind == FirmwareTransportKind::EspNow &&
+         (ctrl.peerCaps & lamp_protocol::kOtaFecCap) != 0 && !pack_;
   offerVersion_       = ctrl.offer.version;
   offerTotalLen_      = ctrl.offer.totalLen;
   offerChunkSize_     = ctrl.offer.chunkSize;
   std::memcpy(offerDigest_, ctrl.offer.digest,
               lamp_protocol::FW_SHA256_FULL_LEN);
+  delta_         = ctrl.offer.isDelta;
+  deltaImageLen_ = delta_ ? ctrl.offer.deltaImageLen : 0;
+  streamBase_    = delta_ ? patchOffset : 0;
 
   // Reject oversized offers before any allocation. totalLen is unauthenticated
   // (ed25519 signs the image digest, not the OFFER header), so a bogus large
@@ -389,20 +433,45 @@ void FirmwareReceiver::onOfferOnLoop(const PendingFirmwareControl& ctrl,
   // (totalLen, chunkSize) ratio is unauthenticated too, so bound the chunk count
   // before allocating or truncating: a replayed chunkSize=1 / totalLen=4MB OFFER
   // implies 4M chunks and a ~512KB bitmap alloc that aborts the lamp.
+  // A packed session's unit count only the sender knows, so it takes the wire
+  // totalChunks, bounded by the count units of at least chunkSize - kSlack
+  // bytes would need. A mutated count costs the session, not the lamp.
   uint32_t expectedChunks = 0;
-  if (!lamp_protocol::offerChunkCountOk(offerTotalLen_, offerChunkSize_,
-                                        expectedChunks)) {
+  const uint16_t minChunkLen =
+      pack_ ? static_cast<uint16_t>(offerChunkSize_ - ota_pack::kSlack)
+            : offerChunkSize_;
+  if (!lamp_protocol::offerChunkCountOk(offerTotalLen_, minChunkLen,
+                                        expectedChunks) ||
+      (pack_ && (ctrl.offer.totalChunks == 0 ||
+                 ctrl.offer.totalChunks > expectedChunks))) {
 #ifdef LAMP_DEBUG
     Serial.printf("[fw_receiver] OFFER chunk-count reject: totalLen=%u "
-                  "chunkSize=%u, declining\n",
-                  (unsigned)offerTotalLen_, (unsigned)offerChunkSize_);
+                  "chunkSize=%u totalChunks=%u packed=%d, declining\n",
+                  (unsigned)offerTotalLen_, (unsigned)offerChunkSize_,
+                  (unsigned)ctrl.offer.totalChunks, (int)pack_);
 #endif
     sendAccept(ctrl, lamp_protocol::FwAcceptStatus::DeclineBusy);
     return;
   }
+  if (pack_) expectedChunks = ctrl.offer.totalChunks;
   offerTotalChunks_ = static_cast<uint16_t>(expectedChunks);
 
   resetBitmap(expectedChunks);
+  // Repair slots for an FEC source (~13 KB at the max chunk size), sized off
+  // the same bounded chunkSize; the gate is disarmed, so Core 0 can't be in
+  // handleRepairOnRecvTask.
+  repairPool_.clear();
+  if (fec_) {
+    repairBuf_.assign(
+        (static_cast<size_t>(ota_fec::RepairPool::kSlots) + 1) * offerChunkSize_, 0);
+  } else {
+    std::vector<uint8_t>().swap(repairBuf_);
+  }
+  if (pack_) {
+    packBuf_.resize(ota_pack::kMaxSpan);
+  } else {
+    std::vector<uint8_t>().swap(packBuf_);
+  }
 
 #if defined(ARDUINO) || defined(ESP_PLATFORM)
   // Target partition: firmware -> the inactive OTA slot; FS -> the live spiffs
@@ -415,10 +484,14 @@ void FirmwareReceiver::onOfferOnLoop(const PendingFirmwareControl& ctrl,
     state_ = State::Failed;
     return;
   }
-  // The image (rounded up to a sector) must fit in the partition before erasing.
+  // The image (rounded up to a sector) must fit in the partition before
+  // erasing. A delta session erases the rebuilt image's region plus the
+  // sectors the patch lands in at the slot's tail (deltaBaseOk checked both
+  // fit without overlapping).
   const size_t kSector = SPI_FLASH_SEC_SIZE;
+  const size_t imageLen = delta_ ? deltaImageLen_ : offerTotalLen_;
   const size_t numSectors =
-      (static_cast<size_t>(offerTotalLen_) + kSector - 1u) / kSector;
+      (imageLen + kSector - 1u) / kSector;
   if (numSectors * kSector > part->size) {
     sendResult(lamp_protocol::FwResultStatus::OtaBeginFail, 0xFE);
     state_ = State::Failed;
@@ -445,15 +518,23 @@ void FirmwareReceiver::onOfferOnLoop(const PendingFirmwareControl& ctrl,
   {
     const uint32_t eraseT0 = millis();
     constexpr size_t kBlock = 64u * 1024u;
-    const size_t eraseLen = numSectors * kSector;  // sector-aligned, covers image
+    // Sector-aligned [from, end) spans: the image, then a delta's patch.
+    const size_t spans[2][2] = {
+        {0, numSectors * kSector},
+        {streamBase_ - streamBase_ % kSector, delta_ ? part->size : 0},
+    };
     esp_err_t eraseErr = ESP_OK;
     size_t eoff = 0;
-    while (eoff < eraseLen) {
-      const size_t span = (eraseLen - eoff) < kBlock ? (eraseLen - eoff) : kBlock;
-      widenIwdt();
-      eraseErr = esp_partition_erase_range(part, eoff, span);
+    for (const auto& range : spans) {
+      eoff = range[0];
+      while (eoff < range[1]) {
+        const size_t span = (range[1] - eoff) < kBlock ? (range[1] - eoff) : kBlock;
+        widenIwdt();
+        eraseErr = esp_partition_erase_range(part, eoff, span);
+        if (eraseErr != ESP_OK) break;
+        eoff += span;
+      }
       if (eraseErr != ESP_OK) break;
-      eoff += span;
     }
     widenIwdt();
     if (eraseErr != ESP_OK) {
@@ -570,6 +651,12 @@ void FirmwareReceiver::onDoneOnLoop(const PendingFirmwareControl& ctrl,
     state_ = State::Failed;
     return;
   }
+  // Rebuild whatever the held repairs cover before judging the bitmap; the
+  // last block's rows land just ahead of DONE.
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  while (decodeRepairsOnLoop()) {
+  }
+#endif
   // Bitmap not yet full: REQ the first missing run and stay in Streaming. The
   // sender fills the run and re-sends DONE.
   if (!isBitmapFull()) {
@@ -678,18 +765,6 @@ void FirmwareReceiver::handleChunkOnRecvTask(const lamp_protocol::ParsedFwChunk&
     lastChunkSeenMs_ = millis();
 #endif
   }
-  // offset + len must fit within the offer's totalLen, else a malformed chunk
-  // could direct esp_partition_write past the erased range. Compared without
-  // adding so an offset near UINT32_MAX can't wrap the sum under the bound.
-  if (p.offset > offerTotalLen_ || p.len > offerTotalLen_ - p.offset) {
-#ifdef LAMP_DEBUG
-    Serial.printf("[fw_receiver] chunk drop: oob chunkIdx=%u off=%u len=%u "
-                  "total=%u\n",
-                  (unsigned)p.chunkIdx, (unsigned)p.offset, (unsigned)p.len,
-                  (unsigned)offerTotalLen_);
-#endif
-    return;
-  }
   // Chunk size must match (last chunk may be shorter; intermediate must
   // be exactly offerChunkSize_).
   if (p.len > offerChunkSize_) {
@@ -698,13 +773,45 @@ void FirmwareReceiver::handleChunkOnRecvTask(const lamp_protocol::ParsedFwChunk&
                   "max=%u\n",
                   (unsigned)p.chunkIdx, (unsigned)p.len,
                   (unsigned)offerChunkSize_);
+#endif
+    return;
+  }
+  // A packed chunk is one ota_pack unit: decode it first, so the bound below
+  // and the write see the decoded run at the stream offset the chunk carries.
+  // Decoding a unit is tens of microseconds, well inside the chunk spacing.
+  const uint8_t* bytes = p.bytes;
+  size_t len = p.len;
+  if (pack_) {
+    size_t outLen = 0;
+    if (p.chunkIdx >= offerTotalChunks_ || packBuf_.empty() ||
+        !ota_pack::unpack(p.bytes, p.len, packBuf_.data(), packBuf_.size(),
+                          outLen)) {
+#ifdef LAMP_DEBUG
+      Serial.printf("[fw_receiver] chunk drop: bad unit chunkIdx=%u len=%u\n",
+                    (unsigned)p.chunkIdx, (unsigned)p.len);
+#endif
+      return;
+    }
+    bytes = packBuf_.data();
+    len   = outLen;
+  }
+  // offset + len must fit within the offer's totalLen, else a malformed chunk
+  // could direct esp_partition_write past the erased range. Compared without
+  // adding so an offset near UINT32_MAX can't wrap the sum under the bound.
+  if (p.offset > offerTotalLen_ || len > offerTotalLen_ - p.offset) {
+#ifdef LAMP_DEBUG
+    Serial.printf("[fw_receiver] chunk drop: oob chunkIdx=%u off=%u len=%u "
+                  "total=%u\n",
+                  (unsigned)p.chunkIdx, (unsigned)p.offset, (unsigned)len,
+                  (unsigned)offerTotalLen_);
 #endif
     return;
   }
   // offset == chunkIdx * offerChunkSize_ on every chunk (catches malformed
   // senders that disagree with themselves). Only the receiver holds the
   // session's negotiated chunkSize, so it validates this, not parseFwChunk.
-  if (p.offset != static_cast<uint32_t>(p.chunkIdx) * offerChunkSize_) {
+  // Packed units vary in span, so their offsets only answer to the bound.
+  if (!pack_ && p.offset != static_cast<uint32_t>(p.chunkIdx) * offerChunkSize_) {
 #ifdef LAMP_DEBUG
     Serial.printf("[fw_receiver] chunk drop: offset misaligned chunkIdx=%u "
                   "off=%u chunkSize=%u\n",
@@ -725,20 +832,27 @@ void FirmwareReceiver::handleChunkOnRecvTask(const lamp_protocol::ParsedFwChunk&
 #endif
 #if defined(ARDUINO) || defined(ESP_PLATFORM)
   // Paired with Core 1's release-store of publishedOtaHandle_, the partition
-  // pointer is valid here. Pure write: the region was erased upfront, and the
-  // write is bounded by the negotiated chunk size (up to FW_CHUNK_SIZE_MAX
-  // bytes). Each call holds cache/interrupts off for the write's duration,
-  // which scales with chunk size.
+  // pointer is valid here. Pure write: the region was erased upfront. Each
+  // call holds cache/interrupts off for the write's duration, which scales
+  // with its length, so every call is bounded by the negotiated chunk size
+  // (up to FW_CHUNK_SIZE_MAX bytes). A decoded packed unit spans up to a
+  // sector and goes down in chunk-size pieces, so the RX ISR gets in between
+  // them exactly as it does between raw chunks.
   const esp_partition_t* part =
       publishedPartition_.load(std::memory_order_relaxed);
   if (part == nullptr) return;
-  const esp_err_t err = esp_partition_write(part, p.offset, p.bytes, p.len);
-  if (err != ESP_OK) {
-    // Latch the write error for Core 1's stall watchdog. Don't send RESULT from
-    // Core 0: broadcastRaw isn't WiFi-task-safe (the dedup ring + send queue
-    // are Core 1 only). Core 1 sees the bitmap stop filling and the hard cap
-    // fires PartitionWriteFail.
-    return;
+  for (size_t done = 0; done < len;) {
+    const size_t piece = len - done < offerChunkSize_ ? len - done : offerChunkSize_;
+    const esp_err_t err =
+        esp_partition_write(part, streamBase_ + p.offset + done, bytes + done, piece);
+    if (err != ESP_OK) {
+      // Latch the write error for Core 1's stall watchdog. Don't send RESULT
+      // from Core 0: broadcastRaw isn't WiFi-task-safe (the dedup ring + send
+      // queue are Core 1 only). Core 1 sees the bitmap stop filling and the
+      // hard cap fires PartitionWriteFail.
+      return;
+    }
+    done += piece;
   }
 #endif
   // markChunkReceived takes eraseMux_ around the byte RMW; Core 1's
@@ -755,6 +869,124 @@ void FirmwareReceiver::handleChunkOnRecvTask(const lamp_protocol::ParsedFwChunk&
 #endif
 }
 
+void FirmwareReceiver::handleRepairOnRecvTask(
+    const lamp_protocol::ParsedFwRepair& r) {
+  // Same gate + source rule as a chunk. No flash IO here, so no
+  // writesInFlight_ bump: the decode's writes go through handleChunkOnRecvTask.
+  if (publishedOtaHandle_.load(std::memory_order_acquire) == 0) return;
+  if (!fec_ || repairBuf_.empty()) return;
+  if (std::memcmp(r.sourceMac, wispMac_, 6) != 0) return;
+  // The pool keys a window by its start, so the session's one stride is
+  // pinned. windowLen and len must be what this image's geometry gives that
+  // window, or the decode would solve for the wrong chunks.
+  if (r.stride != ota_fec::kStride) return;
+  if (r.windowStart >= offerTotalChunks_) return;
+  if (r.windowLen !=
+      ota_fec::windowLen(r.windowStart, r.stride, offerTotalChunks_)) {
+    return;
+  }
+  const uint32_t windowOffset =
+      static_cast<uint32_t>(r.windowStart) * offerChunkSize_;
+  const uint32_t rowLen = offerTotalLen_ - windowOffset < offerChunkSize_
+                              ? offerTotalLen_ - windowOffset
+                              : offerChunkSize_;
+  if (r.len != rowLen) return;
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  portENTER_CRITICAL(&eraseMux_);
+#endif
+  // Nothing missing in the window: drop the row rather than take a slot.
+  uint8_t cols[lamp_protocol::FW_FEC_WINDOW_CHUNKS];
+  const bool wanted =
+      ota_fec::windowMissing(bitmap_.data(), bitmap_.size(), bitmapTotalChunks_,
+                             r.windowStart, r.stride, cols) != 0;
+  const int slot = wanted ? repairPool_.claim(r.windowStart, r.stride, r.row) : -1;
+  // One chunk-sized copy; plan() can't hand the slot out before it lands.
+  if (slot >= 0) {
+    std::memcpy(&repairBuf_[static_cast<size_t>(slot) * offerChunkSize_],
+                r.bytes, r.len);
+  }
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  portEXIT_CRITICAL(&eraseMux_);
+#endif
+}
+
+bool FirmwareReceiver::decodeRepairsOnLoop() {
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  if (!fec_ || repairBuf_.empty()) return false;
+  ota_fec::DecodePlan plan;
+  portENTER_CRITICAL(&eraseMux_);
+  const bool ready = repairPool_.plan(bitmap_.data(), bitmap_.size(),
+                                      bitmapTotalChunks_, plan);
+  portEXIT_CRITICAL(&eraseMux_);
+  if (!ready) return false;
+
+  const size_t chunkSize = offerChunkSize_;
+  const uint32_t windowOffset =
+      static_cast<uint32_t>(plan.windowStart) * offerChunkSize_;
+  const size_t rowLen = offerTotalLen_ - windowOffset < chunkSize
+                            ? offerTotalLen_ - windowOffset
+                            : chunkSize;
+  uint8_t* rows[ota_fec::RepairPool::kSlots];
+  for (uint8_t k = 0; k < plan.m; ++k) {
+    rows[k] = &repairBuf_[static_cast<size_t>(plan.slot[k]) * chunkSize];
+  }
+  uint8_t* scratch =
+      &repairBuf_[static_cast<size_t>(ota_fec::RepairPool::kSlots) * chunkSize];
+
+  // Fold every chunk the window already has out of the rows. Their bitmap
+  // bits were set after their writes landed, so the read-back is the data.
+  const esp_partition_t* part =
+      publishedPartition_.load(std::memory_order_relaxed);
+  bool ok = part != nullptr;
+  uint8_t k = 0;
+  for (uint8_t c = 0; ok && c < plan.windowLen; ++c) {
+    if (k < plan.m && plan.col[k] == c) {
+      ++k;
+      continue;
+    }
+    const uint32_t idx = plan.windowStart + static_cast<uint32_t>(c) * plan.stride;
+    const uint32_t offset = idx * offerChunkSize_;
+    const size_t len = offerTotalLen_ - offset < chunkSize
+                           ? offerTotalLen_ - offset
+                           : chunkSize;
+    ok = esp_partition_read(part, streamBase_ + offset, scratch, len) == ESP_OK;
+    if (ok) ota_fec::eliminate(rows, plan.row, plan.m, rowLen, c, scratch, len);
+  }
+  if (ok) ok = ota_fec::solve(rows, plan.row, plan.col, plan.m, rowLen);
+  if (ok) {
+    // Through the chunk path: the same gate, bounds checks, write and bitmap
+    // bookkeeping as a chunk off the air.
+    for (uint8_t j = 0; j < plan.m; ++j) {
+      const uint32_t idx =
+          plan.windowStart + static_cast<uint32_t>(plan.col[j]) * plan.stride;
+      lamp_protocol::ParsedFwChunk c{};
+      std::memcpy(c.sourceMac, wispMac_, 6);
+      std::memcpy(c.targetMac, myMac_, 6);
+      c.chunkIdx = static_cast<uint16_t>(idx);
+      c.offset   = idx * offerChunkSize_;
+      c.len      = static_cast<uint16_t>(offerTotalLen_ - c.offset < chunkSize
+                                             ? offerTotalLen_ - c.offset
+                                             : chunkSize);
+      c.bytes    = rows[j];
+      handleChunkOnRecvTask(c);
+    }
+  }
+#ifdef LAMP_DEBUG
+  if (!ok) {
+    Serial.printf("[fw_receiver] repair decode failed window=%u\n",
+                  (unsigned)plan.windowStart);
+  }
+#endif
+  // A failed decode drops its rows; the REQ path covers the window.
+  portENTER_CRITICAL(&eraseMux_);
+  repairPool_.release(plan);
+  portEXIT_CRITICAL(&eraseMux_);
+  return ok;
+#else
+  return false;
+#endif
+}
+
 void FirmwareReceiver::resetBitmap(size_t totalChunks) {
   bitmapTotalChunks_ = totalChunks;
   const size_t bytes = (totalChunks + 7) / 8;
@@ -848,32 +1080,36 @@ uint16_t FirmwareReceiver::firstMissingChunk() const {
 
 uint16_t FirmwareReceiver::firstMissingRunLen(uint16_t firstMissing) const {
   // Smallest count covering ALL missing chunks in a kMaxReqRunChunks window
-  // from firstMissing (scan the window, return last-unset - first + 1), NOT the
-  // longest contiguous run. Scattered single-chunk drops (the BLE-coex pattern)
-  // would otherwise cost one round trip each; one windowed REQ re-streams the
-  // span and catches them in a pass. Re-streamed dups are no-op NOR writes, far
-  // cheaper than the saved round trips. Capped so an early all-missing session
-  // doesn't dwarf the forward cursor.
+  // from firstMissing, NOT the longest contiguous run. Scattered single-chunk
+  // drops (the BLE-coex pattern) would otherwise cost one round trip each; one
+  // windowed REQ re-streams the span and catches them in a pass. Re-streamed
+  // dups are no-op NOR writes, far cheaper than the saved round trips. Capped
+  // so an early all-missing session doesn't dwarf the forward cursor. Peers
+  // that take the hole mask skip the dups entirely (sendReq).
   if (firstMissing == UINT16_MAX) return 0;
 #if defined(ARDUINO) || defined(ESP_PLATFORM)
   portENTER_CRITICAL(&eraseMux_);
 #endif
-  uint16_t lastMissingInWindow = firstMissing;  // first is missing by definition
-  const size_t windowEnd =
-      static_cast<size_t>(firstMissing) + kMaxReqRunChunks;
-  for (size_t i = firstMissing;
-       i < bitmapTotalChunks_ && i < windowEnd; ++i) {
-    const size_t byteIdx = i / 8;
-    const uint8_t bit = static_cast<uint8_t>(1u << (i % 8));
-    if (byteIdx >= bitmap_.size()) break;
-    if ((bitmap_[byteIdx] & bit) == 0) {
-      lastMissingInWindow = static_cast<uint16_t>(i);
-    }
-  }
+  const uint16_t runLen =
+      missingRunLen(bitmap_.data(), bitmap_.size(), bitmapTotalChunks_,
+                    firstMissing, kMaxReqRunChunks);
 #if defined(ARDUINO) || defined(ESP_PLATFORM)
   portEXIT_CRITICAL(&eraseMux_);
 #endif
-  return static_cast<uint16_t>(lastMissingInWindow - firstMissing + 1);
+  return runLen;
+}
+
+size_t FirmwareReceiver::missingMaskFrom(uint16_t base, uint8_t* mask,
+                                         size_t cap) const {
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  portENTER_CRITICAL(&eraseMux_);
+#endif
+  const size_t len = missingMask(bitmap_.data(), bitmap_.size(),
+                                 bitmapTotalChunks_, base, mask, cap);
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  portEXIT_CRITICAL(&eraseMux_);
+#endif
+  return len;
 }
 
 bool FirmwareReceiver::sendAccept(const PendingFirmwareControl& ctrl,
@@ -899,11 +1135,27 @@ bool FirmwareReceiver::sendReq(uint16_t firstChunkIdx, uint16_t chunkCount,
   // REQ belongs to the in-flight flow; route to the active transport.
   FirmwareTransport* t = transportForKind(activeTransportKind_);
   if (!t) return false;
-  uint8_t buf[lamp_protocol::FW_REQ_FIXED_SIZE];
-  const size_t n = lamp_protocol::buildFwReq(
-      buf, sizeof(buf), fwOutSeq_++, myMac_, wispMac_,
-      firstChunkIdx, chunkCount, reason, activeWireVersion_,
-      fsHooks_ ? fsHooks_->reqType : lamp_protocol::MSG_FW_REQ);
+  const uint8_t reqType = fsHooks_ ? fsHooks_->reqType : lamp_protocol::MSG_FW_REQ;
+  uint8_t buf[lamp_protocol::FW_REQ_MASK_MAX_SIZE];
+  size_t n = 0;
+  // Exact-hole form toward a source that serves it: the covering run still
+  // rides in the fixed body, the mask names just the missing chunks in it and
+  // the 256 after, so the source re-sends no chunk this lamp already holds.
+  if (reqMask_) {
+    uint8_t mask[lamp_protocol::FW_REQ_MASK_MAX_BYTES];
+    const size_t maskLen = missingMaskFrom(firstChunkIdx, mask, sizeof(mask));
+    if (maskLen) {
+      n = lamp_protocol::buildFwReqMask(
+          buf, sizeof(buf), fwOutSeq_++, myMac_, wispMac_,
+          firstChunkIdx, chunkCount, reason, mask, maskLen,
+          activeWireVersion_, reqType);
+    }
+  }
+  if (!n) {
+    n = lamp_protocol::buildFwReq(
+        buf, sizeof(buf), fwOutSeq_++, myMac_, wispMac_,
+        firstChunkIdx, chunkCount, reason, activeWireVersion_, reqType);
+  }
   if (!n) return false;
   return t->sendFrame(buf, n);
 }
@@ -1020,6 +1272,12 @@ lamp_protocol::FwResultStatus FirmwareReceiver::verifyAndApply() {
     return fsHooks_->verify(static_cast<const void*>(otaPartition),
                             offerVersion_, offerDigest_);
   }
+  // Delta session: the flash holds a patch, not the image. Rebuild the image
+  // first; the verify below then runs over it exactly as over a streamed one.
+  if (delta_) {
+    const lamp_protocol::FwResultStatus rc = rebuildFromDelta(otaPartition);
+    if (rc != lamp_protocol::FwResultStatus::Success) return rc;
+  }
   // Streaming verify: the lamp's ~280 KB heap can't hold a 1.4 MB image, so feed
   // firmware_signature's streaming reader from the OTA partition via
   // esp_partition_read (~4 KB stack per call vs 1.4 MB heap). otaPartition is
@@ -1035,7 +1293,8 @@ lamp_protocol::FwResultStatus FirmwareReceiver::verifyAndApply() {
   const char* outChannel = nullptr;
   uint32_t outVersion = 0;
   uint8_t streamedDigest[lamp_protocol::FW_SHA256_FULL_LEN] = {0};
-  const bool ok = firmware::verifySignedFirmware(reader, offerTotalLen_,
+  const uint32_t imageLen = delta_ ? deltaImageLen_ : offerTotalLen_;
+  const bool ok = firmware::verifySignedFirmware(reader, imageLen,
                                                  &outChannel, &outVersion,
                                                  streamedDigest);
   if (!ok) {
@@ -1093,4 +1352,110 @@ lamp_protocol::FwResultStatus FirmwareReceiver::verifyAndApply() {
 #endif
 }
 
+bool FirmwareReceiver::deltaBaseOk(const PendingFirmwareControl& ctrl,
+                                   uint32_t& patchOffset) {
+  // FS images have no delta form.
+  if (fsHooks_) return false;
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  const esp_partition_t* running = esp_ota_get_running_partition();
+  const esp_partition_t* next = esp_ota_get_next_update_partition(nullptr);
+  if (running == nullptr || next == nullptr) return false;
+  // The running image's identity doesn't change until reboot; scan for its
+  // footer once. A dev build has no footer, so it never takes a delta.
+  if (runningLen_ == 0) {
+    auto reader = [running](size_t offset, size_t wantBytes,
+                            uint8_t* out) -> int {
+      return esp_partition_read(running, offset, out, wantBytes) == ESP_OK
+                 ? static_cast<int>(wantBytes)
+                 : -1;
+    };
+    uint32_t len = 0;
+    if (!firmware::discoverSignedImageLength(reader, running->size, &len)) {
+      return false;
+    }
+    const size_t idOffset =
+        len - firmware::kLsigFooterLen + firmware::kLsigSignatureOffset;
+    if (esp_partition_read(running, idOffset, runningId_,
+                           sizeof(runningId_)) != ESP_OK) {
+      return false;
+    }
+    runningLen_ = len;
+  }
+  if (ctrl.offer.deltaBaseLen != runningLen_ ||
+      std::memcmp(ctrl.offer.deltaBaseId, runningId_, sizeof(runningId_)) != 0) {
+    return false;
+  }
+  return ota_delta::slotLayout(static_cast<uint32_t>(next->size),
+                               ctrl.offer.deltaImageLen, ctrl.offer.totalLen,
+                               SPI_FLASH_SEC_SIZE, patchOffset);
+#else
+  (void)ctrl;
+  (void)patchOffset;
+  return false;
+#endif
+}
+
+lamp_protocol::FwResultStatus FirmwareReceiver::rebuildFromDelta(
+    const void* partition) {
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  const auto* part = static_cast<const esp_partition_t*>(partition);
+  const esp_partition_t* running = esp_ota_get_running_partition();
+  if (running == nullptr || offerTotalLen_ <= ota_delta::kTrailerLen) {
+    return lamp_protocol::FwResultStatus::DeltaApplyFail;
+  }
+  // The streamed trailer must describe what the OFFER promised. A patch that
+  // doesn't can only rebuild an image the verify rejects, but this catches it
+  // before a full rebuild pass.
+  uint8_t raw[ota_delta::kTrailerLen];
+  ota_delta::Trailer t;
+  const size_t trailerAt = streamBase_ + offerTotalLen_ - ota_delta::kTrailerLen;
+  if (esp_partition_read(part, trailerAt, raw, sizeof(raw)) != ESP_OK ||
+      !ota_delta::parseTrailer(raw, sizeof(raw), t) ||
+      !ota_delta::trailerMatchesOffer(t, offerTotalLen_, deltaImageLen_,
+                                      offerVersion_, offerDigest_,
+                                      runningLen_, runningId_)) {
+#ifdef LAMP_DEBUG
+    Serial.println("[fw_receiver] delta trailer doesn't match the OFFER → fail");
+#endif
+    return lamp_protocol::FwResultStatus::DeltaApplyFail;
+  }
+  const uint32_t opsAt = streamBase_;
+  auto readBase = [running](size_t offset, size_t wantBytes,
+                            uint8_t* out) -> int {
+    return esp_partition_read(running, offset, out, wantBytes) == ESP_OK
+               ? static_cast<int>(wantBytes)
+               : -1;
+  };
+  auto readOps = [part, opsAt](size_t offset, size_t wantBytes,
+                               uint8_t* out) -> int {
+    return esp_partition_read(part, opsAt + offset, out, wantBytes) == ESP_OK
+               ? static_cast<int>(wantBytes)
+               : -1;
+  };
+  // Into the erased image region ahead of the patch; apply never writes past
+  // t.imageLen, and slotLayout kept that clear of the patch's sectors.
+  auto writeImage = [part](size_t offset, const uint8_t* data,
+                           size_t len) -> bool {
+    return esp_partition_write(part, offset, data, len) == ESP_OK;
+  };
+  const uint32_t t0 = millis();
+  const ota_delta::ApplyStatus st =
+      ota_delta::apply(t, readBase, readOps, writeImage);
+#ifdef LAMP_DEBUG
+  Serial.printf("[fw_receiver] delta rebuild: %u-byte patch -> %u-byte image "
+                "status=%u in %u ms\n",
+                (unsigned)offerTotalLen_, (unsigned)deltaImageLen_,
+                (unsigned)st, (unsigned)(millis() - t0));
+#else
+  (void)t0;
+#endif
+  return st == ota_delta::ApplyStatus::Ok
+             ? lamp_protocol::FwResultStatus::Success
+             : lamp_protocol::FwResultStatus::DeltaApplyFail;
+#else
+  (void)partition;
+  return lamp_protocol::FwResultStatus::Success;
+#endif
+}
+
 }  // namespace lamp
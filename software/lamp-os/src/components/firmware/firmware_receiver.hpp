@@ -13,14 +13,21 @@
 // the erased image length; verifyAndApply rejects a re-OFFER at a different
 // length so a partial image never boots.
 //
+// A delta OFFER streams a patch into the slot's tail instead of the image into
+// its start; verifyAndApply rebuilds the image from the patch and the running
+// slot (ota_delta.hpp) before the same verify.
+//
 // An OFFER that fails otaAcceptable (wrong channel, cross-variant, downgrade)
 // is declined with FwAcceptStatus::DeclineAlreadyCurrent in onOfferOnLoop, so
 // the distributor drops this lamp from its queue.
 
 #include <atomic>
 #include <cstdint>
+#include <cstring>
 #include <vector>
 
+#include "components/firmware/ota_fec.hpp"
+#include "components/firmware/ota_pack.hpp"
 #include "components/network/protocol/lamp_protocol.hpp"
 #include "util/high_water.hpp"
 
@@ -71,6 +78,11 @@ struct PendingFirmwareControl {
   // Ble + the writer's NimBLE conn handle.
   FirmwareTransportKind transportKind = FirmwareTransportKind::EspNow;
   uint16_t bleConnHandle = 0;
+  // OFFER sender's HELLO caps from the roster (mesh path; 0 when unknown or
+  // over BLE). HELLO_CAP_FW_REQ_BITMAP switches this flow's REQs to the
+  // exact-hole mask form; HELLO_CAP_FW_FEC arms repair-row decode (except
+  // in a packed session, and only in LAMP_OTA_FEC builds).
+  uint8_t peerCaps = 0;
   // Flat (not a union) to stay trivially-copyable for PendingTypedSlot.
   struct {
     uint32_t version;
@@ -85,6 +97,16 @@ struct PendingFirmwareControl {
     bool     hasAuth;
     uint8_t  digest[lamp_protocol::FW_SHA256_FULL_LEN];
     uint8_t  signature[lamp_protocol::FW_SIG_LEN];
+    // Delta trailer (fw_ota.hpp). isDelta: totalLen/chunkSize/totalChunks
+    // describe a patch that rebuilds a deltaImageLen image from the running
+    // one, identified by deltaBaseLen + deltaBaseId. False over BLE.
+    bool     isDelta;
+    uint32_t deltaImageLen;
+    uint32_t deltaBaseLen;
+    uint8_t  deltaBaseId[lamp_protocol::FW_DELTA_BASE_ID_LEN];
+    // Pack trailer (fw_ota.hpp): nonzero = each CHUNK is an ota_pack unit
+    // and totalChunks counts units. Ignored over BLE.
+    uint8_t  packFormat;
   } offer;
   struct {
     uint32_t version;
@@ -175,6 +197,11 @@ class FirmwareReceiver {
   // and marks its bitmap bit. Bounded IO + bitmap set, no heap/JSON/blocking.
   void handleChunkOnRecvTask(const lamp_protocol::ParsedFwChunk& p);
 
+  // Called DIRECTLY from the WiFi recv task (Core 0) for MSG_FW_REPAIR. Holds
+  // the row in a repair slot for tick()'s decode; a bounded copy under
+  // eraseMux_, no flash IO.
+  void handleRepairOnRecvTask(const lamp_protocol::ParsedFwRepair& r);
+
   State state() const { return state_; }
 
   // True while a session is mid-flow (OFFER accepted through verify/apply).
@@ -194,6 +221,14 @@ class FirmwareReceiver {
     return true;
   }
 
+  // True when an in-flight ESP-NOW flow was offered by sourceMac: mesh_link
+  // takes that distributor's group-addressed stream frames (fwGroupMac) only
+  // then. Same unlocked read as getPeerMac.
+  bool inGroupOf(const uint8_t sourceMac[6]) const {
+    uint8_t peer[6];
+    return getPeerMac(peer) && std::memcmp(peer, sourceMac, 6) == 0;
+  }
+
   // Total chunks expected for the in-flight OFFER. Zero outside Streaming.
   uint16_t totalChunks() const { return offerTotalChunks_; }
 
@@ -212,6 +247,11 @@ class FirmwareReceiver {
   void resetBitmap(size_t totalChunks);
   void markChunkReceived(uint16_t chunkIdx);
   bool isBitmapFull() const;
+  // Rebuilds one window's missing chunks from its held repairs, if any window
+  // is decodable: reads the window's received chunks back from the partition,
+  // solves, and writes the rebuilt chunks through handleChunkOnRecvTask.
+  // False when nothing was decodable. Core 1.
+  bool decodeRepairsOnLoop();
   // First un-received chunkIdx, or UINT16_MAX if full. Linear scan over a
   // 1-2 KB bitmap (~1.6 ms worst case at 8000 chunks).
   uint16_t firstMissingChunk() const;
@@ -219,6 +259,9 @@ class FirmwareReceiver {
   // whole run of holes instead of one round trip per chunk. Capped at
   // kMaxReqRunChunks.
   uint16_t firstMissingRunLen(uint16_t firstMissing) const;
+  // Exact-hole mask over the FW_REQ_MASK_MAX_CHUNKS from base (missingMask);
+  // returns the trimmed length.
+  size_t missingMaskFrom(uint16_t base, uint8_t* mask, size_t cap) const;
   // Cap on the per-REQ run length so scattered drops recover in one round trip.
   // cap=1 does NOT converge under real ESP-NOW loss (session times out before
   // the bitmap fills). 20 = one flash sector; held here until a wider value is
@@ -234,6 +277,15 @@ class FirmwareReceiver {
                lamp_protocol::FwReqReason reason);
   bool sendResult(lamp_protocol::FwResultStatus status, uint8_t detail);
 
+  // Delta OFFER gate: the base it names is the running image and the patch
+  // and rebuilt image both fit the inactive slot (ota_delta::slotLayout).
+  // Sets patchOffset. Core 1.
+  bool deltaBaseOk(const PendingFirmwareControl& ctrl, uint32_t& patchOffset);
+  // Rebuilds the image at the slot's start from the patch streamed into its
+  // tail, once the trailer there matches the accepted OFFER. Core 1, from
+  // verifyAndApply.
+  lamp_protocol::FwResultStatus rebuildFromDelta(const void* partition);
+
   // Clears the published handle, drains briefly, aborts the OTA. Core 1 only.
   void abortOta();
 
@@ -265,6 +317,13 @@ class FirmwareReceiver {
   uint8_t  myMac_[6]   = {0};      // this lamp's MAC (sourceMac of ACCEPT/REQ/RESULT)
   FirmwareTransportKind activeTransportKind_ = FirmwareTransportKind::EspNow;
   uint8_t activeWireVersion_ = lamp_protocol::PROTOCOL_VERSION_EMIT;
+  // Source advertised HELLO_CAP_FW_REQ_BITMAP: REQs carry the hole mask.
+  bool     reqMask_ = false;
+  // Source advertised HELLO_CAP_FW_FEC: repairBuf_ is sized and repairs held.
+  bool     fec_ = false;
+  // Packed session (ota_pack.hpp): each chunk decodes into packBuf_ before
+  // its write, at the stream offset it carries. Never alongside fec_.
+  bool     pack_ = false;
   uint16_t activeBleConnHandle_ = 0;
   uint32_t offerVersion_ = 0;
   uint32_t offerTotalLen_ = 0;
@@ -274,6 +333,17 @@ class FirmwareReceiver {
   // streamed image's computed digest to this so a source can't offer a verified
   // digest then stream different bytes. Zero for FS OTA (no offer signature).
   uint8_t  offerDigest_[lamp_protocol::FW_SHA256_FULL_LEN] = {0};
+  // Delta session: offerTotalLen_ is the patch, streamed to streamBase_ (the
+  // slot's tail) and rebuilt into a deltaImageLen_ image at the slot's start
+  // on DONE. streamBase_ is 0 for a full image; Core 0 adds it to every chunk
+  // offset, so it is set before the gate arms like offerTotalLen_.
+  bool     delta_         = false;
+  uint32_t deltaImageLen_ = 0;
+  uint32_t streamBase_    = 0;
+  // The running image's signed length and LSIG base id, read once on the
+  // first delta OFFER (a forward footer scan). runningLen_ 0 = not read yet.
+  uint32_t runningLen_ = 0;
+  uint8_t  runningId_[lamp_protocol::FW_DELTA_BASE_ID_LEN] = {0};
 
   // Sequence counters for outbound FW frames (ACCEPT/REQ/RESULT).
   uint16_t fwOutSeq_ = 0;
@@ -282,6 +352,18 @@ class FirmwareReceiver {
   std::vector<uint8_t> bitmap_;
   size_t bitmapTotalChunks_ = 0;
 
+  // Held repair rows: kSlots chunk-sized slots plus one chunk of decode
+  // scratch, allocated at OFFER for an FEC source and reclaimed with the
+  // bitmap. repairPool_ indexes the slots; both sit under eraseMux_ like the
+  // bitmap, except a plan's busy slots, which only the decode touches.
+  std::vector<uint8_t> repairBuf_;
+  ota_fec::RepairPool  repairPool_;
+
+  // One decoded unit (ota_pack::kMaxSpan bytes), allocated at OFFER for a
+  // packed session and reclaimed with the bitmap. Only Core 0's chunk handler
+  // touches it once the gate arms.
+  std::vector<uint8_t> packBuf_;
+
   //   lastChunkMs_       last successful chunk write (drives stall-REQ)
   //   lastChunkSeenMs_   last chunk to arrive regardless of write outcome
   //                      (drives the no-progress abort; failed writes still
@@ -218,6 +218,7 @@ const lamp::FsDistributorHooks kDistHooks = {
     /*offerType=*/      lp::MSG_FS_OFFER,
     /*chunkType=*/      lp::MSG_FS_CHUNK,
     /*doneType=*/       lp::MSG_FS_DONE,
+    /*repairType=*/     lp::MSG_FS_REPAIR,
 };
 
 }  // namespace
@@ -226,6 +227,8 @@ bool fsPathBusy() {
   return s_fsReceiver.isInProgress() || s_fsDistributor.isInProgress();
 }
 
+bool distributorGathering() { return s_fsDistributor.isGathering(); }
+
 void begin(lamp::FirmwareTransport* meshTransport,
            lamp::FirmwareReceiver* fwReceiver,
            lamp::FirmwareDistributor* fwDistributor) {
@@ -281,7 +284,8 @@ bool needsFs() {
 void considerPeer(const uint8_t peerMac[6], uint32_t peerFwVersion,
                   uint8_t peerProtocolVersion, uint32_t nowMs,
                   const char* peerFwChannel, const uint8_t* peerFsDigest,
-                  bool peerHasFsDigest, bool peerNeedsFs, int8_t peerRssi) {
+                  bool peerHasFsDigest, bool peerNeedsFs, int8_t peerRssi,
+                  uint8_t peerCaps) {
   // A peer with no digest and no need-FS flag is legacy / FS-disabled → skip.
   // A need-FS peer (empty/unmountable FS) has no digest to compare, so it takes
   // the offer unconditionally below.
@@ -309,7 +313,8 @@ void considerPeer(const uint8_t peerMac[6], uint32_t peerFwVersion,
   }
   s_fsDistributor.considerPeerForOta(peerMac, peerFwVersion,
                                      peerProtocolVersion, nowMs, peerFwChannel,
-                                     /*peerMaxChunk=*/0, peerRssi);
+                                     /*peerMaxChunk=*/0, peerRssi,
+                                     /*peerBeingServed=*/false, peerCaps);
 }
 
 void handleControl(const lamp::PendingFirmwareControl& ctrl) {
@@ -328,6 +333,8 @@ void handleControl(const lamp::PendingFirmwareControl& ctrl) {
 }
 
 void onChunk(const lp::ParsedFwChunk& c)  { s_fsReceiver.handleChunkOnRecvTask(c); }
+void onRepair(const lp::ParsedFwRepair& r) { s_fsReceiver.handleRepairOnRecvTask(r); }
+bool inGroupOf(const uint8_t sourceMac[6]) { return s_fsReceiver.inGroupOf(sourceMac); }
 void onAccept(const lp::ParsedFwAccept& a) { s_fsDistributor.onAcceptOnRecvTask(a); }
 void onReq(const lp::ParsedFwReq& r)       { s_fsDistributor.onReqOnRecvTask(r); }
 void onResult(const lp::ParsedFwResult& r) { s_fsDistributor.onResultOnRecvTask(r); }
@@ -339,6 +346,7 @@ void onResult(const lp::ParsedFwResult& r) { s_fsDistributor.onResultOnRecvTask(
 namespace fs_ota {
 // No OTA path runs on the native build; the firmware start gate still links this.
 bool fsPathBusy() { return false; }
+bool distributorGathering() { return false; }
 }  // namespace fs_ota
 
 #endif  // ARDUINO || ESP_PLATFORM
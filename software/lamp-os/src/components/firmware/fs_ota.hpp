@@ -22,6 +22,7 @@ struct PendingFirmwareControl;
 
 namespace lamp_protocol {
 struct ParsedFwChunk;
+struct ParsedFwRepair;
 struct ParsedFwAccept;
 struct ParsedFwReq;
 struct ParsedFwResult;
@@ -44,6 +45,10 @@ void tick(uint32_t nowMs);
 // firmware start gate consults it so fw and FS OTA never stream at once.
 bool fsPathBusy();
 
+// True while the FS distributor's group session is still admitting members;
+// the social scan keeps offering to peers through it.
+bool distributorGathering();
+
 // 8-byte prefix of the local FS manifest digest for HELLO_TLV_FS_STATE, or
 // nullptr if not yet computed (SPIFFS unmountable / empty).
 const uint8_t* localDigestPrefix();
@@ -57,10 +62,12 @@ bool needsFs();
 // advertising an FS digest that differs from ours, OR advertising need-FS
 // (HELLO_TLV_NEED_FS, no digest to compare). Called from the social peer loop
 // (Core 1). No digest AND not need-FS (older / FS-disabled peer) → skip.
+// peerCaps (HELLO caps) picks the session's REQ form and stream cadence.
 void considerPeer(const uint8_t peerMac[6], uint32_t peerFwVersion,
                   uint8_t peerProtocolVersion, uint32_t nowMs,
                   const char* peerFwChannel, const uint8_t* peerFsDigest,
-                  bool peerHasFsDigest, bool peerNeedsFs, int8_t peerRssi = -127);
+                  bool peerHasFsDigest, bool peerNeedsFs, int8_t peerRssi = -127,
+                  uint8_t peerCaps = 0);
 
 // Inbound dispatch, called from mesh_link's WiFi recv task.
 // MSG_FS_OFFER / MSG_FS_DONE post to the Core 1 drain, like firmware.
@@ -68,6 +75,11 @@ void considerPeer(const uint8_t peerMac[6], uint32_t peerFwVersion,
 void handleControl(const lamp::PendingFirmwareControl& ctrl);
 // MSG_FS_CHUNK writes straight to the spiffs partition on Core 0.
 void onChunk(const lamp_protocol::ParsedFwChunk& c);
+// MSG_FS_REPAIR is held for the FS receiver's Core 1 decode.
+void onRepair(const lamp_protocol::ParsedFwRepair& r);
+// True while the FS receiver is in a session offered by sourceMac, so its
+// group-addressed CHUNK/REPAIR/DONE are for us.
+bool inGroupOf(const uint8_t sourceMac[6]);
 // MSG_FS_ACCEPT / REQ / RESULT go to the FS distributor (this lamp sends).
 void onAccept(const lamp_protocol::ParsedFwAccept& a);
 void onReq(const lamp_protocol::ParsedFwReq& r);
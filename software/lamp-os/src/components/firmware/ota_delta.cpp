@@ -0,0 +1,207 @@
+#include "components/firmware/ota_delta.hpp"
+
+#include <cstring>
+
+namespace lamp {
+namespace ota_delta {
+
+namespace {
+
+constexpr uint8_t kMagic[4] = {'L', 'D', 'L', 'T'};
+
+uint32_t le32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+void putLe32(uint8_t* p, uint32_t v) {
+  for (int i = 0; i < 4; ++i) p[i] = static_cast<uint8_t>((v >> (8 * i)) & 0xFF);
+}
+
+// Forward reader over the ops through a small window.
+class OpsCursor {
+ public:
+  OpsCursor(const firmware::FirmwareByteReader& read, uint32_t len)
+      : read_(read), len_(len) {}
+
+  bool atEnd() const { return pos_ == len_; }
+  bool failed() const { return failed_; }
+
+  // Up to n bytes into out; false past the end or on a read failure.
+  bool take(uint8_t* out, size_t n) {
+    while (n > 0) {
+      if (at_ == have_ && !fill()) return false;
+      size_t k = have_ - at_;
+      if (k > n) k = n;
+      std::memcpy(out, buf_ + at_, k);
+      at_ += k;
+      pos_ += static_cast<uint32_t>(k);
+      out += k;
+      n -= k;
+    }
+    return true;
+  }
+
+  // LEB128, at most 32 bits.
+  bool varint(uint32_t& out) {
+    out = 0;
+    for (unsigned shift = 0; shift < 35; shift += 7) {
+      uint8_t b;
+      if (!take(&b, 1)) return false;
+      if (shift == 28 && (b & 0x70) != 0) return false;  // overflows 32 bits
+      out |= static_cast<uint32_t>(b & 0x7F) << shift;
+      if ((b & 0x80) == 0) return true;
+    }
+    return false;
+  }
+
+ private:
+  bool fill() {
+    const uint32_t fetched = pos_ - static_cast<uint32_t>(at_) + static_cast<uint32_t>(have_);
+    if (fetched >= len_) return false;
+    size_t want = len_ - fetched;
+    if (want > sizeof(buf_)) want = sizeof(buf_);
+    if (read_(fetched, want, buf_) != static_cast<int>(want)) {
+      failed_ = true;
+      return false;
+    }
+    at_ = 0;
+    have_ = want;
+    return true;
+  }
+
+  const firmware::FirmwareByteReader& read_;
+  uint32_t len_;
+  uint32_t pos_  = 0;  // ops bytes consumed
+  size_t   at_   = 0;
+  size_t   have_ = 0;
+  bool     failed_ = false;
+  uint8_t  buf_[256];
+};
+
+// Image output, written in whole buffers so flash sees few large writes.
+class ImageOut {
+ public:
+  explicit ImageOut(const ImageWriter& write) : write_(write) {}
+
+  uint8_t* tail() { return buf_ + used_; }
+  size_t room() const { return sizeof(buf_) - used_; }
+  bool commit(size_t n) {
+    used_ += n;
+    return used_ < sizeof(buf_) || flush();
+  }
+  bool flush() {
+    if (used_ == 0) return true;
+    if (!write_(written_, buf_, used_)) return false;
+    written_ += used_;
+    used_ = 0;
+    return true;
+  }
+
+ private:
+  const ImageWriter& write_;
+  size_t  written_ = 0;
+  size_t  used_    = 0;
+  uint8_t buf_[512];
+};
+
+}  // namespace
+
+bool parseTrailer(const uint8_t* buf, size_t len, Trailer& out) {
+  if (!buf || len < kTrailerLen) return false;
+  if (std::memcmp(buf, kMagic, sizeof(kMagic)) != 0 || buf[4] != kFormat) {
+    return false;
+  }
+  out.baseVersion  = le32(buf + 8);
+  out.baseLen      = le32(buf + 12);
+  out.imageVersion = le32(buf + 16);
+  out.imageLen     = le32(buf + 20);
+  out.opsLen       = le32(buf + 24);
+  std::memcpy(out.baseId, buf + 32, sizeof(out.baseId));
+  std::memcpy(out.imageDigest, buf + 48, sizeof(out.imageDigest));
+  return out.imageLen != 0 && out.opsLen != 0;
+}
+
+void writeTrailer(const Trailer& t, uint8_t out[kTrailerLen]) {
+  std::memset(out, 0, kTrailerLen);
+  std::memcpy(out, kMagic, sizeof(kMagic));
+  out[4] = kFormat;
+  putLe32(out + 8, t.baseVersion);
+  putLe32(out + 12, t.baseLen);
+  putLe32(out + 16, t.imageVersion);
+  putLe32(out + 20, t.imageLen);
+  putLe32(out + 24, t.opsLen);
+  std::memcpy(out + 32, t.baseId, sizeof(t.baseId));
+  std::memcpy(out + 48, t.imageDigest, sizeof(t.imageDigest));
+}
+
+bool trailerMatchesOffer(const Trailer& t, uint32_t patchLen, uint32_t imageLen,
+                         uint32_t imageVersion, const uint8_t* imageDigest,
+                         uint32_t baseLen, const uint8_t* baseId) {
+  return patchLen > kTrailerLen && t.opsLen == patchLen - kTrailerLen &&
+         t.imageLen == imageLen && t.imageVersion == imageVersion &&
+         t.baseLen == baseLen &&
+         std::memcmp(t.baseId, baseId, sizeof(t.baseId)) == 0 &&
+         std::memcmp(t.imageDigest, imageDigest, sizeof(t.imageDigest)) == 0;
+}
+
+ApplyStatus apply(const Trailer& t, const firmware::FirmwareByteReader& readBase,
+                  const firmware::FirmwareByteReader& readOps,
+                  const ImageWriter& writeImage) {
+  OpsCursor ops(readOps, t.opsLen);
+  ImageOut  out(writeImage);
+  const auto opsStatus = [&ops] {
+    return ops.failed() ? ApplyStatus::ReadFail : ApplyStatus::Corrupt;
+  };
+  uint32_t basePos = 0;
+  uint32_t written = 0;
+  while (written < t.imageLen) {
+    uint32_t seekZz, copyLen, addLen;
+    if (!ops.varint(seekZz) || !ops.varint(copyLen) || !ops.varint(addLen)) {
+      return opsStatus();
+    }
+    const int64_t seek = static_cast<int64_t>(seekZz >> 1) ^ -static_cast<int64_t>(seekZz & 1);
+    const int64_t from = static_cast<int64_t>(basePos) + seek;
+    const uint32_t left = t.imageLen - written;
+    if (from < 0 || from > t.baseLen || (copyLen == 0 && addLen == 0) ||
+        copyLen > t.baseLen - from || copyLen > left || addLen > left - copyLen) {
+      return ApplyStatus::Corrupt;
+    }
+    basePos = static_cast<uint32_t>(from);
+    for (uint32_t n = copyLen; n > 0;) {
+      const size_t k = n < out.room() ? n : out.room();
+      if (readBase(basePos, k, out.tail()) != static_cast<int>(k)) {
+        return ApplyStatus::ReadFail;
+      }
+      basePos += static_cast<uint32_t>(k);
+      n -= static_cast<uint32_t>(k);
+      if (!out.commit(k)) return ApplyStatus::WriteFail;
+    }
+    for (uint32_t n = addLen; n > 0;) {
+      const size_t k = n < out.room() ? n : out.room();
+      if (!ops.take(out.tail(), k)) return opsStatus();
+      n -= static_cast<uint32_t>(k);
+      if (!out.commit(k)) return ApplyStatus::WriteFail;
+    }
+    written += copyLen + addLen;
+  }
+  // Trailing ops would mean the patch was built for a different image.
+  if (!ops.atEnd()) return ApplyStatus::Corrupt;
+  return out.flush() ? ApplyStatus::Ok : ApplyStatus::WriteFail;
+}
+
+bool slotLayout(uint32_t slotLen, uint32_t imageLen, uint32_t patchLen,
+                uint32_t sectorLen, uint32_t& patchOffset) {
+  if (imageLen == 0 || patchLen == 0 || sectorLen == 0 || patchLen > slotLen) {
+    return false;
+  }
+  const uint32_t offset = slotLen - patchLen;
+  const uint64_t imageEnd =
+      (static_cast<uint64_t>(imageLen) + sectorLen - 1) / sectorLen * sectorLen;
+  if (imageEnd > offset - offset % sectorLen) return false;
+  patchOffset = offset;
+  return true;
+}
+
+}  // namespace ota_delta
+}  // namespace lamp
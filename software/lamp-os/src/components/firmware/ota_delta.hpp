@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "components/firmware/firmware_signature.hpp"  // FirmwareByteReader
+#include "components/network/protocol/fw_ota.hpp"
+
+namespace lamp {
+namespace ota_delta {
+
+// Patch that rebuilds a signed firmware image from the one a lamp is running,
+// so a point release crosses the mesh as a few KB of ops instead of the
+// ~1.5 MB image. scripts/make_firmware_delta.py writes it; the lamp streams it
+// over the normal OTA chunk path (a delta OFFER, fw_ota.hpp) into the tail of
+// its inactive slot, rebuilds the image at the slot's start (apply), then
+// runs the usual LSIG verify over the result.
+//
+//   patch = ops || trailer (kTrailerLen bytes)
+//
+// ops is a run of records, each
+//
+//   seek     zigzag varint   added to the base cursor
+//   copyLen  varint          bytes copied from the base at the cursor
+//   addLen   varint          literal bytes that follow in the record
+//   add      addLen bytes
+//
+// The base cursor carries over from record to record, so a copy that resumes
+// right after an edit costs one zero seek byte. Varints are LEB128.
+//
+// A lamp keeps the patch it was updated with in its running slot's tail, past
+// the image, and distributes it to peers still on the base. A patch whose
+// trailer names another image (the tail of a slot later written with a full
+// image, say) is ignored.
+//
+// Trailer (kTrailerLen == 80, little-endian):
+//   [0..4)    "LDLT"
+//   [4]       format (kFormat)
+//   [5..8)    reserved
+//   [8..12)   base firmware version (packed semver)
+//   [12..16)  base image length, LSIG footer included
+//   [16..20)  image version
+//   [20..24)  image length, LSIG footer included
+//   [24..28)  ops length
+//   [28..32)  reserved
+//   [32..48)  base id: the base's LSIG signature, first FW_DELTA_BASE_ID_LEN
+//   [48..80)  SHA-256 of the image's signed region (its OFFER digest)
+
+constexpr size_t  kTrailerLen = 80;
+constexpr uint8_t kFormat     = 1;
+
+struct Trailer {
+  uint32_t baseVersion = 0;
+  uint32_t baseLen     = 0;
+  uint32_t imageVersion = 0;
+  uint32_t imageLen    = 0;
+  uint32_t opsLen      = 0;
+  uint8_t  baseId[lamp_protocol::FW_DELTA_BASE_ID_LEN] = {0};
+  uint8_t  imageDigest[lamp_protocol::FW_SHA256_FULL_LEN] = {0};
+};
+
+// False on a wrong magic or format, or an empty image or ops region.
+bool parseTrailer(const uint8_t* buf, size_t len, Trailer& out);
+void writeTrailer(const Trailer& t, uint8_t out[kTrailerLen]);
+
+// True when a streamed patch's trailer describes what its delta OFFER promised:
+// patchLen bytes (ops and trailer) rebuilding imageLen bytes of imageVersion
+// with the OFFER's imageDigest, from the running base (baseLen, baseId).
+bool trailerMatchesOffer(const Trailer& t, uint32_t patchLen, uint32_t imageLen,
+                         uint32_t imageVersion, const uint8_t* imageDigest,
+                         uint32_t baseLen, const uint8_t* baseId);
+
+// Writes out[0..len) at image offset `offset`. Offsets only ascend.
+using ImageWriter =
+    std::function<bool(size_t offset, const uint8_t* data, size_t len)>;
+
+enum class ApplyStatus : uint8_t {
+  Ok = 0,
+  Corrupt,    // a record runs past the base, the image or the ops
+  ReadFail,
+  WriteFail,
+};
+
+// Rebuilds t.imageLen bytes through writeImage. readBase serves the base image
+// [0, t.baseLen), readOps the ops [0, t.opsLen). Ok only when the ops end
+// exactly where the image does; nothing is written past t.imageLen either way.
+// ~1 KB of stack, no heap.
+ApplyStatus apply(const Trailer& t, const firmware::FirmwareByteReader& readBase,
+                  const firmware::FirmwareByteReader& readOps,
+                  const ImageWriter& writeImage);
+
+// Where a patch and the image it rebuilds sit in a slot of slotLen bytes: the
+// patch ends at the slot's end, and the image, rounded up to the erase
+// sector, must end at or before the sector the patch starts in. False when
+// they don't both fit.
+bool slotLayout(uint32_t slotLen, uint32_t imageLen, uint32_t patchLen,
+                uint32_t sectorLen, uint32_t& patchOffset);
+
+}  // namespace ota_delta
+}  // namespace lamp
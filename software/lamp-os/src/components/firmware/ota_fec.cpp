@@ -0,0 +1,221 @@
+#include "components/firmware/ota_fec.hpp"
+
+#include <algorithm>
+
+namespace lamp {
+namespace ota_fec {
+
+namespace {
+
+// GF(2^8) over x^8 + x^4 + x^3 + x^2 + 1 (0x11D), generator 2. Built at
+// compile time so the 768 bytes land in flash, not in a boot-time init.
+struct GfTables {
+  uint8_t exp[512];  // doubled so exp[log a + log b] needs no mod 255
+  uint8_t log[256];
+  constexpr GfTables() : exp{}, log{} {
+    unsigned x = 1;
+    for (unsigned i = 0; i < 255; ++i) {
+      exp[i] = static_cast<uint8_t>(x);
+      log[x] = static_cast<uint8_t>(i);
+      x <<= 1;
+      if (x & 0x100u) x ^= 0x11Du;
+    }
+    for (unsigned i = 255; i < 512; ++i) exp[i] = exp[i - 255];
+  }
+};
+constexpr GfTables kGf{};
+
+uint8_t gfMul(uint8_t a, uint8_t b) {
+  if (a == 0 || b == 0) return 0;
+  return kGf.exp[kGf.log[a] + kGf.log[b]];
+}
+
+uint8_t gfInv(uint8_t a) {
+  // a != 0: every caller passes a Cauchy entry or a non-zero pivot.
+  return kGf.exp[255 - kGf.log[a]];
+}
+
+}  // namespace
+
+uint8_t coefficient(uint8_t row, uint8_t col) {
+  const unsigned x = lamp_protocol::FW_FEC_WINDOW_CHUNKS + row;
+  return gfInv(static_cast<uint8_t>(x ^ col));
+}
+
+void mulAdd(uint8_t* acc, size_t len, uint8_t coef,
+            const uint8_t* src, size_t srcLen) {
+  if (coef == 0) return;
+  const size_t n = srcLen < len ? srcLen : len;
+  if (coef == 1) {
+    for (size_t i = 0; i < n; ++i) acc[i] ^= src[i];
+    return;
+  }
+  const unsigned logCoef = kGf.log[coef];
+  for (size_t i = 0; i < n; ++i) {
+    const uint8_t s = src[i];
+    if (s) acc[i] ^= kGf.exp[kGf.log[s] + logCoef];
+  }
+}
+
+void eliminate(uint8_t* const* repairs, const uint8_t* rows, size_t m,
+               size_t len, uint8_t col, const uint8_t* chunk, size_t chunkLen) {
+  for (size_t k = 0; k < m; ++k) {
+    mulAdd(repairs[k], len, coefficient(rows[k], col), chunk, chunkLen);
+  }
+}
+
+bool solve(uint8_t* const* repairs, const uint8_t* rows, const uint8_t* cols,
+           size_t m, size_t len) {
+  if (m == 0) return true;
+  if (m > lamp_protocol::FW_FEC_WINDOW_CHUNKS) return false;
+  constexpr size_t kMax = lamp_protocol::FW_FEC_WINDOW_CHUNKS;
+  uint8_t a[kMax][kMax];
+  for (size_t j = 0; j < m; ++j) {
+    for (size_t k = 0; k < m; ++k) a[j][k] = coefficient(rows[j], cols[k]);
+  }
+  // Gauss-Jordan with the same row operations applied to the payloads. Row
+  // swaps move payload bytes, not pointers, so repairs[k] ends up holding
+  // column cols[k] for the caller.
+  for (size_t k = 0; k < m; ++k) {
+    size_t p = k;
+    while (p < m && a[p][k] == 0) ++p;
+    if (p == m) return false;  // repeated row or column
+    if (p != k) {
+      std::swap_ranges(a[p], a[p] + m, a[k]);
+      std::swap_ranges(repairs[p], repairs[p] + len, repairs[k]);
+    }
+    const uint8_t inv = gfInv(a[k][k]);
+    for (size_t c = 0; c < m; ++c) a[k][c] = gfMul(a[k][c], inv);
+    for (size_t i = 0; i < len; ++i) repairs[k][i] = gfMul(repairs[k][i], inv);
+    for (size_t j = 0; j < m; ++j) {
+      const uint8_t f = a[j][k];
+      if (j == k || f == 0) continue;
+      for (size_t c = 0; c < m; ++c) a[j][c] ^= gfMul(f, a[k][c]);
+      mulAdd(repairs[j], len, f, repairs[k], len);
+    }
+  }
+  return true;
+}
+
+uint8_t windowLen(uint16_t windowStart, uint8_t stride, size_t totalChunks) {
+  if (stride == 0 || windowStart >= totalChunks) return 0;
+  const size_t n = (totalChunks - windowStart + stride - 1) / stride;
+  return static_cast<uint8_t>(n < lamp_protocol::FW_FEC_WINDOW_CHUNKS
+                                  ? n
+                                  : lamp_protocol::FW_FEC_WINDOW_CHUNKS);
+}
+
+uint8_t windowMissing(const uint8_t* bitmap, size_t bitmapBytes,
+                      size_t totalChunks, uint16_t windowStart, uint8_t stride,
+                      uint8_t cols[lamp_protocol::FW_FEC_WINDOW_CHUNKS]) {
+  const uint8_t n = windowLen(windowStart, stride, totalChunks);
+  uint8_t m = 0;
+  for (uint8_t c = 0; c < n; ++c) {
+    const size_t idx = static_cast<size_t>(windowStart) + static_cast<size_t>(c) * stride;
+    if (idx / 8 >= bitmapBytes) break;
+    if (((bitmap[idx / 8] >> (idx % 8)) & 1u) == 0) cols[m++] = c;
+  }
+  return m;
+}
+
+int RepairPool::claim(uint16_t windowStart, uint8_t stride, uint8_t row) {
+  int freeSlot = -1;
+  int victim = -1;
+  for (uint8_t i = 0; i < kSlots; ++i) {
+    const Slot& s = slots_[i];
+    if (s.state == SlotState::Free) {
+      if (freeSlot < 0) freeSlot = i;
+      continue;
+    }
+    if (s.windowStart == windowStart && s.stride == stride && s.row == row) {
+      return -1;
+    }
+    if (s.state == SlotState::Held && s.windowStart < windowStart &&
+        (victim < 0 || s.windowStart < slots_[victim].windowStart)) {
+      victim = i;
+    }
+  }
+  const int pick = freeSlot >= 0 ? freeSlot : victim;
+  if (pick < 0) return -1;
+  slots_[pick] = Slot{windowStart, stride, row, SlotState::Held};
+  return pick;
+}
+
+bool RepairPool::plan(const uint8_t* bitmap, size_t bitmapBytes,
+                      size_t totalChunks, DecodePlan& out) {
+  uint16_t done = UINT16_MAX;  // last window examined, lowest first
+  for (;;) {
+    // Lowest held window above the last one examined.
+    // A session streams at one stride, so windowStart alone keys a window.
+    bool found = false;
+    uint16_t w = 0;
+    uint8_t stride = 1;
+    for (const Slot& s : slots_) {
+      if (s.state != SlotState::Held) continue;
+      if (done != UINT16_MAX && s.windowStart <= done) continue;
+      if (!found || s.windowStart < w) {
+        w = s.windowStart;
+        stride = s.stride;
+        found = true;
+      }
+    }
+    if (!found) return false;
+    done = w;
+
+    uint8_t cols[lamp_protocol::FW_FEC_WINDOW_CHUNKS];
+    const uint8_t m =
+        windowMissing(bitmap, bitmapBytes, totalChunks, w, stride, cols);
+    uint8_t have = 0;
+    for (const Slot& s : slots_) {
+      if (s.state == SlotState::Held && s.windowStart == w) ++have;
+    }
+    if (m == 0) {
+      for (Slot& s : slots_) {
+        if (s.state == SlotState::Held && s.windowStart == w) s.state = SlotState::Free;
+      }
+      continue;
+    }
+    if (m > have) continue;
+
+    out = DecodePlan{};
+    out.windowStart = w;
+    out.stride      = stride;
+    out.windowLen   = windowLen(w, stride, totalChunks);
+    out.m           = m;
+    uint8_t k = 0;
+    for (uint8_t i = 0; i < kSlots && k < m; ++i) {
+      Slot& s = slots_[i];
+      if (s.state != SlotState::Held || s.windowStart != w) continue;
+      s.state = SlotState::Busy;
+      out.slot[k] = i;
+      out.row[k]  = s.row;
+      out.col[k]  = cols[k];
+      ++k;
+    }
+    return true;
+  }
+}
+
+void RepairPool::release(const DecodePlan& p) {
+  // The window is whole once its plan is applied, so its spare rows go too.
+  for (Slot& s : slots_) {
+    if (s.state != SlotState::Free && s.windowStart == p.windowStart) {
+      s.state = SlotState::Free;
+    }
+  }
+}
+
+uint8_t RepairPool::held() const {
+  uint8_t n = 0;
+  for (const Slot& s : slots_) {
+    if (s.state != SlotState::Free) ++n;
+  }
+  return n;
+}
+
+void RepairPool::clear() {
+  for (Slot& s : slots_) s.state = SlotState::Free;
+}
+
+}  // namespace ota_fec
+}  // namespace lamp
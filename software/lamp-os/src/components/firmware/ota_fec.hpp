@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "components/network/protocol/fw_ota.hpp"
+
+namespace lamp {
+namespace ota_fec {
+
+// Window erasure code for the mesh OTA chunk stream (MSG_FW_REPAIR). A window
+// is up to FW_FEC_WINDOW_CHUNKS chunks `stride` apart (column i is chunk
+// windowStart + i * stride); its chunks are sent as-is, followed by repair
+// rows:
+//
+//   repair[row] = sum_i coefficient(row, i) * chunk[column i]   over GF(2^8)
+//
+// with every chunk zero-padded to the window's longest. A stride of D
+// interleaves D windows over a block of D * FW_FEC_WINDOW_CHUNKS chunks, so a
+// burst of up to D lost frames costs each window at most one chunk. The
+// coefficients form a Cauchy matrix, every square submatrix of which is
+// invertible, so ANY m repair rows rebuild ANY m missing chunks of the
+// window. The distributor can keep minting fresh rows (up to FW_FEC_MAX_ROWS)
+// without coordination.
+//
+// The byte math is pure, with no heap: once a block has streamed, the
+// distributor re-reads each window's chunks from the partition and
+// accumulates one row at a time into the outgoing frame; the receiver folds
+// the chunks it holds out of the repairs it holds (eliminate), then solves
+// for the rest in place (solve). Decode RAM is the held repairs plus one
+// chunk of scratch.
+// RepairPool below is the receiver's bookkeeping for which held repair sits
+// in which buffer.
+
+// What the distributor emits toward an FEC peer: two rows per window, four
+// windows interleaved. Two rows cover the lone drop plus most two-frame
+// bursts per window; the interleave spreads a BLE-coex burst across windows.
+// The receiver holds a whole block's rows at once, so the product is capped
+// by its slots.
+constexpr uint8_t kRowsPerWindow = 2;
+constexpr uint8_t kStride = 4;
+
+// Cauchy entry 1 / (x_row + y_col), x_row = FW_FEC_WINDOW_CHUNKS + row and
+// y_col = col. row < FW_FEC_MAX_ROWS, col < FW_FEC_WINDOW_CHUNKS.
+uint8_t coefficient(uint8_t row, uint8_t col);
+
+// acc[0..len) += coef * src, src zero-padded from srcLen to len.
+void mulAdd(uint8_t* acc, size_t len, uint8_t coef,
+            const uint8_t* src, size_t srcLen);
+
+// Encoder step: folds chunk `col` into repair row `row`'s accumulator.
+inline void accumulate(uint8_t* acc, size_t len, uint8_t row, uint8_t col,
+                       const uint8_t* chunk, size_t chunkLen) {
+  mulAdd(acc, len, coefficient(row, col), chunk, chunkLen);
+}
+
+// Decoder step 1, once per chunk the receiver holds: subtracts chunk `col`'s
+// share from each of the m held repairs (rows[k] is repairs[k]'s row).
+void eliminate(uint8_t* const* repairs, const uint8_t* rows, size_t m,
+               size_t len, uint8_t col, const uint8_t* chunk, size_t chunkLen);
+
+// Decoder step 2, after every held chunk is eliminated: solves the m x m
+// system for the m missing columns cols[], leaving column cols[k]'s chunk in
+// repairs[k] (zero-padded to len). Rows and columns must each be distinct;
+// returns false otherwise.
+bool solve(uint8_t* const* repairs, const uint8_t* rows, const uint8_t* cols,
+           size_t m, size_t len);
+
+// Chunks in the window at (windowStart, stride): FW_FEC_WINDOW_CHUNKS, fewer
+// in the image's last block.
+uint8_t windowLen(uint16_t windowStart, uint8_t stride, size_t totalChunks);
+
+// Fills cols with the window columns whose chunk bit is clear in the
+// receiver's bitmap (set = received) and returns how many.
+uint8_t windowMissing(const uint8_t* bitmap, size_t bitmapBytes,
+                      size_t totalChunks, uint16_t windowStart, uint8_t stride,
+                      uint8_t cols[lamp_protocol::FW_FEC_WINDOW_CHUNKS]);
+
+// One window's worth of decode work handed from RepairPool::plan to the
+// caller: m missing columns, and m held repairs (by slot) to rebuild them.
+struct DecodePlan {
+  static constexpr uint8_t kMaxRows = 8;
+  uint16_t windowStart = 0;
+  uint8_t  stride      = 1;
+  uint8_t  windowLen   = 0;
+  uint8_t  m           = 0;
+  uint8_t  slot[kMaxRows] = {0};
+  uint8_t  row[kMaxRows]  = {0};
+  uint8_t  col[kMaxRows]  = {0};
+};
+
+// Receiver-side index of held repair rows. Slot i names the caller's i-th
+// chunk-sized buffer; the caller copies the payload in after claim() and
+// holds its own lock around every call, as with the chunk bitmap.
+class RepairPool {
+ public:
+  static constexpr uint8_t kSlots = DecodePlan::kMaxRows;
+
+  // Slot for an arriving repair, or -1 to drop it: a row already held, or no
+  // free slot and nothing older to evict. When full, the lowest window's
+  // repairs give way to a newer window's (the stream has moved past it and a
+  // REQ covers whatever it can't rebuild); slots under decode are never taken.
+  int claim(uint16_t windowStart, uint8_t stride, uint8_t row);
+
+  // Next decodable window: the lowest held window missing no more chunks than
+  // it has repairs for. Frees repairs of windows with nothing missing on the
+  // way. Marks the plan's slots busy, so claim() leaves them alone until
+  // release(). False when no window is decodable yet.
+  bool plan(const uint8_t* bitmap, size_t bitmapBytes, size_t totalChunks,
+            DecodePlan& out);
+  void release(const DecodePlan& p);
+
+  uint8_t held() const;
+  void clear();
+
+ private:
+  enum class SlotState : uint8_t { Free = 0, Held, Busy };
+  struct Slot {
+    uint16_t  windowStart;
+    uint8_t   stride;
+    uint8_t   row;
+    SlotState state;
+  };
+  Slot slots_[kSlots] = {};
+};
+
+static_assert(kRowsPerWindow * kStride <= RepairPool::kSlots,
+              "a block's repair rows must fit the receiver's slots");
+static_assert(kStride <= lamp_protocol::FW_FEC_MAX_STRIDE, "stride on the wire");
+
+}  // namespace ota_fec
+}  // namespace lamp
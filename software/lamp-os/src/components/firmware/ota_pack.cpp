@@ -0,0 +1,187 @@
+#include "components/firmware/ota_pack.hpp"
+
+#include <cstring>
+
+namespace lamp {
+namespace ota_pack {
+
+namespace {
+
+constexpr size_t kMinMatch = 4;
+
+uint32_t hash4(const uint8_t* p) {
+  const uint32_t v = static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                     (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+  return (v * 2654435761u) >> (32 - kHashBits);
+}
+
+// Bytes a length of n adds past its token nibble.
+size_t extLen(size_t n) { return n < 15 ? 0 : 1 + (n - 15) / 255; }
+
+uint8_t* putExt(uint8_t* op, size_t n) {
+  if (n < 15) return op;
+  n -= 15;
+  while (n >= 255) {
+    *op++ = 255;
+    n -= 255;
+  }
+  *op++ = static_cast<uint8_t>(n);
+  return op;
+}
+
+// Most literals a closing literal-only sequence carries in `room` bytes.
+size_t maxLiterals(size_t room) {
+  if (room < 2) return 0;
+  size_t n = room - 1;
+  while (n > 0 && 1 + extLen(n) + n > room) --n;
+  return n;
+}
+
+bool readExt(const uint8_t* in, size_t inLen, size_t& ip, size_t& n) {
+  uint8_t b;
+  do {
+    if (ip >= inLen) return false;
+    b = in[ip++];
+    n += b;
+  } while (b == 255);
+  return true;
+}
+
+}  // namespace
+
+size_t pack(const uint8_t* in, size_t inLen, uint8_t* out, size_t outCap,
+            uint16_t* table, size_t& consumed) {
+  consumed = 0;
+  if (!in || !out || !table || inLen == 0 || inLen > kMaxSpan || outCap < 2) {
+    return 0;
+  }
+  std::memset(table, 0, sizeof(uint16_t) << kHashBits);
+  uint8_t* op = out;
+  size_t ip = 0;
+  size_t anchor = 0;
+  while (ip + kMinMatch <= inLen) {
+    const size_t room = outCap - static_cast<size_t>(op - out);
+    const size_t lits = ip - anchor;
+    // One more literal no longer fits: neither does any match after them.
+    if (1 + extLen(lits + 1) + lits + 1 > room) break;
+    const uint32_t h = hash4(in + ip);
+    const size_t cand = table[h];  // position + 1; 0 = empty
+    table[h] = static_cast<uint16_t>(ip + 1);
+    if (cand == 0 || std::memcmp(in + cand - 1, in + ip, kMinMatch) != 0) {
+      ++ip;
+      continue;
+    }
+    const size_t from = cand - 1;
+    size_t len = kMinMatch;
+    while (ip + len < inLen && in[from + len] == in[ip + len]) ++len;
+    const size_t cost = 1 + extLen(lits) + lits + 2 + extLen(len - kMinMatch);
+    if (cost > room) break;
+    const size_t m = len - kMinMatch;
+    *op++ = static_cast<uint8_t>(((lits < 15 ? lits : 15) << 4) | (m < 15 ? m : 15));
+    op = putExt(op, lits);
+    std::memcpy(op, in + anchor, lits);
+    op += lits;
+    const size_t dist = ip - from;
+    *op++ = static_cast<uint8_t>(dist & 0xFF);
+    *op++ = static_cast<uint8_t>(dist >> 8);
+    op = putExt(op, m);
+    ip += len;
+    anchor = ip;
+  }
+  // Close with the rest of the input as literals, or as much of it as fits.
+  size_t lits = inLen - anchor;
+  const size_t fit = maxLiterals(outCap - static_cast<size_t>(op - out));
+  if (lits > fit) lits = fit;
+  if (lits > 0) {
+    *op++ = static_cast<uint8_t>((lits < 15 ? lits : 15) << 4);
+    op = putExt(op, lits);
+    std::memcpy(op, in + anchor, lits);
+    op += lits;
+  }
+  consumed = anchor + lits;
+  return static_cast<size_t>(op - out);
+}
+
+bool unpack(const uint8_t* in, size_t inLen, uint8_t* out, size_t outCap,
+            size_t& outLen) {
+  outLen = 0;
+  if (!in || !out || inLen == 0) return false;
+  size_t ip = 0;
+  size_t op = 0;
+  while (ip < inLen) {
+    const uint8_t token = in[ip++];
+    size_t lits = token >> 4;
+    if (lits == 15 && !readExt(in, inLen, ip, lits)) return false;
+    if (lits > inLen - ip || lits > outCap - op) return false;
+    std::memcpy(out + op, in + ip, lits);
+    ip += lits;
+    op += lits;
+    if (ip == inLen) break;
+    if (inLen - ip < 2) return false;
+    const size_t dist = static_cast<size_t>(in[ip]) | (static_cast<size_t>(in[ip + 1]) << 8);
+    ip += 2;
+    size_t len = token & 0x0F;
+    if (len == 15 && !readExt(in, inLen, ip, len)) return false;
+    len += kMinMatch;
+    if (dist == 0 || dist > op || len > outCap - op) return false;
+    // Byte by byte: a match may overlap its own output (a run).
+    for (size_t i = 0; i < len; ++i, ++op) out[op] = out[op - dist];
+  }
+  if (op == 0) return false;
+  outLen = op;
+  return true;
+}
+
+size_t packAt(const firmware::FirmwareByteReader& read, uint32_t streamLen,
+              uint32_t offset, uint16_t chunkSize, Workspace& ws,
+              size_t& consumed) {
+  consumed = 0;
+  if (chunkSize < kMinChunkSize || chunkSize > lamp_protocol::FW_CHUNK_SIZE_MAX ||
+      offset >= streamLen) {
+    return 0;
+  }
+  const size_t want = streamLen - offset < kMaxSpan ? streamLen - offset : kMaxSpan;
+  if (read(offset, want, ws.in) != static_cast<int>(want)) return 0;
+  return pack(ws.in, want, ws.out, chunkSize, ws.table, consumed);
+}
+
+PlanStep planSome(const firmware::FirmwareByteReader& read, uint32_t streamLen,
+                  uint16_t chunkSize, Workspace& ws, std::vector<uint32_t>& starts,
+                  uint32_t& pos, size_t maxUnits) {
+  uint32_t maxUnits32 = 0;
+  if (chunkSize < kMinChunkSize ||
+      !lamp_protocol::offerChunkCountOk(streamLen,
+                                        static_cast<uint16_t>(chunkSize - kSlack),
+                                        maxUnits32)) {
+    starts.clear();
+    return PlanStep::Failed;
+  }
+  // Grown as it goes: maxUnits32 assumes nothing packs, and reserving that up
+  // front would cost the lamp several times the finished plan.
+  for (size_t n = 0; n < maxUnits && pos < streamLen; n++) {
+    size_t consumed = 0;
+    if (starts.size() >= maxUnits32 ||
+        packAt(read, streamLen, pos, chunkSize, ws, consumed) == 0 ||
+        consumed == 0) {
+      starts.clear();
+      return PlanStep::Failed;
+    }
+    starts.push_back(pos);
+    pos += static_cast<uint32_t>(consumed);
+  }
+  if (pos < streamLen) return PlanStep::More;
+  starts.push_back(streamLen);
+  starts.shrink_to_fit();
+  return PlanStep::Done;
+}
+
+bool plan(const firmware::FirmwareByteReader& read, uint32_t streamLen,
+          uint16_t chunkSize, Workspace& ws, std::vector<uint32_t>& starts) {
+  starts.clear();
+  uint32_t pos = 0;
+  return planSome(read, streamLen, chunkSize, ws, starts, pos, SIZE_MAX) ==
+         PlanStep::Done;
+}
+
+}  // namespace ota_pack
+}  // namespace lamp
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "components/firmware/firmware_signature.hpp"  // FirmwareByteReader
+#include "components/network/protocol/fw_ota.hpp"
+
+namespace lamp {
+namespace ota_pack {
+
+// Packed OTA chunks: toward a peer that advertises HELLO_CAP_FW_PACKED, each
+// CHUNK payload is one self-contained LZ unit instead of a raw slice of the
+// stream. A unit decodes to at most kMaxSpan bytes (one flash sector) with no
+// state shared between units, so the receiver decodes it on Core 0 into a
+// sector-sized buffer and writes it straight into the upfront-erased region,
+// the same pure write as a raw chunk. Lost units are REQ'd by index like raw
+// chunks.
+//
+// The CHUNK's offset field carries the stream offset of the unit's first
+// decoded byte, and the OFFER's totalChunks carries the unit count; totalLen
+// still names the stream's (image's or patch's) length. Units tile the stream
+// in order: unit i+1 starts where unit i ends.
+//
+// A unit is a run of sequences, LZ4-style:
+//
+//   token    1 byte          high nibble literal count, low nibble matchLen - 4
+//   [ext]    255-runs        literal count extension when the nibble is 15
+//   literals
+//   offset   2 bytes LE      distance back into this unit's output, 1..4095
+//   [ext]    255-runs        match length extension when the nibble is 15
+//
+// The unit ends when its bytes run out, either right after a sequence's
+// literals (no offset follows) or after a match.
+//
+// The sender packs on the fly from its running slot, so the encoder is a
+// greedy single-probe matcher with a 4 KB hash table: a deflate compressor
+// needs ~300 KB, more than the lamp's heap.
+
+constexpr uint8_t kFormat   = 1;
+constexpr size_t  kMaxSpan  = 4096;
+// Every unit short of the stream's end decodes to at least chunkSize - kSlack
+// bytes, so a unit count above offerChunkCountOk(totalLen, chunkSize - kSlack)
+// is no honest sender's.
+constexpr size_t  kSlack    = 16;
+// Smallest chunk size worth packing.
+constexpr uint16_t kMinChunkSize = 64;
+
+constexpr unsigned kHashBits = 11;
+
+// Encoder scratch (~9.6 KB), off the caller's stack.
+struct Workspace {
+  uint8_t  in[kMaxSpan];
+  uint16_t table[1u << kHashBits];
+  uint8_t  out[lamp_protocol::FW_CHUNK_SIZE_MAX];
+};
+
+// Packs the longest prefix of in[0..inLen) (inLen <= kMaxSpan) that fits in
+// outCap bytes. Returns the unit's length and sets consumed to the input it
+// covers; 0 on bad args. Deterministic, so the same input always packs the
+// same way.
+size_t pack(const uint8_t* in, size_t inLen, uint8_t* out, size_t outCap,
+            uint16_t* table, size_t& consumed);
+
+// Decodes one unit into out (outCap >= the unit's output). False on a
+// malformed unit: a length past the input or outCap, a zero or too-long
+// distance, or no output at all.
+bool unpack(const uint8_t* in, size_t inLen, uint8_t* out, size_t outCap,
+            size_t& outLen);
+
+// Packs the unit starting at stream offset `offset` into ws.out with a
+// chunkSize budget, reading up to kMaxSpan stream bytes through read. Returns
+// the unit's length (0 on a read failure or bad args), and sets consumed.
+size_t packAt(const firmware::FirmwareByteReader& read, uint32_t streamLen,
+              uint32_t offset, uint16_t chunkSize, Workspace& ws,
+              size_t& consumed);
+
+// Packs the whole stream once and records where each unit starts, plus
+// streamLen as a closing entry, so unit i is [starts[i], starts[i+1]). False
+// on a read failure, a chunkSize below kMinChunkSize, or more units than a
+// chunk index can name.
+bool plan(const firmware::FirmwareByteReader& read, uint32_t streamLen,
+          uint16_t chunkSize, Workspace& ws, std::vector<uint32_t>& starts);
+
+// plan() in slices, so a caller can spread one pass over a large image
+// across many short steps. Start with starts empty and pos 0; each call packs
+// up to maxUnits more units from pos and appends their starts. Done closes
+// starts exactly as plan() would; Failed clears it.
+enum class PlanStep : uint8_t { More, Done, Failed };
+PlanStep planSome(const firmware::FirmwareByteReader& read, uint32_t streamLen,
+                  uint16_t chunkSize, Workspace& ws, std::vector<uint32_t>& starts,
+                  uint32_t& pos, size_t maxUnits);
+
+}  // namespace ota_pack
+}  // namespace lamp
@@ -0,0 +1,132 @@
+#include "components/firmware/req_holes.hpp"
+
+#include <cstring>
+
+namespace lamp {
+
+namespace {
+
+bool received(const uint8_t* bitmap, size_t bitmapBytes, size_t idx) {
+  const size_t byteIdx = idx / 8;
+  // Past the bitmap reads as received so a short bitmap never invents holes.
+  if (byteIdx >= bitmapBytes) return true;
+  return (bitmap[byteIdx] >> (idx % 8)) & 1u;
+}
+
+}  // namespace
+
+uint16_t missingRunLen(const uint8_t* bitmap, size_t bitmapBytes,
+                       size_t totalChunks, uint16_t firstMissing,
+                       uint16_t window) {
+  if (firstMissing == UINT16_MAX) return 0;
+  uint16_t lastMissingInWindow = firstMissing;  // first is missing by definition
+  const size_t windowEnd = static_cast<size_t>(firstMissing) + window;
+  for (size_t i = firstMissing; i < totalChunks && i < windowEnd; ++i) {
+    if (i / 8 >= bitmapBytes) break;
+    if (!received(bitmap, bitmapBytes, i)) {
+      lastMissingInWindow = static_cast<uint16_t>(i);
+    }
+  }
+  return static_cast<uint16_t>(lastMissingInWindow - firstMissing + 1);
+}
+
+size_t missingMask(const uint8_t* bitmap, size_t bitmapBytes,
+                   size_t totalChunks, uint16_t base,
+                   uint8_t* mask, size_t cap) {
+  if (!mask || cap == 0) return 0;
+  std::memset(mask, 0, cap);
+  size_t len = 0;
+  for (size_t i = 0; i < cap * 8; ++i) {
+    const size_t idx = static_cast<size_t>(base) + i;
+    if (idx >= totalChunks) break;
+    if (received(bitmap, bitmapBytes, idx)) continue;
+    mask[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+    len = i / 8 + 1;
+  }
+  return len;
+}
+
+bool ReqHoleQueue::load(uint16_t base, const uint8_t* mask, size_t maskLen,
+                        uint16_t forward, uint16_t totalChunks) {
+  clear();
+  if (!mask) return false;
+  if (maskLen > sizeof(mask_)) maskLen = sizeof(mask_);
+  base_ = base;
+  for (size_t i = 0; i < maskLen * 8; ++i) {
+    const size_t idx = static_cast<size_t>(base) + i;
+    if (idx >= forward || idx >= totalChunks) break;
+    if ((mask[i / 8] >> (i % 8)) & 1u) {
+      mask_[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+      ++remaining_;
+    }
+  }
+  return remaining_ != 0;
+}
+
+bool ReqHoleQueue::merge(uint16_t base, const uint8_t* mask, size_t maskLen,
+                         uint16_t forward, uint16_t totalChunks) {
+  if (!active()) return load(base, mask, maskLen, forward, totalChunks);
+  if (!mask) return true;
+  if (maskLen > sizeof(mask_)) maskLen = sizeof(mask_);
+  if (base < base_) {
+    const size_t shift = static_cast<size_t>(base_ - base);
+    uint8_t shifted[sizeof(mask_)] = {0};
+    uint16_t kept = 0;
+    for (size_t bit = 0; bit + shift < lamp_protocol::FW_REQ_MASK_MAX_CHUNKS; ++bit) {
+      if (!test(bit)) continue;
+      const size_t to = bit + shift;
+      shifted[to / 8] |= static_cast<uint8_t>(1u << (to % 8));
+      ++kept;
+    }
+    std::memcpy(mask_, shifted, sizeof(mask_));
+    remaining_ = kept;
+    base_ = base;
+  }
+  for (size_t i = 0; i < maskLen * 8; ++i) {
+    const size_t idx = static_cast<size_t>(base) + i;
+    if (idx >= forward || idx >= totalChunks) break;
+    const size_t bit = idx - base_;
+    if (bit >= lamp_protocol::FW_REQ_MASK_MAX_CHUNKS) break;
+    if (((mask[i / 8] >> (i % 8)) & 1u) == 0 || test(bit)) continue;
+    mask_[bit / 8] |= static_cast<uint8_t>(1u << (bit % 8));
+    ++remaining_;
+  }
+  return active();
+}
+
+uint16_t ReqHoleQueue::front() const {
+  return static_cast<uint16_t>(base_ + nextFrom(0));
+}
+
+bool ReqHoleQueue::served(uint16_t chunkIdx, uint16_t& next) {
+  if (remaining_ == 0) return false;
+  if (chunkIdx >= base_) {
+    const size_t bit = static_cast<size_t>(chunkIdx - base_);
+    if (bit < lamp_protocol::FW_REQ_MASK_MAX_CHUNKS && test(bit)) {
+      mask_[bit / 8] &= static_cast<uint8_t>(~(1u << (bit % 8)));
+      --remaining_;
+    }
+  }
+  if (remaining_ == 0) return false;
+  const size_t from = chunkIdx >= base_ ? static_cast<size_t>(chunkIdx - base_) : 0;
+  size_t bit = nextFrom(from);
+  // A stall rewind can put the cursor past a hole; serve those next pass.
+  if (bit == lamp_protocol::FW_REQ_MASK_MAX_CHUNKS) bit = nextFrom(0);
+  next = static_cast<uint16_t>(base_ + bit);
+  return true;
+}
+
+void ReqHoleQueue::clear() {
+  base_ = 0;
+  remaining_ = 0;
+  std::memset(mask_, 0, sizeof(mask_));
+}
+
+size_t ReqHoleQueue::nextFrom(size_t from) const {
+  for (size_t bit = from; bit < lamp_protocol::FW_REQ_MASK_MAX_CHUNKS; ++bit) {
+    if (test(bit)) return bit;
+  }
+  return lamp_protocol::FW_REQ_MASK_MAX_CHUNKS;
+}
+
+}  // namespace lamp
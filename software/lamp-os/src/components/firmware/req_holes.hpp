@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "components/network/protocol/fw_ota.hpp"
+
+namespace lamp {
+
+// Chunk-loss bookkeeping shared by both ends of a mesh OTA REQ. Pure functions
+// over the receiver's chunk bitmap (one bit per chunk, set = received) plus the
+// distributor's queue of holes to re-serve; callers hold their own locks.
+
+// Smallest count covering ALL missing chunks in a `window`-chunk span from
+// firstMissing (last-unset - first + 1), the legacy run REQ's chunkCount.
+// 0 when firstMissing is UINT16_MAX.
+uint16_t missingRunLen(const uint8_t* bitmap, size_t bitmapBytes,
+                       size_t totalChunks, uint16_t firstMissing,
+                       uint16_t window);
+
+// Fills mask (cap bytes, LSB-first) with bit i set when chunk base+i is
+// missing, over at most cap*8 chunks and never past totalChunks. Returns the
+// mask length with trailing zero bytes trimmed; 0 when nothing is missing.
+size_t missingMask(const uint8_t* bitmap, size_t bitmapBytes,
+                   size_t totalChunks, uint16_t base,
+                   uint8_t* mask, size_t cap);
+
+// Distributor-side queue of the chunks exact-hole REQs named, served in
+// index order.
+class ReqHoleQueue {
+ public:
+  // Replaces the queue with the REQ's holes below `forward` (the stream's
+  // forward cursor: later chunks are still to come in order) and below
+  // totalChunks. Returns false, leaving the queue empty, when none survive.
+  bool load(uint16_t base, const uint8_t* mask, size_t maskLen,
+            uint16_t forward, uint16_t totalChunks);
+
+  // Adds the REQ's holes to the queue instead of replacing it: a group session
+  // serves every member's REQs from one queue. Re-bases down when the REQ
+  // starts lower; queued holes that no longer fit the window are dropped (their
+  // receiver REQs them again). Same as load() on an empty queue. Returns
+  // active().
+  bool merge(uint16_t base, const uint8_t* mask, size_t maskLen,
+             uint16_t forward, uint16_t totalChunks);
+
+  bool active() const { return remaining_ != 0; }
+  uint16_t remaining() const { return remaining_; }
+  // Lowest queued hole. Only meaningful while active().
+  uint16_t front() const;
+
+  // Drops chunkIdx from the queue (no-op if it isn't queued). Returns true and
+  // the next hole above it in `next` while any remain.
+  bool served(uint16_t chunkIdx, uint16_t& next);
+
+  void clear();
+
+ private:
+  bool test(size_t bit) const { return (mask_[bit / 8] >> (bit % 8)) & 1u; }
+  // First queued bit at or above `from`; FW_REQ_MASK_MAX_CHUNKS when none.
+  size_t nextFrom(size_t from) const;
+
+  uint16_t base_ = 0;
+  uint16_t remaining_ = 0;
+  uint8_t  mask_[lamp_protocol::FW_REQ_MASK_MAX_BYTES] = {0};
+};
+
+}  // namespace lamp
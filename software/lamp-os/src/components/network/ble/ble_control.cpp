@@ -6,6 +6,7 @@
 #include <Preferences.h>
 #include <esp_bt.h>
 #include <esp_heap_caps.h>
+#include <esp_random.h>
 
 #include <algorithm>
 #include <array>
@@ -16,7 +17,7 @@
 #include <unordered_set>
 #include <vector>
 
-#include "expr_catalog.h"
+#include "expressions/expr_catalog.hpp"
 
 #include "config/config.hpp"
 #include "behaviors/fade_out.hpp"
@@ -26,12 +27,14 @@
 #include "util/color.hpp"
 #include "util/json_escape.hpp"
 #include "util/heap_probe.hpp"
+#include "util/metrics.hpp"
 #include "core/pending_slot_aggregate.hpp"
 #include "core/override_aggregate.hpp"
 #include "components/firmware/ota_quiet_mode.hpp"
 #include "ble_gap.hpp"
 #include "crypto.hpp"
 #include "components/network/ble/gatt_layout.hpp"
+#include "components/network/ble/section_delta.hpp"
 #include "components/network/ble/social_scan.hpp"
 #include "expressions/expression_manager.hpp"
 #include "components/network/mesh/lamp_roster.hpp"
@@ -133,19 +136,22 @@ struct ConnSlot {
   bool                        authed;
   lamp::crypto::PerConnState  crypto;
   std::string                 pageSnapshot;
+  // Revision envelope head ({"rev":R,"full":) for a revisioned read of a
+  // whole-value section; the body itself stays in pageSnapshot or flash.
+  std::string                 pageHead;
   uint16_t                    pageCursor;
   uint16_t                    pageMtu;
-  // View of the bytes currently being paged out. A heap section serialises
-  // into pageSnapshot and points here at it; a flash section points straight
-  // at its .rodata catalog with zero copy. Empty between sections, so an
-  // unknown/empty section clears this and the next DATA read returns
-  // end-of-section.
-  std::string_view            pageSource;
+  // The bytes currently being paged out. A heap section serialises into
+  // pageSnapshot and points here at it; a flash section points straight at
+  // its .rodata catalog with zero copy; a revisioned read adds pageHead in
+  // front. Empty between sections, so an unknown/empty section clears this
+  // and the next DATA read returns end-of-section.
+  ble_control::PageSource     pageSource;
 };
 static constexpr uint16_t kUnusedHandle = 0xFFFF;
 static constexpr size_t   kMaxConns     = 1;
 static std::array<ConnSlot, kMaxConns> s_conn{{
-  {kUnusedHandle, false, {}, {}, 0, 0, {}},
+  {kUnusedHandle, false, {}, {}, {}, 0, 0, {}},
 }};
 
 // Pinned to ATT_MTU 247 minus the 3-byte ATT header rather than reading
@@ -175,8 +181,9 @@ static ConnSlot* findOrAllocSlot(uint16_t handle) {
   if (freeSlot) {
     freeSlot->handle = handle;
     freeSlot->authed = false;
-    freeSlot->crypto = lamp::crypto::PerConnState{};
+    freeSlot->crypto.reset();
     freeSlot->pageSnapshot.clear();  // keeps capacity
+    freeSlot->pageHead.clear();
     freeSlot->pageCursor = 0;
     freeSlot->pageMtu    = 0;
     freeSlot->pageSource = {};
@@ -189,8 +196,9 @@ static void freeSlot(uint16_t handle) {
   if (auto* s = findSlot(handle)) {
     s->handle = kUnusedHandle;
     s->authed = false;
-    s->crypto = lamp::crypto::PerConnState{};
+    s->crypto.reset();
     std::string().swap(s->pageSnapshot);  // reclaim, not just .clear()
+    std::string().swap(s->pageHead);
     s->pageCursor = 0;
     s->pageMtu    = 0;
     s->pageSource = {};
@@ -202,8 +210,9 @@ static void clearAllSlots() {
   for (auto& s : s_conn) {
     s.handle = kUnusedHandle;
     s.authed = false;
-    s.crypto = lamp::crypto::PerConnState{};
+    s.crypto.reset();
     std::string().swap(s.pageSnapshot);
+    std::string().swap(s.pageHead);
     s.pageCursor = 0;
     s.pageMtu    = 0;
     s.pageSource = {};
@@ -483,8 +492,10 @@ static constexpr uint32_t kNearbyHeapMargin = 1024;
 
 // Builds into `out`, reused in place (cleared, capacity retained) so a
 // steady-state rebuild never allocates once the buffer has grown to the
-// fleet's high-water size.
-static void buildNearbyJson(uint32_t& membershipHashOut,
+// fleet's high-water size. Stages each entry's span, key (lampId, else the
+// escaped name) and app-visible hash into `index`; the caller commits it
+// alongside the swap.
+static void buildNearbyJson(SectionDeltaIndex& index,
                             std::vector<lamp::RosterEntry>& lamps,
                             std::string& out) {
   // Sort by name for stable rendering.
@@ -503,12 +514,14 @@ static void buildNearbyJson(uint32_t& membershipHashOut,
   char buf[96];
   bool first = true;
   const uint32_t now = millis();
-  uint32_t hash = 2166136261u;
+  index.begin();
   for (const auto& p : lamps) {
     if (!first) out += ',';
     first = false;
-    // Membership hash over the app-visible fields only. lastSeenMs and rssi
+    const size_t entryOff = out.size();
+    // Entry hash over the app-visible fields only. lastSeenMs and rssi
     // freshen on every BLE adv (~30 Hz); folding them would churn the rev.
+    uint32_t hash = 2166136261u;
     const uint8_t flags =
         (p.lastSeenNearMs != 0 ? 1 : 0) | (p.lastSeenMeshMs != 0 ? 2 : 0) |
         (lamp::isNearNow(p.lastSeenNearMs, now, LAMP_PRUNE_TIME_MS) ? 4 : 0) |
@@ -523,7 +536,9 @@ static void buildNearbyJson(uint32_t& membershipHashOut,
     fnv1a(hash, &p.otaState, 1);
     if (p.hasOtaSendingTo) fnv1a(hash, p.otaSendingTo, 6);
     out += "{\"name\":\"";
+    size_t keyOff = out.size();
     lamp::appendJsonEscaped(out, p.name);
+    size_t keyLen = out.size() - keyOff;
     // Max of both transport timestamps is the canonical lastSeen.
     const uint32_t lastSeenMs = std::max(p.lastSeenNearMs, p.lastSeenMeshMs);
     snprintf(buf, sizeof(buf), "\",\"lastSeenMs\":%lu,\"viaBle\":%s,\"viaEspNow\":%s,\"near\":%s",
@@ -536,7 +551,9 @@ static void buildNearbyJson(uint32_t& membershipHashOut,
       char macBuf[18];
       lamp::formatBdAddr(p.mac, macBuf);
       out += ",\"lampId\":\"";
+      keyOff = out.size();
       out += macBuf;
+      keyLen = out.size() - keyOff;
       out += '"';
     }
     if (p.lastRssi != -127) {
@@ -567,9 +584,11 @@ static void buildNearbyJson(uint32_t& membershipHashOut,
       out += '"';
     }
     out += '}';
+    uint32_t keyHash = 2166136261u;
+    fnv1a(keyHash, out.data() + keyOff, keyLen);
+    index.add(entryOff, out.size() - entryOff, keyOff, keyLen, keyHash, hash);
   }
   out += ']';
-  membershipHashOut = hash;
 }
 
 // nearby JSON is app-facing only (the Social/Network screens, webapp
@@ -590,9 +609,15 @@ static bool        s_nearbyReady = false;  // guarded by nearbyCacheMutex()
 // and stalest first; the app surfaces "there may be more".
 static constexpr size_t kNearbyMaxLamps = 25;
 
-// Bumped by maintainNearbyJson when the app-visible fields of the served
-// (top-N) set change (excluding the ~30 Hz rssi/lastSeen churn). Surfaced in
-// every stateNotify payload so the app re-reads nearby on a push, not a poll.
+// Per-entry change log over s_nearbyJson, for "nearby@rev" reads. Its rev
+// bumps when the app-visible fields of the served (top-N) set change
+// (excluding the ~30 Hz rssi/lastSeen churn). Staged on Core 1 outside the
+// mutex; commit/retire/appendDelta under it.
+static SectionDeltaIndex s_nearbyIndex;
+
+// The index rev as of the last commit, surfaced in every stateNotify payload
+// so the app re-reads nearby on a push, not a poll. Seeded per boot in
+// start() (see SectionDeltaIndex).
 static uint32_t s_nearbyRev = 0;
 
 void copyNearbyJson(std::string& out) {
@@ -601,6 +626,22 @@ void copyNearbyJson(std::string& out) {
   xSemaphoreGive(nearbyCacheMutex());
 }
 
+// The "nearby@since" answer: the current key order plus the entries changed
+// since `since`, sliced from the cache under the mutex. Unlike a bare read,
+// unchanged entries keep the rssi/lastSeen the app already holds.
+static void copyNearbyDelta(uint32_t since, std::string& out) {
+  out.clear();
+  xSemaphoreTake(nearbyCacheMutex(), portMAX_DELAY);
+  try {
+    out.reserve(s_nearbyIndex.deltaBound(s_nearbyJson));
+    s_nearbyIndex.appendDelta(s_nearbyJson, since, out);
+  } catch (const std::bad_alloc&) {
+    xSemaphoreGive(nearbyCacheMutex());
+    throw;
+  }
+  xSemaphoreGive(nearbyCacheMutex());
+}
+
 // Keep the kNearbyMaxLamps most-relevant entries at the front of `lamps` and
 // drop the rest: near peers before mesh-only, then most-recently-seen, then
 // strongest RSSI. buildNearbyJson re-sorts the survivors by name.
@@ -626,7 +667,6 @@ static void capNearby(std::vector<lamp::RosterEntry>& lamps, uint32_t now) {
 static void maintainNearbyJson() {
   static uint32_t builtGen    = 0;
   static uint32_t lastBuildMs = 0;
-  static uint32_t lastHash    = 0;
   static bool     seeded      = false;
 
   bool wanted = s_clientConnected;
@@ -637,6 +677,7 @@ static void maintainNearbyJson() {
     xSemaphoreTake(nearbyCacheMutex(), portMAX_DELAY);
     if (s_nearbyReady) {
       std::string("[]").swap(s_nearbyJson);  // SSO, reclaims the build heap
+      s_nearbyIndex.retire();
       s_nearbyReady = false;
     }
     xSemaphoreGive(nearbyCacheMutex());
@@ -662,10 +703,9 @@ static void maintainNearbyJson() {
     return;
   }
 
-  uint32_t hash = 0;
   std::string local;
   try {
-    buildNearbyJson(hash, lamps, local);
+    buildNearbyJson(s_nearbyIndex, lamps, local);
   } catch (const std::bad_alloc&) {
     logBleSectionOom("nearby");
     lastBuildMs = now;
@@ -676,23 +716,24 @@ static void maintainNearbyJson() {
     lastBuildMs = now;
     return;
   }
+  // The first build after a (re)connect always bumps and notifies: a
+  // heap-skip can defer it past the app's first read of the idle "[]", and
+  // without a push the app wouldn't know to re-read the now-populated list.
+  // Subsequent builds keep the rssi/lastSeen churn-exclusion and only notify
+  // on a real membership change.
+  const bool firstSinceConnect = !seeded;
+  seeded = true;
   xSemaphoreTake(nearbyCacheMutex(), portMAX_DELAY);
   s_nearbyJson.swap(local);
+  const bool changed = s_nearbyIndex.commit(firstSinceConnect);
+  s_nearbyRev = s_nearbyIndex.rev();
   s_nearbyReady = true;
   xSemaphoreGive(nearbyCacheMutex());
-  builtGen    = gen;
+  // The copy's own stamp: a write landing between generation() and getAll()
+  // is already in `lamps`, so it mustn't trigger a second rebuild.
+  builtGen    = lamp::lampRoster.viewGeneration();
   lastBuildMs = now;
-  // The first build after a (re)connect always notifies: a heap-skip can defer
-  // it past the app's first read of the idle "[]", and without a push the app
-  // wouldn't know to re-read the now-populated list. Subsequent builds keep the
-  // rssi/lastSeen churn-exclusion and only notify on a real membership change.
-  const bool firstSinceConnect = !seeded;
-  seeded = true;
-  if (firstSinceConnect || hash != lastHash) {
-    lastHash = hash;
-    ++s_nearbyRev;
-    notifyStateChange();
-  }
+  if (changed) notifyStateChange();
 }
 
 // Auth-gated on read and write: the disposition map reveals peer
@@ -893,18 +934,28 @@ class SettingsBlobCallback : public NimBLECharacteristicCallbacks {
 // rather than using ATT_READ_BLOB_REQ against a cached value.
 
 using SectionSerializer = void(*)(std::string&);
+using SectionDeltaSerializer = void(*)(uint32_t since, std::string&);
 
 // A section serves one of two ways. fn serialises into the connection's
 // pageSnapshot on open (heap). flashData/flashLen instead point the page
 // source straight at a committed .rodata buffer, served by reference with
 // zero heap; fn is null for those.
+//
+// A "name@rev" open (see section_delta.hpp) answers with a revision
+// envelope instead. delta, when set, builds it whole (nearby's per-entry
+// diff); otherwise the section's content hash is its rev and the body is
+// wrapped by reference. Binary sections aren't revisioned, so "name@rev" on
+// them reads as an unknown section.
 struct SectionEntry {
   const char*                 name;
   SectionSerializer           fn;
   const char*                 flashData = nullptr;
   size_t                      flashLen  = 0;
+  SectionDeltaSerializer      delta     = nullptr;
+  bool                        revisioned = true;
 };
 
+
 // Lambdas capture only globals so they decay to plain function pointers
 // (no std::function footprint). Cached() accessors rebuild and copy out
 // under Config's cache mutex, so calling here on the Core 0 host task is
@@ -916,55 +967,97 @@ struct SectionEntry {
 // the 512-byte ATT ceiling that caps the CHAR_WISP_CLAIMS direct read.
 // wisppalette is binary too (raw RGBW): a dedicated read path so the
 // frequent palette-less status NOTIFY can't clobber it.
-static const std::array<SectionEntry, 9> kSections = {{
+// metrics is the binary util/metrics.hpp snapshot. It reads Core 1's
+// histograms from Core 0 without a lock; a torn sample is acceptable for a
+// diagnostic.
+static const std::array<SectionEntry, 10> kSections = {{
   {"lamp",    [](std::string& out) { s_config->lampSectionJsonCached(out); }},
   {"base",    [](std::string& out) { s_config->baseSectionJsonCached(out); }},
   {"shade",   [](std::string& out) { s_config->shadeSectionJsonCached(out); }},
   {"expr",    [](std::string& out) { s_config->expressionsSectionJsonCached(out); }},
   {"home",    [](std::string& out) { s_config->homeSectionJsonCached(out); }},
-  {"nearby",  [](std::string& out) { copyNearbyJson(out); }},
+  {"nearby",  [](std::string& out) { copyNearbyJson(out); }, nullptr, 0,
+   copyNearbyDelta},
   {"exprcat", nullptr, lamp::kExprCatalog, lamp::kExprCatalogLen},
   {"wispclaims", [](std::string& out) {
     static uint8_t buf[1 + lamp::WispFleetCache::kCapacity * 12];
     const size_t n = lamp::lampRoster.buildWispClaimsBlob(buf, sizeof(buf),
                                                           millis());
     out.assign(reinterpret_cast<const char*>(buf), n);
-  }},
+  }, nullptr, 0, nullptr, false},
   {"wisppalette", [](std::string& out) {
     static uint8_t buf[200];
     const size_t n = lamp::lampRoster.copyManualPaletteBlob(buf, sizeof(buf));
     out.assign(reinterpret_cast<const char*>(buf), n);
-  }},
+  }, nullptr, 0, nullptr, false},
+  {"metrics", [](std::string& out) {
+    static uint8_t buf[lamp::metrics::Registry::kMaxSnapshotBytes];
+    const size_t n = lamp::metrics::registry().writeSnapshot(buf, sizeof(buf),
+                                                             millis());
+    out.assign(reinterpret_cast<const char*>(buf), n);
+  }, nullptr, 0, nullptr, false},
 }};
 
+// Point `slot` at `entry`'s bytes, in a revision envelope when `revisioned`.
+// Throws std::bad_alloc from the heap serialisers.
+static void openSection(ConnSlot* slot, const SectionEntry& entry,
+                        bool revisioned, uint32_t since) {
+  slot->pageHead.clear();
+  if (revisioned && entry.delta) {
+    entry.delta(since, slot->pageSnapshot);
+    slot->pageSource = {{slot->pageSnapshot}};
+    return;
+  }
+  std::string_view body;
+  if (entry.flashData) {
+    // Serve the committed catalog straight from .rodata; no heap.
+    body = std::string_view(entry.flashData, entry.flashLen);
+  } else {
+    // Serialises into pageSnapshot, reusing its existing capacity.
+    entry.fn(slot->pageSnapshot);
+    body = slot->pageSnapshot;
+  }
+  if (!revisioned) {
+    slot->pageSource = {{body}};
+    return;
+  }
+  // exprcat's rev is the build-time catalog hash the lamp section already
+  // reports as catalogHash; the heap sections hash what they just serialised.
+  const uint32_t rev = entry.flashData ? (lamp::kExprCatalogHash ? lamp::kExprCatalogHash : 1)
+                                       : sectionContentRev(body);
+  if (appendFullHead(slot->pageHead, rev, since)) {
+    slot->pageSource = {{slot->pageHead, body, kFullTail}};
+  } else {
+    slot->pageSource = {{slot->pageHead}};
+  }
+}
+
 class PageCtrlCallback : public NimBLECharacteristicCallbacks {
   void onWrite(NimBLECharacteristic* c, NimBLEConnInfo& connInfo) override {
     const uint16_t handle = connInfo.getConnHandle();
     if (!isAuthed(handle)) return;
-    const std::string name = c->getValue();
-    if (name.empty() || name.size() > 16) return;
+    const std::string request = c->getValue();
+    if (request.empty() || request.size() > 32) return;
 
     ConnSlot* slot = findSlot(handle);
     if (!slot) return;
 
+    std::string_view name;
+    uint32_t since = 0;
+    const bool revisioned = parseRevisionedRequest(request, name, since);
+
     for (const auto& entry : kSections) {
-      if (name == entry.name) {
-        if (entry.flashData) {
-          // Serve the committed catalog straight from .rodata; no heap.
-          slot->pageSource = std::string_view(entry.flashData, entry.flashLen);
-        } else {
-          // Serialises into pageSnapshot, reusing its existing capacity.
-          try {
-            entry.fn(slot->pageSnapshot);
-          } catch (const std::bad_alloc&) {
-            slot->pageSnapshot.clear();
-            slot->pageCursor = 0;
-            slot->pageMtu    = 0;
-            slot->pageSource = {};
-            logBleSectionOom(entry.name);
-            return;
-          }
-          slot->pageSource = slot->pageSnapshot;
+      if (name == entry.name && (!revisioned || entry.revisioned)) {
+        try {
+          openSection(slot, entry, revisioned, since);
+        } catch (const std::bad_alloc&) {
+          slot->pageSnapshot.clear();
+          slot->pageHead.clear();
+          slot->pageCursor = 0;
+          slot->pageMtu    = 0;
+          slot->pageSource = {};
+          logBleSectionOom(entry.name);
+          return;
         }
         slot->pageCursor = 0;
         // Cap the chunk at the baseline-MTU page size even when this link
@@ -975,8 +1068,10 @@ class PageCtrlCallback : public NimBLECharacteristicCallbacks {
         slot->pageMtu = (cap > 0 && cap < kPageMaxChunkSize) ? cap
                                                               : kPageMaxChunkSize;
 #ifdef LAMP_DEBUG
-        Serial.printf("[ble_control] page CTRL section=%s len=%u mtu=%u chunk=%u\n",
-                      entry.name, (unsigned)slot->pageSource.size(),
+        Serial.printf("[ble_control] page CTRL section=%s revisioned=%d since=%lu len=%u mtu=%u chunk=%u\n",
+                      entry.name, revisioned ? 1 : 0,
+                      static_cast<unsigned long>(since),
+                      (unsigned)slot->pageSource.size(),
                       (unsigned)mtu, (unsigned)slot->pageMtu);
 #endif
         return;
@@ -986,12 +1081,13 @@ class PageCtrlCallback : public NimBLECharacteristicCallbacks {
     // Unknown section: clear so the next DATA read returns empty, which
     // the app treats as "section not found".
     slot->pageSnapshot.clear();
+    slot->pageHead.clear();
     slot->pageCursor = 0;
     slot->pageMtu    = 0;
     slot->pageSource = {};
 #ifdef LAMP_DEBUG
     Serial.printf("[ble_control] page CTRL unknown section='%.*s'\n",
-                  (int)name.size(), name.data());
+                  (int)request.size(), request.data());
 #endif
   }
 };
@@ -1013,8 +1109,15 @@ class PageDataCallback : public NimBLECharacteristicCallbacks {
     const size_t remaining = slot->pageSource.size() - slot->pageCursor;
     const size_t take      = remaining < slot->pageMtu ? remaining
                                                        : slot->pageMtu;
-    c->setValue(reinterpret_cast<const uint8_t*>(slot->pageSource.data() +
-                                                  slot->pageCursor),
+    // A chunk straddling the envelope head and the body is stitched in a
+    // stack buffer; every other chunk goes out by reference as before.
+    const char* src = slot->pageSource.contiguous(slot->pageCursor, take);
+    char stitched[kPageMaxChunkSize];
+    if (!src) {
+      slot->pageSource.copy(slot->pageCursor, stitched, take);
+      src = stitched;
+    }
+    c->setValue(reinterpret_cast<const uint8_t*>(src),
                 static_cast<size_t>(take));
     slot->pageCursor += static_cast<uint16_t>(take);
 #ifdef LAMP_DEBUG
@@ -1206,6 +1309,15 @@ void start(lamp::Config* config) {
 
   s_config = config;
 
+  // Once per boot, not per start(): the index keeps its history across a
+  // stop/start. Top bit clear so the rev never wraps within a boot.
+  static bool nearbyRevSeeded = false;
+  if (!nearbyRevSeeded) {
+    nearbyRevSeeded = true;
+    s_nearbyIndex.seed(esp_random() >> 1);
+    s_nearbyRev = s_nearbyIndex.rev();
+  }
+
   if (!NimBLEDevice::isInitialized()) {
     NimBLEDevice::init(config->lamp.name.substr(0, 12));
   }
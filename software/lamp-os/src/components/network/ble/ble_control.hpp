@@ -50,6 +50,10 @@ constexpr const char* CHAR_WIFI_STATE      = "5f64f4db-d6d9-4a44-9b3f-3a8d6f7e6b
 //     Lamp snapshots that section's cached JSON into the connection slot
 //     and resets a cursor. Subsequent CTRL writes replace the snapshot.
 //     Known names: "lamp", "base", "shade", "expr", "home", "nearby".
+//     "name@rev" instead asks for changes since a revision the app holds
+//     ("name@0" = none), answered as a {"rev":R,...} envelope: "full" for a
+//     changed whole-value section, "keys"+"upsert" for nearby, just the rev
+//     when unchanged. Format in section_delta.hpp.
 //   CHAR_PAGE_DATA (read): each read returns the next chunk of bytes
 //     starting at the cursor. A read returning fewer bytes than the
 //     hardcoded chunk size (244 = ATT_MTU 247 - 3 ATT header) signals
@@ -24,7 +24,8 @@ bool decryptOp(const uint8_t* p, size_t n,
     if (seen == nonceArr) return false;
   }
 
-  if (!lampos::crypto::decryptPayload(p, n, uuidLE16, name, password, out)) {
+  if (!lampos::crypto::decryptPayload(p, n, uuidLE16, name, password,
+                                      conn.keys, out)) {
     return false;
   }
 
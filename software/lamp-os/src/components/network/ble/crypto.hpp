@@ -20,16 +20,23 @@ constexpr size_t MAX_RECENT_NONCES = 32;
 // ciphertext length equals plaintext length.
 constexpr size_t WIRE_OVERHEAD = 1 + NONCE_LEN + TAG_LEN;
 
-/// Per-connection sliding window of recently-seen nonces. Reset on
-/// disconnect.
+/// Per-connection sliding window of recently-seen nonces plus the derived
+/// per-characteristic GCM keys. reset() on connect and disconnect.
 struct PerConnState {
   std::deque<std::array<uint8_t, NONCE_LEN>> recentNonces;
+  lampos::crypto::KeyCache keys;
+
+  void reset() {
+    std::deque<std::array<uint8_t, NONCE_LEN>>().swap(recentNonces);
+    keys.clear();
+  }
 };
 
 /// Returns true on success and writes the plaintext to [out]. Derive +
 /// AES-256-GCM decrypt is the shared core in software/shared/crypto; this
 /// wrapper adds a per-connection replay check, rejecting a duplicate nonce
-/// within [conn.recentNonces].
+/// within [conn.recentNonces], and serves the derived key from [conn.keys]
+/// so a slider drag's burst of writes derives once.
 bool decryptOp(const uint8_t* payload, size_t payloadLen,
                const uint8_t* charUuidLE16,    // 16 bytes
                const char* charShortName,
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ble_control {
+
+// Revisioned page reads. A CHAR_PAGE_CTRL write of "name@rev" (rev in
+// decimal, the value the app got from its last read of that section) asks
+// "what changed since rev" instead of a fresh snapshot. Every revisioned
+// answer is a JSON object carrying the section's current "rev":
+//
+//   {"rev":R}                                   not modified: one short read
+//   {"rev":R,"full":<section json>}             whole-value section changed
+//   {"rev":R,"keys":[k...],"upsert":[e...]}     array section (nearby): the
+//                                               current key order, plus only
+//                                               the entries changed since rev
+//
+// A bare "name" write is unchanged: the section's JSON, unwrapped, so older
+// apps keep working. An app holding no copy sends "name@0".
+//
+// Whole-value sections (lamp, base, shade, expr, home, exprcat) use a
+// content hash as their rev, so a rev stays meaningful across reconnects and
+// reboots. An array section can't diff against a hash, so it keeps a
+// SectionDeltaIndex: a monotonic rev plus, per entry, the rev it last
+// changed at. Pure logic; ble_control.cpp drives it and test_section_delta
+// pins it natively.
+
+// Split "name@rev". Returns false (name = the whole request) when there is
+// no "@" or the rev isn't a plain decimal u32.
+inline bool parseRevisionedRequest(std::string_view req, std::string_view& name,
+                                   uint32_t& rev) {
+  name = req;
+  const size_t at = req.find('@');
+  if (at == std::string_view::npos) return false;
+  const std::string_view digits = req.substr(at + 1);
+  if (digits.empty() || digits.size() > 10) return false;
+  uint64_t v = 0;
+  for (char c : digits) {
+    if (c < '0' || c > '9') return false;
+    v = v * 10 + static_cast<uint64_t>(c - '0');
+  }
+  if (v > 0xFFFFFFFFu) return false;
+  name = req.substr(0, at);
+  rev = static_cast<uint32_t>(v);
+  return true;
+}
+
+// FNV-1a of a whole-value section's bytes, never 0 ("@0" means "no copy").
+inline uint32_t sectionContentRev(std::string_view body) {
+  uint32_t h = 2166136261u;
+  for (unsigned char c : body) h = (h ^ c) * 16777619u;
+  return h != 0 ? h : 1;
+}
+
+inline void appendRevField(std::string& out, uint32_t rev) {
+  char buf[20];
+  std::snprintf(buf, sizeof(buf), "{\"rev\":%lu", static_cast<unsigned long>(rev));
+  out += buf;
+}
+
+// Envelope head for a whole-value section: the not-modified answer when the
+// app already holds `rev` (the whole reply, `body` not needed), otherwise the
+// "full" prefix the caller follows with the body and kFullTail.
+inline bool appendFullHead(std::string& out, uint32_t rev, uint32_t since) {
+  appendRevField(out, rev);
+  if (since == rev) {
+    out += '}';
+    return false;
+  }
+  out += ",\"full\":";
+  return true;
+}
+inline constexpr std::string_view kFullTail = "}";
+
+// Up to three byte ranges served as one page stream, so an envelope can wrap
+// a flash-resident body (exprcat) without copying it to the heap.
+struct PageSource {
+  std::string_view parts[3];
+
+  size_t size() const { return parts[0].size() + parts[1].size() + parts[2].size(); }
+
+  // Pointer to `n` contiguous bytes at `off`, or nullptr when the range
+  // straddles a part boundary (copy() it instead).
+  const char* contiguous(size_t off, size_t n) const {
+    for (const auto& p : parts) {
+      if (off < p.size()) return off + n <= p.size() ? p.data() + off : nullptr;
+      off -= p.size();
+    }
+    return nullptr;
+  }
+
+  size_t copy(size_t off, char* dst, size_t n) const {
+    size_t done = 0;
+    for (const auto& p : parts) {
+      if (done == n) break;
+      if (off >= p.size()) {
+        off -= p.size();
+        continue;
+      }
+      const size_t take = std::min(n - done, p.size() - off);
+      std::memcpy(dst + done, p.data() + off, take);
+      done += take;
+      off = 0;
+    }
+    return done;
+  }
+};
+
+// Change log for an array section whose JSON is rebuilt whole. Each rebuild
+// stages its entries (byte spans into the new JSON, a key span, and a hash
+// of the entry's app-visible fields); commit() keeps the rev of every entry
+// whose hash is unchanged and stamps the rest with a bumped section rev.
+// appendDelta() then slices the changed entries back out of that JSON, so
+// the index holds spans, not a second copy of the entries.
+//
+// The staging half (begin/add) and the serving half (rev/appendDelta) may
+// run on different tasks; commit() and retire() must run under the same lock
+// as appendDelta() and the swap of the JSON the spans point into.
+//
+// Seed the rev randomly per boot: an app's rev from a previous boot then
+// lands outside this boot's range and just gets every entry again.
+class SectionDeltaIndex {
+ public:
+  struct Item {
+    uint32_t off, len;        // entry object within the JSON; len 0 = retired
+    uint32_t keyOff, keyLen;  // key string contents within the JSON
+    uint32_t keyHash, hash;
+    uint32_t rev;             // section rev this entry last changed at
+  };
+
+  void seed(uint32_t rev) { rev_ = rev; }
+  uint32_t rev() const { return rev_; }
+  size_t size() const { return items_.size(); }
+
+  void begin() { staged_.clear(); }
+  void add(size_t off, size_t len, size_t keyOff, size_t keyLen,
+           uint32_t keyHash, uint32_t hash) {
+    staged_.push_back({static_cast<uint32_t>(off), static_cast<uint32_t>(len),
+                       static_cast<uint32_t>(keyOff), static_cast<uint32_t>(keyLen),
+                       keyHash, hash, 0});
+  }
+
+  // Publish the staged entries. Bumps the rev when an entry was added,
+  // changed or removed, or when `forceBump`. Returns whether it bumped.
+  bool commit(bool forceBump) {
+    bool changed = forceBump || staged_.size() != items_.size();
+    for (Item& s : staged_) {
+      const Item* old = find(s.keyHash);
+      if (old && old->hash == s.hash) {
+        s.rev = old->rev;
+      } else {
+        s.rev = 0;  // stamped below
+        changed = true;
+      }
+    }
+    if (changed) {
+      ++rev_;
+      for (Item& s : staged_) {
+        if (s.rev == 0) s.rev = rev_;
+      }
+    }
+    items_.swap(staged_);
+    return changed;
+  }
+
+  // The JSON was freed: stop serving entries but keep each one's hash and
+  // rev, so an app reconnecting with its old rev gets only what changed
+  // while it was away. The rev carries on.
+  void retire() {
+    for (Item& it : items_) it.len = 0;
+    std::vector<Item>().swap(staged_);
+  }
+
+  // The answer for an app holding `since`, sliced from `json` (the body the
+  // committed spans index). A `since` ahead of this index's rev is unknown
+  // (another boot): every entry is sent.
+  void appendDelta(std::string_view json, uint32_t since, std::string& out) const {
+    appendRevField(out, rev_);
+    if (since == rev_) {
+      out += '}';
+      return;
+    }
+    const bool all = since > rev_;
+    out += ",\"keys\":[";
+    bool first = true;
+    for (const Item& it : items_) {
+      if (it.len == 0) continue;  // retired
+      if (!first) out += ',';
+      first = false;
+      out += '"';
+      out.append(json.substr(it.keyOff, it.keyLen));
+      out += '"';
+    }
+    out += "],\"upsert\":[";
+    first = true;
+    for (const Item& it : items_) {
+      if (it.len == 0 || (!all && it.rev <= since)) continue;
+      if (!first) out += ',';
+      first = false;
+      out.append(json.substr(it.off, it.len));
+    }
+    out += "]}";
+  }
+
+  // Upper bound on appendDelta's output, for a reserve().
+  size_t deltaBound(std::string_view json) const {
+    size_t n = 48 + json.size();
+    for (const Item& it : items_) n += it.keyLen + 3;
+    return n;
+  }
+
+ private:
+  const Item* find(uint32_t keyHash) const {
+    for (const Item& it : items_) {
+      if (it.keyHash == keyHash) return &it;
+    }
+    return nullptr;
+  }
+
+  std::vector<Item> items_;
+  std::vector<Item> staged_;
+  uint32_t rev_ = 0;
+};
+
+}  // namespace ble_control
@@ -0,0 +1,38 @@
+#include "airtime_controller.hpp"
+
+namespace lamp {
+
+bool AirtimeController::update(uint32_t nowMs) {
+  if (!started_) {
+    started_ = true;
+    windowStartMs_ = nowMs;
+    busyUs_.store(0, std::memory_order_relaxed);
+    return false;
+  }
+  const uint32_t elapsedMs = nowMs - windowStartMs_;
+  if (elapsedMs < kAirtimeWindowMs) return false;
+  windowStartMs_ = nowMs;
+
+  // busyUs / (elapsedMs * 1000) in permille is busyUs / elapsedMs.
+  const uint32_t busyUs = busyUs_.exchange(0, std::memory_order_relaxed);
+  const uint32_t util = busyUs / elapsedMs;
+  utilPermille_ = static_cast<uint16_t>(util > 1000 ? 1000 : util);
+
+  if (utilPermille_ > kAirtimeHighPermille) {
+    const uint32_t next = helloIntervalMs_ + helloIntervalMs_ / 2;
+    helloIntervalMs_ = next > LAMP_HELLO_INTERVAL_MAX_MS ? LAMP_HELLO_INTERVAL_MAX_MS
+                                                         : next;
+    relayPermille_ = relayPermille_ > kRelayPermilleMin + kRelayPermilleStep
+                         ? relayPermille_ - kRelayPermilleStep
+                         : kRelayPermilleMin;
+  } else if (utilPermille_ < kAirtimeLowPermille) {
+    const uint32_t next = helloIntervalMs_ * 3 / 4;
+    helloIntervalMs_ = next < LAMP_HELLO_INTERVAL_MS ? LAMP_HELLO_INTERVAL_MS : next;
+    relayPermille_ = relayPermille_ + kRelayPermilleStep > 1000
+                         ? 1000
+                         : relayPermille_ + kRelayPermilleStep;
+  }
+  return true;
+}
+
+}  // namespace lamp
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "hello_interval.hpp"
+#include "meshmix.hpp"
+
+namespace lamp {
+
+// Channel-utilization budget, in permille of wall-clock time, as this lamp
+// hears it. Above kAirtimeHighPermille the controller backs HELLO off; below
+// kAirtimeLowPermille it walks back toward the static cadence. The band
+// between holds steady so neighbors sampling the same channel don't
+// oscillate together.
+constexpr uint16_t kAirtimeHighPermille = 250;
+constexpr uint16_t kAirtimeLowPermille = 150;
+constexpr uint32_t kAirtimeWindowMs = 10000;
+
+// Relay probability floor for partly covered HELLOs. Entries fewer than two
+// neighbors relayed are never thinned (HelloRelaySuppressor), so this only
+// trims the redundant middle of a dense mesh; in the host mesh model a lower
+// floor started costing lamp pairs consecutive HELLOs.
+constexpr uint16_t kRelayPermilleMin = 500;
+constexpr uint16_t kRelayPermilleStep = 125;
+
+// Trickle-style HELLO airtime controller. Every frame this lamp hears or
+// sends is charged to a window at MeshMix::frameAirtimeUs; each closed window
+// yields a utilization estimate. Over budget, the steady HELLO interval grows
+// by half (up to LAMP_HELLO_INTERVAL_MAX_MS) and the partial-coverage relay
+// probability drops a step; under the low-water mark both recover a step.
+// HELLO + relay traffic scales ~N²/interval, so as the fleet grows this
+// hands the channel back to MSG_WISP_STATE and OTA chunks, while a small
+// fleet never leaves the static 30 s cadence.
+//
+// noteFrame is any-task (recv task and loop task both charge it); update and
+// the getters are loop task only. Clock is injected for the host mesh model.
+class AirtimeController {
+ public:
+  void noteFrame(size_t len) {
+    busyUs_.fetch_add(MeshMix::frameAirtimeUs(len), std::memory_order_relaxed);
+  }
+
+  // Closes the window once kAirtimeWindowMs has elapsed and adapts. Returns
+  // true when it did.
+  bool update(uint32_t nowMs);
+
+  uint32_t helloIntervalMs() const { return helloIntervalMs_; }
+  uint16_t relayPermille() const { return relayPermille_; }
+  // Utilization of the last closed window, permille (0 before the first).
+  uint16_t utilizationPermille() const { return utilPermille_; }
+
+ private:
+  std::atomic<uint32_t> busyUs_{0};
+  uint32_t windowStartMs_ = 0;
+  bool started_ = false;
+  uint32_t helloIntervalMs_ = LAMP_HELLO_INTERVAL_MS;
+  uint16_t relayPermille_ = 1000;
+  uint16_t utilPermille_ = 0;
+};
+
+}  // namespace lamp
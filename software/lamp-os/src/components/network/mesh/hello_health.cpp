@@ -0,0 +1,54 @@
+#include "hello_health.hpp"
+
+namespace lamp {
+
+HelloHealthSampler::HelloHealthSampler(metrics::Registry& reg)
+    : frameUs_(reg.histogram("frame.us")),
+      frameDrop_(reg.counter("frame.drop")),
+      relay_(reg.counter("mesh.relay")),
+      heapLow_(reg.gauge("heap.low")),
+      heapLargest_(reg.gauge("heap.largest")),
+      slotDrop_(reg.gauge("slot.drop")),
+      rxDrop_(reg.gauge("rxq.drop")) {}
+
+bool HelloHealthSampler::poll(uint32_t nowMs, lamp_protocol::HelloHealth& out) {
+  const uint32_t elapsedMs = nowMs - lastReportMs_;
+  if (elapsedMs < kIntervalMs) return false;
+
+  // A metrics.reset from the console empties the histogram mid-window; the
+  // report then covers the samples since the reset. The count alone can't
+  // tell: more frames than the baseline may have landed since.
+  const auto& buckets = frameUs_.buckets();
+  if (frameUs_.generation() != prevGeneration_) {
+    prevBuckets_.fill(0);
+    prevFrames_ = 0;
+    prevGeneration_ = frameUs_.generation();
+  }
+  std::array<uint32_t, metrics::Histogram::kBuckets> window;
+  for (size_t b = 0; b < window.size(); b++) window[b] = buckets[b] - prevBuckets_[b];
+  const uint32_t frames = frameUs_.count() - prevFrames_;
+  const uint32_t p99 = metrics::Histogram::percentileOf(window, frames, 99);
+  out.frameP99Us = p99 < frameUs_.max() ? p99 : frameUs_.max();
+
+  const uint32_t frameDrops = frameDrop_.value();
+  const uint32_t relays = relay_.value();
+  const uint32_t slotDrops = static_cast<uint32_t>(slotDrop_.value()) +
+                             static_cast<uint32_t>(rxDrop_.value());
+  out.frameDrops = lamp_protocol::saturateU16(frameDrops - prevFrameDrops_);
+  out.slotDrops = lamp_protocol::saturateU16(slotDrops - prevSlotDrops_);
+  out.relayPerMin = lamp_protocol::saturateU16(static_cast<uint32_t>(
+      static_cast<uint64_t>(relays - prevRelays_) * 60000 / elapsedMs));
+  out.heapLowKb = lamp_protocol::saturateU16(static_cast<uint32_t>(heapLow_.value()) / 1024);
+  out.heapLargestKb =
+      lamp_protocol::saturateU16(static_cast<uint32_t>(heapLargest_.value()) / 1024);
+
+  prevBuckets_ = buckets;
+  prevFrames_ = frameUs_.count();
+  prevFrameDrops_ = frameDrops;
+  prevRelays_ = relays;
+  prevSlotDrops_ = slotDrops;
+  lastReportMs_ = nowMs;
+  return true;
+}
+
+}  // namespace lamp
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "components/network/protocol/lamp_protocol.hpp"
+
+#include "util/metrics.hpp"
+
+namespace lamp {
+
+/**
+ * Builds the HELLO_TLV_HEALTH report from the metrics registry. Every
+ *        kIntervalMs (about every other steady-state HELLO) poll() hands back
+ *        the window since the previous report: frame-time p99 over the
+ *        frame.us samples recorded in between, frames dropped, pending-slot
+ *        plus rx-queue drops, relays per minute, and the current heap
+ *        low-water / largest block. Loop task only (emitHello).
+ */
+class HelloHealthSampler {
+ public:
+  static constexpr uint32_t kIntervalMs = 55000;
+
+  explicit HelloHealthSampler(metrics::Registry& reg = metrics::registry());
+
+  // True, with `out` filled, once kIntervalMs has passed since the last
+  // report (or since boot). False leaves `out` untouched.
+  bool poll(uint32_t nowMs, lamp_protocol::HelloHealth& out);
+
+ private:
+  metrics::Histogram& frameUs_;
+  metrics::Counter& frameDrop_;
+  metrics::Counter& relay_;
+  metrics::Gauge& heapLow_;
+  metrics::Gauge& heapLargest_;
+  metrics::Gauge& slotDrop_;
+  metrics::Gauge& rxDrop_;
+
+  std::array<uint32_t, metrics::Histogram::kBuckets> prevBuckets_{};
+  uint32_t prevFrames_ = 0;
+  uint32_t prevGeneration_ = 0;
+  uint32_t prevFrameDrops_ = 0;
+  uint32_t prevRelays_ = 0;
+  uint32_t prevSlotDrops_ = 0;
+  uint32_t lastReportMs_ = 0;
+};
+
+}  // namespace lamp
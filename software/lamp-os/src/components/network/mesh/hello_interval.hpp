@@ -20,13 +20,19 @@ static_assert(LAMP_HELLO_INTERVAL_MS == 30000,
 #define LAMP_HELLO_BURST_WINDOW_MS 30000
 #define LAMP_HELLO_BURST_INTERVAL_MS 5000
 
+// Ceiling for the airtime controller's stretched steady interval
+// (airtime_controller.hpp). Prune still tolerates 4 missed emits at 60s.
+#define LAMP_HELLO_INTERVAL_MAX_MS 60000
+
 namespace lamp {
 
 // millis() is uptime-since-boot, so uptimeMs < window naturally IS the boot
-// window.
-inline uint32_t helloIntervalMs(uint32_t uptimeMs) {
+// window. `steadyMs` is the post-burst interval, the airtime controller's
+// current choice on the lamp.
+inline uint32_t helloIntervalMs(uint32_t uptimeMs,
+                                uint32_t steadyMs = LAMP_HELLO_INTERVAL_MS) {
   return uptimeMs < LAMP_HELLO_BURST_WINDOW_MS ? LAMP_HELLO_BURST_INTERVAL_MS
-                                               : LAMP_HELLO_INTERVAL_MS;
+                                               : steadyMs;
 }
 
 }  // namespace lamp
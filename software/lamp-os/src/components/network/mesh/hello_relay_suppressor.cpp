@@ -14,6 +14,15 @@ uint32_t HelloRelaySuppressor::jitterMs(const uint8_t mac[6], uint16_t seq) {
   return kHelloRelayJitterMinMs + (h % span);
 }
 
+bool HelloRelaySuppressor::relayAdmitted(const uint8_t mac[6], uint16_t seq,
+                                         uint32_t salt, uint16_t relayPermille) {
+  if (relayPermille >= 1000) return true;
+  uint32_t h = (seq ^ salt) * 0x9E3779B1u;
+  for (int i = 0; i < 6; ++i) h = (h ^ mac[i]) * 0x01000193u;
+  h ^= h >> 16;
+  return h % 1000 < relayPermille;
+}
+
 HelloRelaySuppressor::Pending* HelloRelaySuppressor::find(const uint8_t mac[6],
                                                           uint16_t seq) {
   for (auto& e : slots_) {
@@ -73,7 +82,10 @@ void HelloRelaySuppressor::tick(uint32_t nowMs, const RelayFn& relay) {
     uint16_t len = 0;
     LAMP_PROTOCOL_PORTMUX_ENTER(&mux_);
     if (e.used && nowMs >= e.fireAtMs) {
-      if (e.dupCount < kHelloSuppressThreshold) {
+      const bool covered = e.dupCount >= kHelloSuppressThreshold ||
+                           (e.dupCount > 1 &&
+                            !relayAdmitted(e.mac, e.seq, salt_, relayPermille_));
+      if (!covered) {
         std::memcpy(frame, e.frame, e.len);
         len = e.len;
 #ifdef LAMP_DEBUG
@@ -31,6 +31,11 @@ constexpr size_t kHelloPendingSlots = 16;
 // fire time an entry with >= kHelloSuppressThreshold duplicates is dropped (the
 // mesh already covered it); otherwise the stored frame is relayed verbatim.
 //
+// Under channel load the airtime controller also thins the under-covered
+// relays (setRelayGate): an entry that heard two or more duplicates but
+// fewer than the threshold relays with probability relayPermille/1000. One
+// with fewer always relays, since it may be the only path to a far edge.
+//
 // Clock is injected: onFirstSeen/tick take nowMs so native tests drive a fake
 // clock. Jitter is derived deterministically from (mac, seq), never rand().
 class HelloRelaySuppressor {
@@ -53,6 +58,18 @@ class HelloRelaySuppressor {
   // native timing test to compute the exact fire boundary.
   static uint32_t jitterMs(const uint8_t mac[6], uint16_t seq);
 
+  // Relay probability for partly covered entries, 0..1000. `salt` (this
+  // lamp's MAC bits) decorrelates the draw so neighbors holding the same
+  // (mac, seq) don't all drop it together. Loop task only, like tick().
+  void setRelayGate(uint16_t relayPermille, uint32_t salt) {
+    relayPermille_ = relayPermille;
+    salt_ = salt;
+  }
+
+  // Deterministic per-(mac, seq, salt) draw against relayPermille.
+  static bool relayAdmitted(const uint8_t mac[6], uint16_t seq, uint32_t salt,
+                            uint16_t relayPermille);
+
 #ifdef LAMP_DEBUG
   uint32_t suppressedWindow() const {
     LAMP_PROTOCOL_PORTMUX_ENTER(&mux_);
@@ -91,6 +108,8 @@ class HelloRelaySuppressor {
   // slots_ is written from the recv task (onFirstSeen/onDuplicate) and the loop
   // task (tick/resetWindow); guard every access.
   mutable LAMP_PROTOCOL_PORTMUX_TYPE mux_ = LAMP_PROTOCOL_PORTMUX_INIT;
+  uint16_t relayPermille_ = 1000;
+  uint32_t salt_ = 0;
 #ifdef LAMP_DEBUG
   uint32_t suppressed_ = 0;
   uint32_t relayed_ = 0;
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <cstdio>
 #include <cstring>
+#include <type_traits>
 #ifdef LAMP_DEBUG
 #include <cstdlib>
 #endif
@@ -47,19 +48,185 @@ void copyName(char (&dst)[lamp_protocol::HELLO_MAX_NAME + 1],
 uint32_t lastSeen(const RosterEntry& e) {
   return std::max(e.lastSeenNearMs, e.lastSeenMeshMs);
 }
+
+// getNear order: RSSI descending, mac bytes ascending on a tie, so equal-RSSI
+// peers come out deterministically.
+bool nearerThan(const RosterEntry& a, const RosterEntry& b) {
+  if (a.lastRssi != b.lastRssi) return a.lastRssi > b.lastRssi;
+  return std::memcmp(a.mac, b.mac, 6) < 0;
+}
+
+// FNV-1a over the mac, the same spread HashedDedupRing uses.
+uint32_t hashMac(const uint8_t mac[6]) {
+  uint32_t h = 2166136261u;
+  for (int i = 0; i < 6; i++) h = (h ^ mac[i]) * 16777619u;
+  return h;
+}
+
+// Copy of `src` made through relaxed atomic loads (a word at a time when the
+// type allows), for readView's copies: they race the writer on the other
+// core by design and are discarded when torn, but a plain load there would
+// be a data race.
+template <typename T>
+T racyCopy(const T& src) {
+  static_assert(std::is_trivially_copyable<T>::value, "racyCopy is a bytewise copy");
+  T out;
+  if constexpr (alignof(T) >= alignof(uint32_t) && sizeof(T) % sizeof(uint32_t) == 0) {
+    auto* d = reinterpret_cast<uint32_t*>(&out);
+    const auto* s = reinterpret_cast<const uint32_t*>(&src);
+    for (size_t i = 0; i < sizeof(T) / sizeof(uint32_t); i++) {
+      d[i] = __atomic_load_n(s + i, __ATOMIC_RELAXED);
+    }
+  } else {
+    auto* d = reinterpret_cast<unsigned char*>(&out);
+    const auto* s = reinterpret_cast<const unsigned char*>(&src);
+    for (size_t i = 0; i < sizeof(T); i++) d[i] = __atomic_load_n(s + i, __ATOMIC_RELAXED);
+  }
+  return out;
+}
+
+// Drop `value` from the first `n` of `arr`, keeping order. Returns the new n.
+template <size_t N>
+size_t eraseValue(std::array<uint8_t, N>& arr, size_t n, uint8_t value) {
+  for (size_t k = 0; k < n; k++) {
+    if (arr[k] != value) continue;
+    std::memmove(&arr[k], &arr[k + 1], n - k - 1);
+    return n - 1;
+  }
+  return n;
+}
+
+template <size_t N>
+void renameValue(std::array<uint8_t, N>& arr, size_t n, uint8_t from, uint8_t to) {
+  for (size_t k = 0; k < n; k++) {
+    if (arr[k] == from) { arr[k] = to; return; }
+  }
+}
 }  // namespace
 
 LampRoster lampRoster;  // global instance
 
 LampRoster::LampRoster() {
   mutex_ = xSemaphoreCreateMutex();
+  macIndex_.fill(kNoSlot);
+}
+
+void LampRoster::beginWriteLocked() {
+  seq_.store(seq_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+void LampRoster::endWriteLocked() {
+  seq_.store(seq_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// Seqlock read: the copy may race a writer on the other core, so it's only
+// kept when seq_ was even before and unchanged after. The copies read store_
+// and its indexes through racyCopy; the acquire fence orders those loads
+// before the re-check, pairing with the writer's release fence after it
+// makes seq_ odd. A torn copy is safe to make and throw away: count_,
+// meshCount_ and every index slot only ever hold in-range values, and
+// entries are trivially copyable.
+template <typename Copy>
+void LampRoster::readView(Copy copy) {
+  for (int attempt = 0; attempt < kViewRetries; attempt++) {
+    const uint32_t before = seq_.load(std::memory_order_acquire);
+    if (before & 1u) continue;
+    copy();
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq_.load(std::memory_order_relaxed) == before) {
+      viewGeneration_ = before >> 1;
+      return;
+    }
+  }
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+  copy();
+  viewGeneration_ = seq_.load(std::memory_order_relaxed) >> 1;
+  xSemaphoreGive(mutex_);
+}
+
+size_t LampRoster::macBucketLocked(const uint8_t mac[6]) const {
+  size_t b = hashMac(mac) & (kIndexSlots - 1);
+  while (macIndex_[b] != kNoSlot &&
+         std::memcmp(store_[macIndex_[b]].mac, mac, 6) != 0) {
+    b = (b + 1) & (kIndexSlots - 1);
+  }
+  return b;
+}
+
+// Backward-shift delete: pull later members of the probe run into the hole
+// so every remaining mac stays reachable from its home bucket.
+void LampRoster::macIndexEraseLocked(const uint8_t mac[6]) {
+  size_t hole = macBucketLocked(mac);
+  if (macIndex_[hole] == kNoSlot) return;
+  size_t b = hole;
+  for (;;) {
+    b = (b + 1) & (kIndexSlots - 1);
+    if (macIndex_[b] == kNoSlot) break;
+    const size_t home = hashMac(store_[macIndex_[b]].mac) & (kIndexSlots - 1);
+    // Movable when its home isn't cyclically in (hole, b].
+    if (((b - home) & (kIndexSlots - 1)) >= ((b - hole) & (kIndexSlots - 1))) {
+      macIndex_[hole] = macIndex_[b];
+      hole = b;
+    }
+  }
+  macIndex_[hole] = kNoSlot;
 }
 
 size_t LampRoster::findIndexLocked(const uint8_t mac[6]) const {
-  for (size_t i = 0; i < count_; i++) {
-    if (store_[i].hasMac && std::memcmp(store_[i].mac, mac, 6) == 0) return i;
+  const uint8_t slot = macIndex_[macBucketLocked(mac)];
+  if (slot == kNoSlot || !store_[slot].hasMac) return count_;
+  return slot;
+}
+
+void LampRoster::appendLocked(const RosterEntry& e) {
+  const size_t i = count_;
+  store_[i] = e;
+  macIndex_[macBucketLocked(e.mac)] = static_cast<uint8_t>(i);
+  size_t pos = 0;
+  while (pos < count_ && !nearerThan(e, store_[rssiOrder_[pos]])) pos++;
+  std::memmove(&rssiOrder_[pos + 1], &rssiOrder_[pos], count_ - pos);
+  rssiOrder_[pos] = static_cast<uint8_t>(i);
+  count_++;
+  if (e.lastSeenMeshMs != 0) meshOrder_[meshCount_++] = static_cast<uint8_t>(i);
+}
+
+void LampRoster::removeAtLocked(size_t i) {
+  const size_t last = count_ - 1;
+  macIndexEraseLocked(store_[i].mac);
+  eraseValue(rssiOrder_, count_, static_cast<uint8_t>(i));
+  meshCount_ = eraseValue(meshOrder_, meshCount_, static_cast<uint8_t>(i));
+  if (i != last) {
+    store_[i] = store_[last];
+    macIndex_[macBucketLocked(store_[i].mac)] = static_cast<uint8_t>(i);
+    renameValue(rssiOrder_, last, static_cast<uint8_t>(last), static_cast<uint8_t>(i));
+    renameValue(meshOrder_, meshCount_, static_cast<uint8_t>(last), static_cast<uint8_t>(i));
   }
-  return count_;
+  count_--;
+}
+
+// One entry's key moved: slide it to its new place. A BLE adv nudges RSSI by
+// a few dB, so the walk is usually a step or two.
+void LampRoster::reorderRssiLocked(size_t i) {
+  size_t pos = 0;
+  while (rssiOrder_[pos] != i) pos++;
+  const RosterEntry& e = store_[i];
+  while (pos > 0 && nearerThan(e, store_[rssiOrder_[pos - 1]])) {
+    rssiOrder_[pos] = rssiOrder_[pos - 1];
+    pos--;
+  }
+  while (pos + 1 < count_ && nearerThan(store_[rssiOrder_[pos + 1]], e)) {
+    rssiOrder_[pos] = rssiOrder_[pos + 1];
+    pos++;
+  }
+  rssiOrder_[pos] = static_cast<uint8_t>(i);
+}
+
+void LampRoster::noteMeshSightingLocked(size_t i) {
+  for (size_t k = 0; k < meshCount_; k++) {
+    if (meshOrder_[k] == i) return;
+  }
+  meshOrder_[meshCount_++] = static_cast<uint8_t>(i);
 }
 
 void LampRoster::evictOldestIfFullLocked() {
@@ -70,10 +237,7 @@ void LampRoster::evictOldestIfFullLocked() {
     uint32_t m = lastSeen(store_[i]);
     if (m < oldestMax) { oldestMax = m; oldestIdx = i; }
   }
-  if (oldestIdx != count_ - 1) {
-    store_[oldestIdx] = store_[count_ - 1];
-  }
-  count_--;
+  removeAtLocked(oldestIdx);
 }
 
 void LampRoster::addOrUpdateFromBle(const std::string& name,
@@ -86,6 +250,7 @@ void LampRoster::addOrUpdateFromBle(const std::string& name,
   uint8_t recoveredMac[6];
   meshMacFromBleAddr(ble, recoveredMac);
   xSemaphoreTake(mutex_, portMAX_DELAY);
+  beginWriteLocked();
   size_t idx = findIndexLocked(recoveredMac);
   if (idx == count_) {
     evictOldestIfFullLocked();
@@ -97,7 +262,7 @@ void LampRoster::addOrUpdateFromBle(const std::string& name,
     e.shadeColor = shade;
     e.lastSeenNearMs = now;
     e.lastRssi = rssi;
-    store_[count_++] = e;
+    appendLocked(e);
   } else {
     // Empty name from a nameless BLE adv must not erase a known display name
     // on the merged entry.
@@ -109,9 +274,12 @@ void LampRoster::addOrUpdateFromBle(const std::string& name,
     // tracks current signal strength rather than a one-shot first-seen
     // value. -127 is the "unknown" sentinel; only overwrite when the
     // caller supplied a real reading.
-    if (rssi != -127) store_[idx].lastRssi = rssi;
+    if (rssi != -127 && rssi != store_[idx].lastRssi) {
+      store_[idx].lastRssi = rssi;
+      reorderRssiLocked(idx);
+    }
   }
-  generation_++;
+  endWriteLocked();
   xSemaphoreGive(mutex_);
 }
 
@@ -128,7 +296,9 @@ void LampRoster::addOrUpdateFromEspNow(const char* name, const uint8_t mac[6],
                                        const uint8_t* otaSendingTo,
                                        bool hasOtaSendingTo,
                                        int8_t rssi,
-                                       lamp_protocol::LampVariant variant) {
+                                       lamp_protocol::LampVariant variant,
+                                       uint8_t caps,
+                                       uint32_t invocationSchema) {
   uint32_t now = millis();
   // WiFi task: bounded take so a stall doesn't block recv frames or the
   // link_.broadcast(). On timeout the write drops; the next HELLO retries.
@@ -144,6 +314,7 @@ void LampRoster::addOrUpdateFromEspNow(const char* name, const uint8_t mac[6],
 #endif
     return;
   }
+  beginWriteLocked();
   // lastRssi not updated from HELLO: single transport source prevents
   // cross-transport contamination in PersonalityEngine's hysteresis.
   size_t idx = findIndexLocked(mac);
@@ -174,8 +345,10 @@ void LampRoster::addOrUpdateFromEspNow(const char* name, const uint8_t mac[6],
       std::memcpy(e.otaSendingTo, otaSendingTo, 6);
     }
     e.variant = variant;
+    e.caps = caps;
+    e.invocationSchema = invocationSchema;
     e.espnowRssi = rssi;
-    store_[count_++] = e;
+    appendLocked(e);
   } else {
     // A HELLO whose nameLen was 0 arrives with an empty name; keep the last
     // known display name rather than blanking the merged entry.
@@ -184,6 +357,7 @@ void LampRoster::addOrUpdateFromEspNow(const char* name, const uint8_t mac[6],
     store_[idx].shadeColor = shade;
     std::memcpy(store_[idx].mac, mac, 6);
     store_[idx].hasMac = true;
+    if (store_[idx].lastSeenMeshMs == 0) noteMeshSightingLocked(idx);
     store_[idx].lastSeenMeshMs = now;
     // Zero from BLE-only callers (no HELLO) leaves a known version intact.
     if (firmwareVersion != 0) store_[idx].firmwareVersion = firmwareVersion;
@@ -221,59 +395,59 @@ void LampRoster::addOrUpdateFromEspNow(const char* name, const uint8_t mac[6],
     if (variant != lamp_protocol::LampVariant::Unknown) {
       store_[idx].variant = variant;
     }
+    // Instantaneous: the latest HELLO wins, so a peer OTA'd onto a different
+    // invocation schema (or back to JSON-only firmware) is re-negotiated.
+    store_[idx].caps = caps;
+    store_[idx].invocationSchema = invocationSchema;
     // Freshens every HELLO like lastRssi does for BLE adv; -127 sentinel
     // (unavailable RSSI) leaves the last known reading intact.
     if (rssi != -127) store_[idx].espnowRssi = rssi;
   }
-  generation_++;
+  endWriteLocked();
   xSemaphoreGive(mutex_);
 }
 
 void LampRoster::prune(uint32_t maxAgeMs) {
   uint32_t now = millis();
   xSemaphoreTake(mutex_, portMAX_DELAY);
+  bool writing = false;
   for (size_t i = 0; i < count_; ) {
     uint32_t mostRecent = lastSeen(store_[i]);
     if (mostRecent != 0 && (now - mostRecent) > maxAgeMs) {
-      if (i != count_ - 1) store_[i] = store_[count_ - 1];
-      count_--;
-      generation_++;
+      if (!writing) {
+        beginWriteLocked();
+        writing = true;
+      }
+      removeAtLocked(i);
       continue;
     }
     i++;
   }
+  if (writing) endWriteLocked();
   xSemaphoreGive(mutex_);
 }
 
-// Copy store_ into a reused buffer under lock, filter outside. Bounds the
-// critical section so ESP-NOW recv-side bounded takes don't time out on a
-// loop-task reader, and reuses the buffer so steady-state queries don't churn
-// the fragmented heap.
+// Copy into a reused buffer through readView: no mutex on the common path,
+// so ESP-NOW recv-side bounded takes don't time out on a loop-task reader,
+// and the reused buffer keeps steady-state queries off the fragmented heap.
 std::vector<RosterEntry>& LampRoster::getNear(uint32_t maxAgeMs) {
 #ifdef LAMP_DEBUG
   debugGetterEnter();
 #endif
   uint32_t now = millis();
-  nearBuf_.clear();
-  xSemaphoreTake(mutex_, portMAX_DELAY);
-  nearBuf_.insert(nearBuf_.end(), store_.begin(), store_.begin() + count_);
-  xSemaphoreGive(mutex_);
-  nearBuf_.erase(
-      std::remove_if(nearBuf_.begin(), nearBuf_.end(),
-                     [&](const RosterEntry& e) {
-                       return !(e.lastSeenNearMs != 0 &&
-                                (now - e.lastSeenNearMs) <= maxAgeMs);
-                     }),
-      nearBuf_.end());
   // Highest RSSI first: `peers.front()` gives the nearest lamp
-  // (cascade-stagger sort key). -127 sorts to the back. std::sort (in-place
-  // introsort, no merge-buffer alloc) avoids bad_alloc on the fragmented
-  // heap; the mac tiebreak gives equal-RSSI peers a deterministic order.
-  std::sort(nearBuf_.begin(), nearBuf_.end(),
-            [](const RosterEntry& a, const RosterEntry& b) {
-              if (a.lastRssi != b.lastRssi) return a.lastRssi > b.lastRssi;
-              return std::memcmp(a.mac, b.mac, 6) < 0;
-            });
+  // (cascade-stagger sort key). -127 sorts to the back. rssiOrder_ is kept
+  // in that order by the writers, so the copy is a filtered walk, no sort.
+  readView([&] {
+    nearBuf_.clear();
+    const size_t n = racyCopy(count_);
+    for (size_t k = 0; k < n; k++) {
+      const RosterEntry e = racyCopy(store_[racyCopy(rssiOrder_[k])]);
+      if (e.lastSeenNearMs != 0 && (now - e.lastSeenNearMs) <= maxAgeMs) {
+        nearBuf_.push_back(e);
+      }
+    }
+  });
 #ifdef LAMP_DEBUG
   debugGetterExit();
 #endif
@@ -311,17 +485,14 @@ std::vector<RosterEntry>& LampRoster::getMesh(uint32_t maxAgeMs) {
   debugGetterEnter();
 #endif
   uint32_t now = millis();
-  meshBuf_.clear();
-  xSemaphoreTake(mutex_, portMAX_DELAY);
-  meshBuf_.insert(meshBuf_.end(), store_.begin(), store_.begin() + count_);
-  xSemaphoreGive(mutex_);
-  meshBuf_.erase(
-      std::remove_if(meshBuf_.begin(), meshBuf_.end(),
-                     [&](const RosterEntry& e) {
-                       return !(e.lastSeenMeshMs != 0 &&
-                                (now - e.lastSeenMeshMs) <= maxAgeMs);
-                     }),
-      meshBuf_.end());
+  readView([&] {
+    meshBuf_.clear();
+    const size_t n = racyCopy(meshCount_);
+    for (size_t k = 0; k < n; k++) {
+      const RosterEntry e = racyCopy(store_[racyCopy(meshOrder_[k])]);
+      if ((now - e.lastSeenMeshMs) <= maxAgeMs) meshBuf_.push_back(e);
+    }
+  });
 #ifdef LAMP_DEBUG
   debugGetterExit();
 #endif
@@ -332,10 +503,11 @@ std::vector<RosterEntry>& LampRoster::getAll() {
 #ifdef LAMP_DEBUG
   debugGetterEnter();
 #endif
-  allBuf_.clear();
-  xSemaphoreTake(mutex_, portMAX_DELAY);
-  allBuf_.insert(allBuf_.end(), store_.begin(), store_.begin() + count_);
-  xSemaphoreGive(mutex_);
+  readView([&] {
+    allBuf_.clear();
+    const size_t n = racyCopy(count_);
+    for (size_t i = 0; i < n; i++) allBuf_.push_back(racyCopy(store_[i]));
+  });
 #ifdef LAMP_DEBUG
   debugGetterExit();
 #endif
@@ -345,23 +517,20 @@ std::vector<RosterEntry>& LampRoster::getAll() {
 bool LampRoster::findByMac(const uint8_t mac[6], RosterEntry& out) {
   if (mac == nullptr) return false;
   xSemaphoreTake(mutex_, portMAX_DELAY);
-  for (size_t i = 0; i < count_; i++) {
-    if (store_[i].hasMac && std::memcmp(store_[i].mac, mac, 6) == 0) {
-      out = store_[i];
-      xSemaphoreGive(mutex_);
-      return true;
-    }
-  }
+  const size_t idx = findIndexLocked(mac);
+  const bool found = idx < count_;
+  if (found) out = store_[idx];
   xSemaphoreGive(mutex_);
-  return false;
+  return found;
 }
 
 void LampRoster::acknowledge(const uint8_t mac[6]) {
   xSemaphoreTake(mutex_, portMAX_DELAY);
   size_t idx = findIndexLocked(mac);
   if (idx < count_) {
+    beginWriteLocked();
     store_[idx].acknowledged = true;
-    generation_++;
+    endWriteLocked();
   }
   xSemaphoreGive(mutex_);
 }
@@ -370,17 +539,17 @@ void LampRoster::markNear(const uint8_t mac[6]) {
   if (xSemaphoreTake(mutex_, pdMS_TO_TICKS(2)) != pdTRUE) return;
   size_t idx = findIndexLocked(mac);
   if (idx < count_) {
+    beginWriteLocked();
     store_[idx].lastSeenNearMs = millis();
-    generation_++;
+    endWriteLocked();
   }
   xSemaphoreGive(mutex_);
 }
 
-uint32_t LampRoster::generation() {
-  xSemaphoreTake(mutex_, portMAX_DELAY);
-  uint32_t g = generation_;
-  xSemaphoreGive(mutex_);
-  return g;
+// Rounded up past an in-flight write, so a caller that sees a value can't
+// later build from a copy older than it.
+uint32_t LampRoster::generation() const {
+  return (seq_.load(std::memory_order_acquire) + 1) >> 1;
 }
 
 }  // namespace lamp
@@ -8,6 +8,7 @@
 #endif
 
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <string>
@@ -95,9 +96,13 @@ struct RosterEntry {
   // Peer's lamp variant from HELLO_TLV_VARIANT. Unknown on legacy / BLE-only
   // peers (no TLV). Surfaced to behaviors via PeerView::variant.
   lamp_protocol::LampVariant variant = lamp_protocol::LampVariant::Unknown;
+  // Peer's HELLO_TLV_CAPS: optional wire features plus the binary-invocation
+  // schema id. Zero on older / BLE-only peers, which get JSON invocations.
+  uint8_t  caps = 0;
+  uint32_t invocationSchema = 0;
   // BLE-scan RSSI (dBm). Written only by addOrUpdateFromBle (single-transport
   // invariant for PersonalityEngine hysteresis). -127 = unknown, sorts to back.
-  // getNear() sorts descending; getMesh() does not.
+  // getNear() orders by it descending; getMesh() does not.
   int8_t lastRssi = -127;
   // ESP-NOW HELLO RSSI (dBm), written only by addOrUpdateFromEspNow. Distinct
   // from lastRssi (BLE-scan RSSI): feeds the OTA distributor's signal-floor
@@ -139,8 +144,16 @@ static_assert(std::is_trivially_copyable<NearbyCopy>::value,
  * Single source of truth for "lamps I can hear right now."
  *        Mutated from NimBLE scan callback (Core 0) and ESP-NOW HELLO
  *        recv (WiFi task); read from the loop task. SemaphoreHandle_t
- *        mutex serialises. Storage is a fixed static array; when full,
- *        the stalest entry (max of both last-seen stamps) is evicted.
+ *        mutex serialises writers. Storage is a fixed static array; when
+ *        full, the stalest entry (max of both last-seen stamps) is evicted.
+ *
+ *        Writers keep three indexes current so no reader scans or sorts:
+ *        a MAC → slot hash (findByMac, every HELLO's lookup), the getNear
+ *        order (RSSI descending, mac ascending), and the mesh-sighted
+ *        slots in first-sighting order (getMesh). Each write is bracketed
+ *        by a sequence counter, so the getters copy without the mutex and
+ *        retry on a torn read (falling back to the mutex after a few
+ *        tries); the even counter value halved is the roster generation.
  */
 class LampRoster {
  public:
@@ -148,6 +161,16 @@ class LampRoster {
   // broader wisp-claim set, which stays 100 so wisps claim all nearby lamps).
   static constexpr size_t kCapacity = 50;
 
+  // MAC-hash buckets: a power of two at least twice kCapacity, so probe
+  // chains stay short at a full roster.
+  static constexpr size_t kIndexSlots = 128;
+  static_assert((kIndexSlots & (kIndexSlots - 1)) == 0 &&
+                    kIndexSlots >= 2 * kCapacity && kCapacity < 0xFF,
+                "MAC index must be a power of two >= 2x capacity");
+
+  // Lock-free getter copies attempted before falling back to the mutex.
+  static constexpr int kViewRetries = 3;
+
   // Presence-freshness window; repeated snapshotNear calls with the same
   // maxAgeMs within it reuse the cached copy instead of re-locking, filtering,
   // and sorting, so a behavior may call snapshotNear per frame.
@@ -173,7 +196,9 @@ class LampRoster {
                              bool hasOtaSendingTo = false,
                              int8_t rssi = -127,
                              lamp_protocol::LampVariant variant =
-                                 lamp_protocol::LampVariant::Unknown);
+                                 lamp_protocol::LampVariant::Unknown,
+                             uint8_t caps = 0,
+                             uint32_t invocationSchema = 0);
 
   // Drop entries whose most-recent sighting (max of the two transports)
   // is older than `maxAgeMs`.
@@ -202,29 +227,27 @@ class LampRoster {
   const std::vector<NearbyCopy>& snapshotNear(uint32_t maxAgeMs);
 
   // Highest-RSSI near arrival (hasMac, unacknowledged, seen within maxAgeMs)
-  // that `accept` also passes, copied into `out`. Scans store_ in place under
-  // the mutex, no snapshot and no sort, so the ~60 Hz greeting tick can't
-  // fragment the heap. `accept` runs inside the critical section: it must not
-  // allocate or block. Equal RSSI breaks on mac bytes ascending for a
-  // deterministic pick. Returns false and leaves `out` untouched when nothing
-  // qualifies.
+  // that `accept` also passes, copied into `out`. Walks the maintained getNear
+  // order in place under the mutex and stops at the first match, no snapshot
+  // and no sort, so the ~60 Hz greeting tick can't fragment the heap.
+  // `accept` runs inside the critical section: it must not allocate or block.
+  // Equal RSSI breaks on mac bytes ascending for a deterministic pick.
+  // Returns false and leaves `out` untouched when nothing qualifies.
   template <typename Accept>
   bool bestUngreetedArrival(uint32_t maxAgeMs, uint32_t now, Accept accept,
                             RosterEntry& out) {
     bool found = false;
     xSemaphoreTake(mutex_, portMAX_DELAY);
-    for (size_t i = 0; i < count_; i++) {
-      const RosterEntry& e = store_[i];
+    for (size_t k = 0; k < count_; k++) {
+      const RosterEntry& e = store_[rssiOrder_[k]];
       if (!e.hasMac) continue;
       if (e.lastSeenNearMs == 0) continue;
       if ((now - e.lastSeenNearMs) > maxAgeMs) continue;
       if (e.acknowledged) continue;
       if (!accept(e)) continue;
-      if (!found || e.lastRssi > out.lastRssi ||
-          (e.lastRssi == out.lastRssi && std::memcmp(e.mac, out.mac, 6) < 0)) {
-        out = e;
-        found = true;
-      }
+      out = e;
+      found = true;
+      break;
     }
     xSemaphoreGive(mutex_);
     return found;
@@ -239,8 +262,12 @@ class LampRoster {
   std::vector<RosterEntry>& getAll();
 
   // Monotonic counter, bumped on every entry mutation. Change detection
-  // for the nearby-JSON cache rebuild in ble_control::tick().
-  uint32_t generation();
+  // for the nearby-JSON cache rebuild in ble_control::tick(). Lock-free.
+  uint32_t generation() const;
+
+  // Generation the most recent getNear/getMesh/getAll copy is consistent
+  // with: the stamp to remember alongside a cache built from that copy.
+  uint32_t viewGeneration() const { return viewGeneration_; }
 
 #ifdef LAMP_DEBUG
   // The shared getter buffers are non-reentrant and read outside the mutex, so
@@ -372,7 +399,18 @@ class LampRoster {
   uint32_t lastSnapshotMaxAge_ = 0;
   bool lastSnapshotValid_ = false;
   size_t count_ = 0;
-  uint32_t generation_ = 0;
+  // store_ slots of every entry in getNear order (lastRssi descending, mac
+  // ascending); the first count_ are live.
+  std::array<uint8_t, kCapacity> rssiOrder_{};
+  // store_ slots of entries with a mesh sighting, first-sighting order.
+  std::array<uint8_t, kCapacity> meshOrder_{};
+  size_t meshCount_ = 0;
+  // MAC → store_ slot, linear probing; kNoSlot marks an empty bucket.
+  static constexpr uint8_t kNoSlot = 0xFF;
+  std::array<uint8_t, kIndexSlots> macIndex_;
+  // Odd while a writer is mid-mutation; seq_ / 2 is the generation.
+  std::atomic<uint32_t> seq_{0};
+  uint32_t viewGeneration_ = 0;  // loop-task only, set by the getters
   SemaphoreHandle_t mutex_ = nullptr;
 #ifdef LAMP_DEBUG
   TaskHandle_t getterTask_ = nullptr;
@@ -396,6 +434,30 @@ class LampRoster {
   // Caller must hold the mutex. Evicts the entry with the oldest combined
   // last-seen if the store is at capacity.
   void evictOldestIfFullLocked();
+
+  // Caller must hold the mutex and have opened a write. Appends `e` and
+  // threads it into every index.
+  void appendLocked(const RosterEntry& e);
+  // Caller must hold the mutex and have opened a write. Drops slot `i`,
+  // moving the last entry into it, and repairs every index.
+  void removeAtLocked(size_t i);
+  // Caller must hold the mutex. Re-sorts slot `i` after its lastRssi moved.
+  void reorderRssiLocked(size_t i);
+  // Caller must hold the mutex. Adds slot `i` to the mesh view on its first
+  // mesh sighting.
+  void noteMeshSightingLocked(size_t i);
+  size_t macBucketLocked(const uint8_t mac[6]) const;
+  void macIndexEraseLocked(const uint8_t mac[6]);
+
+  // Bracket every store_ mutation (caller holds the mutex): beginWrite makes
+  // seq_ odd so a concurrent lock-free copy retries, endWrite publishes.
+  void beginWriteLocked();
+  void endWriteLocked();
+  // Run `copy` (which must restart its output from empty) against a
+  // consistent store_: lock-free first, the mutex after kViewRetries torn
+  // reads. Stamps viewGeneration_.
+  template <typename Copy>
+  void readView(Copy copy);
 };
 
 extern LampRoster lampRoster;  // single global instance, defined in .cpp
@@ -11,6 +11,7 @@
 #include "components/firmware/fs_ota.hpp"
 #include "components/network/mesh/proximity.hpp"
 #include "components/network/protocol/command_auth.hpp"
+#include "expressions/expression_invocation.hpp"
 #include "version.hpp"
 
 #include <lampos/blended_identity.hpp>
@@ -51,6 +52,8 @@ void MeshLink::begin(Config* cfg) {
   helloSeq_ = static_cast<uint16_t>(esp_random());
   helloBootPhaseMs_ =
       ((uint32_t(myMac_[4]) << 8) | myMac_[5]) % LAMP_HELLO_BURST_INTERVAL_MS;
+  relaySalt_ = (uint32_t(myMac_[2]) << 24) | (uint32_t(myMac_[3]) << 16) |
+               (uint32_t(myMac_[4]) << 8) | myMac_[5];
   Serial.printf("[show] ready, mac=%02X:%02X:%02X:%02X:%02X:%02X\n",
                 myMac_[0], myMac_[1], myMac_[2], myMac_[3], myMac_[4], myMac_[5]);
 }
@@ -67,6 +70,8 @@ void MeshLink::tick() {
   commandResend_.service(now, send);
   colorQueryResend_.service(now, send);
   colorInfoResend_.service(now, send);
+  airtime_.update(now);
+  helloSuppressor_.setRelayGate(airtime_.relayPermille(), relaySalt_);
   helloSuppressor_.tick(now, [this](const uint8_t* frame, size_t len) {
     relay(frame, len);
   });
@@ -85,7 +90,10 @@ void MeshLink::tick() {
     lastHelloMs_ = 0;
   }
   if (lastHelloMs_ == 0 && now < helloBootPhaseMs_) return;
-  if (now - lastHelloMs_ < helloIntervalMs(now) && lastHelloMs_ != 0) return;
+  if (now - lastHelloMs_ < helloIntervalMs(now, airtime_.helloIntervalMs()) &&
+      lastHelloMs_ != 0) {
+    return;
+  }
   lastHelloMs_ = now;
   // Only a receiver goes silent; it needs the airtime for the chunk stream. A
   // pure distributor keeps emitting so its otaState=Sending reaches peers.
@@ -147,7 +155,7 @@ bool MeshLink::sendControlOpUnicast(const uint8_t targetMac[6],
 }
 
 bool MeshLink::sendCommand(const uint8_t targetMac[6],
-                              const uint8_t* invocationJson, size_t len) {
+                              const uint8_t* invocation, size_t len) {
   if (len == 0 || len > lamp_protocol::COMMAND_MAX_PAYLOAD) return false;
   // static: the ~1470 B frame is too big for the loop-task stack; every
   // sendCommand caller (cascade + greeting) runs on the Core 1 loop task.
@@ -155,7 +163,7 @@ bool MeshLink::sendCommand(const uint8_t targetMac[6],
               lamp_protocol::COMMAND_TAG_SIZE];
   const size_t n = lamp_protocol::buildCommand(buf, sizeof(buf), commandSeq_++,
                                                myMac_, targetMac,
-                                               invocationJson, len);
+                                               invocation, len);
   if (!n) return false;
   const size_t framed = lamp_protocol::command_auth::appendTag(buf, n, sizeof(buf));
   commandDedup_.record(myMac_, lamp_protocol::MSG_COMMAND, commandSeq_ - 1);
@@ -170,12 +178,12 @@ bool MeshLink::sendCommand(const uint8_t targetMac[6],
   return ok;
 }
 
-bool MeshLink::sendEvent(const uint8_t* payloadJson, size_t len) {
+bool MeshLink::sendEvent(const uint8_t* invocation, size_t len) {
   if (len == 0 || len > lamp_protocol::EVENT_MAX_PAYLOAD) return false;
   uint8_t buf[lamp_protocol::EVENT_FIXED_SIZE + lamp_protocol::EVENT_MAX_PAYLOAD +
               lamp_protocol::EVENT_TAG_SIZE];
   const size_t n = lamp_protocol::buildEvent(buf, sizeof(buf), eventSeq_++,
-                                             myMac_, payloadJson, len);
+                                             myMac_, invocation, len);
   if (!n) return false;
   const size_t framed = lamp_protocol::command_auth::appendTag(buf, n, sizeof(buf));
   eventDedup_.record(myMac_, lamp_protocol::MSG_EVENT, eventSeq_ - 1);
@@ -289,6 +297,10 @@ void MeshLink::reportMeshMix(uint32_t nowMs) {
   Serial.printf("[hellosupp] win=30s suppressed=%u relayed=%u rate=%u%%\n",
                 (unsigned)supp, (unsigned)rel,
                 (unsigned)(fired ? supp * 100 / fired : 0));
+  Serial.printf("[airtime] util=%u%% hello_iv=%ums relay=%u%%\n",
+                (unsigned)(airtime_.utilizationPermille() / 10),
+                (unsigned)airtime_.helloIntervalMs(),
+                (unsigned)(airtime_.relayPermille() / 10));
   Serial.printf("[wispstate] win=30s recv=%u adopts=%u releases=%u selfPresent=%u\n",
                 (unsigned)wispStateMeter_.recv(),
                 (unsigned)wispStateMeter_.adopts(),
@@ -303,6 +315,8 @@ void MeshLink::reportMeshMix(uint32_t nowMs) {
 void MeshLink::handleRecv(const uint8_t* srcMac, const uint8_t* data,
                               size_t len, int8_t rssi) {
   const uint8_t msgType = lamp_protocol::inspect(data, len);
+  rxMetric_.add();
+  airtime_.noteFrame(len);
 #ifdef LAMP_DEBUG
   meshMix_.countRx(msgType);
   reportMeshMix(millis());
@@ -357,7 +371,9 @@ void MeshLink::handleRecv(const uint8_t* srcMac, const uint8_t* data,
         h.hasOtaSendingTo ? h.otaSendingTo : nullptr,
         h.hasOtaSendingTo,
         rssi,
-        h.variant);
+        h.variant,
+        h.caps,
+        h.invocationSchema);
     if (isDirectHello(srcMac, h.sourceMac) && isNearRssi(rssi, kNearRssiEspNow)) {
       lampRoster.markNear(h.sourceMac);
     }
@@ -686,6 +702,9 @@ void MeshLink::handleRecv(const uint8_t* srcMac, const uint8_t* data,
     slot.msgType = lamp_protocol::MSG_FW_OFFER;
     slot.seq = p.seq;
     slot.wireVersion = data[2];
+    // The sender's HELLO caps pick this flow's REQ form (exact-hole or run).
+    RosterEntry sender;
+    if (lampRoster.findByMac(p.sourceMac, sender)) slot.peerCaps = sender.caps;
     std::memcpy(slot.sourceMac, p.sourceMac, 6);
     std::memcpy(slot.targetMac, p.targetMac, 6);
     slot.offer.version       = p.version;
@@ -699,6 +718,12 @@ void MeshLink::handleRecv(const uint8_t* srcMac, const uint8_t* data,
     slot.offer.hasAuth     = p.hasAuth;
     std::memcpy(slot.offer.digest, p.digest, lamp_protocol::FW_SHA256_FULL_LEN);
     std::memcpy(slot.offer.signature, p.signature, lamp_protocol::FW_SIG_LEN);
+    slot.offer.isDelta       = p.isDelta;
+    slot.offer.deltaImageLen = p.deltaImageLen;
+    slot.offer.deltaBaseLen  = p.deltaBaseLen;
+    std::memcpy(slot.offer.deltaBaseId, p.deltaBaseId,
+                lamp_protocol::FW_DELTA_BASE_ID_LEN);
+    slot.offer.packFormat    = p.packFormat;
     postPendingFirmwareControl(slot);
   } else if (msgType == lamp_protocol::MSG_FW_CHUNK) {
     // Direct handoff to handleChunkOnRecvTask: a pending single-slot
@@ -707,13 +732,33 @@ void MeshLink::handleRecv(const uint8_t* srcMac, const uint8_t* data,
     lamp_protocol::ParsedFwChunk p;
     if (!lamp_protocol::parseFwChunk(data, len, p)) return;
     if (!firmwareDedup_.record(p.sourceMac, lamp_protocol::MSG_FW_CHUNK, p.seq)) return;
-    if (!addressedToUs(p.targetMac, myMac_)) return;
+    if (!lamp_protocol::isFwStreamForUs(
+            p.targetMac, p.sourceMac, myMac_,
+            firmwareReceiver_ && firmwareReceiver_->inGroupOf(p.sourceMac))) {
+      return;
+    }
     if (firmwareReceiver_) firmwareReceiver_->handleChunkOnRecvTask(p);
+  } else if (msgType == lamp_protocol::MSG_FW_REPAIR) {
+    // Same direct handoff as CHUNK: a bounded copy into a held-repair slot.
+    // Decode runs on Core 1 (FirmwareReceiver::tick).
+    lamp_protocol::ParsedFwRepair p;
+    if (!lamp_protocol::parseFwRepair(data, len, p)) return;
+    if (!firmwareDedup_.record(p.sourceMac, lamp_protocol::MSG_FW_REPAIR, p.seq)) return;
+    if (!lamp_protocol::isFwStreamForUs(
+            p.targetMac, p.sourceMac, myMac_,
+            firmwareReceiver_ && firmwareReceiver_->inGroupOf(p.sourceMac))) {
+      return;
+    }
+    if (firmwareReceiver_) firmwareReceiver_->handleRepairOnRecvTask(p);
   } else if (msgType == lamp_protocol::MSG_FW_DONE) {
     lamp_protocol::ParsedFwDone p;
     if (!lamp_protocol::parseFwDone(data, len, p)) return;
     if (!firmwareDedup_.record(p.sourceMac, lamp_protocol::MSG_FW_DONE, p.seq)) return;
-    if (!addressedToUs(p.targetMac, myMac_)) return;
+    if (!lamp_protocol::isFwStreamForUs(
+            p.targetMac, p.sourceMac, myMac_,
+            firmwareReceiver_ && firmwareReceiver_->inGroupOf(p.sourceMac))) {
+      return;
+    }
     PendingFirmwareControl slot{};
     slot.msgType = lamp_protocol::MSG_FW_DONE;
     slot.seq = p.seq;
@@ -765,6 +810,9 @@ void MeshLink::handleRecv(const uint8_t* srcMac, const uint8_t* data,
     slot.msgType = lamp_protocol::MSG_FS_OFFER;
     slot.seq = p.seq;
     slot.wireVersion = data[2];
+    // The sender's HELLO caps pick this flow's REQ form (exact-hole or run).
+    RosterEntry sender;
+    if (lampRoster.findByMac(p.sourceMac, sender)) slot.peerCaps = sender.caps;
     std::memcpy(slot.sourceMac, p.sourceMac, 6);
     std::memcpy(slot.targetMac, p.targetMac, 6);
     slot.offer.version   = p.version;
@@ -778,18 +826,34 @@ void MeshLink::handleRecv(const uint8_t* srcMac, const uint8_t* data,
     slot.offer.hasAuth     = p.hasAuth;
     std::memcpy(slot.offer.digest, p.digest, lamp_protocol::FW_SHA256_FULL_LEN);
     std::memcpy(slot.offer.signature, p.signature, lamp_protocol::FW_SIG_LEN);
+    slot.offer.packFormat  = p.packFormat;
     postPendingFirmwareControl(slot);
   } else if (msgType == lamp_protocol::MSG_FS_CHUNK) {
     lamp_protocol::ParsedFwChunk p;
     if (!lamp_protocol::parseFwChunk(data, len, p, lamp_protocol::MSG_FS_CHUNK)) return;
     if (!firmwareDedup_.record(p.sourceMac, lamp_protocol::MSG_FS_CHUNK, p.seq)) return;
-    if (!addressedToUs(p.targetMac, myMac_)) return;
+    if (!lamp_protocol::isFwStreamForUs(p.targetMac, p.sourceMac, myMac_,
+                                        fs_ota::inGroupOf(p.sourceMac))) {
+      return;
+    }
     fs_ota::onChunk(p);
+  } else if (msgType == lamp_protocol::MSG_FS_REPAIR) {
+    lamp_protocol::ParsedFwRepair p;
+    if (!lamp_protocol::parseFwRepair(data, len, p, lamp_protocol::MSG_FS_REPAIR)) return;
+    if (!firmwareDedup_.record(p.sourceMac, lamp_protocol::MSG_FS_REPAIR, p.seq)) return;
+    if (!lamp_protocol::isFwStreamForUs(p.targetMac, p.sourceMac, myMac_,
+                                        fs_ota::inGroupOf(p.sourceMac))) {
+      return;
+    }
+    fs_ota::onRepair(p);
   } else if (msgType == lamp_protocol::MSG_FS_DONE) {
     lamp_protocol::ParsedFwDone p;
     if (!lamp_protocol::parseFwDone(data, len, p, lamp_protocol::MSG_FS_DONE)) return;
     if (!firmwareDedup_.record(p.sourceMac, lamp_protocol::MSG_FS_DONE, p.seq)) return;
-    if (!addressedToUs(p.targetMac, myMac_)) return;
+    if (!lamp_protocol::isFwStreamForUs(p.targetMac, p.sourceMac, myMac_,
+                                        fs_ota::inGroupOf(p.sourceMac))) {
+      return;
+    }
     PendingFirmwareControl slot{};
     slot.msgType = lamp_protocol::MSG_FS_DONE;
     slot.seq = p.seq;
@@ -866,6 +930,12 @@ void MeshLink::emitHello(uint8_t otaState) {
   // distributor can negotiate a larger session chunk size than the baseline.
   // NEED_FS (re-evaluated every HELLO) asks peers to offer the UI image while
   // this lamp has no valid FS digest to advertise a mismatch against.
+  // CAPS tells peers this build decodes binary invocations of its schema and
+  // binary CONTROL_OP payloads, and speaks the exact-hole OTA REQ, repair rows,
+  // group sessions and delta images. HEALTH rides about every other HELLO so
+  // the wisp's fleet table can flag overloaded or fragmenting lamps.
+  lamp_protocol::HelloHealth health;
+  const bool withHealth = healthSampler_.poll(millis(), health);
   size_t n = lamp_protocol::buildHello(buf, sizeof(buf), helloSeq_++, myMac_,
                                        shade, base, FIRMWARE_VERSION,
                                        name.data(), nameLen, otaState,
@@ -874,9 +944,19 @@ void MeshLink::emitHello(uint8_t otaState) {
                                        lamp_protocol::FW_CHUNK_SIZE_MAX,
                                        fs_ota::needsFs(),
                                        hasSendingTo ? sendingTo : nullptr,
-                                       config_->lampVariant());
+                                       config_->lampVariant(),
+                                       lamp_protocol::HELLO_CAP_BINARY_INVOCATION |
+                                           lamp_protocol::HELLO_CAP_BINARY_CONTROL_OP |
+                                           lamp_protocol::HELLO_CAP_FW_REQ_BITMAP |
+                                           lamp_protocol::kOtaFecCap |
+                                           lamp_protocol::HELLO_CAP_FW_GROUP |
+                                           lamp_protocol::HELLO_CAP_FW_DELTA |
+                                           lamp_protocol::HELLO_CAP_FW_PACKED,
+                                       kInvocationSchemaId,
+                                       withHealth ? &health : nullptr);
   if (n) {
     link_.broadcast(buf, n);
+    airtime_.noteFrame(n);
   }
 }
 
@@ -11,6 +11,8 @@
 #include "expressions/expression_invocation.hpp"
 #include "components/network/transport/espnow_link.hpp"
 #include "components/network/protocol/lamp_protocol.hpp"
+#include "airtime_controller.hpp"
+#include "hello_health.hpp"
 #include "hello_interval.hpp"
 #include "hello_relay_suppressor.hpp"
 #include "lamp_roster.hpp"
@@ -20,6 +22,7 @@
 #include "wisp_state.hpp"
 #include "meshmix.hpp"
 #include "util/color.hpp"
+#include "util/metrics.hpp"
 #include "components/firmware/firmware_receiver.hpp"  // FirmwareTransport interface
 
 #ifndef LAMP_ESPNOW_CHANNEL
@@ -82,8 +85,9 @@ class MeshLink {
   // shade/base colors at HELLO time. Caller retains ownership.
   void begin(Config* cfg);
 
-  // Called from the Arduino loop task. Emits HELLO at LAMP_HELLO_INTERVAL_MS
-  // cadence; otherwise cheap to call every frame.
+  // Called from the Arduino loop task. Emits HELLO at the airtime
+  // controller's interval (LAMP_HELLO_INTERVAL_MS unless the channel is
+  // busy); otherwise cheap to call every frame.
   void tick();
 
   // Read this lamp's own MAC. Populated after begin().
@@ -109,14 +113,14 @@ class MeshLink {
                             size_t payloadLen);
 
   // Broadcast a MSG_COMMAND frame targeting a specific nearby lamp.
-  // `invocationJson` is the ExpressionInvocation JSON; `len` must be
-  // 1..COMMAND_MAX_PAYLOAD. Deduped so a loop-back broadcast doesn't
-  // re-trigger locally.
-  bool sendCommand(const uint8_t targetMac[6], const uint8_t* invocationJson,
+  // `invocation` is the encoded ExpressionInvocation (JSON or binary, see
+  // expression_invocation.hpp); `len` must be 1..COMMAND_MAX_PAYLOAD. Deduped
+  // so a loop-back broadcast doesn't re-trigger locally.
+  bool sendCommand(const uint8_t targetMac[6], const uint8_t* invocation,
                    size_t len);
 
-  // Broadcast a MSG_EVENT frame; payload is the ExpressionInvocation JSON.
-  bool sendEvent(const uint8_t* payloadJson, size_t len);
+  // Broadcast a MSG_EVENT frame; payload is the encoded ExpressionInvocation.
+  bool sendEvent(const uint8_t* invocation, size_t len);
 
   bool sendColorQuery(const uint8_t targetMac[6]);
   bool sendColorInfo(const uint8_t targetMac[6],
@@ -159,13 +163,15 @@ class MeshLink {
   uint8_t myMac_[6] = {0};
 
   // Capacity per ring is sized to the message type's traffic. Relay-heavy
-  // every-lamp types get the full 64; single-hop / low-rate types get less.
-  lamp_protocol::DedupRing<64> helloDedup_;
+  // every-lamp types get a hashed 256 (a 60+ lamp crowd's relays still land
+  // inside the window, and the critical section doesn't grow with it);
+  // single-hop / low-rate types keep the linear ring at 64 or less.
+  lamp_protocol::HashedDedupRing<256> helloDedup_;
   // Defers each first-seen HELLO relay; drops it if enough neighbors already
   // relayed the same (mac, seq). Bounds HELLO airtime below the ~N^2 that
   // relaying every first sight costs. Receive-side only, no wire change.
   HelloRelaySuppressor helloSuppressor_;
-  lamp_protocol::DedupRing<64> controlOpDedup_;
+  lamp_protocol::HashedDedupRing<256> controlOpDedup_;
   // Per-type dedup. Each new MSG_* gets its own ring so a
   // CONTROL_OP seq doesn't accidentally suppress an OVERRIDE_COLORS seq
   // from the same sender (seqs are independent per type).
@@ -208,6 +214,14 @@ class MeshLink {
   WispStateMeter wispStateMeter_;
   MeshMix meshMix_;
 #endif
+  // Always-on frame counts for the metrics snapshot; bumped on the recv task.
+  metrics::Counter& rxMetric_ = metrics::registry().counter("mesh.rx");
+  metrics::Counter& relayMetric_ = metrics::registry().counter("mesh.relay");
+  HelloHealthSampler healthSampler_;
+  // Charged with every frame heard (recv task) and every HELLO / relay sent
+  // (loop task); stretches the HELLO interval and thins relays under load.
+  AirtimeController airtime_;
+  uint32_t relaySalt_ = 0;
 
   uint32_t lastHelloMs_ = 0;
   // MAC-seeded first-HELLO offset so a fleet powering on together doesn't
@@ -255,6 +269,8 @@ class MeshLink {
   // Re-broadcast a received frame for gossip relay.
   void relay(const uint8_t* data, size_t len) {
     link_.broadcast(data, len);
+    airtime_.noteFrame(len);
+    relayMetric_.add();
 #ifdef LAMP_DEBUG
     meshMix_.relayedOut++;
 #endif
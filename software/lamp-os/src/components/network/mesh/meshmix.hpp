@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 #include "components/network/protocol/lamp_protocol.hpp"
@@ -28,6 +29,18 @@ struct MeshMix {
   uint32_t relayedOut = 0;
   uint32_t windowStartMs = 0;
 
+  // Estimated channel time one ESP-NOW frame of `len` payload bytes holds at
+  // the default 1 Mbps PHY rate: long preamble + PLCP, DIFS + mean backoff,
+  // and the vendor action-frame header + FCS at 8 us per byte. Deliberately
+  // rough; it only has to rank load against a budget.
+  static constexpr uint32_t kPhyOverheadUs = 192;
+  static constexpr uint32_t kContentionUs = 200;
+  static constexpr uint32_t kMacOverheadBytes = 43;
+  static constexpr uint32_t frameAirtimeUs(size_t len) {
+    return kPhyOverheadUs + kContentionUs +
+           (static_cast<uint32_t>(len) + kMacOverheadBytes) * 8;
+  }
+
   static Bucket bucketFor(uint8_t msgType) {
     switch (msgType) {
       case lamp_protocol::MSG_HELLO:           return kHello;
@@ -128,4 +128,18 @@ struct PendingEvent {
   uint8_t  payload[lamp_protocol::EVENT_MAX_PAYLOAD];
 };
 
+// Binary CONTROL_OP brightness (see control_op_binary.hpp). Posted straight
+// from the WiFi task's dispatch table; the drain applies it render-only, the
+// same as a relayed JSON brightness op, without a parse on either side.
+struct PendingRemoteBrightness {
+  uint8_t level;  // 0..100
+};
+
+// Binary CONTROL_OP shade / base colors. One slot per surface so a shade and
+// a base write landing between two drains both apply.
+struct PendingRemoteColors {
+  uint8_t count;  // 1..CONTROL_OP_MAX_COLORS
+  Color colors[lamp_protocol::CONTROL_OP_MAX_COLORS];
+};
+
 }  // namespace lamp
@@ -17,7 +17,8 @@
 //    0    6    header (see header.hpp)
 //    6    6    sourceMac
 //   12    6    targetMac
-//   18    N    payload (ExpressionInvocation JSON)
+//   18    N    payload (ExpressionInvocation, JSON or binary;
+//              see expression_invocation.hpp)
 //  18+N   8    command_auth tag (HMAC-SHA256 trailer; see command_auth.hpp)
 //
 // No gossip relay. addressedToUs filter on recv (single-hop, physically nearby).
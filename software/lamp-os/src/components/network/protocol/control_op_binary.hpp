@@ -0,0 +1,157 @@
+#pragma once
+
+// Binary MSG_CONTROL_OP payload: the lamp-to-lamp form of the fixed-shape
+// remote ops (brightness, shade/base colors, knockout). Sent only toward
+// peers advertising HELLO_CAP_BINARY_CONTROL_OP; everything else, and every
+// op with a free-form body (expressionOp, wispStatus, wispOp), stays JSON.
+// Rides inside the opaque CONTROL_OP payload (control_op.hpp), so relaying
+// lamps forward it untouched whatever their version.
+//
+//   off  size  field
+//    0    1    CONTROL_OP_BINARY_TAG (0xC1; never '{', never a wisp op prefix)
+//    1    1    ControlOpCode
+//    2    N    fixed fields for the op:
+//                Brightness   [level 0..100]
+//                ShadeColors  [count 1..CONTROL_OP_MAX_COLORS][RGBW x count]
+//                BaseColors   [count 1..CONTROL_OP_MAX_COLORS][RGBW x count]
+//                Knockout     [pixel][brightness 0..100]
+//
+// Trailing bytes past the op's fields are ignored so an op can grow in place.
+// Op codes are append-only: a peer that advertises the cap but predates a
+// code rejects it (parse fails) rather than misreading it.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace lamp_protocol {
+
+constexpr uint8_t CONTROL_OP_BINARY_TAG = 0xC1;
+constexpr uint8_t CONTROL_OP_MAX_COLORS = 16;
+
+enum class ControlOpCode : uint8_t {
+  Brightness  = 1,
+  ShadeColors = 2,
+  BaseColors  = 3,
+  Knockout    = 4,
+};
+constexpr uint8_t CONTROL_OP_CODE_MAX = static_cast<uint8_t>(ControlOpCode::Knockout);
+
+constexpr size_t CONTROL_OP_BINARY_MAX_SIZE = 2 + 1 + CONTROL_OP_MAX_COLORS * 4;  // 67
+static_assert(CONTROL_OP_BINARY_MAX_SIZE == 67, "binary CONTROL_OP max size lock");
+
+// Fields not used by `op` are zero. `rgbw` points into the payload; caller
+// must not retain past the dispatch call.
+struct ParsedBinaryControlOp {
+  ControlOpCode  op;
+  uint8_t        level;       // Brightness
+  uint8_t        pixel;       // Knockout
+  uint8_t        brightness;  // Knockout
+  uint8_t        colorCount;  // ShadeColors / BaseColors
+  const uint8_t* rgbw;        // ShadeColors / BaseColors, colorCount * 4 bytes
+};
+
+inline bool isBinaryControlOp(const uint8_t* payload, size_t len) {
+  return payload && len >= 2 && payload[0] == CONTROL_OP_BINARY_TAG;
+}
+
+// Builders return bytes written, 0 on bad args / out-of-range / short buffer.
+inline size_t buildBinaryBrightnessOp(uint8_t* buf, size_t bufLen, uint8_t level) {
+  if (!buf || bufLen < 3 || level > 100) return 0;
+  buf[0] = CONTROL_OP_BINARY_TAG;
+  buf[1] = static_cast<uint8_t>(ControlOpCode::Brightness);
+  buf[2] = level;
+  return 3;
+}
+
+inline size_t buildBinaryKnockoutOp(uint8_t* buf, size_t bufLen,
+                                    uint8_t pixel, uint8_t brightness) {
+  if (!buf || bufLen < 4 || brightness > 100) return 0;
+  buf[0] = CONTROL_OP_BINARY_TAG;
+  buf[1] = static_cast<uint8_t>(ControlOpCode::Knockout);
+  buf[2] = pixel;
+  buf[3] = brightness;
+  return 4;
+}
+
+// `op` must be ShadeColors or BaseColors; `rgbw` is count * 4 bytes.
+inline size_t buildBinaryColorsOp(uint8_t* buf, size_t bufLen, ControlOpCode op,
+                                  const uint8_t* rgbw, uint8_t count) {
+  if (!buf || !rgbw) return 0;
+  if (op != ControlOpCode::ShadeColors && op != ControlOpCode::BaseColors) return 0;
+  if (count == 0 || count > CONTROL_OP_MAX_COLORS) return 0;
+  const size_t total = 3 + static_cast<size_t>(count) * 4;
+  if (bufLen < total) return 0;
+  buf[0] = CONTROL_OP_BINARY_TAG;
+  buf[1] = static_cast<uint8_t>(op);
+  buf[2] = count;
+  std::memcpy(&buf[3], rgbw, static_cast<size_t>(count) * 4);
+  return total;
+}
+
+// Validates the tag, the op code and every field's range; false on anything
+// a JSON sender's receiver would also have refused.
+inline bool parseBinaryControlOp(const uint8_t* payload, size_t len,
+                                 ParsedBinaryControlOp& out) {
+  if (!isBinaryControlOp(payload, len)) return false;
+  out = {};
+  out.op = static_cast<ControlOpCode>(payload[1]);
+  switch (out.op) {
+    case ControlOpCode::Brightness:
+      if (len < 3 || payload[2] > 100) return false;
+      out.level = payload[2];
+      return true;
+    case ControlOpCode::ShadeColors:
+    case ControlOpCode::BaseColors: {
+      if (len < 3) return false;
+      const uint8_t count = payload[2];
+      if (count == 0 || count > CONTROL_OP_MAX_COLORS) return false;
+      if (len < 3 + static_cast<size_t>(count) * 4) return false;
+      out.colorCount = count;
+      out.rgbw = &payload[3];
+      return true;
+    }
+    case ControlOpCode::Knockout:
+      if (len < 4 || payload[3] > 100) return false;
+      out.pixel = payload[2];
+      out.brightness = payload[3];
+      return true;
+  }
+  return false;
+}
+
+// One row of a receiver's dispatch table. Handlers run on whatever task
+// calls dispatchBinaryControlOp (MeshLink's WiFi recv task in production),
+// so they only post into pending slots.
+struct BinaryControlOpRoute {
+  ControlOpCode op;
+  void (*handler)(const ParsedBinaryControlOp& op);
+};
+
+// A table is indexed by op code: row i carries code i + 1 and every code up
+// to CONTROL_OP_CODE_MAX has a row. Checked at compile time by the owner:
+//   static_assert(binaryControlOpRoutesIndexed(kRoutes));
+template <size_t N>
+constexpr bool binaryControlOpRoutesIndexed(const BinaryControlOpRoute (&table)[N]) {
+  if (N != CONTROL_OP_CODE_MAX) return false;
+  for (size_t i = 0; i < N; i++) {
+    if (static_cast<size_t>(table[i].op) != i + 1 || !table[i].handler) return false;
+  }
+  return true;
+}
+
+// Parse and route through `table` (see binaryControlOpRoutesIndexed). No
+// heap, no JSON. Returns false when the payload is malformed or its code has
+// no row; the caller drops it.
+template <size_t N>
+inline bool dispatchBinaryControlOp(const BinaryControlOpRoute (&table)[N],
+                                    const uint8_t* payload, size_t len) {
+  ParsedBinaryControlOp op;
+  if (!parseBinaryControlOp(payload, len, op)) return false;
+  const size_t idx = static_cast<size_t>(op.op) - 1;
+  if (idx >= N) return false;
+  table[idx].handler(op);
+  return true;
+}
+
+}  // namespace lamp_protocol
@@ -15,7 +15,8 @@
 //   off  size  field
 //    0    6    header (see header.hpp)
 //    6    6    sourceMac (who fired)
-//   12    N    payload (ExpressionInvocation JSON)
+//   12    N    payload (ExpressionInvocation, JSON or binary;
+//              see expression_invocation.hpp)
 //  12+N   8    command_auth tag (HMAC-SHA256 trailer; see command_auth.hpp)
 
 namespace lamp_protocol {
@@ -19,6 +19,7 @@ namespace lamp_protocol {
 // Direction (sender = the lamp distributor over ESP-NOW, or the app's BLE
 // pusher; the wisp distributes no firmware):
 //   OFFER, CHUNK, DONE      sender → receiver
+//   REPAIR                  sender → receiver (only toward HELLO_CAP_FW_FEC)
 //   ACCEPT, REQ, RESULT     receiver → sender
 //
 // A channel/variant mismatch or downgrade is caught by otaAcceptable. The
@@ -30,8 +31,9 @@ namespace lamp_protocol {
 // build/parse entry points (parameterized by msgType, so the identical
 // machinery serves both the FW_* and FS_* type IDs):
 //   buildFwOffer/parseFwOffer   buildFwAccept/parseFwAccept
-//   buildFwChunk/parseFwChunk   buildFwReq/parseFwReq
+//   buildFwChunk/parseFwChunk   buildFwReq(+Mask)/parseFwReq
 //   buildFwDone/parseFwDone     buildFwResult/parseFwResult
+//   buildFwRepair/parseFwRepair
 //
 // Family byte-maps. All share hdr(6)+src(6)+tgt(6) = bytes 0..17; the tables
 // below give the body. Where a field has a named offset constant, the map
@@ -53,6 +55,21 @@ namespace lamp_protocol {
 // pre-auth receiver stops parsing at byte 56 and skips the trailer (its
 // existing end-of-stream verify still gates the flip). No offset shift, no
 // PROTOCOL_VERSION bump.
+//   --- delta trailer (only after the auth trailer; only toward HELLO_CAP_FW_DELTA) ---
+//   FW_OFFER_OFF_DELTA_IMAGE_LEN  4  image length the patch rebuilds (LE)
+//   FW_OFFER_OFF_DELTA_BASE_LEN   4  length of the image it applies to (LE)
+//   FW_OFFER_OFF_DELTA_BASE_ID   16  that image's LSIG signature, first 16 bytes
+// A delta OFFER streams a patch (components/firmware/ota_delta.hpp), not the
+// image: totalLen, chunkSize and totalChunks describe the patch, while
+// version, sha256Prefix, digest and signature still describe the image the
+// receiver rebuilds and verifies.
+//   --- pack trailer (after the delta trailer; only toward HELLO_CAP_FW_PACKED) ---
+//   FW_OFFER_OFF_PACK_FORMAT      1  chunk payload format (ota_pack::kFormat)
+//   +177                          3  reserved (0)
+// A packed OFFER streams LZ units (components/firmware/ota_pack.hpp), one per
+// CHUNK: totalChunks counts units and each CHUNK's offset is its first
+// decoded byte. A full-image packed OFFER zero-fills the delta trailer, which
+// then parses as no delta.
 //
 // MSG_FW_ACCEPT (FW_ACCEPT_FIXED_SIZE == 28):
 //   18  2  offerSeq (LE)   20  4  version (LE)   24  1  status (FwAcceptStatus)
@@ -63,9 +80,16 @@ namespace lamp_protocol {
 //   26  len  payload. The offset == chunkIdx * chunkSize invariant is
 //   receiver-side (session context owns chunkSize), not parsed here.
 //
-// MSG_FW_REQ    (FW_REQ_FIXED_SIZE == 24):
+// MSG_FW_REQ    (FW_REQ_FIXED_SIZE == 24, + optional mask trailer):
 //   18  2  firstChunkIdx (LE)  20  2  chunkCount (LE, 1..32)  22  1  reason
 //   23  1  reserved
+//   --- mask trailer (exact-hole REQ; only toward HELLO_CAP_FW_REQ_BITMAP) ---
+//   24  1  maskLen (1..FW_REQ_MASK_MAX_BYTES)
+//   25  maskLen  missing-chunk mask, LSB-first: bit i = chunk firstChunkIdx+i
+//                still missing. Bit 0 is always set; trailing zero bytes are
+//                trimmed, so a tail REQ for one hole is 26 bytes.
+// The fixed body still carries the covering run, so a distributor that stops
+// parsing at byte 24 serves it as a plain run REQ.
 //
 // MSG_FW_DONE   (FW_DONE_FIXED_SIZE == 38):
 //   18  4  version (LE)  22  4  totalLen (LE)  26  8  sha256Prefix
@@ -74,7 +98,19 @@ namespace lamp_protocol {
 // MSG_FW_RESULT (FW_RESULT_FIXED_SIZE == 24):
 //   18  1  status (FwResultStatus)  19  1  detail  20  4  version (LE)
 //
-// MSG_FS_* (0x46..0x4B) reuse every layout above via the msgType parameter.
+// MSG_FW_REPAIR (FW_REPAIR_FIXED_SIZE == 26 + payload, MAX 1470):
+//   18  2  windowStart (LE)   20  1  windowLen (1..FW_FEC_WINDOW_CHUNKS)
+//   21  1  row (< FW_FEC_MAX_ROWS)   22  1  stride (1..FW_FEC_MAX_STRIDE)
+//   23  1  reserved   24  2  len (LE)   26  len  payload
+//   Column i of the window is chunk windowStart + i * stride; windowStart sits
+//   in the first `stride` chunks of a FW_FEC_WINDOW_CHUNKS * stride block. The
+//   payload is sum_i coef(row, i) * chunk[column i] over GF(2^8), each chunk
+//   zero-padded to len (the window's longest chunk); see
+//   components/firmware/ota_fec.hpp. Any m repair rows of a window rebuild any
+//   m of its chunks, so the receiver heals scattered loss without a REQ.
+//
+// MSG_FS_* (0x46..0x4B, and 0x4D for REPAIR) reuse every layout above via the
+// msgType parameter.
 
 constexpr uint8_t  MSG_FW_OFFER  = 0x40;
 constexpr uint8_t  MSG_FW_ACCEPT = 0x41;
@@ -99,6 +135,14 @@ constexpr uint8_t  MSG_FS_RESULT = 0x4B;
 static_assert(MSG_FS_RESULT < kReservedMsgTypeHighBit,
               "MSG_FS_* must stay below the reserved high-bit type space");
 
+// Window parity for the chunk stream, FW and FS flavours. Emitted only toward
+// a peer advertising HELLO_CAP_FW_FEC, so an old lamp never sees one (and
+// would drop the unknown msgType if it did).
+constexpr uint8_t  MSG_FW_REPAIR = 0x4C;
+constexpr uint8_t  MSG_FS_REPAIR = 0x4D;
+static_assert(MSG_FS_REPAIR < kReservedMsgTypeHighBit,
+              "MSG_*_REPAIR must stay below the reserved high-bit type space");
+
 // Channel string is zero-padded ASCII, fixed-width. Carries `{type}-{channel}`
 // (e.g. "standard-stable", "snafu-beta") so otaAcceptable enforces per-variant
 // OTA gating without a separate type field.
@@ -123,6 +167,19 @@ constexpr uint16_t FW_CHUNK_SIZE_MAX      = 1444;
 // Cap on per-REQ run length. One flash sector; wider values not yet
 // stability-tested under real ESP-NOW loss rates.
 constexpr uint16_t FW_MAX_REQ_RUN_CHUNKS = 20;
+// Exact-hole REQ window: a 32-byte mask names every hole in the 256 chunks
+// from firstChunkIdx, so one round trip clears a whole stretch of scattered
+// loss. The frame tops out at 57 bytes.
+constexpr size_t   FW_REQ_MASK_MAX_BYTES  = 32;
+constexpr uint16_t FW_REQ_MASK_MAX_CHUNKS = FW_REQ_MASK_MAX_BYTES * 8;
+// Repair coding window: up to 16 chunks `stride` apart share parity rows. 16
+// keeps a receiver's decode to a 16x16 solve and a few held repair payloads.
+constexpr uint8_t  FW_FEC_WINDOW_CHUNKS   = 16;
+// Repair row ids stay below this so the Cauchy row and column points never
+// collide in GF(2^8): rows map to 16..255, columns to 0..15.
+constexpr uint16_t FW_FEC_MAX_ROWS        = 256 - FW_FEC_WINDOW_CHUNKS;
+// Widest window interleave: one block spans 16 windows of 16, 256 chunks.
+constexpr uint8_t  FW_FEC_MAX_STRIDE      = 16;
 
 // Largest chunk count a receiver can track. chunkIdx and OFFER.totalChunks are
 // both uint16, so a count above this is unrepresentable on the wire; it also
@@ -149,6 +206,36 @@ inline bool offerChunkCountOk(uint32_t totalLen, uint16_t chunkSize,
   return true;
 }
 
+// One-to-many session target: the distributor's own MAC with the IEEE group
+// bit set. No station holds it and it isn't broadcast, so a lamp that doesn't
+// know group sessions drops CHUNK/REPAIR/DONE sent to it, and a group-aware
+// lamp can tell whose session a frame belongs to from the source alone.
+inline void fwGroupMac(const uint8_t sourceMac[6], uint8_t out[6]) {
+  std::memcpy(out, sourceMac, 6);
+  out[0] = static_cast<uint8_t>(out[0] | 0x01);
+}
+
+inline bool isFwGroupTarget(const uint8_t targetMac[6],
+                            const uint8_t sourceMac[6]) {
+  uint8_t group[6];
+  fwGroupMac(sourceMac, group);
+  return (sourceMac[0] & 0x01) == 0 && std::memcmp(targetMac, group, 6) == 0;
+}
+
+// Receive-side filter for CHUNK/REPAIR/DONE: frames addressed to us or
+// broadcast, and a distributor's group-addressed frames only while we're in
+// that distributor's session (inGroupOfSource).
+inline bool isFwStreamForUs(const uint8_t targetMac[6],
+                            const uint8_t sourceMac[6], const uint8_t myMac[6],
+                            bool inGroupOfSource) {
+  static const uint8_t bcast[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+  if (std::memcmp(targetMac, myMac, 6) == 0 ||
+      std::memcmp(targetMac, bcast, 6) == 0) {
+    return true;
+  }
+  return inGroupOfSource && isFwGroupTarget(targetMac, sourceMac);
+}
+
 // OTA-viable signal floor for a direct single-hop OFFER. Below this, chunk
 // transfer thrashes regardless of chunk size, so both the offering and
 // receiving side skip it and let cascade OTA reach the peer via a nearer
@@ -159,6 +246,16 @@ inline bool offerChunkCountOk(uint32_t totalLen, uint16_t chunkSize,
 // lamp.
 constexpr int8_t kOtaMinRssiDbm = -92;
 
+// Repair rows (HELLO_CAP_FW_FEC) are opt-in. On the simulated bursty link the
+// exact-hole REQ alone finishes sooner in fewer frames (test_ota_fec), and a
+// receiver's repair slots hold ~13 KB of heap from OFFER to Idle. A lamp built
+// without LAMP_OTA_FEC neither advertises the cap nor honours it from a peer,
+// so it never emits or decodes rows.
+#ifndef LAMP_OTA_FEC
+#define LAMP_OTA_FEC 0
+#endif
+constexpr uint8_t kOtaFecCap = LAMP_OTA_FEC ? HELLO_CAP_FW_FEC : 0;
+
 // Fixed-size frame totals. The byte layout for each is the per-builder
 // comment below.
 constexpr size_t   FW_OFFER_FIXED_SIZE  = 56;   // hdr(6)+src(6)+tgt(6) + body(38)
@@ -180,11 +277,25 @@ constexpr size_t   FW_OFFER_OFF_SIG          = FW_OFFER_OFF_DIGEST + FW_SHA256_F
 constexpr size_t   FW_OFFER_AUTH_SIZE        = FW_OFFER_OFF_SIG + FW_SIG_LEN;                // 152
 static_assert(FW_OFFER_AUTH_SIZE == FW_OFFER_FIXED_SIZE + FW_SHA256_FULL_LEN + FW_SIG_LEN,
               "FW OFFER auth trailer must follow the fixed body contiguously");
+// Delta trailer, after the auth trailer. The base id is a prefix of the base
+// image's LSIG signature: ed25519 is deterministic, so it names one image, and
+// a lamp reads its own from its footer without hashing the image.
+constexpr size_t   FW_DELTA_BASE_ID_LEN         = 16;
+constexpr size_t   FW_OFFER_OFF_DELTA_IMAGE_LEN = FW_OFFER_AUTH_SIZE;                        // 152
+constexpr size_t   FW_OFFER_OFF_DELTA_BASE_LEN  = FW_OFFER_OFF_DELTA_IMAGE_LEN + 4;          // 156
+constexpr size_t   FW_OFFER_OFF_DELTA_BASE_ID   = FW_OFFER_OFF_DELTA_BASE_LEN + 4;           // 160
+constexpr size_t   FW_OFFER_DELTA_SIZE          = FW_OFFER_OFF_DELTA_BASE_ID + FW_DELTA_BASE_ID_LEN;  // 176
+// Pack trailer, after the delta trailer.
+constexpr size_t   FW_OFFER_OFF_PACK_FORMAT     = FW_OFFER_DELTA_SIZE;                       // 176
+constexpr size_t   FW_OFFER_PACK_SIZE           = FW_OFFER_OFF_PACK_FORMAT + 4;              // 180
 constexpr size_t   FW_ACCEPT_FIXED_SIZE = 28;   // hdr(6)+src(6)+tgt(6) + body(10)
 constexpr size_t   FW_CHUNK_FIXED_SIZE  = 26;   // hdr(6)+src(6)+tgt(6) + body(8) (payload trails)
 constexpr size_t   FW_CHUNK_MAX_SIZE    = FW_CHUNK_FIXED_SIZE + FW_CHUNK_SIZE_MAX;  // 1470
 constexpr size_t   FW_REQ_FIXED_SIZE    = 24;   // hdr(6)+src(6)+tgt(6) + body(6)
+constexpr size_t   FW_REQ_MASK_MAX_SIZE = FW_REQ_FIXED_SIZE + 1 + FW_REQ_MASK_MAX_BYTES;  // 57
 constexpr size_t   FW_DONE_FIXED_SIZE   = 38;   // hdr(6)+src(6)+tgt(6) + body(20)
+constexpr size_t   FW_REPAIR_FIXED_SIZE = 26;   // hdr(6)+src(6)+tgt(6) + body(8) (payload trails)
+constexpr size_t   FW_REPAIR_MAX_SIZE   = FW_REPAIR_FIXED_SIZE + FW_CHUNK_SIZE_MAX;  // 1470
 constexpr size_t   FW_RESULT_FIXED_SIZE = 24;   // hdr(6)+src(6)+tgt(6) + body(6)
 
 // Lock-in static asserts. A future refactor that shifts a byte will fail
@@ -195,20 +306,29 @@ static_assert(FW_CHUNK_FIXED_SIZE  == 26, "FW CHUNK header lock");
 static_assert(FW_REQ_FIXED_SIZE    == 24, "FW REQ size lock");
 static_assert(FW_DONE_FIXED_SIZE   == 38, "FW DONE size lock");
 static_assert(FW_RESULT_FIXED_SIZE == 24, "FW RESULT size lock");
+static_assert(FW_REPAIR_FIXED_SIZE == 26, "FW REPAIR header lock");
+static_assert(FW_REPAIR_MAX_SIZE   <= ESPNOW_V2_FRAME_MAX, "ESP-NOW v2 frame cap");
 static_assert(FW_CHUNK_MAX_SIZE    <= ESPNOW_V2_FRAME_MAX, "ESP-NOW v2 frame cap");
 static_assert(FW_OFFER_FIXED_SIZE  <= ESPNOW_V2_FRAME_MAX, "ESP-NOW v2 frame cap");
 static_assert(FW_OFFER_AUTH_SIZE   <= ESPNOW_V2_FRAME_MAX,
               "ESP-NOW v2 frame cap (OFFER + auth trailer)");
+static_assert(FW_OFFER_DELTA_SIZE  <= ESPNOW_V2_FRAME_MAX,
+              "ESP-NOW v2 frame cap (OFFER + auth + delta trailers)");
+static_assert(FW_OFFER_PACK_SIZE   <= ESPNOW_V2_FRAME_MAX,
+              "ESP-NOW v2 frame cap (OFFER + auth + delta + pack trailers)");
 
 // ACCEPT status byte. 0 = accept-and-stream; 1 = busy (mid-flow already);
 // 2 = already-current, which also covers an offer otaAcceptable rejects
 // (wrong channel, cross-variant, downgrade); 3 = offer failed the offer-time
-// ed25519 signature check (unsigned/foreign-key/tampered), never streamed.
+// ed25519 signature check (unsigned/foreign-key/tampered), never streamed;
+// 4 = a delta OFFER whose base isn't the running image, or whose patch and
+// image don't both fit the slot; the distributor offers the full image next.
 enum class FwAcceptStatus : uint8_t {
   Accept                = 0,
   DeclineBusy           = 1,
   DeclineAlreadyCurrent = 2,
   DeclineUnverified     = 3,
+  DeclineDeltaBase      = 4,
 };
 
 // REQ reason. Diagnostic-only; wisp logs it.
@@ -217,7 +337,7 @@ enum class FwReqReason : uint8_t {
   StallWatchdog = 1,  // 2s without progress; emit one REQ for the lowest gap
 };
 
-// RESULT status enum. uint8_t on the wire; values 9..255 reserved for forward-compat.
+// RESULT status enum. uint8_t on the wire; values 12..255 reserved for forward-compat.
 // The wisp treats unknown codes as "abort + log + back off".
 enum class FwResultStatus : uint8_t {
   Success            = 0,  // verified + boot partition set + rebooting
@@ -233,7 +353,8 @@ enum class FwResultStatus : uint8_t {
   // frame). These take values from the firmware enum's reserved 9..255 range.
   FsMountFail        = 9,   // spiffs unmountable after write → can't recompute digest
   FsDigestMismatch   = 10,  // recomputed manifest digest != fw.lsig signature
-  // 11..255 reserved
+  DeltaApplyFail     = 11,  // delta patch malformed or didn't match the offer
+  // 12..255 reserved
 };
 
 // --- Parsed structs -------------------------------------------------------
@@ -254,6 +375,14 @@ struct ParsedFwOffer {
   bool     hasAuth;
   uint8_t  digest[FW_SHA256_FULL_LEN];
   uint8_t  signature[FW_SIG_LEN];
+  // Delta trailer. isDelta false for a full-image OFFER; the fields are then
+  // zeroed.
+  bool     isDelta;
+  uint32_t deltaImageLen;
+  uint32_t deltaBaseLen;
+  uint8_t  deltaBaseId[FW_DELTA_BASE_ID_LEN];
+  // Pack trailer. 0 for raw chunks.
+  uint8_t  packFormat;
 };
 
 struct ParsedFwAccept {
@@ -276,6 +405,18 @@ struct ParsedFwChunk {
   const uint8_t* bytes;  // points into recv buffer; caller must not retain
 };
 
+struct ParsedFwRepair {
+  uint16_t       seq;
+  uint8_t        sourceMac[6];
+  uint8_t        targetMac[6];
+  uint16_t       windowStart;
+  uint8_t        windowLen;
+  uint8_t        row;
+  uint8_t        stride;
+  uint16_t       len;
+  const uint8_t* bytes;  // points into recv buffer; caller must not retain
+};
+
 struct ParsedFwReq {
   uint16_t    seq;
   uint8_t     sourceMac[6];
@@ -283,6 +424,9 @@ struct ParsedFwReq {
   uint16_t    firstChunkIdx;
   uint16_t    chunkCount;
   FwReqReason reason;
+  // Exact-hole mask trailer; maskLen 0 = plain run REQ (no trailer).
+  uint8_t     maskLen;
+  uint8_t     mask[FW_REQ_MASK_MAX_BYTES];
 };
 
 struct ParsedFwDone {
@@ -363,6 +507,39 @@ inline size_t buildFwOffer(uint8_t* buf, size_t bufLen, uint16_t seq,
   return frameLen;
 }
 
+// Appends the delta trailer to an authenticated OFFER already built in buf
+// (offerLen == FW_OFFER_AUTH_SIZE). Returns the new frame length, 0 on bad
+// args or a short buffer.
+inline size_t appendFwOfferDelta(uint8_t* buf, size_t bufLen, size_t offerLen,
+                                 uint32_t imageLen, uint32_t baseLen,
+                                 const uint8_t baseId[FW_DELTA_BASE_ID_LEN]) {
+  if (!buf || !baseId || offerLen != FW_OFFER_AUTH_SIZE) return 0;
+  if (bufLen < FW_OFFER_DELTA_SIZE) return 0;
+  for (int i = 0; i < 4; ++i) {
+    buf[FW_OFFER_OFF_DELTA_IMAGE_LEN + i] = static_cast<uint8_t>((imageLen >> (8 * i)) & 0xFF);
+    buf[FW_OFFER_OFF_DELTA_BASE_LEN + i]  = static_cast<uint8_t>((baseLen >> (8 * i)) & 0xFF);
+  }
+  std::memcpy(&buf[FW_OFFER_OFF_DELTA_BASE_ID], baseId, FW_DELTA_BASE_ID_LEN);
+  return FW_OFFER_DELTA_SIZE;
+}
+
+// Appends the pack trailer to an authenticated OFFER already built in buf,
+// with or without its delta trailer (offerLen == FW_OFFER_AUTH_SIZE or
+// FW_OFFER_DELTA_SIZE); without one, the delta trailer is zero-filled.
+// Returns the new frame length, 0 on bad args or a short buffer.
+inline size_t appendFwOfferPack(uint8_t* buf, size_t bufLen, size_t offerLen,
+                                uint8_t format) {
+  if (!buf || format == 0) return 0;
+  if (offerLen != FW_OFFER_AUTH_SIZE && offerLen != FW_OFFER_DELTA_SIZE) return 0;
+  if (bufLen < FW_OFFER_PACK_SIZE) return 0;
+  if (offerLen == FW_OFFER_AUTH_SIZE) {
+    std::memset(&buf[FW_OFFER_AUTH_SIZE], 0, FW_OFFER_DELTA_SIZE - FW_OFFER_AUTH_SIZE);
+  }
+  buf[FW_OFFER_OFF_PACK_FORMAT] = format;
+  std::memset(&buf[FW_OFFER_OFF_PACK_FORMAT + 1], 0, 3);
+  return FW_OFFER_PACK_SIZE;
+}
+
 // MSG_FW_ACCEPT (28 bytes):
 //   hdr(6) + src(6) + tgt(6) + body(10)
 // Body: offerSeq(2 LE) + version(4 LE) + status(1) + reserved(3)
@@ -447,6 +624,29 @@ inline size_t buildFwReq(uint8_t* buf, size_t bufLen, uint16_t seq,
   return FW_REQ_FIXED_SIZE;
 }
 
+// Exact-hole MSG_FW_REQ (FW_REQ_FIXED_SIZE + 1 + maskLen): the fixed REQ
+// above, then maskLen + mask. mask[0] bit 0 must be set (firstChunkIdx is a
+// hole) and mask[maskLen-1] non-zero; the caller trims trailing zero bytes.
+inline size_t buildFwReqMask(uint8_t* buf, size_t bufLen, uint16_t seq,
+                             const uint8_t sourceMac[6], const uint8_t targetMac[6],
+                             uint16_t firstChunkIdx, uint16_t chunkCount,
+                             FwReqReason reason,
+                             const uint8_t* mask, size_t maskLen,
+                             uint8_t wireVersion = PROTOCOL_VERSION_EMIT,
+                             uint8_t msgType = MSG_FW_REQ) {
+  if (!mask || maskLen == 0 || maskLen > FW_REQ_MASK_MAX_BYTES) return 0;
+  if ((mask[0] & 0x01) == 0 || mask[maskLen - 1] == 0) return 0;
+  const size_t total = FW_REQ_FIXED_SIZE + 1 + maskLen;
+  if (bufLen < total) return 0;
+  if (!buildFwReq(buf, bufLen, seq, sourceMac, targetMac, firstChunkIdx,
+                  chunkCount, reason, wireVersion, msgType)) {
+    return 0;
+  }
+  buf[FW_REQ_FIXED_SIZE] = static_cast<uint8_t>(maskLen);
+  std::memcpy(&buf[FW_REQ_FIXED_SIZE + 1], mask, maskLen);
+  return total;
+}
+
 // MSG_FW_DONE (38 bytes):
 //   hdr(6) + src(6) + tgt(6) + version(4 LE) + totalLen(4 LE)
 //   + sha256Prefix(8) + footerLen(2 LE) + reserved(2)
@@ -499,6 +699,45 @@ inline size_t buildFwResult(uint8_t* buf, size_t bufLen, uint16_t seq,
   return FW_RESULT_FIXED_SIZE;
 }
 
+// Shape check shared by the MSG_FW_REPAIR builder and parser: stride in
+// range, windowStart among the first `stride` chunks of its block.
+inline bool fecWindowOk(uint16_t windowStart, uint8_t windowLen, uint8_t stride,
+                        uint8_t row) {
+  if (stride == 0 || stride > FW_FEC_MAX_STRIDE) return false;
+  if (windowStart % (FW_FEC_WINDOW_CHUNKS * stride) >= stride) return false;
+  if (windowLen == 0 || windowLen > FW_FEC_WINDOW_CHUNKS) return false;
+  return row < FW_FEC_MAX_ROWS;
+}
+
+// MSG_FW_REPAIR (26 + len bytes):
+//   hdr(6) + src(6) + tgt(6) + windowStart(2 LE) + windowLen(1) + row(1)
+//   + stride(1) + reserved(1) + len(2 LE) + payload(len)
+inline size_t buildFwRepair(uint8_t* buf, size_t bufLen, uint16_t seq,
+                            const uint8_t sourceMac[6], const uint8_t targetMac[6],
+                            uint16_t windowStart, uint8_t windowLen, uint8_t stride,
+                            uint8_t row, const uint8_t* bytes, uint16_t len,
+                            uint8_t wireVersion = PROTOCOL_VERSION_EMIT,
+                            uint8_t msgType = MSG_FW_REPAIR) {
+  if (!buf || !sourceMac || !targetMac || !bytes) return 0;
+  if (len == 0 || len > FW_CHUNK_SIZE_MAX) return 0;
+  if (!fecWindowOk(windowStart, windowLen, stride, row)) return 0;
+  const size_t total = FW_REPAIR_FIXED_SIZE + static_cast<size_t>(len);
+  if (bufLen < total) return 0;
+  detail::writeHeader(buf, msgType, seq, wireVersion);
+  std::memcpy(&buf[6], sourceMac, 6);
+  std::memcpy(&buf[12], targetMac, 6);
+  buf[18] = static_cast<uint8_t>(windowStart & 0xFF);
+  buf[19] = static_cast<uint8_t>((windowStart >> 8) & 0xFF);
+  buf[20] = windowLen;
+  buf[21] = row;
+  buf[22] = stride;
+  buf[23] = 0;  // reserved
+  buf[24] = static_cast<uint8_t>(len & 0xFF);
+  buf[25] = static_cast<uint8_t>((len >> 8) & 0xFF);
+  std::memcpy(&buf[FW_REPAIR_FIXED_SIZE], bytes, len);
+  return total;
+}
+
 // --- Parsers --------------------------------------------------------------
 
 inline bool parseFwOffer(const uint8_t* data, size_t len, ParsedFwOffer& out,
@@ -539,6 +778,19 @@ inline bool parseFwOffer(const uint8_t* data, size_t len, ParsedFwOffer& out,
     std::memset(out.digest, 0, FW_SHA256_FULL_LEN);
     std::memset(out.signature, 0, FW_SIG_LEN);
   }
+  out.deltaImageLen = 0;
+  out.deltaBaseLen  = 0;
+  std::memset(out.deltaBaseId, 0, FW_DELTA_BASE_ID_LEN);
+  if (len >= FW_OFFER_DELTA_SIZE) {
+    for (int i = 0; i < 4; ++i) {
+      out.deltaImageLen |= static_cast<uint32_t>(data[FW_OFFER_OFF_DELTA_IMAGE_LEN + i]) << (8 * i);
+      out.deltaBaseLen  |= static_cast<uint32_t>(data[FW_OFFER_OFF_DELTA_BASE_LEN + i]) << (8 * i);
+    }
+    std::memcpy(out.deltaBaseId, &data[FW_OFFER_OFF_DELTA_BASE_ID], FW_DELTA_BASE_ID_LEN);
+  }
+  // A zero-filled delta trailer (a full-image packed OFFER) isn't a delta.
+  out.isDelta    = out.deltaImageLen != 0;
+  out.packFormat = len >= FW_OFFER_PACK_SIZE ? data[FW_OFFER_OFF_PACK_FORMAT] : 0;
   return true;
 }
 
@@ -607,6 +859,17 @@ inline bool parseFwReq(const uint8_t* data, size_t len, ParsedFwReq& out,
      | (static_cast<uint16_t>(data[21]) << 8);
   if (out.chunkCount == 0 || out.chunkCount > 32) return false;
   out.reason = static_cast<FwReqReason>(data[22]);
+  out.maskLen = 0;
+  if (len == FW_REQ_FIXED_SIZE) return true;
+  // A trailer, once present, must be well-formed: a truncated or oversized
+  // mask would have the distributor serve chunks nobody asked for.
+  const size_t maskLen = data[FW_REQ_FIXED_SIZE];
+  if (maskLen == 0 || maskLen > FW_REQ_MASK_MAX_BYTES) return false;
+  if (len < FW_REQ_FIXED_SIZE + 1 + maskLen) return false;
+  const uint8_t* mask = &data[FW_REQ_FIXED_SIZE + 1];
+  if ((mask[0] & 0x01) == 0) return false;
+  out.maskLen = static_cast<uint8_t>(maskLen);
+  std::memcpy(out.mask, mask, maskLen);
   return true;
 }
 
@@ -651,6 +914,32 @@ inline bool parseFwResult(const uint8_t* data, size_t len, ParsedFwResult& out,
   return true;
 }
 
+inline bool parseFwRepair(const uint8_t* data, size_t len, ParsedFwRepair& out,
+                          uint8_t expectType = MSG_FW_REPAIR) {
+  if (inspect(data, len) != expectType) return false;
+  if (len < FW_REPAIR_FIXED_SIZE) return false;
+  const uint16_t payloadLen =
+       static_cast<uint16_t>(data[24])
+     | (static_cast<uint16_t>(data[25]) << 8);
+  if (payloadLen == 0 || payloadLen > FW_CHUNK_SIZE_MAX) return false;
+  if (len != FW_REPAIR_FIXED_SIZE + static_cast<size_t>(payloadLen)) return false;
+  out.windowStart =
+       static_cast<uint16_t>(data[18])
+     | (static_cast<uint16_t>(data[19]) << 8);
+  out.windowLen = data[20];
+  out.row = data[21];
+  out.stride = data[22];
+  if (!fecWindowOk(out.windowStart, out.windowLen, out.stride, out.row)) return false;
+  out.seq = static_cast<uint16_t>(data[4]) | (static_cast<uint16_t>(data[5]) << 8);
+  std::memcpy(out.sourceMac, &data[6], 6);
+  std::memcpy(out.targetMac, &data[12], 6);
+  out.len = payloadLen;
+  // Whether windowLen and len match the image needs the session's chunkSize
+  // and totalLen; the receiver checks them.
+  out.bytes = &data[FW_REPAIR_FIXED_SIZE];
+  return true;
+}
+
 // Pre-erase auth decision for a firmware OFFER. Pure: no flash, no state.
 // Called after chunkSize and channel checks pass; returns DeclineUnverified
 // when the offer's auth trailer is absent or its ed25519 verify failed,
@@ -3,8 +3,8 @@
 // lamp_protocol umbrella for the lamp firmware. Pulls the shared mesh wire
 // core (header + presence + control_op + wisp + override + dedup_ring +
 // MAX_PACKET_SIZE) from the lampos-protocol library, then layers the
-// lamp-only families (OTA/FS, directed command/color, event) on top. The
-// wisp compiles only the shared core.
+// lamp-only families (OTA/FS, directed command/color, event, binary
+// control-op payloads) on top. The wisp compiles only the shared core.
 //
 // Shared core lives in software/shared/protocol/; the wisp includes the same
 // <lampos/protocol/lamp_protocol.hpp>. Lamp-only families stay here beside
@@ -15,5 +15,6 @@
 #include "command_auth.hpp"
 #include "command.hpp"
 #include "color_info.hpp"
+#include "control_op_binary.hpp"
 #include "event.hpp"
 #include "fw_ota.hpp"
@@ -5,7 +5,7 @@
 #include "behaviors/configurator.hpp"
 #include "core/behavior_context.hpp"
 #include "core/frame_buffer.hpp"
-#include "util/gradient.hpp"
+#include "util/gradient_cache.hpp"
 
 namespace lamp {
 
@@ -59,23 +59,21 @@ void ColorOverride::apply(const uint8_t sourceMac[6],
   // configuration changed (rare; only at boot or factory reset).
   if (configurator_->fb) pixelCount_ = configurator_->fb->pixelCount;
 
-  // Expand the stops into a per-pixel gradient via the existing helper.
-  std::vector<Color> stops(colors, colors + numColors);
-  std::vector<Color> target =
-      lamp::buildGradientWithStops(pixelCount_, stops);
-
-  // Cache the full per-pixel gradient so reassertHold() can re-install
-  // it after test_expression_complete's payload momentarily overwrites
-  // `configurator.colors` with the lamp's saved baseline.
-  targetGradient_ = target;
+  // Expand the stops into the full per-pixel gradient, kept so
+  // reassertHold() can re-install it after test_expression_complete's
+  // payload momentarily overwrites `configurator.colors` with the lamp's
+  // saved baseline. Expanded in place: a wisp paint stream re-applies at
+  // frame rate and must not churn the heap.
+  targetGradient_.resize(pixelCount_);
+  lamp::renderGradient(targetGradient_.data(), pixelCount_, colors, numColors);
 
   // Cache the wisp paint's first stop for the app's indicator. Only
   // record on wisp-sourced applies so a hypothetical future producer
   // can't pollute the "last wisp color" view.
   bool wispColorChanged = false;
   if (source == lamp_protocol::OverrideSource::Wisp) {
-    wispColorChanged = !hasLastWispColor_ || !(lastWispColor_ == stops[0]);
-    lastWispColor_ = stops[0];
+    wispColorChanged = !hasLastWispColor_ || !(lastWispColor_ == colors[0]);
+    lastWispColor_ = colors[0];
     hasLastWispColor_ = true;
   }
 
@@ -89,8 +87,8 @@ void ColorOverride::apply(const uint8_t sourceMac[6],
   // upstream in the wire decode.
   Serial.printf("[override] beginFade surface=0x%02X src=%d target0=(R=%u G=%u B=%u W=%u)\n",
                 (unsigned)surface_, (int)source,
-                (unsigned)stops[0].r, (unsigned)stops[0].g,
-                (unsigned)stops[0].b, (unsigned)stops[0].w);
+                (unsigned)colors[0].r, (unsigned)colors[0].g,
+                (unsigned)colors[0].b, (unsigned)colors[0].w);
 #endif
   // Wisp pixels are rendered by the compositor's LayerStack wisp layer, fed
   // from the drain adapter. This override only tracks state (isWispActive,
@@ -17,13 +17,13 @@
 #include <cstring>
 #include <string>
 
-#include "expr_catalog.h"
 #include "components/firmware/ota_quiet_mode.hpp"
 #include "components/network/ble/ble_control.hpp"
 #include "components/network/transport/wifi.hpp"
 #include "components/webapp/webapp_deadline.hpp"
 #include "config/config_types.hpp"
 #include "core/pending_json_slot.hpp"
+#include "expressions/expr_catalog.hpp"
 #include "util/color.hpp"
 #include "util/heap_probe.hpp"
 
@@ -8,8 +8,9 @@
 #include <freertos/semphr.h>
 
 #include "config/config_codec.hpp"
+#include "config/config_sections.hpp"
 #include "core/lamp.hpp"
-#include "expr_catalog.h"
+#include "expressions/expr_catalog.hpp"
 #include "util/bd_addr.hpp"
 #include "util/color.hpp"
 #include "version.hpp"
@@ -34,87 +35,69 @@ static void seedRoleSegments(std::vector<SegmentSettings>& segs,
 }
 
 Config::Config(ConfigStore* inStore) {
-  JsonDocument doc;
   store_ = inStore;
   dispositions_.attachStore(store_);
-  std::string json = store_->read("cfg", "{}");
-  DeserializationError error = deserializeJson(doc, json);
+  // Binary section blobs decode straight into the model; only a section
+  // still in an older JSON layout goes through config_codec::fromJson.
+  const config_sections::LoadResult loaded = config_sections::load(
+      *store_, lamp, base, shade, expressions, homeMode, stored_);
 
 #ifdef LAMP_DEBUG
-  // Print a compact, secret-free summary instead of the raw NVS JSON.
-  // The raw payload would leak `lamp.password` to anyone on the serial
-  // console (USB physical access). If you need the full shape while
-  // debugging a parse bug, attach a temporary `Serial.println(json)`
-  // for that session; don't roll back this redaction. Reads off `doc`
-  // (already parsed above) rather than a second JsonDocument + parse.
-  if (error == DeserializationError::Ok) {
-    const char* loadedName = doc["lamp"]["name"] | "<unset>";
-    const char* pwField = doc["lamp"]["password"] | "";
-    const bool hasPassword = pwField != nullptr && pwField[0] != '\0';
-    const int exprCount = doc["expressions"].is<JsonArray>()
-                              ? (int)doc["expressions"].as<JsonArray>().size()
-                              : 0;
+  // Print a compact, secret-free summary instead of the stored config. The
+  // raw payload would leak `lamp.password` to anyone on the serial console
+  // (USB physical access). If you need the full shape while debugging a
+  // load bug, attach a temporary serializeJson(asJsonDocument(), Serial)
+  // for that session; don't roll back this redaction.
+  if (loaded.ok) {
     Serial.printf(
-        "[cfg] loaded name=%s pw=%s expressions=%d nvs_bytes=%u\n",
-        loadedName, hasPassword ? "set" : "unset", exprCount,
-        (unsigned)json.length());
+        "[cfg] loaded name=%s pw=%s expressions=%d nvs_bytes=%u from_json=%u "
+        "replayed=%u legacy_newer=%d\n",
+        lamp.name.c_str(), lamp.password.empty() ? "unset" : "set",
+        (int)expressions.expressions.size(), (unsigned)loaded.bytes,
+        (unsigned)loaded.fromJson, (unsigned)loaded.replayed,
+        (int)loaded.legacyNewer);
   } else {
-    Serial.printf("[cfg] loaded nvs_bytes=%u (parse failed; full dump suppressed)\n",
-                  (unsigned)json.length());
+    Serial.printf("[cfg] loaded nvs_bytes=%u (load failed: %s; full dump suppressed)\n",
+                  (unsigned)loaded.bytes, loaded.error);
   }
 #endif
 
-  if (error) {
-    if (configBlobHasData(json)) {
+  if (!loaded.ok) {
+    if (loaded.hadData) {
       loadFailedWithData_ = true;
       Serial.printf(
           "[cfg] STORED CONFIG FAILED TO PARSE (%u bytes) — serving defaults "
           "WITHOUT overwriting NVS\n",
-          (unsigned)json.length());
+          (unsigned)loaded.bytes);
     }
-#ifdef LAMP_DEBUG
-    Serial.printf("ws deserializeJson() failed: %s\n", error.c_str());
-#endif
     return;  // use class defaults
   }
-
-  config_codec::fromJson(doc.as<JsonObject>(), lamp, base, shade, expressions,
-                         homeMode);
-  namedKeyPresent_ = doc["lamp"]["named"].is<bool>();
+  namedKeyPresent_ = loaded.namedKeyPresent;
 
   // Per-peer dispositions live in a separate NVS key.
   dispositions_.load();
 };
 
-bool Config::persistConfig(const char* via) {
+bool Config::persistConfig(const char* via, uint8_t* sectionsWritten) {
+  if (sectionsWritten) *sectionsWritten = 0;
   if (!store_) return false;
-  JsonDocument doc = asJsonDocument();
-  String out;
-  // Reserve the exact serialized size up front; growing by doubling would
-  // momentarily need ~2x the final size contiguous on a heap this fragmented,
-  // tipping into bad_alloc.
-  out.reserve(measureJson(doc));
-  try {
-    serializeJson(doc, out);
-  } catch (const std::bad_alloc&) {
+  // Each section is encoded on its own and written only when its bytes moved
+  // since the last write (or since boot). A store write returns 0 bytes when
+  // NVS is full or the partition is corrupt; that section keeps its old hash
+  // and the next call retries it.
+  const config_sections::PersistResult r = config_sections::persist(
+      *store_, lamp, base, shade, expressions, homeMode, stored_);
+  if (sectionsWritten) *sectionsWritten = r.written;
 #ifdef LAMP_DEBUG
-    Serial.println("[nvs] persistConfig OOM during serialize");
-#endif
-    return false;
-  }
-  // A store write returns 0 bytes when NVS is full or the partition is
-  // corrupt; the caller decides what to do (callers today just move on;
-  // expression edits stay in RAM and the next attempt may succeed).
-  size_t written = store_->write("cfg", out.c_str());
-#ifdef LAMP_DEBUG
-  if (written == 0) {
-    Serial.println("[nvs] persistConfig wrote 0 bytes");
+  if (!r.ok) {
+    Serial.printf("[nvs] persistConfig via=%s failed after %u section(s)\n",
+                  via, (unsigned)r.written);
   } else {
-    Serial.printf("[nvs] persistConfig via=%s wrote %u bytes\n",
-                  via, (unsigned)written);
+    Serial.printf("[nvs] persistConfig via=%s wrote %u section(s)\n",
+                  via, (unsigned)r.written);
   }
 #endif
-  return written > 0;
+  return r.ok;
 }
 
 bool Config::persistRawJson(const char* json) {
@@ -125,7 +108,18 @@ bool Config::persistRawJson(const char* json) {
 #endif
     return false;
   }
-  return store_->write("cfg", json) > 0;
+  JsonDocument doc;
+  if (deserializeJson(doc, json)) return false;
+  // Decode into a fresh model, exactly as the next boot would have parsed
+  // the document, and store every section of it: a section the PUT omitted
+  // must come back at its default, not survive from before.
+  LampSettings l;
+  BaseSettings b;
+  ShadeSettings s;
+  ExpressionSettings e;
+  HomeModeSettings h;
+  config_codec::fromJson(doc.as<JsonObject>(), l, b, s, e, h);
+  return config_sections::persistAll(*store_, l, b, s, e, h, stored_).ok;
 }
 
 bool Config::factoryReset() { return store_ ? store_->clear() : false; }
@@ -312,8 +306,8 @@ String Config::asExpressionsJson() {
     exprNode["intervalMin"] = expr.intervalMin;
     exprNode["intervalMax"] = expr.intervalMax;
     exprNode["target"] = expr.target;
-    for (const auto& param : expr.parameters) {
-      exprNode[param.first] = param.second;
+    for (const ParamSet::Entry param : expr.parameters) {
+      exprNode[param.name()] = param.value;
     }
     JsonArray colorsNode = exprNode["colors"].to<JsonArray>();
     for (const auto& color : expr.colors) {
@@ -8,13 +8,15 @@
 
 #include <lampos/protocol/presence.hpp>
 
+#include "config_sections.hpp"
 #include "config_store.hpp"
 #include "config_types.hpp"
 #include "disposition_store.hpp"
 
 namespace lamp {
 
-// Runtime lamp configuration; persisted to NVS under the "cfg" key.
+// Runtime lamp configuration; persisted to NVS as one binary blob per
+// top-level section (config_sections.hpp, config_binary.hpp).
 class Config {
  private:
   ConfigStore* store_ = nullptr;
@@ -101,27 +103,31 @@ class Config {
   JsonDocument asJsonDocument();
 
   /**
-   * Persist the current in-memory config to NVS under the "cfg" key.
+   * Persist the current in-memory config to NVS, rewriting only the
+   * section keys whose content changed since the last write.
    *
    * Used by live-preview drains (e.g. expressionOp) that want their change
    * to survive a reboot WITHOUT going through the settings_blob path's
    * fade-out-and-reboot. The runtime state has already been applied by
-   * the caller; this just writes the canonical JSON to NVS.
+   * the caller; this just encodes the changed sections to NVS.
    *
-   * Returns true iff the store wrote > 0 bytes. On failure the in-memory
-   * state is unchanged; the next call may succeed.
+   * Returns true iff every changed section was written (true with nothing
+   * written when nothing changed). On failure the in-memory state is
+   * unchanged; the next call retries the sections that did not land.
+   * `sectionsWritten`, when non-null, receives the number of section keys
+   * rewritten.
    *
    * `via`: short tag like "commit" / "settings_blob" / "expressionOp"
    * included in the success log to disambiguate which path triggered the write.
    * Pass a constant string literal.
    */
-  bool persistConfig(const char* via);
+  bool persistConfig(const char* via, uint8_t* sectionsWritten = nullptr);
 
-  // Writes a caller-supplied whole-config JSON string straight to the NVS
-  // "cfg" blob (the webapp's whole-document PUT path; the constructor
-  // re-parses it on the next boot). Keeps the namespace/key contract here
+  // Decodes a caller-supplied whole-config JSON string and writes every
+  // section of it to NVS (the webapp's whole-document PUT path; the
+  // constructor loads it on the next boot). Keeps the namespace/key contract here
   // rather than letting callers open Preferences("lamp") themselves.
-  // Returns true iff the store wrote > 0 bytes.
+  // Returns true iff every section key was written.
   bool persistRawJson(const char* json);
 
   // Wipe persisted state (factory reset). Returns true on success. The caller
@@ -269,6 +275,7 @@ class Config {
   uint8_t lampOtaState_ = 0;
   bool lampHasOtaSendingTo_ = false;
   uint8_t lampOtaSendingTo_[6] = {0};
+  config_sections::StoredState stored_;
   bool loadFailedWithData_ = false;
   bool namedKeyPresent_ = false;
   bool lampSectionDirty_ = true;
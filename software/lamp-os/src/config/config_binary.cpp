@@ -0,0 +1,302 @@
+#include "config/config_binary.hpp"
+
+#include <string>
+#include <utility>
+
+namespace lamp {
+namespace config_binary {
+
+namespace {
+
+class Writer {
+ public:
+  Writer(Bytes& out, Section section) : out_(out) {
+    out_.clear();
+    u8(kSchemaVersion);
+    u8(static_cast<uint8_t>(section));
+  }
+
+  void u8(uint8_t v) { out_.push_back(v); }
+  void u16(uint16_t v) {
+    out_.push_back(static_cast<uint8_t>(v));
+    out_.push_back(static_cast<uint8_t>(v >> 8));
+  }
+  void u32(uint32_t v) {
+    for (int i = 0; i < 4; i++) out_.push_back(static_cast<uint8_t>(v >> (8 * i)));
+  }
+  void flag(bool v) { u8(v ? 1 : 0); }
+  void str(const std::string& s) {
+    const size_t n = s.size() > 0xFFFF ? 0xFFFF : s.size();
+    u16(static_cast<uint16_t>(n));
+    out_.insert(out_.end(), s.begin(), s.begin() + n);
+  }
+  void count(size_t n) { u16(static_cast<uint16_t>(n > 0xFFFF ? 0xFFFF : n)); }
+  void color(const Color& c) {
+    u8(c.r);
+    u8(c.g);
+    u8(c.b);
+    u8(c.w);
+  }
+  void colors(const std::vector<Color>& cs) {
+    count(cs.size());
+    for (size_t i = 0; i < cs.size() && i < 0xFFFF; i++) color(cs[i]);
+  }
+
+ private:
+  Bytes& out_;
+};
+
+// Bounds-checked cursor. Any short read latches !ok() and yields zeros, so
+// decoders read straight through and check once at the end.
+class Reader {
+ public:
+  Reader(const uint8_t* data, size_t len) : p_(data), end_(data + len) {}
+
+  bool header(Section section) {
+    return u8() == kSchemaVersion && u8() == static_cast<uint8_t>(section) && ok_;
+  }
+
+  uint8_t u8() {
+    if (!need(1)) return 0;
+    return *p_++;
+  }
+  uint16_t u16() {
+    if (!need(2)) return 0;
+    const uint16_t v = static_cast<uint16_t>(p_[0] | (p_[1] << 8));
+    p_ += 2;
+    return v;
+  }
+  uint32_t u32() {
+    if (!need(4)) return 0;
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= static_cast<uint32_t>(p_[i]) << (8 * i);
+    p_ += 4;
+    return v;
+  }
+  bool flag() { return u8() != 0; }
+  std::string str() {
+    const uint16_t n = u16();
+    if (!need(n)) return std::string();
+    std::string s(reinterpret_cast<const char*>(p_), n);
+    p_ += n;
+    return s;
+  }
+  // A count whose items (at least `minItemBytes` each) can't fit in what is
+  // left is corrupt; latching here keeps a garbage count from reserving a
+  // huge vector before the item reads would fail anyway.
+  uint16_t count(size_t minItemBytes) {
+    const uint16_t n = u16();
+    if (ok_ && static_cast<size_t>(end_ - p_) < n * minItemBytes) ok_ = false;
+    return ok_ ? n : 0;
+  }
+  Color color() {
+    const uint8_t r = u8(), g = u8(), b = u8(), w = u8();
+    return Color(r, g, b, w);
+  }
+  void colors(std::vector<Color>& out) {
+    const uint16_t n = count(4);
+    out.clear();
+    out.reserve(n);
+    for (uint16_t i = 0; i < n; i++) out.push_back(color());
+  }
+
+  // Everything read and nothing left over.
+  bool done() const { return ok_ && p_ == end_; }
+
+ private:
+  bool need(size_t n) {
+    if (ok_ && static_cast<size_t>(end_ - p_) >= n) return true;
+    ok_ = false;
+    return false;
+  }
+
+  const uint8_t* p_;
+  const uint8_t* end_;
+  bool ok_ = true;
+};
+
+void writeSegments(Writer& w, const std::vector<SegmentSettings>& segs) {
+  w.count(segs.size());
+  for (const auto& s : segs) {
+    w.str(s.name);
+    w.u8(s.px);
+    w.colors(s.colors);
+  }
+}
+
+// Same invariants parseSegments() leaves: ≥1 segment, ≥1 color each, Σpx
+// clamped.
+void readSegments(Reader& r, std::vector<SegmentSettings>& segs,
+                  const Color& fallback, const char* roleName) {
+  const uint16_t n = r.count(4);
+  segs.clear();
+  segs.reserve(n);
+  for (uint16_t i = 0; i < n; i++) {
+    SegmentSettings seg;
+    seg.name = r.str();
+    seg.px = r.u8();
+    r.colors(seg.colors);
+    if (seg.colors.empty()) seg.colors.push_back(fallback);
+    segs.push_back(std::move(seg));
+  }
+  if (segs.empty()) segs.push_back({roleName, 0, {fallback}});
+  clampSegmentsSumPx(segs);
+}
+
+}  // namespace
+
+void encode(const LampSettings& lamp, Bytes& out) {
+  Writer w(out, Section::Lamp);
+  w.str(lamp.name);
+  w.u8(lamp.brightness);
+  w.str(lamp.password);
+  w.flag(lamp.setup);
+  w.flag(lamp.named);
+  w.flag(lamp.advancedEnabled);
+  w.flag(lamp.webappEnabled);
+  w.u8(lamp.apBootMinutes);
+  w.u8(lamp.brightnessCeiling);
+  w.u8(static_cast<uint8_t>(lamp.socialMode));
+}
+
+void encode(const BaseSettings& base, Bytes& out) {
+  Writer w(out, Section::Base);
+  w.str(base.byteOrder);
+  writeSegments(w, base.segments);
+  w.count(base.knockoutPixels.size());
+  for (uint8_t v : base.knockoutPixels) w.u8(v);
+}
+
+void encode(const ShadeSettings& shade, Bytes& out) {
+  Writer w(out, Section::Shade);
+  w.str(shade.byteOrder);
+  writeSegments(w, shade.segments);
+}
+
+void encode(const ExpressionSettings& expressions, Bytes& out) {
+  Writer w(out, Section::Expressions);
+  w.count(expressions.expressions.size());
+  for (const auto& e : expressions.expressions) {
+    w.str(e.type);
+    w.flag(e.enabled);
+    w.u32(e.intervalMin);
+    w.u32(e.intervalMax);
+    w.u8(e.target);
+    w.u8(static_cast<uint8_t>(e.parameters.size()));
+    for (const ParamSet::Entry p : e.parameters) {
+      w.str(p.name());
+      w.u32(p.value);
+    }
+    w.colors(e.colors);
+  }
+}
+
+void encode(const HomeModeSettings& homeMode, Bytes& out) {
+  Writer w(out, Section::HomeMode);
+  w.str(homeMode.ssid);
+  w.u8(homeMode.brightness);
+  w.flag(homeMode.enabled);
+  w.flag(homeMode.networkBound);
+  w.flag(homeMode.socialDisabled);
+  w.count(homeMode.disabledExpressionTypes.size());
+  for (const auto& t : homeMode.disabledExpressionTypes) w.str(t);
+}
+
+bool decode(const uint8_t* data, size_t len, LampSettings& out) {
+  Reader r(data, len);
+  if (!r.header(Section::Lamp)) return false;
+  LampSettings v;
+  v.name = r.str();
+  v.brightness = r.u8();
+  v.password = r.str();
+  v.setup = r.flag();
+  v.named = r.flag();
+  v.advancedEnabled = r.flag();
+  v.webappEnabled = r.flag();
+  v.apBootMinutes = r.u8();
+  v.brightnessCeiling = r.u8();
+  uint8_t modeRaw = r.u8();
+  if (modeRaw > 2) modeRaw = 1;
+  v.socialMode = static_cast<SocialMode>(modeRaw);
+  if (!r.done()) return false;
+  // lampType is loaded from its own key; keep whatever the caller holds.
+  v.lampType = std::move(out.lampType);
+  out = std::move(v);
+  return true;
+}
+
+bool decode(const uint8_t* data, size_t len, BaseSettings& out) {
+  Reader r(data, len);
+  if (!r.header(Section::Base)) return false;
+  BaseSettings v;
+  v.byteOrder = r.str();
+  readSegments(r, v.segments, kBaseDefaultColor, "Base");
+  const uint16_t n = r.count(1);
+  v.knockoutPixels.assign(n, 100);
+  for (uint16_t i = 0; i < n; i++) v.knockoutPixels[i] = r.u8();
+  if (!r.done()) return false;
+  v.knockoutPixels.resize(v.sumPx(), 100);
+  v.colorsEditable = out.colorsEditable;
+  out = std::move(v);
+  return true;
+}
+
+bool decode(const uint8_t* data, size_t len, ShadeSettings& out) {
+  Reader r(data, len);
+  if (!r.header(Section::Shade)) return false;
+  ShadeSettings v;
+  v.byteOrder = r.str();
+  readSegments(r, v.segments, kShadeDefaultColor, "Shade");
+  if (!r.done()) return false;
+  v.colorsEditable = out.colorsEditable;
+  out = std::move(v);
+  return true;
+}
+
+bool decode(const uint8_t* data, size_t len, ExpressionSettings& out) {
+  Reader r(data, len);
+  if (!r.header(Section::Expressions)) return false;
+  ExpressionSettings v;
+  const uint16_t n = r.count(15);
+  v.expressions.reserve(n);
+  for (uint16_t i = 0; i < n; i++) {
+    ExpressionConfig e;
+    e.type = r.str();
+    e.enabled = r.flag();
+    e.intervalMin = r.u32();
+    e.intervalMax = r.u32();
+    e.target = r.u8();
+    const uint8_t params = r.u8();
+    for (uint8_t k = 0; k < params; k++) {
+      const std::string name = r.str();
+      const uint32_t value = r.u32();
+      // A key this firmware doesn't know is dropped, as fromJson() does.
+      e.setParameter(name.c_str(), value);
+    }
+    r.colors(e.colors);
+    v.expressions.push_back(std::move(e));
+  }
+  if (!r.done()) return false;
+  out = std::move(v);
+  return true;
+}
+
+bool decode(const uint8_t* data, size_t len, HomeModeSettings& out) {
+  Reader r(data, len);
+  if (!r.header(Section::HomeMode)) return false;
+  HomeModeSettings v;
+  v.ssid = r.str();
+  v.brightness = r.u8();
+  v.enabled = r.flag();
+  v.networkBound = r.flag();
+  v.socialDisabled = r.flag();
+  const uint16_t n = r.count(2);
+  v.disabledExpressionTypes.clear();
+  for (uint16_t i = 0; i < n; i++) v.disabledExpressionTypes.push_back(r.str());
+  if (!r.done()) return false;
+  out = std::move(v);
+  return true;
+}
+
+}  // namespace config_binary
+}  // namespace lamp
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "config_types.hpp"
+
+// Packed binary codec for the persisted config sections. NVS holds one blob
+// per section (config_sections.hpp); boot decodes them straight into the
+// model structs and a commit encodes straight from them, so JSON is left to
+// the edges that speak it (BLE section reads, the webapp, settings_blob).
+// Pure functions over the model structs, round-trip tested against the
+// config_codec fixtures in test/test_config_binary.
+//
+// Blob layout: [schema version u8][section id u8][payload]. Integers are
+// little-endian; strings are u16 length + bytes; lists are u16 count + items;
+// a Color is r,g,b,w. Expression parameters are stored by name, not by
+// ParamKey index, so adding a key to kParamKeyNames never reshuffles what an
+// older blob means. Fields firmware owns outside the sections (lampType,
+// colorsEditable) are not stored, matching toJson().
+namespace lamp {
+namespace config_binary {
+
+// Bump when a payload's shape changes; decode() then reads older versions
+// through a per-version branch instead of rejecting them.
+constexpr uint8_t kSchemaVersion = 1;
+
+enum class Section : uint8_t {
+  Lamp = 0,
+  Base = 1,
+  Shade = 2,
+  Expressions = 3,
+  HomeMode = 4,
+};
+
+using Bytes = std::vector<uint8_t>;
+
+// Replace `out` with the section's blob.
+void encode(const LampSettings& lamp, Bytes& out);
+void encode(const BaseSettings& base, Bytes& out);
+void encode(const ShadeSettings& shade, Bytes& out);
+void encode(const ExpressionSettings& expressions, Bytes& out);
+void encode(const HomeModeSettings& homeMode, Bytes& out);
+
+// Decode a section blob. Returns false — leaving `out` untouched — on a
+// version or section-id mismatch, truncation, or trailing bytes. Applies the
+// same clamps fromJson() does (socialMode range, Σpx ≤ 255, ≥1 color per
+// segment, knockout sized to the base's pixel count).
+bool decode(const uint8_t* data, size_t len, LampSettings& out);
+bool decode(const uint8_t* data, size_t len, BaseSettings& out);
+bool decode(const uint8_t* data, size_t len, ShadeSettings& out);
+bool decode(const uint8_t* data, size_t len, ExpressionSettings& out);
+bool decode(const uint8_t* data, size_t len, HomeModeSettings& out);
+
+}  // namespace config_binary
+}  // namespace lamp
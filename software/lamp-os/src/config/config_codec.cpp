@@ -42,18 +42,6 @@ static void parseSegments(JsonObject node, std::vector<SegmentSettings>& segs,
   if (segs.empty()) segs.push_back({roleName, 0, {fallback}});
 }
 
-// Σ segment px ≤ 255 (uint8 pixelCount + boot buffer sizing). This is the one
-// boundary every NVS load crosses (settings-blob apply AND webapp raw-persist
-// both re-parse here on boot), so clamp the running sum: a garbage oversized
-// blob can't blow the boot buffer.
-static void clampSumPx(std::vector<SegmentSettings>& segs) {
-  unsigned budget = 255;
-  for (auto& s : segs) {
-    if (s.px > budget) s.px = static_cast<uint8_t>(budget);
-    budget -= s.px;
-  }
-}
-
 static void writeSegments(JsonObject node,
                           const std::vector<SegmentSettings>& segs) {
   JsonArray arr = node["segments"].to<JsonArray>();
@@ -97,7 +85,7 @@ void fromJson(JsonObject root, LampSettings& lamp, BaseSettings& base,
   JsonObject baseNode = root["base"];
   base.byteOrder = std::string(baseNode["byteOrder"] | "");
   parseSegments(baseNode, base.segments, kBaseDefaultColor, "Base");
-  clampSumPx(base.segments);
+  clampSegmentsSumPx(base.segments);
   // Keep knockoutPixels in sync with the active pixel count. Drops stale
   // entries when px shrinks and 100-fills ("no knockout") any slots when px
   // grows. The input loop below then overwrites slots 0..sumPx-1 from JSON.
@@ -116,7 +104,7 @@ void fromJson(JsonObject root, LampSettings& lamp, BaseSettings& base,
   JsonObject shadeNode = root["shade"];
   shade.byteOrder = std::string(shadeNode["byteOrder"] | "");
   parseSegments(shadeNode, shade.segments, kShadeDefaultColor, "Shade");
-  clampSumPx(shade.segments);
+  clampSegmentsSumPx(shade.segments);
   // colorsEditable is firmware-owned (set by Lamp subclass defaults via
   // applyDefaults). Inbound writes intentionally do not update it.
 
@@ -149,9 +137,9 @@ void fromJson(JsonObject root, LampSettings& lamp, BaseSettings& base,
         // Store the parameter value
         JsonVariant value = kv.value();
         if (value.is<uint32_t>()) {
-          expr.setParameter(keyStr, value.as<uint32_t>());
+          expr.setParameter(key, value.as<uint32_t>());
         } else if (value.is<int>()) {
-          expr.setParameter(keyStr, static_cast<uint32_t>(value.as<int>()));
+          expr.setParameter(key, static_cast<uint32_t>(value.as<int>()));
         }
       }
 
@@ -232,10 +220,8 @@ void toJson(JsonObject root, const LampSettings& lamp, const BaseSettings& base,
     exprNode["target"] = expr.target;
     // disabledDuringWispOverride is a pure type-property, not persisted.
     // Serialize generic parameters
-    for (const auto& param : expr.parameters) {
-      const std::string& key = param.first;
-      const uint32_t& value = param.second;
-      exprNode[key] = value;
+    for (const ParamSet::Entry param : expr.parameters) {
+      exprNode[param.name()] = param.value;
     }
 
     JsonArray colorsNode = exprNode["colors"].to<JsonArray>();
@@ -0,0 +1,365 @@
+#include "config/config_sections.hpp"
+
+#include <ArduinoJson.h>
+
+#include <algorithm>
+#include <iterator>
+#include <new>
+#include <string>
+#include <utility>
+
+#include "config/config_binary.hpp"
+#include "config/config_codec.hpp"
+
+namespace lamp {
+namespace config_sections {
+
+namespace {
+
+// The five sections, indexable by position (config_binary::Section order).
+template <typename L, typename B, typename S, typename E, typename H>
+struct Model {
+  L& lamp;
+  B& base;
+  S& shade;
+  E& expressions;
+  H& homeMode;
+};
+using MutModel = Model<LampSettings, BaseSettings, ShadeSettings,
+                       ExpressionSettings, HomeModeSettings>;
+using ConstModel = Model<const LampSettings, const BaseSettings,
+                         const ShadeSettings, const ExpressionSettings,
+                         const HomeModeSettings>;
+
+bool decodeSection(size_t i, const config_binary::Bytes& blob, MutModel m) {
+  const uint8_t* p = blob.data();
+  const size_t n = blob.size();
+  switch (i) {
+    case 0: return config_binary::decode(p, n, m.lamp);
+    case 1: return config_binary::decode(p, n, m.base);
+    case 2: return config_binary::decode(p, n, m.shade);
+    case 3: return config_binary::decode(p, n, m.expressions);
+    default: return config_binary::decode(p, n, m.homeMode);
+  }
+}
+
+void encodeSection(size_t i, ConstModel m, config_binary::Bytes& out) {
+  switch (i) {
+    case 0: config_binary::encode(m.lamp, out); break;
+    case 1: config_binary::encode(m.base, out); break;
+    case 2: config_binary::encode(m.shade, out); break;
+    case 3: config_binary::encode(m.expressions, out); break;
+    default: config_binary::encode(m.homeMode, out); break;
+  }
+}
+
+void moveSection(size_t i, MutModel from, MutModel to) {
+  switch (i) {
+    case 0: to.lamp = std::move(from.lamp); break;
+    case 1: to.base = std::move(from.base); break;
+    case 2: to.shade = std::move(from.shade); break;
+    case 3: to.expressions = std::move(from.expressions); break;
+    default: to.homeMode = std::move(from.homeMode); break;
+  }
+}
+
+// Gather the sections without a blob from the JSON layouts into `root`.
+// Per-section JSON keys win over the legacy document.
+bool readJson(ConfigStore& store, const bool (&fromBinary)[kCount],
+              const bool (&corrupt)[kCount], JsonObject root, LoadResult& r,
+              StoredState& state) {
+  JsonDocument legacy;
+  bool legacyRead = false;
+  for (size_t i = 0; i < kCount; i++) {
+    if (fromBinary[i]) continue;
+    const std::string s = store.read(kJsonKeys[i], "");
+    if (!s.empty()) {
+      state.jsonPresent = true;
+      r.hadData = true;
+      r.bytes += s.size();
+      JsonDocument part;
+      const DeserializationError err = deserializeJson(part, s);
+      if (err) {
+        r.error = err.c_str();
+        return false;
+      }
+      if (!part.isNull()) root[kNames[i]] = part.as<JsonVariantConst>();
+      r.fromJson++;
+      continue;
+    }
+    if (!legacyRead) {
+      legacyRead = true;
+      const std::string blob = store.read(kLegacyKey, "{}");
+      if (configBlobHasData(blob)) {
+        state.jsonPresent = true;
+        r.hadData = true;
+        r.bytes += blob.size();
+        const DeserializationError err = deserializeJson(legacy, blob);
+        if (err) {
+          r.error = err.c_str();
+          return false;
+        }
+      }
+    }
+    JsonVariantConst v = legacy[kNames[i]];
+    if (!v.isNull()) {
+      root[kNames[i]] = v;
+      r.fromJson++;
+    } else if (corrupt[i]) {
+      r.error = "corrupt section blob";
+      return false;
+    }
+  }
+  return true;
+}
+
+// Split a journal into its section blobs. False, with `out` unspecified, on
+// a malformed journal.
+bool parseJournal(const config_binary::Bytes& j, config_binary::Bytes (&out)[kCount],
+                  bool (&has)[kCount]) {
+  if (j.empty()) return false;
+  size_t off = 1;
+  for (size_t k = 0; k < j[0]; k++) {
+    if (off + 2 > j.size()) return false;
+    const size_t len = j[off] | (static_cast<size_t>(j[off + 1]) << 8);
+    off += 2;
+    if (len < 2 || off + len > j.size() || j[off + 1] >= kCount) return false;
+    out[j[off + 1]].assign(j.begin() + off, j.begin() + off + len);
+    has[j[off + 1]] = true;
+    off += len;
+  }
+  return off == j.size();
+}
+
+void appendJournal(const config_binary::Bytes& blob, config_binary::Bytes& j) {
+  j[0]++;
+  j.push_back(static_cast<uint8_t>(blob.size() & 0xFF));
+  j.push_back(static_cast<uint8_t>(blob.size() >> 8));
+  j.insert(j.end(), blob.begin(), blob.end());
+}
+
+// Rewrite "cfg" from the model and fingerprint it. False if either write
+// failed or the document didn't fit in memory.
+bool writeMirror(ConfigStore& store, ConstModel m) {
+  std::string json;
+  try {
+    JsonDocument doc;
+    config_codec::toJson(doc.to<JsonObject>(), m.lamp, m.base, m.shade,
+                         m.expressions, m.homeMode);
+    if (doc.overflowed()) return false;
+    serializeJson(doc, json);
+  } catch (const std::bad_alloc&) {
+    return false;
+  }
+  if (store.write(kLegacyKey, json.c_str()) == 0) return false;
+  const uint32_t h =
+      hashBytes(reinterpret_cast<const uint8_t*>(json.data()), json.size());
+  const uint8_t fp[4] = {static_cast<uint8_t>(h), static_cast<uint8_t>(h >> 8),
+                         static_cast<uint8_t>(h >> 16),
+                         static_cast<uint8_t>(h >> 24)};
+  return store.writeBytes(kMirrorKey, fp, sizeof(fp)) != 0;
+}
+
+// True when a fingerprint is stored and "cfg" no longer matches it: older
+// firmware saved the document after this image last mirrored it. Sets
+// `fingerprinted` when a fingerprint is stored at all.
+bool legacyEditedSinceMirror(ConfigStore& store, bool& fingerprinted) {
+  config_binary::Bytes fp;
+  fingerprinted = store.readBytes(kMirrorKey, fp) && fp.size() == 4;
+  if (!fingerprinted) return false;
+  const uint32_t want = fp[0] | (static_cast<uint32_t>(fp[1]) << 8) |
+                        (static_cast<uint32_t>(fp[2]) << 16) |
+                        (static_cast<uint32_t>(fp[3]) << 24);
+  const std::string json = store.read(kLegacyKey, "");
+  return configBlobHasData(json) &&
+         hashBytes(reinterpret_cast<const uint8_t*>(json.data()),
+                   json.size()) != want;
+}
+
+PersistResult persistSections(ConfigStore& store, ConstModel m,
+                              StoredState& state, bool all) {
+  PersistResult r;
+  config_binary::Bytes blobs[kCount];
+  uint32_t hashes[kCount] = {};
+  bool changed[kCount] = {};
+  size_t changedCount = 0;
+  try {
+    for (size_t i = 0; i < kCount; i++) {
+      encodeSection(i, m, blobs[i]);
+      hashes[i] = hashBytes(blobs[i].data(), blobs[i].size());
+      changed[i] = all || hashes[i] != state.hashes[i];
+      changedCount += changed[i];
+    }
+  } catch (const std::bad_alloc&) {
+    r.ok = false;
+    return r;
+  }
+
+  // Several sections move together, or a journal an earlier commit left
+  // behind still names sections: this write supersedes it either way.
+  if (changedCount > 1 || (changedCount == 1 && state.journalPresent)) {
+    try {
+      config_binary::Bytes journal(1, 0);
+      for (size_t i = 0; i < kCount; i++) {
+        if (changed[i]) appendJournal(blobs[i], journal);
+      }
+      if (store.writeBytes(kJournalKey, journal.data(), journal.size()) == 0) {
+        r.ok = false;
+        return r;
+      }
+    } catch (const std::bad_alloc&) {
+      r.ok = false;
+      return r;
+    }
+    state.journalPresent = true;
+  }
+  for (size_t i = 0; i < kCount; i++) {
+    if (!changed[i]) continue;
+    if (store.writeBytes(kKeys[i], blobs[i].data(), blobs[i].size()) == 0) {
+      r.ok = false;
+      continue;
+    }
+    state.hashes[i] = hashes[i];
+    r.written++;
+  }
+  // A section write that failed keeps the journal, so a reboot still lands it.
+  if (r.ok && state.journalPresent && store.remove(kJournalKey)) {
+    state.journalPresent = false;
+  }
+  // "cfg" is all a rolled-back or downgraded image can read: keep it in step
+  // with the blobs. A commit that fails part way mirrors on its retry.
+  if (changedCount > 0) state.mirrorStale = true;
+  if (r.ok && state.mirrorStale) {
+    state.mirrorStale = !writeMirror(store, m);
+    r.ok = !state.mirrorStale;
+  }
+  if (r.ok && state.jsonPresent) {
+    bool removed = true;
+    for (size_t i = 0; i < kCount; i++) removed = store.remove(kJsonKeys[i]) && removed;
+    if (removed) state.jsonPresent = false;
+  }
+  return r;
+}
+
+}  // namespace
+
+uint32_t hashBytes(const uint8_t* data, size_t len) {
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < len; i++) h = (h ^ data[i]) * 16777619u;
+  return h;
+}
+
+LoadResult load(ConfigStore& store, LampSettings& lamp, BaseSettings& base,
+                ShadeSettings& shade, ExpressionSettings& expressions,
+                HomeModeSettings& homeMode, StoredState& state) {
+  LoadResult r;
+  state = StoredState{};
+  const MutModel out{lamp, base, shade, expressions, homeMode};
+
+  // Decode into copies so a failure leaves the model untouched. Copies, not
+  // defaults: decode() keeps the fields it doesn't store (lampType,
+  // colorsEditable).
+  LampSettings l = lamp;
+  BaseSettings b = base;
+  ShadeSettings s = shade;
+  ExpressionSettings e = expressions;
+  HomeModeSettings h = homeMode;
+  const MutModel decoded{l, b, s, e, h};
+
+  // A "cfg" edited by older firmware after a rollback or downgrade is newer
+  // than every blob and any journal: load it whole, and the next persist
+  // rewrites the blobs from it.
+  bool fingerprinted = false;
+  r.legacyNewer = legacyEditedSinceMirror(store, fingerprinted);
+  if (r.legacyNewer) {
+    state.mirrorStale = true;
+    state.journalPresent = !store.remove(kJournalKey);
+  }
+
+  // A journal means a multi-section commit may have stopped part way: its
+  // blobs win over the section keys, which are rewritten from it.
+  config_binary::Bytes journal;
+  config_binary::Bytes journaled[kCount];
+  bool inJournal[kCount] = {};
+  bool replayFailed[kCount] = {};
+  if (!r.legacyNewer && store.readBytes(kJournalKey, journal)) {
+    if (parseJournal(journal, journaled, inJournal)) {
+      for (size_t i = 0; i < kCount; i++) {
+        if (!inJournal[i]) continue;
+        replayFailed[i] = store.writeBytes(kKeys[i], journaled[i].data(),
+                                           journaled[i].size()) == 0;
+        r.replayed++;
+      }
+    } else {
+      std::fill(std::begin(inJournal), std::end(inJournal), false);
+    }
+    bool landed = true;
+    for (bool failed : replayFailed) landed = landed && !failed;
+    state.journalPresent = !(landed && store.remove(kJournalKey));
+  }
+
+  bool fromBinary[kCount] = {};
+  bool corrupt[kCount] = {};
+  bool anyMissing = false;
+  config_binary::Bytes blob;
+  for (size_t i = 0; i < kCount && !r.legacyNewer; i++) {
+    bool stored = inJournal[i];
+    if (stored) {
+      blob.swap(journaled[i]);
+    } else {
+      stored = store.readBytes(kKeys[i], blob);
+    }
+    if (stored) {
+      // Blobs from before the mirror existed: "cfg" lags them.
+      state.mirrorStale |= !fingerprinted;
+      r.hadData = true;
+      r.bytes += blob.size();
+      fromBinary[i] = decodeSection(i, blob, decoded);
+      corrupt[i] = !fromBinary[i];
+      // A blob that didn't decode, or a journaled one that didn't reach its
+      // key, stays hash 0 so the next persist rewrites it.
+      if (fromBinary[i] && !replayFailed[i]) {
+        state.hashes[i] = hashBytes(blob.data(), blob.size());
+      }
+    }
+    anyMissing |= !fromBinary[i];
+  }
+  anyMissing |= r.legacyNewer;
+
+  if (anyMissing) {
+    JsonDocument doc;
+    JsonObject root = doc.to<JsonObject>();
+    if (!readJson(store, fromBinary, corrupt, root, r, state)) {
+      r.ok = false;
+      return r;
+    }
+    // Sections absent from `root` come out at their defaults; the decoded
+    // ones are moved over them below.
+    config_codec::fromJson(root, lamp, base, shade, expressions, homeMode);
+    r.namedKeyPresent = root["lamp"]["named"].is<bool>();
+  }
+  for (size_t i = 0; i < kCount; i++) {
+    if (fromBinary[i]) moveSection(i, decoded, out);
+  }
+  if (fromBinary[0]) r.namedKeyPresent = true;
+  return r;
+}
+
+PersistResult persist(ConfigStore& store, const LampSettings& lamp,
+                      const BaseSettings& base, const ShadeSettings& shade,
+                      const ExpressionSettings& expressions,
+                      const HomeModeSettings& homeMode, StoredState& state) {
+  return persistSections(store, {lamp, base, shade, expressions, homeMode},
+                         state, false);
+}
+
+PersistResult persistAll(ConfigStore& store, const LampSettings& lamp,
+                         const BaseSettings& base, const ShadeSettings& shade,
+                         const ExpressionSettings& expressions,
+                         const HomeModeSettings& homeMode, StoredState& state) {
+  return persistSections(store, {lamp, base, shade, expressions, homeMode},
+                         state, true);
+}
+
+}  // namespace config_sections
+}  // namespace lamp
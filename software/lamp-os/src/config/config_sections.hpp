@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "config/config_store.hpp"
+#include "config/config_types.hpp"
+
+// Per-section persistence for the config model. Each of the five top-level
+// sections lives under its own NVS key as a config_binary blob, so boot
+// decodes straight into the model structs and a commit rewrites only the
+// sections whose encoded bytes changed.
+//
+// Two older JSON layouts are still read for any section that has no binary
+// blob: the per-section JSON keys, then the single "cfg" document. The first
+// persist that lands every section in binary removes the per-section keys but
+// never "cfg": older firmware reads only that key, so every commit that
+// changes a section rewrites it from the model and stores its fingerprint,
+// and an OTA rollback or a USB downgrade boots with current settings. Older
+// firmware rewrites "cfg" without the fingerprint; a load that finds the two
+// disagree takes "cfg" as the newer copy over every blob, so edits made while
+// downgraded survive the re-upgrade.
+//
+// A commit that changes more than one section first writes every changed
+// blob to one journal key, then the section keys, then removes the journal.
+// A single NVS write is atomic, so the journal is the commit point: a power
+// cut before it lands leaves the old sections, and load() rolls a journal it
+// finds forward over the section keys, so a cut between the section writes
+// can't boot a mix of old and new sections. Pure functions over a
+// ConfigStore, so the whole contract runs in the native suite
+// (test/test_config_sections).
+namespace lamp {
+namespace config_sections {
+
+constexpr size_t kCount = 5;
+
+// toJson() member names, then each section's keys (NVS keys are capped at 15
+// chars). Index order matches config_binary::Section.
+constexpr const char* kNames[kCount] = {"lamp", "base", "shade", "expressions",
+                                        "homeMode"};
+constexpr const char* kKeys[kCount] = {"cfgb.lamp", "cfgb.base", "cfgb.shade",
+                                       "cfgb.expr", "cfgb.home"};
+constexpr const char* kJsonKeys[kCount] = {"cfg.lamp", "cfg.base", "cfg.shade",
+                                           "cfg.expr", "cfg.home"};
+constexpr const char* kLegacyKey = "cfg";
+// [count u8] then count x [len u16 LE][section blob]; each blob names its
+// section in its own header.
+constexpr const char* kJournalKey = "cfgb.jrnl";
+// hashBytes() of the "cfg" document the last commit mirrored, u32 LE.
+constexpr const char* kMirrorKey = "cfgb.mirr";
+
+// FNV-1a over a stored blob.
+uint32_t hashBytes(const uint8_t* data, size_t len);
+
+using Hashes = std::array<uint32_t, kCount>;
+
+// What NVS holds, as far as persist() needs to know. Owned by Config; filled
+// by load(), kept current by persist() / persistAll().
+struct StoredState {
+  Hashes hashes{};             // 0 = no usable blob stored
+  bool jsonPresent = false;     // an older JSON layout still carries data
+  bool journalPresent = false;  // a journal may still be stored
+  bool mirrorStale = false;     // "cfg" doesn't match the blobs
+};
+
+struct LoadResult {
+  bool ok = true;
+  const char* error = "";        // why !ok, for the debug log
+  bool hadData = false;          // something was stored (not a true first boot)
+  size_t bytes = 0;              // stored bytes read
+  uint8_t fromJson = 0;          // sections migrated from a JSON layout
+  uint8_t replayed = 0;          // sections rolled forward from a journal
+  bool legacyNewer = false;      // "cfg" was edited by older firmware
+  bool namedKeyPresent = false;  // see Config::namedKeyPresent()
+};
+
+// Load every section into the model, first rolling forward a journal left
+// by an interrupted persist. A section with no blob, or every section when
+// "cfg" no longer matches its fingerprint, comes from the JSON layouts, through config_codec::fromJson; one stored nowhere keeps its
+// class default. On failure (a corrupt blob with no JSON copy, or unparsable
+// JSON) the model is left untouched and the caller serves defaults.
+LoadResult load(ConfigStore& store, LampSettings& lamp, BaseSettings& base,
+                ShadeSettings& shade, ExpressionSettings& expressions,
+                HomeModeSettings& homeMode, StoredState& state);
+
+struct PersistResult {
+  bool ok = true;       // every changed section was written
+  uint8_t written = 0;  // section keys rewritten
+};
+
+// Encode each section and rewrite the keys whose bytes differ from `state`
+// (through the journal when more than one does) and mirror "cfg", then
+// remove the per-section JSON keys once every section is in binary. A failed
+// write (store full, OOM encoding) leaves that section's stored hash
+// unchanged, so the next call retries it; a failed journal write leaves every
+// section unwritten; a failed mirror is retried by the next call.
+PersistResult persist(ConfigStore& store, const LampSettings& lamp,
+                      const BaseSettings& base, const ShadeSettings& shade,
+                      const ExpressionSettings& expressions,
+                      const HomeModeSettings& homeMode, StoredState& state);
+
+// persist() with every section treated as changed (the whole-document write
+// path).
+PersistResult persistAll(ConfigStore& store, const LampSettings& lamp,
+                         const BaseSettings& base, const ShadeSettings& shade,
+                         const ExpressionSettings& expressions,
+                         const HomeModeSettings& homeMode, StoredState& state);
+
+}  // namespace config_sections
+}  // namespace lamp
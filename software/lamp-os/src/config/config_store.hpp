@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace lamp {
 
@@ -11,13 +13,19 @@ namespace lamp {
 //
 // Reads return defaultValue when the key is absent or the backing is
 // unavailable. write() returns bytes stored (0 = nothing written, e.g. the
-// backing couldn't be opened). All access is single-writer on Core 1 (NVS is
+// backing couldn't be opened). The Bytes pair is the same contract for
+// binary values (config_binary section blobs); readBytes() returns false
+// for an absent key. All access is single-writer on Core 1 (NVS is
 // not Core-0-safe); the seam adds no locking of its own.
 class ConfigStore {
  public:
   virtual ~ConfigStore() = default;
   virtual std::string read(const char* key, const char* defaultValue) = 0;
   virtual size_t write(const char* key, const char* value) = 0;
+  virtual bool readBytes(const char* key, std::vector<uint8_t>& out) = 0;
+  virtual size_t writeBytes(const char* key, const uint8_t* data, size_t len) = 0;
+  // Drop one key. True when it is absent afterwards.
+  virtual bool remove(const char* key) = 0;
   // Wipe the whole namespace (factory reset). Returns true on success.
   virtual bool clear() = 0;
 };
@@ -35,6 +43,20 @@ class InMemoryConfigStore : public ConfigStore {
     map_[key] = value;
     return map_[key].size();
   }
+  bool readBytes(const char* key, std::vector<uint8_t>& out) override {
+    auto it = map_.find(key);
+    if (it == map_.end()) return false;
+    out.assign(it->second.begin(), it->second.end());
+    return true;
+  }
+  size_t writeBytes(const char* key, const uint8_t* data, size_t len) override {
+    map_[key].assign(reinterpret_cast<const char*>(data), len);
+    return len;
+  }
+  bool remove(const char* key) override {
+    map_.erase(key);
+    return true;
+  }
   bool clear() override {
     map_.clear();
     return true;
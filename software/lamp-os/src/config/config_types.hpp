@@ -1,11 +1,11 @@
 #pragma once
 
 #include <cstdint>
-#include <map>
 #include <string>
 #include <variant>
 #include <vector>
 
+#include "expressions/param_set.hpp"
 #include "util/color.hpp"
 
 namespace lamp {
@@ -130,6 +130,17 @@ class BaseSettings {
   const std::vector<Color>& broadcastColors() const { return segments.front().colors; }
 };
 
+// Σ segment px ≤ 255 (uint8 pixelCount + boot buffer sizing). Every NVS load
+// crosses this (config_codec::fromJson, config_binary::decode), so clamp the
+// running sum: a garbage oversized payload can't blow the boot buffer.
+inline void clampSegmentsSumPx(std::vector<SegmentSettings>& segments) {
+  unsigned budget = 255;
+  for (auto& s : segments) {
+    if (s.px > budget) s.px = static_cast<uint8_t>(budget);
+    budget -= s.px;
+  }
+}
+
 // Resolve a loaded pixel count against a variant default. A persisted px
 // of 0 means the field was absent from NVS (the loader parses a missing
 // "px" key to 0), i.e. a fresh lamp: fill from the variant default. Any
@@ -181,19 +192,16 @@ class ExpressionConfig {
   uint8_t target = 3;              // TARGET_SHADE=1, TARGET_BASE=2, TARGET_BOTH=3
 
   // Generic parameter storage for expression-specific values
-  std::map<std::string, uint32_t> parameters;
+  ParamSet parameters;
 
   // Helper methods for parameter access
-  uint32_t getParameter(const std::string& name, uint32_t defaultValue) const {
-    auto it = parameters.find(name);
-    if (it != parameters.end()) {
-      return it->second;
-    }
-    return defaultValue;
+  uint32_t getParameter(const char* name, uint32_t defaultValue) const {
+    return parameters.get(name, defaultValue);
   }
 
-  void setParameter(const std::string& name, uint32_t value) {
-    parameters[name] = value;
+  // False (and nothing stored) for a key outside kParamKeyNames.
+  bool setParameter(const char* name, uint32_t value) {
+    return parameters.set(name, value);
   }
 };
 
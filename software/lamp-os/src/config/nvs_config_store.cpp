@@ -18,6 +18,33 @@ size_t NvsConfigStore::write(const char* key, const char* value) {
   return written;
 }
 
+bool NvsConfigStore::readBytes(const char* key, std::vector<uint8_t>& out) {
+  if (!prefs_.begin("lamp", true)) return false;
+  const size_t len = prefs_.isKey(key) ? prefs_.getBytesLength(key) : 0;
+  bool found = false;
+  if (len > 0) {
+    out.resize(len);
+    found = prefs_.getBytes(key, out.data(), len) == len;
+  }
+  prefs_.end();
+  return found;
+}
+
+size_t NvsConfigStore::writeBytes(const char* key, const uint8_t* data, size_t len) {
+  if (!prefs_.begin("lamp", false)) return 0;
+  size_t written = prefs_.putBytes(key, data, len);
+  prefs_.end();
+  return written;
+}
+
+bool NvsConfigStore::remove(const char* key) {
+  if (!prefs_.begin("lamp", false)) return false;
+  // Preferences::remove reports false for an absent key; that is success here.
+  const bool gone = prefs_.remove(key) || !prefs_.isKey(key);
+  prefs_.end();
+  return gone;
+}
+
 bool NvsConfigStore::clear() {
   if (!prefs_.begin("lamp", false)) return false;
   bool cleared = prefs_.clear();
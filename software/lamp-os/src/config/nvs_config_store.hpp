@@ -16,6 +16,9 @@ class NvsConfigStore : public ConfigStore {
  public:
   std::string read(const char* key, const char* defaultValue) override;
   size_t write(const char* key, const char* value) override;
+  bool readBytes(const char* key, std::vector<uint8_t>& out) override;
+  size_t writeBytes(const char* key, const uint8_t* data, size_t len) override;
+  bool remove(const char* key) override;
   bool clear() override;
 
  private:
@@ -210,10 +210,12 @@ void Compositor::compositeWisp() {
   wispBaseStack_.tick(wispBasePresence_.value());
   // frameBuffers[0]=shade, [1]=base per lamp_behaviors.cpp ordering.
   if (!frameBuffers.empty() && frameBuffers[0]) {
-    for (Color& px : frameBuffers[0]->buffer) px = wispShadeStack_.composite(px);
+    std::vector<Color>& px = frameBuffers[0]->buffer;
+    wispShadeStack_.compositeSpan(px.data(), px.size());
   }
   if (frameBuffers.size() > 1 && frameBuffers[1]) {
-    for (Color& px : frameBuffers[1]->buffer) px = wispBaseStack_.composite(px);
+    std::vector<Color>& px = frameBuffers[1]->buffer;
+    wispBaseStack_.compositeSpan(px.data(), px.size());
   }
 }
 
@@ -2,13 +2,17 @@
 
 #include <Adafruit_NeoPixel.h>
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <vector>
 
 #include "util/color.hpp"
 
 namespace lamp {
 
+static_assert(sizeof(Color) == 4, "flush() diffs a Color as one 32-bit word");
+
 FrameBuffer::FrameBuffer() {}
 
 void FrameBuffer::begin(std::vector<Color> inDefaultColors, std::vector<StripSegment> inSegments) {
@@ -32,34 +36,102 @@ void FrameBuffer::begin(std::vector<Color> inDefaultColors, uint8_t inPixelCount
   begin(std::move(inDefaultColors), {{inDriver, "", 0, inPixelCount}});
 }
 
+void FrameBuffer::setBrightness(uint8_t level) {
+  for (const auto& seg : segments) {
+    if (seg.driver) seg.driver->setBrightness(level);
+  }
+  if (!segments.empty() && segments[0].driver) {
+    buildEncodeLut(segments[0].driver->getBrightness());
+  }
+}
+
+void FrameBuffer::buildEncodeLut(uint8_t brightness) {
+  // Adafruit stores setBrightness(b) as b+1 and scales (v * (b+1)) >> 8 at
+  // setPixelColor time; 255 wraps to 0, which means no scaling.
+  const uint16_t scale = static_cast<uint16_t>(brightness) + 1;
+  for (uint16_t v = 0; v < 256; v++) {
+    const uint8_t g = Adafruit_NeoPixel::gamma8(static_cast<uint8_t>(v));
+    encodeLut_[v] = brightness == 255 ? g : static_cast<uint8_t>((g * scale) >> 8);
+  }
+  encodeLutBrightness_ = brightness;
+}
+
+void FrameBuffer::markAllDirty() {
+  for (uint32_t& word : dirty_) word = ~0u;
+}
+
+void FrameBuffer::clearDirtyRange(uint16_t begin, uint16_t end) {
+  while (begin < end) {
+    const uint16_t bit = begin & 31;
+    const uint16_t span = std::min<uint16_t>(32 - bit, end - begin);
+    const uint32_t mask = span == 32 ? ~0u : ((1u << span) - 1) << bit;
+    dirty_[begin >> 5] &= ~mask;
+    begin += span;
+  }
+}
+
 void FrameBuffer::flush() {
   if (segments.empty()) return;
   // Brightness is uniform across segments; segments[0] is representative.
-  if (buffer == previousBuffer &&
-      segments[0].driver->getBrightness() == previousBrightness) {
-    return;
+  const uint8_t brightness = segments[0].driver->getBrightness();
+  // The drivers scale at setPixelColor time, so a brightness change stales
+  // every pixel they hold. A size mismatch is the first flush (or a buffer
+  // resized behind our back): nothing shown is known, push it all.
+  if (brightness != previousBrightness || previousBuffer.size() != buffer.size()) {
+    markAllDirty();
+    previousBuffer.resize(buffer.size());
+  }
+  if (encodeLutBrightness_ != brightness) buildEncodeLut(brightness);
+  const uint16_t n = static_cast<uint16_t>(
+      std::min<size_t>(buffer.size(), kMaxPixels));
+  // Diff a word of the bitmap at a time; each Color is compared as one
+  // 32-bit load rather than four byte compares.
+  for (uint16_t base = 0; base < n; base += 32) {
+    const uint16_t end = std::min<uint16_t>(n, base + 32);
+    uint32_t changed = 0;
+    for (uint16_t i = base; i < end; i++) {
+      uint32_t now, prev;
+      std::memcpy(&now, &buffer[i], sizeof(now));
+      std::memcpy(&prev, &previousBuffer[i], sizeof(prev));
+      changed |= static_cast<uint32_t>(now != prev) << (i - base);
+    }
+    dirty_[base >> 5] |= changed;
   }
+
   bool allShown = true;
   for (const auto& seg : segments) {
+    // Encode gamma + brightness + byte order in one table lookup per channel,
+    // straight into the driver's wire buffer (what setPixelColor would write).
+    const lampos::led::WireLayout layout = lampos::led::wireLayout(seg.byteOrder);
+    uint8_t* wire = seg.driver->getPixels();
+    bool segmentDirty = false;
     for (uint16_t i = 0; i < seg.pixelCount; i++) {
-      const Color& c = buffer[seg.offset + (seg.reversed ? (seg.pixelCount - 1 - i) : i)];
-      seg.driver->setPixelColor(
-          i, (uint32_t)((Adafruit_NeoPixel::gamma8(c.w) << 24) |
-                        (Adafruit_NeoPixel::gamma8(c.r) << 16) |
-                        (Adafruit_NeoPixel::gamma8(c.g) << 8) |
-                        Adafruit_NeoPixel::gamma8(c.b)));
+      const uint16_t idx = seg.offset + (seg.reversed ? (seg.pixelCount - 1 - i) : i);
+      if (idx >= n || !isDirty(idx)) continue;
+      const Color& c = buffer[idx];
+      uint8_t* px = wire + i * layout.bytesPerPixel;
+      px[layout.r] = encodeLut_[c.r];
+      px[layout.g] = encodeLut_[c.g];
+      px[layout.b] = encodeLut_[c.b];
+      if (layout.w != lampos::led::kNoWhiteByte) px[layout.w] = encodeLut_[c.w];
+      segmentDirty = true;
     }
-    if (seg.driver->canShow()) {
-      seg.driver->show();
-    } else {
+    if (!segmentDirty) continue;
+    if (!seg.driver->canShow()) {
+      // A skipped segment keeps its dirty bits and retransmits next frame.
       allShown = false;
+      continue;
+    }
+    seg.driver->show();
+    // Clean pixels already match previousBuffer, so copy the whole slice.
+    const uint16_t end = std::min<uint16_t>(n, seg.offset + seg.pixelCount);
+    if (seg.offset < end) {
+      std::copy(buffer.begin() + seg.offset, buffer.begin() + end,
+                previousBuffer.begin() + seg.offset);
+      clearDirtyRange(seg.offset, end);
     }
   }
-  // A skipped segment retransmits on the next frame.
-  if (allShown) {
-    previousBuffer = buffer;
-    previousBrightness = segments[0].driver->getBrightness();
-  }
+  if (allShown) previousBrightness = brightness;
 }
 
 }  // namespace lamp
@@ -5,6 +5,8 @@
 #include <cstdint>
 #include <vector>
 
+#include <lampos/led_types.hpp>
+
 #include "util/color.hpp"
 
 namespace lamp {
@@ -16,6 +18,8 @@ struct StripSegment {
   uint16_t offset;     // start index in the logical buffer
   uint16_t pixelCount;
   bool reversed = false;
+  // Wire order of the driver's pixel array; flush() encodes straight into it.
+  lampos::led::ByteOrder byteOrder = lampos::led::ByteOrder::GRBW;
 };
 
 class FrameBuffer {
@@ -35,7 +39,42 @@ class FrameBuffer {
 
   void begin(std::vector<Color> inDefaultColors, uint8_t inPixelCount, Adafruit_NeoPixel* inDriver);
 
+  // Sets every segment driver's brightness and rebuilds the encode table so
+  // the next flush() doesn't pay for it.
+  void setBrightness(uint8_t level);
+
+  // Re-encodes and transmits only what changed since the last shown frame:
+  // a pixel is dirty when it differs from previousBuffer or was marked, and a
+  // segment with no dirty pixel is neither re-encoded nor shown. A driver
+  // brightness change dirties everything. previousBuffer advances per shown
+  // segment, so a segment whose driver was busy retransmits next frame.
   void flush();
+
+  // Force buffer[index] (or every pixel) out on the next flush() even if it
+  // matches the last shown frame. Cheap bit set; callers that write `buffer`
+  // directly need not mark, flush() diffs against previousBuffer anyway.
+  void markDirty(uint16_t index) {
+    if (index < kMaxPixels) dirty_[index >> 5] |= 1u << (index & 31);
+  }
+  void markAllDirty();
+
+ private:
+  // Σ pixelCount fits in uint8_t, so one fixed bitmap covers any buffer.
+  static constexpr uint16_t kMaxPixels = 256;
+  uint32_t dirty_[kMaxPixels / 32] = {};
+
+  // gamma8 x driver brightness, indexed by channel value; what the driver's
+  // setPixelColor would produce. Rebuilt when the brightness it was built for
+  // (-1: never) differs from the drivers'.
+  uint8_t encodeLut_[256];
+  int16_t encodeLutBrightness_ = -1;
+  void buildEncodeLut(uint8_t brightness);
+
+  bool isDirty(uint16_t index) const {
+    return (dirty_[index >> 5] >> (index & 31)) & 1u;
+  }
+  // Clears bits [begin, end).
+  void clearDirtyRange(uint16_t begin, uint16_t end);
 };
 
 }  // namespace lamp
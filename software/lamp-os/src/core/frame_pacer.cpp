@@ -0,0 +1,82 @@
+#include "core/frame_pacer.hpp"
+
+namespace lamp {
+
+bool FramePacer::frameDue(uint32_t nowUs) const {
+  return !armed_ || static_cast<int32_t>(nowUs - deadlineUs_) >= 0;
+}
+
+void FramePacer::frameFlushed(uint32_t nowUs) {
+  if (armed_) {
+    const int32_t late = static_cast<int32_t>(nowUs - deadlineUs_);
+    // The compositor gates on whole milliseconds, so a flush can land a
+    // fraction of one early; that's on time.
+    const uint32_t latenessUs = late > 0 ? static_cast<uint32_t>(late) : 0;
+    jitter_[bucketFor(latenessUs)]++;
+    if (latenessUs > maxLatenessUs_) maxLatenessUs_ = latenessUs;
+    frames_++;
+  }
+  deadlineUs_ = nowUs + periodUs_;
+  armed_ = true;
+}
+
+uint32_t FramePacer::slackUs(uint32_t nowUs) const {
+  if (!armed_) return 0;
+  const int32_t left = static_cast<int32_t>(deadlineUs_ - nowUs);
+  return left > 0 ? static_cast<uint32_t>(left) : 0;
+}
+
+bool FramePacer::admit(uint8_t id, uint32_t nowUs) {
+  if (id >= kMaxDrains) return true;
+  DrainStat& d = drains_[id];
+  // Before the first flush there is no deadline to protect.
+  if (!armed_) return true;
+  if (d.costUs + kGuardUs <= slackUs(nowUs)) return true;
+  if (!d.deferred) {
+    d.deferred = true;
+    d.deferredSinceUs = nowUs;
+  } else if (nowUs - d.deferredSinceUs >= kMaxDeferFrames * periodUs_) {
+    d.forced = true;
+    return true;  // starved long enough; run it late rather than never
+  }
+  d.deferrals++;
+  return false;
+}
+
+void FramePacer::charge(uint8_t id, uint32_t costUs) {
+  if (id >= kMaxDrains) return;
+  DrainStat& d = drains_[id];
+  d.deferred = false;
+  d.runs++;
+  if (costUs > d.maxUs) d.maxUs = costUs;
+  // A heavy run (blob parse, NVS commit) is the cost to plan for next time;
+  // idle runs bleed it back down over a few dozen passes. A drain the
+  // estimate kept deferred never gets those runs, so a forced run replaces
+  // the estimate outright: one idle run then brings it back into the slack.
+  const bool forced = d.forced;
+  d.forced = false;
+  if (costUs >= d.costUs || forced) {
+    d.costUs = costUs;
+  } else {
+    d.costUs -= (d.costUs - costUs + 7) / 8;
+  }
+}
+
+void FramePacer::resetStats() {
+  jitter_.fill(0);
+  frames_ = 0;
+  maxLatenessUs_ = 0;
+  for (DrainStat& d : drains_) {
+    d.maxUs = 0;
+    d.runs = 0;
+    d.deferrals = 0;
+  }
+}
+
+size_t FramePacer::bucketFor(uint32_t latenessUs) {
+  size_t b = 0;
+  for (uint32_t edge = 500; b < kJitterBuckets - 1 && latenessUs >= edge; edge <<= 1) b++;
+  return b;
+}
+
+}  // namespace lamp
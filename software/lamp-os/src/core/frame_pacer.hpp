@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace lamp {
+
+// Cooperative frame pacing for Lamp::tick(). Tracks the next frame deadline
+// from the last flush, so the loop can render first when a frame is due and
+// spend the slack before the next deadline on expensive drains. Each paced
+// drain carries a cost estimate (instant rise on a heavy run, slow decay
+// while idle); a drain whose estimate doesn't fit the remaining slack waits
+// for a later pass, but never longer than kMaxDeferFrames frame periods, so
+// deferral bounds jitter without starving a drain. A run forced by that
+// bound resets the estimate to what it measured: a deferred drain has no
+// idle runs to decay through. Flush-to-flush lateness
+// lands in a power-of-two histogram for the debug console. Pure over plain
+// values so native tests drive it directly.
+class FramePacer {
+ public:
+  static constexpr uint32_t kDefaultPeriodUs = 16000;  // MINIMUM_FRAME_DRAW_TIME_MS
+  static constexpr size_t kMaxDrains = 16;
+  static constexpr uint8_t kMaxDeferFrames = 4;
+  // Headroom kept free ahead of the deadline for the compositor pass itself.
+  static constexpr uint32_t kGuardUs = 1000;
+  // Lateness buckets: [0, 0.5) [0.5, 1) [1, 2) ... [16, 32) [32, inf) ms.
+  static constexpr size_t kJitterBuckets = 8;
+
+  struct DrainStat {
+    uint32_t costUs = 0;           // current estimate
+    uint32_t maxUs = 0;            // worst single run since reset
+    uint32_t runs = 0;
+    uint32_t deferrals = 0;        // passes skipped for lack of slack
+    uint32_t deferredSinceUs = 0;  // first skip of the current streak
+    bool deferred = false;
+    bool forced = false;           // admitted by the starvation bound
+  };
+
+  explicit FramePacer(uint32_t periodUs = kDefaultPeriodUs) : periodUs_(periodUs) {}
+
+  // True once the next frame's deadline has arrived (always before the
+  // first flush).
+  bool frameDue(uint32_t nowUs) const;
+
+  // Call when the compositor has flushed a frame. Records lateness against
+  // the previous deadline and arms the next one.
+  void frameFlushed(uint32_t nowUs);
+
+  // Microseconds until the next deadline; 0 when due or late.
+  uint32_t slackUs(uint32_t nowUs) const;
+
+  // Whether paced drain `id` should run now. False defers it to a later pass;
+  // the caller skips the drain and tries again next loop.
+  bool admit(uint8_t id, uint32_t nowUs);
+
+  // Cost of a drain run admit() let through.
+  void charge(uint8_t id, uint32_t costUs);
+
+  const DrainStat& drain(uint8_t id) const { return drains_[id]; }
+  const std::array<uint32_t, kJitterBuckets>& jitter() const { return jitter_; }
+  uint32_t frames() const { return frames_; }
+  uint32_t maxLatenessUs() const { return maxLatenessUs_; }
+
+  // Clears the histogram and drain stats; keeps the deadline and estimates.
+  void resetStats();
+
+  static size_t bucketFor(uint32_t latenessUs);
+
+ private:
+  uint32_t periodUs_;
+  uint32_t deadlineUs_ = 0;
+  bool armed_ = false;
+  uint32_t frames_ = 0;
+  uint32_t maxLatenessUs_ = 0;
+  std::array<uint32_t, kJitterBuckets> jitter_{};
+  std::array<DrainStat, kMaxDrains> drains_{};
+};
+
+}  // namespace lamp
@@ -13,6 +13,7 @@
 #include <Arduino.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <string>
@@ -30,6 +31,7 @@
 #include <NimBLEDevice.h>
 #include <esp_ota_ops.h>
 #include <esp_mac.h>
+#include <esp_heap_caps.h>
 #include <esp_system.h>
 #endif
 #include "components/input/input_driver.hpp"
@@ -56,6 +58,7 @@
 #include "config/nvs_config_store.hpp"
 #include "core/compositor.hpp"
 #include "core/frame_buffer.hpp"
+#include "core/frame_pacer.hpp"
 #include "core/power_governor.hpp"
 #include <lampos/blended_identity.hpp>
 #include <lampos/led_power.hpp>
@@ -70,6 +73,7 @@
 #include "util/gradient.hpp"
 #include "util/heap_probe.hpp"
 #include "util/levels.hpp"
+#include "util/metrics.hpp"
 
 lamp::NvsConfigStore configStore;
 
@@ -96,6 +100,101 @@ static uint8_t s_baseChannels = 4;
 static uint16_t s_govPixelCount = 0;
 static void governFrame();
 
+lamp::FramePacer s_framePacer;
+const char* const kPacedDrainNames[kPacedDrainCount] = {
+    "dispFlush", "exprOp",  "commit",  "settings", "socialDisp", "wifiOp",
+    "inboundOp", "remoteOp", "wispOp", "rxFrames", "fwControl",  "sections",
+};
+
+// Loop-owned metrics (util/metrics.hpp). Registered during static init,
+// before any task runs; the hot paths below just record.
+static struct LoopMetrics {
+  lamp::metrics::Histogram& frameUs = lamp::metrics::registry().histogram("frame.us");
+  lamp::metrics::Counter& frameDrop = lamp::metrics::registry().counter("frame.drop");
+  lamp::metrics::Histogram& tickUs = lamp::metrics::registry().histogram("tick.us");
+  lamp::metrics::Histogram& drainUs = lamp::metrics::registry().histogram("drain.us");
+  lamp::metrics::Histogram& rxApplyUs = lamp::metrics::registry().histogram("rx.apply.us");
+  lamp::metrics::Gauge& heapFree = lamp::metrics::registry().gauge("heap.free");
+  lamp::metrics::Gauge& heapLargest = lamp::metrics::registry().gauge("heap.largest");
+  lamp::metrics::Gauge& heapLow = lamp::metrics::registry().gauge("heap.low");
+  lamp::metrics::Gauge& stackFree = lamp::metrics::registry().gauge("stack.free");
+  lamp::metrics::Gauge& rxDropped = lamp::metrics::registry().gauge("rxq.drop");
+  lamp::metrics::Gauge& slotDropped = lamp::metrics::registry().gauge("slot.drop");
+} s_metrics;
+
+// micros() of the oldest rx frame not yet applied (bit 0 forced so a live
+// stamp is never 0). Set by the first post after a take, on the WiFi task
+// (Core 0), once the frame is in the ring; taken by drainRxFrames on Core 1
+// before it drains, so a frame posted mid-drain stamps the next batch rather
+// than being cleared unmeasured. Release / acquire order the stamp after its
+// frame's post, so a taken stamp's frame is in the ring this drain reads
+// (or, when it landed during the last drain, was applied by it: an empty
+// batch then records nothing).
+static std::atomic<uint32_t> s_rxPendingSinceUs{0};
+
+static void stampRxPost(bool posted) {
+  if (!posted) return;
+  uint32_t idle = 0;
+  s_rxPendingSinceUs.compare_exchange_strong(idle, micros() | 1u,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed);
+}
+
+uint32_t takeRxPendingSince() {
+  return s_rxPendingSinceUs.exchange(0, std::memory_order_acquire);
+}
+
+void recordRxApplied(uint32_t sinceUs) {
+  if (sinceUs != 0) s_metrics.rxApplyUs.record(micros() - sinceUs);
+}
+
+// compositor.tick() plus the pacer's flush bookkeeping. The compositor owns
+// the frame gate; a moved lastDrawTimeMs means this call flushed.
+static void tickCompositor() {
+  const unsigned long lastDrawMs = compositor.lastDrawTimeMs;
+  compositor.tick();
+  if (compositor.lastDrawTimeMs == lastDrawMs) return;
+  static uint32_t s_lastFlushUs = 0;
+  const uint32_t nowUs = micros();
+  if (s_lastFlushUs != 0) {
+    const uint32_t intervalUs = nowUs - s_lastFlushUs;
+    s_metrics.frameUs.record(intervalUs);
+    // A whole period skipped: the strip held one frame for two.
+    if (intervalUs >= 2 * lamp::FramePacer::kDefaultPeriodUs) s_metrics.frameDrop.add();
+  }
+  s_lastFlushUs = nowUs;
+  s_framePacer.frameFlushed(nowUs);
+}
+
+// Runs paced drain `id` if the pacer admits it, charging what it cost.
+// Declined drains keep their pending slot and retry on a later pass.
+template <class Fn>
+static void runPaced(PacedDrain id, Fn&& fn) {
+  const uint32_t startUs = micros();
+  if (!s_framePacer.admit(id, startUs)) return;
+  fn();
+  const uint32_t costUs = micros() - startUs;
+  s_framePacer.charge(id, costUs);
+  s_metrics.drainUs.record(costUs);
+}
+
+// 1 Hz level gauges: heap (free, largest block, boot low-water), loop-task
+// stack headroom, rx frames dropped on a full queue, typed pending-slot
+// overwrites.
+static void sampleGauges(uint32_t nowMs) {
+  static uint32_t s_nextSampleMs = 0;
+  if (static_cast<int32_t>(nowMs - s_nextSampleMs) < 0) return;
+  s_nextSampleMs = nowMs + 1000;
+  s_metrics.heapFree.set(static_cast<int32_t>(esp_get_free_heap_size()));
+  s_metrics.heapLargest.set(
+      static_cast<int32_t>(heap_caps_get_largest_free_block(MALLOC_CAP_8BIT)));
+  s_metrics.heapLow.set(static_cast<int32_t>(esp_get_minimum_free_heap_size()));
+  s_metrics.stackFree.set(static_cast<int32_t>(uxTaskGetStackHighWaterMark(nullptr)));
+  s_metrics.rxDropped.set(static_cast<int32_t>(lamp::pendingSlots.rxFrames.dropped()));
+  s_metrics.slotDropped.set(static_cast<int32_t>(
+      lamp::typedSlotOverwrites.load(std::memory_order_relaxed)));
+}
+
 // Bring apply_brightness helpers into file scope so unqualified call sites
 // (applyEffectiveBrightness, computeUserBrightnessNow) resolve.
 using lamp::applyEffectiveBrightness;
@@ -176,11 +275,42 @@ void postPendingWispPalette(const PendingWispPalette& src)               { pendi
 void postPendingWispClaim(const PendingWispClaim& src)                   { pendingSlots.wispClaim.post(pendingMux, src); }
 void postPendingWispPaint(const PendingWispPaint& src)                   { pendingSlots.wispPaint.post(pendingMux, src); }
 void postPendingWispState(const PendingWispState& src)                   { pendingSlots.wispState.post(pendingMux, src); }
-void postPendingCommand(const PendingCommand& src)                       { pendingSlots.command.post(pendingMux, src); }
-void postPendingEvent(const PendingEvent& src)                           { pendingSlots.event.post(pendingMux, src); }
-void postPendingColorQuery(const PendingColorQuery& src)                 { pendingSlots.colorQuery.post(pendingMux, src); }
-void postPendingColorInfo(const PendingColorInfo& src)                   { pendingSlots.colorInfo.post(pendingMux, src); }
+void postPendingCommand(const PendingCommand& src)                       { stampRxPost(pendingSlots.rxFrames.post(src)); }
+void postPendingEvent(const PendingEvent& src)                           { stampRxPost(pendingSlots.rxFrames.post(src)); }
+void postPendingColorQuery(const PendingColorQuery& src)                 { stampRxPost(pendingSlots.rxFrames.post(src)); }
+void postPendingColorInfo(const PendingColorInfo& src)                   { stampRxPost(pendingSlots.rxFrames.post(src)); }
 void postPendingFirmwareControl(const PendingFirmwareControl& src)       { pendingSlots.firmwareControl.post(pendingMux, src); }
+void postPendingRemoteBrightness(const PendingRemoteBrightness& src)     { pendingSlots.remoteBrightness.post(pendingMux, src); }
+void postPendingRemoteShadeColors(const PendingRemoteColors& src)        { pendingSlots.remoteShadeColors.post(pendingMux, src); }
+void postPendingRemoteBaseColors(const PendingRemoteColors& src)         { pendingSlots.remoteBaseColors.post(pendingMux, src); }
+
+namespace {
+PendingRemoteColors remoteColorsFrom(const lamp_protocol::ParsedBinaryControlOp& op) {
+  PendingRemoteColors out{};
+  out.count = op.colorCount;
+  for (uint8_t i = 0; i < op.colorCount; i++) {
+    const uint8_t* p = op.rgbw + i * 4;
+    out.colors[i] = Color(p[0], p[1], p[2], p[3]);
+  }
+  return out;
+}
+}  // namespace
+
+// Binary CONTROL_OP routes, indexed by op code. Dispatched on the WiFi recv
+// task by the control-op handler below, so each row only posts into the same
+// slots the JSON path ends up in: no JsonDocument, no loop-task re-parse.
+constexpr lamp_protocol::BinaryControlOpRoute kBinaryControlOpRoutes[] = {
+  {lamp_protocol::ControlOpCode::Brightness,
+   [](const lamp_protocol::ParsedBinaryControlOp& op) { postPendingRemoteBrightness({op.level}); }},
+  {lamp_protocol::ControlOpCode::ShadeColors,
+   [](const lamp_protocol::ParsedBinaryControlOp& op) { postPendingRemoteShadeColors(remoteColorsFrom(op)); }},
+  {lamp_protocol::ControlOpCode::BaseColors,
+   [](const lamp_protocol::ParsedBinaryControlOp& op) { postPendingRemoteBaseColors(remoteColorsFrom(op)); }},
+  {lamp_protocol::ControlOpCode::Knockout,
+   [](const lamp_protocol::ParsedBinaryControlOp& op) { ::postPendingKnockout(op.pixel, op.brightness); }},
+};
+static_assert(lamp_protocol::binaryControlOpRoutesIndexed(kBinaryControlOpRoutes),
+              "kBinaryControlOpRoutes needs one row per ControlOpCode, in code order");
 
 // Schedules a future triggerInvocation without each call site having to
 // know the queue storage lives here. Runs on Core 1 (drain task);
@@ -309,14 +439,18 @@ static void recomputeDrawAnchors() {
 namespace lamp {
 void renderShadeColors(JsonArray arr) {
   if (arr.isNull() || arr.size() == 0) return;
-  std::vector<lamp::Color> colors = jsonArrayToColors(arr);
-  std::vector<lamp::Color> gradient =
-      lamp::buildGradientWithStops(shade.pixelCount, colors);
+  renderShadeColors(jsonArrayToColors(arr));
+}
+
+void renderShadeColors(const std::vector<lamp::Color>& colors) {
+  if (colors.empty()) return;
   // beginFade keeps the color-picker's ~250ms ease. On a rapid write mid-fade
   // it re-anchors fade-from to the in-progress lerp value, so drags
-  // rubber-band smoothly instead of snapping.
-  shadeConfiguratorBehavior.beginFade(gradient, lamp::kDefaultFadeMs);
-  lamp::overrides.shade.rebaseline(gradient);
+  // rubber-band smoothly instead of snapping. The gradient expands in place
+  // into the configurator, so a drag's per-write path doesn't allocate.
+  shadeConfiguratorBehavior.beginFadeToStops(colors.data(), colors.size(),
+                                             lamp::kDefaultFadeMs);
+  lamp::overrides.shade.rebaseline(shadeConfiguratorBehavior.colors);
   // Reflect the new shade in the BLE adv so phones and v1 neighbours see it
   // without connecting. Base and shade both carry their blended identity
   // color.
@@ -331,15 +465,18 @@ void renderShadeColors(JsonArray arr) {
 // handle timestamps + invalidate.
 void renderBaseColors(JsonArray arr) {
   if (arr.isNull() || arr.size() == 0) return;
-  std::vector<lamp::Color> colors = jsonArrayToColors(arr);
-  std::vector<lamp::Color> gradient =
-      lamp::buildGradientWithStops(base.pixelCount, colors);
+  renderBaseColors(jsonArrayToColors(arr));
+}
+
+void renderBaseColors(const std::vector<lamp::Color>& colors) {
+  if (colors.empty()) return;
   // See renderShadeColors: the fade-snapshot-from-buffer flicker on knockout
   // pixels is handled inside ConfiguratorBehavior::beginFade (it snapshots
   // from `colors` / in-progress lerp, not fb->buffer). No mid-fade guard
   // needed here.
-  baseConfiguratorBehavior.beginFade(gradient, lamp::kDefaultFadeMs);
-  lamp::overrides.base.rebaseline(gradient);
+  baseConfiguratorBehavior.beginFadeToStops(colors.data(), colors.size(),
+                                            lamp::kDefaultFadeMs);
+  lamp::overrides.base.rebaseline(baseConfiguratorBehavior.colors);
   // Reflect the new base in the BLE adv as its blended identity color.
   const auto& shadeStops = config.shade.broadcastColors();
   bt.setAdvertisedColors(
@@ -377,8 +514,8 @@ void runExpressionOp(JsonObject doc, bool mutateConfig) {
           key == "intervalMin" || key == "intervalMax" ||
           key == "target" || key == "colors") continue;
       JsonVariant v = kv.value();
-      if (v.is<uint32_t>()) cfg.setParameter(key, v.as<uint32_t>());
-      else if (v.is<int>()) cfg.setParameter(key, static_cast<uint32_t>(v.as<int>()));
+      if (v.is<uint32_t>()) cfg.setParameter(key.c_str(), v.as<uint32_t>());
+      else if (v.is<int>()) cfg.setParameter(key.c_str(), static_cast<uint32_t>(v.as<int>()));
     }
     // Store the JsonArray in a local so iteration doesn't reference a
     // temporary destroyed at the end of the full expression (ArduinoJson
@@ -477,8 +614,7 @@ void BehaviorContext::setGradient(const std::vector<Color>& stops) {
   const uint32_t now = millis();
   auto paint = [&](ConfiguratorBehavior* cfg) {
     if (!cfg || !cfg->fb) return;
-    cfg->beginFade(buildGradientWithStops(cfg->fb->pixelCount, stops),
-                   kDefaultFadeMs);
+    cfg->beginFadeToStops(stops.data(), stops.size(), kDefaultFadeMs);
     cfg->lastWebSocketUpdateTimeMs = now;
   };
   paint(shadeConfigurator);
@@ -687,7 +823,7 @@ void lamp::Lamp::setup() {
       byteOrderFromString(configByteOrder.c_str(), order);
       auto* driver =
           new Adafruit_NeoPixel(px, s.pin, lampos::led::neoPixelFormat(order) + NEO_KHZ800);
-      segments.push_back({driver, s.name, offset, px, s.reversed});
+      segments.push_back({driver, s.name, offset, px, s.reversed, order});
       offset += px;
     }
     fb.begin(lamp::buildGradientWithStops(offset, colors), std::move(segments));
@@ -745,6 +881,12 @@ void lamp::Lamp::setup() {
   // arriving in the gap is dropped because controlOpHandler_ is null.
   meshLink.setControlOpHandler(
       [](const uint8_t* payload, size_t len, const uint8_t srcMac[6]) {
+        // Binary ops route straight to their typed slots; a malformed one
+        // is dropped here rather than handed to the JSON parser.
+        if (lamp_protocol::isBinaryControlOp(payload, len)) {
+          lamp_protocol::dispatchBinaryControlOp(lamp::kBinaryControlOpRoutes, payload, len);
+          return;
+        }
         lamp::pendingSlots.inboundOp.post(
             pendingMux, reinterpret_cast<const char*>(payload), len, srcMac);
       });
@@ -928,6 +1070,8 @@ void lamp::Lamp::tick() {
   // / flushDispositionsNow calls below can use it unqualified. Drain helpers
   // each re-bind locally where they need it.
   lamp::Config& config = ::config;
+  const uint32_t tickStartUs = micros();
+  sampleGauges(millis());
 
 #ifdef LAMP_DEBUG
   pollSerialCommands();
@@ -959,6 +1103,11 @@ void lamp::Lamp::tick() {
   // fast cache write); the actual NimBLE setAdvertisementData() call
   // is rate-limited inside tickAdvertising() to avoid the host-task
   // race that panics the lamp on rapid color picker drags.
+  // A frame that's already due flushes before any drain can push it later.
+  // behaviorsComputed is normally set by the previous pass, so this is just
+  // the flush; the compositor pass at the bottom renders the next frame.
+  if (s_framePacer.frameDue(micros())) tickCompositor();
+
   bt.setAdvertisedOtaDistributing(config.isOtaDistributing());
   bt.tickAdvertising();
 
@@ -976,8 +1125,10 @@ void lamp::Lamp::tick() {
 
   // Debounced disposition commit: runs the actual NVS write once the user
   // has been idle for kDispositionFlushIdleMs (5s). Cheap when nothing is
-  // dirty (single bool check + uint32_t subtraction).
-  config.maybeFlushDispositions(millis());
+  // dirty (single bool check + uint32_t subtraction). The commit itself is
+  // paced; an NVS write can cost several milliseconds.
+  runPaced(kPacedDispositionFlush,
+           [&config] { config.maybeFlushDispositions(millis()); });
   if (pendingFlushDispositionsRequested) {
     // Phone disconnected (set on Core 0 in ble_control's onDisconnect).
     // Force-commit so the user's final slider value survives even if
@@ -993,17 +1144,20 @@ void lamp::Lamp::tick() {
   drainBaseColors();
   drainKnockout();
 
-  drainExpressionOp();
+  runPaced(kPacedExpressionOp, [this] { drainExpressionOp(); });
 
-  drainCommit();
+  runPaced(kPacedCommit, [this] { drainCommit(); });
 
-  drainSettingsBlob();
-  drainSocialDispositions();
+  runPaced(kPacedSettingsBlob, [this] { drainSettingsBlob(); });
+  runPaced(kPacedSocialDispositions, [this] { drainSocialDispositions(); });
 
   drainTestAction();
-  drainWifiOp();
-  drainInboundOp();
-  drainRemoteOp();
+  runPaced(kPacedWifiOp, [this] { drainWifiOp(); });
+  runPaced(kPacedInboundOp, [this] { drainInboundOp(); });
+  drainRemoteBrightness();
+  drainRemoteShadeColors();
+  drainRemoteBaseColors();
+  runPaced(kPacedRemoteOp, [this] { drainRemoteOp(); });
 
   // Transient-override drains. Each block drains its typed slot
   // and dispatches to the matching override instance based on the
@@ -1014,13 +1168,10 @@ void lamp::Lamp::tick() {
   drainWispPalette();
   drainWispClaim();
   drainWispState();
-  drainWispOp();
+  runPaced(kPacedWispOp, [this] { drainWispOp(); });
   drainWispStatus();
-  drainCommand();
-  drainColorQuery();
-  drainColorInfo();
-  drainEvent();
-  drainFirmwareControl();
+  runPaced(kPacedRxFrames, [this] { drainRxFrames(); });
+  runPaced(kPacedFirmwareControl, [this] { drainFirmwareControl(); });
 
   // Drive the override state machines. tick() is cheap when Idle
   // (single load + branch) so call unconditionally. Brightness tick uses
@@ -1122,14 +1273,14 @@ void lamp::Lamp::tick() {
   // Rebuild + push any dirty section JSON to its NimBLE characteristic
   // so onRead callbacks (Core 0) hand back NimBLE's already-buffered
   // bytes without walking config vectors. Cheap when nothing's dirty.
-  ble_control::tick();
+  runPaced(kPacedSectionRebuild, [] { ble_control::tick(); });
 
   // Tick physical inputs immediately before the compositor so a gesture's
   // edge/held state is current for this frame's render. Core 1, millis-gated
   // (touch), no delay().
   tickInputs(millis());
 
-  compositor.tick();
+  tickCompositor();
 
   // Demand sensing is per frame in governFrame (compositor pre-flush hook);
   // this block only advances the boot ramp and the paced release, plus the
@@ -1173,6 +1324,8 @@ void lamp::Lamp::tick() {
   if (expressionManager.reapCompletedTests()) {
     ble_control::notifyStateChange();
   }
+
+  s_metrics.tickUs.record(micros() - tickStartUs);
 }
 
 // Per-slot tick() drain helpers: definitions live in core/lamp_drains.cpp.
@@ -14,6 +14,10 @@ namespace lamp {
 
 class FrameBuffer;  // forward
 class ExpressionRegistry;  // forward
+struct PendingCommand;     // forward
+struct PendingEvent;       // forward
+struct PendingColorQuery;  // forward
+struct PendingColorInfo;   // forward
 
 class Lamp {
  public:
@@ -82,6 +86,9 @@ class Lamp {
   void drainTestAction();
   void drainWifiOp();
   void drainInboundOp();
+  void drainRemoteBrightness();
+  void drainRemoteShadeColors();
+  void drainRemoteBaseColors();
   void drainRemoteOp();
   void drainOverrideBrightness();
   void drainRestoreBrightness();
@@ -91,11 +98,15 @@ class Lamp {
   void drainWispState();
   void drainWispOp();
   void drainWispStatus();
-  void drainCommand();
-  void drainColorQuery();
-  void drainColorInfo();
-  void drainEvent();
+  void drainRxFrames();
   void drainFirmwareControl();
+
+  // Per-frame handlers for drainRxFrames (MSG_COMMAND / COLOR_QUERY /
+  // COLOR_INFO / EVENT).
+  void handleCommand(const PendingCommand& cmd);
+  void handleColorQuery(const PendingColorQuery& q);
+  void handleColorInfo(const PendingColorInfo& info);
+  void handleEvent(const PendingEvent& ev);
 };
 
 }  // namespace lamp
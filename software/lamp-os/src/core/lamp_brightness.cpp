@@ -170,8 +170,8 @@ void setAllStripsBrightness(uint8_t scaledLevel) {
       std::min(scaledLevel, s_powerGovernor.ceiling(millis()));
   const uint8_t shadeApplied = scale8(applied, s_shadeFactor);
   const uint8_t baseApplied  = scale8(applied, s_baseFactor);
-  for (const auto& seg : shade.segments) if (seg.driver) seg.driver->setBrightness(shadeApplied);
-  for (const auto& seg : base.segments)  if (seg.driver) seg.driver->setBrightness(baseApplied);
+  shade.setBrightness(shadeApplied);
+  base.setBrightness(baseApplied);
 }
 
 void applyEffectiveBrightness() {
@@ -5,7 +5,6 @@
 #include <ArduinoJson.h>
 
 #include <cstring>
-#include <new>
 #include <string>
 #include <vector>
 
@@ -37,18 +36,8 @@ namespace {
 // Local state for drainCommit only.
 bool      commitDirty = false;
 uint32_t  lastCommitSignalMs = 0;
-uint32_t  lastPersistedHash = 0;  // FNV-1a of last successfully persisted serialized JSON
 constexpr uint32_t kCommitFlushIdleMs = 2500;
 
-uint32_t fnv1aHash(const String& s) {
-  uint32_t h = 2166136261u;
-  for (size_t i = 0; i < s.length(); ++i) {
-    h ^= static_cast<uint8_t>(s[i]);
-    h *= 16777619u;
-  }
-  return h;
-}
-
 }  // namespace
 
 // Live-preview only; does not invalidate the section cache.
@@ -181,7 +170,7 @@ void Lamp::drainExpressionOp() {
   }
 }
 
-// Debounced 2500 ms; hash-dedup skips redundant NVS writes.
+// Debounced 2500 ms; per-section hash-dedup skips redundant NVS writes.
 // Force-flush path on BLE disconnect. Runs after live-preview drains.
 void Lamp::drainCommit() {
   lamp::Config& config = ::config;
@@ -206,35 +195,21 @@ void Lamp::drainCommit() {
       Serial.println("[loop] commit drain: OTA in progress, deferred");
 #endif
     } else {
-      JsonDocument doc = config.asJsonDocument();
-      String serialized;
-      // Reserve up front; growing by doubling would momentarily need ~2x the
-      // final size contiguous on a heap this fragmented, tipping into
-      // bad_alloc.
-      serialized.reserve(measureJson(doc));
-      try {
-        serializeJson(doc, serialized);
-        uint32_t hash = fnv1aHash(serialized);
-        if (hash == lastPersistedHash) {
-#ifdef LAMP_DEBUG
-          Serial.println("[loop] commit drain: hash-dedup skip");
-#endif
-          commitDirty = false;
-        } else {
-          bool persisted = config.persistConfig("commit");
-          if (persisted) {
-            lastPersistedHash = hash;
-            config.invalidateAllSections();
-            commitDirty = false;
-          }
-          // Persist failure leaves commitDirty set; next tick retries.
-        }
-      } catch (const std::bad_alloc&) {
+      // persistConfig encodes each section to its binary blob and writes
+      // only the ones that moved, so an unchanged commit costs no NVS write
+      // and no JSON at all.
+      uint8_t written = 0;
+      if (config.persistConfig("commit", &written)) {
+        // Invalidate even when nothing was written: an expressionOp drain
+        // may already have persisted the state the live-preview drains
+        // applied without invalidating the section cache.
+        config.invalidateAllSections();
+        commitDirty = false;
 #ifdef LAMP_DEBUG
-        Serial.println("[loop] commit drain: OOM during dedup hash, deferred");
+        if (written == 0) Serial.println("[loop] commit drain: hash-dedup skip");
 #endif
-        // commitDirty stays set; next tick retries.
       }
+      // Persist failure leaves commitDirty set; next tick retries.
     }
   }
 }
@@ -384,6 +359,42 @@ void Lamp::drainInboundOp() {
   }
 }
 
+// Binary CONTROL_OP surfaces (routed on the WiFi task by
+// kBinaryControlOpRoutes). Same cascade-source semantics as the JSON ops in
+// applyRemoteOpLocal: ToRender only, no config mutation, no section
+// invalidate.
+void Lamp::drainRemoteBrightness() {
+  lamp::PendingRemoteBrightness cmd;
+  if (lamp::pendingSlots.remoteBrightness.drain(pendingMux, cmd)) {
+#ifdef LAMP_DEBUG
+    Serial.printf("[loop] drain remoteBrightness level=%u\n", (unsigned)cmd.level);
+#endif
+    lamp::apply::brightnessToRender(cmd.level, false, s_hwMaxBrightness);
+  }
+}
+
+void Lamp::drainRemoteShadeColors() {
+  lamp::PendingRemoteColors cmd;
+  if (lamp::pendingSlots.remoteShadeColors.drain(pendingMux, cmd)) {
+#ifdef LAMP_DEBUG
+    Serial.printf("[loop] drain remoteShadeColors count=%u\n", (unsigned)cmd.count);
+#endif
+    lamp::apply::shadeColorsToRender(cmd.colors, cmd.count);
+    lamp::stampConfiguratorActivity(millis());
+  }
+}
+
+void Lamp::drainRemoteBaseColors() {
+  lamp::PendingRemoteColors cmd;
+  if (lamp::pendingSlots.remoteBaseColors.drain(pendingMux, cmd)) {
+#ifdef LAMP_DEBUG
+    Serial.printf("[loop] drain remoteBaseColors count=%u\n", (unsigned)cmd.count);
+#endif
+    lamp::apply::baseColorsToRender(cmd.colors, cmd.count);
+    lamp::stampConfiguratorActivity(millis());
+  }
+}
+
 // BLE has no network source MAC; selfMac lets app-driven triggers coalesce.
 void Lamp::drainRemoteOp() {
   if (lamp::pendingSlots.remoteOp.valid) {
@@ -578,29 +589,56 @@ void Lamp::drainWispStatus() {
   }
 }
 
-void Lamp::drainCommand() {
-  {
-    // static: the 1444 B payload is too big for the loop-task stack; this drain
-    // is the slot's only consumer and runs only on Core 1.
-    static lamp::PendingCommand cmd;
-    if (lamp::pendingSlots.command.drain(pendingMux, cmd)) {
-      JsonDocument doc;
-      if (deserializeJson(doc, cmd.payload, cmd.payloadLen) != DeserializationError::Ok) return;
-      lamp::ExpressionInvocation inv;
-      if (!lamp::parseInvocation(doc.as<JsonObjectConst>(), inv)) return;
-      if (inv.delayMs == 0) {
-        expressionManager.triggerInvocation(inv, cmd.sourceMac);
-      } else {
-        lamp::enqueueDelayedInvocation(inv, cmd.sourceMac, inv.delayMs);
+// Queued mesh frames (MSG_COMMAND / COLOR_QUERY / COLOR_INFO / EVENT), in
+// arrival order. One batch per tick: everything the WiFi task published
+// before the call, less what each type's RxFramePolicy coalesces away.
+void Lamp::drainRxFrames() {
+  // static: a PendingCommand's 1444 B payload is too big for the loop-task
+  // stack; this drain is the queue's only consumer and runs only on Core 1.
+  static lamp::PendingCommand cmd;
+  using Queue = lamp::MeshRxFrameQueue;
+  const uint32_t sinceUs = takeRxPendingSince();
+  const size_t n = lamp::pendingSlots.rxFrames.drain([this](const lamp::RxFrame& f) {
+    switch (f.tag) {
+      case lamp::RxFramePolicy<lamp::PendingCommand>::kTag:
+        if (Queue::load(f, cmd)) handleCommand(cmd);
+        break;
+      case lamp::RxFramePolicy<lamp::PendingEvent>::kTag: {
+        lamp::PendingEvent ev;
+        if (Queue::load(f, ev)) handleEvent(ev);
+        break;
+      }
+      case lamp::RxFramePolicy<lamp::PendingColorQuery>::kTag: {
+        lamp::PendingColorQuery q;
+        if (Queue::load(f, q)) handleColorQuery(q);
+        break;
+      }
+      case lamp::RxFramePolicy<lamp::PendingColorInfo>::kTag: {
+        lamp::PendingColorInfo info;
+        if (Queue::load(f, info)) handleColorInfo(info);
+        break;
       }
     }
-  }
+  });
+  if (n > 0) recordRxApplied(sinceUs);
+#ifdef LAMP_DEBUG
+  if (n > 1) Serial.printf("[loop] drain rxFrames batch=%u\n", (unsigned)n);
+#else
+  (void)n;
+#endif
 }
 
-void Lamp::drainColorQuery() {
-  lamp::PendingColorQuery q;
-  if (!lamp::pendingSlots.colorQuery.drain(pendingMux, q)) return;
+void Lamp::handleCommand(const lamp::PendingCommand& cmd) {
+  lamp::ExpressionInvocation inv;
+  if (!lamp::parseInvocationPayload(cmd.payload, cmd.payloadLen, inv)) return;
+  if (inv.delayMs == 0) {
+    expressionManager.triggerInvocation(inv, cmd.sourceMac);
+  } else {
+    lamp::enqueueDelayedInvocation(inv, cmd.sourceMac, inv.delayMs);
+  }
+}
 
+void Lamp::handleColorQuery(const lamp::PendingColorQuery& q) {
   lamp::Config& config = ::config;
 
   uint8_t baseStops[lamp_protocol::COLOR_INFO_MAX_STOPS * 4];
@@ -624,9 +662,7 @@ void Lamp::drainColorQuery() {
                          shadeStops, shadeCount);
 }
 
-void Lamp::drainColorInfo() {
-  lamp::PendingColorInfo info;
-  if (!lamp::pendingSlots.colorInfo.drain(pendingMux, info)) return;
+void Lamp::handleColorInfo(const lamp::PendingColorInfo& info) {
   std::vector<Color> baseStops;
   baseStops.reserve(info.baseCount);
   for (uint8_t i = 0; i < info.baseCount; ++i) {
@@ -644,17 +680,10 @@ void Lamp::drainColorInfo() {
   }
 }
 
-void Lamp::drainEvent() {
-  {
-    lamp::PendingEvent ev;
-    if (lamp::pendingSlots.event.drain(pendingMux, ev)) {
-      JsonDocument doc;
-      if (deserializeJson(doc, ev.payload, ev.payloadLen) != DeserializationError::Ok) return;
-      lamp::ExpressionInvocation inv;
-      if (!lamp::parseInvocation(doc.as<JsonObjectConst>(), inv)) return;
-      expressionObserverRegistry.fanOut(ev.sourceMac, inv);
-    }
-  }
+void Lamp::handleEvent(const lamp::PendingEvent& ev) {
+  lamp::ExpressionInvocation inv;
+  if (!lamp::parseInvocationPayload(ev.payload, ev.payloadLen, inv)) return;
+  expressionObserverRegistry.fanOut(ev.sourceMac, inv);
 }
 
 // FW_OFFER/DONE: heavy work (esp_ota_begin, sig verify) runs on Core 1.
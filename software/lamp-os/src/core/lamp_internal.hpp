@@ -23,6 +23,7 @@
 #include "components/network/mesh/mesh_link.hpp"
 #include "config/config.hpp"
 #include "config/nvs_config_store.hpp"
+#include "core/frame_pacer.hpp"
 #include "core/lamp.hpp"
 #include "core/power_governor.hpp"
 #include "expressions/expression_manager.hpp"
@@ -61,6 +62,38 @@ extern uint8_t s_hwMaxBrightness;
 // inside lamp::setAllStripsBrightness.
 extern lamp::PowerGovernor s_powerGovernor;
 
+// Drains Lamp::tick() admits through s_framePacer: the ones whose cost
+// spikes (JSON parses, NVS commits, section rebuilds, mesh frame bursts).
+// Brightness / color / override drains stay unpaced; they're cheap and
+// latency-visible.
+enum PacedDrain : uint8_t {
+  kPacedDispositionFlush,
+  kPacedExpressionOp,
+  kPacedCommit,
+  kPacedSettingsBlob,
+  kPacedSocialDispositions,
+  kPacedWifiOp,
+  kPacedInboundOp,
+  kPacedRemoteOp,
+  kPacedWispOp,
+  kPacedRxFrames,
+  kPacedFirmwareControl,
+  kPacedSectionRebuild,
+  kPacedDrainCount,
+};
+static_assert(kPacedDrainCount <= lamp::FramePacer::kMaxDrains);
+extern const char* const kPacedDrainNames[kPacedDrainCount];
+
+// Loop frame pacer (core/frame_pacer.hpp). Flush bookkeeping in lamp.cpp's
+// tickCompositor; debug console `pace.get` / `pace.reset`.
+extern lamp::FramePacer s_framePacer;
+
+// rx.apply.us: drainRxFrames takes the oldest pending frame's post stamp
+// before draining, then records post-to-apply latency for the batch. 0 (and
+// a no-op record) when nothing was stamped.
+uint32_t takeRxPendingSince();
+void recordRxApplied(uint32_t sinceUs);
+
 // Cross-core mux shared by every pending slot post / drain pair.
 extern portMUX_TYPE pendingMux;
 
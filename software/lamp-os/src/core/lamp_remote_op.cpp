@@ -20,11 +20,14 @@
 #include "components/apply/apply_brightness.hpp"
 #include "components/apply/apply_expressions.hpp"
 #include "components/apply/apply_shade_colors.hpp"
+#include "components/network/mesh/lamp_roster.hpp"
 #include "components/network/mesh/mesh_link.hpp"
+#include "components/network/protocol/lamp_protocol.hpp"
 #include "config/config.hpp"
 #include "core/pending_slot_aggregate.hpp"
 #include "expressions/expression_manager.hpp"
 #include "util/bd_addr.hpp"
+#include "util/color.hpp"
 
 // Forward-declared so the wispStatus branch below can post into the slot
 // aggregate without dragging ble_control.cpp's header into this TU. Same
@@ -122,6 +125,66 @@ static void applyRemoteOpLocal(const char* payloadJson, size_t len,
   // branch, and silently drops, which is the desired behavior.
 }
 
+// True when every lamp the forward reaches decodes binary CONTROL_OP
+// payloads: the addressed peer for unicast, every mesh peer for broadcast.
+// An unknown unicast target gets JSON, as does a broadcast with any older
+// lamp in range (it would drop the binary form as malformed JSON).
+static bool forwardSpeaksBinaryControlOp(const uint8_t targetMac[6], bool isBroadcast) {
+  if (isBroadcast) {
+    for (const auto& p : lamp::lampRoster.getMesh(LAMP_PRUNE_TIME_MS)) {
+      if (!(p.caps & lamp_protocol::HELLO_CAP_BINARY_CONTROL_OP)) return false;
+    }
+    return true;
+  }
+  lamp::RosterEntry peer;
+  return lamp::lampRoster.findByMac(targetMac, peer) &&
+         (peer.caps & lamp_protocol::HELLO_CAP_BINARY_CONTROL_OP);
+}
+
+// Binary form of a BLE remote op (see control_op_binary.hpp), or 0 when the
+// op has no binary form (expressionOp, wisp ops) or its fields would not
+// survive the receiver's range checks, in which case the caller sends JSON.
+// Field checks mirror applyRemoteOpLocal's so both forms apply identically.
+static size_t encodeBinaryControlOp(JsonDocument& doc, uint8_t* buf, size_t bufLen) {
+  const char* ch = doc["char"].as<const char*>();
+  if (!ch) return 0;
+  if (strcmp(ch, "brightness") == 0) {
+    int level = doc["value"] | -1;
+    if (level < 0 || level > 100) return 0;
+    return lamp_protocol::buildBinaryBrightnessOp(buf, bufLen, static_cast<uint8_t>(level));
+  }
+  if (strcmp(ch, "knockout") == 0) {
+    int pixel = doc["pixel"] | -1;
+    int brightness = doc["brightness"] | -1;
+    if (pixel < 0 || pixel >= 256 || brightness < 0 || brightness > 100) return 0;
+    return lamp_protocol::buildBinaryKnockoutOp(buf, bufLen, static_cast<uint8_t>(pixel),
+                                                static_cast<uint8_t>(brightness));
+  }
+  const bool shade = strcmp(ch, "shadeColors") == 0;
+  if (!shade && strcmp(ch, "baseColors") != 0) return 0;
+  JsonArray arr = doc["colors"].as<JsonArray>();
+  if (arr.isNull() || arr.size() == 0 ||
+      arr.size() > lamp_protocol::CONTROL_OP_MAX_COLORS) {
+    return 0;
+  }
+  uint8_t rgbw[lamp_protocol::CONTROL_OP_MAX_COLORS * 4];
+  uint8_t count = 0;
+  for (JsonVariant v : arr) {
+    // Same hex decode the receiver's JSON path runs, done once here.
+    const lamp::Color c = lamp::hexStringToColor(v);
+    rgbw[count * 4 + 0] = c.r;
+    rgbw[count * 4 + 1] = c.g;
+    rgbw[count * 4 + 2] = c.b;
+    rgbw[count * 4 + 3] = c.w;
+    ++count;
+  }
+  return lamp_protocol::buildBinaryColorsOp(
+      buf, bufLen,
+      shade ? lamp_protocol::ControlOpCode::ShadeColors
+            : lamp_protocol::ControlOpCode::BaseColors,
+      rgbw, count);
+}
+
 // `RemoteOpTransport` enum + applyRemoteOpRouted forward declaration both
 // live in lamp_internal.hpp so lamp_drains.cpp's drainInboundOp /
 // drainRemoteOp can see them. Definition follows below.
@@ -210,9 +273,20 @@ void applyRemoteOpRouted(const char* payloadJson, size_t len,
     // chunk stream for ESP-NOW airtime under BLE coex. Dropped forwards
     // are recoverable (the app retries on its next loop drain), but a
     // dropped chunk needs a stall-watchdog REQ round trip to recover.
-    meshLink.sendControlOp(
-        targetMac,
-        reinterpret_cast<const uint8_t*>(payload.data()),
-        payload.size());
+    //
+    // Fixed-shape ops go out binary when every receiver negotiated it, so a
+    // brightness drag costs each hop a memcpy instead of a JSON parse.
+    uint8_t bin[lamp_protocol::CONTROL_OP_BINARY_MAX_SIZE];
+    const size_t binLen = forwardSpeaksBinaryControlOp(targetMac, isBroadcast)
+                              ? encodeBinaryControlOp(doc, bin, sizeof(bin))
+                              : 0;
+    if (binLen) {
+      meshLink.sendControlOp(targetMac, bin, binLen);
+    } else {
+      meshLink.sendControlOp(
+          targetMac,
+          reinterpret_cast<const uint8_t*>(payload.data()),
+          payload.size());
+    }
   }
 }
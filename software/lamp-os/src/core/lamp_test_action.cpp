@@ -37,6 +37,7 @@
 #include "util/bd_addr.hpp"
 #include "util/color.hpp"
 #include "util/gradient.hpp"
+#include "util/metrics.hpp"
 
 namespace {
 
@@ -128,8 +129,7 @@ void dispatchLampAction(JsonDocument& doc, unsigned long updateTimeMs) {
         inv.target = static_cast<uint8_t>(target);
         inv.colors = std::move(payloadColors);
         for (JsonPairConst kv : doc["parameters"].as<JsonObjectConst>()) {
-          inv.parameters[std::string(kv.key().c_str())] =
-              kv.value().as<uint32_t>();
+          inv.parameters.set(kv.key().c_str(), kv.value().as<uint32_t>());
         }
 #ifdef LAMP_DEBUG
         Serial.printf("[test] transient pulse colors=%zu type=%s target=%d\n",
@@ -352,6 +352,67 @@ void runSerialCommand(char* line, size_t len) {
     return;
   }
 
+  // Frame jitter histogram (flush lateness vs the 16 ms deadline; bucket
+  // upper edges 0.5/1/2/4/8/16/32 ms, last open) plus per-drain
+  // cost/max/runs/deferrals for the paced drains.
+  if (strcmp(line, "pace.get") == 0) {
+    const auto& hist = s_framePacer.jitter();
+    Serial.printf("[cmd] ok pace frames=%u maxLateUs=%u hist=",
+                  (unsigned)s_framePacer.frames(),
+                  (unsigned)s_framePacer.maxLatenessUs());
+    for (size_t i = 0; i < hist.size(); i++) {
+      Serial.printf(i ? ",%u" : "%u", (unsigned)hist[i]);
+    }
+    for (uint8_t id = 0; id < kPacedDrainCount; id++) {
+      const auto& d = s_framePacer.drain(id);
+      Serial.printf(" %s=%u/%u/%u/%u", kPacedDrainNames[id], (unsigned)d.costUs,
+                    (unsigned)d.maxUs, (unsigned)d.runs, (unsigned)d.deferrals);
+    }
+    Serial.println();
+    return;
+  }
+
+  if (strcmp(line, "pace.reset") == 0) {
+    s_framePacer.resetStats();
+    Serial.println("[cmd] ok pace.reset");
+    return;
+  }
+
+  // The metrics registry (util/metrics.hpp) as text, one name=value pair per
+  // metric: counters as n, gauges as value/min/max, histograms as
+  // count/min/p50/p99/max. Same values the `metrics` BLE page section carries.
+  if (strcmp(line, "metrics.get") == 0) {
+    const auto& reg = lamp::metrics::registry();
+    Serial.printf("[cmd] ok metrics uptimeMs=%u", (unsigned)millis());
+    reg.forEach([&reg](lamp::metrics::Kind kind, const char* name, size_t i) {
+      switch (kind) {
+        case lamp::metrics::Kind::Counter:
+          Serial.printf(" %s=%u", name, (unsigned)reg.counterAt(i).value());
+          break;
+        case lamp::metrics::Kind::Gauge: {
+          const auto& g = reg.gaugeAt(i);
+          Serial.printf(" %s=%d/%d/%d", name, (int)g.value(), (int)g.min(), (int)g.max());
+          break;
+        }
+        case lamp::metrics::Kind::Histogram: {
+          const auto& h = reg.histogramAt(i);
+          Serial.printf(" %s=%u/%u/%u/%u/%u", name, (unsigned)h.count(),
+                        (unsigned)h.min(), (unsigned)h.percentile(50),
+                        (unsigned)h.percentile(99), (unsigned)h.max());
+          break;
+        }
+      }
+    });
+    Serial.println();
+    return;
+  }
+
+  if (strcmp(line, "metrics.reset") == 0) {
+    lamp::metrics::registry().resetWindow();
+    Serial.println("[cmd] ok metrics.reset");
+    return;
+  }
+
   if (strcmp(line, "cfg.get") == 0) {
     std::string base, shade;
     config.baseSectionJsonCached(base);
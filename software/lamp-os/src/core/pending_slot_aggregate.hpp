@@ -12,11 +12,59 @@
 
 #include "core/pending_json_slot.hpp"
 #include "core/pending_typed_slot.hpp"
+#include "core/rx_frame_queue.hpp"
 #include "components/network/mesh/pending_slots.hpp"
 #include "components/firmware/firmware_receiver.hpp"
 
+#include <cstddef>
+
 namespace lamp {
 
+// Mesh receive types that ride the rxFrames queue instead of a newest-wins
+// slot. A cascade fans one MSG_COMMAND out per peer and greetings trigger a
+// burst of COLOR_QUERY / COLOR_INFO, so several can land between two drains;
+// every one of them is wanted (a repeat query from one sender needs one
+// reply, hence NewestPerSource there).
+template <>
+struct RxFramePolicy<PendingCommand> {
+  static constexpr uint8_t kTag = 1;
+  static constexpr RxCoalesce kCoalesce = RxCoalesce::None;
+  static size_t bytes(const PendingCommand& v) {
+    return offsetof(PendingCommand, payload) + v.payloadLen;
+  }
+};
+template <>
+struct RxFramePolicy<PendingEvent> {
+  static constexpr uint8_t kTag = 2;
+  static constexpr RxCoalesce kCoalesce = RxCoalesce::None;
+  static size_t bytes(const PendingEvent& v) {
+    return offsetof(PendingEvent, payload) + v.payloadLen;
+  }
+};
+template <>
+struct RxFramePolicy<PendingColorQuery> {
+  static constexpr uint8_t kTag = 3;
+  static constexpr RxCoalesce kCoalesce = RxCoalesce::NewestPerSource;
+  static size_t bytes(const PendingColorQuery&) { return sizeof(PendingColorQuery); }
+};
+template <>
+struct RxFramePolicy<PendingColorInfo> {
+  static constexpr uint8_t kTag = 4;
+  static constexpr RxCoalesce kCoalesce = RxCoalesce::NewestPerSource;
+  static size_t bytes(const PendingColorInfo&) { return sizeof(PendingColorInfo); }
+};
+static_assert(offsetof(PendingCommand, sourceMac) == 0 &&
+                  offsetof(PendingEvent, sourceMac) == 0 &&
+                  offsetof(PendingColorQuery, sourceMac) == 0 &&
+                  offsetof(PendingColorInfo, sourceMac) == 0,
+              "RxFrameQueue keys coalescing on a leading sourceMac");
+
+// 4 KB: one worst-case 1444 B JSON command plus a cascade's worth of typical
+// (binary / short JSON) ones. A full ring drops the newest frame and counts it.
+constexpr size_t kRxFrameQueueBytes = 4096;
+using MeshRxFrameQueue = RxFrameQueue<kRxFrameQueueBytes, PendingCommand, PendingEvent,
+                                      PendingColorQuery, PendingColorInfo>;
+
 struct PendingSlotAggregate {
   // Commit flags, set by ble_control.cpp's CHAR_COMMIT path, drained by
   // the loop in lamp.cpp's commit-tick logic.
@@ -39,7 +87,7 @@ struct PendingSlotAggregate {
   PendingJsonSlotWithMac<kPendingJsonOp> inboundOp;
 
   // Typed slots: transient color/brightness overrides + wisp events +
-  // firmware control flow.
+  // firmware control flow + binary CONTROL_OP surfaces.
   PendingTypedSlot<PendingOverrideColors>     overrideColors;
   PendingTypedSlot<PendingRestoreColors>      restoreColors;
   PendingTypedSlot<PendingOverrideBrightness> overrideBrightness;
@@ -49,11 +97,14 @@ struct PendingSlotAggregate {
   PendingTypedSlot<PendingWispClaim>          wispClaim;
   PendingTypedSlot<PendingWispPaint>          wispPaint;
   PendingTypedSlot<PendingWispState>          wispState;
-  PendingTypedSlot<PendingCommand>            command;
-  PendingTypedSlot<PendingEvent>              event;
-  PendingTypedSlot<PendingColorQuery>         colorQuery;
-  PendingTypedSlot<PendingColorInfo>          colorInfo;
   PendingTypedSlot<PendingFirmwareControl>    firmwareControl;
+  PendingTypedSlot<PendingRemoteBrightness>   remoteBrightness;
+  PendingTypedSlot<PendingRemoteColors>       remoteShadeColors;
+  PendingTypedSlot<PendingRemoteColors>       remoteBaseColors;
+
+  // Lock-free queue for the loss-intolerant mesh types (policies above).
+  // Single producer: MeshLink's WiFi recv task. Single consumer: the loop.
+  MeshRxFrameQueue rxFrames;
 };
 
 // Single production instance, defined in pending_slot_aggregate.cpp.
@@ -26,6 +26,9 @@
 // portMUX_TYPE; the production wire-payload types (PendingOverrideColors,
 // PendingWispHello, etc.) are all POD-by-construction.
 
+#include <atomic>
+#include <cstdint>
+
 #if defined(ARDUINO) || defined(ESP_PLATFORM)
 #include <Arduino.h>
 #include <freertos/FreeRTOS.h>
@@ -34,6 +37,11 @@
 
 namespace lamp {
 
+// Posts across every typed slot that landed on a still-valid payload (the
+// older event was lost). Reported as slot.drop in the metrics snapshot and
+// the HELLO health TLV.
+inline std::atomic<uint32_t> typedSlotOverwrites{0};
+
 template <typename T>
 struct PendingTypedSlot {
   bool valid = false;
@@ -41,12 +49,11 @@ struct PendingTypedSlot {
 
   bool post(portMUX_TYPE& mux, const T& src) {
     portENTER_CRITICAL(&mux);
-#ifdef LAMP_DEBUG
     const bool overwriting = valid;
-#endif
     payload = src;
     valid = true;
     portEXIT_CRITICAL(&mux);
+    if (overwriting) typedSlotOverwrites.fetch_add(1, std::memory_order_relaxed);
 #ifdef LAMP_DEBUG
     // Overwrite diagnostic: fires when a new post() lands on a still-valid
     // slot (the pending event is lost). sizeof(T) discriminates which slot
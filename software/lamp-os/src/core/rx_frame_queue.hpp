@@ -0,0 +1,143 @@
+#pragma once
+
+// RxFrameQueue<kBytes, Ts...> is the typed face of SpscFrameRing for the
+// mesh receive types that must not lose frames to a newer one (cascade
+// MSG_COMMAND / MSG_EVENT bursts, COLOR_QUERY / COLOR_INFO from several
+// peers at once). Each type in Ts declares at compile time, through an
+// RxFramePolicy<T> specialization:
+//
+//   kTag       : its frame tag (non-zero, unique within Ts).
+//   kCoalesce  : None            every frame is delivered, in arrival order.
+//                NewestPerSource within one drain batch only the newest
+//                                frame per sourceMac is delivered; older ones
+//                                from the same sender are skipped.
+//   bytes(v)   : how much of v to queue (a trimmed prefix, e.g. a header plus
+//                only the used part of a payload array).
+//
+// T must be trivially copyable with `uint8_t sourceMac[6]` as its first
+// member. Types whose newest-writer-wins semantics is what the drain wants
+// (override state, wisp snapshots) stay on PendingTypedSlot.
+//
+// post() is the single producer (MeshLink's WiFi recv task); drain() is the
+// single consumer (the loop task). Neither takes a lock.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "core/spsc_frame_ring.hpp"
+
+#ifdef LAMP_DEBUG
+#include <Arduino.h>
+#endif
+
+namespace lamp {
+
+enum class RxCoalesce : uint8_t { None, NewestPerSource };
+
+template <typename T>
+struct RxFramePolicy;  // specialized per queued type
+
+template <size_t kBytes, typename... Ts>
+class RxFrameQueue {
+ public:
+  // Newest-per-source bookkeeping is a fixed table; senders past it in one
+  // batch are delivered uncoalesced (never dropped).
+  static constexpr size_t kMaxCoalesceSources = 16;
+
+  template <typename T>
+  bool post(const T& v) {
+    static_assert((std::is_same_v<T, Ts> || ...), "T is not queued by this RxFrameQueue");
+    const bool ok = ring_.push(RxFramePolicy<T>::kTag, &v, RxFramePolicy<T>::bytes(v));
+#ifdef LAMP_DEBUG
+    if (!ok) {
+      Serial.printf("[rxq.drop] tag=%u dropped=%u\n",
+                    (unsigned)RxFramePolicy<T>::kTag, (unsigned)ring_.dropped());
+    }
+#endif
+    return ok;
+  }
+
+  // Copy a drained frame back into its DTO. False when the frame isn't a T.
+  // Bytes past the queued prefix are left as they were in `out`.
+  template <typename T>
+  static bool load(const RxFrame& f, T& out) {
+    if (f.tag != RxFramePolicy<T>::kTag || f.len > sizeof(T)) return false;
+    std::memcpy(static_cast<void*>(&out), f.data, f.len);
+    return true;
+  }
+
+  // Deliver every frame published before the call, applying each type's
+  // coalescing policy, then free them. fn(const RxFrame&) runs in arrival
+  // order. Returns the number of frames delivered.
+  template <typename Fn>
+  size_t drain(Fn&& fn) {
+    struct Newest {
+      uint8_t tag;
+      uint8_t mac[6];
+      size_t index;
+    };
+    Newest newest[kMaxCoalesceSources];
+    size_t sources = 0;
+    const size_t batch = ring_.scan([&](const RxFrame& f, size_t i) {
+      if (coalesceFor(f.tag) != RxCoalesce::NewestPerSource || f.len < 6) return;
+      for (size_t k = 0; k < sources; k++) {
+        if (newest[k].tag == f.tag && std::memcmp(newest[k].mac, f.data, 6) == 0) {
+          newest[k].index = i;
+          return;
+        }
+      }
+      if (sources < kMaxCoalesceSources) {
+        newest[sources].tag = f.tag;
+        std::memcpy(newest[sources].mac, f.data, 6);
+        newest[sources].index = i;
+        ++sources;
+      }
+    });
+    size_t delivered = 0;
+    ring_.drain([&](const RxFrame& f, size_t i) {
+      if (coalesceFor(f.tag) == RxCoalesce::NewestPerSource && f.len >= 6) {
+        for (size_t k = 0; k < sources; k++) {
+          if (newest[k].tag == f.tag && std::memcmp(newest[k].mac, f.data, 6) == 0) {
+            if (newest[k].index != i) return;  // a newer one from this sender follows
+            break;
+          }
+        }
+      }
+      fn(f);
+      ++delivered;
+    }, batch);
+    return delivered;
+  }
+
+  bool empty() const { return ring_.empty(); }
+  uint32_t dropped() const { return ring_.dropped(); }
+
+ private:
+  static constexpr RxCoalesce coalesceFor(uint8_t tag) {
+    RxCoalesce c = RxCoalesce::None;
+    ((tag == RxFramePolicy<Ts>::kTag ? (c = RxFramePolicy<Ts>::kCoalesce, 0) : 0), ...);
+    return c;
+  }
+
+  static constexpr bool tagsValid() {
+    const uint8_t tags[] = {RxFramePolicy<Ts>::kTag...};
+    for (size_t i = 0; i < sizeof...(Ts); i++) {
+      if (tags[i] == SpscFrameRing<kBytes>::kWrapTag) return false;
+      for (size_t j = i + 1; j < sizeof...(Ts); j++) {
+        if (tags[i] == tags[j]) return false;
+      }
+    }
+    return true;
+  }
+  static_assert(sizeof...(Ts) > 0, "RxFrameQueue needs at least one type");
+  static_assert(tagsValid(), "RxFramePolicy tags must be non-zero and unique");
+  static_assert((std::is_trivially_copyable_v<Ts> && ...), "queued types are memcpy'd");
+  static_assert(((sizeof(Ts) <= SpscFrameRing<kBytes>::kMaxFrameBytes) && ...),
+                "a queued type doesn't fit the ring");
+
+  SpscFrameRing<kBytes> ring_;
+};
+
+}  // namespace lamp
@@ -0,0 +1,137 @@
+#pragma once
+
+// SpscFrameRing<kBytes> is a bounded lock-free single-producer /
+// single-consumer ring of tagged, variable-length frames in one static byte
+// array. No heap, no portMUX: the producer publishes with a release store of
+// head_, the consumer frees with a release store of tail_, and each side
+// only reads the other's index with acquire.
+//
+// Each frame is a 4-byte header {len u16, tag u8, 0} plus its bytes, padded
+// to 4. A frame that would straddle the end is preceded by a wrap marker
+// (tag kWrapTag) filling the tail of the array, so every frame is contiguous
+// and handed to the consumer in place.
+//
+// Contract:
+//   - push(tag, data, len): producer only. Copies the frame in and publishes
+//                           it. Returns false, and counts a drop, when it
+//                           doesn't fit; frames already queued are never
+//                           overwritten.
+//   - scan(fn, max)       : consumer only. Walks up to `max` published frames
+//                           in order, fn(frame, index), without freeing them.
+//   - drain(fn, max)      : consumer only. Same walk, then frees everything it
+//                           walked with one store. Frame pointers are valid
+//                           only inside fn.
+//
+// Used for the Core 0 → Core 1 mesh receive hand-off (see rx_frame_queue.hpp);
+// the producer is MeshLink's WiFi recv task, the consumer the loop task.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace lamp {
+
+struct RxFrame {
+  uint8_t tag;
+  uint16_t len;
+  const uint8_t* data;
+};
+
+template <size_t kBytes>
+class SpscFrameRing {
+  static_assert(kBytes >= 64 && (kBytes & (kBytes - 1)) == 0,
+                "ring size must be a power of two");
+
+ public:
+  static constexpr uint8_t kWrapTag = 0;
+  static constexpr size_t kHeaderBytes = 4;
+  // Largest frame push() can ever accept (a wrap can cost up to one frame).
+  static constexpr size_t kMaxFrameBytes = kBytes / 2 - kHeaderBytes;
+
+  bool push(uint8_t tag, const void* data, size_t len) {
+    if (tag == kWrapTag || len > kMaxFrameBytes || (len && !data)) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    const uint32_t need = frameBytes(len);
+    const uint32_t head = head_.load(std::memory_order_relaxed);
+    const uint32_t tail = tail_.load(std::memory_order_acquire);
+    const uint32_t pos = head & kMask;
+    const uint32_t toEnd = static_cast<uint32_t>(kBytes) - pos;
+    const uint32_t pad = toEnd < need ? toEnd : 0;
+    if (pad + need > static_cast<uint32_t>(kBytes) - (head - tail)) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    if (pad) writeHeader(pos, kWrapTag, 0);
+    const uint32_t at = (head + pad) & kMask;
+    writeHeader(at, tag, static_cast<uint16_t>(len));
+    if (len) std::memcpy(&buf_[at + kHeaderBytes], data, len);
+    head_.store(head + pad + need, std::memory_order_release);
+    return true;
+  }
+
+  template <typename Fn>
+  size_t scan(Fn&& fn, size_t maxFrames = SIZE_MAX) const {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    return walk(tail, fn, maxFrames);
+  }
+
+  template <typename Fn>
+  size_t drain(Fn&& fn, size_t maxFrames = SIZE_MAX) {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t n = walk(tail, fn, maxFrames);
+    tail_.store(tail, std::memory_order_release);
+    return n;
+  }
+
+  bool empty() const {
+    return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_relaxed);
+  }
+
+  // Frames refused since boot (ring full or oversize). Producer-written.
+  uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  static constexpr uint32_t kMask = static_cast<uint32_t>(kBytes) - 1;
+
+  static constexpr uint32_t frameBytes(size_t len) {
+    return static_cast<uint32_t>(kHeaderBytes + ((len + 3) & ~static_cast<size_t>(3)));
+  }
+
+  void writeHeader(uint32_t pos, uint8_t tag, uint16_t len) {
+    buf_[pos + 0] = static_cast<uint8_t>(len & 0xFF);
+    buf_[pos + 1] = static_cast<uint8_t>(len >> 8);
+    buf_[pos + 2] = tag;
+    buf_[pos + 3] = 0;
+  }
+
+  // Walks published frames from `tail`, advancing it past each one walked
+  // (and past any wrap marker in front of one).
+  template <typename Fn>
+  size_t walk(uint32_t& tail, Fn& fn, size_t maxFrames) const {
+    const uint32_t head = head_.load(std::memory_order_acquire);
+    size_t n = 0;
+    while (tail != head && n < maxFrames) {
+      const uint32_t pos = tail & kMask;
+      const uint8_t tag = buf_[pos + 2];
+      if (tag == kWrapTag) {
+        tail += static_cast<uint32_t>(kBytes) - pos;
+        continue;
+      }
+      const uint16_t len = static_cast<uint16_t>(buf_[pos] | (buf_[pos + 1] << 8));
+      fn(RxFrame{tag, len, &buf_[pos + kHeaderBytes]}, n);
+      tail += frameBytes(len);
+      ++n;
+    }
+    return n;
+  }
+
+  alignas(4) uint8_t buf_[kBytes] = {};
+  std::atomic<uint32_t> head_{0};  // producer-owned, free-running byte offset
+  std::atomic<uint32_t> tail_{0};  // consumer-owned, free-running byte offset
+  std::atomic<uint32_t> dropped_{0};
+};
+
+}  // namespace lamp
@@ -86,7 +86,7 @@ class BreathingExpression : public Expression {
    * Configure breathing-specific parameters from generic parameter map.
    * @param parameters Map containing expression-specific parameters
    */
-  void configureFromParameters(const std::map<std::string, uint32_t>& parameters) override;
+  void configureFromParameters(const ParamSet& parameters) override;
   static const ExpressionDescriptor& classDescriptor();
   const ExpressionDescriptor& descriptor() const override;
 
@@ -0,0 +1,407 @@
+#pragma once
+// Compile-time exprcat builder. Renders a descriptor set to the exact bytes
+// ExpressionRegistry::serializeCatalog produces (same key order, same
+// omissions, same escaping), checks the set for schema mistakes, and finds
+// the perfect-hash seed the registry's find() uses. Everything here is
+// constexpr over the header-resident k<Name>DescriptorData, so the firmware
+// catalog is a .rodata array built by the compiler rather than by a host
+// generator, and a malformed descriptor is a build error rather than a
+// runtime surprise in the app.
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "expressions/expression_schema.hpp"
+
+namespace lamp::catalog {
+
+// ---- JSON writer -----------------------------------------------------------
+
+// Counts bytes; the first pass sizes the array.
+struct CountSink {
+  size_t n = 0;
+  constexpr void put(char) { n++; }
+};
+
+template <size_t N>
+struct ArraySink {
+  std::array<char, N>& buf;
+  size_t n = 0;
+  constexpr void put(char c) { buf[n++] = c; }
+};
+
+// Minimal ArduinoJson-compatible emitter: compact, members in call order,
+// strings escaped the way ArduinoJson's TextFormatter escapes them.
+template <class Sink>
+class JsonWriter {
+ public:
+  constexpr explicit JsonWriter(Sink& s) : s_(s) {}
+
+  constexpr void beginObject() { open('{'); }
+  constexpr void endObject() { close('}'); }
+  constexpr void beginArray() { open('['); }
+  constexpr void endArray() { close(']'); }
+
+  // Member key inside an object, or element separator inside an array.
+  constexpr void key(const char* k) { sep(); str(k); s_.put(':'); }
+  constexpr void element() { sep(); }
+
+  constexpr void str(const char* t) {
+    s_.put('"');
+    for (; *t; ++t) {
+      const char c = *t;
+      switch (c) {
+        case '"':  raw("\\\""); break;
+        case '\\': raw("\\\\"); break;
+        case '\b': raw("\\b"); break;
+        case '\f': raw("\\f"); break;
+        case '\n': raw("\\n"); break;
+        case '\r': raw("\\r"); break;
+        case '\t': raw("\\t"); break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20) {
+            constexpr char kHex[] = "0123456789abcdef";
+            raw("\\u00");
+            s_.put(kHex[(c >> 4) & 0xf]);
+            s_.put(kHex[c & 0xf]);
+          } else {
+            s_.put(c);
+          }
+      }
+    }
+    s_.put('"');
+  }
+
+  constexpr void num(int64_t v) {
+    if (v < 0) {
+      s_.put('-');
+      v = -v;
+    }
+    char digits[20] = {};
+    int n = 0;
+    do {
+      digits[n++] = static_cast<char>('0' + v % 10);
+      v /= 10;
+    } while (v);
+    while (n) s_.put(digits[--n]);
+  }
+
+  constexpr void boolean(bool b) { raw(b ? "true" : "false"); }
+
+  constexpr void memberStr(const char* k, const char* v) { key(k); str(v); }
+  constexpr void memberNum(const char* k, int64_t v) { key(k); num(v); }
+  constexpr void memberBool(const char* k, bool v) { key(k); boolean(v); }
+
+ private:
+  static constexpr int kMaxDepth = 8;
+
+  constexpr void raw(const char* t) { while (*t) s_.put(*t++); }
+  constexpr void open(char c) { s_.put(c); first_[depth_++] = true; }
+  constexpr void close(char c) { depth_--; s_.put(c); }
+  constexpr void sep() {
+    if (!first_[depth_ - 1]) s_.put(',');
+    first_[depth_ - 1] = false;
+  }
+
+  Sink& s_;
+  bool first_[kMaxDepth] = {};
+  int depth_ = 0;
+};
+
+// ---- exprcat ---------------------------------------------------------------
+
+constexpr const char* surfaceStr(Surface s) {
+  return s == Surface::Base ? "base" : "shade";
+}
+
+template <class W>
+constexpr void writeBound(W& w, const char* key, const Bound& b) {
+  if (b.kind == Bound::Literal) {
+    w.memberNum(key, b.v);
+    return;
+  }
+  w.key(key);
+  w.beginObject();
+  w.memberStr("rel", "pixels");
+  if (b.v > 0) w.memberNum("cap", b.v);
+  w.endObject();
+}
+
+template <class W>
+constexpr void writeRangeSpec(W& w, const char* key, const RangeSpec& r) {
+  w.key(key);
+  w.beginObject();
+  w.memberNum("min", r.min);
+  w.memberNum("max", r.max);
+  w.memberNum("step", r.step);
+  if (r.unit) w.memberStr("unit", r.unit);
+  w.key("default");
+  w.beginArray();
+  w.element();
+  w.num(r.defLo);
+  w.element();
+  w.num(r.defHi);
+  w.endArray();
+  if (r.minGap) w.memberNum("minGap", r.minGap);
+  if (r.label) w.memberStr("label", r.label);
+  if (r.help) w.memberStr("help", r.help);
+  if (r.minKey) w.memberStr("minKey", r.minKey);
+  if (r.maxKey) w.memberStr("maxKey", r.maxKey);
+  w.endObject();
+}
+
+template <class W>
+constexpr void writeParam(W& w, const ParamSpec& p) {
+  w.element();
+  w.beginObject();
+  w.memberStr("key", p.key);
+  w.memberStr("type", p.kind == ParamKind::Int ? "int" : "enum");
+  w.memberStr("label", p.label);
+  w.memberNum("min", p.min);
+  writeBound(w, "max", p.max);
+  w.memberNum("step", p.step);
+  writeBound(w, "default", p.def);
+  if (p.unit) w.memberStr("unit", p.unit);
+  if (p.invert) w.memberBool("invert", true);
+  if (p.leftLabel) w.memberStr("leftLabel", p.leftLabel);
+  if (p.rightLabel) w.memberStr("rightLabel", p.rightLabel);
+  if (p.help) w.memberStr("help", p.help);
+  if (p.requiresZoning) w.memberBool("requiresZoning", true);
+  if (p.kind == ParamKind::Enum && !p.options.empty()) {
+    w.key("options");
+    w.beginArray();
+    for (const auto& opt : p.options) {
+      w.element();
+      w.beginObject();
+      w.memberNum("value", opt.value);
+      w.memberStr("label", opt.label);
+      if (opt.zoning) w.memberBool("zoning", true);
+      if (opt.group) w.memberStr("group", opt.group);
+      w.endObject();
+    }
+    w.endArray();
+  }
+  w.endObject();
+}
+
+template <class W>
+constexpr void writeDescriptor(W& w, const ExpressionDescriptor& d) {
+  w.element();
+  w.beginObject();
+  w.memberStr("id", d.id);
+  w.memberStr("name", d.name);
+  w.memberBool("continuous", d.continuous);
+  if (d.advanced) w.memberBool("advanced", true);
+
+  w.key("colors");
+  w.beginObject();
+  w.memberNum("max", d.colors.max);
+  if (d.colors.label) w.memberStr("label", d.colors.label);
+  if (d.colors.help) w.memberStr("help", d.colors.help);
+  if (d.colors.inheritsSurface) w.memberBool("inheritsSurface", true);
+  w.endObject();
+
+  if (d.interval.has_value()) writeRangeSpec(w, "interval", *d.interval);
+  if (d.duration.has_value()) writeRangeSpec(w, "duration", *d.duration);
+
+  if (d.hasZone) {
+    w.key("zone");
+    w.beginObject();
+    if (d.zoneOptional) w.memberBool("optional", true);
+    w.endObject();
+  }
+
+  if (!d.excludeTargets.empty()) {
+    w.key("excludeTargets");
+    w.beginArray();
+    for (const auto& s : d.excludeTargets) {
+      w.element();
+      w.str(surfaceStr(s));
+    }
+    w.endArray();
+  }
+
+  if (!d.params.empty()) {
+    w.key("params");
+    w.beginArray();
+    for (const auto& p : d.params) writeParam(w, p);
+    w.endArray();
+  }
+  w.endObject();
+}
+
+// { "schemaVersion":1, "expressions":[...] }, internal descriptors skipped.
+template <class Sink>
+constexpr void writeCatalog(Sink& sink, const ExpressionDescriptor* const* ds,
+                            size_t n) {
+  JsonWriter<Sink> w(sink);
+  w.beginObject();
+  w.memberNum("schemaVersion", 1);
+  w.key("expressions");
+  w.beginArray();
+  for (size_t i = 0; i < n; i++) {
+    if (!ds[i]->internal) writeDescriptor(w, *ds[i]);
+  }
+  w.endArray();
+  w.endObject();
+}
+
+constexpr size_t catalogSize(const ExpressionDescriptor* const* ds, size_t n) {
+  CountSink c;
+  writeCatalog(c, ds, n);
+  return c.n;
+}
+
+constexpr uint32_t fnv1a32(const char* p, size_t n) {
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < n; i++) {
+    h ^= static_cast<unsigned char>(p[i]);
+    h *= 16777619u;
+  }
+  return h;
+}
+
+// ---- Validation ------------------------------------------------------------
+
+constexpr bool strEq(const char* a, const char* b) {
+  while (*a && *a == *b) {
+    a++;
+    b++;
+  }
+  return *a == *b;
+}
+
+constexpr bool nonEmpty(const char* s) { return s && *s; }
+
+// Literal bounds only; a Pixels bound resolves against the window at runtime.
+constexpr bool inLiteralRange(int32_t v, int32_t lo, const Bound& hi) {
+  return v >= lo && (hi.kind != Bound::Literal || v <= hi.v);
+}
+
+constexpr const char* validateRange(const std::optional<RangeSpec>& r) {
+  if (!r.has_value()) return nullptr;
+  if (r->step <= 0) return "range step must be positive";
+  if (r->min > r->max) return "range min exceeds max";
+  if (r->defLo < r->min || r->defHi > r->max || r->defLo > r->defHi) {
+    return "range default outside [min, max]";
+  }
+  if (r->minGap < 0 || r->minGap > r->max - r->min) return "range minGap out of range";
+  if ((r->minKey == nullptr) != (r->maxKey == nullptr)) {
+    return "range minKey/maxKey must be set together";
+  }
+  return nullptr;
+}
+
+constexpr const char* validateParam(const ParamSpec& p) {
+  if (!nonEmpty(p.key)) return "param key is empty";
+  if (!nonEmpty(p.label)) return "param label is empty";
+  if (p.step <= 0) return "param step must be positive";
+  if (p.max.kind == Bound::Literal && p.min > p.max.v) return "param min exceeds max";
+  if (p.def.kind == Bound::Literal && !inLiteralRange(p.def.v, p.min, p.max)) {
+    return "param default outside [min, max]";
+  }
+  if (p.kind == ParamKind::Enum) {
+    if (p.options.empty()) return "enum param has no options";
+    for (const auto& opt : p.options) {
+      if (!nonEmpty(opt.label)) return "enum option label is empty";
+      if (!inLiteralRange(opt.value, p.min, p.max)) return "enum option outside [min, max]";
+    }
+  }
+  return nullptr;
+}
+
+// nullptr when d is well-formed, else what's wrong with it. Compile-time
+// callers wrap it in static_assert; GCC prints the message on failure.
+constexpr const char* validateDescriptor(const ExpressionDescriptor& d) {
+  if (!nonEmpty(d.id)) return "descriptor id is empty";
+  if (!nonEmpty(d.name)) return "descriptor name is empty";
+  if (const char* e = validateRange(d.interval)) return e;
+  if (const char* e = validateRange(d.duration)) return e;
+  for (size_t i = 0; i < d.params.size(); i++) {
+    if (const char* e = validateParam(d.params[i])) return e;
+    for (size_t j = 0; j < i; j++) {
+      if (strEq(d.params[i].key, d.params[j].key)) return "duplicate param key";
+    }
+  }
+  return nullptr;
+}
+
+constexpr const char* validateSet(const ExpressionDescriptor* const* ds,
+                                  size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    if (const char* e = validateDescriptor(*ds[i])) return e;
+    for (size_t j = 0; j < i; j++) {
+      if (strEq(ds[i]->id, ds[j]->id)) return "duplicate expression id";
+    }
+  }
+  return nullptr;
+}
+
+// ---- Perfect hash ----------------------------------------------------------
+
+// Seeded FNV-1a over an expression id. The registry maps ids to slots with
+// idHash(id, seed) & mask and picks the first seed that leaves no two ids in
+// one slot, so find() is one hash and one strcmp.
+constexpr uint32_t idHash(const char* id, uint32_t seed) {
+  uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+  for (; *id; ++id) {
+    h ^= static_cast<unsigned char>(*id);
+    h *= 16777619u;
+  }
+  return h ^ (h >> 15);
+}
+
+inline constexpr uint32_t kMaxPerfectSeed = 4096;
+
+// Smallest power of two >= 2 * n (at least 8).
+constexpr size_t perfectTableSize(size_t n) {
+  size_t size = 8;
+  while (size < 2 * n) size <<= 1;
+  return size;
+}
+
+// First seed under which `ids` hash to distinct slots of a `tableSize`
+// table, or kMaxPerfectSeed if none does. The caller grows the table then.
+template <class IdAt>
+constexpr uint32_t findPerfectSeed(IdAt idAt, size_t n, size_t tableSize) {
+  const uint32_t mask = static_cast<uint32_t>(tableSize - 1);
+  for (uint32_t seed = 0; seed < kMaxPerfectSeed; seed++) {
+    bool ok = true;
+    for (size_t i = 0; i < n && ok; i++) {
+      const uint32_t si = idHash(idAt(i), seed) & mask;
+      for (size_t j = 0; j < i; j++) {
+        if ((idHash(idAt(j), seed) & mask) == si) {
+          ok = false;
+          break;
+        }
+      }
+    }
+    if (ok) return seed;
+  }
+  return kMaxPerfectSeed;
+}
+
+// ---- Per-set catalog -------------------------------------------------------
+
+// The rendered catalog for a constexpr descriptor set (a std::array of
+// descriptor pointers with static storage). kData is NUL-terminated.
+template <const auto& Set>
+struct Catalog {
+  static_assert(validateSet(Set.data(), Set.size()) == nullptr,
+                "malformed expression descriptor");
+  static_assert(findPerfectSeed([](size_t i) { return Set[i]->id; }, Set.size(),
+                                perfectTableSize(Set.size())) < kMaxPerfectSeed,
+                "no perfect-hash seed for this expression set");
+
+  static constexpr size_t kLen = catalogSize(Set.data(), Set.size());
+  static constexpr std::array<char, kLen + 1> kData = [] {
+    std::array<char, kLen + 1> out{};
+    ArraySink<kLen + 1> sink{out};
+    writeCatalog(sink, Set.data(), Set.size());
+    return out;
+  }();
+  static constexpr uint32_t kHash = fnv1a32(kData.data(), kLen);
+};
+
+}  // namespace lamp::catalog
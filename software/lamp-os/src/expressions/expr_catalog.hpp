@@ -0,0 +1,38 @@
+#pragma once
+// This build's exprcat catalog, rendered at compile time from the same
+// per-variant X-macro the runtime registration expands
+// (expressions/expr_variant_sets.hpp), so the served catalog cannot drift from
+// the registered set. Held in .rodata (flash) and served by reference.
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "expressions/bloom/bloom_expression.hpp"
+#include "expressions/breathing/breathing_expression.hpp"
+#include "expressions/catalog_constexpr.hpp"
+#include "expressions/expr_variant_sets.hpp"
+#include "expressions/glitchy/glitchy_expression.hpp"
+#include "expressions/pulse/pulse_expression.hpp"
+#include "expressions/shifty/shifty_expression.hpp"
+#include "expressions/shimmer/shimmer_expression.hpp"
+#include "expressions/spotty/spotty_expression.hpp"
+
+namespace lamp {
+
+#define X(N) &k##N##DescriptorData,
+#if defined(LAMP_BUILD_VARIANT_SNAFU)
+inline constexpr std::array kExprCatalogSet = {LAMPOS_SNAFU_EXPRESSIONS(X)};
+#elif defined(LAMP_BUILD_VARIANT_STAFF)
+inline constexpr std::array kExprCatalogSet = {LAMPOS_STAFF_EXPRESSIONS(X)};
+#else
+inline constexpr std::array kExprCatalogSet = {LAMPOS_BASE_EXPRESSIONS(X)};
+#endif
+#undef X
+
+using ExprCatalog = catalog::Catalog<kExprCatalogSet>;
+
+inline constexpr const char* kExprCatalog = ExprCatalog::kData.data();
+inline constexpr size_t kExprCatalogLen = ExprCatalog::kLen;
+inline constexpr uint32_t kExprCatalogHash = ExprCatalog::kHash;
+
+}  // namespace lamp
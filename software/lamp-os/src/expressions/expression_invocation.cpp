@@ -6,14 +6,11 @@
 
 namespace lamp {
 
-std::map<std::string, uint32_t> parametersWithoutCascadeKeys(
-    const std::map<std::string, uint32_t>& parameters) {
-  std::map<std::string, uint32_t> out;
-  for (const auto& kv : parameters) {
-    if (kv.first == kParamCascadeEnabled) continue;
-    if (kv.first == kParamCascadeStaggerMs) continue;
-    out.insert(kv);
-  }
+ParamSet parametersWithoutCascadeKeys(
+    const ParamSet& parameters) {
+  ParamSet out = parameters;
+  out.erase(kParamCascadeEnabled);
+  out.erase(kParamCascadeStaggerMs);
   return out;
 }
 
@@ -32,8 +29,8 @@ void serializeInvocation(const ExpressionInvocation& inv, std::string& out) {
   }
 
   JsonObject paramsObj = doc["parameters"].to<JsonObject>();
-  for (const auto& kv : inv.parameters) {
-    paramsObj[kv.first] = kv.second;
+  for (const ParamSet::Entry e : inv.parameters) {
+    paramsObj[e.name()] = e.value;
   }
 
   serializeJson(doc, out);
@@ -66,17 +63,24 @@ bool parseInvocation(JsonObjectConst doc, ExpressionInvocation& out) {
   JsonObjectConst params = doc["parameters"].as<JsonObjectConst>();
   if (!params.isNull()) {
     for (JsonPairConst kv : params) {
+      // Keys resolve against the interned table, no string copies; a key no
+      // descriptor declares has no reader, so it is dropped here.
+      const ParamKey key = findParamKey(kv.key().c_str());
+      if (key == kNoParamKey) {
+#ifdef LAMP_DEBUG
+        Serial.printf("[invocation] dropping unknown param '%s'\n", kv.key().c_str());
+#endif
+        continue;
+      }
       JsonVariantConst v = kv.value();
       // bool first; ArduinoJson types `true`/`false` as bool, distinct
       // from int. Coerce so callers can send the JSON-natural form too.
       if (v.is<bool>()) {
-        out.parameters[std::string(kv.key().c_str())] =
-            v.as<bool>() ? 1u : 0u;
+        out.parameters.set(key, v.as<bool>() ? 1u : 0u);
       } else if (v.is<uint32_t>()) {
-        out.parameters[std::string(kv.key().c_str())] = v.as<uint32_t>();
+        out.parameters.set(key, v.as<uint32_t>());
       } else if (v.is<int>()) {
-        out.parameters[std::string(kv.key().c_str())] =
-            static_cast<uint32_t>(v.as<int>());
+        out.parameters.set(key, static_cast<uint32_t>(v.as<int>()));
       }
     }
   }
@@ -84,4 +88,103 @@ bool parseInvocation(JsonObjectConst doc, ExpressionInvocation& out) {
   return true;
 }
 
+namespace {
+
+// Unsigned LEB128: 7 bits per byte, low group first, high bit = more.
+size_t putVarint(uint8_t* out, size_t cap, size_t off, uint32_t v) {
+  do {
+    if (off >= cap) return 0;
+    uint8_t b = static_cast<uint8_t>(v & 0x7F);
+    v >>= 7;
+    if (v) b |= 0x80;
+    out[off++] = b;
+  } while (v);
+  return off;
+}
+
+// Advances `off` past one varint. False on truncation or a >5-byte encoding.
+bool getVarint(const uint8_t* data, size_t len, size_t& off, uint32_t& v) {
+  v = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (off >= len) return false;
+    const uint8_t b = data[off++];
+    v |= static_cast<uint32_t>(b & 0x7F) << shift;
+    if (!(b & 0x80)) return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+size_t serializeInvocationBinary(const ExpressionInvocation& inv, uint8_t* out,
+                                 size_t cap) {
+  const uint8_t typeId = findInvocationTypeId(inv.type.c_str());
+  if (typeId == 0xFF || inv.colors.size() > kMaxBinaryInvocationColors) return 0;
+  const size_t fixed = 4 + inv.colors.size() * 4 + 1;
+  if (!out || cap < fixed) return 0;
+
+  size_t off = 0;
+  out[off++] = kInvocationBinaryTag;
+  out[off++] = typeId;
+  out[off++] = inv.target;
+  out[off++] = static_cast<uint8_t>(inv.colors.size());
+  for (const Color& c : inv.colors) {
+    out[off++] = c.r;
+    out[off++] = c.g;
+    out[off++] = c.b;
+    out[off++] = c.w;
+  }
+  out[off++] = static_cast<uint8_t>(inv.parameters.size());
+  for (const ParamSet::Entry e : inv.parameters) {
+    if (off >= cap) return 0;
+    out[off++] = e.key;
+    off = putVarint(out, cap, off, e.value);
+    if (!off) return 0;
+  }
+  return putVarint(out, cap, off, inv.delayMs);
+}
+
+bool parseInvocationBinary(const uint8_t* data, size_t len,
+                           ExpressionInvocation& out) {
+  if (!data || len < 4 || data[0] != kInvocationBinaryTag) return false;
+  if (data[1] >= kInvocationTypeCount) return false;
+  out.type = kInvocationTypeNames[data[1]];
+  // Same coercion as the JSON path: anything but SHADE/BASE/BOTH is BOTH.
+  out.target = (data[2] >= 1 && data[2] <= 3) ? data[2] : 3;
+
+  const size_t colorCount = data[3];
+  size_t off = 4;
+  if (len < off + colorCount * 4 + 1) return false;
+  out.colors.clear();
+  out.colors.reserve(colorCount);
+  for (size_t i = 0; i < colorCount; i++, off += 4) {
+    out.colors.emplace_back(data[off], data[off + 1], data[off + 2], data[off + 3]);
+  }
+
+  out.parameters.clear();
+  const uint8_t paramCount = data[off++];
+  for (uint8_t i = 0; i < paramCount; i++) {
+    if (off >= len) return false;
+    const ParamKey key = data[off++];
+    uint32_t v;
+    if (!getVarint(data, len, off, v)) return false;
+    // The schema id matched, so an out-of-table key is corruption, not skew.
+    if (!out.parameters.set(key, v)) return false;
+  }
+
+  uint32_t delay;
+  if (!getVarint(data, len, off, delay)) return false;
+  out.delayMs = clampDelayMs(delay);
+  return true;
+}
+
+bool parseInvocationPayload(const uint8_t* data, size_t len,
+                            ExpressionInvocation& out) {
+  if (!data || len == 0) return false;
+  if (data[0] == kInvocationBinaryTag) return parseInvocationBinary(data, len, out);
+  JsonDocument doc;
+  if (deserializeJson(doc, data, len) != DeserializationError::Ok) return false;
+  return parseInvocation(doc.as<JsonObjectConst>(), out);
+}
+
 }  // namespace lamp
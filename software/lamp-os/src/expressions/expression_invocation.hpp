@@ -3,17 +3,19 @@
 #include <ArduinoJson.h>
 
 #include <cstdint>
-#include <map>
+#include <cstring>
 #include <string>
 #include <vector>
 
+#include "expressions/param_set.hpp"
 #include "util/color.hpp"
 
 namespace lamp {
 
 // A one-shot "fire this expression now" payload. Subset of ExpressionConfig
-// (no enabled / intervalMin / intervalMax). Carried as the JSON body of
-// MSG_COMMAND (cascade + greeting) and MSG_EVENT (announce) frames.
+// (no enabled / intervalMin / intervalMax). Carried as the body of
+// MSG_COMMAND (cascade + greeting) and MSG_EVENT (announce) frames, in JSON
+// or, toward peers that negotiated it, the binary form below.
 //
 // `colors` is an optional palette override; empty means "use the configured
 // palette for this type." `delayMs` is interpreted by the receiver as
@@ -23,12 +25,12 @@ struct ExpressionInvocation {
   std::string type;
   std::vector<Color> colors;
   uint8_t target = 3;  // 1=SHADE, 2=BASE, 3=BOTH
-  std::map<std::string, uint32_t> parameters;
+  ParamSet parameters;
   uint32_t delayMs = 0;
 };
 
 // Cascade convention: the manager fans out any locally-triggered expression
-// whose parameters map contains cascadeEnabled=1, using cascadeStaggerMs as
+// whose parameter set contains cascadeEnabled=1, using cascadeStaggerMs as
 // the inter-peer delay. These keys are stripped from the invocation that
 // goes on the wire so receivers can never re-cascade.
 constexpr const char* kParamCascadeEnabled = "cascadeEnabled";
@@ -51,8 +53,8 @@ uint32_t clampDelayMs(uint32_t v);
 // Used by ExpressionManager when serializing an invocation for the wire;
 // receivers should never see the cascade keys, both to keep the message
 // small and as defense-in-depth against accidental re-cascade.
-std::map<std::string, uint32_t> parametersWithoutCascadeKeys(
-    const std::map<std::string, uint32_t>& parameters);
+ParamSet parametersWithoutCascadeKeys(
+    const ParamSet& parameters);
 
 // Serialize `inv` to JSON for MSG_COMMAND and MSG_EVENT payloads. `out` is
 // set to the serialized string. Always succeeds. `colors` is packed hex
@@ -67,4 +69,96 @@ void serializeInvocation(const ExpressionInvocation& inv, std::string& out);
 // parses and fires with the configured palette.
 bool parseInvocation(JsonObjectConst doc, ExpressionInvocation& out);
 
+// --- Binary wire form ---
+//
+// Compact body for MSG_COMMAND / MSG_EVENT, sent only to peers whose HELLO
+// advertised HELLO_CAP_BINARY_INVOCATION with invocationSchema ==
+// kInvocationSchemaId (everyone else keeps getting JSON). Decoding is a
+// bounded byte walk with no document allocation.
+//
+//   off  size  field
+//    0    1    kInvocationBinaryTag (a JSON body always starts with '{')
+//    1    1    type id, index into kInvocationTypeNames
+//    2    1    target
+//    3    1    colorCount N (<= kMaxBinaryInvocationColors)
+//    4   4N    colors, R G B W per color
+//  4+4N   1    paramCount M
+//    …    …    M x [ParamKey 1][value uleb128 1-5]
+//    …   1-5   delayMs, uleb128
+//
+// Bytes past delayMs are ignored, so a field can be appended without a new
+// tag. Type ids and ParamKeys index compile-time tables; kInvocationSchemaId
+// hashes both, so two builds only speak binary when their tables agree.
+constexpr uint8_t kInvocationBinaryTag = 0xB1;
+
+// Expression ids with a binary type id. An id outside this table (a variant
+// expression added without a row) still travels, as JSON.
+inline constexpr const char* kInvocationTypeNames[] = {
+  "bloom",
+  "breathing",
+  "flicker",
+  "glitchy",
+  "pulse",
+  "shifty",
+  "spotty",
+};
+inline constexpr size_t kInvocationTypeCount =
+    sizeof(kInvocationTypeNames) / sizeof(kInvocationTypeNames[0]);
+static_assert(kInvocationTypeCount < 0xFF, "type id is one byte");
+
+// More colors than this fall back to JSON; keeps the encode buffer on the stack.
+constexpr size_t kMaxBinaryInvocationColors = 16;
+// Worst-case binary body: tag/type/target/colorCount, colors, paramCount,
+// 5-byte varint per param, 5-byte varint delay.
+constexpr size_t kInvocationBinaryMaxSize =
+    4 + kMaxBinaryInvocationColors * 4 + 1 + kParamKeyCount * (1 + 5) + 5;
+
+namespace detail {
+constexpr uint32_t schemaHashString(uint32_t h, const char* s) {
+  // FNV-1a over the bytes plus the terminator, so table boundaries count.
+  while (true) {
+    h = (h ^ static_cast<uint8_t>(*s)) * 16777619u;
+    if (*s++ == '\0') return h;
+  }
+}
+constexpr uint32_t invocationSchemaId() {
+  uint32_t h = schemaHashString(2166136261u, "inv1");
+  for (const char* t : kInvocationTypeNames) h = schemaHashString(h, t);
+  for (const char* k : kParamKeyNames) h = schemaHashString(h, k);
+  return h;
+}
+}  // namespace detail
+
+// This build's binary-invocation schema id, advertised in HELLO_TLV_CAPS.
+// Changes whenever kInvocationTypeNames or kParamKeyNames does.
+inline constexpr uint32_t kInvocationSchemaId = detail::invocationSchemaId();
+static_assert(kInvocationSchemaId != 0, "0 means 'no schema' on the wire");
+
+// Type id for `type`, or 0xFF when it has none.
+inline uint8_t findInvocationTypeId(const char* type) {
+  if (!type) return 0xFF;
+  for (size_t i = 0; i < kInvocationTypeCount; i++) {
+    if (std::strcmp(kInvocationTypeNames[i], type) == 0) return static_cast<uint8_t>(i);
+  }
+  return 0xFF;
+}
+
+// Encode `inv` in the binary form into `out`. Returns bytes written, or 0 when
+// the invocation has no binary form (type outside kInvocationTypeNames, more
+// than kMaxBinaryInvocationColors colors) or `cap` is too small; the caller
+// then sends JSON.
+size_t serializeInvocationBinary(const ExpressionInvocation& inv, uint8_t* out,
+                                 size_t cap);
+
+// Decode a binary body. Returns false on a wrong tag, an unknown type id or
+// ParamKey, or a truncated field. target and delayMs get the same coercion
+// and clamp as parseInvocation.
+bool parseInvocationBinary(const uint8_t* data, size_t len,
+                           ExpressionInvocation& out);
+
+// Decode a MSG_COMMAND / MSG_EVENT body in either form, dispatching on the
+// first byte. The receive-side entry point for both drains.
+bool parseInvocationPayload(const uint8_t* data, size_t len,
+                            ExpressionInvocation& out);
+
 }  // namespace lamp
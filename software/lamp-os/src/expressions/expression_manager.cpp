@@ -14,6 +14,38 @@
 
 namespace lamp {
 
+namespace {
+
+// True when `peer` decodes this build's binary invocation form.
+bool speaksBinaryInvocation(const RosterEntry& peer) {
+  return (peer.caps & lamp_protocol::HELLO_CAP_BINARY_INVOCATION) &&
+         peer.invocationSchema == kInvocationSchemaId;
+}
+
+// One encoded MSG_COMMAND / MSG_EVENT body: binary when asked for and the
+// invocation has a binary form, JSON otherwise. The binary bytes stay on the
+// stack; only the JSON fallback touches the heap.
+struct InvocationPayload {
+  uint8_t bin[kInvocationBinaryMaxSize];
+  std::string json;
+  const uint8_t* data = nullptr;
+  size_t len = 0;
+
+  void encode(const ExpressionInvocation& inv, bool binary) {
+    len = binary ? serializeInvocationBinary(inv, bin, sizeof(bin)) : 0;
+    if (len) {
+      data = bin;
+      return;
+    }
+    json.clear();
+    serializeInvocation(inv, json);
+    data = reinterpret_cast<const uint8_t*>(json.data());
+    len = json.size();
+  }
+};
+
+}  // namespace
+
 void ExpressionManager::begin(FrameBuffer* shade, FrameBuffer* base) {
   shadeBuffer = shade;
   baseBuffer = base;
@@ -44,7 +76,7 @@ std::unique_ptr<Expression> ExpressionManager::makeExpression(
     const std::vector<Color>& colors,
     uint32_t intervalMin, uint32_t intervalMax,
     ExpressionTarget target,
-    const std::map<std::string, uint32_t>& parameters) {
+    const ParamSet& parameters) {
   const ExpressionDescriptor* d = registry_.find(type.c_str());
   if (!d || !d->make) return nullptr;
 
@@ -56,7 +88,7 @@ std::unique_ptr<Expression> ExpressionManager::makeExpression(
   }
   expr->configure(colors, intervalMin, intervalMax, target);
 
-  std::map<std::string, uint32_t> effective = parameters;
+  ParamSet effective = parameters;
   registry_.applyDefaults(*d, effective,
                           (buffer && buffer->pixelCount > 0) ? buffer->pixelCount : 1);
   expr->configureFromParameters(effective);
@@ -177,19 +209,17 @@ void ExpressionManager::maybeCascade(const ExpressionEntry& entry,
   size_t sent = 0;
   size_t dropped = 0;
   size_t overLen = 0;
+  InvocationPayload payload;
   for (size_t i = 0; i < targets.size(); ++i) {
     const uint32_t d = static_cast<uint32_t>(i + 1) * staggerMs;
     inv.delayMs = d > kMaxDelayMs ? kMaxDelayMs : d;
-    std::string json;
-    serializeInvocation(inv, json);
-    if (json.size() > lamp_protocol::COMMAND_MAX_PAYLOAD) {
+    payload.encode(inv, speaksBinaryInvocation(targets[i]));
+    if (payload.len > lamp_protocol::COMMAND_MAX_PAYLOAD) {
       ++dropped;
-      overLen = json.size();
+      overLen = payload.len;
       continue;
     }
-    meshLink_->sendCommand(targets[i].mac,
-                           reinterpret_cast<const uint8_t*>(json.data()),
-                           json.size());
+    meshLink_->sendCommand(targets[i].mac, payload.data, payload.len);
     ++sent;
   }
   // Unconditional: an over-cap invocation silently fails to cascade on
@@ -229,10 +259,17 @@ void ExpressionManager::emitEvent(const ExpressionEntry& entry) {
   inv.target = static_cast<uint8_t>(entry.expression->getTarget());
   inv.parameters = parametersWithoutCascadeKeys(entry.config.parameters);
 
-  std::string json;
-  serializeInvocation(inv, json);
-  if (json.size() > lamp_protocol::EVENT_MAX_PAYLOAD) return;
-  meshLink_->sendEvent(reinterpret_cast<const uint8_t*>(json.data()), json.size());
+  // Broadcast: binary only when every mesh peer negotiated it, so an older
+  // lamp in range still hears the announce. An empty roster is not a
+  // negotiation: until a HELLO has been heard (just after boot, or a peer
+  // that hasn't said HELLO yet), announce in JSON, which every lamp decodes.
+  const std::vector<RosterEntry>& peers = lampRoster.getMesh(LAMP_PRUNE_TIME_MS);
+  const bool binary = !peers.empty() &&
+                      std::all_of(peers.begin(), peers.end(), speaksBinaryInvocation);
+  InvocationPayload payload;
+  payload.encode(inv, binary);
+  if (payload.len > lamp_protocol::EVENT_MAX_PAYLOAD) return;
+  meshLink_->sendEvent(payload.data, payload.len);
 }
 
 std::vector<AnimatedBehavior*> ExpressionManager::getBehaviors() {
@@ -329,11 +366,11 @@ void ExpressionManager::broadcastInvocation(const ExpressionInvocation& inv,
 void ExpressionManager::sendInvocationTo(const uint8_t mac[6],
                                          const ExpressionInvocation& inv) {
   if (!meshLink_) return;
-  std::string json;
-  serializeInvocation(inv, json);
-  if (json.size() > lamp_protocol::COMMAND_MAX_PAYLOAD) return;
-  meshLink_->sendCommand(mac, reinterpret_cast<const uint8_t*>(json.data()),
-                         json.size());
+  RosterEntry peer;
+  InvocationPayload payload;
+  payload.encode(inv, lampRoster.findByMac(mac, peer) && speaksBinaryInvocation(peer));
+  if (payload.len > lamp_protocol::COMMAND_MAX_PAYLOAD) return;
+  meshLink_->sendCommand(mac, payload.data, payload.len);
 }
 
 void ExpressionManager::onExpressionFired(Expression* e) {
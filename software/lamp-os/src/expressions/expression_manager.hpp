@@ -1,7 +1,6 @@
 #pragma once
 
 #include <cstdint>
-#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -180,7 +179,7 @@ class ExpressionManager {
       const std::vector<Color>& colors,
       uint32_t intervalMin, uint32_t intervalMax,
       ExpressionTarget target,
-      const std::map<std::string, uint32_t>& parameters);
+      const ParamSet& parameters);
 
  public:
   ExpressionRegistry& registry() { return registry_; }
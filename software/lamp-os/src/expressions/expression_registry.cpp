@@ -65,6 +65,7 @@ void ExpressionRegistry::add(const ExpressionDescriptor& d) {
     }
   }
   descriptors_.push_back(&d);
+  indexDirty_ = true;
 }
 
 void ExpressionRegistry::remove(const char* id) {
@@ -74,13 +75,39 @@ void ExpressionRegistry::remove(const char* id) {
                        return std::strcmp(p->id, id) == 0;
                      }),
       descriptors_.end());
+  indexDirty_ = true;
 }
 
-const ExpressionDescriptor* ExpressionRegistry::find(const char* id) const {
-  for (const auto* p : descriptors_) {
-    if (std::strcmp(p->id, id) == 0) return p;
+// Runs once per batch of adds/removes, on the next find(); the variant sets
+// are static_asserted to have a seed at the base table size
+// (expr_catalog.hpp).
+void ExpressionRegistry::rebuildIndex() const {
+  const size_t n = descriptors_.size();
+  auto idAt = [this](size_t i) { return descriptors_[i]->id; };
+  size_t size = catalog::perfectTableSize(n);
+  uint32_t seed = catalog::findPerfectSeed(idAt, n, size);
+  while (seed == catalog::kMaxPerfectSeed) {
+    size <<= 1;
+    seed = catalog::findPerfectSeed(idAt, n, size);
+  }
+  seed_ = seed;
+  slots_.assign(size, 0);
+  const uint32_t mask = static_cast<uint32_t>(size - 1);
+  for (size_t i = 0; i < n; i++) {
+    slots_[catalog::idHash(descriptors_[i]->id, seed_) & mask] =
+        static_cast<uint8_t>(i + 1);
   }
-  return nullptr;
+  indexDirty_ = false;
+}
+
+const ExpressionDescriptor* ExpressionRegistry::find(const char* id) const {
+  if (indexDirty_) rebuildIndex();
+  if (slots_.empty() || id == nullptr) return nullptr;
+  const uint32_t mask = static_cast<uint32_t>(slots_.size() - 1);
+  const uint8_t slot = slots_[catalog::idHash(id, seed_) & mask];
+  if (slot == 0) return nullptr;
+  const ExpressionDescriptor* d = descriptors_[slot - 1];
+  return std::strcmp(d->id, id) == 0 ? d : nullptr;
 }
 
 const std::vector<const ExpressionDescriptor*>& ExpressionRegistry::all() const {
@@ -88,15 +115,15 @@ const std::vector<const ExpressionDescriptor*>& ExpressionRegistry::all() const
 }
 
 void ExpressionRegistry::applyDefaults(const ExpressionDescriptor& d,
-                                       std::map<std::string, uint32_t>& params,
+                                       ParamSet& params,
                                        uint16_t window) const {
   for (const auto& p : d.params) {
-    params.emplace(p.key, resolveBound(p.def, window));
+    params.setIfAbsent(p.key, resolveBound(p.def, window));
   }
   auto foldRange = [&params](const std::optional<RangeSpec>& r) {
     if (!r.has_value()) return;
-    if (r->minKey) params.emplace(r->minKey, static_cast<uint32_t>(r->defLo));
-    if (r->maxKey) params.emplace(r->maxKey, static_cast<uint32_t>(r->defHi));
+    if (r->minKey) params.setIfAbsent(r->minKey, static_cast<uint32_t>(r->defLo));
+    if (r->maxKey) params.setIfAbsent(r->maxKey, static_cast<uint32_t>(r->defHi));
   };
   foldRange(d.interval);
   foldRange(d.duration);
@@ -1,9 +1,9 @@
 #pragma once
 #include <cstring>
-#include <map>
 #include <string>
 #include <vector>
 
+#include "expressions/catalog_constexpr.hpp"
 #include "expressions/expression_schema.hpp"
 #include "expressions/param_utils.hpp"
 
@@ -13,7 +13,7 @@ namespace lamp {
 // the loop param follows its config value (Continuous == 1); otherwise the
 // descriptor's static continuous flag decides.
 inline bool effectiveContinuous(const ExpressionDescriptor& d,
-                                const std::map<std::string, uint32_t>& params) {
+                                const ParamSet& params) {
   for (const auto& p : d.params) {
     if (std::strcmp(p.key, kLoopParamKey) == 0) {
       return getParam(params, kLoopParamKey, 0) != 0;
@@ -24,6 +24,11 @@ inline bool effectiveContinuous(const ExpressionDescriptor& d,
 
 // Registry of ExpressionDescriptors. Holds pointers into static constexpr
 // storage; descriptors are never copied.
+//
+// find() runs on every config apply and trigger, so ids resolve through a
+// perfect hash (catalog::idHash): one hash, one strcmp. add/remove only mark
+// the index dirty; the first find() after them rebuilds it, so a burst of
+// registrations pays for one seed search.
 class ExpressionRegistry {
  public:
   // Registers d. If an entry with the same id already exists, replaces it.
@@ -36,14 +41,21 @@ class ExpressionRegistry {
   // interval/duration range defaults into their min/maxKey. Never overwrites a
   // present key.
   void applyDefaults(const ExpressionDescriptor& d,
-                     std::map<std::string, uint32_t>& params,
+                     ParamSet& params,
                      uint16_t window) const;
 
   // Returns the exprcat wire JSON: { "schemaVersion":1, "expressions":[...] }.
   std::string serializeCatalog() const;
 
  private:
+  void rebuildIndex() const;
+
   std::vector<const ExpressionDescriptor*> descriptors_;
+  // Slot -> descriptors_ index + 1 (0 = empty), so at most 255 entries;
+  // size is a power of two. Rebuilt by find() while indexDirty_.
+  mutable std::vector<uint8_t> slots_;
+  mutable uint32_t seed_ = 0;
+  mutable bool indexDirty_ = false;
 };
 
 }  // namespace lamp
@@ -83,7 +83,7 @@ class GlitchyExpression : public Expression {
    * Configure glitchy-specific parameters from generic parameter map.
    * @param parameters Map containing expression-specific parameters
    */
-  void configureFromParameters(const std::map<std::string, uint32_t>& parameters) override;
+  void configureFromParameters(const ParamSet& parameters) override;
   static const ExpressionDescriptor& classDescriptor();
   const ExpressionDescriptor& descriptor() const override;
 
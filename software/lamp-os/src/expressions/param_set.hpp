@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <utility>
+
+namespace lamp {
+
+// Interned expression parameter key: an index into kParamKeyNames. Every key
+// an ExpressionDescriptor declares (ParamSpec.key, RangeSpec min/maxKey) plus
+// the framework keys the manager and app share (zone, cascade) lives here, so
+// a parameter set is a bitmask and a value array instead of string-keyed heap
+// nodes. test_builtin_descriptors pins that every production descriptor's
+// keys resolve; a new ParamSpec key needs a row here.
+using ParamKey = uint8_t;
+inline constexpr ParamKey kNoParamKey = 0xFF;
+
+// Sorted (strcmp order) so lookup can bisect and iteration order matches the
+// std::map<std::string, uint32_t> this replaced (JSON output is unchanged).
+inline constexpr const char* kParamKeyNames[] = {
+  "breathSpeed",
+  "cascadeEnabled",
+  "cascadeStaggerMs",
+  "count",
+  "durationMax",
+  "durationMin",
+  "easing",
+  "fadeDuration",
+  "fillMode",
+  "fire",
+  "fullStrip",
+  "loop",
+  "opacity",
+  "posMax",
+  "posMin",
+  "pulseSpeed",
+  "scatter",
+  "shiftDurationMax",
+  "shiftDurationMin",
+  "size",
+  "spotSpeed",
+};
+inline constexpr size_t kParamKeyCount =
+    sizeof(kParamKeyNames) / sizeof(kParamKeyNames[0]);
+static_assert(kParamKeyCount <= 32, "ParamSet presence mask is one uint32_t");
+
+namespace detail {
+constexpr int paramKeyCompare(const char* a, const char* b) {
+  while (*a && *a == *b) { ++a; ++b; }
+  return static_cast<unsigned char>(*a) - static_cast<unsigned char>(*b);
+}
+constexpr bool paramKeysSorted() {
+  for (size_t i = 1; i < kParamKeyCount; i++) {
+    if (paramKeyCompare(kParamKeyNames[i - 1], kParamKeyNames[i]) >= 0) return false;
+  }
+  return true;
+}
+}  // namespace detail
+static_assert(detail::paramKeysSorted(), "kParamKeyNames must stay sorted and unique");
+
+// Key for `name`, or kNoParamKey. `len` bounds names that aren't
+// NUL-terminated (JSON keys); pass strlen otherwise.
+inline ParamKey findParamKey(const char* name, size_t len) {
+  if (!name) return kNoParamKey;
+  size_t lo = 0, hi = kParamKeyCount;
+  while (lo < hi) {
+    const size_t mid = (lo + hi) / 2;
+    const char* k = kParamKeyNames[mid];
+    int c = std::strncmp(k, name, len);
+    if (c == 0 && k[len] != '\0') c = 1;  // k is longer: sorts after name
+    if (c == 0) return static_cast<ParamKey>(mid);
+    if (c < 0) lo = mid + 1; else hi = mid;
+  }
+  return kNoParamKey;
+}
+inline ParamKey findParamKey(const char* name) {
+  return name ? findParamKey(name, std::strlen(name)) : kNoParamKey;
+}
+
+inline const char* paramKeyName(ParamKey k) {
+  return k < kParamKeyCount ? kParamKeyNames[k] : "";
+}
+
+// Fixed-size expression parameter set: one presence bit and one uint32_t slot
+// per interned key. No heap, trivially copyable, O(1) get/set. Keys outside
+// kParamKeyNames are refused (set() returns false) — nothing downstream of
+// configureFromParameters would read them anyway.
+class ParamSet {
+ public:
+  struct Entry {
+    ParamKey key;
+    uint32_t value;
+    const char* name() const { return paramKeyName(key); }
+  };
+
+  ParamSet() = default;
+  // Literal-friendly: ParamSet p = {{"size", 3}, {"posMin", 0}}.
+  ParamSet(std::initializer_list<std::pair<const char*, uint32_t>> init) {
+    for (const auto& kv : init) set(kv.first, kv.second);
+  }
+
+  bool set(ParamKey k, uint32_t v) {
+    if (k >= kParamKeyCount) return false;
+    values_[k] = v;
+    present_ |= bit(k);
+    return true;
+  }
+  bool set(const char* name, uint32_t v) { return set(findParamKey(name), v); }
+
+  // Insert only when absent (std::map::emplace semantics).
+  bool setIfAbsent(ParamKey k, uint32_t v) {
+    if (k >= kParamKeyCount || has(k)) return false;
+    return set(k, v);
+  }
+  bool setIfAbsent(const char* name, uint32_t v) {
+    return setIfAbsent(findParamKey(name), v);
+  }
+
+  bool has(ParamKey k) const { return k < kParamKeyCount && (present_ & bit(k)); }
+  bool has(const char* name) const { return has(findParamKey(name)); }
+
+  // Present value or nullptr.
+  const uint32_t* find(ParamKey k) const { return has(k) ? &values_[k] : nullptr; }
+  const uint32_t* find(const char* name) const { return find(findParamKey(name)); }
+
+  uint32_t get(const char* name, uint32_t fallback) const {
+    const uint32_t* v = find(name);
+    return v ? *v : fallback;
+  }
+
+  void erase(ParamKey k) {
+    if (k < kParamKeyCount) present_ &= ~bit(k);
+  }
+  void erase(const char* name) { erase(findParamKey(name)); }
+  void clear() { present_ = 0; }
+
+  bool empty() const { return present_ == 0; }
+  size_t size() const { return static_cast<size_t>(__builtin_popcount(present_)); }
+
+  bool operator==(const ParamSet& o) const {
+    if (present_ != o.present_) return false;
+    for (ParamKey k = 0; k < kParamKeyCount; k++) {
+      if (has(k) && values_[k] != o.values_[k]) return false;
+    }
+    return true;
+  }
+  bool operator!=(const ParamSet& o) const { return !(*this == o); }
+
+  // Present entries in key (alphabetical) order.
+  class const_iterator {
+   public:
+    const_iterator(const ParamSet* s, uint32_t remaining) : s_(s), rem_(remaining) {}
+    Entry operator*() const {
+      const ParamKey k = static_cast<ParamKey>(__builtin_ctz(rem_));
+      return {k, s_->values_[k]};
+    }
+    const_iterator& operator++() {
+      rem_ &= rem_ - 1;
+      return *this;
+    }
+    bool operator!=(const const_iterator& o) const { return rem_ != o.rem_; }
+    bool operator==(const const_iterator& o) const { return rem_ == o.rem_; }
+
+   private:
+    const ParamSet* s_;
+    uint32_t rem_;
+  };
+  const_iterator begin() const { return {this, present_}; }
+  const_iterator end() const { return {this, 0}; }
+
+ private:
+  static constexpr uint32_t bit(ParamKey k) { return 1u << k; }
+
+  uint32_t present_ = 0;
+  uint32_t values_[kParamKeyCount] = {};
+};
+
+}  // namespace lamp
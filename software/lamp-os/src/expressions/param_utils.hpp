@@ -2,19 +2,18 @@
 
 #include <algorithm>
 #include <cstdint>
-#include <map>
-#include <string>
 
 #ifdef LAMP_DEBUG
 #include <Arduino.h>
 #endif
 
+#include "expressions/param_set.hpp"
+
 namespace lamp {
 
-inline uint32_t getParam(const std::map<std::string, uint32_t>& params,
+inline uint32_t getParam(const ParamSet& params,
                          const char* key, uint32_t fallback) {
-  auto it = params.find(key);
-  return it != params.end() ? it->second : fallback;
+  return params.get(key, fallback);
 }
 
 // Authoritative min-gap clamp for a range pair. Raises hi to lo+minGap
@@ -29,10 +28,9 @@ inline uint32_t clampRangeHiGap(uint32_t lo, uint32_t hi,
 // Descriptor-declared keys only. applyDefaults folds every ParamSpec.key plus
 // interval/duration write-back keys into the map before configureFromParameters
 // runs, so a miss here is a schema bug, not a missing preset.
-inline uint32_t getParam(const std::map<std::string, uint32_t>& params,
+inline uint32_t getParam(const ParamSet& params,
                          const char* key) {
-  auto it = params.find(key);
-  if (it != params.end()) return it->second;
+  if (const uint32_t* v = params.find(key)) return *v;
 #ifdef LAMP_DEBUG
   Serial.printf("[param] descriptor key %s absent after applyDefaults\n", key);
 #endif
@@ -1,7 +1,7 @@
 #include "lamps/lioness/lions_scene.hpp"
 
 #include "expressions/primitives.hpp"
-#include "util/gradient.hpp"
+#include "util/gradient_cache.hpp"
 
 namespace lamp { namespace lioness {
 
@@ -13,9 +13,11 @@ void renderZone(std::vector<Color>& out, const Zone& zn,
     for (uint16_t i = 0; i < sz; ++i) out[zn.posMin + i] = mainColor;
     return;
   }
-  std::vector<Color> grad = buildGradientWithStops(static_cast<uint8_t>(sz), stops);
-  for (uint16_t i = 0; i < sz; ++i)
-    out[zn.posMin + i] = (i < grad.size()) ? grad[i] : mainColor;
+  // Rendered per frame with the same few stops: a gradient-cache hit, written
+  // straight into the zone.
+  const uint8_t n = static_cast<uint8_t>(sz);
+  renderGradient(out.data() + zn.posMin, n, stops.data(), stops.size());
+  for (uint16_t i = n; i < sz; ++i) out[zn.posMin + i] = mainColor;
 }
 
 void renderLions(std::vector<Color>& out, uint16_t windowSize,
@@ -8,9 +8,10 @@
 namespace lamp { namespace lioness {
 
 // Paint one lion zone into `out` (which must already span the zone). Empty
-// stops render solid `mainColor` (idle: mirror Main); otherwise
-// buildGradientWithStops(zoneSize, stops), with any gradient tail past its
-// length falling back to `mainColor`. Pure: no crossfade, no time.
+// stops render solid `mainColor` (idle: mirror Main); otherwise the gradient
+// of `stops` over zoneSize, expanded through the gradient cache with no
+// allocation, with any gradient tail past its length falling back to
+// `mainColor`. Pure: no crossfade, no time.
 void renderZone(std::vector<Color>& out, const Zone& zn,
                 const std::vector<Color>& stops, Color mainColor);
 
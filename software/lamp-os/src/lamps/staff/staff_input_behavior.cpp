@@ -6,7 +6,6 @@
 #include "core/behavior_context.hpp"
 #include "core/hw_config.hpp"
 #include "util/color.hpp"
-#include "util/gradient.hpp"
 
 namespace staff {
 
@@ -91,17 +90,15 @@ void StaffInputBehavior::restoreConfiguredColors() {
   auto* ctx = behaviorContext();
   if (!ctx) return;
   if (ctx->shadeConfigurator && ctx->shadeConfigurator->fb) {
-    ctx->shadeConfigurator->beginFade(
-        lamp::buildGradientWithStops(ctx->shadeConfigurator->fb->pixelCount,
-                                     config_.shade.broadcastColors()),
-        lamp::kDefaultFadeMs);
+    const auto& stops = config_.shade.broadcastColors();
+    ctx->shadeConfigurator->beginFadeToStops(stops.data(), stops.size(),
+                                             lamp::kDefaultFadeMs);
     ctx->shadeConfigurator->lastWebSocketUpdateTimeMs = millis();
   }
   if (ctx->baseConfigurator && ctx->baseConfigurator->fb) {
-    ctx->baseConfigurator->beginFade(
-        lamp::buildGradientWithStops(ctx->baseConfigurator->fb->pixelCount,
-                                     config_.base.broadcastColors()),
-        lamp::kDefaultFadeMs);
+    const auto& stops = config_.base.broadcastColors();
+    ctx->baseConfigurator->beginFadeToStops(stops.data(), stops.size(),
+                                            lamp::kDefaultFadeMs);
     ctx->baseConfigurator->lastWebSocketUpdateTimeMs = millis();
   }
 }
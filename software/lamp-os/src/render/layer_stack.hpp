@@ -2,6 +2,7 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
 
 #include "util/color.hpp"
 #include "util/eased_scalar.hpp"
@@ -37,6 +38,70 @@ class EasedColor {
   EasedScalar t_;
 };
 
+// A frame's worth of constant-weight blends, applied to whole spans of pixels.
+// Each pass is mixColorWeight(px, over, weight) rewritten as
+//   out = (px * (2^18 - f) + over * f) >> 18,  f = uint32_t(weight * 2^18)
+// which is byte-exact with mixByteLinear's signed-floor result (px * 2^18 is a
+// multiple of the divisor, so the floor only sees the (over - px) * f term).
+// The float->Q18 conversion happens once per pass, not once per pixel, and the
+// per-byte loop has no branches or lane-dependent work beyond a 4-entry
+// addend table, so compilers unroll/vectorize it.
+class SpanBlend {
+ public:
+  static constexpr size_t kMaxPasses = 5;  // wisp + LayerStack::kMaxExpressionLayers
+  static constexpr uint32_t kOne = 262144u;  // mixByteLinear's full-scale divisor
+
+  // Append `over` at `weight`, mirroring mixColorWeight's end cases: <= 0 is
+  // dropped, >= 1 replaces everything beneath it with a solid fill.
+  void add(Color over, float weight) {
+    if (weight <= 0.0f) return;
+    if (weight >= 1.0f) {
+      fill_ = true;
+      fillColor_ = over;
+      count_ = 0;
+      return;
+    }
+    if (count_ >= kMaxPasses) return;
+    const uint32_t f = static_cast<uint32_t>(weight * 262144.0f);
+    Pass& p = passes_[count_++];
+    p.keep = kOne - f;
+    p.add[0] = over.r * f;
+    p.add[1] = over.g * f;
+    p.add[2] = over.b * f;
+    p.add[3] = over.w * f;
+  }
+
+  void apply(Color* px, size_t n) const {
+    if (fill_) {
+      for (size_t i = 0; i < n; i++) px[i] = fillColor_;
+    }
+    static_assert(sizeof(Color) == 4, "span blend walks Color as 4 bytes");
+    // Color is four uint8_t; walk it as a flat r,g,b,w byte stream.
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(px);
+    const size_t len = n * 4;
+    for (size_t k = 0; k < count_; k++) {
+      const uint32_t keep = passes_[k].keep;
+      const uint32_t* add = passes_[k].add;
+      for (size_t i = 0; i < len; i += 4) {
+        bytes[i + 0] = static_cast<uint8_t>((bytes[i + 0] * keep + add[0]) >> 18);
+        bytes[i + 1] = static_cast<uint8_t>((bytes[i + 1] * keep + add[1]) >> 18);
+        bytes[i + 2] = static_cast<uint8_t>((bytes[i + 2] * keep + add[2]) >> 18);
+        bytes[i + 3] = static_cast<uint8_t>((bytes[i + 3] * keep + add[3]) >> 18);
+      }
+    }
+  }
+
+ private:
+  struct Pass {
+    uint32_t keep;    // 2^18 - f
+    uint32_t add[4];  // over channel * f, in r,g,b,w order
+  };
+  std::array<Pass, kMaxPasses> passes_{};
+  size_t count_ = 0;
+  bool fill_ = false;
+  Color fillColor_;
+};
+
 // One surface's compositing stack: own color, then the wisp layer (eased color
 // at the shared presence opacity `w`), then expression layers (each an eased
 // opacity via opacityTarget). Base and shade are two stacks sharing one `w`; the
@@ -95,6 +160,19 @@ class LayerStack {
     return out;
   }
 
+  // composite() over px[0, n) in place. Same bytes, but the frame's weights
+  // are converted to fixed point once and each layer is one pass over the
+  // span instead of a float mix per pixel per layer.
+  void compositeSpan(Color* px, size_t n) const {
+    SpanBlend blend;
+    blend.add(wisp_.value(), w_);
+    for (const ExpressionLayer& layer : expr_) {
+      if (!layer.active) continue;
+      blend.add(layer.color, layer.opacity.value());
+    }
+    blend.apply(px, n);
+  }
+
  private:
   struct ExpressionLayer {
     Color color;
@@ -1,5 +1,7 @@
+#include "gradient.hpp"
+
+#include <algorithm>
 #include <array>
-#include <cmath>
 #include <cstdint>
 #include <vector>
 
@@ -8,12 +10,6 @@
 
 namespace lamp {
 namespace {
-// Maximum number of color stops honored in buildGradientWithStops. The UI
-// caps user-selectable stops at 5; the ceiling is slightly generous so the
-// `breaks` array can live on the stack. Anything beyond this is silently
-// truncated to the first kMaxStops colors.
-constexpr uint8_t kMaxStops = 8;
-
 // In-place gradient writer: writes `steps` interpolated colors into `dst`.
 // No allocation; the caller owns the buffer.
 void calculateGradientInto(Color inColorStart, Color inColorEnd, Color* dst,
@@ -32,39 +28,45 @@ std::vector<Color> calculateGradient(Color inColorStart, Color inColorEnd,
 };
 
 std::vector<Color> buildGradientWithStops(uint8_t inNumberPixels,
-                                          std::vector<Color> inColorStops) {
-  uint8_t numberColors = inColorStops.size();
+                                          const std::vector<Color>& inColorStops) {
+  std::vector<Color> buf(inNumberPixels);
+  writeGradientWithStops(buf.data(), inNumberPixels, inColorStops.data(),
+                         inColorStops.size());
+  return buf;
+}
 
+void writeGradientWithStops(Color* outPixels, uint8_t inNumberPixels,
+                            const Color* inColorStops, size_t inNumberStops) {
   // input color stops are empty
-  if (numberColors < 1) {
-    return std::vector<Color>{inNumberPixels, Color()};
+  if (inNumberStops < 1) {
+    std::fill(outPixels, outPixels + inNumberPixels, Color());
+    return;
   }
 
-  // single color - return a uniform pixel buffer
-  if (numberColors == 1) {
-    return std::vector<Color>{inNumberPixels, inColorStops[0]};
+  // single color - a uniform pixel buffer
+  if (inNumberStops == 1) {
+    std::fill(outPixels, outPixels + inNumberPixels, inColorStops[0]);
+    return;
   }
 
   // Clamp to the compile-time ceiling so `breaks` can live on the stack.
-  if (numberColors > kMaxStops) {
-    numberColors = kMaxStops;
-  }
+  const uint8_t numberColors = static_cast<uint8_t>(
+      std::min<size_t>(inNumberStops, kMaxGradientStops));
 
-  // two colors - return a single gradient (allocate exactly once via resize)
+  // two colors - a single gradient
   if (numberColors == 2) {
-    std::vector<Color> buf(inNumberPixels);
-    calculateGradientInto(inColorStops[0], inColorStops[1], buf.data(),
+    calculateGradientInto(inColorStops[0], inColorStops[1], outPixels,
                           inNumberPixels);
-    return buf;
+    return;
   }
 
   // multiple colors - use integer math to calculate an even fit for all the
   // stops
-  uint8_t steps = floor(inNumberPixels / (numberColors - 1));
+  uint8_t steps = inNumberPixels / (numberColors - 1);
   uint8_t remainder = inNumberPixels % (numberColors - 1);
 
-  // Stack-allocated breakpoints: bounded by kMaxStops - 1.
-  std::array<uint8_t, kMaxStops - 1> breaks{};
+  // Stack-allocated breakpoints: bounded by kMaxGradientStops - 1.
+  std::array<uint8_t, kMaxGradientStops - 1> breaks{};
   const uint8_t numBreaks = numberColors - 1;
   for (uint8_t i = 0; i < numBreaks; i++) {
     breaks[i] = steps;
@@ -82,17 +84,12 @@ std::vector<Color> buildGradientWithStops(uint8_t inNumberPixels,
     }
   }
 
-  // with all the breakpoints identified, build the gradients in place. No
-  // per-stop allocation, one resize on `buf`.
-  std::vector<Color> buf;
-  buf.resize(inNumberPixels);
+  // with all the breakpoints identified, build the gradients in place.
   size_t offset = 0;
   for (uint8_t i = 0; i < numBreaks; i++) {
     calculateGradientInto(inColorStops[i], inColorStops[i + 1],
-                          buf.data() + offset, breaks[i]);
+                          outPixels + offset, breaks[i]);
     offset += breaks[i];
   }
-
-  return buf;
-};
+}
 }  // namespace lamp
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -7,6 +8,12 @@
 #include "fade.hpp"
 
 namespace lamp {
+// Maximum number of color stops honored by the gradient builders. The UI caps
+// user-selectable stops at 5; the ceiling is slightly generous so the
+// breakpoints can live on the stack. Anything beyond this is silently
+// truncated to the first kMaxGradientStops colors.
+constexpr uint8_t kMaxGradientStops = 8;
+
 /**
  * make a smooth gradient from one color to another
  * @param [in] inColorStart - the start color
@@ -25,5 +32,15 @@ std::vector<Color> calculateGradient(Color inColorStart, Color inColorEnd,
  * @return gradiented colors for the total strip length specified
  */
 std::vector<Color> buildGradientWithStops(uint8_t inNumberPixels,
-                                          std::vector<Color> inColorStops);
+                                          const std::vector<Color>& inColorStops);
+
+/**
+ * buildGradientWithStops into a caller-owned span; no allocation
+ * @param [out] outPixels inNumberPixels colors are written here
+ * @param [in] inNumberPixels the total Neopixel count to spread the gradient
+ * @param [in] inColorStops the user colors to fade between
+ * @param [in] inNumberStops count of inColorStops
+ */
+void writeGradientWithStops(Color* outPixels, uint8_t inNumberPixels,
+                            const Color* inColorStops, size_t inNumberStops);
 }  // namespace lamp
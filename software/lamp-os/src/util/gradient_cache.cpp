@@ -0,0 +1,97 @@
+#include "gradient_cache.hpp"
+
+#include <algorithm>
+
+namespace lamp {
+
+namespace {
+// FNV-1a over the pixel count and the stop bytes.
+uint32_t hashKey(const Color* stops, uint8_t numStops, uint8_t numPixels) {
+  uint32_t h = 2166136261u;
+  auto mix = [&h](uint8_t b) { h = (h ^ b) * 16777619u; };
+  mix(numPixels);
+  for (uint8_t i = 0; i < numStops; i++) {
+    mix(stops[i].r);
+    mix(stops[i].g);
+    mix(stops[i].b);
+    mix(stops[i].w);
+  }
+  return h;
+}
+}  // namespace
+
+GradientCache::Slot* GradientCache::find(uint32_t hash, const Color* stops,
+                                         uint8_t numStops, uint8_t numPixels) {
+  for (Slot& s : slots_) {
+    if (s.lastUse == 0 || s.hash != hash || s.numPixels != numPixels ||
+        s.numStops != numStops) {
+      continue;
+    }
+    if (std::equal(stops, stops + numStops, s.stops.begin())) return &s;
+  }
+  return nullptr;
+}
+
+GradientCache::Slot& GradientCache::place(uint8_t numPixels) {
+  if (head_ + numPixels > kArenaPixels) head_ = 0;
+  const uint16_t begin = head_;
+  const uint16_t end = begin + numPixels;
+  head_ = end;
+
+  Slot* victim = nullptr;
+  for (Slot& s : slots_) {
+    if (s.lastUse == 0) continue;
+    if (s.offset < end && begin < s.offset + s.numPixels) s.lastUse = 0;
+  }
+  for (Slot& s : slots_) {
+    if (!victim || s.lastUse < victim->lastUse) victim = &s;
+  }
+  victim->offset = begin;
+  victim->numPixels = numPixels;
+  return *victim;
+}
+
+const Color* GradientCache::get(const Color* stops, size_t numStops,
+                                uint8_t numPixels) {
+  // writeGradientWithStops ignores stops past the ceiling, so they don't key.
+  const uint8_t n =
+      static_cast<uint8_t>(std::min<size_t>(numStops, kMaxGradientStops));
+  const uint32_t hash = hashKey(stops, n, numPixels);
+  if (Slot* s = find(hash, stops, n, numPixels)) {
+    s->lastUse = ++useClock_;
+    hits_++;
+    return arena_.data() + s->offset;
+  }
+  misses_++;
+  Slot& s = place(numPixels);
+  s.hash = hash;
+  s.numStops = n;
+  std::copy(stops, stops + n, s.stops.begin());
+  s.lastUse = ++useClock_;
+  writeGradientWithStops(arena_.data() + s.offset, numPixels, stops, n);
+  return arena_.data() + s.offset;
+}
+
+void GradientCache::render(Color* dst, uint8_t numPixels, const Color* stops,
+                           size_t numStops) {
+  // Empty and solid fills are cheaper than a lookup; keep them out of the
+  // arena.
+  if (numStops <= 1) {
+    writeGradientWithStops(dst, numPixels, stops, numStops);
+    return;
+  }
+  const Color* src = get(stops, numStops, numPixels);
+  std::copy(src, src + numPixels, dst);
+}
+
+void GradientCache::clear() {
+  for (Slot& s : slots_) s.lastUse = 0;
+  head_ = 0;
+}
+
+GradientCache& gradientCache() {
+  static GradientCache cache;
+  return cache;
+}
+
+}  // namespace lamp
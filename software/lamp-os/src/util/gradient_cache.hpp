@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "color.hpp"
+#include "gradient.hpp"
+
+namespace lamp {
+
+// Content-addressed cache of expanded gradients: (stops, pixel count) maps
+// to a span in a fixed arena, so a repeat expansion (a configurator re-fade,
+// a lion zone re-rendered each frame, a picker drag that revisits a color)
+// is a copy instead of a per-pixel fadeLinear walk, and no call allocates.
+// Spans are placed round-robin through the arena; a new span evicts the
+// entries it overlaps, else the least recently used slot.
+//
+// Not thread-safe: Core 1 (loop task) only, like the configurators and
+// drains that call it.
+class GradientCache {
+ public:
+  static constexpr size_t kSlots = 8;
+  // Shade + base + lion zones of the largest variant, with room to spare.
+  static constexpr size_t kArenaPixels = 512;
+
+  // The expanded gradient, valid until the next get()/render(). Same bytes
+  // as writeGradientWithStops.
+  const Color* get(const Color* stops, size_t numStops, uint8_t numPixels);
+
+  // Copy the expanded gradient into `dst` (numPixels colors).
+  void render(Color* dst, uint8_t numPixels, const Color* stops,
+              size_t numStops);
+
+  void clear();
+
+  uint32_t hits() const { return hits_; }
+  uint32_t misses() const { return misses_; }
+
+ private:
+  struct Slot {
+    uint32_t hash = 0;
+    uint32_t lastUse = 0;  // 0 = empty
+    uint16_t offset = 0;
+    uint8_t numPixels = 0;
+    uint8_t numStops = 0;
+    std::array<Color, kMaxGradientStops> stops{};
+  };
+
+  Slot* find(uint32_t hash, const Color* stops, uint8_t numStops,
+             uint8_t numPixels);
+  Slot& place(uint8_t numPixels);
+
+  std::array<Slot, kSlots> slots_{};
+  std::array<Color, kArenaPixels> arena_{};
+  uint16_t head_ = 0;
+  uint32_t useClock_ = 0;
+  uint32_t hits_ = 0;
+  uint32_t misses_ = 0;
+};
+
+// The firmware's shared instance (Core 1).
+GradientCache& gradientCache();
+
+// writeGradientWithStops through gradientCache().
+inline void renderGradient(Color* dst, uint8_t numPixels, const Color* stops,
+                           size_t numStops) {
+  gradientCache().render(dst, numPixels, stops, numStops);
+}
+
+}  // namespace lamp
@@ -0,0 +1,191 @@
+#include "util/metrics.hpp"
+
+#include <cstring>
+
+namespace lamp::metrics {
+
+void Gauge::set(int32_t v) {
+  v_.store(v, std::memory_order_relaxed);
+  if (!seen_) {
+    min_ = max_ = v;
+    seen_ = true;
+    return;
+  }
+  if (v < min_) min_ = v;
+  if (v > max_) max_ = v;
+}
+
+void Gauge::resetWindow() {
+  const int32_t v = value();
+  min_ = max_ = v;
+}
+
+// 0..7 get a bucket each; above that each power of two splits in quarters
+// on the two bits below the leading one: [8,10) [10,12) [12,14) [14,16)
+// [16,20) ...
+size_t Histogram::bucketFor(uint32_t v) {
+  if (v < 8) return v;
+  const uint32_t msb = 31 - static_cast<uint32_t>(__builtin_clz(v));
+  const uint32_t quarter = (v >> (msb - 2)) & 3;
+  const size_t b = 8 + (msb - 3) * 4 + quarter;
+  return b < kBuckets ? b : kBuckets - 1;
+}
+
+uint32_t Histogram::bucketUpper(size_t b) {
+  if (b < 8) return static_cast<uint32_t>(b);
+  if (b >= kBuckets - 1) return UINT32_MAX;
+  const uint32_t msb = static_cast<uint32_t>((b - 8) / 4 + 3);
+  const uint32_t quarter = static_cast<uint32_t>((b - 8) % 4);
+  // Exclusive top of the bucket, less one.
+  return ((5 + quarter) << (msb - 2)) - 1;
+}
+
+void Histogram::record(uint32_t v) {
+  buckets_[bucketFor(v)]++;
+  if (count_ == 0 || v < min_) min_ = v;
+  if (v > max_) max_ = v;
+  count_++;
+}
+
+uint32_t Histogram::percentileOf(const std::array<uint32_t, kBuckets>& buckets,
+                                 uint32_t count, uint8_t pct) {
+  if (count == 0) return 0;
+  if (pct > 100) pct = 100;
+  // Rank of the sample the percentile lands on, 1-based, rounded up.
+  const uint64_t rank = (static_cast<uint64_t>(count) * pct + 99) / 100;
+  const uint64_t want = rank ? rank : 1;
+  uint64_t seen = 0;
+  for (size_t b = 0; b < kBuckets; b++) {
+    seen += buckets[b];
+    if (seen >= want) return bucketUpper(b);
+  }
+  return bucketUpper(kBuckets - 1);
+}
+
+uint32_t Histogram::percentile(uint8_t pct) const {
+  if (count_ == 0) return 0;
+  const uint32_t upper = percentileOf(buckets_, count_, pct);
+  return upper < max_ ? upper : max_;
+}
+
+void Histogram::resetWindow() {
+  buckets_.fill(0);
+  count_ = 0;
+  min_ = 0;
+  max_ = 0;
+  generation_++;
+}
+
+const Registry::Entry* Registry::findEntry(Kind kind, const char* name) const {
+  for (size_t i = 0; i < entryCount_; i++) {
+    const Entry& e = entries_[i];
+    if (e.kind == kind && strcmp(e.name, name) == 0) return &e;
+  }
+  return nullptr;
+}
+
+bool Registry::addEntry(Kind kind, uint8_t index, const char* name) {
+  if (entryCount_ >= kMaxEntries) return false;
+  entries_[entryCount_++] = Entry{kind, index, name};
+  return true;
+}
+
+Counter& Registry::counter(const char* name) {
+  if (const Entry* e = findEntry(Kind::Counter, name)) return counters_[e->index];
+  if (counterCount_ >= kMaxCounters || !addEntry(Kind::Counter, counterCount_, name)) {
+    return overflowCounter_;
+  }
+  return counters_[counterCount_++];
+}
+
+Gauge& Registry::gauge(const char* name) {
+  if (const Entry* e = findEntry(Kind::Gauge, name)) return gauges_[e->index];
+  if (gaugeCount_ >= kMaxGauges || !addEntry(Kind::Gauge, gaugeCount_, name)) {
+    return overflowGauge_;
+  }
+  return gauges_[gaugeCount_++];
+}
+
+Histogram& Registry::histogram(const char* name) {
+  if (const Entry* e = findEntry(Kind::Histogram, name)) return histograms_[e->index];
+  if (histogramCount_ >= kMaxHistograms ||
+      !addEntry(Kind::Histogram, histogramCount_, name)) {
+    return overflowHistogram_;
+  }
+  return histograms_[histogramCount_++];
+}
+
+namespace {
+
+struct Writer {
+  uint8_t* out;
+  size_t cap;
+  size_t len = 0;
+  bool ok = true;
+
+  void u8(uint8_t v) {
+    if (len + 1 > cap) {
+      ok = false;
+      return;
+    }
+    out[len++] = v;
+  }
+  void u32(uint32_t v) {
+    for (int i = 0; i < 4; i++) u8(static_cast<uint8_t>(v >> (8 * i)));
+  }
+  void i32(int32_t v) { u32(static_cast<uint32_t>(v)); }
+  void bytes(const char* s, size_t n) {
+    for (size_t i = 0; i < n; i++) u8(static_cast<uint8_t>(s[i]));
+  }
+};
+
+}  // namespace
+
+size_t Registry::writeSnapshot(uint8_t* out, size_t cap, uint32_t uptimeMs) const {
+  Writer w{out, cap};
+  w.u8(kSnapshotVersion);
+  w.u8(entryCount_);
+  w.u32(uptimeMs);
+  for (size_t i = 0; i < entryCount_; i++) {
+    const Entry& e = entries_[i];
+    size_t nameLen = strlen(e.name);
+    if (nameLen > kMaxNameLen) nameLen = kMaxNameLen;
+    w.u8(static_cast<uint8_t>(e.kind));
+    w.u8(static_cast<uint8_t>(nameLen));
+    w.bytes(e.name, nameLen);
+    switch (e.kind) {
+      case Kind::Counter:
+        w.u32(counters_[e.index].value());
+        break;
+      case Kind::Gauge: {
+        const Gauge& g = gauges_[e.index];
+        w.i32(g.value());
+        w.i32(g.min());
+        w.i32(g.max());
+        break;
+      }
+      case Kind::Histogram: {
+        const Histogram& h = histograms_[e.index];
+        w.u32(h.count());
+        w.u32(h.min());
+        w.u32(h.percentile(50));
+        w.u32(h.percentile(99));
+        w.u32(h.max());
+        break;
+      }
+    }
+  }
+  return w.ok ? w.len : 0;
+}
+
+void Registry::resetWindow() {
+  for (size_t i = 0; i < gaugeCount_; i++) gauges_[i].resetWindow();
+  for (size_t i = 0; i < histogramCount_; i++) histograms_[i].resetWindow();
+}
+
+Registry& registry() {
+  static Registry r;
+  return r;
+}
+
+}  // namespace lamp::metrics
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace lamp::metrics {
+
+// Fixed-memory metrics registry: counters, gauges and log-bucketed
+// histograms that subsystems register into by name at boot and update from
+// their hot paths without allocating or locking. One binary snapshot
+// (writeSnapshot) serves the `metrics` BLE page section, so the app can see
+// which lamps in an install are dropping frames without a USB cable; the
+// serial `metrics.get` bench command prints the same values as text.
+//
+// Registration is boot-time, Core 1 only (setup / begin paths). Updates:
+// Counter is any-core (relaxed atomic); Gauge and Histogram have a single
+// writer each. Snapshot readers on another core may see a histogram
+// mid-update; the values are diagnostics, not invariants.
+
+enum class Kind : uint8_t { Counter = 1, Gauge = 2, Histogram = 3 };
+
+inline constexpr size_t kMaxNameLen = 15;
+
+// Monotonic event count since boot.
+class Counter {
+ public:
+  void add(uint32_t n = 1) { v_.fetch_add(n, std::memory_order_relaxed); }
+  uint32_t value() const { return v_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<uint32_t> v_{0};
+};
+
+// Last level written, with its low and high water since the last
+// resetWindow().
+class Gauge {
+ public:
+  void set(int32_t v);
+  int32_t value() const { return v_.load(std::memory_order_relaxed); }
+  int32_t min() const { return min_; }
+  int32_t max() const { return max_; }
+  void resetWindow();
+
+ private:
+  std::atomic<int32_t> v_{0};
+  int32_t min_ = 0;
+  int32_t max_ = 0;
+  bool seen_ = false;
+};
+
+// Distribution of non-negative samples (microseconds, bytes, ...) in four
+// buckets per power of two, so a percentile is within 25% of the true
+// value. Samples at or past 2^20 share the top bucket; min/max stay exact.
+class Histogram {
+ public:
+  static constexpr size_t kBuckets = 77;
+
+  void record(uint32_t v);
+  uint32_t count() const { return count_; }
+  uint32_t min() const { return count_ ? min_ : 0; }
+  uint32_t max() const { return max_; }
+  // Bumped by every resetWindow(), so a reader diffing buckets() copies
+  // can tell its baseline was emptied under it.
+  uint32_t generation() const { return generation_; }
+  // Upper edge of the bucket holding the pct-th percentile sample, clamped
+  // to max(). 0 when empty.
+  uint32_t percentile(uint8_t pct) const;
+  void resetWindow();
+
+  const std::array<uint32_t, kBuckets>& buckets() const { return buckets_; }
+
+  static size_t bucketFor(uint32_t v);
+  static uint32_t bucketUpper(size_t b);
+  // Upper bucket edge of the pct-th percentile over `buckets` holding
+  // `count` samples (a window's difference of two buckets() copies, say).
+  static uint32_t percentileOf(const std::array<uint32_t, kBuckets>& buckets,
+                               uint32_t count, uint8_t pct);
+
+ private:
+  std::array<uint32_t, kBuckets> buckets_{};
+  uint32_t count_ = 0;
+  uint32_t min_ = 0;
+  uint32_t max_ = 0;
+  uint32_t generation_ = 0;
+};
+
+// Snapshot wire format (little-endian), version 1:
+//   u8 version, u8 entryCount, u32 uptimeMs, then per entry in
+//   registration order:
+//   u8 kind, u8 nameLen, name bytes, payload
+//     Counter:   u32 value
+//     Gauge:     i32 value, i32 min, i32 max
+//     Histogram: u32 count, u32 min, u32 p50, u32 p99, u32 max
+inline constexpr uint8_t kSnapshotVersion = 1;
+
+class Registry {
+ public:
+  static constexpr size_t kMaxCounters = 12;
+  static constexpr size_t kMaxGauges = 8;
+  static constexpr size_t kMaxHistograms = 6;
+  static constexpr size_t kMaxEntries = kMaxCounters + kMaxGauges + kMaxHistograms;
+  static constexpr size_t kMaxSnapshotBytes =
+      6 + kMaxCounters * (2 + kMaxNameLen + 4) + kMaxGauges * (2 + kMaxNameLen + 12) +
+      kMaxHistograms * (2 + kMaxNameLen + 20);
+
+  // Register `name` (a string literal; truncated to kMaxNameLen on the wire)
+  // or return the metric already registered under it. Past capacity the
+  // caller gets a shared sink that is never reported, so hot paths never
+  // null-check.
+  Counter& counter(const char* name);
+  Gauge& gauge(const char* name);
+  Histogram& histogram(const char* name);
+
+  size_t size() const { return entryCount_; }
+
+  // Serialises every registered metric. Returns bytes written, 0 when `cap`
+  // is too small.
+  size_t writeSnapshot(uint8_t* out, size_t cap, uint32_t uptimeMs) const;
+
+  // Starts a new window: histograms empty, gauge min/max collapse to the
+  // current value. Counters run for the boot.
+  void resetWindow();
+
+  // Visits entries in registration order: fn(kind, name, index) where
+  // index addresses counterAt / gaugeAt / histogramAt.
+  template <class Fn>
+  void forEach(Fn&& fn) const {
+    for (size_t i = 0; i < entryCount_; i++) {
+      fn(entries_[i].kind, entries_[i].name, entries_[i].index);
+    }
+  }
+  const Counter& counterAt(size_t i) const { return counters_[i]; }
+  const Gauge& gaugeAt(size_t i) const { return gauges_[i]; }
+  const Histogram& histogramAt(size_t i) const { return histograms_[i]; }
+
+ private:
+  struct Entry {
+    Kind kind;
+    uint8_t index;
+    const char* name;
+  };
+
+  const Entry* findEntry(Kind kind, const char* name) const;
+  bool addEntry(Kind kind, uint8_t index, const char* name);
+
+  std::array<Counter, kMaxCounters> counters_{};
+  std::array<Gauge, kMaxGauges> gauges_{};
+  std::array<Histogram, kMaxHistograms> histograms_{};
+  std::array<Entry, kMaxEntries> entries_{};
+  uint8_t entryCount_ = 0;
+  uint8_t counterCount_ = 0;
+  uint8_t gaugeCount_ = 0;
+  uint8_t histogramCount_ = 0;
+  Counter overflowCounter_;
+  Gauge overflowGauge_;
+  Histogram overflowHistogram_;
+};
+
+// The firmware's registry.
+Registry& registry();
+
+}  // namespace lamp::metrics
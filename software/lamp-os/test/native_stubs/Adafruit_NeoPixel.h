@@ -3,6 +3,7 @@
 // frame_buffer.cpp to compile and for tests to observe driver call sequences.
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <vector>
 
 // NEO_* pixel format constants (values match the real Adafruit library).
@@ -24,12 +25,21 @@ class Adafruit_NeoPixel {
     return (uint8_t)(pow(v / 255.0, 2.6) * 255 + 0.5);
   }
 
+  // reset() fills the pixel array with this byte so tests can tell which
+  // pixels a flush wrote through getPixels().
+  static constexpr uint8_t kUnwritten = 0xA5;
+  static constexpr uint16_t kMaxPixels = 256;
+
   bool canShowResult = true;
-  uint8_t brightness = 0;
+  // A fresh real driver reads back 255 (no scaling) until setBrightness.
+  uint8_t brightness = 255;
   std::vector<PixelCall> pixelCalls;
   int showCount = 0;
   int beginCount = 0;
   int fillCount = 0;
+  uint8_t pixels[kMaxPixels * 4];
+
+  Adafruit_NeoPixel() { std::memset(pixels, kUnwritten, sizeof(pixels)); }
 
   bool begin() { ++beginCount; return true; }
   void fill(uint32_t = 0, uint16_t = 0, uint16_t = 0) { ++fillCount; }
@@ -37,9 +47,23 @@ class Adafruit_NeoPixel {
   void setPixelColor(uint16_t n, uint32_t c) { pixelCalls.push_back({n, c}); }
   bool canShow() { return canShowResult; }
   uint8_t getBrightness() const { return brightness; }
+  void setBrightness(uint8_t b) { brightness = b; }
+  uint8_t* getPixels() { return pixels; }
+
+  // Pixels in [0, count) written since the last reset(), at `bytesPerPixel`.
+  uint16_t writtenPixels(uint16_t count, uint8_t bytesPerPixel) const {
+    uint16_t n = 0;
+    for (uint16_t i = 0; i < count; i++) {
+      for (uint8_t k = 0; k < bytesPerPixel; k++) {
+        if (pixels[i * bytesPerPixel + k] != kUnwritten) { ++n; break; }
+      }
+    }
+    return n;
+  }
 
   void reset() {
     pixelCalls.clear();
     showCount = 0;
+    std::memset(pixels, kUnwritten, sizeof(pixels));
   }
 };
@@ -0,0 +1,342 @@
+#pragma once
+
+// Lossy-link model of a mesh OTA session, shared by the OTA simulation tests.
+//
+// A millisecond clock runs FirmwareDistributor's stream cursor (smart-rewind
+// resume, exact-hole queue, a group's merged queue and late-member replay,
+// DONE retries) against one or more FirmwareReceivers (bitmap, stall
+// watchdog, DONE-time gap REQ), each behind its own Gilbert-Elliott channel
+// used in both directions. REQ frames go through the real fw_ota.hpp codec
+// and the hole bookkeeping is the production req_holes.cpp, which the
+// including test compiles in.
+//
+// Chunks are indices, not bytes. A test that carries payload (repair rows,
+// image bytes) derives from Sender and Receiver and hides the hooks it needs;
+// runSession is a template, so the derived members are the ones it calls.
+
+#include <unity.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "components/firmware/req_holes.hpp"
+#include "components/network/protocol/lamp_protocol.hpp"
+
+namespace ota_sim {
+
+namespace lp = lamp_protocol;
+
+inline void setBit(std::vector<uint8_t>& bitmap, size_t idx) {
+  bitmap[idx / 8] |= static_cast<uint8_t>(1u << (idx % 8));
+}
+
+inline bool hasBit(const std::vector<uint8_t>& bitmap, size_t idx) {
+  return (bitmap[idx / 8] >> (idx % 8)) & 1u;
+}
+
+// xorshift32; fixed seeds keep every run deterministic.
+struct Rng {
+  uint32_t s;
+  uint32_t next() {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+  }
+  bool chance(uint32_t permille) { return next() % 1000 < permille; }
+};
+
+// Gilbert-Elliott channel: mostly-clean air with BLE-coex bursts, per frame.
+// ~7% average loss, clustered the way the bench logs show it.
+struct Channel {
+  Rng rng;
+  bool bad = false;
+  bool drops() {
+    bad = bad ? !rng.chance(250) : rng.chance(20);
+    return rng.chance(bad ? 600 : 30);
+  }
+};
+
+constexpr uint32_t kChunkStallReqMs     = 2000;  // FirmwareReceiver
+constexpr uint32_t kDoneRetryIntervalMs = 300;   // FirmwareDistributor
+constexpr uint8_t  kMaxDoneRetries      = 4;
+constexpr uint32_t kGroupGatherMs       = 3000;
+constexpr uint32_t kSessionCapMs        = 20u * 60u * 1000u;
+
+const uint8_t kSender[6]   = {0x10, 0x11, 0x12, 0x13, 0x14, 0x15};
+const uint8_t kReceiver[6] = {0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5};
+
+struct SessionStats {
+  bool     complete = false;
+  bool     intact = false;     // set by tests that carry bytes
+  uint32_t elapsedMs = 0;
+  uint32_t frames = 0;         // chunks + repair rows on air
+  uint32_t chunks = 0;
+  uint32_t repairs = 0;
+  uint32_t duplicates = 0;     // chunks a receiver already held
+  uint32_t rebuilt = 0;        // set by tests that decode repair rows
+  uint32_t reqs = 0;
+};
+
+// Distributor: FirmwareDistributor::onReq's cursor handling, streamOneChunk's
+// advance, and the group drain's replay for members that accepted late.
+struct Sender {
+  uint16_t total;
+  bool     group;
+  uint16_t next = 0;
+  uint16_t resume = 0;
+  uint16_t reqEnd = 0;
+  uint16_t lateJoinEnd = 0;
+  lamp::ReqHoleQueue holes;
+  bool finalizing = false;
+
+  explicit Sender(uint16_t n, bool isGroup = false) : total(n), group(isGroup) {}
+
+  void onReq(const lp::ParsedFwReq& r) {
+    if (r.firstChunkIdx >= total) return;
+    // A group serves every member from one hole queue, so a run REQ joins it
+    // as the mask of its run.
+    uint8_t runMask[lp::FW_REQ_MASK_MAX_BYTES] = {0};
+    const uint8_t* mask = r.mask;
+    size_t maskLen = r.maskLen;
+    if (group && maskLen == 0) {
+      const size_t run = std::min<size_t>(r.chunkCount, lp::FW_REQ_MASK_MAX_CHUNKS);
+      for (size_t i = 0; i < run; ++i) runMask[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+      mask = runMask;
+      maskLen = (run + 7) / 8;
+    }
+    const uint16_t forward = resume != 0 ? resume : next;
+    const bool wasQueued = holes.active();
+    const bool queued =
+        maskLen != 0 &&
+        (group ? holes.merge(r.firstChunkIdx, mask, maskLen, forward, total)
+               : holes.load(r.firstChunkIdx, mask, maskLen, forward, total));
+    if (queued) {
+      if (!group || !wasQueued) {
+        resume = forward;
+        reqEnd = 0;
+        next = holes.front();
+      }
+    } else if (!group) {
+      holes.clear();
+      const uint16_t end = r.firstChunkIdx + r.chunkCount;
+      if (resume == 0 && next > end) {
+        resume = next;
+        reqEnd = end;
+      } else if (resume != 0 && end > reqEnd) {
+        reqEnd = end;
+      }
+      next = r.firstChunkIdx;
+    }
+    finalizing = false;
+  }
+
+  void lateAccept() {
+    const uint16_t forward = resume != 0 ? resume : next;
+    lateJoinEnd = std::max(lateJoinEnd, forward);
+    finalizing = false;
+  }
+
+  // At the end of the stream: true to finalize, false when a replay for late
+  // members starts instead.
+  bool drain() {
+    if (lateJoinEnd == 0) return true;
+    resume = total;
+    reqEnd = lateJoinEnd;
+    next = 0;
+    lateJoinEnd = 0;
+    return false;
+  }
+
+  void sent(uint16_t chunkIdx) {
+    next = chunkIdx + 1;
+    uint16_t hole = 0;
+    if (holes.active()) {
+      if (holes.served(chunkIdx, hole)) {
+        next = hole;
+      } else if (resume != 0) {
+        next = resume;
+        resume = 0;
+        reqEnd = 0;
+      }
+    } else if (resume != 0 && next >= reqEnd && next < resume) {
+      next = resume;
+      resume = 0;
+      reqEnd = 0;
+    }
+  }
+
+  // Repair rows go out ahead of the next chunk while any are due.
+  bool repairDue() const { return false; }
+  size_t buildRepair(uint8_t*, size_t, uint16_t) { return 0; }
+};
+
+// Receiver: FirmwareReceiver's bitmap and REQ triggers.
+struct Receiver {
+  size_t total;
+  bool useMask;
+  uint8_t mac[6];
+  std::vector<uint8_t> bitmap;
+  uint32_t unique = 0;
+  uint32_t acceptMs = 0;
+  bool accepted = false;
+  uint32_t lastChunkMs = 0;
+  uint32_t lastReqMs = 0;
+  uint16_t seq = 0;
+
+  explicit Receiver(size_t n, bool mask = true, uint8_t id = kReceiver[5])
+      : total(n), useMask(mask),
+        mac{kReceiver[0], kReceiver[1], kReceiver[2], kReceiver[3], kReceiver[4], id},
+        bitmap((n + 7) / 8, 0) {}
+
+  bool full() const { return unique == total; }
+
+  // Marks idx held; false when it already was.
+  bool mark(uint16_t idx, uint32_t nowMs) {
+    lastChunkMs = nowMs;
+    if (hasBit(bitmap, idx)) return false;
+    setBit(bitmap, idx);
+    unique++;
+    return true;
+  }
+
+  // Hooks runSession calls: a chunk that got through, a repair row that got
+  // through, every millisecond while accepted, and on a DONE before the
+  // bitmap is judged.
+  bool onChunk(uint16_t idx, uint32_t nowMs) { return mark(idx, nowMs); }
+  void onRepair(const uint8_t*, size_t) {}
+  void tick(uint32_t) {}
+  void onDone(uint32_t) {}
+
+  uint16_t firstMissing() const {
+    for (size_t i = 0; i < total; ++i) {
+      if (!hasBit(bitmap, i)) return static_cast<uint16_t>(i);
+    }
+    return UINT16_MAX;
+  }
+
+  // Serialises the REQ the firmware would send now.
+  size_t buildReq(uint8_t* buf, size_t cap, lp::FwReqReason reason) {
+    const uint16_t first = firstMissing();
+    if (first == UINT16_MAX) return 0;
+    const uint16_t run = lamp::missingRunLen(bitmap.data(), bitmap.size(), total, first,
+                                             lp::FW_MAX_REQ_RUN_CHUNKS);
+    if (useMask) {
+      uint8_t mask[lp::FW_REQ_MASK_MAX_BYTES];
+      const size_t len = lamp::missingMask(bitmap.data(), bitmap.size(), total, first,
+                                           mask, sizeof(mask));
+      return lp::buildFwReqMask(buf, cap, seq++, mac, kSender, first, run, reason,
+                                mask, len);
+    }
+    return lp::buildFwReq(buf, cap, seq++, mac, kSender, first, run, reason);
+  }
+};
+
+// One stream from tx to every receiver in rx, each behind air[i]. Streaming
+// starts at startMs; a receiver accepts at its acceptMs, and one that accepts
+// after the start joins mid-stream.
+template <class Tx, class Rx>
+SessionStats runSession(Tx& tx, std::vector<Rx>& rx, std::vector<Channel>& air,
+                        uint32_t spacingMs, uint32_t startMs = 0) {
+  SessionStats st;
+  uint32_t nextSendMs = 0;
+  uint32_t lastDoneMs = 0;
+  uint8_t doneRetries = 0;
+  uint16_t txSeq = 0;
+
+  auto deliverReq = [&](size_t i, uint32_t nowMs, lp::FwReqReason reason) {
+    uint8_t buf[lp::FW_REQ_MASK_MAX_SIZE];
+    const size_t n = rx[i].buildReq(buf, sizeof(buf), reason);
+    TEST_ASSERT_TRUE(n > 0);
+    rx[i].lastReqMs = nowMs;
+    st.reqs++;
+    if (air[i].drops()) return;
+    lp::ParsedFwReq r;
+    TEST_ASSERT_TRUE(lp::parseFwReq(buf, n, r));
+    tx.onReq(r);
+  };
+  auto sendDone = [&](uint32_t nowMs) {
+    lastDoneMs = nowMs;
+    for (size_t i = 0; i < rx.size(); ++i) {
+      if (!rx[i].accepted || air[i].drops()) continue;
+      rx[i].onDone(nowMs);
+      if (!rx[i].full()) deliverReq(i, nowMs, lp::FwReqReason::Gap);
+    }
+  };
+
+  for (uint32_t t = 0; t < kSessionCapMs; ++t) {
+    bool allFull = true;
+    for (Rx& r : rx) {
+      if (!r.accepted && t >= r.acceptMs) {
+        r.accepted = true;
+        // The receiver's no-progress clock starts at the OFFER.
+        r.lastChunkMs = t;
+        if (t > startMs) tx.lateAccept();
+      }
+      if (r.accepted) r.tick(t);
+      allFull = allFull && r.full();
+    }
+    if (allFull) {
+      st.complete = true;
+      st.elapsedMs = t;
+      break;
+    }
+    if (t < startMs) continue;
+    if (!tx.finalizing && t >= nextSendMs) {
+      if (tx.repairDue()) {
+        uint8_t buf[lp::FW_REPAIR_MAX_SIZE];
+        const size_t n = tx.buildRepair(buf, sizeof(buf), txSeq++);
+        TEST_ASSERT_TRUE(n > 0);
+        st.frames++;
+        st.repairs++;
+        for (size_t i = 0; i < rx.size(); ++i) {
+          if (rx[i].accepted && !air[i].drops()) rx[i].onRepair(buf, n);
+        }
+        nextSendMs = t + spacingMs;
+      } else if (tx.next >= tx.total) {
+        if (tx.drain()) {
+          tx.finalizing = true;
+          doneRetries = 1;
+          sendDone(t);
+        }
+      } else {
+        const uint16_t idx = tx.next;
+        st.frames++;
+        st.chunks++;
+        for (size_t i = 0; i < rx.size(); ++i) {
+          if (rx[i].accepted && !air[i].drops() && !rx[i].onChunk(idx, t)) {
+            st.duplicates++;
+          }
+        }
+        tx.sent(idx);
+        nextSendMs = t + spacingMs;
+      }
+    } else if (tx.finalizing && doneRetries < kMaxDoneRetries &&
+               t - lastDoneMs >= kDoneRetryIntervalMs) {
+      doneRetries++;
+      sendDone(t);
+    }
+    for (size_t i = 0; i < rx.size(); ++i) {
+      Rx& r = rx[i];
+      if (!r.accepted || r.full()) continue;
+      if (t - r.lastChunkMs > kChunkStallReqMs &&
+          (r.lastReqMs == 0 || t - r.lastReqMs > kChunkStallReqMs)) {
+        deliverReq(i, t, lp::FwReqReason::StallWatchdog);
+      }
+    }
+  }
+  return st;
+}
+
+// One sender, one receiver, one channel.
+template <class Tx, class Rx>
+SessionStats runOne(Tx& tx, Rx& rx, uint32_t seed, uint32_t spacingMs) {
+  std::vector<Rx> one{rx};
+  std::vector<Channel> air{Channel{Rng{seed}}};
+  const SessionStats st = runSession(tx, one, air, spacingMs);
+  rx = one[0];
+  return st;
+}
+
+}  // namespace ota_sim
@@ -0,0 +1,327 @@
+// Native tests for AirtimeController: the per-window utilization estimate,
+// back-off and recovery with their bounds, the relay gate it drives in
+// HelloRelaySuppressor, and a host mesh model (lamps on a grid, HELLO +
+// suppressed relay + background stream) showing a large fleet held near the
+// airtime budget without losing roster coverage, and a small fleet left on
+// the static cadence.
+
+#include <unity.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "../../src/components/network/mesh/airtime_controller.cpp"
+#include "../../src/components/network/mesh/hello_relay_suppressor.cpp"
+
+using lamp::AirtimeController;
+using lamp::HelloRelaySuppressor;
+using lamp::MeshMix;
+
+void setUp() {}
+void tearDown() {}
+
+void test_frame_airtime_estimate() {
+  TEST_ASSERT_EQUAL_UINT32(392 + 43 * 8, MeshMix::frameAirtimeUs(0));
+  // A full 128-byte HELLO holds the channel ~1.8 ms at 1 Mbps.
+  TEST_ASSERT_EQUAL_UINT32(1760, MeshMix::frameAirtimeUs(lamp_protocol::HELLO_MAX_SIZE));
+}
+
+void test_backs_off_and_recovers_within_bounds() {
+  AirtimeController c;
+  TEST_ASSERT_FALSE(c.update(1000));  // arms the first window
+  TEST_ASSERT_EQUAL_UINT32(LAMP_HELLO_INTERVAL_MS, c.helloIntervalMs());
+  TEST_ASSERT_EQUAL_UINT16(1000, c.relayPermille());
+
+  // 30% busy: 3 s of airtime over a 10 s window, in 1760 us HELLOs.
+  for (int i = 0; i < 1705; i++) c.noteFrame(lamp_protocol::HELLO_MAX_SIZE);
+  TEST_ASSERT_FALSE(c.update(1000 + lamp::kAirtimeWindowMs - 1));
+  TEST_ASSERT_TRUE(c.update(1000 + lamp::kAirtimeWindowMs));
+  TEST_ASSERT_EQUAL_UINT16(300, c.utilizationPermille());
+  TEST_ASSERT_EQUAL_UINT32(45000, c.helloIntervalMs());
+  TEST_ASSERT_EQUAL_UINT16(875, c.relayPermille());
+
+  // Sustained overload saturates at the prune-safe ceiling and the floor.
+  uint32_t now = 1000 + lamp::kAirtimeWindowMs;
+  for (int w = 0; w < 10; w++) {
+    for (int i = 0; i < 2000; i++) c.noteFrame(lamp_protocol::HELLO_MAX_SIZE);
+    now += lamp::kAirtimeWindowMs;
+    TEST_ASSERT_TRUE(c.update(now));
+  }
+  TEST_ASSERT_EQUAL_UINT32(LAMP_HELLO_INTERVAL_MAX_MS, c.helloIntervalMs());
+  TEST_ASSERT_EQUAL_UINT16(lamp::kRelayPermilleMin, c.relayPermille());
+
+  // Inside the hysteresis band nothing moves.
+  for (int i = 0; i < 1136; i++) c.noteFrame(lamp_protocol::HELLO_MAX_SIZE);  // ~20%
+  now += lamp::kAirtimeWindowMs;
+  TEST_ASSERT_TRUE(c.update(now));
+  TEST_ASSERT_EQUAL_UINT32(LAMP_HELLO_INTERVAL_MAX_MS, c.helloIntervalMs());
+
+  // A quiet channel walks both back to the static cadence.
+  for (int w = 0; w < 10; w++) {
+    now += lamp::kAirtimeWindowMs;
+    TEST_ASSERT_TRUE(c.update(now));
+  }
+  TEST_ASSERT_EQUAL_UINT16(0, c.utilizationPermille());
+  TEST_ASSERT_EQUAL_UINT32(LAMP_HELLO_INTERVAL_MS, c.helloIntervalMs());
+  TEST_ASSERT_EQUAL_UINT16(1000, c.relayPermille());
+}
+
+void test_relay_gate_spares_uncovered_entries() {
+  const uint8_t mac[6] = {0xAA, 0x11, 0x22, 0x33, 0x44, 0x01};
+  uint8_t frame[32] = {0};
+  int relayed = 0;
+  const HelloRelaySuppressor::RelayFn count = [&](const uint8_t*, size_t) { relayed++; };
+
+  // Gate closed entirely: entries with none or one duplicate still relay.
+  HelloRelaySuppressor s;
+  s.setRelayGate(0, 0x1234);
+  s.onFirstSeen(mac, 1, frame, sizeof(frame), 0);
+  s.onFirstSeen(mac, 2, frame, sizeof(frame), 0);
+  s.onDuplicate(mac, 2);
+  s.tick(1000, count);
+  TEST_ASSERT_EQUAL_INT(2, relayed);
+  // Two duplicates heard, under the threshold of three: thinned.
+  s.onFirstSeen(mac, 3, frame, sizeof(frame), 0);
+  s.onDuplicate(mac, 3);
+  s.onDuplicate(mac, 3);
+  s.tick(1000, count);
+  TEST_ASSERT_EQUAL_INT(2, relayed);
+
+  // The draw tracks the permille and differs by salt.
+  int admitted = 0, sameAcrossSalts = 0;
+  for (uint16_t seq = 0; seq < 4000; seq++) {
+    const bool a = HelloRelaySuppressor::relayAdmitted(mac, seq, 0x1111, 500);
+    const bool b = HelloRelaySuppressor::relayAdmitted(mac, seq, 0x2222, 500);
+    admitted += a;
+    sameAcrossSalts += a == b;
+  }
+  TEST_ASSERT_TRUE(admitted > 1800 && admitted < 2200);
+  TEST_ASSERT_TRUE(sameAcrossSalts < 2400);
+  TEST_ASSERT_TRUE(HelloRelaySuppressor::relayAdmitted(mac, 7, 0, 1000));
+}
+
+namespace {
+
+// Host mesh model. Lamps sit on a grid and hear every lamp within `range`
+// grid units; delivery is instant and lossless, so the model isolates load
+// and coverage. Each lamp emits a full-size HELLO on its controller's
+// interval, runs the real HelloRelaySuppressor over what it hears, and
+// charges its own AirtimeController with every frame it hears or sends. A
+// background stream (a wisp's MSG_WISP_STATE, an OTA chunk stream) is heard
+// by every lamp.
+struct MeshModel {
+  int cols = 0;
+  int n = 0;
+  float range = 0;
+  bool adaptive = true;
+  uint32_t bgFrameLen = 0;
+  uint32_t bgPeriodMs = 0;
+
+  struct Lamp {
+    AirtimeController ctl;
+    HelloRelaySuppressor sup;
+    uint8_t mac[6] = {0};
+    uint16_t seq = 0;
+    uint32_t nextHelloMs = 0;
+    uint64_t heardUs = 0;       // measured after warm-up
+    uint64_t helloHeardUs = 0;  // HELLO + relay share of heardUs
+    uint32_t maxIntervalMs = 0;
+  };
+  std::vector<Lamp> lamps;
+  std::vector<std::vector<int>> nbrs;
+  std::vector<int32_t> lastSeq;        // [rx * n + src]
+  std::vector<uint32_t> lastHeardMs;   // [rx * n + src]
+  uint32_t maxGapMs = 0;
+  bool measuring = false;
+
+  struct Tx { int from; uint8_t frame[lamp_protocol::HELLO_MAX_SIZE]; };
+  std::vector<Tx> queue;
+
+  void build(int c, int count, float r) {
+    cols = c;
+    n = count;
+    range = r;
+    lamps = std::vector<Lamp>(n);
+    nbrs.assign(n, {});
+    lastSeq.assign(n * n, -1);
+    lastHeardMs.assign(n * n, 0);
+    for (int i = 0; i < n; i++) {
+      lamps[i].mac[0] = 0x24;
+      lamps[i].mac[4] = static_cast<uint8_t>(i >> 8);
+      lamps[i].mac[5] = static_cast<uint8_t>(i);
+      lamps[i].sup.setRelayGate(1000, 0x9E37u * (i + 1));
+      // Spread first emits over the interval like the MAC boot phase does.
+      lamps[i].nextHelloMs = static_cast<uint32_t>(i) * 7919u % LAMP_HELLO_INTERVAL_MS;
+      for (int j = 0; j < n; j++) {
+        if (i == j) continue;
+        const float dx = float(i % cols - j % cols);
+        const float dy = float(i / cols - j / cols);
+        if (dx * dx + dy * dy <= range * range) nbrs[i].push_back(j);
+      }
+    }
+  }
+
+  void send(int from, const uint8_t* frame, uint32_t nowMs) {
+    const uint32_t us = MeshMix::frameAirtimeUs(lamp_protocol::HELLO_MAX_SIZE);
+    lamps[from].ctl.noteFrame(lamp_protocol::HELLO_MAX_SIZE);
+    for (int j : nbrs[from]) {
+      Lamp& rx = lamps[j];
+      rx.ctl.noteFrame(lamp_protocol::HELLO_MAX_SIZE);
+      if (measuring) {
+        rx.heardUs += us;
+        rx.helloHeardUs += us;
+      }
+      const int src = frame[6];
+      const int32_t seq = frame[7] | (frame[8] << 8);
+      if (src == j) continue;  // own HELLO echoed back
+      int32_t& last = lastSeq[j * n + src];
+      if (seq > last) {
+        last = seq;
+        uint32_t& heard = lastHeardMs[j * n + src];
+        if (measuring && nowMs - heard > maxGapMs) maxGapMs = nowMs - heard;
+        heard = nowMs;
+        if (rx.sup.onFirstSeen(lamps[src].mac, static_cast<uint16_t>(seq), frame,
+                               lamp_protocol::HELLO_MAX_SIZE, nowMs)) {
+          Tx t{j, {0}};
+          std::memcpy(t.frame, frame, sizeof(t.frame));
+          queue.push_back(t);
+        }
+      } else if (seq == last) {
+        rx.sup.onDuplicate(lamps[src].mac, static_cast<uint16_t>(seq));
+      }
+    }
+  }
+
+  void drain(uint32_t nowMs) {
+    while (!queue.empty()) {
+      const Tx t = queue.back();
+      queue.pop_back();
+      send(t.from, t.frame, nowMs);
+    }
+  }
+
+  void run(uint32_t durationMs, uint32_t warmupMs) {
+    const uint32_t stepMs = 10;
+    const uint32_t bgUs = bgFrameLen ? MeshMix::frameAirtimeUs(bgFrameLen) : 0;
+    for (uint32_t now = 0; now < durationMs; now += stepMs) {
+      if (!measuring && now >= warmupMs) {
+        measuring = true;
+        for (int j = 0; j < n * n; j++) lastHeardMs[j] = now;
+      }
+      if (bgPeriodMs && now % bgPeriodMs == 0) {
+        for (Lamp& l : lamps) {
+          l.ctl.noteFrame(bgFrameLen);
+          if (measuring) l.heardUs += bgUs;
+        }
+      }
+      for (int i = 0; i < n; i++) {
+        Lamp& l = lamps[i];
+        l.ctl.update(now);
+        if (adaptive) l.sup.setRelayGate(l.ctl.relayPermille(), 0x9E37u * (i + 1));
+        l.sup.tick(now, [&](const uint8_t* f, size_t) {
+          Tx t{i, {0}};
+          std::memcpy(t.frame, f, sizeof(t.frame));
+          queue.push_back(t);
+        });
+        if (now >= l.nextHelloMs) {
+          uint8_t frame[lamp_protocol::HELLO_MAX_SIZE] = {0};
+          frame[6] = static_cast<uint8_t>(i);
+          frame[7] = static_cast<uint8_t>(l.seq);
+          frame[8] = static_cast<uint8_t>(l.seq >> 8);
+          l.seq++;
+          lastSeq[i * n + i] = l.seq;
+          send(i, frame, now);
+          const uint32_t iv = adaptive ? l.ctl.helloIntervalMs() : LAMP_HELLO_INTERVAL_MS;
+          if (measuring && iv > l.maxIntervalMs) l.maxIntervalMs = iv;
+          l.nextHelloMs = now + iv;
+        }
+        drain(now);
+      }
+    }
+    const uint32_t end = durationMs;
+    for (int j = 0; j < n; j++) {
+      for (int src = 0; src < n; src++) {
+        if (src == j) continue;
+        const uint32_t gap = end - lastHeardMs[j * n + src];
+        if (gap > maxGapMs) maxGapMs = gap;
+      }
+    }
+  }
+
+  // Mean over lamps, permille of the measured span.
+  uint32_t meanPermille(uint64_t Lamp::*field, uint32_t spanMs) const {
+    uint64_t sum = 0;
+    for (const Lamp& l : lamps) sum += l.*field;
+    return static_cast<uint32_t>(sum / n / spanMs);
+  }
+};
+
+// LAMP_PRUNE_TIME_MS (lamp_roster.hpp), which this model doesn't pull in.
+constexpr uint32_t kPruneMs = 240000;
+constexpr uint32_t kSimMs = 900000;
+constexpr uint32_t kWarmupMs = 300000;
+
+void runFleet(MeshModel& m, bool adaptive) {
+  m.adaptive = adaptive;
+  // 196 lamps, each hearing ~60 neighbors, four hops corner to corner.
+  m.build(/*cols=*/14, /*count=*/196, /*range=*/4.5f);
+  // An OTA-rate chunk stream: a 1 KiB frame every 50 ms, ~18% of airtime.
+  m.bgFrameLen = 1024;
+  m.bgPeriodMs = 50;
+  m.run(kSimMs, kWarmupMs);
+}
+
+}  // namespace
+
+void test_mesh_model_large_fleet_held_near_budget() {
+  MeshModel fixed;
+  runFleet(fixed, false);
+  MeshModel adaptive;
+  runFleet(adaptive, true);
+  const uint32_t span = kSimMs - kWarmupMs;
+
+  const uint32_t fixedUtil = fixed.meanPermille(&MeshModel::Lamp::heardUs, span);
+  const uint32_t adaptUtil = adaptive.meanPermille(&MeshModel::Lamp::heardUs, span);
+  const uint32_t fixedHello = fixed.meanPermille(&MeshModel::Lamp::helloHeardUs, span);
+  const uint32_t adaptHello = adaptive.meanPermille(&MeshModel::Lamp::helloHeardUs, span);
+  std::printf("fixed util=%u hello=%u | adaptive util=%u hello=%u maxgap=%u/%u ms\n",
+         (unsigned)fixedUtil, (unsigned)fixedHello, (unsigned)adaptUtil,
+         (unsigned)adaptHello, (unsigned)fixed.maxGapMs, (unsigned)adaptive.maxGapMs);
+
+  // The static cadence runs the channel over budget; the controller brings
+  // it back under by cutting HELLO + relay airtime by a third or more.
+  TEST_ASSERT_TRUE(fixedUtil > lamp::kAirtimeHighPermille);
+  TEST_ASSERT_TRUE(adaptUtil <= lamp::kAirtimeHighPermille);
+  TEST_ASSERT_TRUE(adaptHello * 3 <= fixedHello * 2);
+  // Every lamp still hears every other lamp: at worst one HELLO in a row
+  // lost to relay thinning, against a prune window of four.
+  TEST_ASSERT_TRUE(adaptive.maxGapMs <= 2 * LAMP_HELLO_INTERVAL_MAX_MS + 1000);
+  TEST_ASSERT_TRUE(adaptive.maxGapMs < kPruneMs);
+  for (const auto& l : adaptive.lamps) {
+    TEST_ASSERT_TRUE(l.maxIntervalMs <= LAMP_HELLO_INTERVAL_MAX_MS);
+  }
+}
+
+void test_mesh_model_small_fleet_keeps_static_cadence() {
+  MeshModel m;
+  m.build(/*cols=*/4, /*count=*/12, /*range=*/2.5f);
+  m.run(kSimMs, kWarmupMs);
+  for (const auto& l : m.lamps) {
+    TEST_ASSERT_EQUAL_UINT32(LAMP_HELLO_INTERVAL_MS, l.ctl.helloIntervalMs());
+    TEST_ASSERT_EQUAL_UINT16(1000, l.ctl.relayPermille());
+    TEST_ASSERT_EQUAL_UINT32(LAMP_HELLO_INTERVAL_MS, l.maxIntervalMs);
+  }
+  TEST_ASSERT_TRUE(m.maxGapMs <= LAMP_HELLO_INTERVAL_MS + 1000);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_frame_airtime_estimate);
+  RUN_TEST(test_backs_off_and_recovers_within_bounds);
+  RUN_TEST(test_relay_gate_spares_uncovered_entries);
+  RUN_TEST(test_mesh_model_large_fleet_held_near_budget);
+  RUN_TEST(test_mesh_model_small_fleet_keeps_static_cadence);
+  return UNITY_END();
+}
@@ -6,6 +6,9 @@
 
 #include <cstring>
 
+#include "expressions/expression_invocation.hpp"
+#include "expressions/param_set.hpp"
+
 #include "expressions/breathing/breathing_expression.hpp"
 #include "expressions/shimmer/shimmer_expression.hpp"
 #include "expressions/glitchy/glitchy_expression.hpp"
@@ -434,6 +437,37 @@ void test_shimmer_has_no_colors_and_has_opacity() {
   TEST_ASSERT_TRUE(hasOpacity(kShimmerDescriptorData));
 }
 
+// ParamSet only stores interned keys (param_set.hpp). A production key
+// missing from kParamKeyNames would have its defaults and app-sent values
+// silently dropped, so every declared key must resolve.
+void test_all_param_keys_are_interned() {
+  for (const ExpressionDescriptor* d : g_reg.all()) {
+    for (const ParamSpec& p : d->params) {
+      TEST_ASSERT_NOT_EQUAL_MESSAGE(kNoParamKey, findParamKey(p.key), p.key);
+    }
+    for (const auto* r : {&d->interval, &d->duration}) {
+      if (!r->has_value()) continue;
+      for (const char* k : {(*r)->minKey, (*r)->maxKey}) {
+        if (k) TEST_ASSERT_NOT_EQUAL_MESSAGE(kNoParamKey, findParamKey(k), k);
+      }
+    }
+  }
+  // Framework keys: the app's zone + cascade controls (see docs/dev/expressions.md).
+  for (const char* k : {"posMin", "posMax", "fullStrip", "cascadeEnabled",
+                        "cascadeStaggerMs"}) {
+    TEST_ASSERT_NOT_EQUAL_MESSAGE(kNoParamKey, findParamKey(k), k);
+  }
+}
+
+// A descriptor id without a binary type id still cascades, but as JSON to
+// every peer; a new production expression needs a kInvocationTypeNames row.
+void test_all_ids_have_binary_type_ids() {
+  for (const ExpressionDescriptor* d : g_reg.all()) {
+    TEST_ASSERT_NOT_EQUAL_MESSAGE(0xFF, findInvocationTypeId(d->id), d->id);
+  }
+  TEST_ASSERT_NOT_EQUAL(0xFF, findInvocationTypeId("bloom"));
+}
+
 int main(int, char**) {
   UNITY_BEGIN();
   RUN_TEST(test_all_five_ids_present);
@@ -470,5 +504,7 @@ int main(int, char**) {
   RUN_TEST(test_shimmer_is_not_advanced);
   RUN_TEST(test_shimmer_fire_enum);
   RUN_TEST(test_shimmer_has_no_colors_and_has_opacity);
+  RUN_TEST(test_all_param_keys_are_interned);
+  RUN_TEST(test_all_ids_have_binary_type_ids);
   return UNITY_END();
 }
@@ -0,0 +1,97 @@
+// Native microbenchmark for LayerStack::compositeSpan against the per-pixel
+// composite() loop compositeWisp() used to run: 255 pixels x 2 surfaces (shade
+// + base stacks), wisp mid-ease plus four active expression layers, so every
+// pass is a real partial blend. Byte equality is asserted; timings are
+// reported, not asserted (host CPU, not ESP32).
+//
+// Production code: src/render/layer_stack.hpp, src/core/compositor.cpp.
+
+#include <unity.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "render/layer_stack.hpp"
+#include "util/color.hpp"
+
+using lamp::Color;
+using lamp::LayerStack;
+
+namespace {
+
+constexpr size_t kPixels = 255;
+constexpr int kIterations = 2000;
+
+std::vector<Color> ownFrame(uint32_t seed) {
+  std::vector<Color> out(kPixels);
+  for (size_t i = 0; i < kPixels; i++) {
+    const uint32_t v = (static_cast<uint32_t>(i) * 2654435761u) ^ seed;
+    out[i] = Color(v & 0xFF, (v >> 8) & 0xFF, (v >> 16) & 0xFF, (v >> 24) & 0xFF);
+  }
+  return out;
+}
+
+// Wisp and every expression layer part-way up their eases.
+void primeStack(LayerStack& s, Color wisp) {
+  s.setWispTarget(wisp);
+  for (size_t l = 0; l < LayerStack::kMaxExpressionLayers; l++) {
+    s.setExpressionLayer(l, Color(60 * l, 200 - 40 * l, 25 * l, 10 * l),
+                         /*enabled=*/true, /*userOpacity=*/0.8f,
+                         /*wispDimFloor=*/0.5f);
+  }
+  for (int i = 0; i < 12; i++) s.tick(0.6f);
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_report_span_vs_per_pixel() {
+  LayerStack shade;
+  LayerStack base;
+  primeStack(shade, Color(0, 180, 255, 0));
+  primeStack(base, Color(255, 90, 0, 30));
+  const std::vector<Color> shadeOwn = ownFrame(0xC0FFEE);
+  const std::vector<Color> baseOwn = ownFrame(0xBADF00D);
+
+  std::vector<Color> shadePx, basePx;
+  using Clock = std::chrono::steady_clock;
+  const auto t0 = Clock::now();
+  for (int it = 0; it < kIterations; it++) {
+    shadePx = shadeOwn;
+    basePx = baseOwn;
+    for (Color& px : shadePx) px = shade.composite(px);
+    for (Color& px : basePx) px = base.composite(px);
+  }
+  const auto t1 = Clock::now();
+  const std::vector<Color> shadeRef = shadePx;
+  const std::vector<Color> baseRef = basePx;
+  for (int it = 0; it < kIterations; it++) {
+    shadePx = shadeOwn;
+    basePx = baseOwn;
+    shade.compositeSpan(shadePx.data(), shadePx.size());
+    base.compositeSpan(basePx.data(), basePx.size());
+  }
+  const auto t2 = Clock::now();
+
+  const double px = static_cast<double>(kIterations) * kPixels * 2;
+  const double perPixelNs =
+      std::chrono::duration<double, std::nano>(t1 - t0).count() / px;
+  const double spanNs =
+      std::chrono::duration<double, std::nano>(t2 - t1).count() / px;
+  std::printf("[bench] wisp composite %u px x 2 surfaces x %d, 5 layers: "
+              "per-pixel=%.2f ns/px span=%.2f ns/px\n",
+              (unsigned)kPixels, kIterations, perPixelNs, spanNs);
+
+  TEST_ASSERT_EQUAL_MEMORY(shadeRef.data(), shadePx.data(), kPixels * sizeof(Color));
+  TEST_ASSERT_EQUAL_MEMORY(baseRef.data(), basePx.data(), kPixels * sizeof(Color));
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_report_span_vs_per_pixel);
+  return UNITY_END();
+}
@@ -0,0 +1,320 @@
+// Native-host tests + microbenchmark for the binary config section codec.
+//
+// Pins:
+//   1. every test_config_codec fixture, parsed through fromJson, survives an
+//      encode/decode round trip: toJson of the decoded model is byte-equal to
+//      toJson of the original.
+//   2. decode rejects, and leaves its output untouched on, a wrong schema
+//      version, a wrong section id, every truncation, and trailing bytes.
+//   3. decode applies fromJson's clamps (socialMode range, Σpx ≤ 255, ≥1
+//      color per segment, knockout sized to the base) and drops parameter
+//      names this firmware doesn't know.
+//   4. reports load and save cost against the JSON path. Timings are
+//      reported, not asserted.
+//
+// Production code: src/config/config_binary.cpp.
+
+#include <unity.h>
+
+#include <ArduinoJson.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "config/config_binary.hpp"
+#include "config/config_codec.hpp"
+
+// Native tests don't build src/, so compile the real implementations in.
+#include "../../src/util/color.cpp"
+#include "../../src/config/config_codec.cpp"
+#include "../../src/config/config_binary.cpp"
+
+using namespace lamp;
+namespace cb = lamp::config_binary;
+
+namespace {
+
+struct Model {
+  LampSettings lamp;
+  BaseSettings base;
+  ShadeSettings shade;
+  ExpressionSettings expressions;
+  HomeModeSettings homeMode;
+};
+
+void parseInto(const char* json, Model& m) {
+  JsonDocument doc;
+  deserializeJson(doc, json);
+  config_codec::fromJson(doc.as<JsonObject>(), m.lamp, m.base, m.shade,
+                         m.expressions, m.homeMode);
+}
+
+std::string toJsonString(const Model& m) {
+  JsonDocument doc;
+  config_codec::toJson(doc.to<JsonObject>(), m.lamp, m.base, m.shade,
+                       m.expressions, m.homeMode);
+  std::string out;
+  serializeJson(doc, out);
+  return out;
+}
+
+bool roundTrip(const Model& a, Model& b) {
+  cb::Bytes blob;
+  bool ok = true;
+  cb::encode(a.lamp, blob);
+  ok &= cb::decode(blob.data(), blob.size(), b.lamp);
+  cb::encode(a.base, blob);
+  ok &= cb::decode(blob.data(), blob.size(), b.base);
+  cb::encode(a.shade, blob);
+  ok &= cb::decode(blob.data(), blob.size(), b.shade);
+  cb::encode(a.expressions, blob);
+  ok &= cb::decode(blob.data(), blob.size(), b.expressions);
+  cb::encode(a.homeMode, blob);
+  ok &= cb::decode(blob.data(), blob.size(), b.homeMode);
+  return ok;
+}
+
+// The test_config_codec fixtures, plus a fully populated document.
+const char* const kFixtures[] = {
+    "{}",
+    "{\"lamp\":{\"name\":\"LIVING ROOM\"}}",
+    "{\"lamp\":{\"socialMode\":9}}",
+    "{\"shade\":{\"segments\":["
+    "{\"name\":\"Small\",\"px\":16,\"colors\":[\"#11223300\"]},"
+    "{\"name\":\"Medium\",\"px\":12,\"colors\":[\"#44556600\"]},"
+    "{\"name\":\"Big\",\"px\":9,\"colors\":[\"#77889900\"]}]}}",
+    "{\"base\":{\"segments\":["
+    "{\"px\":200,\"colors\":[\"#11111100\"]},"
+    "{\"px\":200,\"colors\":[\"#22222200\"]}]}}",
+    "{\"homeMode\":{\"ssid\":\"net\"}}",
+    "{\"homeMode\":{\"ssid\":\"\"}}",
+    "{\"lamp\":{\"name\":\"floor\",\"brightness\":42,\"socialMode\":2},"
+    "\"base\":{\"ac\":0,\"segments\":[{\"name\":\"Base\",\"px\":10,"
+    "\"colors\":[\"#11223300\"]}]},"
+    "\"shade\":{\"segments\":[{\"name\":\"Shade\",\"px\":5,"
+    "\"colors\":[\"#aabbcc00\"]}]},"
+    "\"homeMode\":{\"ssid\":\"net\",\"brightness\":30,\"enabled\":true},"
+    "\"expressions\":[{\"type\":\"twinkle\",\"enabled\":true,"
+    "\"intervalMin\":5,\"intervalMax\":9,\"target\":2,\"speed\":3,"
+    "\"colors\":[\"#ff000000\"]}]}",
+    "{\"lamp\":{\"name\":\"myLamp\"},"
+    "\"base\":{\"colors\":[\"#11223344\",\"#55667788\"],\"px\":35},"
+    "\"shade\":{\"colors\":[\"#aabbccdd\"],\"px\":38}}",
+    "{\"base\":{\"ac\":0},\"shade\":{}}",
+    "{\"base\":{\"segments\":[{\"name\":\"Left rail\",\"px\":20,"
+    "\"colors\":[\"#11223344\"]}]}}",
+    "{\"homeMode\":{\"ssid\":\"net\",\"networkBound\":false}}",
+    "{\"homeMode\":{\"disabledExpressionTypes\":[\"pulse\",\"shifty\"]}}",
+    "{\"homeMode\":{\"disabledExpressionTypes\":[]}}",
+    "{\"homeMode\":{\"socialDisabled\":false}}",
+    "{\"homeMode\":{\"ssid\":\"net\",\"brightness\":40,\"enabled\":true,"
+    "\"networkBound\":true,\"socialDisabled\":false,"
+    "\"disabledExpressionTypes\":[\"pulse\",\"breathing\"]}}",
+    "{\"lamp\":{\"name\":\"desk\",\"brightness\":77,\"password\":\"hunter2\","
+    "\"setup\":true,\"named\":true,\"advancedEnabled\":true,"
+    "\"webappEnabled\":false,\"apBootMinutes\":10,\"brightnessCeiling\":200,"
+    "\"socialMode\":0},"
+    "\"base\":{\"byteOrder\":\"GRB\",\"segments\":[{\"name\":\"Stem\",\"px\":12,"
+    "\"colors\":[\"#01020304\",\"#05060708\"]}],"
+    "\"knockout\":[0,10,20,30,40,50,60,70,80,90,100,100]},"
+    "\"shade\":{\"byteOrder\":\"GRBW\",\"segments\":[{\"name\":\"A\",\"px\":20,"
+    "\"colors\":[\"#10203040\"]},{\"name\":\"B\",\"px\":18,"
+    "\"colors\":[\"#50607080\"]}]},"
+    "\"expressions\":[{\"type\":\"glitchy\",\"enabled\":true,\"intervalMin\":30,"
+    "\"intervalMax\":4000000,\"target\":1,\"size\":3,\"posMin\":0,\"posMax\":37,"
+    "\"colors\":[\"#ff000000\",\"#00ff0000\"]},"
+    "{\"type\":\"shifty\",\"enabled\":false,\"intervalMin\":60,"
+    "\"intervalMax\":900,\"target\":3,\"colors\":[]}],"
+    "\"homeMode\":{\"ssid\":\"home-net\",\"brightness\":25,\"enabled\":true,"
+    "\"networkBound\":true,\"socialDisabled\":true,"
+    "\"disabledExpressionTypes\":[\"glitchy\"]}}",
+};
+
+}  // namespace
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_codec_fixtures_round_trip() {
+  for (const char* json : kFixtures) {
+    Model a;
+    parseInto(json, a);
+    Model b;
+    TEST_ASSERT_TRUE_MESSAGE(roundTrip(a, b), json);
+    TEST_ASSERT_EQUAL_STRING_MESSAGE(toJsonString(a).c_str(),
+                                     toJsonString(b).c_str(), json);
+    TEST_ASSERT_TRUE_MESSAGE(a.expressions.expressions.size() ==
+                                 b.expressions.expressions.size(),
+                             json);
+    for (size_t i = 0; i < a.expressions.expressions.size(); i++) {
+      TEST_ASSERT_TRUE_MESSAGE(a.expressions.expressions[i].parameters ==
+                                   b.expressions.expressions[i].parameters,
+                               json);
+    }
+  }
+}
+
+void test_header_mismatch_rejected() {
+  LampSettings lamp;
+  lamp.name = "keep";
+  cb::Bytes blob;
+  cb::encode(HomeModeSettings(), blob);
+  TEST_ASSERT_FALSE(cb::decode(blob.data(), blob.size(), lamp));  // wrong section
+
+  cb::encode(LampSettings(), blob);
+  blob[0] = cb::kSchemaVersion + 1;
+  TEST_ASSERT_FALSE(cb::decode(blob.data(), blob.size(), lamp));
+  TEST_ASSERT_EQUAL_STRING("keep", lamp.name.c_str());
+}
+
+void test_truncation_and_trailing_bytes_rejected() {
+  Model a;
+  parseInto(kFixtures[sizeof(kFixtures) / sizeof(kFixtures[0]) - 1], a);
+  cb::Bytes blob;
+  cb::encode(a.expressions, blob);
+  for (size_t n = 0; n < blob.size(); n++) {
+    ExpressionSettings out;
+    out.expressions.resize(7);
+    TEST_ASSERT_FALSE(cb::decode(blob.data(), n, out));
+    TEST_ASSERT_EQUAL_UINT(7, out.expressions.size());
+  }
+  blob.push_back(0);
+  ExpressionSettings out;
+  TEST_ASSERT_FALSE(cb::decode(blob.data(), blob.size(), out));
+
+  cb::encode(a.base, blob);
+  for (size_t n = 0; n < blob.size(); n++) {
+    BaseSettings b;
+    TEST_ASSERT_FALSE(cb::decode(blob.data(), n, b));
+  }
+}
+
+void test_decode_applies_load_clamps() {
+  // Hand-built blobs a well-behaved encoder never produces.
+  LampSettings lamp;
+  cb::Bytes blob;
+  cb::encode(lamp, blob);
+  blob.back() = 9;  // socialMode
+  TEST_ASSERT_TRUE(cb::decode(blob.data(), blob.size(), lamp));
+  TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(SocialMode::Ambivert),
+                          static_cast<uint8_t>(lamp.socialMode));
+
+  BaseSettings over;
+  over.segments = {{"a", 200, {}}, {"b", 200, {Color(1, 2, 3, 4)}}};
+  over.knockoutPixels.assign(3, 7);
+  cb::encode(over, blob);
+  BaseSettings back;
+  TEST_ASSERT_TRUE(cb::decode(blob.data(), blob.size(), back));
+  TEST_ASSERT_EQUAL_UINT8(255, back.sumPx());
+  TEST_ASSERT_EQUAL_UINT8(55, back.segments[1].px);
+  TEST_ASSERT_TRUE(back.segments[0].colors[0] == kBaseDefaultColor);
+  TEST_ASSERT_EQUAL_UINT(255, back.knockoutPixels.size());
+  TEST_ASSERT_EQUAL_UINT8(7, back.knockoutPixels[2]);
+  TEST_ASSERT_EQUAL_UINT8(100, back.knockoutPixels[3]);
+
+  ShadeSettings none;
+  none.segments.clear();
+  cb::encode(none, blob);
+  ShadeSettings shade;
+  TEST_ASSERT_TRUE(cb::decode(blob.data(), blob.size(), shade));
+  TEST_ASSERT_EQUAL_UINT(1, shade.segments.size());
+  TEST_ASSERT_TRUE(shade.broadcastColors()[0] == kShadeDefaultColor);
+}
+
+void test_unknown_parameter_dropped() {
+  ExpressionSettings e;
+  e.expressions.resize(1);
+  e.expressions[0].setParameter("size", 4);
+  cb::Bytes blob;
+  cb::encode(e, blob);
+  // Rename "size" to a key no firmware knows; same length keeps the framing.
+  for (size_t i = 0; i + 4 <= blob.size(); i++) {
+    if (std::string(reinterpret_cast<const char*>(&blob[i]), 4) == "size") {
+      blob[i] = 'z';
+    }
+  }
+  ExpressionSettings out;
+  TEST_ASSERT_TRUE(cb::decode(blob.data(), blob.size(), out));
+  TEST_ASSERT_TRUE(out.expressions[0].parameters.empty());
+}
+
+void test_decode_keeps_unstored_fields() {
+  LampSettings lamp;
+  lamp.lampType = "snafu";
+  BaseSettings base;
+  base.colorsEditable = false;
+  cb::Bytes blob;
+  cb::encode(LampSettings(), blob);
+  TEST_ASSERT_TRUE(cb::decode(blob.data(), blob.size(), lamp));
+  TEST_ASSERT_EQUAL_STRING("snafu", lamp.lampType.c_str());
+  cb::encode(BaseSettings(), blob);
+  TEST_ASSERT_TRUE(cb::decode(blob.data(), blob.size(), base));
+  TEST_ASSERT_FALSE(base.colorsEditable);
+}
+
+void test_report_load_and_save_cost() {
+  Model a;
+  parseInto(kFixtures[sizeof(kFixtures) / sizeof(kFixtures[0]) - 1], a);
+  const std::string json = toJsonString(a);
+  cb::Bytes blobs[5];
+  cb::encode(a.lamp, blobs[0]);
+  cb::encode(a.base, blobs[1]);
+  cb::encode(a.shade, blobs[2]);
+  cb::encode(a.expressions, blobs[3]);
+  cb::encode(a.homeMode, blobs[4]);
+  size_t binBytes = 0;
+  for (const auto& b : blobs) binBytes += b.size();
+
+  const int iters = 2000;
+  size_t sink = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int k = 0; k < iters; k++) {
+    Model m;
+    parseInto(json.c_str(), m);
+    sink += m.base.sumPx();
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for (int k = 0; k < iters; k++) {
+    Model m;
+    cb::decode(blobs[0].data(), blobs[0].size(), m.lamp);
+    cb::decode(blobs[1].data(), blobs[1].size(), m.base);
+    cb::decode(blobs[2].data(), blobs[2].size(), m.shade);
+    cb::decode(blobs[3].data(), blobs[3].size(), m.expressions);
+    cb::decode(blobs[4].data(), blobs[4].size(), m.homeMode);
+    sink += m.base.sumPx();
+  }
+  auto t2 = std::chrono::steady_clock::now();
+  for (int k = 0; k < iters; k++) sink += toJsonString(a).size();
+  auto t3 = std::chrono::steady_clock::now();
+  for (int k = 0; k < iters; k++) {
+    cb::Bytes out;
+    cb::encode(a.lamp, out);
+    cb::encode(a.base, out);
+    cb::encode(a.shade, out);
+    cb::encode(a.expressions, out);
+    cb::encode(a.homeMode, out);
+    sink += out.size();
+  }
+  auto t4 = std::chrono::steady_clock::now();
+  TEST_ASSERT_GREATER_THAN(0, sink);
+  auto us = [&](auto d) {
+    return std::chrono::duration<double, std::micro>(d).count() / iters;
+  };
+  std::printf("[bench] config json=%uB bin=%uB load json=%6.2f us bin=%6.2f us "
+              "save json=%6.2f us bin=%6.2f us\n",
+              static_cast<unsigned>(json.size()), static_cast<unsigned>(binBytes),
+              us(t1 - t0), us(t2 - t1), us(t3 - t2), us(t4 - t3));
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_codec_fixtures_round_trip);
+  RUN_TEST(test_header_mismatch_rejected);
+  RUN_TEST(test_truncation_and_trailing_bytes_rejected);
+  RUN_TEST(test_decode_applies_load_clamps);
+  RUN_TEST(test_unknown_parameter_dropped);
+  RUN_TEST(test_decode_keeps_unstored_fields);
+  RUN_TEST(test_report_load_and_save_cost);
+  return UNITY_END();
+}
@@ -0,0 +1,482 @@
+// Native-host tests for per-section config persistence.
+//
+// Pins:
+//   1. an unchanged model writes nothing; editing one section rewrites only
+//      that section's key.
+//   2. load() reassembles the model persist() wrote, and the hashes it
+//      records from the stored blobs match a fresh encode, so the first
+//      commit after boot is a no-op.
+//   3. a legacy "cfg" document and the per-section JSON keys load through
+//      fromJson and migrate to binary on the first persist. The per-section
+//      keys are then removed; "cfg" is rewritten on every commit for a
+//      rollback or downgrade to older firmware, and later loads ignore it
+//      unless older firmware has edited it since, when it wins whole.
+//   4. a failed section write reports !ok and is retried on the next call
+//      without rewriting the sections that landed; the JSON copy stays
+//      until every section is in binary.
+//   5. a corrupt blob falls back to a JSON copy of that section when one
+//      exists, and otherwise fails with hadData and the model untouched, so
+//      Config serves defaults without overwriting NVS.
+//   6. a commit that changes several sections goes through the journal key
+//      first; a journal left by a commit that stopped part way is rolled
+//      forward on load, so no boot sees a mix of old and new sections.
+//
+// Production code: src/config/config_sections.cpp.
+
+#include <unity.h>
+
+#include <ArduinoJson.h>
+
+#include <string>
+#include <vector>
+
+#include "config/config_sections.hpp"
+#include "config/config_store.hpp"
+
+// Native tests don't build src/, so compile the real implementations in.
+#include "../../src/util/color.cpp"
+#include "../../src/config/config_codec.cpp"
+#include "../../src/config/config_binary.cpp"
+#include "../../src/config/config_sections.cpp"
+
+using namespace lamp;
+namespace cs = lamp::config_sections;
+
+namespace {
+
+// InMemoryConfigStore that records every key written and can refuse one.
+class RecordingStore : public ConfigStore {
+ public:
+  std::vector<std::string> writes;
+  std::string failKey;
+
+  std::string read(const char* key, const char* defaultValue) override {
+    return mem_.read(key, defaultValue);
+  }
+  size_t write(const char* key, const char* value) override {
+    if (failKey == key) return 0;
+    writes.push_back(key);
+    return mem_.write(key, value);
+  }
+  bool readBytes(const char* key, std::vector<uint8_t>& out) override {
+    return mem_.readBytes(key, out);
+  }
+  size_t writeBytes(const char* key, const uint8_t* data, size_t len) override {
+    if (failKey == key) return 0;
+    writes.push_back(key);
+    return mem_.writeBytes(key, data, len);
+  }
+  bool remove(const char* key) override { return mem_.remove(key); }
+  bool clear() override { return mem_.clear(); }
+
+  bool has(const char* key) {
+    std::vector<uint8_t> unused;
+    return mem_.readBytes(key, unused);
+  }
+
+ private:
+  InMemoryConfigStore mem_;
+};
+
+struct Model {
+  LampSettings lamp;
+  BaseSettings base;
+  ShadeSettings shade;
+  ExpressionSettings expressions;
+  HomeModeSettings homeMode;
+};
+
+const char* kDoc = R"({"lamp":{"name":"jacko","named":true,"brightness":80},)"
+                   R"("base":{"segments":[{"name":"Base","px":32,"colors":["#FF000000"]}]},)"
+                   R"("shade":{"segments":[{"name":"Shade","px":40,"colors":["#00FF0000"]}]},)"
+                   R"("expressions":[{"type":"glitchy","enabled":true,"size":2}],)"
+                   R"("homeMode":{"enabled":false}})";
+
+void parseInto(const char* json, Model& m) {
+  JsonDocument doc;
+  deserializeJson(doc, json);
+  config_codec::fromJson(doc.as<JsonObject>(), m.lamp, m.base, m.shade,
+                         m.expressions, m.homeMode);
+}
+
+std::string dump(const Model& m) {
+  JsonDocument doc;
+  config_codec::toJson(doc.to<JsonObject>(), m.lamp, m.base, m.shade,
+                       m.expressions, m.homeMode);
+  std::string out;
+  serializeJson(doc, out);
+  return out;
+}
+
+cs::PersistResult persist(RecordingStore& s, const Model& m, cs::StoredState& st) {
+  return cs::persist(s, m.lamp, m.base, m.shade, m.expressions, m.homeMode, st);
+}
+
+cs::LoadResult load(RecordingStore& s, Model& m, cs::StoredState& st) {
+  return cs::load(s, m.lamp, m.base, m.shade, m.expressions, m.homeMode, st);
+}
+
+}  // namespace
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_only_changed_sections_written() {
+  RecordingStore s;
+  cs::StoredState st;
+  Model m;
+  parseInto(kDoc, m);
+
+  cs::PersistResult r = persist(s, m, st);
+  TEST_ASSERT_TRUE(r.ok);
+  TEST_ASSERT_EQUAL_UINT8(cs::kCount, r.written);
+
+  s.writes.clear();
+  r = persist(s, m, st);
+  TEST_ASSERT_TRUE(r.ok);
+  TEST_ASSERT_EQUAL_UINT8(0, r.written);
+  TEST_ASSERT_EQUAL(0, (int)s.writes.size());
+
+  m.base.segments[0].px = 33;
+  r = persist(s, m, st);
+  TEST_ASSERT_EQUAL_UINT8(1, r.written);
+  TEST_ASSERT_EQUAL(3, (int)s.writes.size());
+  TEST_ASSERT_EQUAL_STRING("cfgb.base", s.writes[0].c_str());
+  TEST_ASSERT_EQUAL_STRING(cs::kLegacyKey, s.writes[1].c_str());
+  TEST_ASSERT_EQUAL_STRING(cs::kMirrorKey, s.writes[2].c_str());
+}
+
+void test_load_round_trips_and_first_commit_is_noop() {
+  RecordingStore s;
+  cs::StoredState st;
+  Model m;
+  parseInto(kDoc, m);
+  persist(s, m, st);
+
+  Model back;
+  cs::StoredState loadedState;
+  cs::LoadResult lr = load(s, back, loadedState);
+  TEST_ASSERT_TRUE(lr.ok);
+  TEST_ASSERT_TRUE(lr.hadData);
+  TEST_ASSERT_TRUE(lr.namedKeyPresent);
+  TEST_ASSERT_EQUAL_UINT8(0, lr.fromJson);
+  TEST_ASSERT_FALSE(loadedState.jsonPresent);
+  TEST_ASSERT_EQUAL_STRING(dump(m).c_str(), dump(back).c_str());
+  for (size_t i = 0; i < cs::kCount; i++) {
+    TEST_ASSERT_EQUAL_UINT32(st.hashes[i], loadedState.hashes[i]);
+  }
+
+  s.writes.clear();
+  TEST_ASSERT_EQUAL_UINT8(0, persist(s, back, loadedState).written);
+  TEST_ASSERT_EQUAL(0, (int)s.writes.size());
+}
+
+void test_legacy_document_migrates_and_is_mirrored() {
+  RecordingStore s;
+  s.write(cs::kLegacyKey, kDoc);
+
+  Model m;
+  cs::StoredState st;
+  cs::LoadResult lr = load(s, m, st);
+  TEST_ASSERT_TRUE(lr.ok);
+  TEST_ASSERT_TRUE(lr.hadData);
+  TEST_ASSERT_TRUE(lr.namedKeyPresent);
+  TEST_ASSERT_EQUAL_UINT8(cs::kCount, lr.fromJson);
+  TEST_ASSERT_TRUE(st.jsonPresent);
+  Model want;
+  parseInto(kDoc, want);
+  TEST_ASSERT_EQUAL_STRING(dump(want).c_str(), dump(m).c_str());
+
+  cs::PersistResult r = persist(s, m, st);
+  TEST_ASSERT_TRUE(r.ok);
+  TEST_ASSERT_EQUAL_UINT8(cs::kCount, r.written);
+  TEST_ASSERT_FALSE(st.jsonPresent);
+  TEST_ASSERT_EQUAL_STRING(dump(m).c_str(), s.read(cs::kLegacyKey, "").c_str());
+
+  // Edits are mirrored into the legacy document, which a rolled-back image
+  // reads; it no longer feeds a load here.
+  m.lamp.name = "edited";
+  s.writes.clear();
+  r = persist(s, m, st);
+  TEST_ASSERT_EQUAL_UINT8(1, r.written);
+  Model rolledBack;
+  parseInto(s.read(cs::kLegacyKey, "").c_str(), rolledBack);
+  TEST_ASSERT_EQUAL_STRING("edited", rolledBack.lamp.name.c_str());
+
+  Model back;
+  cs::StoredState again;
+  lr = load(s, back, again);
+  TEST_ASSERT_EQUAL_UINT8(0, lr.fromJson);
+  TEST_ASSERT_FALSE(again.jsonPresent);
+  TEST_ASSERT_EQUAL_STRING(dump(m).c_str(), dump(back).c_str());
+}
+
+void test_pre_flag_legacy_reports_named_absent() {
+  RecordingStore s;
+  s.write(cs::kLegacyKey, R"({"lamp":{"name":"jacko"}})");
+  Model m;
+  cs::StoredState st;
+  TEST_ASSERT_FALSE(load(s, m, st).namedKeyPresent);
+}
+
+void test_section_json_keys_win_over_legacy() {
+  RecordingStore s;
+  s.write(cs::kLegacyKey, kDoc);
+  s.write("cfg.lamp", R"({"name":"newer","named":true})");
+  Model m;
+  cs::StoredState st;
+  TEST_ASSERT_TRUE(load(s, m, st).ok);
+  TEST_ASSERT_EQUAL_STRING("newer", m.lamp.name.c_str());
+  TEST_ASSERT_EQUAL_UINT8(32, m.base.sumPx());
+
+  persist(s, m, st);
+  TEST_ASSERT_FALSE(s.has("cfg.lamp"));
+  TEST_ASSERT_TRUE(s.has(cs::kLegacyKey));
+}
+
+void test_failed_section_retried_and_json_kept() {
+  RecordingStore s;
+  s.write(cs::kLegacyKey, kDoc);
+  Model m;
+  cs::StoredState st;
+  load(s, m, st);
+
+  s.failKey = "cfgb.shade";
+  s.writes.clear();
+  cs::PersistResult r = persist(s, m, st);
+  TEST_ASSERT_FALSE(r.ok);
+  TEST_ASSERT_EQUAL_UINT8(cs::kCount - 1, r.written);
+  // The legacy document still carries shade, so it must not be removed yet.
+  TEST_ASSERT_TRUE(st.jsonPresent);
+  TEST_ASSERT_TRUE(s.has(cs::kLegacyKey));
+
+  s.failKey.clear();
+  s.writes.clear();
+  r = persist(s, m, st);
+  TEST_ASSERT_TRUE(r.ok);
+  TEST_ASSERT_EQUAL_UINT8(1, r.written);
+  // The first commit's journal is still stored, so the retry supersedes it.
+  TEST_ASSERT_EQUAL(4, (int)s.writes.size());
+  TEST_ASSERT_EQUAL_STRING(cs::kJournalKey, s.writes[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("cfgb.shade", s.writes[1].c_str());
+  TEST_ASSERT_FALSE(st.jsonPresent);
+  TEST_ASSERT_FALSE(st.journalPresent);
+  TEST_ASSERT_FALSE(s.has(cs::kJournalKey));
+}
+
+void test_persist_all_rewrites_every_section() {
+  RecordingStore s;
+  cs::StoredState st;
+  Model m;
+  parseInto(kDoc, m);
+  persist(s, m, st);
+
+  s.writes.clear();
+  cs::PersistResult r =
+      cs::persistAll(s, m.lamp, m.base, m.shade, m.expressions, m.homeMode, st);
+  TEST_ASSERT_TRUE(r.ok);
+  TEST_ASSERT_EQUAL_UINT8(cs::kCount, r.written);
+  TEST_ASSERT_EQUAL(cs::kCount + 3, s.writes.size());
+  TEST_ASSERT_FALSE(s.has(cs::kJournalKey));
+}
+
+void test_multi_section_commit_goes_through_journal() {
+  RecordingStore s;
+  cs::StoredState st;
+  Model m;
+  parseInto(kDoc, m);
+  persist(s, m, st);
+
+  m.lamp.name = "both";
+  m.base.segments[0].name = "Edited";
+  s.writes.clear();
+  cs::PersistResult r = persist(s, m, st);
+  TEST_ASSERT_TRUE(r.ok);
+  TEST_ASSERT_EQUAL_UINT8(2, r.written);
+  TEST_ASSERT_EQUAL(5, (int)s.writes.size());
+  TEST_ASSERT_EQUAL_STRING(cs::kJournalKey, s.writes[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("cfgb.lamp", s.writes[1].c_str());
+  TEST_ASSERT_EQUAL_STRING("cfgb.base", s.writes[2].c_str());
+  TEST_ASSERT_FALSE(st.journalPresent);
+  TEST_ASSERT_FALSE(s.has(cs::kJournalKey));
+
+  // The journal didn't land: nothing did, and the next commit retries both.
+  m.lamp.name = "again";
+  m.base.segments[0].name = "Again";
+  s.failKey = cs::kJournalKey;
+  r = persist(s, m, st);
+  TEST_ASSERT_FALSE(r.ok);
+  TEST_ASSERT_EQUAL_UINT8(0, r.written);
+  Model back;
+  cs::StoredState again;
+  load(s, back, again);
+  TEST_ASSERT_EQUAL_STRING("both", back.lamp.name.c_str());
+  TEST_ASSERT_EQUAL_STRING("Edited", back.base.segments[0].name.c_str());
+  s.failKey.clear();
+  TEST_ASSERT_EQUAL_UINT8(2, persist(s, m, st).written);
+}
+
+void test_interrupted_commit_rolls_forward() {
+  RecordingStore s;
+  cs::StoredState st;
+  Model m;
+  parseInto(kDoc, m);
+  persist(s, m, st);
+
+  // The journal and lamp land; base's write is lost, as a power cut before
+  // it would lose it.
+  m.lamp.name = "both";
+  m.base.segments[0].name = "Edited";
+  s.failKey = "cfgb.base";
+  cs::PersistResult r = persist(s, m, st);
+  TEST_ASSERT_FALSE(r.ok);
+  TEST_ASSERT_TRUE(st.journalPresent);
+  TEST_ASSERT_TRUE(s.has(cs::kJournalKey));
+  s.failKey.clear();
+
+  Model back;
+  cs::StoredState again;
+  cs::LoadResult lr = load(s, back, again);
+  TEST_ASSERT_TRUE(lr.ok);
+  TEST_ASSERT_EQUAL_UINT8(2, lr.replayed);
+  TEST_ASSERT_EQUAL_STRING("both", back.lamp.name.c_str());
+  TEST_ASSERT_EQUAL_STRING("Edited", back.base.segments[0].name.c_str());
+  TEST_ASSERT_FALSE(again.journalPresent);
+  TEST_ASSERT_FALSE(s.has(cs::kJournalKey));
+
+  // The section keys now hold the journal's blobs: the next boot needs no
+  // replay and the first commit is a no-op.
+  Model third;
+  cs::StoredState st3;
+  lr = load(s, third, st3);
+  TEST_ASSERT_EQUAL_UINT8(0, lr.replayed);
+  TEST_ASSERT_EQUAL_STRING(dump(back).c_str(), dump(third).c_str());
+  s.writes.clear();
+  TEST_ASSERT_EQUAL_UINT8(0, persist(s, third, st3).written);
+
+  // A journal that doesn't parse is dropped, and the keys load as stored.
+  const uint8_t torn[] = {0x02, 0x10, 0x00, 0x01};
+  s.writeBytes(cs::kJournalKey, torn, sizeof(torn));
+  lr = load(s, third, st3);
+  TEST_ASSERT_TRUE(lr.ok);
+  TEST_ASSERT_EQUAL_UINT8(0, lr.replayed);
+  TEST_ASSERT_FALSE(s.has(cs::kJournalKey));
+  TEST_ASSERT_EQUAL_STRING(dump(back).c_str(), dump(third).c_str());
+}
+
+void test_corrupt_blob_falls_back_or_fails() {
+  RecordingStore s;
+  cs::StoredState st;
+  Model m;
+  parseInto(kDoc, m);
+  persist(s, m, st);
+  const uint8_t junk[] = {0xEE, 0x00, 0x01};
+  s.writeBytes("cfgb.lamp", junk, sizeof(junk));
+  const std::string mirror = s.read(cs::kLegacyKey, "");
+  s.remove(cs::kLegacyKey);
+
+  // No JSON copy: fail, model untouched.
+  Model fresh;
+  fresh.lamp.name = "untouched";
+  cs::StoredState st2;
+  cs::LoadResult lr = load(s, fresh, st2);
+  TEST_ASSERT_FALSE(lr.ok);
+  TEST_ASSERT_TRUE(lr.hadData);
+  TEST_ASSERT_EQUAL_STRING("untouched", fresh.lamp.name.c_str());
+  TEST_ASSERT_EQUAL_UINT8(60, fresh.homeMode.brightness);
+
+  // The mirrored JSON copy of the section recovers it.
+  s.write(cs::kLegacyKey, mirror.c_str());
+  Model recovered;
+  lr = load(s, recovered, st2);
+  TEST_ASSERT_TRUE(lr.ok);
+  TEST_ASSERT_EQUAL_UINT8(1, lr.fromJson);
+  TEST_ASSERT_EQUAL_STRING("jacko", recovered.lamp.name.c_str());
+  TEST_ASSERT_EQUAL_UINT32(0, st2.hashes[0]);
+}
+
+void test_legacy_edited_by_older_firmware_wins() {
+  RecordingStore s;
+  cs::StoredState st;
+  Model m;
+  parseInto(kDoc, m);
+  persist(s, m, st);
+
+  // Downgraded: older firmware saves "cfg" and knows nothing of the blobs
+  // or the fingerprint.
+  Model older;
+  parseInto(kDoc, older);
+  older.lamp.name = "downgraded";
+  s.write(cs::kLegacyKey, dump(older).c_str());
+
+  Model back;
+  cs::StoredState again;
+  cs::LoadResult lr = load(s, back, again);
+  TEST_ASSERT_TRUE(lr.ok);
+  TEST_ASSERT_TRUE(lr.legacyNewer);
+  TEST_ASSERT_EQUAL_UINT8(cs::kCount, lr.fromJson);
+  TEST_ASSERT_EQUAL_STRING("downgraded", back.lamp.name.c_str());
+
+  // The first commit rewrites every blob from it and re-fingerprints, so
+  // the boot after is back on the blobs.
+  TEST_ASSERT_EQUAL_UINT8(cs::kCount, persist(s, back, again).written);
+  Model third;
+  cs::StoredState st3;
+  lr = load(s, third, st3);
+  TEST_ASSERT_FALSE(lr.legacyNewer);
+  TEST_ASSERT_EQUAL_UINT8(0, lr.fromJson);
+  TEST_ASSERT_EQUAL_STRING("downgraded", third.lamp.name.c_str());
+  s.writes.clear();
+  TEST_ASSERT_EQUAL_UINT8(0, persist(s, third, st3).written);
+  TEST_ASSERT_EQUAL(0, (int)s.writes.size());
+
+  // Blobs stored before the fingerprint existed keep winning over "cfg",
+  // and the first commit brings "cfg" up to date.
+  s.remove(cs::kMirrorKey);
+  s.write(cs::kLegacyKey, kDoc);
+  lr = load(s, third, st3);
+  TEST_ASSERT_FALSE(lr.legacyNewer);
+  TEST_ASSERT_TRUE(st3.mirrorStale);
+  TEST_ASSERT_EQUAL_STRING("downgraded", third.lamp.name.c_str());
+  s.writes.clear();
+  TEST_ASSERT_EQUAL_UINT8(0, persist(s, third, st3).written);
+  TEST_ASSERT_EQUAL(2, (int)s.writes.size());
+  TEST_ASSERT_FALSE(st3.mirrorStale);
+  TEST_ASSERT_EQUAL_STRING(dump(third).c_str(),
+                           s.read(cs::kLegacyKey, "").c_str());
+}
+
+void test_first_boot_and_corrupt_json() {
+  RecordingStore empty;
+  Model fresh;
+  cs::StoredState st;
+  cs::LoadResult lr = load(empty, fresh, st);
+  TEST_ASSERT_TRUE(lr.ok);
+  TEST_ASSERT_FALSE(lr.hadData);
+  TEST_ASSERT_FALSE(st.jsonPresent);
+  TEST_ASSERT_EQUAL_STRING("stray", fresh.lamp.name.c_str());
+
+  RecordingStore s;
+  s.write(cs::kLegacyKey, R"({"lamp":{"name":"jac)");
+  Model m;
+  lr = load(s, m, st);
+  TEST_ASSERT_FALSE(lr.ok);
+  TEST_ASSERT_TRUE(lr.hadData);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_only_changed_sections_written);
+  RUN_TEST(test_load_round_trips_and_first_commit_is_noop);
+  RUN_TEST(test_legacy_document_migrates_and_is_mirrored);
+  RUN_TEST(test_pre_flag_legacy_reports_named_absent);
+  RUN_TEST(test_section_json_keys_win_over_legacy);
+  RUN_TEST(test_failed_section_retried_and_json_kept);
+  RUN_TEST(test_persist_all_rewrites_every_section);
+  RUN_TEST(test_multi_section_commit_goes_through_journal);
+  RUN_TEST(test_interrupted_commit_rolls_forward);
+  RUN_TEST(test_corrupt_blob_falls_back_or_fails);
+  RUN_TEST(test_legacy_edited_by_older_firmware_wins);
+  RUN_TEST(test_first_boot_and_corrupt_json);
+  return UNITY_END();
+}
@@ -0,0 +1,218 @@
+// Native-host tests for the binary MSG_CONTROL_OP payload.
+//
+// Pins:
+//   1. per-op build/parse round-trip (brightness, shade/base colors, knockout)
+//      inside a full CONTROL_OP frame.
+//   2. range / truncation / unknown-code rejects match the JSON receiver's.
+//   3. the payload never starts like JSON or a wisp op, so older receivers
+//      drop it instead of misreading it.
+//   4. dispatch routes by op code through an indexed table and does not
+//      touch the heap (remote brightness drags are allocation-free).
+
+#include <unity.h>
+
+#include <cstdlib>
+#include <new>
+
+#include "components/network/protocol/lamp_protocol.hpp"
+
+namespace lp = lamp_protocol;
+
+// Heap calls made while g_countAllocs is set.
+static bool g_countAllocs = false;
+static size_t g_allocs = 0;
+void* operator new(size_t n) {
+  if (g_countAllocs) ++g_allocs;
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+static const uint8_t kTarget[6] = {0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
+static const uint8_t kSrc[6]    = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+
+// Dispatch recorder: each route stores what it saw.
+static int g_routed = 0;
+static lp::ControlOpCode g_lastOp{};
+static lp::ParsedBinaryControlOp g_last{};
+static void record(const lp::ParsedBinaryControlOp& op) {
+  ++g_routed;
+  g_lastOp = op.op;
+  g_last = op;
+}
+
+constexpr lp::BinaryControlOpRoute kRoutes[] = {
+  {lp::ControlOpCode::Brightness,  record},
+  {lp::ControlOpCode::ShadeColors, record},
+  {lp::ControlOpCode::BaseColors,  record},
+  {lp::ControlOpCode::Knockout,    record},
+};
+static_assert(lp::binaryControlOpRoutesIndexed(kRoutes));
+
+constexpr lp::BinaryControlOpRoute kOutOfOrder[] = {
+  {lp::ControlOpCode::ShadeColors, record},
+  {lp::ControlOpCode::Brightness,  record},
+  {lp::ControlOpCode::BaseColors,  record},
+  {lp::ControlOpCode::Knockout,    record},
+};
+static_assert(!lp::binaryControlOpRoutesIndexed(kOutOfOrder));
+
+void setUp(void) {
+  g_routed = 0;
+  g_last = {};
+}
+void tearDown(void) {}
+
+void test_brightness_roundtrip_through_control_op_frame() {
+  uint8_t op[lp::CONTROL_OP_BINARY_MAX_SIZE];
+  const size_t n = lp::buildBinaryBrightnessOp(op, sizeof(op), 73);
+  TEST_ASSERT_EQUAL_UINT32(3, n);
+
+  uint8_t frame[lp::CONTROL_MAX_SIZE];
+  const size_t f = lp::buildControlOp(frame, sizeof(frame), 7, kTarget, kSrc, op, n);
+  TEST_ASSERT_EQUAL_UINT32(lp::CONTROL_FIXED + 3, f);
+  lp::ParsedControlOp parsed;
+  TEST_ASSERT_TRUE(lp::parseControlOp(frame, f, parsed));
+  TEST_ASSERT_TRUE(lp::isBinaryControlOp(parsed.payload, parsed.payloadLen));
+
+  lp::ParsedBinaryControlOp out;
+  TEST_ASSERT_TRUE(lp::parseBinaryControlOp(parsed.payload, parsed.payloadLen, out));
+  TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(lp::ControlOpCode::Brightness),
+                          static_cast<uint8_t>(out.op));
+  TEST_ASSERT_EQUAL_UINT8(73, out.level);
+}
+
+void test_colors_roundtrip_max_stops() {
+  uint8_t rgbw[lp::CONTROL_OP_MAX_COLORS * 4];
+  for (size_t i = 0; i < sizeof(rgbw); i++) rgbw[i] = static_cast<uint8_t>(i * 7);
+  uint8_t op[lp::CONTROL_OP_BINARY_MAX_SIZE];
+  const size_t n = lp::buildBinaryColorsOp(op, sizeof(op), lp::ControlOpCode::BaseColors,
+                                           rgbw, lp::CONTROL_OP_MAX_COLORS);
+  TEST_ASSERT_EQUAL_UINT32(lp::CONTROL_OP_BINARY_MAX_SIZE, n);
+
+  lp::ParsedBinaryControlOp out;
+  TEST_ASSERT_TRUE(lp::parseBinaryControlOp(op, n, out));
+  TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(lp::ControlOpCode::BaseColors),
+                          static_cast<uint8_t>(out.op));
+  TEST_ASSERT_EQUAL_UINT8(lp::CONTROL_OP_MAX_COLORS, out.colorCount);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(rgbw, out.rgbw, sizeof(rgbw));
+}
+
+void test_knockout_roundtrip() {
+  uint8_t op[4];
+  TEST_ASSERT_EQUAL_UINT32(4, lp::buildBinaryKnockoutOp(op, sizeof(op), 255, 100));
+  lp::ParsedBinaryControlOp out;
+  TEST_ASSERT_TRUE(lp::parseBinaryControlOp(op, 4, out));
+  TEST_ASSERT_EQUAL_UINT8(255, out.pixel);
+  TEST_ASSERT_EQUAL_UINT8(100, out.brightness);
+}
+
+void test_builders_refuse_out_of_range() {
+  uint8_t op[lp::CONTROL_OP_BINARY_MAX_SIZE];
+  const uint8_t rgbw[4] = {1, 2, 3, 4};
+  TEST_ASSERT_EQUAL_UINT32(0, lp::buildBinaryBrightnessOp(op, sizeof(op), 101));
+  TEST_ASSERT_EQUAL_UINT32(0, lp::buildBinaryBrightnessOp(op, 2, 50));
+  TEST_ASSERT_EQUAL_UINT32(0, lp::buildBinaryKnockoutOp(op, sizeof(op), 0, 101));
+  TEST_ASSERT_EQUAL_UINT32(0, lp::buildBinaryColorsOp(op, sizeof(op),
+                                                      lp::ControlOpCode::ShadeColors, rgbw, 0));
+  TEST_ASSERT_EQUAL_UINT32(0, lp::buildBinaryColorsOp(op, sizeof(op),
+                                                      lp::ControlOpCode::ShadeColors, rgbw,
+                                                      lp::CONTROL_OP_MAX_COLORS + 1));
+  TEST_ASSERT_EQUAL_UINT32(0, lp::buildBinaryColorsOp(op, sizeof(op),
+                                                      lp::ControlOpCode::Knockout, rgbw, 1));
+  TEST_ASSERT_EQUAL_UINT32(0, lp::buildBinaryColorsOp(op, 6,
+                                                      lp::ControlOpCode::ShadeColors, rgbw, 1));
+}
+
+void test_parse_rejects_malformed() {
+  lp::ParsedBinaryControlOp out;
+  const uint8_t tooBright[] = {lp::CONTROL_OP_BINARY_TAG, 1, 101};
+  const uint8_t truncatedBrightness[] = {lp::CONTROL_OP_BINARY_TAG, 1};
+  const uint8_t zeroColors[] = {lp::CONTROL_OP_BINARY_TAG, 2, 0};
+  const uint8_t shortColors[] = {lp::CONTROL_OP_BINARY_TAG, 2, 2, 1, 2, 3, 4, 5};
+  const uint8_t tooManyColors[] = {lp::CONTROL_OP_BINARY_TAG, 3, lp::CONTROL_OP_MAX_COLORS + 1};
+  const uint8_t knockoutTooBright[] = {lp::CONTROL_OP_BINARY_TAG, 4, 3, 200};
+  const uint8_t unknownCode[] = {lp::CONTROL_OP_BINARY_TAG, 0x7F, 0};
+  const uint8_t zeroCode[] = {lp::CONTROL_OP_BINARY_TAG, 0, 0};
+  const uint8_t wrongTag[] = {0xC2, 1, 50};
+  TEST_ASSERT_FALSE(lp::parseBinaryControlOp(tooBright, sizeof(tooBright), out));
+  TEST_ASSERT_FALSE(lp::parseBinaryControlOp(truncatedBrightness, sizeof(truncatedBrightness), out));
+  TEST_ASSERT_FALSE(lp::parseBinaryControlOp(zeroColors, sizeof(zeroColors), out));
+  TEST_ASSERT_FALSE(lp::parseBinaryControlOp(shortColors, sizeof(shortColors), out));
+  TEST_ASSERT_FALSE(lp::parseBinaryControlOp(tooManyColors, sizeof(tooManyColors), out));
+  TEST_ASSERT_FALSE(lp::parseBinaryControlOp(knockoutTooBright, sizeof(knockoutTooBright), out));
+  TEST_ASSERT_FALSE(lp::parseBinaryControlOp(unknownCode, sizeof(unknownCode), out));
+  TEST_ASSERT_FALSE(lp::parseBinaryControlOp(zeroCode, sizeof(zeroCode), out));
+  TEST_ASSERT_FALSE(lp::parseBinaryControlOp(wrongTag, sizeof(wrongTag), out));
+  TEST_ASSERT_FALSE(lp::parseBinaryControlOp(nullptr, 3, out));
+}
+
+void test_trailing_bytes_ignored() {
+  const uint8_t op[] = {lp::CONTROL_OP_BINARY_TAG, 1, 40, 0xEE, 0xEE};
+  lp::ParsedBinaryControlOp out;
+  TEST_ASSERT_TRUE(lp::parseBinaryControlOp(op, sizeof(op), out));
+  TEST_ASSERT_EQUAL_UINT8(40, out.level);
+}
+
+// Older lamps feed every CONTROL_OP payload to deserializeJson and wisps
+// switch on 0x01 / 0x02 / '{'; the tag must collide with none of them.
+void test_tag_is_not_json_or_wisp_prefix() {
+  TEST_ASSERT_NOT_EQUAL('{', lp::CONTROL_OP_BINARY_TAG);
+  TEST_ASSERT_NOT_EQUAL(0x01, lp::CONTROL_OP_BINARY_TAG);
+  TEST_ASSERT_NOT_EQUAL(0x02, lp::CONTROL_OP_BINARY_TAG);
+  const char json[] = "{\"char\":\"brightness\",\"value\":50}";
+  TEST_ASSERT_FALSE(lp::isBinaryControlOp(reinterpret_cast<const uint8_t*>(json),
+                                          sizeof(json) - 1));
+}
+
+void test_dispatch_routes_by_code() {
+  uint8_t op[lp::CONTROL_OP_BINARY_MAX_SIZE];
+  size_t n = lp::buildBinaryKnockoutOp(op, sizeof(op), 9, 30);
+  TEST_ASSERT_TRUE(lp::dispatchBinaryControlOp(kRoutes, op, n));
+  TEST_ASSERT_EQUAL(1, g_routed);
+  TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(lp::ControlOpCode::Knockout),
+                          static_cast<uint8_t>(g_lastOp));
+  TEST_ASSERT_EQUAL_UINT8(9, g_last.pixel);
+  TEST_ASSERT_EQUAL_UINT8(30, g_last.brightness);
+
+  const uint8_t rgbw[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  n = lp::buildBinaryColorsOp(op, sizeof(op), lp::ControlOpCode::ShadeColors, rgbw, 2);
+  TEST_ASSERT_TRUE(lp::dispatchBinaryControlOp(kRoutes, op, n));
+  TEST_ASSERT_EQUAL(2, g_routed);
+  TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(lp::ControlOpCode::ShadeColors),
+                          static_cast<uint8_t>(g_lastOp));
+  TEST_ASSERT_EQUAL_UINT8(2, g_last.colorCount);
+
+  const uint8_t bad[] = {lp::CONTROL_OP_BINARY_TAG, 1, 200};
+  TEST_ASSERT_FALSE(lp::dispatchBinaryControlOp(kRoutes, bad, sizeof(bad)));
+  TEST_ASSERT_EQUAL(2, g_routed);
+}
+
+void test_brightness_drag_dispatch_is_allocation_free() {
+  uint8_t op[lp::CONTROL_OP_BINARY_MAX_SIZE];
+  g_allocs = 0;
+  g_countAllocs = true;
+  for (uint8_t level = 0; level <= 100; level++) {
+    const size_t n = lp::buildBinaryBrightnessOp(op, sizeof(op), level);
+    lp::dispatchBinaryControlOp(kRoutes, op, n);
+  }
+  g_countAllocs = false;
+  TEST_ASSERT_EQUAL_UINT32(0, g_allocs);
+  TEST_ASSERT_EQUAL(101, g_routed);
+  TEST_ASSERT_EQUAL_UINT8(100, g_last.level);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_brightness_roundtrip_through_control_op_frame);
+  RUN_TEST(test_colors_roundtrip_max_stops);
+  RUN_TEST(test_knockout_roundtrip);
+  RUN_TEST(test_builders_refuse_out_of_range);
+  RUN_TEST(test_parse_rejects_malformed);
+  RUN_TEST(test_trailing_bytes_ignored);
+  RUN_TEST(test_tag_is_not_json_or_wisp_prefix);
+  RUN_TEST(test_dispatch_routes_by_code);
+  RUN_TEST(test_brightness_drag_dispatch_is_allocation_free);
+  return UNITY_END();
+}
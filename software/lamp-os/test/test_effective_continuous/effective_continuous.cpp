@@ -1,6 +1,5 @@
 #include <unity.h>
 
-#include <map>
 #include <string>
 
 #include "expressions/expression_registry.hpp"
@@ -23,22 +22,22 @@ void setUp() {}
 void tearDown() {}
 
 void test_loop_param_continuous_is_continuous() {
-  std::map<std::string, uint32_t> p = {{"loop", 1}};
+  ParamSet p = {{"loop", 1}};
   TEST_ASSERT_TRUE(effectiveContinuous(kWithLoop, p));
 }
 
 void test_loop_param_trigger_is_not_continuous() {
-  std::map<std::string, uint32_t> p = {{"loop", 0}};
+  ParamSet p = {{"loop", 0}};
   TEST_ASSERT_FALSE(effectiveContinuous(kWithLoop, p));
 }
 
 void test_loop_param_absent_defaults_to_trigger() {
-  std::map<std::string, uint32_t> p;
+  ParamSet p;
   TEST_ASSERT_FALSE(effectiveContinuous(kWithLoop, p));
 }
 
 void test_no_loop_param_uses_descriptor_continuous() {
-  std::map<std::string, uint32_t> p;
+  ParamSet p;
   TEST_ASSERT_TRUE(effectiveContinuous(kContinuousNoLoop, p));
   TEST_ASSERT_FALSE(effectiveContinuous(kOneShotNoLoop, p));
 }
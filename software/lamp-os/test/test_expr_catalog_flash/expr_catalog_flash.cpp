@@ -1,36 +1,46 @@
-// Drift gate: the committed generated/<variant>/expr_catalog.h must be exactly
-// what `npm run catalog:gen` renders today. A stale header (descriptor changed,
-// subset changed, hand-edit) fails here. Byte-equivalence of the base catalog
-// to the on-device serializeCatalog output is separately pinned by
-// test_builtin_descriptors (same kExprDescriptorData constants).
+// The flash-resident exprcat catalog (expressions/expr_catalog.hpp) is built
+// by the compiler from each variant's X-macro set. It must be exactly what
+// ExpressionRegistry::serializeCatalog renders for the same descriptors at
+// runtime, byte for byte and hash for hash, for every set a variant can pick.
+// Byte-equivalence of the descriptors themselves to the app's expectations is
+// separately pinned by test_builtin_descriptors.
 #include <unity.h>
 
-#include <filesystem>
-#include <fstream>
+#include <array>
+#include <cstdint>
 #include <set>
-#include <sstream>
 #include <string>
 
-#include "../expr_catalog_gen/catalog_gen.hpp"
+#include "expressions/expr_catalog.hpp"
 
-using namespace lamp::catalog_gen;
+#include "../../src/expressions/expression_registry.cpp"
+
+using namespace lamp;
 
 namespace {
 
-std::filesystem::path generatedDir() {
-  // <lamp-os>/test/test_expr_catalog_flash/<this file>
-  return std::filesystem::absolute(__FILE__)
-      .parent_path()
-      .parent_path()
-      .parent_path() /
-      "generated";
+#define X(N) &k##N##DescriptorData,
+constexpr std::array kBaseSet = {LAMPOS_BASE_EXPRESSIONS(X)};
+constexpr std::array kSnafuSet = {LAMPOS_SNAFU_EXPRESSIONS(X)};
+constexpr std::array kStaffSet = {LAMPOS_STAFF_EXPRESSIONS(X)};
+#undef X
+
+template <const auto& Set>
+std::string runtimeCatalog() {
+  ExpressionRegistry reg;
+  for (const auto* d : Set) reg.add(*d);
+  return reg.serializeCatalog();
 }
 
-std::string readFile(const std::filesystem::path& p) {
-  std::ifstream f(p, std::ios::binary);
-  std::ostringstream ss;
-  ss << f.rdbuf();
-  return ss.str();
+template <const auto& Set>
+void assertMatchesRuntime(const char* variant) {
+  using C = catalog::Catalog<Set>;
+  const std::string runtime = runtimeCatalog<Set>();
+  TEST_ASSERT_FALSE_MESSAGE(runtime.empty(), variant);
+  TEST_ASSERT_TRUE_MESSAGE(runtime.size() == C::kLen, variant);
+  TEST_ASSERT_EQUAL_STRING_MESSAGE(runtime.c_str(), C::kData.data(), variant);
+  TEST_ASSERT_EQUAL_HEX32_MESSAGE(
+      catalog::fnv1a32(runtime.data(), runtime.size()), C::kHash, variant);
 }
 
 }  // namespace
@@ -38,57 +48,51 @@ std::string readFile(const std::filesystem::path& p) {
 void setUp() {}
 void tearDown() {}
 
-void test_committed_headers_match_generator() {
-  for (const auto& v : variantSpecs()) {
-    const std::filesystem::path path = generatedDir() / v.name / "expr_catalog.h";
-    const std::string committed = readFile(path);
-    TEST_ASSERT_FALSE_MESSAGE(committed.empty(),
-                              (std::string("missing/empty ") + path.string()).c_str());
-    const std::string expected = emitHeader(v);
-    if (committed != expected) {
-      TEST_FAIL_MESSAGE(
-          (std::string("stale generated header for '") + v.name +
-           "'; run `npm run catalog:gen`")
-              .c_str());
-    }
-  }
+void test_constexpr_catalogs_match_serialize_catalog() {
+  assertMatchesRuntime<kBaseSet>("base");
+  assertMatchesRuntime<kSnafuSet>("snafu");
+  assertMatchesRuntime<kStaffSet>("staff");
 }
 
-void test_only_two_distinct_catalogs() {
-  std::set<std::string> catalogs;
-  for (const auto& v : variantSpecs()) catalogs.insert(buildCatalog(v));
-  TEST_ASSERT_EQUAL_size_t(2, catalogs.size());
+// Native builds define no LAMP_BUILD_VARIANT_*, so they get the base set,
+// as standard/lioness/loaf do.
+void test_build_catalog_is_the_base_set() {
+  using Base = catalog::Catalog<kBaseSet>;
+  TEST_ASSERT_EQUAL_UINT32(Base::kLen, kExprCatalogLen);
+  TEST_ASSERT_EQUAL_STRING(Base::kData.data(), kExprCatalog);
+  TEST_ASSERT_EQUAL_HEX32(Base::kHash, kExprCatalogHash);
 }
 
-std::string committedHash(const std::string& variant) {
-  const std::string header = readFile(generatedDir() / variant / "expr_catalog.h");
-  const std::string key = "kExprCatalogHash = ";
-  const size_t at = header.find(key);
-  TEST_ASSERT_TRUE_MESSAGE(at != std::string::npos,
-                           (std::string("no kExprCatalogHash in ") + variant).c_str());
-  const size_t start = at + key.size();
-  return header.substr(start, header.find(';', start) - start);
-}
+// Staff's extra Bloom is internal, so it serves the base catalog; snafu's
+// trimmed set is the only other one.
+void test_only_two_distinct_catalogs() {
+  std::set<std::string> catalogs = {
+      catalog::Catalog<kBaseSet>::kData.data(),
+      catalog::Catalog<kSnafuSet>::kData.data(),
+      catalog::Catalog<kStaffSet>::kData.data(),
+  };
+  TEST_ASSERT_EQUAL_size_t(2, catalogs.size());
 
-void test_committed_hash_matches_fnv() {
-  for (const auto& v : variantSpecs()) {
-    char expected[24];
-    std::snprintf(expected, sizeof(expected), "0x%08xu", fnv1a32(buildCatalog(v)));
-    TEST_ASSERT_EQUAL_STRING_MESSAGE(expected, committedHash(v.name).c_str(), v.name);
-  }
+  std::set<uint32_t> hashes = {
+      catalog::Catalog<kBaseSet>::kHash,
+      catalog::Catalog<kSnafuSet>::kHash,
+      catalog::Catalog<kStaffSet>::kHash,
+  };
+  TEST_ASSERT_EQUAL_size_t(2, hashes.size());
 }
 
-void test_distinct_catalogs_have_distinct_hashes() {
-  std::set<std::string> hashes;
-  for (const auto& v : variantSpecs()) hashes.insert(committedHash(v.name));
-  TEST_ASSERT_EQUAL_size_t(2, hashes.size());
+void test_registry_resolves_every_catalog_id() {
+  ExpressionRegistry reg;
+  for (const auto* d : kStaffSet) reg.add(*d);
+  for (const auto* d : kStaffSet) TEST_ASSERT_EQUAL_PTR(d, reg.find(d->id));
+  TEST_ASSERT_NULL(reg.find("flickr"));
 }
 
 int main(int, char**) {
   UNITY_BEGIN();
-  RUN_TEST(test_committed_headers_match_generator);
+  RUN_TEST(test_constexpr_catalogs_match_serialize_catalog);
+  RUN_TEST(test_build_catalog_is_the_base_set);
   RUN_TEST(test_only_two_distinct_catalogs);
-  RUN_TEST(test_committed_hash_matches_fnv);
-  RUN_TEST(test_distinct_catalogs_have_distinct_hashes);
+  RUN_TEST(test_registry_resolves_every_catalog_id);
   return UNITY_END();
 }
@@ -2,9 +2,11 @@
 
 #include <ArduinoJson.h>
 
-#include <map>
+#include <array>
+#include <cstdio>
 #include <string>
 
+#include "expressions/catalog_constexpr.hpp"
 #include "expressions/expression_registry.hpp"
 #include "expressions/param_utils.hpp"
 
@@ -45,7 +47,7 @@ static constexpr EnumOption kOpts2[] = {
 };
 
 static constexpr ParamSpec kParams2[] = {
-  { .key = "style", .kind = ParamKind::Enum, .label = "Style",
+  { .key = "fillMode", .kind = ParamKind::Enum, .label = "Style",
     .min = 0, .max = 1, .step = 1, .def = 0,
     .options = kOpts2 },
 };
@@ -83,7 +85,7 @@ static constexpr ExpressionDescriptor kDesc3{
 static constexpr ParamSpec kParams4[] = {
   { .key = "size", .kind = ParamKind::Int, .label = "Size",
     .min = 0, .max = Bound::pixels(), .step = 1, .def = Bound::pixels() },
-  { .key = "cap", .kind = ParamKind::Int, .label = "Cap",
+  { .key = "scatter", .kind = ParamKind::Int, .label = "Cap",
     .min = 0, .max = Bound::pixels(), .step = 1, .def = Bound::pixels(10) },
 };
 
@@ -98,6 +100,19 @@ static constexpr ExpressionDescriptor kDesc4{
   .params = kParams4,
 };
 
+// -- Descriptor 5: strings the serializer has to escape.
+static constexpr ExpressionDescriptor kDesc5{
+  .id = "quote",
+  .name = "Say \"hi\"",
+  .colors = { .max = 1, .help = "back\\slash\nnewline" },
+};
+
+// The compile-time catalog covers every branch the fixtures above exercise.
+static constexpr std::array kFixtureSet = {&kDesc1, &kDesc2, &kDesc3, &kDesc4,
+                                           &kDesc5};
+static_assert(catalog::validateSet(kFixtureSet.data(), kFixtureSet.size()) ==
+              nullptr);
+
 void setUp(void) {}
 void tearDown(void) {}
 
@@ -129,42 +144,43 @@ void test_add_replaces_existing_id() {
 
 void test_apply_defaults_fills_missing_and_preserves_present() {
   ExpressionRegistry reg;
-  std::map<std::string, uint32_t> params;
-  params["count"] = 99;  // already present — must not be overwritten
+  ParamSet params;
+  params.set("count", 99);  // already present — must not be overwritten
 
   reg.applyDefaults(kDesc1, params, 30);
-  TEST_ASSERT_EQUAL_UINT32(99, params["count"]);  // untouched
-  // interval range folds into its minKey/maxKey
-  TEST_ASSERT_EQUAL_UINT32(5,  params["intervalMin"]);
-  TEST_ASSERT_EQUAL_UINT32(15, params["intervalMax"]);
+  TEST_ASSERT_EQUAL_UINT32(99, params.get("count", 0));  // untouched
+  // kDesc1's interval keys aren't in kParamKeyNames, so the fold has no slot
+  // to write; the set refuses them rather than growing.
+  TEST_ASSERT_FALSE(params.has("intervalMin"));
+  TEST_ASSERT_EQUAL_size_t(1, params.size());
 
-  // kDesc2 has "style" with def=0
+  // kDesc2 has "fillMode" with def=0
   reg.applyDefaults(kDesc2, params, 30);
-  TEST_ASSERT_TRUE(params.count("style") > 0);
-  TEST_ASSERT_EQUAL_UINT32(0, params["style"]);
+  TEST_ASSERT_TRUE(params.has("fillMode"));
+  TEST_ASSERT_EQUAL_UINT32(0, params.get("fillMode", 99));
 }
 
 void test_apply_defaults_resolves_bounds_and_folds_ranges() {
   ExpressionRegistry reg;
 
-  std::map<std::string, uint32_t> params;
+  ParamSet params;
   reg.applyDefaults(kDesc4, params, 24);
-  TEST_ASSERT_EQUAL_UINT32(24, params["size"]);         // pixels → window
-  TEST_ASSERT_EQUAL_UINT32(10, params["cap"]);          // pixels(10), window > cap
-  TEST_ASSERT_EQUAL_UINT32(3,  params["durationMin"]);  // duration range fold
-  TEST_ASSERT_EQUAL_UINT32(20, params["durationMax"]);
+  TEST_ASSERT_EQUAL_UINT32(24, params.get("size", 0));         // pixels → window
+  TEST_ASSERT_EQUAL_UINT32(10, params.get("scatter", 0));      // pixels(10), window > cap
+  TEST_ASSERT_EQUAL_UINT32(3,  params.get("durationMin", 0));  // duration range fold
+  TEST_ASSERT_EQUAL_UINT32(20, params.get("durationMax", 0));
 
-  std::map<std::string, uint32_t> small;
+  ParamSet small;
   reg.applyDefaults(kDesc4, small, 6);
-  TEST_ASSERT_EQUAL_UINT32(6, small["size"]);           // pixels → window
-  TEST_ASSERT_EQUAL_UINT32(6, small["cap"]);            // min(window, 10)
+  TEST_ASSERT_EQUAL_UINT32(6, small.get("size", 0));           // pixels → window
+  TEST_ASSERT_EQUAL_UINT32(6, small.get("scatter", 0));        // min(window, 10)
 
-  std::map<std::string, uint32_t> preset;
-  preset["size"] = 99;
-  preset["durationMin"] = 42;
+  ParamSet preset;
+  preset.set("size", 99);
+  preset.set("durationMin", 42);
   reg.applyDefaults(kDesc4, preset, 24);
-  TEST_ASSERT_EQUAL_UINT32(99, preset["size"]);         // present key never overwritten
-  TEST_ASSERT_EQUAL_UINT32(42, preset["durationMin"]);
+  TEST_ASSERT_EQUAL_UINT32(99, preset.get("size", 0));         // present key never overwritten
+  TEST_ASSERT_EQUAL_UINT32(42, preset.get("durationMin", 0));
 }
 
 void test_serialize_catalog_schema_version_and_count() {
@@ -451,7 +467,7 @@ void test_serialize_interval_unit_and_label() {
 
 void test_apply_defaults_negative_literal_clamps_to_zero() {
   static constexpr ParamSpec kNegParam[] = {
-    { .key = "neg", .kind = ParamKind::Int, .label = "Neg",
+    { .key = "fire", .kind = ParamKind::Int, .label = "Neg",
       .def = Bound(-3) },
   };
   static constexpr ExpressionDescriptor kNegDesc{
@@ -461,17 +477,18 @@ void test_apply_defaults_negative_literal_clamps_to_zero() {
     .params = kNegParam,
   };
   ExpressionRegistry reg;
-  std::map<std::string, uint32_t> params;
+  ParamSet params;
   reg.applyDefaults(kNegDesc, params, 20);
-  TEST_ASSERT_EQUAL_UINT32(0, params["neg"]);
+  TEST_ASSERT_TRUE(params.has("fire"));
+  TEST_ASSERT_EQUAL_UINT32(0, params.get("fire", 99));
 }
 
 void test_apply_defaults_does_not_overwrite_duration_max_key() {
   ExpressionRegistry reg;
-  std::map<std::string, uint32_t> params;
-  params["durationMax"] = 99;
+  ParamSet params;
+  params.set("durationMax", 99);
   reg.applyDefaults(kDesc4, params, 24);
-  TEST_ASSERT_EQUAL_UINT32(99, params["durationMax"]);
+  TEST_ASSERT_EQUAL_UINT32(99, params.get("durationMax", 0));
 }
 
 void test_advanced_field_serializes_only_when_set() {
@@ -490,6 +507,83 @@ void test_advanced_field_serializes_only_when_set() {
   }
 }
 
+void test_find_is_exact_across_growth_and_removal() {
+  // Enough ids that the table grows past its first size, several sharing a
+  // prefix, so a seed that merely separates first bytes wouldn't do.
+  static char ids[40][8];
+  static ExpressionDescriptor descs[40];
+  ExpressionRegistry reg;
+  for (int i = 0; i < 40; i++) {
+    std::snprintf(ids[i], sizeof(ids[i]), "fx%02d", i);
+    descs[i] = ExpressionDescriptor{.id = ids[i], .name = ids[i]};
+    reg.add(descs[i]);
+    for (int j = 0; j <= i; j++) TEST_ASSERT_EQUAL_PTR(&descs[j], reg.find(ids[j]));
+  }
+  TEST_ASSERT_NULL(reg.find("fx40"));
+  TEST_ASSERT_NULL(reg.find("fx0"));
+  TEST_ASSERT_NULL(reg.find(""));
+  TEST_ASSERT_NULL(reg.find(nullptr));
+
+  for (int i = 0; i < 40; i += 2) reg.remove(ids[i]);
+  for (int i = 0; i < 40; i++) {
+    TEST_ASSERT_EQUAL_PTR(i % 2 ? &descs[i] : nullptr, reg.find(ids[i]));
+  }
+  TEST_ASSERT_NULL(ExpressionRegistry{}.find("fx01"));
+}
+
+void test_constexpr_catalog_matches_serialize_catalog() {
+  using Fixture = catalog::Catalog<kFixtureSet>;
+  ExpressionRegistry reg;
+  for (const auto* d : kFixtureSet) reg.add(*d);
+  const std::string runtime = reg.serializeCatalog();
+  TEST_ASSERT_EQUAL_size_t(runtime.size(), Fixture::kLen);
+  TEST_ASSERT_EQUAL_STRING(runtime.c_str(), Fixture::kData.data());
+  TEST_ASSERT_EQUAL_HEX32(catalog::fnv1a32(runtime.data(), runtime.size()),
+                          Fixture::kHash);
+}
+
+void test_validation_names_the_problem() {
+  static constexpr EnumOption kOutOfRange[] = {{.value = 4, .label = "Four"}};
+  static constexpr ParamSpec kBadParams[][2] = {
+    {{.key = "a", .kind = ParamKind::Int, .label = "A", .max = 5, .step = 0}},
+    {{.key = "a", .kind = ParamKind::Int, .label = "A", .min = 5, .max = 2}},
+    {{.key = "a", .kind = ParamKind::Int, .label = "A", .max = 5, .def = 6}},
+    {{.key = "a", .kind = ParamKind::Enum, .label = "A", .max = 3}},
+    {{.key = "a", .kind = ParamKind::Enum, .label = "A", .max = 3,
+      .options = kOutOfRange}},
+    {{.key = "a", .kind = ParamKind::Int, .label = "A", .max = 5},
+     {.key = "a", .kind = ParamKind::Int, .label = "B", .max = 5}},
+  };
+  static constexpr const char* kWant[] = {
+    "param step must be positive",
+    "param min exceeds max",
+    "param default outside [min, max]",
+    "enum param has no options",
+    "enum option outside [min, max]",
+    "duplicate param key",
+  };
+  for (size_t i = 0; i < 6; i++) {
+    const size_t n = (i == 5) ? 2 : 1;
+    const ExpressionDescriptor d{
+        .id = "x", .name = "X",
+        .params = std::span<const ParamSpec>(kBadParams[i], n)};
+    TEST_ASSERT_EQUAL_STRING(kWant[i], catalog::validateDescriptor(d));
+  }
+
+  const ExpressionDescriptor badRange{
+      .id = "x", .name = "X",
+      .interval = RangeSpec{.min = 10, .max = 20, .defLo = 5, .defHi = 15}};
+  TEST_ASSERT_EQUAL_STRING("range default outside [min, max]",
+                           catalog::validateDescriptor(badRange));
+  const ExpressionDescriptor noName{.id = "x", .name = ""};
+  TEST_ASSERT_EQUAL_STRING("descriptor name is empty",
+                           catalog::validateDescriptor(noName));
+
+  const ExpressionDescriptor* dup[] = {&kDesc1, &kDesc2, &kDesc1};
+  TEST_ASSERT_EQUAL_STRING("duplicate expression id", catalog::validateSet(dup, 3));
+  TEST_ASSERT_NULL(catalog::validateSet(dup, 2));
+}
+
 int main(int, char**) {
   UNITY_BEGIN();
   RUN_TEST(test_add_find_remove);
@@ -522,5 +616,8 @@ int main(int, char**) {
   RUN_TEST(test_apply_defaults_negative_literal_clamps_to_zero);
   RUN_TEST(test_apply_defaults_does_not_overwrite_duration_max_key);
   RUN_TEST(test_advanced_field_serializes_only_when_set);
+  RUN_TEST(test_find_is_exact_across_growth_and_removal);
+  RUN_TEST(test_constexpr_catalog_matches_serialize_catalog);
+  RUN_TEST(test_validation_names_the_problem);
   return UNITY_END();
 }
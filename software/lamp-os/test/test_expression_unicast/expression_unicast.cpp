@@ -17,7 +17,8 @@
 #include <cstring>
 #include <string>
 #include <vector>
-#include <map>
+
+#include "expressions/param_set.hpp"
 
 // Satisfy COMMAND_MAX_PAYLOAD without the full protocol stack.
 static constexpr size_t kCommandMaxPayload = 232;
@@ -34,7 +35,7 @@ struct ExpressionInvocation {
   std::string type;
   std::vector<Color> colors;
   uint8_t target = 3;
-  std::map<std::string, uint32_t> parameters;
+  lamp::ParamSet parameters;
   uint32_t delayMs = 0;
 };
 
@@ -22,6 +22,10 @@
 //   ✓ FW_REQ rewind cursor + reqCountThisSession_ budget hardening
 //     (lamp-side hardening — new, not in the wisp test)
 //   ✓ Full happy path OFFER → ACCEPT → CHUNK× → DONE → RESULT(success)
+//   ✓ Group sessions: join admission, the gather window, per-member
+//     timeouts and declines, and settling Done/Failed on member RESULTs
+//   ✓ Delta sessions: which peers get the patch, and the fall back to the
+//     full image after a DeclineDeltaBase or a failed delta RESULT
 //   ✓ discoverImageLength scan-backward logic (lamp-specific; replaces
 //     the wisp's "totalLen = carrier.size" assumption)
 //   ✗ Real mesh emit (transport_->sendFrame is a FreeRTOS-queued call)
@@ -72,6 +76,17 @@ constexpr uint32_t kDoneRetryIntervalMs   = 300;
 constexpr uint16_t kMaxReqPerSession      = 32;
 // Mirrors kOtaMinRssiDbm (fw_ota.hpp).
 constexpr int8_t   kOtaMinRssiDbm         = -80;
+// Mirrors kMaxGroupMembers / kGroupGatherMs (firmware_distributor.hpp).
+constexpr uint8_t  kMaxGroupMembers       = 8;
+constexpr uint32_t kGroupGatherMs         = 3000;
+// Mirrors PROTOCOL_VERSION_EMIT (header.hpp) and the HELLO_CAP_FW_* bits a
+// group member has to share with its session (presence.hpp).
+constexpr uint8_t  kProtocolVersion       = 0x05;
+constexpr uint8_t  kCapFwReqBitmap        = 0x04;
+constexpr uint8_t  kCapFwFec              = 0x08;
+constexpr uint8_t  kCapFwGroup            = 0x10;
+constexpr uint8_t  kCapFwDelta            = 0x20;
+constexpr uint8_t  kCapFwPacked           = 0x40;
 
 enum class State : uint8_t {
   Disabled = 0,
@@ -88,6 +103,7 @@ enum class FwAcceptStatus : uint8_t {
   DeclineBusy         = 1,
   DeclineAlreadyCurrent = 2,
   DeclineUnverified   = 3,
+  DeclineDeltaBase    = 4,
 };
 
 struct Penalty {
@@ -97,6 +113,15 @@ struct Penalty {
   bool     persistent;
 };
 
+// Group session member; the lead is members_[0].
+enum class MemberState : uint8_t { Offered = 0, Accepted, Succeeded, Failed };
+struct GroupMember {
+  uint8_t     mac[6];
+  uint8_t     offerRetries;
+  uint32_t    offeredMs;
+  MemberState state;
+};
+
 // --- DistAlgo: lamp state machine mirror --------------------------------
 
 // Differences from the wisp's algorithm mirror:
@@ -126,6 +151,27 @@ struct DistAlgo {
   uint8_t  offerRetryCount_     = 0;
   uint16_t reqCountThisSession_ = 0;
 
+  // Group sessions (HELLO_CAP_FW_GROUP): one stream for up to
+  // kMaxGroupMembers peers that share the lead's wire version, chunk size
+  // and stream form. packPlanReady_ stands in for packPlanFor's answer.
+  uint8_t  targetProtocolVersion_ = 0;
+  bool     groupSession_  = false;
+  bool     reqMaskPeer_   = false;
+  bool     fecPeer_       = false;
+  bool     packSession_   = false;
+  bool     packPlanReady_ = false;
+  GroupMember members_[kMaxGroupMembers] = {};
+  uint8_t  memberCount_   = 0;
+
+  // Delta sessions (HELLO_CAP_FW_DELTA): a peer on deltaBaseVersion_ gets the
+  // patch when one is ready, unless it has refused or failed one before.
+  bool     deltaReady_       = false;
+  uint32_t deltaBaseVersion_ = 0;
+  bool     deltaSession_     = false;
+  static constexpr size_t kDeltaRefusedRingSize = 8;
+  uint8_t  deltaRefused_[kDeltaRefusedRingSize][6] = {};
+  uint8_t  deltaRefusedNext_ = 0;
+
   // DONE retry bookkeeping. Same shape as wisp's mirror.
   uint16_t doneSeqCaptured_   = 0;
   uint8_t  doneAttempts_      = 0;
@@ -207,17 +253,51 @@ struct DistAlgo {
     lastOfferSendMs_     = 0;
     offerRetryCount_     = 0;
     reqCountThisSession_ = 0;
+    targetProtocolVersion_ = 0;
+    groupSession_        = false;
+    reqMaskPeer_         = false;
+    fecPeer_             = false;
+    packSession_         = false;
+    memberCount_         = 0;
+    deltaSession_        = false;
+  }
+
+  bool deltaFor(const uint8_t mac[6], uint32_t peerVersion,
+                uint8_t peerCaps) const {
+    if (!deltaReady_ || peerVersion != deltaBaseVersion_ ||
+        (peerCaps & kCapFwDelta) == 0) {
+      return false;
+    }
+    for (size_t i = 0; i < kDeltaRefusedRingSize; ++i) {
+      if (macsEqual(deltaRefused_[i], mac)) return false;
+    }
+    return true;
+  }
+
+  void noteDeltaRefused(const uint8_t mac[6]) {
+    for (size_t i = 0; i < kDeltaRefusedRingSize; ++i) {
+      if (macsEqual(deltaRefused_[i], mac)) return;
+    }
+    std::memcpy(deltaRefused_[deltaRefusedNext_], mac, 6);
+    deltaRefusedNext_ =
+        static_cast<uint8_t>((deltaRefusedNext_ + 1) % kDeltaRefusedRingSize);
   }
 
   // Event-driven targeting — caller (SocialBehavior) supplies a peer
-  // observed via ESP-NOW HELLO. Idempotent on non-Idle. peerMaxChunk mirrors
-  // the peer's HELLO FW_MAX_CHUNK TLV (0 = not advertised).
+  // observed via ESP-NOW HELLO. Idempotent on non-Idle, except that a
+  // gathering group session takes group-capable peers through joinGroup.
+  // peerMaxChunk mirrors the peer's HELLO FW_MAX_CHUNK TLV (0 = not
+  // advertised), peerCaps its HELLO caps byte.
   bool considerPeerForOta(const uint8_t peerMac[6], uint32_t peerVersion,
                           uint32_t nowMs, const char* peerChannel = nullptr,
                           uint16_t peerMaxChunk = 0,
                           int8_t peerRssi = -127,
-                          bool peerBeingServed = false) {
-    if (state_ != State::Idle) return false;
+                          bool peerBeingServed = false,
+                          uint8_t peerCaps = 0,
+                          uint8_t peerProtocolVersion = kProtocolVersion) {
+    const bool joining = state_ == State::OfferSent && groupSession_ &&
+                         (peerCaps & kCapFwGroup) != 0;
+    if (state_ != State::Idle && !joining) return false;
     // Another lamp already owns this peer's transfer; don't stomp it.
     if (peerBeingServed) return false;
     // Use otaAcceptable with roles swapped: asks "would the peer accept this
@@ -234,6 +314,10 @@ struct DistAlgo {
     // Skip peers below the OTA signal floor; unknown RSSI (-127) isn't gated.
     if (peerRssi != -127 && peerRssi < kOtaMinRssiDbm) return false;
     if (peerIsInBackoff(peerMac, nowMs)) return false;
+    if (joining) {
+      return joinGroup(peerMac, peerVersion, peerProtocolVersion, peerMaxChunk,
+                       peerCaps, nowMs);
+    }
     std::memcpy(targetMac_, peerMac, 6);
     state_              = State::OfferSent;
     stateEnteredMs_     = nowMs;
@@ -241,18 +325,171 @@ struct DistAlgo {
     offerRetryCount_    = 0;
     nextChunkIdx_       = 0;
     reqCountThisSession_ = 0;
+    targetProtocolVersion_ = peerProtocolVersion;
     const uint16_t cappedPeerMaxChunk =
         peerMaxChunk < kChunkSizeMax ? peerMaxChunk : kChunkSizeMax;
     sessionChunkSize_ = peerMaxChunk > 0 ? cappedPeerMaxChunk : kChunkSizeBaseline;
+    reqMaskPeer_  = (peerCaps & kCapFwReqBitmap) != 0;
+    groupSession_ = (peerCaps & kCapFwGroup) != 0;
+    deltaSession_ = deltaFor(peerMac, peerVersion, peerCaps);
+    packSession_  = (peerCaps & kCapFwPacked) != 0 && packPlanReady_;
+    fecPeer_      = (peerCaps & kCapFwFec) != 0 && !packSession_;
+    memberCount_  = 0;
+    if (groupSession_) {
+      GroupMember& lead = members_[memberCount_++];
+      std::memcpy(lead.mac, peerMac, 6);
+      lead.offerRetries = 0;
+      lead.offeredMs    = nowMs;
+      lead.state        = MemberState::Offered;
+    }
+    return true;
+  }
+
+  // Production joinGroup: one stream serves every member, so each must parse
+  // the session's wire version, take its chunk size, REQ/decode the way the
+  // stream expects, and want the same bytes (the patch or the image).
+  // Returns whether the peer was admitted.
+  bool joinGroup(const uint8_t peerMac[6], uint32_t peerVersion,
+                 uint8_t peerProtocolVersion, uint16_t peerMaxChunk,
+                 uint8_t peerCaps, uint32_t nowMs) {
+    const uint16_t peerChunk =
+        peerMaxChunk == 0 ? kChunkSizeBaseline
+        : peerMaxChunk < kChunkSizeMax ? peerMaxChunk
+                                       : kChunkSizeMax;
+    const bool peerReqMask = (peerCaps & kCapFwReqBitmap) != 0;
+    const bool peerFec     = (peerCaps & kCapFwFec) != 0 && !packSession_;
+    const bool peerPacked  = (peerCaps & kCapFwPacked) != 0;
+    const bool peerDelta   = deltaFor(peerMac, peerVersion, peerCaps);
+    if (state_ != State::OfferSent || !groupSession_ ||
+        memberCount_ >= kMaxGroupMembers || findMember(peerMac) ||
+        peerProtocolVersion != targetProtocolVersion_ ||
+        peerChunk < sessionChunkSize_ ||
+        peerReqMask != reqMaskPeer_ || peerFec != fecPeer_ ||
+        peerDelta != deltaSession_ || (!peerPacked && packSession_)) {
+      return false;
+    }
+    GroupMember& m = members_[memberCount_++];
+    std::memcpy(m.mac, peerMac, 6);
+    m.offerRetries = 0;
+    m.offeredMs    = nowMs;
+    m.state        = MemberState::Offered;
+    return true;
+  }
+
+  GroupMember* findMember(const uint8_t mac[6]) {
+    for (uint8_t i = 0; i < memberCount_; ++i) {
+      if (macsEqual(members_[i].mac, mac)) return &members_[i];
+    }
+    return nullptr;
+  }
+
+  // Production tickGroup: members time out one by one; the stream starts once
+  // one has accepted, no OFFER retries are still running and the gather
+  // window is over.
+  void tickGroup(uint32_t nowMs) {
+    bool accepted = false;
+    bool retrying = false;
+    for (uint8_t i = 0; i < memberCount_; ++i) {
+      GroupMember& m = members_[i];
+      if (m.state == MemberState::Offered &&
+          nowMs - m.offeredMs > kAcceptTimeoutMs) {
+        m.state = MemberState::Failed;
+        notePeerBackoff(m.mac, nowMs, kPeerBackoffMs);
+      }
+      if (m.state == MemberState::Accepted) accepted = true;
+      if (m.state == MemberState::Offered && m.offerRetries < kMaxOfferRetries) {
+        retrying = true;
+      }
+    }
+    if (settleGroup(nowMs)) return;
+    if (state_ != State::OfferSent || !accepted || retrying ||
+        nowMs - stateEnteredMs_ < kGroupGatherMs) {
+      return;
+    }
+    state_ = State::Streaming;
+    stateEnteredMs_ = nowMs;
+    lastSentMs_ = nowMs;
+  }
+
+  // Production settleGroup: once no member is still Offered or Accepted, the
+  // session is Done if any member verified, Failed otherwise.
+  bool settleGroup(uint32_t nowMs) {
+    if (!groupSession_) return false;
+    const GroupMember* verified = nullptr;
+    for (uint8_t i = 0; i < memberCount_; ++i) {
+      const GroupMember& m = members_[i];
+      if (m.state == MemberState::Offered || m.state == MemberState::Accepted) {
+        return false;
+      }
+      if (m.state == MemberState::Succeeded && !verified) verified = &m;
+    }
+    if (verified) {
+      std::memcpy(targetMac_, verified->mac, 6);
+      captureLastSession();
+    }
+    resetSession();
+    state_ = verified ? State::Done : State::Failed;
+    stateEnteredMs_ = nowMs;
     return true;
   }
 
+  // Production penalizeMembers: a session-wide failure fails every member
+  // still in it, each with its own backoff.
+  void penalizeMembers(uint32_t nowMs, uint32_t durationMs) {
+    for (uint8_t i = 0; i < memberCount_; ++i) {
+      GroupMember& m = members_[i];
+      if (m.state != MemberState::Offered && m.state != MemberState::Accepted) {
+        continue;
+      }
+      m.state = MemberState::Failed;
+      notePeerBackoff(m.mac, nowMs, durationMs);
+    }
+  }
+
+  // Production recordPeerFailure / recordPeerFailureFinalize.
+  void recordPeerFailure(uint32_t nowMs, uint32_t durationMs = kPeerBackoffMs) {
+    if (groupSession_) {
+      penalizeMembers(nowMs, durationMs);
+      return;
+    }
+    notePeerBackoff(targetMac_, nowMs, durationMs);
+  }
+
+  // Session-wide failure: a group settles on what its members already
+  // reported, a single-peer session fails outright.
+  void failSession(uint32_t nowMs) {
+    if (settleGroup(nowMs)) return;
+    resetSession();
+    state_ = State::Failed;
+    stateEnteredMs_ = nowMs;
+  }
+
+  // The group's shared OFFER retry beat (groupOfferStep).
+  void groupOfferStep(uint32_t nowMs) {
+    if (nowMs - lastOfferSendMs_ < kOfferRetryIntervalMs) return;
+    bool sent = false;
+    for (uint8_t i = 0; i < memberCount_; ++i) {
+      GroupMember& m = members_[i];
+      if (m.state != MemberState::Offered || m.offerRetries >= kMaxOfferRetries) {
+        continue;
+      }
+      ++m.offerRetries;
+      sent = true;
+    }
+    if (sent) lastOfferSendMs_ = nowMs;
+  }
+
   void tick(uint32_t nowMs) {
     switch (state_) {
       case State::Disabled:
       case State::Idle:
         return;
       case State::OfferSent:
+        if (groupSession_) {
+          groupOfferStep(nowMs);
+          tickGroup(nowMs);
+          return;
+        }
         if ((nowMs - stateEnteredMs_) > kAcceptTimeoutMs) {
           notePeerBackoff(targetMac_, nowMs);
           resetSession();
@@ -267,6 +504,11 @@ struct DistAlgo {
         }
         return;
       case State::Streaming: {
+        if (groupSession_) {
+          // Expiring the last unanswered OFFER can settle the whole group.
+          tickGroup(nowMs);
+          if (state_ != State::Streaming) return;
+        }
         if (nextChunkIdx_ >= totalChunks_) {
           state_ = State::Finalizing;
           stateEnteredMs_ = nowMs;
@@ -281,10 +523,8 @@ struct DistAlgo {
         }
         if ((nowMs - lastSentMs_) > kChunkResendMs) {
           if (currentChunkRetries_ >= kRetriesPerChunk) {
-            notePeerBackoff(targetMac_, nowMs);
-            resetSession();
-            state_ = State::Failed;
-            stateEnteredMs_ = nowMs;
+            recordPeerFailure(nowMs);
+            failSession(nowMs);
             return;
           }
           currentChunkRetries_++;
@@ -294,10 +534,11 @@ struct DistAlgo {
       }
       case State::Finalizing:
         if ((nowMs - stateEnteredMs_) > kFinalizeTimeoutMs) {
-          notePeerBackoff(targetMac_, nowMs, kPeerFinalizeBackoffMs);
-          resetSession();
-          state_ = State::Failed;
-          stateEnteredMs_ = nowMs;
+          // A group with a verified member still ends Done.
+          recordPeerFailure(nowMs, kPeerFinalizeBackoffMs);
+          failSession(nowMs);
+        } else if (groupSession_) {
+          tickGroup(nowMs);
         }
         return;
       case State::Failed:
@@ -311,8 +552,21 @@ struct DistAlgo {
 
   void onAccept(const uint8_t fromMac[6], uint32_t nowMs,
                 FwAcceptStatus status = FwAcceptStatus::Accept) {
+    if (groupSession_) {
+      onMemberAccept(fromMac, nowMs, status);
+      return;
+    }
     if (state_ != State::OfferSent) return;
     if (!macsEqual(fromMac, targetMac_)) return;
+    if (status == FwAcceptStatus::DeclineDeltaBase) {
+      // Not on the patch's base after all. No backoff: the next consider
+      // offers it the full image.
+      noteDeltaRefused(fromMac);
+      resetSession();
+      state_ = State::Failed;
+      stateEnteredMs_ = nowMs;
+      return;
+    }
     if (status != FwAcceptStatus::Accept) {
       // Offers go only to peers read as behind; already-current back from one
       // means it can't accept the local variant. Block it instead of a
@@ -331,6 +585,48 @@ struct DistAlgo {
     stateEnteredMs_ = nowMs;
   }
 
+  // A group member answers its own OFFER, possibly after the stream started.
+  // A decline takes only that member out; the rest carry on.
+  void onMemberAccept(const uint8_t fromMac[6], uint32_t nowMs,
+                      FwAcceptStatus status) {
+    GroupMember* member = findMember(fromMac);
+    if (!isInProgress() || !member || member->state != MemberState::Offered) {
+      return;
+    }
+    if (status == FwAcceptStatus::DeclineDeltaBase) {
+      noteDeltaRefused(fromMac);
+      member->state = MemberState::Failed;
+      settleGroup(nowMs);
+      return;
+    }
+    if (status != FwAcceptStatus::Accept) {
+      const bool block = status == FwAcceptStatus::DeclineAlreadyCurrent;
+      member->state = MemberState::Failed;
+      notePeerBackoff(member->mac, nowMs, block ? 0 : kPeerBackoffMs, block);
+      settleGroup(nowMs);
+      return;
+    }
+    // Gathering members wait for tickGroup to start the stream.
+    member->state = MemberState::Accepted;
+    if (state_ == State::Finalizing) {
+      state_ = State::Streaming;
+      stateEnteredMs_ = nowMs;
+      lastSentMs_ = nowMs;
+    }
+  }
+
+  bool isInProgress() const {
+    return state_ == State::OfferSent || state_ == State::Streaming ||
+           state_ == State::Finalizing;
+  }
+
+  // Production isStreamPeer: the target, or in a group any accepted member.
+  bool isStreamPeer(const uint8_t mac[6]) {
+    if (!groupSession_) return macsEqual(mac, targetMac_);
+    const GroupMember* m = findMember(mac);
+    return m && m->state == MemberState::Accepted;
+  }
+
   // Mirror of the lamp-side hardening: reqCountThisSession_ is
   // bumped per accepted REQ; exceeding kMaxReqPerSession aborts the
   // session with a full peer-backoff penalty (not the short
@@ -338,13 +634,11 @@ struct DistAlgo {
   // catastrophically broken peer).
   void onReq(const uint8_t fromMac[6], uint16_t firstIdx, uint32_t nowMs) {
     if (state_ != State::Streaming && state_ != State::Finalizing) return;
-    if (!macsEqual(fromMac, targetMac_)) return;
+    if (!isStreamPeer(fromMac)) return;
     if (firstIdx >= totalChunks_) return;
     if (reqCountThisSession_ >= kMaxReqPerSession) {
-      notePeerBackoff(targetMac_, nowMs);  // 10-min backoff
-      resetSession();
-      state_ = State::Failed;
-      stateEnteredMs_ = nowMs;
+      recordPeerFailure(nowMs);  // 10-min backoff
+      failSession(nowMs);
       return;
     }
     reqCountThisSession_++;
@@ -369,7 +663,24 @@ struct DistAlgo {
     lastSessionValid_       = true;
   }
 
+  // A group member can verify while another member's REQ has the stream
+  // back in Streaming; its RESULT settles only that member.
+  GroupMember* resultMember(const uint8_t fromMac[6]) {
+    if (state_ != State::Streaming && state_ != State::Finalizing) {
+      return nullptr;
+    }
+    GroupMember* m = findMember(fromMac);
+    return m && m->state == MemberState::Accepted ? m : nullptr;
+  }
+
   void onResultSuccess(const uint8_t fromMac[6], uint32_t nowMs) {
+    if (groupSession_) {
+      GroupMember* m = resultMember(fromMac);
+      if (!m) return;
+      m->state = MemberState::Succeeded;
+      settleGroup(nowMs);
+      return;
+    }
     if (state_ != State::Finalizing) return;
     if (!macsEqual(fromMac, targetMac_)) return;
     captureLastSession();
@@ -378,9 +689,20 @@ struct DistAlgo {
     stateEnteredMs_ = nowMs;
   }
 
+  // A failed delta (a bad patch, say) is retried with the full image.
   void onResultFail(const uint8_t fromMac[6], uint32_t nowMs) {
+    if (groupSession_) {
+      GroupMember* m = resultMember(fromMac);
+      if (!m) return;
+      if (deltaSession_) noteDeltaRefused(fromMac);
+      m->state = MemberState::Failed;
+      notePeerBackoff(m->mac, nowMs, kPeerBackoffMs);
+      settleGroup(nowMs);
+      return;
+    }
     if (state_ != State::Finalizing) return;
     if (!macsEqual(fromMac, targetMac_)) return;
+    if (deltaSession_) noteDeltaRefused(fromMac);
     notePeerBackoff(targetMac_, nowMs);
     resetSession();
     state_ = State::Failed;
@@ -1203,6 +1525,415 @@ void test_discoverImageLength_rejects_null_args(void) {
   TEST_ASSERT_FALSE(lf::discoverSignedImageLength(reader, buf.size(), nullptr));
 }
 
+// =============================================================================
+// Group sessions (HELLO_CAP_FW_GROUP)
+// =============================================================================
+
+constexpr uint8_t  kGroupCaps = kCapFwGroup | kCapFwReqBitmap;
+constexpr uint32_t kBehindVer = 0x00010004u;
+
+// A group session led by tail 1 at t=0, at the max chunk size.
+static DistAlgo makeGroup(bool packPlanReady = false,
+                          uint8_t leadCaps = kGroupCaps) {
+  DistAlgo d = makeAlgo();
+  d.packPlanReady_ = packPlanReady;
+  uint8_t lead[6]; macFromTail(lead, 1);
+  d.considerPeerForOta(lead, kBehindVer, 0, nullptr, kChunkSizeMax, -127,
+                       false, leadCaps);
+  return d;
+}
+
+static bool joinGroup(DistAlgo& d, uint8_t tail, uint32_t nowMs,
+                      uint16_t maxChunk = kChunkSizeMax,
+                      uint8_t caps = kGroupCaps,
+                      uint8_t protocolVersion = kProtocolVersion) {
+  uint8_t mac[6]; macFromTail(mac, tail);
+  return d.considerPeerForOta(mac, kBehindVer, nowMs, nullptr, maxChunk, -127,
+                              false, caps, protocolVersion);
+}
+
+static void acceptMember(DistAlgo& d, uint8_t tail, uint32_t nowMs,
+                         FwAcceptStatus status = FwAcceptStatus::Accept) {
+  uint8_t mac[6]; macFromTail(mac, tail);
+  d.onAccept(mac, nowMs, status);
+}
+
+// Ticks every 100 ms from `fromMs` until the state leaves `from` or `untilMs`
+// passes; returns the tick that moved it (0 if none did).
+static uint32_t tickUntilLeaves(DistAlgo& d, State from, uint32_t fromMs,
+                                uint32_t untilMs) {
+  for (uint32_t t = fromMs; t <= untilMs; t += 100) {
+    d.tick(t);
+    if (d.state_ != from) return t;
+  }
+  return 0;
+}
+
+// Lead and tail 2 accepted and the stream run out to Finalizing.
+static uint32_t runGroupToFinalizing(DistAlgo& d) {
+  TEST_ASSERT_TRUE(joinGroup(d, 2, 50));
+  acceptMember(d, 1, 100);
+  acceptMember(d, 2, 150);
+  const uint32_t startMs = tickUntilLeaves(d, State::OfferSent, 200, 10000);
+  TEST_ASSERT_EQUAL(State::Streaming, d.state_);
+  const uint32_t finMs = tickUntilLeaves(d, State::Streaming, startMs + 100,
+                                         startMs + 1000);
+  TEST_ASSERT_EQUAL(State::Finalizing, d.state_);
+  return finMs;
+}
+
+void test_group_lead_opens_session(void) {
+  DistAlgo d = makeGroup();
+  TEST_ASSERT_EQUAL(State::OfferSent, d.state_);
+  TEST_ASSERT_TRUE(d.groupSession_);
+  TEST_ASSERT_EQUAL_UINT8(1, d.memberCount_);
+  TEST_ASSERT_EQUAL_UINT16(kChunkSizeMax, d.sessionChunkSize_);
+  TEST_ASSERT_TRUE(d.members_[0].state == MemberState::Offered);
+  // Without the cap the session is single-peer and takes no one else.
+  DistAlgo single = makeGroup(false, kCapFwReqBitmap);
+  TEST_ASSERT_FALSE(single.groupSession_);
+  TEST_ASSERT_FALSE(joinGroup(single, 2, 50));
+}
+
+void test_group_join_admits_matching_peer(void) {
+  DistAlgo d = makeGroup();
+  TEST_ASSERT_TRUE(joinGroup(d, 2, 50));
+  TEST_ASSERT_EQUAL_UINT8(2, d.memberCount_);
+  TEST_ASSERT_TRUE(d.members_[1].state == MemberState::Offered);
+  TEST_ASSERT_EQUAL_UINT32(50, d.members_[1].offeredMs);
+  // An overstated chunk size is capped, so it still fits.
+  TEST_ASSERT_TRUE(joinGroup(d, 3, 60, 4096));
+}
+
+// Every member gets the session's chunk size; a smaller one can't take it.
+void test_group_join_rejects_smaller_chunk(void) {
+  DistAlgo d = makeGroup();
+  TEST_ASSERT_FALSE(joinGroup(d, 2, 50, kChunkSizeMax - 1));
+  TEST_ASSERT_FALSE(joinGroup(d, 3, 50, /*not advertised=*/0));
+  TEST_ASSERT_EQUAL_UINT8(1, d.memberCount_);
+}
+
+// A member has to REQ and decode the way the stream expects.
+void test_group_join_rejects_caps_mismatch(void) {
+  DistAlgo d = makeGroup();
+  TEST_ASSERT_FALSE(joinGroup(d, 2, 50, kChunkSizeMax, kCapFwGroup));
+  TEST_ASSERT_FALSE(joinGroup(d, 3, 50, kChunkSizeMax, kGroupCaps | kCapFwFec));
+  TEST_ASSERT_FALSE(joinGroup(d, 4, 50, kChunkSizeMax, kCapFwReqBitmap));
+  TEST_ASSERT_EQUAL_UINT8(1, d.memberCount_);
+}
+
+// A packed stream needs packed members; FEC doesn't ride a packed session, so
+// a member's FEC cap doesn't count against it there.
+void test_group_join_packed_session(void) {
+  DistAlgo d = makeGroup(/*packPlanReady=*/true,
+                         kGroupCaps | kCapFwPacked | kCapFwFec);
+  TEST_ASSERT_TRUE(d.packSession_);
+  TEST_ASSERT_FALSE(d.fecPeer_);
+  TEST_ASSERT_FALSE(joinGroup(d, 2, 50, kChunkSizeMax, kGroupCaps));
+  TEST_ASSERT_TRUE(joinGroup(d, 3, 50, kChunkSizeMax, kGroupCaps | kCapFwPacked));
+  TEST_ASSERT_TRUE(joinGroup(d, 4, 50, kChunkSizeMax,
+                             kGroupCaps | kCapFwPacked | kCapFwFec));
+}
+
+void test_group_join_rejects_protocol_mismatch(void) {
+  DistAlgo d = makeGroup();
+  TEST_ASSERT_FALSE(joinGroup(d, 2, 50, kChunkSizeMax, kGroupCaps,
+                              kProtocolVersion - 1));
+  TEST_ASSERT_EQUAL_UINT8(1, d.memberCount_);
+}
+
+void test_group_join_caps_at_max_members(void) {
+  DistAlgo d = makeGroup();
+  for (uint8_t tail = 2; tail <= kMaxGroupMembers; ++tail) {
+    TEST_ASSERT_TRUE(joinGroup(d, tail, 50));
+  }
+  TEST_ASSERT_EQUAL_UINT8(kMaxGroupMembers, d.memberCount_);
+  TEST_ASSERT_FALSE(joinGroup(d, kMaxGroupMembers + 1, 60));
+  TEST_ASSERT_EQUAL_UINT8(kMaxGroupMembers, d.memberCount_);
+}
+
+void test_group_join_rejects_present_member(void) {
+  DistAlgo d = makeGroup();
+  TEST_ASSERT_FALSE(joinGroup(d, 1, 50));
+  TEST_ASSERT_TRUE(joinGroup(d, 2, 50));
+  TEST_ASSERT_FALSE(joinGroup(d, 2, 60));
+  TEST_ASSERT_EQUAL_UINT8(2, d.memberCount_);
+  TEST_ASSERT_EQUAL_UINT32(50, d.members_[1].offeredMs);
+}
+
+void test_group_join_skips_peer_in_backoff(void) {
+  DistAlgo d = makeGroup();
+  uint8_t mac[6]; macFromTail(mac, 2);
+  d.notePeerBackoff(mac, 0);
+  TEST_ASSERT_FALSE(joinGroup(d, 2, 50));
+  TEST_ASSERT_EQUAL_UINT8(1, d.memberCount_);
+}
+
+// Joining ends when the stream starts.
+void test_group_join_only_while_gathering(void) {
+  DistAlgo d = makeGroup();
+  acceptMember(d, 1, 100);
+  tickUntilLeaves(d, State::OfferSent, 200, 10000);
+  TEST_ASSERT_EQUAL(State::Streaming, d.state_);
+  TEST_ASSERT_FALSE(joinGroup(d, 2, d.stateEnteredMs_ + 10));
+}
+
+// Accepted members wait out the gather window before the stream starts.
+void test_group_streams_after_gather_window(void) {
+  DistAlgo d = makeGroup();
+  TEST_ASSERT_TRUE(joinGroup(d, 2, 50));
+  acceptMember(d, 1, 100);
+  acceptMember(d, 2, 150);
+  TEST_ASSERT_EQUAL(State::OfferSent, d.state_);
+  const uint32_t startMs = tickUntilLeaves(d, State::OfferSent, 200, 10000);
+  TEST_ASSERT_EQUAL(State::Streaming, d.state_);
+  TEST_ASSERT_EQUAL_UINT32(kGroupGatherMs, startMs);
+}
+
+// A member still retrying its OFFER holds the stream past the window, until
+// its retries run out.
+void test_group_gather_waits_for_offer_retries(void) {
+  DistAlgo d = makeGroup();
+  acceptMember(d, 1, 100);
+  tickUntilLeaves(d, State::OfferSent, 200, 2400);
+  TEST_ASSERT_TRUE(joinGroup(d, 2, 2500));
+  const uint32_t startMs = tickUntilLeaves(d, State::OfferSent, 2500, 10000);
+  TEST_ASSERT_EQUAL(State::Streaming, d.state_);
+  TEST_ASSERT_TRUE(startMs > kGroupGatherMs);
+  TEST_ASSERT_TRUE(startMs < 2500 + kAcceptTimeoutMs);
+  TEST_ASSERT_EQUAL_UINT8(kMaxOfferRetries, d.members_[1].offerRetries);
+  TEST_ASSERT_TRUE(d.members_[1].state == MemberState::Offered);
+}
+
+// Nobody accepts: each member times out into backoff and the group fails.
+void test_group_fails_when_no_member_accepts(void) {
+  DistAlgo d = makeGroup();
+  tickUntilLeaves(d, State::OfferSent, 100, 900);
+  TEST_ASSERT_TRUE(joinGroup(d, 2, 1000));
+  const uint32_t endMs = tickUntilLeaves(d, State::OfferSent, 1000, 10000);
+  TEST_ASSERT_EQUAL(State::Failed, d.state_);
+  TEST_ASSERT_TRUE(endMs > 1000 + kAcceptTimeoutMs);
+  uint8_t a[6]; macFromTail(a, 1);
+  uint8_t b[6]; macFromTail(b, 2);
+  TEST_ASSERT_TRUE(d.peerIsInBackoff(a, endMs + 1));
+  TEST_ASSERT_TRUE(d.peerIsInBackoff(b, endMs + 1));
+  TEST_ASSERT_FALSE(d.lastSessionValid_);
+}
+
+// One member declining leaves the rest gathering.
+void test_group_decline_takes_out_one_member(void) {
+  DistAlgo d = makeGroup();
+  TEST_ASSERT_TRUE(joinGroup(d, 2, 50));
+  acceptMember(d, 2, 100, FwAcceptStatus::DeclineBusy);
+  TEST_ASSERT_EQUAL(State::OfferSent, d.state_);
+  TEST_ASSERT_TRUE(d.members_[1].state == MemberState::Failed);
+  uint8_t b[6]; macFromTail(b, 2);
+  TEST_ASSERT_TRUE(d.peerIsInBackoff(b, 200));
+  acceptMember(d, 1, 150);
+  tickUntilLeaves(d, State::OfferSent, 200, 10000);
+  TEST_ASSERT_EQUAL(State::Streaming, d.state_);
+}
+
+// Settles Done once every member has reported, if any of them verified; the
+// indicator hold shows the verified one.
+void test_group_settles_done_if_any_member_verified(void) {
+  DistAlgo d = makeGroup();
+  const uint32_t finMs = runGroupToFinalizing(d);
+  uint8_t a[6]; macFromTail(a, 1);
+  uint8_t b[6]; macFromTail(b, 2);
+  d.onResultFail(b, finMs + 100);
+  TEST_ASSERT_EQUAL(State::Finalizing, d.state_);
+  d.onResultSuccess(a, finMs + 200);
+  TEST_ASSERT_EQUAL(State::Done, d.state_);
+  TEST_ASSERT_TRUE(d.lastSessionValid_);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(a, d.lastSessionPeerMac_, 6);
+  TEST_ASSERT_FALSE(d.peerIsInBackoff(a, finMs + 300));
+  TEST_ASSERT_TRUE(d.peerIsInBackoff(b, finMs + 300));
+}
+
+void test_group_settles_failed_if_none_verified(void) {
+  DistAlgo d = makeGroup();
+  const uint32_t finMs = runGroupToFinalizing(d);
+  uint8_t a[6]; macFromTail(a, 1);
+  uint8_t b[6]; macFromTail(b, 2);
+  d.onResultFail(a, finMs + 100);
+  d.onResultFail(b, finMs + 200);
+  TEST_ASSERT_EQUAL(State::Failed, d.state_);
+  TEST_ASSERT_FALSE(d.lastSessionValid_);
+}
+
+// FINALIZE timeout: members that never sent RESULT get the short backoff,
+// and a verified member still makes it Done.
+void test_group_finalize_timeout_backs_off_silent_members(void) {
+  DistAlgo d = makeGroup();
+  const uint32_t finMs = runGroupToFinalizing(d);
+  uint8_t a[6]; macFromTail(a, 1);
+  uint8_t b[6]; macFromTail(b, 2);
+  d.onResultSuccess(a, finMs + 100);
+  TEST_ASSERT_EQUAL(State::Finalizing, d.state_);
+  const uint32_t timeoutMs = finMs + kFinalizeTimeoutMs + 1;
+  d.tick(timeoutMs);
+  TEST_ASSERT_EQUAL(State::Done, d.state_);
+  TEST_ASSERT_FALSE(d.peerIsInBackoff(a, timeoutMs));
+  TEST_ASSERT_TRUE(d.peerIsInBackoff(b, timeoutMs));
+  TEST_ASSERT_FALSE(d.peerIsInBackoff(b, timeoutMs + kPeerFinalizeBackoffMs));
+}
+
+// A member that never answers its OFFER times out into backoff while the
+// others stream, and the session still ends Done.
+void test_group_member_times_out_while_streaming(void) {
+  DistAlgo d = makeGroup();
+  d.totalChunks_ = 400;
+  acceptMember(d, 1, 100);
+  tickUntilLeaves(d, State::OfferSent, 200, 1900);
+  TEST_ASSERT_TRUE(joinGroup(d, 2, 2000));
+  const uint32_t startMs = tickUntilLeaves(d, State::OfferSent, 2000, 10000);
+  TEST_ASSERT_EQUAL(State::Streaming, d.state_);
+  uint8_t a[6]; macFromTail(a, 1);
+  uint8_t b[6]; macFromTail(b, 2);
+  tickUntilLeaves(d, State::Streaming, startMs + 100, 2000 + kAcceptTimeoutMs);
+  TEST_ASSERT_EQUAL(State::Streaming, d.state_);
+  TEST_ASSERT_TRUE(d.members_[1].state == MemberState::Offered);
+  d.tick(2000 + kAcceptTimeoutMs + 100);
+  TEST_ASSERT_EQUAL(State::Streaming, d.state_);
+  TEST_ASSERT_TRUE(d.members_[1].state == MemberState::Failed);
+  TEST_ASSERT_TRUE(d.peerIsInBackoff(b, 2000 + kAcceptTimeoutMs + 100));
+  const uint32_t finMs = tickUntilLeaves(d, State::Streaming,
+                                         2000 + kAcceptTimeoutMs + 200, 20000);
+  TEST_ASSERT_EQUAL(State::Finalizing, d.state_);
+  d.onResultSuccess(a, finMs + 100);
+  TEST_ASSERT_EQUAL(State::Done, d.state_);
+}
+
+// =============================================================================
+// Delta sessions (HELLO_CAP_FW_DELTA)
+// =============================================================================
+
+// A distributor holding a patch from kBehindVer.
+static DistAlgo makeDeltaAlgo() {
+  DistAlgo d = makeAlgo();
+  d.deltaReady_       = true;
+  d.deltaBaseVersion_ = kBehindVer;
+  return d;
+}
+
+static bool considerDelta(DistAlgo& d, const uint8_t mac[6], uint32_t nowMs,
+                          uint8_t caps = kCapFwDelta,
+                          uint32_t version = kBehindVer) {
+  return d.considerPeerForOta(mac, version, nowMs, nullptr, 0, -127, false,
+                              caps);
+}
+
+// Only a delta-capable peer on the patch's base gets the patch.
+void test_delta_offered_to_peer_on_base(void) {
+  uint8_t p[6]; macFromTail(p, 1);
+  DistAlgo d = makeDeltaAlgo();
+  TEST_ASSERT_TRUE(considerDelta(d, p, 0));
+  TEST_ASSERT_TRUE(d.deltaSession_);
+
+  DistAlgo older = makeDeltaAlgo();
+  TEST_ASSERT_TRUE(considerDelta(older, p, 0, kCapFwDelta, kBehindVer - 1));
+  TEST_ASSERT_FALSE(older.deltaSession_);
+
+  DistAlgo noCap = makeDeltaAlgo();
+  TEST_ASSERT_TRUE(considerDelta(noCap, p, 0, 0));
+  TEST_ASSERT_FALSE(noCap.deltaSession_);
+
+  DistAlgo noPatch = makeAlgo();
+  noPatch.deltaBaseVersion_ = kBehindVer;
+  TEST_ASSERT_TRUE(considerDelta(noPatch, p, 0));
+  TEST_ASSERT_FALSE(noPatch.deltaSession_);
+}
+
+// DeclineDeltaBase: no backoff, and the next OFFER to that peer is the full
+// image.
+void test_delta_decline_falls_back_to_full_image(void) {
+  uint8_t p[6]; macFromTail(p, 1);
+  DistAlgo d = makeDeltaAlgo();
+  TEST_ASSERT_TRUE(considerDelta(d, p, 0));
+  TEST_ASSERT_TRUE(d.deltaSession_);
+  d.onAccept(p, 100, FwAcceptStatus::DeclineDeltaBase);
+  TEST_ASSERT_EQUAL(State::Failed, d.state_);
+  TEST_ASSERT_FALSE(d.peerIsInBackoff(p, 100));
+  d.tick(200);
+  TEST_ASSERT_EQUAL(State::Idle, d.state_);
+
+  TEST_ASSERT_TRUE(considerDelta(d, p, 300));
+  TEST_ASSERT_EQUAL(State::OfferSent, d.state_);
+  TEST_ASSERT_FALSE(d.deltaSession_);
+  // Other peers on the base still get the patch.
+  d.onAccept(p, 400, FwAcceptStatus::DeclineBusy);
+  d.tick(500);
+  d.tick(600);
+  uint8_t q[6]; macFromTail(q, 2);
+  TEST_ASSERT_TRUE(considerDelta(d, q, 700));
+  TEST_ASSERT_TRUE(d.deltaSession_);
+}
+
+// A delta session that fails its RESULT (a bad patch, say) is retried with
+// the full image once the backoff is over.
+void test_delta_result_fail_falls_back_to_full_image(void) {
+  uint8_t p[6]; macFromTail(p, 1);
+  DistAlgo d = makeDeltaAlgo();
+  TEST_ASSERT_TRUE(considerDelta(d, p, 0));
+  d.onAccept(p, 100);
+  d.tick(200);
+  d.tick(300);
+  d.tick(400);
+  TEST_ASSERT_EQUAL(State::Finalizing, d.state_);
+  d.onResultFail(p, 500);
+  TEST_ASSERT_EQUAL(State::Failed, d.state_);
+  TEST_ASSERT_TRUE(d.peerIsInBackoff(p, 600));
+  d.tick(600);
+
+  const uint32_t later = 500 + kPeerBackoffMs;
+  TEST_ASSERT_TRUE(considerDelta(d, p, later));
+  TEST_ASSERT_FALSE(d.deltaSession_);
+}
+
+// The refused ring holds each peer once and keeps the last eight.
+void test_delta_refused_ring(void) {
+  DistAlgo d = makeDeltaAlgo();
+  uint8_t first[6]; macFromTail(first, 1);
+  d.noteDeltaRefused(first);
+  d.noteDeltaRefused(first);
+  TEST_ASSERT_EQUAL_UINT8(1, d.deltaRefusedNext_);
+  TEST_ASSERT_FALSE(d.deltaFor(first, kBehindVer, kCapFwDelta));
+  for (uint8_t tail = 2; tail <= DistAlgo::kDeltaRefusedRingSize; ++tail) {
+    uint8_t mac[6]; macFromTail(mac, tail);
+    d.noteDeltaRefused(mac);
+  }
+  TEST_ASSERT_FALSE(d.deltaFor(first, kBehindVer, kCapFwDelta));
+  uint8_t ninth[6]; macFromTail(ninth, DistAlgo::kDeltaRefusedRingSize + 1);
+  d.noteDeltaRefused(ninth);
+  TEST_ASSERT_TRUE(d.deltaFor(first, kBehindVer, kCapFwDelta));
+  TEST_ASSERT_FALSE(d.deltaFor(ninth, kBehindVer, kCapFwDelta));
+}
+
+// In a group, a member wanting other bytes than the session stays out, and a
+// member declining the patch leaves without a backoff and the group carries
+// on.
+void test_delta_group_member_decline(void) {
+  DistAlgo d = makeDeltaAlgo();
+  uint8_t lead[6]; macFromTail(lead, 1);
+  TEST_ASSERT_TRUE(considerDelta(d, lead, 0, kGroupCaps | kCapFwDelta));
+  TEST_ASSERT_TRUE(d.groupSession_);
+  TEST_ASSERT_TRUE(d.deltaSession_);
+  TEST_ASSERT_FALSE(joinGroup(d, 2, 50, 0, kGroupCaps));
+  TEST_ASSERT_TRUE(joinGroup(d, 3, 50, 0, kGroupCaps | kCapFwDelta));
+  TEST_ASSERT_EQUAL_UINT8(2, d.memberCount_);
+
+  uint8_t m[6]; macFromTail(m, 3);
+  d.onAccept(m, 100, FwAcceptStatus::DeclineDeltaBase);
+  TEST_ASSERT_TRUE(d.members_[1].state == MemberState::Failed);
+  TEST_ASSERT_FALSE(d.peerIsInBackoff(m, 100));
+  TEST_ASSERT_FALSE(d.deltaFor(m, kBehindVer, kCapFwDelta));
+  TEST_ASSERT_EQUAL(State::OfferSent, d.state_);
+  d.onAccept(lead, 150);
+  tickUntilLeaves(d, State::OfferSent, 200, 10000);
+  TEST_ASSERT_EQUAL(State::Streaming, d.state_);
+}
+
 // =============================================================================
 // Channel-aware considerPeerForOta (promotion gating)
 // =============================================================================
@@ -1341,6 +2072,31 @@ int main(int, char**) {
   RUN_TEST(test_isDistributingTo_false_for_other_mac);
   RUN_TEST(test_isDistributingTo_false_when_idle);
   RUN_TEST(test_isDistributingTo_false_after_done);
+  // Group sessions
+  RUN_TEST(test_group_lead_opens_session);
+  RUN_TEST(test_group_join_admits_matching_peer);
+  RUN_TEST(test_group_join_rejects_smaller_chunk);
+  RUN_TEST(test_group_join_rejects_caps_mismatch);
+  RUN_TEST(test_group_join_packed_session);
+  RUN_TEST(test_group_join_rejects_protocol_mismatch);
+  RUN_TEST(test_group_join_caps_at_max_members);
+  RUN_TEST(test_group_join_rejects_present_member);
+  RUN_TEST(test_group_join_skips_peer_in_backoff);
+  RUN_TEST(test_group_join_only_while_gathering);
+  RUN_TEST(test_group_streams_after_gather_window);
+  RUN_TEST(test_group_gather_waits_for_offer_retries);
+  RUN_TEST(test_group_fails_when_no_member_accepts);
+  RUN_TEST(test_group_decline_takes_out_one_member);
+  RUN_TEST(test_group_settles_done_if_any_member_verified);
+  RUN_TEST(test_group_settles_failed_if_none_verified);
+  RUN_TEST(test_group_finalize_timeout_backs_off_silent_members);
+  RUN_TEST(test_group_member_times_out_while_streaming);
+  // Delta sessions
+  RUN_TEST(test_delta_offered_to_peer_on_base);
+  RUN_TEST(test_delta_decline_falls_back_to_full_image);
+  RUN_TEST(test_delta_result_fail_falls_back_to_full_image);
+  RUN_TEST(test_delta_refused_ring);
+  RUN_TEST(test_delta_group_member_decline);
   // Channel-aware considerPeerForOta (promotion gating)
   RUN_TEST(test_consider_offers_stable_to_beta_peer_equal_version);
   RUN_TEST(test_consider_skips_when_stable_older_than_beta);
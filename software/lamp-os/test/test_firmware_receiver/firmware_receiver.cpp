@@ -11,6 +11,8 @@
 //   - The onOffer / onDone control-plane decisions: channel mismatch
 //     decline, version-not-greater decline, full-bitmap -> verify
 //     trigger, version mismatch detection on DONE.
+//   - The delta OFFER gate (deltaBaseOk) and rebuildFromDelta's trailer
+//     check; the rebuild itself is test_ota_delta's.
 //
 // What we don't mirror:
 //   - esp_ota_* calls (we replace with a mock that records the call
@@ -34,6 +36,7 @@
 
 #include "components/firmware/ota_channel.hpp"
 #include "components/firmware/ota_channel.cpp"
+#include "components/firmware/ota_delta.cpp"
 #include "components/network/protocol/fw_ota.hpp"
 #include "components/firmware/firmware_signature.hpp"
 
@@ -62,6 +65,7 @@ enum class FwAcceptStatus : uint8_t {
   DeclineBusy           = 1,
   DeclineAlreadyCurrent = 2,
   DeclineUnverified     = 3,
+  DeclineDeltaBase      = 4,
 };
 enum class FwReqReason : uint8_t {
   Gap           = 0,
@@ -77,12 +81,14 @@ enum class FwResultStatus : uint8_t {
   OtaEndFail         = 6,
   SetBootFail        = 7,
   OfferShaMismatch   = 8,
+  DeltaApplyFail     = 11,
 };
 
 constexpr uint32_t kMyVersion        = 0x00010000;  // 1.0.0
 constexpr uint32_t kChunkStallReqMs    = 2000;
 constexpr uint32_t kStreamingHardCapMs = 600000;  // 10 min; matches production
 constexpr uint32_t kNoProgressAbortMs  = 60000;   // 1 min; matches production
+constexpr uint32_t kFlashSectorLen     = 4096;    // SPI_FLASH_SEC_SIZE
 
 // --- Mirror PendingFirmwareControl ---------------------------------------
 
@@ -102,6 +108,10 @@ struct PendingFirmwareControl {
     bool     hasAuth;
     uint8_t  digest[lamp_protocol::FW_SHA256_FULL_LEN];
     uint8_t  signature[lamp_protocol::FW_SIG_LEN];
+    bool     isDelta;
+    uint32_t deltaImageLen;
+    uint32_t deltaBaseLen;
+    uint8_t  deltaBaseId[lamp_protocol::FW_DELTA_BASE_ID_LEN];
   } offer;
   struct {
     uint32_t version;
@@ -163,6 +173,13 @@ struct MockOta {
   bool setBootShouldFail = false;
   bool readShouldFail = false;
   bool signatureShouldFail = false;
+  // The running image's signed length and LSIG id (0 = a dev build with no
+  // footer), the inactive slot's size, and the trailer the streamed patch
+  // ends in as rebuildFromDelta reads it back.
+  uint32_t runningLen = 0;
+  uint8_t  runningId[lamp_protocol::FW_DELTA_BASE_ID_LEN] = {0};
+  uint32_t slotLen = 0x1E0000;
+  uint8_t  patchTrailer[lamp::ota_delta::kTrailerLen] = {0};
   void reset() { *this = MockOta{}; }
 };
 
@@ -246,6 +263,15 @@ class FirmwareReceiver {
     lastChunkSeenMs_ = mockNow_;
   }
 
+  // Production inGroupOf: only the distributor whose OFFER this flow took
+  // has its group-addressed stream frames let through.
+  bool isInProgress() const {
+    return state_ != State::Idle && state_ != State::Failed;
+  }
+  bool inGroupOf(const uint8_t sourceMac[6]) const {
+    return isInProgress() && std::memcmp(wispMac_, sourceMac, 6) == 0;
+  }
+
   // Test accessors
   State state() const { return state_; }
   uint16_t totalChunksForTest() const { return offerTotalChunks_; }
@@ -354,6 +380,15 @@ class FirmwareReceiver {
       return;
     }
 
+    // A delta OFFER is only good against the image it was built from;
+    // declined before anything is erased so the distributor falls back to
+    // the full image.
+    uint32_t patchOffset = 0;
+    if (ctrl.offer.isDelta && !deltaBaseOk(ctrl, patchOffset)) {
+      sendAccept(ctrl, FwAcceptStatus::DeclineDeltaBase);
+      return;
+    }
+
     // Ratio guard: an unauthenticated (totalLen, chunkSize) implying more than
     // FW_MAX_CHUNKS chunks would size a multi-MB bitmap; decline before arming.
     uint32_t expectedChunks = 0;
@@ -378,6 +413,9 @@ class FirmwareReceiver {
     offerTotalLen_    = ctrl.offer.totalLen;
     offerChunkSize_   = ctrl.offer.chunkSize;
     std::memcpy(offerSha256Prefix_, ctrl.offer.sha256Prefix, FW_SHA256_PREFIX_LEN);
+    std::memcpy(offerDigest_, ctrl.offer.digest, sizeof(offerDigest_));
+    delta_         = ctrl.offer.isDelta;
+    deltaImageLen_ = delta_ ? ctrl.offer.deltaImageLen : 0;
 
     offerTotalChunks_ = static_cast<uint16_t>(expectedChunks);
     resetBitmap(expectedChunks);
@@ -412,6 +450,14 @@ class FirmwareReceiver {
       state_ = State::Failed;
       return;
     }
+    if (delta_) {
+      const FwResultStatus rc = rebuildFromDelta();
+      if (rc != FwResultStatus::Success) {
+        sendResult(rc, 0);
+        state_ = State::Failed;
+        return;
+      }
+    }
     if (ota_->readShouldFail) {
       sendResult(FwResultStatus::PartitionReadFail, 0);
       state_ = State::Failed;
@@ -438,6 +484,36 @@ class FirmwareReceiver {
     if (ota_) ota_->state = MockOtaState::Aborted;
   }
 
+  // Production deltaBaseOk: the OFFER's base must be the running image, and
+  // the patch and the image it rebuilds must both fit the slot.
+  bool deltaBaseOk(const PendingFirmwareControl& ctrl,
+                   uint32_t& patchOffset) const {
+    if (ota_->runningLen == 0) return false;
+    if (ctrl.offer.deltaBaseLen != ota_->runningLen ||
+        std::memcmp(ctrl.offer.deltaBaseId, ota_->runningId,
+                    sizeof(ota_->runningId)) != 0) {
+      return false;
+    }
+    return lamp::ota_delta::slotLayout(ota_->slotLen, ctrl.offer.deltaImageLen,
+                                       ctrl.offer.totalLen, kFlashSectorLen,
+                                       patchOffset);
+  }
+
+  // Production rebuildFromDelta up to the apply: the streamed trailer has to
+  // describe what the OFFER promised.
+  FwResultStatus rebuildFromDelta() const {
+    lamp::ota_delta::Trailer t;
+    if (!lamp::ota_delta::parseTrailer(ota_->patchTrailer,
+                                       sizeof(ota_->patchTrailer), t) ||
+        !lamp::ota_delta::trailerMatchesOffer(t, offerTotalLen_, deltaImageLen_,
+                                              offerVersion_, offerDigest_,
+                                              ota_->runningLen,
+                                              ota_->runningId)) {
+      return FwResultStatus::DeltaApplyFail;
+    }
+    return FwResultStatus::Success;
+  }
+
   void sendAccept(const PendingFirmwareControl& ctrl, FwAcceptStatus status) {
     if (!receiver_) return;
     receiver_->accepts.push_back({ctrl.seq, ctrl.offer.version, status});
@@ -463,6 +539,9 @@ class FirmwareReceiver {
   uint16_t offerChunkSize_ = 0;
   uint16_t offerTotalChunks_ = 0;
   uint8_t  offerSha256Prefix_[FW_SHA256_PREFIX_LEN] = {0};
+  uint8_t  offerDigest_[lamp_protocol::FW_SHA256_FULL_LEN] = {0};
+  bool     delta_ = false;
+  uint32_t deltaImageLen_ = 0;
   uint32_t streamingStartMs_ = 0;
   uint32_t lastChunkMs_ = 0;
   uint32_t lastChunkSeenMs_ = 0;
@@ -519,6 +598,45 @@ static ParsedFwChunk makeChunk(uint16_t idx, uint16_t len = FW_CHUNK_SIZE) {
   return p;
 }
 
+
+// A lamp running a signed image (running length + LSIG id), and a 600-byte
+// delta OFFER built against it that rebuilds a 1.5 MB image.
+constexpr uint32_t kDeltaRunningLen = 1499904;
+constexpr uint32_t kDeltaImageLen   = 1500096;
+constexpr uint32_t kDeltaPatchLen   = 600;
+
+static void setRunningImage(MockOta& ota) {
+  ota.runningLen = kDeltaRunningLen;
+  for (size_t i = 0; i < sizeof(ota.runningId); ++i) {
+    ota.runningId[i] = static_cast<uint8_t>(0x40 + i);
+  }
+}
+
+static PendingFirmwareControl makeDeltaOffer(const MockOta& ota, uint16_t seq,
+                                             uint32_t version) {
+  PendingFirmwareControl c = makeOffer(seq, version, kDeltaPatchLen, 3);
+  for (size_t i = 0; i < sizeof(c.offer.digest); ++i) {
+    c.offer.digest[i] = static_cast<uint8_t>(0xA0 + i);
+  }
+  c.offer.isDelta       = true;
+  c.offer.deltaImageLen = kDeltaImageLen;
+  c.offer.deltaBaseLen  = ota.runningLen;
+  std::memcpy(c.offer.deltaBaseId, ota.runningId, sizeof(c.offer.deltaBaseId));
+  return c;
+}
+
+// The trailer a patch built for `offer` ends in.
+static lamp::ota_delta::Trailer trailerFor(const PendingFirmwareControl& offer) {
+  lamp::ota_delta::Trailer t;
+  t.baseLen      = offer.offer.deltaBaseLen;
+  t.imageVersion = offer.offer.version;
+  t.imageLen     = offer.offer.deltaImageLen;
+  t.opsLen       = offer.offer.totalLen - lamp::ota_delta::kTrailerLen;
+  std::memcpy(t.baseId, offer.offer.deltaBaseId, sizeof(t.baseId));
+  std::memcpy(t.imageDigest, offer.offer.digest, sizeof(t.imageDigest));
+  return t;
+}
+
 }  // namespace test
 
 void setUp(void) {}
@@ -1318,6 +1436,139 @@ void test_offer_ratio_dos_declined_no_alloc() {
   TEST_ASSERT_EQUAL_UINT32(0u, static_cast<uint32_t>(fr.bitmapBytesForTest()));
 }
 
+// Group-addressed stream frames are taken only from the distributor whose
+// OFFER this flow accepted, and only while it runs.
+void test_in_group_of_offering_distributor_only() {
+  test::MockMeshLink mock;
+  test::MockOta ota;
+  test::FirmwareReceiver fr;
+  fr.begin(&mock, &ota);
+  const uint8_t other[6] = {0x20, 0x21, 0x22, 0x23, 0x24, 0x25};
+
+  TEST_ASSERT_FALSE(fr.inGroupOf(test::kWispMac));
+  fr.handleControlOnLoop(test::makeOffer(1, 0x00010001, 600, 3));
+  TEST_ASSERT_TRUE(fr.inGroupOf(test::kWispMac));
+  TEST_ASSERT_FALSE(fr.inGroupOf(other));
+
+  // A declined OFFER from another distributor doesn't move the flow.
+  auto foreign = test::makeOffer(2, 0x00010002, 600, 3);
+  std::memcpy(foreign.sourceMac, other, 6);
+  fr.handleControlOnLoop(foreign);
+  TEST_ASSERT_TRUE(fr.inGroupOf(test::kWispMac));
+  TEST_ASSERT_FALSE(fr.inGroupOf(other));
+
+  fr.setMockNow(test::kStreamingHardCapMs + 1);
+  fr.tick(test::kStreamingHardCapMs + 1);
+  TEST_ASSERT_FALSE(fr.inGroupOf(test::kWispMac));
+}
+
+// A delta OFFER not built against the running image is declined with
+// DeclineDeltaBase before anything is erased or armed.
+void test_delta_offer_base_mismatch_declines_before_erase() {
+  struct Case {
+    const char* what;
+    void (*mutate)(test::MockOta&, test::PendingFirmwareControl&);
+  };
+  const Case cases[] = {
+      {"base length", [](test::MockOta&, test::PendingFirmwareControl& c) {
+         c.offer.deltaBaseLen += 4096;
+       }},
+      {"base id", [](test::MockOta&, test::PendingFirmwareControl& c) {
+         c.offer.deltaBaseId[3] ^= 0x01;
+       }},
+      {"no running footer", [](test::MockOta& o, test::PendingFirmwareControl&) {
+         o.runningLen = 0;
+       }},
+      {"slot too small", [](test::MockOta& o, test::PendingFirmwareControl&) {
+         o.slotLen = test::kDeltaImageLen;
+       }},
+  };
+  for (const Case& k : cases) {
+    test::MockMeshLink mock;
+    test::MockOta ota;
+    test::setRunningImage(ota);
+    test::FirmwareReceiver fr;
+    fr.begin(&mock, &ota);
+    auto offer = test::makeDeltaOffer(ota, 1, 0x00010001);
+    k.mutate(ota, offer);
+    fr.handleControlOnLoop(offer);
+
+    TEST_ASSERT_TRUE_MESSAGE(mock.accepts.size() == 1, k.what);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(
+        static_cast<uint8_t>(test::FwAcceptStatus::DeclineDeltaBase),
+        static_cast<uint8_t>(mock.accepts[0].status), k.what);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(
+        static_cast<uint8_t>(test::MockOtaState::None),
+        static_cast<uint8_t>(ota.state), k.what);
+    TEST_ASSERT_TRUE_MESSAGE(fr.state() == test::FirmwareReceiver::State::Idle,
+                             k.what);
+    TEST_ASSERT_TRUE_MESSAGE(fr.bitmapBytesForTest() == 0, k.what);
+  }
+}
+
+// A delta OFFER against the running image streams like any other, and a
+// trailer that matches it gets through to the verify.
+void test_delta_offer_matching_base_applies() {
+  test::MockMeshLink mock;
+  test::MockOta ota;
+  test::setRunningImage(ota);
+  test::FirmwareReceiver fr;
+  fr.begin(&mock, &ota);
+  auto offer = test::makeDeltaOffer(ota, 1, 0x00010001);
+  fr.handleControlOnLoop(offer);
+  TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(test::FwAcceptStatus::Accept),
+                          static_cast<uint8_t>(mock.accepts[0].status));
+  TEST_ASSERT_EQUAL(static_cast<int>(test::FirmwareReceiver::State::Streaming),
+                    static_cast<int>(fr.state()));
+
+  lamp::ota_delta::writeTrailer(test::trailerFor(offer), ota.patchTrailer);
+  for (uint16_t i = 0; i < 3; ++i) fr.handleChunk(test::makeChunk(i));
+  fr.handleControlOnLoop(test::makeDone(0x00010001, test::kDeltaPatchLen));
+  TEST_ASSERT_EQUAL_UINT32(1u, static_cast<uint32_t>(mock.results.size()));
+  TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(test::FwResultStatus::Success),
+                          static_cast<uint8_t>(mock.results[0].status));
+  TEST_ASSERT_EQUAL(static_cast<int>(test::FirmwareReceiver::State::Apply),
+                    static_cast<int>(fr.state()));
+}
+
+// A streamed trailer that disagrees with the OFFER fails the session with
+// DeltaApplyFail before any rebuild.
+void test_delta_trailer_offer_mismatch_fails() {
+  struct Case {
+    const char* what;
+    void (*mutate)(lamp::ota_delta::Trailer&);
+  };
+  const Case cases[] = {
+      {"ops length", [](lamp::ota_delta::Trailer& t) { t.opsLen += 1; }},
+      {"image length", [](lamp::ota_delta::Trailer& t) { t.imageLen -= 1; }},
+      {"image version", [](lamp::ota_delta::Trailer& t) { t.imageVersion += 1; }},
+      {"base length", [](lamp::ota_delta::Trailer& t) { t.baseLen += 4096; }},
+      {"base id", [](lamp::ota_delta::Trailer& t) { t.baseId[0] ^= 0x01; }},
+      {"image digest", [](lamp::ota_delta::Trailer& t) { t.imageDigest[31] ^= 0x80; }},
+  };
+  for (const Case& k : cases) {
+    test::MockMeshLink mock;
+    test::MockOta ota;
+    test::setRunningImage(ota);
+    test::FirmwareReceiver fr;
+    fr.begin(&mock, &ota);
+    auto offer = test::makeDeltaOffer(ota, 1, 0x00010001);
+    fr.handleControlOnLoop(offer);
+    lamp::ota_delta::Trailer t = test::trailerFor(offer);
+    k.mutate(t);
+    lamp::ota_delta::writeTrailer(t, ota.patchTrailer);
+    for (uint16_t i = 0; i < 3; ++i) fr.handleChunk(test::makeChunk(i));
+    fr.handleControlOnLoop(test::makeDone(0x00010001, test::kDeltaPatchLen));
+
+    TEST_ASSERT_TRUE_MESSAGE(mock.results.size() == 1, k.what);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(
+        static_cast<uint8_t>(test::FwResultStatus::DeltaApplyFail),
+        static_cast<uint8_t>(mock.results[0].status), k.what);
+    TEST_ASSERT_TRUE_MESSAGE(
+        fr.state() == test::FirmwareReceiver::State::Failed, k.what);
+  }
+}
+
 int main(int argc, char** argv) {
   (void)argc;
   (void)argv;
@@ -1368,5 +1619,9 @@ int main(int argc, char** argv) {
   RUN_TEST(test_offerChunkCountOk_accepts_normal_offer);
   RUN_TEST(test_offerChunkCountOk_boundary_at_max_chunks);
   RUN_TEST(test_offer_ratio_dos_declined_no_alloc);
+  RUN_TEST(test_in_group_of_offering_distributor_only);
+  RUN_TEST(test_delta_offer_base_mismatch_declines_before_erase);
+  RUN_TEST(test_delta_offer_matching_base_applies);
+  RUN_TEST(test_delta_trailer_offer_mismatch_fails);
   return UNITY_END();
 }
@@ -1,7 +1,9 @@
-// Native tests for FrameBuffer multi-segment fanout.
+// Native tests for FrameBuffer multi-segment fanout, dirty tracking and the
+// fused gamma/brightness/byte-order encode.
 //
 // Adafruit_NeoPixel.h is stubbed by test/native_stubs/Adafruit_NeoPixel.h,
-// found via -I test/native_stubs in the native env build_flags.
+// found via -I test/native_stubs in the native env build_flags. flush()
+// writes the stub's pixel array directly; reset() marks it unwritten.
 
 #include <unity.h>
 
@@ -28,7 +30,17 @@ static uint32_t encode(const Color& c) {
                     Adafruit_NeoPixel::gamma8(c.b));
 }
 
-// New API and old adapter produce identical setPixelColor call sequences.
+// Driver pixel i of a GRBW strip, repacked as encode() packs it.
+static uint32_t wireAt(const Adafruit_NeoPixel& neo, uint16_t i) {
+  const uint8_t* p = neo.pixels + i * 4;
+  return (uint32_t)((p[3] << 24) | (p[1] << 16) | (p[0] << 8) | p[2]);
+}
+
+static uint16_t written(const Adafruit_NeoPixel& neo, uint16_t count) {
+  return neo.writtenPixels(count, 4);
+}
+
+// New API and old adapter produce identical wire output.
 void test_new_api_and_adapter_flush_identically() {
   const Color red(0xFF, 0, 0, 0);
   const Color blue(0, 0, 0xFF, 0);
@@ -38,19 +50,18 @@ void test_new_api_and_adapter_flush_identically() {
   fb1.buffer = {red, blue, red};
   neo0.reset();
   fb1.flush();
-  auto calls1 = neo0.pixelCalls;
+  std::vector<uint32_t> wire1;
+  for (uint16_t i = 0; i < 3; i++) wire1.push_back(wireAt(neo0, i));
 
   FrameBuffer fb2;
   fb2.begin({red, blue, red}, 3, &neo0);
   fb2.buffer = {red, blue, red};
   neo0.reset();
   fb2.flush();
-  auto calls2 = neo0.pixelCalls;
 
-  TEST_ASSERT_EQUAL_UINT(calls1.size(), calls2.size());
-  for (size_t i = 0; i < calls1.size(); i++) {
-    TEST_ASSERT_EQUAL_UINT16(calls1[i].n, calls2[i].n);
-    TEST_ASSERT_EQUAL_UINT32(calls1[i].c, calls2[i].c);
+  TEST_ASSERT_EQUAL_UINT(3, written(neo0, 8));
+  for (uint16_t i = 0; i < 3; i++) {
+    TEST_ASSERT_EQUAL_UINT32(wire1[i], wireAt(neo0, i));
   }
 }
 
@@ -70,21 +81,20 @@ void test_multisegment_routes_pixels_to_correct_drivers() {
 
   fb.flush();
 
-  TEST_ASSERT_EQUAL_UINT(a, neo0.pixelCalls.size());
-  for (size_t i = 0; i < neo0.pixelCalls.size(); i++) {
-    TEST_ASSERT_EQUAL_UINT16(i, neo0.pixelCalls[i].n);
-    TEST_ASSERT_EQUAL_UINT32(encode(red), neo0.pixelCalls[i].c);
+  TEST_ASSERT_EQUAL_UINT(a, written(neo0, 16));
+  for (uint16_t i = 0; i < a; i++) {
+    TEST_ASSERT_EQUAL_UINT32(encode(red), wireAt(neo0, i));
   }
 
-  TEST_ASSERT_EQUAL_UINT(b, neo1.pixelCalls.size());
-  for (size_t i = 0; i < neo1.pixelCalls.size(); i++) {
-    TEST_ASSERT_EQUAL_UINT16(i, neo1.pixelCalls[i].n);
-    TEST_ASSERT_EQUAL_UINT32(encode(green), neo1.pixelCalls[i].c);
+  TEST_ASSERT_EQUAL_UINT(b, written(neo1, 16));
+  for (uint16_t i = 0; i < b; i++) {
+    TEST_ASSERT_EQUAL_UINT32(encode(green), wireAt(neo1, i));
   }
 }
 
-// canShow() false on one segment: show() skipped and previousBuffer not advanced,
-// so the next flush retransmits rather than short-circuiting.
+// canShow() false on one segment: show() skipped and that segment's slice of
+// previousBuffer not advanced, so the next flush retransmits it rather than
+// short-circuiting.
 void test_skipped_segment_leaves_previous_buffer_unadvanced() {
   const Color red(0xFF, 0, 0, 0);
   const Color blue(0, 0, 0xFF, 0);
@@ -111,12 +121,14 @@ void test_skipped_segment_leaves_previous_buffer_unadvanced() {
   // previousBuffer stays at the last fully-shown state, not the current buffer.
   TEST_ASSERT_FALSE(fb.previousBuffer == fb.buffer);
 
-  // Next flush with the same buffer: not short-circuited (previousBuffer still old).
+  // Next flush with the same buffer: not short-circuited for the blocked
+  // segment (its slice of previousBuffer is still old); the shown one is clean.
   neo0.reset();
   neo1.reset();
   fb.flush();
-  TEST_ASSERT_EQUAL_UINT(2, neo0.pixelCalls.size());
-  TEST_ASSERT_EQUAL_UINT(2, neo1.pixelCalls.size());
+  TEST_ASSERT_EQUAL_UINT(0, written(neo0, 2));
+  TEST_ASSERT_EQUAL_INT(0, neo0.showCount);
+  TEST_ASSERT_EQUAL_UINT(2, written(neo1, 2));
   TEST_ASSERT_EQUAL_INT(0, neo1.showCount);
 
   // Unblock neo1: full flush advances previousBuffer.
@@ -144,14 +156,14 @@ void test_brightness_change_forces_full_repush() {
   // Same content, same brightness: dedup short-circuits.
   neo0.reset();
   fb.flush();
-  TEST_ASSERT_EQUAL_UINT(0, neo0.pixelCalls.size());
+  TEST_ASSERT_EQUAL_UINT(0, written(neo0, 3));
   TEST_ASSERT_EQUAL_INT(0, neo0.showCount);
 
   // Same content, clamped brightness: full repush then show.
   neo0.brightness = 127;
   neo0.reset();
   fb.flush();
-  TEST_ASSERT_EQUAL_UINT(3, neo0.pixelCalls.size());
+  TEST_ASSERT_EQUAL_UINT(3, written(neo0, 3));
   TEST_ASSERT_EQUAL_INT(1, neo0.showCount);
   TEST_ASSERT_EQUAL_UINT8(127, fb.previousBrightness);
 }
@@ -170,10 +182,9 @@ void test_reversed_segment_flips_pixel_order() {
   fwd.buffer = pattern;
   neo0.reset();
   fwd.flush();
-  TEST_ASSERT_EQUAL_UINT(4, neo0.pixelCalls.size());
-  for (size_t i = 0; i < 4; i++) {
-    TEST_ASSERT_EQUAL_UINT16(i, neo0.pixelCalls[i].n);
-    TEST_ASSERT_EQUAL_UINT32(encode(pattern[3 - i]), neo0.pixelCalls[i].c);
+  TEST_ASSERT_EQUAL_UINT(4, written(neo0, 8));
+  for (uint16_t i = 0; i < 4; i++) {
+    TEST_ASSERT_EQUAL_UINT32(encode(pattern[3 - i]), wireAt(neo0, i));
   }
 
   // non-reversed segment: driver pixel i should receive buffer[offset + i]
@@ -182,13 +193,137 @@ void test_reversed_segment_flips_pixel_order() {
   fwd2.buffer = pattern;
   neo0.reset();
   fwd2.flush();
-  TEST_ASSERT_EQUAL_UINT(4, neo0.pixelCalls.size());
-  for (size_t i = 0; i < 4; i++) {
-    TEST_ASSERT_EQUAL_UINT16(i, neo0.pixelCalls[i].n);
-    TEST_ASSERT_EQUAL_UINT32(encode(pattern[i]), neo0.pixelCalls[i].c);
+  TEST_ASSERT_EQUAL_UINT(4, written(neo0, 8));
+  for (uint16_t i = 0; i < 4; i++) {
+    TEST_ASSERT_EQUAL_UINT32(encode(pattern[i]), wireAt(neo0, i));
   }
 }
 
+// A change confined to one segment re-encodes and shows only that segment.
+void test_unchanged_segment_is_not_retransmitted() {
+  const Color red(0xFF, 0, 0, 0);
+  const Color green(0, 0xFF, 0, 0);
+
+  FrameBuffer fb;
+  fb.begin({}, std::vector<StripSegment>{{&neo0, "s0", 0, 3}, {&neo1, "s1", 3, 3}});
+  fb.buffer.assign(6, red);
+  fb.flush();
+
+  fb.buffer[4] = green;
+  neo0.reset();
+  neo1.reset();
+  fb.flush();
+
+  TEST_ASSERT_EQUAL_UINT(0, written(neo0, 3));
+  TEST_ASSERT_EQUAL_INT(0, neo0.showCount);
+  TEST_ASSERT_EQUAL_INT(1, neo1.showCount);
+  TEST_ASSERT_TRUE(fb.previousBuffer == fb.buffer);
+}
+
+// Within a dirty segment only the changed pixels are re-encoded; the driver
+// keeps the rest from the last frame. Reversed segments map the same way.
+void test_only_changed_pixels_are_reencoded() {
+  const Color red(0xFF, 0, 0, 0);
+  const Color blue(0, 0, 0xFF, 0);
+
+  FrameBuffer fb;
+  fb.begin({}, std::vector<StripSegment>{{&neo0, "fwd", 0, 4},
+                                         {&neo1, "rev", 4, 4, true}});
+  fb.buffer.assign(8, red);
+  fb.flush();
+
+  fb.buffer[1] = blue;
+  fb.buffer[5] = blue;  // driver pixel 2 on the reversed segment
+  neo0.reset();
+  neo1.reset();
+  fb.flush();
+
+  TEST_ASSERT_EQUAL_UINT(1, written(neo0, 4));
+  TEST_ASSERT_EQUAL_UINT32(encode(blue), wireAt(neo0, 1));
+  TEST_ASSERT_EQUAL_UINT(1, written(neo1, 4));
+  TEST_ASSERT_EQUAL_UINT32(encode(blue), wireAt(neo1, 2));
+}
+
+// markDirty forces a pixel out even when its value matches the shown frame.
+void test_mark_dirty_forces_repush() {
+  const Color red(0xFF, 0, 0, 0);
+
+  FrameBuffer fb;
+  fb.begin({}, std::vector<StripSegment>{{&neo0, "s0", 0, 3}, {&neo1, "s1", 3, 3}});
+  fb.buffer.assign(6, red);
+  fb.flush();
+
+  fb.markDirty(2);
+  neo0.reset();
+  neo1.reset();
+  fb.flush();
+  TEST_ASSERT_EQUAL_UINT(1, written(neo0, 3));
+  TEST_ASSERT_EQUAL_UINT32(encode(red), wireAt(neo0, 2));
+  TEST_ASSERT_EQUAL_INT(1, neo0.showCount);
+  TEST_ASSERT_EQUAL_INT(0, neo1.showCount);
+
+  fb.markAllDirty();
+  neo0.reset();
+  neo1.reset();
+  fb.flush();
+  TEST_ASSERT_EQUAL_UINT(3, written(neo0, 3));
+  TEST_ASSERT_EQUAL_UINT(3, written(neo1, 3));
+
+  // Bits clear once shown.
+  neo0.reset();
+  neo1.reset();
+  fb.flush();
+  TEST_ASSERT_EQUAL_UINT(0, written(neo0, 3) + written(neo1, 3));
+}
+
+// The table folds the driver's brightness scaling in exactly as
+// setPixelColor would: (gamma8(v) * (b + 1)) >> 8, with 255 meaning unscaled.
+void test_encode_applies_driver_brightness() {
+  const Color c(0xFF, 0x80, 0x40, 0x10);
+
+  FrameBuffer fb;
+  fb.begin({}, std::vector<StripSegment>{{&neo0, "s0", 0, 1}});
+  fb.buffer = {c};
+  fb.setBrightness(100);
+  TEST_ASSERT_EQUAL_UINT8(100, neo0.getBrightness());
+  fb.flush();
+
+  auto scaled = [](uint8_t v) {
+    return (uint8_t)((Adafruit_NeoPixel::gamma8(v) * 101) >> 8);
+  };
+  TEST_ASSERT_EQUAL_UINT8(scaled(c.g), neo0.pixels[0]);
+  TEST_ASSERT_EQUAL_UINT8(scaled(c.r), neo0.pixels[1]);
+  TEST_ASSERT_EQUAL_UINT8(scaled(c.b), neo0.pixels[2]);
+  TEST_ASSERT_EQUAL_UINT8(scaled(c.w), neo0.pixels[3]);
+}
+
+// Each byte order lands channels at the Adafruit NEO_* offsets; RGB-only
+// strips pack 3 bytes per pixel and drop W.
+void test_encode_follows_segment_byte_order() {
+  const Color c(0xFF, 0x80, 0x40, 0x10);
+  const uint8_t r = Adafruit_NeoPixel::gamma8(c.r);
+  const uint8_t g = Adafruit_NeoPixel::gamma8(c.g);
+  const uint8_t b = Adafruit_NeoPixel::gamma8(c.b);
+
+  FrameBuffer grb;
+  grb.begin({}, std::vector<StripSegment>{
+                    {&neo0, "grb", 0, 2, false, lampos::led::ByteOrder::GRB}});
+  grb.buffer = {c, c};
+  neo0.reset();
+  grb.flush();
+  const uint8_t expectGrb[] = {g, r, b, g, r, b, Adafruit_NeoPixel::kUnwritten};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expectGrb, neo0.pixels, sizeof(expectGrb));
+
+  FrameBuffer bgr;
+  bgr.begin({}, std::vector<StripSegment>{
+                    {&neo1, "bgr", 0, 1, false, lampos::led::ByteOrder::BGR}});
+  bgr.buffer = {c};
+  neo1.reset();
+  bgr.flush();
+  const uint8_t expectBgr[] = {b, g, r, Adafruit_NeoPixel::kUnwritten};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expectBgr, neo1.pixels, sizeof(expectBgr));
+}
+
 int main(int argc, char** argv) {
   (void)argc; (void)argv;
   UNITY_BEGIN();
@@ -197,5 +332,10 @@ int main(int argc, char** argv) {
   RUN_TEST(test_skipped_segment_leaves_previous_buffer_unadvanced);
   RUN_TEST(test_brightness_change_forces_full_repush);
   RUN_TEST(test_reversed_segment_flips_pixel_order);
+  RUN_TEST(test_unchanged_segment_is_not_retransmitted);
+  RUN_TEST(test_only_changed_pixels_are_reencoded);
+  RUN_TEST(test_mark_dirty_forces_repush);
+  RUN_TEST(test_encode_applies_driver_brightness);
+  RUN_TEST(test_encode_follows_segment_byte_order);
   return UNITY_END();
 }
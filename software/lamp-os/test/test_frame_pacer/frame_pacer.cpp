@@ -0,0 +1,195 @@
+// Native tests for FramePacer: the frame deadline, the lateness histogram,
+// paced-drain admission with its starvation bound, the cost estimator, and a
+// simulated loop showing a heavy drain no longer pushes flushes late.
+
+#include <unity.h>
+
+#include <cstdint>
+
+#include "../../src/core/frame_pacer.cpp"
+
+using lamp::FramePacer;
+
+void setUp() {}
+void tearDown() {}
+
+void test_deadline_and_slack() {
+  FramePacer p;
+  TEST_ASSERT_TRUE(p.frameDue(0));  // nothing flushed yet
+  TEST_ASSERT_EQUAL_UINT32(0, p.slackUs(0));
+
+  p.frameFlushed(1000);
+  TEST_ASSERT_FALSE(p.frameDue(1000));
+  TEST_ASSERT_EQUAL_UINT32(16000, p.slackUs(1000));
+  TEST_ASSERT_EQUAL_UINT32(6000, p.slackUs(11000));
+  TEST_ASSERT_TRUE(p.frameDue(17000));
+  TEST_ASSERT_EQUAL_UINT32(0, p.slackUs(20000));
+
+  // Wraps with the 32-bit microsecond clock.
+  p.frameFlushed(0xFFFFF000u);
+  TEST_ASSERT_FALSE(p.frameDue(0x00000100u));
+  TEST_ASSERT_EQUAL_UINT32(16000 - 0x1100, p.slackUs(0x00000100u));
+}
+
+void test_lateness_histogram() {
+  TEST_ASSERT_EQUAL_size_t(0, FramePacer::bucketFor(0));
+  TEST_ASSERT_EQUAL_size_t(0, FramePacer::bucketFor(499));
+  TEST_ASSERT_EQUAL_size_t(1, FramePacer::bucketFor(500));
+  TEST_ASSERT_EQUAL_size_t(2, FramePacer::bucketFor(1999));
+  TEST_ASSERT_EQUAL_size_t(6, FramePacer::bucketFor(16000));
+  TEST_ASSERT_EQUAL_size_t(7, FramePacer::bucketFor(32000));
+  TEST_ASSERT_EQUAL_size_t(7, FramePacer::bucketFor(1000000));
+
+  FramePacer p;
+  uint32_t t = 0;
+  p.frameFlushed(t);  // arms; nothing to measure against yet
+  TEST_ASSERT_EQUAL_UINT32(0, p.frames());
+  p.frameFlushed(t += 15400);  // ms-gated flush a fraction early: on time
+  p.frameFlushed(t += 16700);  // 0.7 ms late
+  p.frameFlushed(t += 19000);  // 3 ms late
+  p.frameFlushed(t += 56000);  // 40 ms late
+  TEST_ASSERT_EQUAL_UINT32(4, p.frames());
+  TEST_ASSERT_EQUAL_UINT32(1, p.jitter()[0]);
+  TEST_ASSERT_EQUAL_UINT32(1, p.jitter()[1]);
+  TEST_ASSERT_EQUAL_UINT32(1, p.jitter()[3]);
+  TEST_ASSERT_EQUAL_UINT32(1, p.jitter()[7]);
+  TEST_ASSERT_EQUAL_UINT32(40000, p.maxLatenessUs());
+
+  p.resetStats();
+  TEST_ASSERT_EQUAL_UINT32(0, p.frames());
+  TEST_ASSERT_EQUAL_UINT32(0, p.jitter()[7]);
+  TEST_ASSERT_EQUAL_UINT32(0, p.maxLatenessUs());
+  TEST_ASSERT_FALSE(p.frameDue(t + 100));  // the deadline survives a reset
+}
+
+void test_admission_and_starvation_bound() {
+  FramePacer p;
+  TEST_ASSERT_TRUE(p.admit(0, 0));  // unarmed: nothing to protect
+  p.charge(0, 8000);                // an 8 ms settings parse
+  TEST_ASSERT_EQUAL_UINT32(8000, p.drain(0).costUs);
+
+  p.frameFlushed(0);
+  TEST_ASSERT_TRUE(p.admit(0, 2000));    // 14 ms of slack
+  TEST_ASSERT_FALSE(p.admit(0, 8000));   // 8 ms left, 8 ms + guard needed
+  TEST_ASSERT_FALSE(p.admit(0, 15000));
+  TEST_ASSERT_EQUAL_UINT32(2, p.drain(0).deferrals);
+
+  // Unknown drains and other ids are independent.
+  TEST_ASSERT_FALSE(p.admit(1, 15500));  // cost 0, but inside the guard
+  TEST_ASSERT_TRUE(p.admit(FramePacer::kMaxDrains, 15999));
+
+  // Past four frame periods of deferral the drain runs regardless.
+  TEST_ASSERT_FALSE(p.admit(0, 8000 + 4 * 16000 - 1));
+  TEST_ASSERT_TRUE(p.admit(0, 8000 + 4 * 16000));
+  p.charge(0, 8000);
+  TEST_ASSERT_FALSE(p.drain(0).deferred);
+  TEST_ASSERT_EQUAL_UINT32(2, p.drain(0).runs);
+}
+
+void test_cost_estimate_rises_fast_and_decays() {
+  FramePacer p;
+  p.charge(2, 20);
+  TEST_ASSERT_EQUAL_UINT32(20, p.drain(2).costUs);
+  p.charge(2, 6000);
+  TEST_ASSERT_EQUAL_UINT32(6000, p.drain(2).costUs);
+  p.charge(2, 20);
+  TEST_ASSERT_TRUE(p.drain(2).costUs < 6000 && p.drain(2).costUs > 5000);
+  for (int i = 0; i < 200; i++) p.charge(2, 20);
+  TEST_ASSERT_EQUAL_UINT32(20, p.drain(2).costUs);
+  TEST_ASSERT_EQUAL_UINT32(6000, p.drain(2).maxUs);
+  TEST_ASSERT_EQUAL_UINT32(203, p.drain(2).runs);
+}
+
+void test_forced_run_refreshes_stale_estimate() {
+  FramePacer p;
+  p.frameFlushed(0);
+  TEST_ASSERT_TRUE(p.admit(3, 100));
+  p.charge(3, 20000);  // a one-off NVS commit, longer than any frame
+
+  // Idle since, but the estimate never fits, so only the bound runs it.
+  const uint32_t t = 16000;
+  p.frameFlushed(t);
+  TEST_ASSERT_FALSE(p.admit(3, t + 100));
+  TEST_ASSERT_TRUE(p.admit(3, t + 100 + 4 * 16000));
+  p.charge(3, 20);
+  TEST_ASSERT_EQUAL_UINT32(20, p.drain(3).costUs);
+  TEST_ASSERT_FALSE(p.drain(3).forced);
+
+  // Back to running whenever the slack allows, and decaying as usual.
+  const uint32_t t2 = t + 5 * 16000;
+  p.frameFlushed(t2);
+  TEST_ASSERT_TRUE(p.admit(3, t2 + 100));
+  p.charge(3, 6000);
+  p.charge(3, 20);
+  TEST_ASSERT_TRUE(p.drain(3).costUs > 5000);
+}
+
+namespace {
+
+// A loop on a simulated clock: a 1 ms render/flush when due, then one heavy
+// drain (12 ms whenever work is pending, 20 us otherwise) with new work every
+// 7 ms, then a 200 us remainder of the tick. Returns the worst flush
+// lateness after a 100 ms warm-up (the first heavy run is unforecast by
+// construction); `paced` routes the drain through the pacer.
+uint32_t simulate(bool paced, uint32_t* maxDeferredUs) {
+  FramePacer p;
+  uint32_t now = 0;
+  uint32_t lastWorkAt = 0;
+  uint32_t pendingSince = 0;
+  bool pending = false;
+  *maxDeferredUs = 0;
+  bool warm = false;
+  while (now < 2000000) {
+    if (!warm && now >= 100000) {
+      warm = true;
+      p.resetStats();
+      *maxDeferredUs = 0;
+    }
+    if (p.frameDue(now)) {
+      now += 1000;
+      p.frameFlushed(now);
+    }
+    if (now - lastWorkAt >= 7000) {
+      lastWorkAt = now;
+      if (!pending) pendingSince = now;
+      pending = true;
+    }
+    if (!paced || p.admit(0, now)) {
+      const uint32_t cost = pending ? 12000 : 20;
+      if (pending && now - pendingSince > *maxDeferredUs) {
+        *maxDeferredUs = now - pendingSince;
+      }
+      pending = false;
+      now += cost;
+      if (paced) p.charge(0, cost);
+    }
+    now += 200;
+  }
+  return p.maxLatenessUs();
+}
+
+}  // namespace
+
+void test_paced_loop_bounds_jitter() {
+  uint32_t unpacedDefer = 0;
+  uint32_t pacedDefer = 0;
+  const uint32_t unpaced = simulate(false, &unpacedDefer);
+  const uint32_t paced = simulate(true, &pacedDefer);
+  // Unpaced, a 12 ms drain straddling the deadline lands the flush up to a
+  // drain late; paced, the flush waits at most on the tick remainder.
+  TEST_ASSERT_TRUE(unpaced >= 8000);
+  TEST_ASSERT_TRUE(paced <= 1500);
+  // Deferred work still runs within the starvation bound.
+  TEST_ASSERT_TRUE(pacedDefer <= FramePacer::kMaxDeferFrames * 16000 + 12000);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_deadline_and_slack);
+  RUN_TEST(test_lateness_histogram);
+  RUN_TEST(test_admission_and_starvation_bound);
+  RUN_TEST(test_cost_estimate_rises_fast_and_decays);
+  RUN_TEST(test_forced_run_refreshes_stale_estimate);
+  RUN_TEST(test_paced_loop_bounds_jitter);
+  return UNITY_END();
+}
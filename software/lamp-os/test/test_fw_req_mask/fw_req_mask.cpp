@@ -0,0 +1,138 @@
+// Native tests for exact-hole OTA REQ recovery: the receiver's missing-chunk
+// mask, the distributor's hole queue, and a lossy-link simulation that runs
+// one mesh OTA session end to end under each REQ form and compares how many
+// chunks the receiver got twice.
+//
+// The session model is the shared one in test/ota_sim/session_model.hpp:
+// FirmwareDistributor's stream cursor, smart-rewind resume and DONE retries
+// against FirmwareReceiver's stall watchdog and DONE-time gap REQ, on a
+// simulated millisecond clock.
+
+#include <unity.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "components/network/protocol/lamp_protocol.hpp"
+#include "../../src/components/firmware/req_holes.cpp"
+#include "../ota_sim/session_model.hpp"
+
+namespace lp = lamp_protocol;
+using lamp::missingMask;
+using lamp::missingRunLen;
+using lamp::ReqHoleQueue;
+using ota_sim::SessionStats;
+
+void setUp() {}
+void tearDown() {}
+
+namespace {
+
+SessionStats runSession(bool useMask, uint32_t spacingMs, uint32_t seed,
+                        uint16_t totalChunks = 2000) {
+  ota_sim::Sender tx(totalChunks);
+  ota_sim::Receiver rx(totalChunks, useMask);
+  return ota_sim::runOne(tx, rx, seed, spacingMs);
+}
+
+}  // namespace
+
+void test_missing_mask_and_run() {
+  std::vector<uint8_t> bitmap(300 / 8 + 1, 0xFF);
+  const size_t total = 300;
+  // Holes at 10, 13, 29 and 275.
+  for (size_t i : {10, 13, 29, 275}) bitmap[i / 8] &= static_cast<uint8_t>(~(1u << (i % 8)));
+
+  TEST_ASSERT_EQUAL_UINT16(20, missingRunLen(bitmap.data(), bitmap.size(), total, 10, 20));
+  TEST_ASSERT_EQUAL_UINT16(4, missingRunLen(bitmap.data(), bitmap.size(), total, 10, 5));
+  TEST_ASSERT_EQUAL_UINT16(0, missingRunLen(bitmap.data(), bitmap.size(), total,
+                                            UINT16_MAX, 20));
+
+  uint8_t mask[lp::FW_REQ_MASK_MAX_BYTES];
+  // 275 is 265 past the base, outside the 256-chunk window.
+  size_t len = missingMask(bitmap.data(), bitmap.size(), total, 10, mask, sizeof(mask));
+  TEST_ASSERT_EQUAL_size_t(3, len);
+  TEST_ASSERT_EQUAL_UINT8(0x09, mask[0]);
+  TEST_ASSERT_EQUAL_UINT8(0x00, mask[1]);
+  TEST_ASSERT_EQUAL_UINT8(0x08, mask[2]);
+
+  // Padding bits past totalChunks are never holes.
+  bitmap.assign(bitmap.size(), 0xFF);
+  bitmap[299 / 8] &= static_cast<uint8_t>(~(1u << (299 % 8)));
+  len = missingMask(bitmap.data(), bitmap.size(), total, 296, mask, sizeof(mask));
+  TEST_ASSERT_EQUAL_size_t(1, len);
+  TEST_ASSERT_EQUAL_UINT8(0x08, mask[0]);
+  TEST_ASSERT_EQUAL_size_t(0, missingMask(bitmap.data(), bitmap.size(), total, 0, mask, 4));
+}
+
+void test_hole_queue_serves_named_chunks_below_forward() {
+  ReqHoleQueue q;
+  // Holes at 100, 102, 109, 120; the stream has only reached 115.
+  const uint8_t mask[3] = {0x05, 0x02, 0x10};
+  TEST_ASSERT_TRUE(q.load(100, mask, sizeof(mask), /*forward=*/115, /*total=*/500));
+  TEST_ASSERT_EQUAL_UINT16(3, q.remaining());
+  TEST_ASSERT_EQUAL_UINT16(100, q.front());
+
+  uint16_t next = 0;
+  TEST_ASSERT_TRUE(q.served(100, next));
+  TEST_ASSERT_EQUAL_UINT16(102, next);
+  TEST_ASSERT_TRUE(q.served(102, next));
+  TEST_ASSERT_EQUAL_UINT16(109, next);
+  TEST_ASSERT_FALSE(q.served(109, next));
+  TEST_ASSERT_FALSE(q.active());
+
+  // Nothing below the forward cursor: nothing to queue.
+  TEST_ASSERT_FALSE(q.load(100, mask, sizeof(mask), /*forward=*/100, 500));
+  // A stall rewind past a queued hole wraps back to it.
+  TEST_ASSERT_TRUE(q.load(100, mask, sizeof(mask), 200, 500));
+  TEST_ASSERT_TRUE(q.served(109, next));
+  TEST_ASSERT_EQUAL_UINT16(120, next);
+  TEST_ASSERT_TRUE(q.served(120, next));
+  TEST_ASSERT_EQUAL_UINT16(100, next);
+}
+
+// Same seeds, same channel: the hole mask re-sends nothing the receiver holds,
+// where the run REQ re-streams whole covering spans.
+void test_lossy_link_duplicate_rates() {
+  uint32_t runSent = 0, runDup = 0, runMs = 0;
+  uint32_t maskSent = 0, maskDup = 0, maskMs = 0;
+  uint32_t fastSent = 0, fastMs = 0;
+  for (uint32_t seed = 1; seed <= 8; ++seed) {
+    const SessionStats run = runSession(false, 30, seed * 2654435761u);
+    const SessionStats mask = runSession(true, 30, seed * 2654435761u);
+    const SessionStats fast = runSession(true, 20, seed * 2654435761u);
+    TEST_ASSERT_TRUE(run.complete);
+    TEST_ASSERT_TRUE(mask.complete);
+    TEST_ASSERT_TRUE(fast.complete);
+    runSent += run.chunks;   runDup += run.duplicates;   runMs += run.elapsedMs;
+    maskSent += mask.chunks; maskDup += mask.duplicates; maskMs += mask.elapsedMs;
+    fastSent += fast.chunks; fastMs += fast.elapsedMs;
+  }
+  const uint32_t runDupPermille = runDup * 1000 / runSent;
+  const uint32_t maskDupPermille = maskDup * 1000 / maskSent;
+  printf("run REQ  @30ms: sent %u dup %u (%u permille) %u ms\n", (unsigned)runSent,
+         (unsigned)runDup, (unsigned)runDupPermille, (unsigned)(runMs / 8));
+  printf("hole REQ @30ms: sent %u dup %u (%u permille) %u ms\n", (unsigned)maskSent,
+         (unsigned)maskDup, (unsigned)maskDupPermille, (unsigned)(maskMs / 8));
+  printf("hole REQ @20ms: sent %u %u ms\n", (unsigned)fastSent, (unsigned)(fastMs / 8));
+
+  // The run form's covering spans cost a real duplicate tax...
+  TEST_ASSERT_TRUE(runDupPermille >= 50);
+  // ...the hole form pays at most a stray in-flight resend.
+  TEST_ASSERT_TRUE(maskDupPermille * 10 <= runDupPermille);
+  TEST_ASSERT_TRUE(maskSent < runSent);
+  // Shortened cadence: the same frames as at 30 ms, well inside the run
+  // form's wall time.
+  TEST_ASSERT_TRUE(fastSent < runSent);
+  TEST_ASSERT_TRUE(fastMs < runMs);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_missing_mask_and_run);
+  RUN_TEST(test_hole_queue_serves_named_chunks_below_forward);
+  RUN_TEST(test_lossy_link_duplicate_rates);
+  return UNITY_END();
+}
@@ -0,0 +1,172 @@
+// Native tests for the content-addressed gradient cache (util/gradient_cache)
+// and the in-place configurator fade it feeds.
+//
+//  1. Every cached span is byte-identical to buildGradientWithStops, for
+//     2..8+ stops and pixel counts up to 255, hit or miss.
+//  2. A repeat (stops, pixel count) is a hit; a different count or a changed
+//     stop is a miss; stops past kMaxGradientStops don't key.
+//  3. Overrunning the arena evicts overlapped spans without corrupting the
+//     survivors.
+//  4. ConfiguratorBehavior::beginFadeToStops, the picker-drag path, lands the
+//     same colors as beginFade(buildGradientWithStops(...)) and stops
+//     allocating once its buffers have grown.
+
+#include <unity.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "../../src/behaviors/configurator.cpp"
+#include "../../src/core/animated_behavior.cpp"
+#include "../../src/core/frame_buffer.cpp"
+#include "../../src/util/color.cpp"
+#include "../../src/util/fade.cpp"
+#include "../../src/util/gradient.cpp"
+#include "../../src/util/gradient_cache.cpp"
+
+using lamp::Color;
+using lamp::GradientCache;
+
+// Counts global operator new while armed, as in test_render_bench. Backed by
+// malloc, which the default operator delete pairs with.
+namespace {
+std::atomic<uint32_t> g_allocs{0};
+std::atomic<bool> g_counting{false};
+}  // namespace
+
+void* operator new(std::size_t n) {
+  if (g_counting.load(std::memory_order_relaxed)) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) { return ::operator new(n); }
+
+void setUp(void) {}
+void tearDown(void) {}
+
+namespace {
+
+const std::vector<Color> kStops5 = {
+    Color(255, 0, 0, 0), Color(0, 255, 0, 0), Color(0, 0, 255, 0),
+    Color(0, 0, 0, 255), Color(10, 20, 30, 40)};
+
+void assertMatchesBuild(const Color* got, uint8_t n,
+                        const std::vector<Color>& stops) {
+  const std::vector<Color> want = lamp::buildGradientWithStops(n, stops);
+  for (uint8_t i = 0; i < n; i++) {
+    TEST_ASSERT_TRUE_MESSAGE(got[i] == want[i], "pixel differs from build");
+  }
+}
+
+}  // namespace
+
+void test_spans_match_build_gradient() {
+  GradientCache cache;
+  for (size_t k = 2; k <= kStops5.size(); k++) {
+    const std::vector<Color> stops(kStops5.begin(), kStops5.begin() + k);
+    for (uint8_t n : {1, 2, 7, 36, 40, 255}) {
+      assertMatchesBuild(cache.get(stops.data(), stops.size(), n), n, stops);
+      // Second lookup is a hit and still the same bytes.
+      assertMatchesBuild(cache.get(stops.data(), stops.size(), n), n, stops);
+    }
+  }
+  // Solid and empty fills go through render() without touching the arena.
+  std::vector<Color> out(12, Color(1, 1, 1, 1));
+  cache.render(out.data(), 12, kStops5.data(), 1);
+  for (const Color& c : out) TEST_ASSERT_TRUE(c == kStops5[0]);
+  cache.render(out.data(), 12, nullptr, 0);
+  for (const Color& c : out) TEST_ASSERT_TRUE(c == Color());
+}
+
+void test_hits_and_misses() {
+  GradientCache cache;
+  cache.get(kStops5.data(), 3, 36);
+  cache.get(kStops5.data(), 3, 36);
+  TEST_ASSERT_EQUAL_UINT32(1, cache.hits());
+  TEST_ASSERT_EQUAL_UINT32(1, cache.misses());
+
+  cache.get(kStops5.data(), 3, 32);  // same stops, other length
+  std::vector<Color> changed(kStops5.begin(), kStops5.begin() + 3);
+  changed[1].g = 254;  // one channel of one stop
+  cache.get(changed.data(), changed.size(), 36);
+  TEST_ASSERT_EQUAL_UINT32(3, cache.misses());
+
+  // Stops past the ceiling are ignored by the expansion, so they don't key.
+  std::vector<Color> many(lamp::kMaxGradientStops + 2, Color(5, 5, 5, 5));
+  for (size_t i = 0; i < many.size(); i++) many[i].r = static_cast<uint8_t>(i * 20);
+  cache.get(many.data(), many.size(), 40);
+  many.back().r = 7;
+  const Color* span = cache.get(many.data(), many.size(), 40);
+  TEST_ASSERT_EQUAL_UINT32(2, cache.hits());
+  assertMatchesBuild(span, 40, many);
+}
+
+void test_arena_overrun_evicts_cleanly() {
+  GradientCache cache;
+  // 200 px spans: the third wraps the 512 px arena and evicts the first.
+  std::vector<std::vector<Color>> palettes;
+  for (uint8_t p = 0; p < 6; p++) {
+    palettes.push_back({Color(p * 40, 0, 0, 0), Color(0, p * 40, 0, 0),
+                        Color(0, 0, p * 40, 0)});
+  }
+  for (const auto& stops : palettes) {
+    assertMatchesBuild(cache.get(stops.data(), stops.size(), 200), 200, stops);
+  }
+  // Every palette still resolves to correct bytes, hit or re-expanded.
+  for (const auto& stops : palettes) {
+    assertMatchesBuild(cache.get(stops.data(), stops.size(), 200), 200, stops);
+  }
+  // More distinct keys than slots: correct bytes throughout.
+  for (uint8_t n = 1; n < 40; n++) {
+    assertMatchesBuild(cache.get(kStops5.data(), kStops5.size(), n), n, kStops5);
+  }
+  cache.clear();
+  const uint32_t misses = cache.misses();
+  cache.get(kStops5.data(), kStops5.size(), 10);
+  TEST_ASSERT_EQUAL_UINT32(misses + 1, cache.misses());
+}
+
+void test_configurator_fade_to_stops_matches_and_stops_allocating() {
+  Adafruit_NeoPixel strip;
+  lamp::FrameBuffer fb;
+  fb.begin(std::vector<Color>(40, Color()), 40, &strip);
+  lamp::ConfiguratorBehavior viaStops(&fb);
+  lamp::ConfiguratorBehavior viaVector(&fb);
+
+  viaStops.beginFadeToStops(kStops5.data(), kStops5.size(), 100);
+  viaVector.beginFade(lamp::buildGradientWithStops(40, kStops5), 100);
+  TEST_ASSERT_EQUAL_UINT32(viaVector.colors.size(), viaStops.colors.size());
+  for (size_t i = 0; i < viaStops.colors.size(); i++) {
+    TEST_ASSERT_TRUE(viaStops.colors[i] == viaVector.colors[i]);
+  }
+  TEST_ASSERT_EQUAL_UINT32(100, viaStops.fadeDurationMs());
+
+  // A drag: alternating colors, each write interrupting the previous fade.
+  // Let both fade buffers reach full size first.
+  std::vector<Color> drag(kStops5.begin(), kStops5.begin() + 3);
+  for (int i = 0; i < 3; i++) viaStops.beginFadeToStops(drag.data(), drag.size(), 100);
+  g_allocs.store(0);
+  g_counting.store(true);
+  for (int i = 0; i < 50; i++) {
+    drag[0].r = static_cast<uint8_t>(i * 5);
+    viaStops.beginFadeToStops(drag.data(), drag.size(), 100);
+  }
+  g_counting.store(false);
+  TEST_ASSERT_EQUAL_UINT32(0, g_allocs.load());
+}
+
+int main(int argc, char** argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_spans_match_build_gradient);
+  RUN_TEST(test_hits_and_misses);
+  RUN_TEST(test_arena_overrun_evicts_cleanly);
+  RUN_TEST(test_configurator_fade_to_stops_matches_and_stops_allocating);
+  return UNITY_END();
+}
@@ -0,0 +1,182 @@
+// Native-host tests + microbenchmark for HashedDedupRing.
+//
+// Pins:
+//   1. answers identically to the linear DedupRing for long randomized
+//      streams at 64 / 256 / 1024 capacity (same keying, same ring-ordered
+//      eviction), including heavy duplicate and eviction churn.
+//   2. eviction of a tuple whose probe chain others share (forced bucket
+//      collisions via a tiny ring) leaves the rest findable.
+//   3. reports ns/record for both rings at each capacity on a dense-relay
+//      stream. Timings are reported, not asserted.
+//
+// Production code: software/shared/protocol/src/lampos/protocol/dedup_ring.hpp.
+// Compiles the real header; its portMUX shim is a no-op off-target.
+
+#include <unity.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include <lampos/protocol/dedup_ring.hpp>
+
+using lamp_protocol::DedupRing;
+using lamp_protocol::HashedDedupRing;
+
+namespace {
+
+struct Frame {
+  uint8_t mac[6];
+  uint8_t msgType;
+  uint16_t seq;
+};
+
+// xorshift32: deterministic across hosts.
+uint32_t g_rng = 0x12345678u;
+uint32_t nextRand() {
+  g_rng ^= g_rng << 13;
+  g_rng ^= g_rng >> 17;
+  g_rng ^= g_rng << 5;
+  return g_rng;
+}
+
+// `lamps` senders each emit a run of seqs; every frame is heard `copies`
+// times (direct + relays), copies landing up to `spread` frames late.
+std::vector<Frame> relayStream(size_t lamps, size_t frames, size_t copies, size_t spread) {
+  std::vector<Frame> uniq;
+  uniq.reserve(frames);
+  std::vector<uint16_t> seqs(lamps, 0);
+  for (size_t i = 0; i < frames; i++) {
+    const size_t lamp = nextRand() % lamps;
+    Frame f{{0x24, 0x6F, 0x28, static_cast<uint8_t>(lamp >> 8),
+             static_cast<uint8_t>(lamp), 0x01},
+            static_cast<uint8_t>((nextRand() & 1) ? 0x01 : 0x03),
+            seqs[lamp]++};
+    uniq.push_back(f);
+  }
+  std::vector<Frame> out;
+  out.reserve(frames * copies);
+  for (size_t i = 0; i < uniq.size(); i++) {
+    out.push_back(uniq[i]);
+    for (size_t c = 1; c < copies; c++) {
+      const size_t back = nextRand() % (spread + 1);
+      out.push_back(uniq[i >= back ? i - back : 0]);
+    }
+  }
+  return out;
+}
+
+template <size_t N>
+void checkEquivalent(const std::vector<Frame>& stream) {
+  static DedupRing<N> linear;
+  static HashedDedupRing<N> hashed;
+  linear = DedupRing<N>();
+  hashed = HashedDedupRing<N>();
+  size_t fresh = 0;
+  for (size_t i = 0; i < stream.size(); i++) {
+    const Frame& f = stream[i];
+    const bool a = linear.record(f.mac, f.msgType, f.seq);
+    const bool b = hashed.record(f.mac, f.msgType, f.seq);
+    if (a != b) {
+      char msg[64];
+      std::snprintf(msg, sizeof(msg), "cap %u diverged at frame %u",
+                    static_cast<unsigned>(N), static_cast<unsigned>(i));
+      TEST_FAIL_MESSAGE(msg);
+    }
+    fresh += a;
+  }
+  // The stream must actually exercise both answers and the eviction path.
+  TEST_ASSERT_GREATER_THAN(N, fresh);
+  TEST_ASSERT_LESS_THAN(stream.size(), fresh);
+}
+
+template <size_t N, typename Ring>
+double nsPerRecord(const std::vector<Frame>& stream, int passes) {
+  static Ring ring;
+  ring = Ring();
+  size_t fresh = 0;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int p = 0; p < passes; p++) {
+    for (const Frame& f : stream) fresh += ring.record(f.mac, f.msgType, f.seq);
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  TEST_ASSERT_GREATER_THAN(0, fresh);
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() /
+         (static_cast<double>(stream.size()) * passes);
+}
+
+template <size_t N>
+void reportCapacity(const std::vector<Frame>& stream) {
+  const int passes = 2;
+  const double lin = nsPerRecord<N, DedupRing<N>>(stream, passes);
+  const double hsh = nsPerRecord<N, HashedDedupRing<N>>(stream, passes);
+  std::printf("[bench] dedup cap=%-4u linear=%7.1f ns/record hashed=%6.1f ns/record\n",
+              static_cast<unsigned>(N), lin, hsh);
+}
+
+}  // namespace
+
+void setUp(void) { g_rng = 0x12345678u; }
+void tearDown(void) {}
+
+void test_same_contract_basics() {
+  HashedDedupRing<> ring;
+  const uint8_t a[6] = {0xAA, 0x11, 0x22, 0x33, 0x44, 0x01};
+  const uint8_t b[6] = {0xBB, 0x11, 0x22, 0x33, 0x44, 0x02};
+  const uint8_t zero[6] = {0, 0, 0, 0, 0, 0};
+  TEST_ASSERT_TRUE(ring.record(a, 0x02, 100));
+  TEST_ASSERT_FALSE(ring.record(a, 0x02, 100));
+  TEST_ASSERT_TRUE(ring.record(a, 0x02, 101));  // seq
+  TEST_ASSERT_TRUE(ring.record(a, 0x01, 100));  // msgType
+  TEST_ASSERT_TRUE(ring.record(b, 0x02, 100));  // mac
+  // An empty ring never matches the all-zero tuple.
+  TEST_ASSERT_TRUE(ring.record(zero, 0x00, 0));
+  TEST_ASSERT_FALSE(ring.record(zero, 0x00, 0));
+}
+
+void test_full_ring_evicts_oldest_first() {
+  HashedDedupRing<> ring;
+  const uint8_t mac[6] = {0xAA, 0x11, 0x22, 0x33, 0x44, 0x01};
+  for (uint16_t s = 0; s < 64; ++s) TEST_ASSERT_TRUE(ring.record(mac, 0x02, s));
+  TEST_ASSERT_FALSE(ring.record(mac, 0x02, 0));
+  TEST_ASSERT_FALSE(ring.record(mac, 0x02, 63));
+  TEST_ASSERT_TRUE(ring.record(mac, 0x02, 64));  // evicts seq 0
+  TEST_ASSERT_TRUE(ring.record(mac, 0x02, 0));   // evicts seq 1
+  TEST_ASSERT_FALSE(ring.record(mac, 0x02, 2));
+  TEST_ASSERT_TRUE(ring.record(mac, 0x02, 1));
+}
+
+// A 2-entry ring has 4 buckets, so chains collide constantly and every
+// insert past the second runs the shift-delete.
+void test_tiny_ring_collisions_match_linear() {
+  std::vector<Frame> stream = relayStream(3, 4000, 3, 4);
+  checkEquivalent<2>(stream);
+  checkEquivalent<3>(stream);
+}
+
+void test_matches_linear_ring_at_64_256_1024() {
+  const std::vector<Frame> stream = relayStream(80, 20000, 4, 300);
+  checkEquivalent<64>(stream);
+  checkEquivalent<256>(stream);
+  checkEquivalent<1024>(stream);
+}
+
+// 60+ lamps, every frame heard ~4 times, relays arriving up to a few hundred
+// frames late: the dense-crowd HELLO / CONTROL_OP pattern.
+void test_report_record_cost() {
+  const std::vector<Frame> stream = relayStream(64, 20000, 4, 200);
+  reportCapacity<64>(stream);
+  reportCapacity<256>(stream);
+  reportCapacity<1024>(stream);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_same_contract_basics);
+  RUN_TEST(test_full_ring_evicts_oldest_first);
+  RUN_TEST(test_tiny_ring_collisions_match_linear);
+  RUN_TEST(test_matches_linear_ring_at_64_256_1024);
+  RUN_TEST(test_report_record_cost);
+  return UNITY_END();
+}
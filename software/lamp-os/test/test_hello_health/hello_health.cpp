@@ -0,0 +1,94 @@
+// Native tests for HelloHealthSampler: report cadence and the per-window
+// figures it derives from the metrics registry for HELLO_TLV_HEALTH.
+
+#include <unity.h>
+
+#include <cstdint>
+
+#include "../../src/util/metrics.cpp"
+#include "../../src/components/network/mesh/hello_health.cpp"
+
+using lamp::HelloHealthSampler;
+using lamp::metrics::Registry;
+
+void setUp() {}
+void tearDown() {}
+
+void test_reports_once_per_interval() {
+  Registry reg;
+  HelloHealthSampler s(reg);
+  lamp_protocol::HelloHealth h;
+  TEST_ASSERT_FALSE(s.poll(5000, h));
+  TEST_ASSERT_TRUE(s.poll(HelloHealthSampler::kIntervalMs, h));
+  // Steady HELLOs every 30 s: every other one carries health.
+  const uint32_t t0 = HelloHealthSampler::kIntervalMs;
+  TEST_ASSERT_FALSE(s.poll(t0 + 30000, h));
+  TEST_ASSERT_TRUE(s.poll(t0 + 60000, h));
+  TEST_ASSERT_FALSE(s.poll(t0 + 90000, h));
+  TEST_ASSERT_TRUE(s.poll(t0 + 120000, h));
+}
+
+void test_window_figures() {
+  Registry reg;
+  auto& frame = reg.histogram("frame.us");
+  auto& drops = reg.counter("frame.drop");
+  auto& relays = reg.counter("mesh.relay");
+  auto& heapLow = reg.gauge("heap.low");
+  auto& heapBig = reg.gauge("heap.largest");
+  auto& slots = reg.gauge("slot.drop");
+  auto& rxq = reg.gauge("rxq.drop");
+  HelloHealthSampler s(reg);
+  lamp_protocol::HelloHealth h;
+
+  // First window: a stall-heavy boot.
+  for (int i = 0; i < 50; i++) frame.record(16000);
+  for (int i = 0; i < 50; i++) frame.record(60000);
+  drops.add(50);
+  relays.add(110);
+  heapLow.set(70 * 1024 + 500);
+  heapBig.set(30 * 1024);
+  slots.set(2);
+  rxq.set(1);
+  TEST_ASSERT_TRUE(s.poll(60000, h));
+  TEST_ASSERT_TRUE(h.frameP99Us >= 60000 && h.frameP99Us < 60000 * 5 / 4);
+  TEST_ASSERT_EQUAL_UINT16(50, h.frameDrops);
+  TEST_ASSERT_EQUAL_UINT16(3, h.slotDrops);
+  TEST_ASSERT_EQUAL_UINT16(110, h.relayPerMin);
+  TEST_ASSERT_EQUAL_UINT16(70, h.heapLowKb);
+  TEST_ASSERT_EQUAL_UINT16(30, h.heapLargestKb);
+
+  // Second window: healthy. The boot stalls don't leak into the p99 and the
+  // counts are deltas; heap figures are current levels.
+  for (int i = 0; i < 1000; i++) frame.record(16000 + (i % 400));
+  relays.add(30);
+  TEST_ASSERT_TRUE(s.poll(60000 + 120000, h));
+  TEST_ASSERT_TRUE(h.frameP99Us >= 16399 && h.frameP99Us <= 16400 * 5 / 4);
+  TEST_ASSERT_EQUAL_UINT16(0, h.frameDrops);
+  TEST_ASSERT_EQUAL_UINT16(0, h.slotDrops);
+  TEST_ASSERT_EQUAL_UINT16(15, h.relayPerMin);
+  TEST_ASSERT_EQUAL_UINT16(70, h.heapLowKb);
+
+  // A console metrics.reset mid-window: the report covers what came after.
+  reg.resetWindow();
+  for (int i = 0; i < 10; i++) frame.record(20000);
+  TEST_ASSERT_TRUE(s.poll(60000 + 240000, h));
+  TEST_ASSERT_TRUE(h.frameP99Us >= 20000 && h.frameP99Us < 20000 * 5 / 4);
+
+  // Another reset, then more frames than the last baseline held: no bucket
+  // delta may wrap.
+  reg.resetWindow();
+  for (int i = 0; i < 20; i++) frame.record(40000);
+  TEST_ASSERT_TRUE(s.poll(60000 + 300000, h));
+  TEST_ASSERT_TRUE(h.frameP99Us >= 40000 && h.frameP99Us < 40000 * 5 / 4);
+
+  // A window without frames reports 0, not a stale value.
+  TEST_ASSERT_TRUE(s.poll(60000 + 420000, h));
+  TEST_ASSERT_EQUAL_UINT32(0, h.frameP99Us);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_reports_once_per_interval);
+  RUN_TEST(test_window_figures);
+  return UNITY_END();
+}
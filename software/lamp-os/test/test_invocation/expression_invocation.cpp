@@ -6,11 +6,14 @@
 //      ("rrggbbww" per color, no '#', no separators; key omitted when empty).
 //   3. malformed colors (bad length / non-hex) drop whole; parse still succeeds.
 //   4. worst-case 8-color zoned glitchy payload fits COMMAND_MAX_PAYLOAD.
+//   5. binary wire form: decodes to the same invocation as JSON, rejects
+//      truncation / unknown ids, falls back (returns 0) for out-of-table
+//      types, and parseInvocationPayload dispatches on the first byte.
 
 #include <unity.h>
 
+#include <chrono>
 #include <cstdio>
-#include <map>
 #include <string>
 
 #include "components/network/protocol/command.hpp"
@@ -25,56 +28,56 @@ void tearDown(void) {}
 // --- cascade-key stripping ---
 
 void test_strip_removes_cascade_enabled() {
-  std::map<std::string, uint32_t> in = {
+  lamp::ParamSet in = {
       {"cascadeEnabled", 1}, {"pulseSpeed", 5}};
   auto out = lamp::parametersWithoutCascadeKeys(in);
   TEST_ASSERT_EQUAL(1, (int)out.size());
-  TEST_ASSERT_EQUAL(5, (int)out["pulseSpeed"]);
-  TEST_ASSERT_EQUAL(0, (int)out.count("cascadeEnabled"));
+  TEST_ASSERT_EQUAL(5, (int)out.get("pulseSpeed", 0));
+  TEST_ASSERT_EQUAL(0, (int)out.has("cascadeEnabled"));
 }
 
 void test_strip_removes_cascade_stagger_ms() {
-  std::map<std::string, uint32_t> in = {
-      {"cascadeStaggerMs", 2000}, {"holdMs", 5000}};
+  lamp::ParamSet in = {
+      {"cascadeStaggerMs", 2000}, {"fadeDuration", 5000}};
   auto out = lamp::parametersWithoutCascadeKeys(in);
   TEST_ASSERT_EQUAL(1, (int)out.size());
-  TEST_ASSERT_EQUAL(5000, (int)out["holdMs"]);
-  TEST_ASSERT_EQUAL(0, (int)out.count("cascadeStaggerMs"));
+  TEST_ASSERT_EQUAL(5000, (int)out.get("fadeDuration", 0));
+  TEST_ASSERT_EQUAL(0, (int)out.has("cascadeStaggerMs"));
 }
 
 void test_strip_removes_both_cascade_keys() {
-  std::map<std::string, uint32_t> in = {
+  lamp::ParamSet in = {
       {"cascadeEnabled", 1},
       {"cascadeStaggerMs", 1000},
       {"durationMin", 1},
       {"durationMax", 3}};
   auto out = lamp::parametersWithoutCascadeKeys(in);
   TEST_ASSERT_EQUAL(2, (int)out.size());
-  TEST_ASSERT_EQUAL(1, (int)out["durationMin"]);
-  TEST_ASSERT_EQUAL(3, (int)out["durationMax"]);
+  TEST_ASSERT_EQUAL(1, (int)out.get("durationMin", 0));
+  TEST_ASSERT_EQUAL(3, (int)out.get("durationMax", 0));
 }
 
 void test_strip_is_noop_when_no_cascade_keys() {
-  std::map<std::string, uint32_t> in = {
+  lamp::ParamSet in = {
       {"pulseSpeed", 5}, {"durationMin", 1}};
   auto out = lamp::parametersWithoutCascadeKeys(in);
   TEST_ASSERT_EQUAL(2, (int)out.size());
-  TEST_ASSERT_EQUAL(5, (int)out["pulseSpeed"]);
-  TEST_ASSERT_EQUAL(1, (int)out["durationMin"]);
+  TEST_ASSERT_EQUAL(5, (int)out.get("pulseSpeed", 0));
+  TEST_ASSERT_EQUAL(1, (int)out.get("durationMin", 0));
 }
 
 void test_strip_handles_empty_map() {
-  std::map<std::string, uint32_t> in;
+  lamp::ParamSet in;
   auto out = lamp::parametersWithoutCascadeKeys(in);
   TEST_ASSERT_EQUAL(0, (int)out.size());
 }
 
 void test_strip_does_not_mutate_input() {
-  std::map<std::string, uint32_t> in = {
+  lamp::ParamSet in = {
       {"cascadeEnabled", 1}, {"pulseSpeed", 5}};
   lamp::parametersWithoutCascadeKeys(in);
   TEST_ASSERT_EQUAL(2, (int)in.size());
-  TEST_ASSERT_EQUAL(1, (int)in["cascadeEnabled"]);
+  TEST_ASSERT_EQUAL(1, (int)in.get("cascadeEnabled", 0));
 }
 
 // --- delayMs clamp ---
@@ -154,6 +157,21 @@ void test_serialize_omits_colors_when_empty() {
   TEST_ASSERT_EQUAL_UINT(0, out.colors.size());
 }
 
+void test_parse_keeps_known_params_and_drops_unknown() {
+  const char* json =
+      "{\"type\":\"pulse\",\"parameters\":{\"pulseSpeed\":7,\"loop\":true,"
+      "\"posMin\":-1,\"notAParam\":9}}";
+  JsonDocument doc;
+  TEST_ASSERT_TRUE(deserializeJson(doc, json) == DeserializationError::Ok);
+  lamp::ExpressionInvocation out;
+  TEST_ASSERT_TRUE(lamp::parseInvocation(doc.as<JsonObjectConst>(), out));
+  TEST_ASSERT_EQUAL_UINT(3, out.parameters.size());
+  TEST_ASSERT_EQUAL_UINT32(7u, out.parameters.get("pulseSpeed", 0));
+  TEST_ASSERT_EQUAL_UINT32(1u, out.parameters.get("loop", 0));
+  TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFFu, out.parameters.get("posMin", 0));
+  TEST_ASSERT_FALSE(out.parameters.has("notAParam"));
+}
+
 // --- malformed colors: dropped whole, invocation still parses ---
 
 static void assertColorsDropped(const char* json) {
@@ -206,6 +224,154 @@ void test_zoned_glitchy_8_colors_fits_command_payload() {
                                  json.size());
 }
 
+// --- binary wire form ---
+
+static lamp::ExpressionInvocation zonedGlitchy() {
+  lamp::ExpressionInvocation inv;
+  inv.type = "glitchy";
+  inv.target = 1;
+  inv.delayMs = 750;
+  for (int i = 0; i < 8; i++) {
+    inv.colors.push_back(lamp::Color(0xFF, 0x10 * i, 0x20, 0xFF - i));
+  }
+  inv.parameters = {
+      {"durationMin", 30}, {"durationMax", 120}, {"fullStrip", 0},
+      {"posMin", 0},       {"posMax", 37},       {"count", 1},
+      {"size", 1},         {"scatter", 0xFFFFFFFFu},
+  };
+  return inv;
+}
+
+static void assertSameInvocation(const lamp::ExpressionInvocation& a,
+                                 const lamp::ExpressionInvocation& b) {
+  TEST_ASSERT_EQUAL_STRING(a.type.c_str(), b.type.c_str());
+  TEST_ASSERT_EQUAL_UINT8(a.target, b.target);
+  TEST_ASSERT_EQUAL_UINT32(a.delayMs, b.delayMs);
+  TEST_ASSERT_EQUAL_UINT(a.colors.size(), b.colors.size());
+  for (size_t i = 0; i < a.colors.size(); i++) {
+    TEST_ASSERT_TRUE(a.colors[i] == b.colors[i]);
+  }
+  TEST_ASSERT_TRUE(a.parameters == b.parameters);
+}
+
+void test_binary_decodes_same_as_json() {
+  const lamp::ExpressionInvocation in = zonedGlitchy();
+  uint8_t bin[lamp::kInvocationBinaryMaxSize];
+  const size_t n = lamp::serializeInvocationBinary(in, bin, sizeof(bin));
+  TEST_ASSERT_GREATER_THAN(0, n);
+  TEST_ASSERT_EQUAL_UINT8(lamp::kInvocationBinaryTag, bin[0]);
+
+  lamp::ExpressionInvocation viaBinary, viaJson;
+  TEST_ASSERT_TRUE(lamp::parseInvocationPayload(bin, n, viaBinary));
+  std::string json;
+  lamp::serializeInvocation(in, json);
+  TEST_ASSERT_TRUE(lamp::parseInvocationPayload(
+      reinterpret_cast<const uint8_t*>(json.data()), json.size(), viaJson));
+  assertSameInvocation(viaJson, viaBinary);
+  assertSameInvocation(in, viaBinary);
+
+  std::printf("zoned glitchy invocation: json=%u B binary=%u B\n",
+              (unsigned)json.size(), (unsigned)n);
+  // The point of the form: several-fold smaller on the air.
+  TEST_ASSERT_LESS_THAN(json.size() / 3, n);
+}
+
+void test_binary_every_type_round_trips() {
+  for (size_t t = 0; t < lamp::kInvocationTypeCount; t++) {
+    lamp::ExpressionInvocation in;
+    in.type = lamp::kInvocationTypeNames[t];
+    uint8_t bin[lamp::kInvocationBinaryMaxSize];
+    const size_t n = lamp::serializeInvocationBinary(in, bin, sizeof(bin));
+    TEST_ASSERT_EQUAL(6, (int)n);  // tag type target 0-colors 0-params delay
+    lamp::ExpressionInvocation out;
+    TEST_ASSERT_TRUE(lamp::parseInvocationBinary(bin, n, out));
+    TEST_ASSERT_EQUAL_STRING(in.type.c_str(), out.type.c_str());
+  }
+}
+
+void test_binary_unknown_type_or_too_many_colors_falls_back() {
+  uint8_t bin[lamp::kInvocationBinaryMaxSize];
+  lamp::ExpressionInvocation inv;
+  inv.type = "notAnExpression";
+  TEST_ASSERT_EQUAL(0, (int)lamp::serializeInvocationBinary(inv, bin, sizeof(bin)));
+  inv.type = "pulse";
+  inv.colors.assign(lamp::kMaxBinaryInvocationColors + 1, lamp::Color(1, 2, 3, 4));
+  TEST_ASSERT_EQUAL(0, (int)lamp::serializeInvocationBinary(inv, bin, sizeof(bin)));
+  // Too small a buffer is a refusal, not an overrun.
+  inv.colors.clear();
+  TEST_ASSERT_EQUAL(0, (int)lamp::serializeInvocationBinary(inv, bin, 3));
+}
+
+void test_binary_clamps_delay_and_coerces_target() {
+  lamp::ExpressionInvocation in;
+  in.type = "spotty";
+  in.target = 9;
+  in.delayMs = 60000;
+  uint8_t bin[lamp::kInvocationBinaryMaxSize];
+  const size_t n = lamp::serializeInvocationBinary(in, bin, sizeof(bin));
+  lamp::ExpressionInvocation out;
+  TEST_ASSERT_TRUE(lamp::parseInvocationBinary(bin, n, out));
+  TEST_ASSERT_EQUAL_UINT8(3, out.target);
+  TEST_ASSERT_EQUAL_UINT32(lamp::kMaxDelayMs, out.delayMs);
+}
+
+void test_binary_rejects_truncation_and_bad_ids() {
+  const lamp::ExpressionInvocation in = zonedGlitchy();
+  uint8_t bin[lamp::kInvocationBinaryMaxSize];
+  const size_t n = lamp::serializeInvocationBinary(in, bin, sizeof(bin));
+  lamp::ExpressionInvocation out;
+  for (size_t cut = 0; cut < n; cut++) {
+    TEST_ASSERT_FALSE(lamp::parseInvocationBinary(bin, cut, out));
+  }
+  // Appended bytes are reserved for additive fields and ignored.
+  bin[n] = 0x7F;
+  TEST_ASSERT_TRUE(lamp::parseInvocationBinary(bin, n + 1, out));
+
+  uint8_t badType[] = {lamp::kInvocationBinaryTag,
+                       (uint8_t)lamp::kInvocationTypeCount, 3, 0, 0, 0};
+  TEST_ASSERT_FALSE(lamp::parseInvocationBinary(badType, sizeof(badType), out));
+  uint8_t badKey[] = {lamp::kInvocationBinaryTag, 0, 3, 0, 1,
+                      (uint8_t)lamp::kParamKeyCount, 1, 0};
+  TEST_ASSERT_FALSE(lamp::parseInvocationBinary(badKey, sizeof(badKey), out));
+  // A varint that never terminates within 5 bytes.
+  uint8_t longVarint[] = {lamp::kInvocationBinaryTag, 0, 3, 0, 0,
+                          0x80, 0x80, 0x80, 0x80, 0x80, 0x01};
+  TEST_ASSERT_FALSE(lamp::parseInvocationBinary(longVarint, sizeof(longVarint), out));
+}
+
+// Receive-side cost per invocation, both forms through the drain entry point.
+// Reported, not asserted (host time, not ESP32 time).
+void test_report_parse_cost() {
+  const lamp::ExpressionInvocation in = zonedGlitchy();
+  uint8_t bin[lamp::kInvocationBinaryMaxSize];
+  const size_t n = lamp::serializeInvocationBinary(in, bin, sizeof(bin));
+  std::string json;
+  lamp::serializeInvocation(in, json);
+
+  constexpr int kIterations = 20000;
+  lamp::ExpressionInvocation out;
+  using Clock = std::chrono::steady_clock;
+  const auto t0 = Clock::now();
+  for (int i = 0; i < kIterations; i++) {
+    lamp::parseInvocationPayload(reinterpret_cast<const uint8_t*>(json.data()),
+                                 json.size(), out);
+  }
+  const auto t1 = Clock::now();
+  for (int i = 0; i < kIterations; i++) lamp::parseInvocationPayload(bin, n, out);
+  const auto t2 = Clock::now();
+  std::printf("[bench] invocation parse: json=%.0f ns binary=%.0f ns\n",
+              std::chrono::duration<double, std::nano>(t1 - t0).count() / kIterations,
+              std::chrono::duration<double, std::nano>(t2 - t1).count() / kIterations);
+  assertSameInvocation(in, out);
+}
+
+void test_payload_rejects_non_json_non_binary() {
+  const uint8_t junk[] = {0x00, 0x01, 0x02};
+  lamp::ExpressionInvocation out;
+  TEST_ASSERT_FALSE(lamp::parseInvocationPayload(junk, sizeof(junk), out));
+  TEST_ASSERT_FALSE(lamp::parseInvocationPayload(junk, 0, out));
+}
+
 int main() {
   UNITY_BEGIN();
   RUN_TEST(test_strip_removes_cascade_enabled);
@@ -224,6 +390,14 @@ int main() {
   RUN_TEST(test_parse_drops_truncated_colors);
   RUN_TEST(test_parse_drops_odd_length_colors);
   RUN_TEST(test_parse_drops_non_hex_colors);
+  RUN_TEST(test_parse_keeps_known_params_and_drops_unknown);
   RUN_TEST(test_zoned_glitchy_8_colors_fits_command_payload);
+  RUN_TEST(test_binary_decodes_same_as_json);
+  RUN_TEST(test_binary_every_type_round_trips);
+  RUN_TEST(test_binary_unknown_type_or_too_many_colors_falls_back);
+  RUN_TEST(test_binary_clamps_delay_and_coerces_target);
+  RUN_TEST(test_binary_rejects_truncation_and_bad_ids);
+  RUN_TEST(test_payload_rejects_non_json_non_binary);
+  RUN_TEST(test_report_parse_cost);
   return UNITY_END();
 }
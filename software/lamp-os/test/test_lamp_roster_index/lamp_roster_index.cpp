@@ -0,0 +1,267 @@
+// Native-host tests + microbenchmark for LampRoster's maintained indexes.
+//
+// Pins:
+//   1. under long randomized churn (BLE and HELLO sightings, RSSI jitter,
+//      evictions past kCapacity, prunes, acks) getNear equals the old
+//      copy / filter / sort of getAll, getMesh holds exactly the
+//      mesh-fresh entries, and findByMac hits every live MAC and misses
+//      evicted ones.
+//   2. bestUngreetedArrival picks the same peer as a full scan would.
+//   3. generation() moves on every mutation and only then, and
+//      viewGeneration() stamps the copy a getter returned.
+//   4. reports getNear / findByMac cost at a full roster. Timings are
+//      reported, not asserted.
+//
+// Production code: src/components/network/mesh/lamp_roster.cpp.
+
+#include <unity.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Native-test seam: exercise the shipped class.
+#include "components/network/mesh/lamp_roster.cpp"
+
+using namespace lamp;
+
+namespace {
+
+const Color kNoColor = Color();
+
+// xorshift32: deterministic across hosts.
+uint32_t g_rng = 0x2468ACE1u;
+uint32_t nextRand() {
+  g_rng ^= g_rng << 13;
+  g_rng ^= g_rng >> 17;
+  g_rng ^= g_rng << 5;
+  return g_rng;
+}
+
+// Peer `i`'s BLE address and the mesh MAC the roster recovers from it, so
+// both transports land on the same entry.
+void peerAddr(uint8_t i, char (&addr)[18], uint8_t mac[6]) {
+  std::snprintf(addr, sizeof(addr), "24:6F:28:%02X:%02X:10", i / 7, i);
+  uint8_t ble[6];
+  parseBdAddr(addr, ble);
+  meshMacFromBleAddr(ble, mac);
+}
+
+void seeBle(LampRoster& r, uint8_t i, int8_t rssi) {
+  char addr[18];
+  uint8_t mac[6];
+  peerAddr(i, addr, mac);
+  r.addOrUpdateFromBle("peer", addr, kNoColor, kNoColor, rssi);
+}
+
+void seeHello(LampRoster& r, uint8_t i) {
+  char addr[18];
+  uint8_t mac[6];
+  peerAddr(i, addr, mac);
+  r.addOrUpdateFromEspNow("peer", mac, kNoColor, kNoColor, 0x010203, 0, 5,
+                          nullptr, nullptr, false, 0, false, nullptr, false,
+                          -60);
+}
+
+bool nearFresh(const RosterEntry& e, uint32_t maxAgeMs) {
+  return e.lastSeenNearMs != 0 && (g_mock_millis - e.lastSeenNearMs) <= maxAgeMs;
+}
+
+bool meshFresh(const RosterEntry& e, uint32_t maxAgeMs) {
+  return e.lastSeenMeshMs != 0 && (g_mock_millis - e.lastSeenMeshMs) <= maxAgeMs;
+}
+
+// The pre-index getNear: filter a full copy, then sort.
+std::vector<RosterEntry> referenceNear(LampRoster& r, uint32_t maxAgeMs) {
+  std::vector<RosterEntry> out;
+  for (const RosterEntry& e : r.getAll()) {
+    if (nearFresh(e, maxAgeMs)) out.push_back(e);
+  }
+  std::sort(out.begin(), out.end(), [](const RosterEntry& a, const RosterEntry& b) {
+    if (a.lastRssi != b.lastRssi) return a.lastRssi > b.lastRssi;
+    return std::memcmp(a.mac, b.mac, 6) < 0;
+  });
+  return out;
+}
+
+void checkViews(LampRoster& r, uint32_t maxAgeMs, size_t step) {
+  char msg[64];
+  std::snprintf(msg, sizeof(msg), "diverged at step %u", static_cast<unsigned>(step));
+
+  const std::vector<RosterEntry> want = referenceNear(r, maxAgeMs);
+  const std::vector<RosterEntry>& got = r.getNear(maxAgeMs);
+  TEST_ASSERT_TRUE_MESSAGE(want.size() == got.size(), msg);
+  for (size_t k = 0; k < want.size(); k++) {
+    TEST_ASSERT_TRUE_MESSAGE(std::memcmp(want[k].mac, got[k].mac, 6) == 0, msg);
+  }
+
+  size_t meshWant = 0;
+  const std::vector<RosterEntry> all = r.getAll();
+  for (const RosterEntry& e : all) meshWant += meshFresh(e, maxAgeMs);
+  const std::vector<RosterEntry>& mesh = r.getMesh(maxAgeMs);
+  TEST_ASSERT_TRUE_MESSAGE(meshWant == mesh.size(), msg);
+  for (const RosterEntry& e : mesh) TEST_ASSERT_TRUE_MESSAGE(meshFresh(e, maxAgeMs), msg);
+
+  for (const RosterEntry& e : all) {
+    RosterEntry hit;
+    TEST_ASSERT_TRUE_MESSAGE(r.findByMac(e.mac, hit), msg);
+    TEST_ASSERT_TRUE_MESSAGE(std::memcmp(e.mac, hit.mac, 6) == 0, msg);
+  }
+}
+
+}  // namespace
+
+void setUp(void) {
+  g_rng = 0x2468ACE1u;
+  set_mock_millis(100000);
+}
+void tearDown(void) {}
+
+void test_views_match_reference_under_churn() {
+  static LampRoster r;
+  const uint32_t maxAge = 20000;
+  // 90 peers over a 50-entry roster: evictions on most steps once warm.
+  for (size_t step = 0; step < 6000; step++) {
+    g_mock_millis += 1 + nextRand() % 40;
+    const uint8_t peer = static_cast<uint8_t>(nextRand() % 90);
+    switch (nextRand() % 8) {
+      case 0:
+      case 1:
+      case 2:
+        seeBle(r, peer, static_cast<int8_t>(-30 - static_cast<int>(nextRand() % 60)));
+        break;
+      case 3:
+      case 4:
+        seeHello(r, peer);
+        break;
+      case 5: {
+        char addr[18];
+        uint8_t mac[6];
+        peerAddr(peer, addr, mac);
+        r.markNear(mac);
+        break;
+      }
+      case 6: {
+        char addr[18];
+        uint8_t mac[6];
+        peerAddr(peer, addr, mac);
+        r.acknowledge(mac);
+        break;
+      }
+      default:
+        if (nextRand() % 16 == 0) r.prune(maxAge);
+        break;
+    }
+    checkViews(r, maxAge, step);
+  }
+  TEST_ASSERT_EQUAL_size_t(LampRoster::kCapacity, r.getAll().size());
+}
+
+void test_evicted_and_pruned_macs_miss() {
+  LampRoster r;
+  for (uint8_t i = 0; i < LampRoster::kCapacity + 5; i++) {
+    g_mock_millis += 10;
+    seeHello(r, i);
+  }
+  // The five stalest were evicted.
+  for (uint8_t i = 0; i < LampRoster::kCapacity + 5; i++) {
+    char addr[18];
+    uint8_t mac[6];
+    peerAddr(i, addr, mac);
+    RosterEntry out;
+    TEST_ASSERT_EQUAL(i >= 5, r.findByMac(mac, out));
+  }
+  g_mock_millis += 1000;
+  seeHello(r, 7);
+  r.prune(500);
+  TEST_ASSERT_EQUAL_size_t(1, r.getAll().size());
+  char addr[18];
+  uint8_t mac[6];
+  peerAddr(7, addr, mac);
+  RosterEntry out;
+  TEST_ASSERT_TRUE(r.findByMac(mac, out));
+  peerAddr(8, addr, mac);
+  TEST_ASSERT_FALSE(r.findByMac(mac, out));
+}
+
+void test_best_arrival_matches_full_scan() {
+  LampRoster r;
+  for (uint8_t i = 0; i < 30; i++) {
+    seeBle(r, i, static_cast<int8_t>(-40 - (nextRand() % 8)));  // many ties
+  }
+  // Greet the best few, then check each pick against a scan of getAll.
+  for (int round = 0; round < 10; round++) {
+    RosterEntry best;
+    bool any = false;
+    for (const RosterEntry& e : r.getAll()) {
+      if (e.acknowledged) continue;
+      if (!any || e.lastRssi > best.lastRssi ||
+          (e.lastRssi == best.lastRssi && std::memcmp(e.mac, best.mac, 6) < 0)) {
+        best = e;
+        any = true;
+      }
+    }
+    RosterEntry picked;
+    TEST_ASSERT_TRUE(r.bestUngreetedArrival(240000, g_mock_millis,
+                                            [](const RosterEntry&) { return true; },
+                                            picked));
+    TEST_ASSERT_EQUAL_MEMORY(best.mac, picked.mac, 6);
+    r.acknowledge(picked.mac);
+  }
+}
+
+void test_generation_tracks_mutations() {
+  LampRoster r;
+  const uint32_t g0 = r.generation();
+  seeBle(r, 1, -50);
+  const uint32_t g1 = r.generation();
+  TEST_ASSERT_EQUAL_UINT32(g0 + 1, g1);
+  r.prune(240000);  // nothing stale: no write
+  uint8_t unknown[6] = {0xDE, 0xAD, 0, 0, 0, 0};
+  r.markNear(unknown);
+  r.acknowledge(unknown);
+  TEST_ASSERT_EQUAL_UINT32(g1, r.generation());
+  seeHello(r, 1);
+  TEST_ASSERT_EQUAL_UINT32(g1 + 1, r.generation());
+  r.getAll();
+  TEST_ASSERT_EQUAL_UINT32(r.generation(), r.viewGeneration());
+}
+
+void test_report_lookup_cost() {
+  static LampRoster r;
+  for (uint8_t i = 0; i < LampRoster::kCapacity; i++) {
+    seeBle(r, i, static_cast<int8_t>(-30 - i));
+    seeHello(r, i);
+  }
+  const int iters = 20000;
+  size_t sink = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int k = 0; k < iters; k++) sink += r.getNear(240000).size();
+  auto t1 = std::chrono::steady_clock::now();
+  for (int k = 0; k < iters; k++) {
+    char addr[18];
+    uint8_t mac[6];
+    peerAddr(static_cast<uint8_t>(k % LampRoster::kCapacity), addr, mac);
+    RosterEntry out;
+    sink += r.findByMac(mac, out);
+  }
+  auto t2 = std::chrono::steady_clock::now();
+  TEST_ASSERT_GREATER_THAN(0, sink);
+  std::printf("[bench] roster n=%u getNear=%7.1f ns findByMac+addr=%6.1f ns\n",
+              static_cast<unsigned>(LampRoster::kCapacity),
+              std::chrono::duration<double, std::nano>(t1 - t0).count() / iters,
+              std::chrono::duration<double, std::nano>(t2 - t1).count() / iters);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_views_match_reference_under_churn);
+  RUN_TEST(test_evicted_and_pruned_macs_miss);
+  RUN_TEST(test_best_arrival_matches_full_scan);
+  RUN_TEST(test_generation_tracks_mutations);
+  RUN_TEST(test_report_lookup_cost);
+  return UNITY_END();
+}
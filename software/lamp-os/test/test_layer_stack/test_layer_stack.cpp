@@ -209,6 +209,37 @@ void test_adapter_per_surface_presence_no_stale_sibling() {
   assertColorEq(shadeWisp, rig.shade.composite(shadeOwn));
 }
 
+// compositeSpan must produce composite()'s bytes for every pixel, through
+// partial weights, a fully-opaque layer mid-stack and mid-ease states.
+void test_composite_span_matches_per_pixel() {
+  Color own[64];
+  for (int i = 0; i < 64; ++i) {
+    const uint32_t v = static_cast<uint32_t>(i) * 2654435761u;
+    own[i] = Color(v & 0xFF, (v >> 8) & 0xFF, (v >> 16) & 0xFF, (v >> 24) & 0xFF);
+  }
+  const float presences[] = {0.0f, 0.03f, 0.5f, 0.97f, 1.0f};
+  for (float w : presences) {
+    for (int layers = 0; layers <= 4; ++layers) {
+      LayerStack s;
+      s.setWispTarget(Color(250, 3, 128, 77));
+      for (int l = 0; l < layers; ++l) {
+        // Layer 2 goes fully opaque, so later layers sit on a solid fill.
+        s.setExpressionLayer(l, Color(40 * l, 255 - 30 * l, 7 * l, 90),
+                             /*enabled=*/true, l == 2 ? 1.0f : 0.2f + 0.15f * l,
+                             /*wispDimFloor=*/0.6f);
+      }
+      for (int frame = 0; frame < 45; ++frame) {
+        s.tick(w);
+        if (frame % 7 != 3) continue;  // check a few mid-ease frames
+        Color span[64];
+        for (int i = 0; i < 64; ++i) span[i] = own[i];
+        s.compositeSpan(span, 64);
+        for (int i = 0; i < 64; ++i) assertColorEq(s.composite(own[i]), span[i]);
+      }
+    }
+  }
+}
+
 int main(int, char**) {
   UNITY_BEGIN();
   RUN_TEST(test_empty_stack_own_only);
@@ -222,5 +253,6 @@ int main(int, char**) {
   RUN_TEST(test_wisp_dim_floor_dims_expression);
   RUN_TEST(test_adapter_override_reveals_then_restore_homes);
   RUN_TEST(test_adapter_per_surface_presence_no_stale_sibling);
+  RUN_TEST(test_composite_span_matches_per_pixel);
   return UNITY_END();
 }
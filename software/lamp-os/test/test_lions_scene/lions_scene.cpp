@@ -5,6 +5,7 @@
 #include "../../src/util/color.cpp"
 #include "../../src/util/fade.cpp"
 #include "../../src/util/gradient.cpp"
+#include "../../src/util/gradient_cache.cpp"
 
 using namespace lamp;
 using namespace lamp::lioness;
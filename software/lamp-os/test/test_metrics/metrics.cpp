@@ -0,0 +1,204 @@
+// Native tests for the metrics registry: histogram bucketing and
+// percentiles, gauge windows, registration by name with the overflow sink,
+// and the binary snapshot the `metrics` BLE page section serves.
+
+#include <unity.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "../../src/util/metrics.cpp"
+
+using namespace lamp::metrics;
+
+void setUp() {}
+void tearDown() {}
+
+namespace {
+
+uint32_t readU32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+}  // namespace
+
+void test_histogram_buckets() {
+  TEST_ASSERT_EQUAL_size_t(0, Histogram::bucketFor(0));
+  TEST_ASSERT_EQUAL_size_t(7, Histogram::bucketFor(7));
+  TEST_ASSERT_EQUAL_size_t(8, Histogram::bucketFor(8));
+  TEST_ASSERT_EQUAL_size_t(8, Histogram::bucketFor(9));
+  TEST_ASSERT_EQUAL_size_t(9, Histogram::bucketFor(10));
+  TEST_ASSERT_EQUAL_size_t(12, Histogram::bucketFor(16));
+  TEST_ASSERT_EQUAL_UINT32(19, Histogram::bucketUpper(12));
+  TEST_ASSERT_EQUAL_size_t(Histogram::kBuckets - 1, Histogram::bucketFor(1u << 20));
+  TEST_ASSERT_EQUAL_size_t(Histogram::kBuckets - 1, Histogram::bucketFor(UINT32_MAX));
+
+  // Every value sits at or under its bucket's upper edge, above the
+  // previous bucket's, and within 25% of the edge.
+  for (uint32_t v = 0; v < (1u << 20); v += (v >> 4) + 1) {
+    const size_t b = Histogram::bucketFor(v);
+    TEST_ASSERT_TRUE(v <= Histogram::bucketUpper(b));
+    if (b > 0) TEST_ASSERT_TRUE(v > Histogram::bucketUpper(b - 1));
+    TEST_ASSERT_TRUE(Histogram::bucketUpper(b) - v <= v / 4 + 1);
+  }
+}
+
+void test_histogram_percentiles() {
+  Histogram h;
+  TEST_ASSERT_EQUAL_UINT32(0, h.percentile(99));
+  TEST_ASSERT_EQUAL_UINT32(0, h.min());
+
+  // 98 on-time 16 ms frames, two 40 ms stalls.
+  for (int i = 0; i < 98; i++) h.record(16000 + i);
+  h.record(40000);
+  h.record(41000);
+  TEST_ASSERT_EQUAL_UINT32(100, h.count());
+  TEST_ASSERT_EQUAL_UINT32(16000, h.min());
+  TEST_ASSERT_EQUAL_UINT32(41000, h.max());
+  const uint32_t p50 = h.percentile(50);
+  TEST_ASSERT_TRUE(p50 >= 16097 && p50 < 16000 * 5 / 4);
+  const uint32_t p99 = h.percentile(99);
+  TEST_ASSERT_TRUE(p99 >= 40000 && p99 <= 41000);
+  TEST_ASSERT_EQUAL_UINT32(41000, h.percentile(100));
+
+  h.resetWindow();
+  TEST_ASSERT_EQUAL_UINT32(0, h.count());
+  TEST_ASSERT_EQUAL_UINT32(0, h.max());
+  h.record(5);
+  TEST_ASSERT_EQUAL_UINT32(5, h.min());
+  TEST_ASSERT_EQUAL_UINT32(5, h.percentile(99));
+}
+
+void test_gauge_window() {
+  Gauge g;
+  g.set(200000);
+  g.set(150000);
+  g.set(180000);
+  TEST_ASSERT_EQUAL_INT32(180000, g.value());
+  TEST_ASSERT_EQUAL_INT32(150000, g.min());
+  TEST_ASSERT_EQUAL_INT32(200000, g.max());
+  g.resetWindow();
+  TEST_ASSERT_EQUAL_INT32(180000, g.min());
+  TEST_ASSERT_EQUAL_INT32(180000, g.max());
+  g.set(-4);
+  TEST_ASSERT_EQUAL_INT32(-4, g.min());
+}
+
+void test_registration_by_name_and_overflow() {
+  Registry reg;
+  Counter& a = reg.counter("mesh.rx");
+  TEST_ASSERT_EQUAL_PTR(&a, &reg.counter("mesh.rx"));
+  // Kinds have separate namespaces.
+  Gauge& g = reg.gauge("mesh.rx");
+  TEST_ASSERT_EQUAL_size_t(2, reg.size());
+  a.add();
+  a.add(4);
+  TEST_ASSERT_EQUAL_UINT32(5, reg.counter("mesh.rx").value());
+  g.set(1);
+
+  static const char* const kNames[] = {"c1", "c2", "c3", "c4", "c5", "c6",
+                                       "c7", "c8", "c9", "c10", "c11", "c12"};
+  for (const char* n : kNames) reg.counter(n);
+  TEST_ASSERT_EQUAL_size_t(Registry::kMaxCounters + 1, reg.size());
+  Counter& sink = reg.counter("c12");
+  TEST_ASSERT_EQUAL_PTR(&sink, &reg.counter("late"));
+  sink.add();  // absorbed, never reported
+  TEST_ASSERT_EQUAL_size_t(Registry::kMaxCounters + 1, reg.size());
+}
+
+void test_snapshot_layout() {
+  Registry reg;
+  reg.counter("mesh.relay").add(7);
+  Gauge& heap = reg.gauge("heap.free");
+  heap.set(90000);
+  heap.set(120000);
+  Histogram& frame = reg.histogram("frame.us");
+  frame.record(16000);
+  frame.record(17000);
+  reg.counter("a.very.long.metric.name").add();
+
+  uint8_t buf[Registry::kMaxSnapshotBytes];
+  const size_t n = reg.writeSnapshot(buf, sizeof(buf), 123456);
+  const size_t expected = 6 + (2 + 10 + 4) + (2 + 9 + 12) + (2 + 8 + 20) +
+                          (2 + kMaxNameLen + 4);
+  TEST_ASSERT_EQUAL_size_t(expected, n);
+
+  const uint8_t* p = buf;
+  TEST_ASSERT_EQUAL_UINT8(kSnapshotVersion, p[0]);
+  TEST_ASSERT_EQUAL_UINT8(4, p[1]);
+  TEST_ASSERT_EQUAL_UINT32(123456, readU32(p + 2));
+  p += 6;
+
+  TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(Kind::Counter), p[0]);
+  TEST_ASSERT_EQUAL_UINT8(10, p[1]);
+  TEST_ASSERT_EQUAL_MEMORY("mesh.relay", p + 2, 10);
+  TEST_ASSERT_EQUAL_UINT32(7, readU32(p + 12));
+  p += 16;
+
+  TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(Kind::Gauge), p[0]);
+  TEST_ASSERT_EQUAL_MEMORY("heap.free", p + 2, 9);
+  TEST_ASSERT_EQUAL_UINT32(120000, readU32(p + 11));
+  TEST_ASSERT_EQUAL_UINT32(90000, readU32(p + 15));
+  TEST_ASSERT_EQUAL_UINT32(120000, readU32(p + 19));
+  p += 23;
+
+  TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(Kind::Histogram), p[0]);
+  TEST_ASSERT_EQUAL_MEMORY("frame.us", p + 2, 8);
+  TEST_ASSERT_EQUAL_UINT32(2, readU32(p + 10));
+  TEST_ASSERT_EQUAL_UINT32(16000, readU32(p + 14));
+  TEST_ASSERT_EQUAL_UINT32(frame.percentile(50), readU32(p + 18));
+  TEST_ASSERT_EQUAL_UINT32(17000, readU32(p + 22));
+  TEST_ASSERT_EQUAL_UINT32(17000, readU32(p + 26));
+  p += 30;
+
+  // Names past kMaxNameLen are truncated on the wire.
+  TEST_ASSERT_EQUAL_UINT8(kMaxNameLen, p[1]);
+  TEST_ASSERT_EQUAL_MEMORY("a.very.long.met", p + 2, kMaxNameLen);
+
+  // Too small a buffer writes nothing usable.
+  TEST_ASSERT_EQUAL_size_t(0, reg.writeSnapshot(buf, n - 1, 0));
+
+  // The advertised bound holds with every slot taken by a max-length name.
+  Registry full;
+  static char names[Registry::kMaxEntries][kMaxNameLen + 1];
+  size_t k = 0;
+  for (size_t i = 0; i < Registry::kMaxCounters; i++, k++) {
+    snprintf(names[k], sizeof(names[k]), "counter.%07u", (unsigned)i);
+    full.counter(names[k]);
+  }
+  for (size_t i = 0; i < Registry::kMaxGauges; i++, k++) {
+    snprintf(names[k], sizeof(names[k]), "gauge.%09u", (unsigned)i);
+    full.gauge(names[k]);
+  }
+  for (size_t i = 0; i < Registry::kMaxHistograms; i++, k++) {
+    snprintf(names[k], sizeof(names[k]), "histogram.%05u", (unsigned)i);
+    full.histogram(names[k]);
+  }
+  TEST_ASSERT_EQUAL_size_t(Registry::kMaxSnapshotBytes,
+                           full.writeSnapshot(buf, sizeof(buf), 0));
+}
+
+void test_reset_window_keeps_counters() {
+  Registry reg;
+  reg.counter("frame.drop").add(3);
+  reg.histogram("drain.us").record(900);
+  reg.gauge("stack.free").set(1200);
+  reg.gauge("stack.free").set(800);
+  reg.resetWindow();
+  TEST_ASSERT_EQUAL_UINT32(3, reg.counter("frame.drop").value());
+  TEST_ASSERT_EQUAL_UINT32(0, reg.histogram("drain.us").count());
+  TEST_ASSERT_EQUAL_INT32(800, reg.gauge("stack.free").max());
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_histogram_buckets);
+  RUN_TEST(test_histogram_percentiles);
+  RUN_TEST(test_gauge_window);
+  RUN_TEST(test_registration_by_name_and_overflow);
+  RUN_TEST(test_snapshot_layout);
+  RUN_TEST(test_reset_window_keeps_counters);
+  return UNITY_END();
+}
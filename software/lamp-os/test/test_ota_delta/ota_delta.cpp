@@ -0,0 +1,415 @@
+// Native tests for delta OTA patches (ota_delta.hpp): the trailer codec and
+// its check against the OFFER, the decoder against a patch written by
+// scripts/make_firmware_delta.py, a synthetic point release rebuilt through
+// the same reader/writer shape the receiver uses on flash, the decoder's
+// bounds checks, and the slot layout that keeps a patch and its image apart
+// in one OTA slot.
+//
+// The release is a pseudo-random 1.5 MB "image" with relinked words spread
+// through it plus an inserted and a removed run, encoded by a port of the
+// script's greedy matcher; the run prints the patch/image ratio.
+
+#include <unity.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "../../src/components/firmware/ota_delta.cpp"
+
+namespace lp = lamp_protocol;
+namespace delta = lamp::ota_delta;
+
+void setUp() {}
+void tearDown() {}
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+// xorshift32; fixed seeds keep every run deterministic.
+struct Rng {
+  uint32_t s;
+  uint32_t next() {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+  }
+};
+
+void putVarint(Bytes& out, uint32_t v) {
+  while (v >= 0x80) {
+    out.push_back(static_cast<uint8_t>(v | 0x80));
+    v >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(v));
+}
+
+void putRecord(Bytes& ops, int64_t seek, uint32_t copyLen, const uint8_t* add,
+               uint32_t addLen) {
+  putVarint(ops, static_cast<uint32_t>(seek >= 0 ? seek << 1 : ((-seek) << 1) - 1));
+  putVarint(ops, copyLen);
+  putVarint(ops, addLen);
+  ops.insert(ops.end(), add, add + addLen);
+}
+
+size_t matchLen(const Bytes& base, size_t q, const Bytes& img, size_t p) {
+  size_t n = 0;
+  while (q + n < base.size() && p + n < img.size() && base[q + n] == img[p + n]) ++n;
+  return n;
+}
+
+// Port of make_firmware_delta.py's build_ops: resume at the base cursor, else
+// a 16-byte anchor indexed every 4 base bytes; matches grow back over pending
+// literals.
+Bytes encode(const Bytes& base, const Bytes& img) {
+  constexpr size_t kAnchor = 16, kStride = 4, kResume = 8;
+  const auto key = [](const uint8_t* p) {
+    uint64_t a, b;
+    std::memcpy(&a, p, 8);
+    std::memcpy(&b, p + 8, 8);
+    return a * 0x9E3779B97F4A7C15ull ^ b;
+  };
+  std::unordered_map<uint64_t, size_t> index;
+  for (size_t q = 0; q + kAnchor <= base.size(); q += kStride) {
+    index.emplace(key(&base[q]), q);
+  }
+  Bytes ops;
+  size_t cursor = 0, litStart = 0, p = 0;
+  bool pending = false;
+  int64_t pendSeek = 0;
+  uint32_t pendCopy = 0;
+  while (p < img.size()) {
+    size_t q = cursor + (p - litStart);
+    size_t len = q < base.size() ? matchLen(base, q, img, p) : 0;
+    if (len < kResume) {
+      len = 0;
+      if (p + kAnchor <= img.size()) {
+        auto it = index.find(key(&img[p]));
+        if (it != index.end()) {
+          q = it->second;
+          len = matchLen(base, q, img, p);
+        }
+      }
+      if (len < kAnchor) {
+        ++p;
+        continue;
+      }
+    }
+    size_t back = 0;
+    while (p - back > litStart && q - back > 0 && img[p - back - 1] == base[q - back - 1]) ++back;
+    const size_t startImg = p - back, startBase = q - back;
+    len += back;
+    if (!pending && startImg > 0) pending = true;  // leading literals: copy 0
+    if (pending) {
+      putRecord(ops, pendSeek, pendCopy, img.data() + litStart,
+                static_cast<uint32_t>(startImg - litStart));
+    }
+    pending  = true;
+    pendSeek = static_cast<int64_t>(startBase) - static_cast<int64_t>(cursor);
+    pendCopy = static_cast<uint32_t>(len);
+    cursor   = startBase + len;
+    litStart = p = startImg + len;
+  }
+  putRecord(ops, pending ? pendSeek : 0, pending ? pendCopy : 0,
+            img.data() + litStart, static_cast<uint32_t>(img.size() - litStart));
+  return ops;
+}
+
+int st(delta::ApplyStatus s) { return static_cast<int>(s); }
+
+// Flash-shaped endpoints: byte readers over vectors and an image writer that
+// records whether writes ever went backwards or past the image.
+struct Rebuild {
+  const Bytes& base;
+  const Bytes& ops;
+  Bytes image;
+  bool ordered = true;
+  size_t writes = 0;
+  bool failRead = false;
+  size_t failWriteAt = SIZE_MAX;
+
+  Rebuild(const Bytes& b, const Bytes& o, size_t imageLen)
+      : base(b), ops(o), image(imageLen, 0xFF) {}
+
+  delta::ApplyStatus run(const delta::Trailer& t) {
+    size_t next = 0;
+    const lamp::firmware::FirmwareByteReader readBase =
+        [this](size_t off, size_t want, uint8_t* out) -> int {
+      if (failRead || off + want > base.size()) return -1;
+      std::memcpy(out, base.data() + off, want);
+      return static_cast<int>(want);
+    };
+    const lamp::firmware::FirmwareByteReader readOps =
+        [this](size_t off, size_t want, uint8_t* out) -> int {
+      if (off + want > ops.size()) return -1;
+      std::memcpy(out, ops.data() + off, want);
+      return static_cast<int>(want);
+    };
+    const delta::ImageWriter write = [this, &next](size_t off, const uint8_t* data,
+                                                   size_t len) -> bool {
+      if (writes++ == failWriteAt) return false;
+      if (off != next || off + len > image.size()) {
+        ordered = false;
+        return false;
+      }
+      std::memcpy(image.data() + off, data, len);
+      next = off + len;
+      return true;
+    };
+    return delta::apply(t, readBase, readOps, write);
+  }
+};
+
+delta::Trailer trailerFor(const Bytes& base, const Bytes& img, const Bytes& ops) {
+  delta::Trailer t;
+  t.baseVersion  = 0x010200;
+  t.baseLen      = static_cast<uint32_t>(base.size());
+  t.imageVersion = 0x010201;
+  t.imageLen     = static_cast<uint32_t>(img.size());
+  t.opsLen       = static_cast<uint32_t>(ops.size());
+  return t;
+}
+
+}  // namespace
+
+void test_trailer_round_trip() {
+  delta::Trailer t;
+  t.baseVersion  = 0x010203;
+  t.baseLen      = 1499904;
+  t.imageVersion = 0x010204;
+  t.imageLen     = 1500096;
+  t.opsLen       = 23456;
+  for (size_t i = 0; i < sizeof(t.baseId); ++i) t.baseId[i] = static_cast<uint8_t>(i + 1);
+  for (size_t i = 0; i < sizeof(t.imageDigest); ++i) t.imageDigest[i] = static_cast<uint8_t>(0xA0 + i);
+  uint8_t raw[delta::kTrailerLen];
+  delta::writeTrailer(t, raw);
+  TEST_ASSERT_EQUAL_MEMORY("LDLT", raw, 4);
+
+  delta::Trailer back;
+  TEST_ASSERT_TRUE(delta::parseTrailer(raw, sizeof(raw), back));
+  TEST_ASSERT_EQUAL_UINT32(t.baseVersion, back.baseVersion);
+  TEST_ASSERT_EQUAL_UINT32(t.baseLen, back.baseLen);
+  TEST_ASSERT_EQUAL_UINT32(t.imageVersion, back.imageVersion);
+  TEST_ASSERT_EQUAL_UINT32(t.imageLen, back.imageLen);
+  TEST_ASSERT_EQUAL_UINT32(t.opsLen, back.opsLen);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(t.baseId, back.baseId, sizeof(t.baseId));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(t.imageDigest, back.imageDigest, sizeof(t.imageDigest));
+
+  TEST_ASSERT_FALSE(delta::parseTrailer(raw, sizeof(raw) - 1, back));
+  raw[4] = delta::kFormat + 1;
+  TEST_ASSERT_FALSE(delta::parseTrailer(raw, sizeof(raw), back));
+  raw[4] = delta::kFormat;
+  raw[0] = 'X';
+  TEST_ASSERT_FALSE(delta::parseTrailer(raw, sizeof(raw), back));
+  // An erased slot tail (all 0xFF) is no trailer.
+  std::memset(raw, 0xFF, sizeof(raw));
+  TEST_ASSERT_FALSE(delta::parseTrailer(raw, sizeof(raw), back));
+}
+
+// The receiver checks the streamed trailer against the delta OFFER before it
+// rebuilds; any field that disagrees fails the session (DeltaApplyFail).
+void test_trailer_matches_offer() {
+  delta::Trailer t;
+  t.baseLen      = 1499904;
+  t.imageVersion = 0x010204;
+  t.imageLen     = 1500096;
+  t.opsLen       = 23456;
+  for (size_t i = 0; i < sizeof(t.baseId); ++i) t.baseId[i] = static_cast<uint8_t>(i + 1);
+  for (size_t i = 0; i < sizeof(t.imageDigest); ++i) t.imageDigest[i] = static_cast<uint8_t>(0xA0 + i);
+  const uint32_t patchLen = t.opsLen + delta::kTrailerLen;
+  uint8_t baseId[sizeof(t.baseId)];
+  uint8_t digest[sizeof(t.imageDigest)];
+  std::memcpy(baseId, t.baseId, sizeof(baseId));
+  std::memcpy(digest, t.imageDigest, sizeof(digest));
+  const auto matches = [&](uint32_t patch, uint32_t imageLen, uint32_t version,
+                           uint32_t baseLen) {
+    return delta::trailerMatchesOffer(t, patch, imageLen, version, digest,
+                                      baseLen, baseId);
+  };
+  TEST_ASSERT_TRUE(matches(patchLen, t.imageLen, t.imageVersion, t.baseLen));
+  TEST_ASSERT_FALSE(matches(patchLen + 1, t.imageLen, t.imageVersion, t.baseLen));
+  TEST_ASSERT_FALSE(matches(delta::kTrailerLen, t.imageLen, t.imageVersion, t.baseLen));
+  TEST_ASSERT_FALSE(matches(patchLen, t.imageLen - 1, t.imageVersion, t.baseLen));
+  TEST_ASSERT_FALSE(matches(patchLen, t.imageLen, t.imageVersion + 1, t.baseLen));
+  TEST_ASSERT_FALSE(matches(patchLen, t.imageLen, t.imageVersion, t.baseLen + 4096));
+  baseId[5] ^= 0x01;
+  TEST_ASSERT_FALSE(matches(patchLen, t.imageLen, t.imageVersion, t.baseLen));
+  baseId[5] ^= 0x01;
+  digest[31] ^= 0x80;
+  TEST_ASSERT_FALSE(matches(patchLen, t.imageLen, t.imageVersion, t.baseLen));
+}
+
+// Ops written by scripts/make_firmware_delta.py (build_ops) for a 96-byte
+// base with a relinked word, an inserted run and a removed one; pins the
+// format between the script and the decoder.
+void test_apply_script_fixture() {
+  Bytes base(96);
+  for (size_t i = 0; i < base.size(); ++i) base[i] = static_cast<uint8_t>(i * 37 + 11);
+  Bytes img = base;
+  const uint8_t word[4] = {0xDE, 0xAD, 0xBE, 0xEF};
+  std::memcpy(&img[20], word, 4);
+  img.insert(img.begin() + 60, {'N', 'E', 'W', '!'});
+  img.erase(img.begin() + 80, img.begin() + 88);
+  const Bytes ops = {0x00, 0x14, 0x04, 0xde, 0xad, 0xbe, 0xef, 0x08, 0x24, 0x04,
+                     0x4e, 0x45, 0x57, 0x21, 0x00, 0x10, 0x0c, 0x2f, 0x54, 0x79,
+                     0x9e, 0xc3, 0xe8, 0x0d, 0x32, 0x57, 0x7c, 0xa1, 0xc6};
+  Rebuild r(base, ops, img.size());
+  TEST_ASSERT_EQUAL_INT(st(delta::ApplyStatus::Ok), st(r.run(trailerFor(base, img, ops))));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(img.data(), r.image.data(), img.size());
+  // The C++ port of the matcher agrees byte for byte.
+  const Bytes ported = encode(base, img);
+  TEST_ASSERT_EQUAL_UINT32(ops.size(), ported.size());
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(ops.data(), ported.data(), ops.size());
+}
+
+void test_apply_synthetic_release() {
+  Rng rng{0x5EED1234u};
+  Bytes base(1500000);
+  for (auto& b : base) b = static_cast<uint8_t>(rng.next());
+  Bytes img = base;
+  for (int i = 0; i < 2000; ++i) {  // relinked addresses
+    const size_t at = rng.next() % (img.size() - 4);
+    for (size_t k = 0; k < 4; ++k) img[at + k] = static_cast<uint8_t>(rng.next());
+  }
+  Bytes added(3000);
+  for (auto& b : added) b = static_cast<uint8_t>(rng.next());
+  img.insert(img.begin() + 700000, added.begin(), added.end());
+  img.erase(img.begin() + 1200000, img.begin() + 1201000);
+
+  const Bytes ops = encode(base, img);
+  Rebuild r(base, ops, img.size());
+  TEST_ASSERT_EQUAL_INT(st(delta::ApplyStatus::Ok), st(r.run(trailerFor(base, img, ops))));
+  TEST_ASSERT_TRUE(r.ordered);
+  TEST_ASSERT_TRUE(r.image == img);
+  const size_t patchLen = ops.size() + delta::kTrailerLen;
+  std::printf("delta: %zu-byte patch rebuilds %zu-byte image (%.2f%%), "
+              "%zu flash writes\n",
+              patchLen, img.size(), 100.0 * patchLen / img.size(), r.writes);
+  // Eight bytes a relink, the inserted run, a record per edit: well under 5%.
+  TEST_ASSERT_TRUE(patchLen < img.size() / 20);
+}
+
+void test_apply_rejects_bad_records() {
+  Bytes base(64);
+  for (size_t i = 0; i < base.size(); ++i) base[i] = static_cast<uint8_t>(i);
+  const uint8_t lit[4] = {1, 2, 3, 4};
+  struct Case {
+    const char* what;
+    Bytes ops;
+    uint32_t imageLen;
+    delta::ApplyStatus want;
+  };
+  std::vector<Case> cases;
+  auto ops = [&](std::initializer_list<std::tuple<int64_t, uint32_t, uint32_t>> recs) {
+    Bytes o;
+    for (const auto& [seek, copy, add] : recs) {
+      Bytes a(add, 0x55);
+      putRecord(o, seek, copy, a.data(), add);
+    }
+    return o;
+  };
+  cases.push_back({"copy past the base", ops({{32, 40, 0}}), 40, delta::ApplyStatus::Corrupt});
+  cases.push_back({"seek before the base", ops({{-1, 4, 0}}), 4, delta::ApplyStatus::Corrupt});
+  cases.push_back({"seek past the base", ops({{65, 0, 4}}), 4, delta::ApplyStatus::Corrupt});
+  cases.push_back({"empty record", ops({{0, 0, 0}, {0, 4, 0}}), 4, delta::ApplyStatus::Corrupt});
+  cases.push_back({"copy past the image", ops({{0, 8, 0}}), 4, delta::ApplyStatus::Corrupt});
+  cases.push_back({"literals past the image", ops({{0, 2, 4}}), 4, delta::ApplyStatus::Corrupt});
+  cases.push_back({"ops left over", ops({{0, 4, 0}, {0, 4, 0}}), 4, delta::ApplyStatus::Corrupt});
+  cases.push_back({"ops end early", ops({{0, 4, 0}}), 8, delta::ApplyStatus::Corrupt});
+  {
+    Bytes o = ops({{0, 0, 4}});
+    o.pop_back();  // literals cut short
+    cases.push_back({"short literals", o, 4, delta::ApplyStatus::Corrupt});
+  }
+  cases.push_back({"varint over 32 bits",
+                   Bytes{0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0x00}, 4,
+                   delta::ApplyStatus::Corrupt});
+  // A valid one for contrast: copy, seek back, copy again, literals.
+  {
+    Bytes o;
+    putRecord(o, 8, 4, nullptr, 0);
+    putRecord(o, -12, 4, lit, 4);
+    cases.push_back({"valid", o, 12, delta::ApplyStatus::Ok});
+  }
+  for (const Case& c : cases) {
+    delta::Trailer t;
+    t.baseLen  = static_cast<uint32_t>(base.size());
+    t.imageLen = c.imageLen;
+    t.opsLen   = static_cast<uint32_t>(c.ops.size());
+    Rebuild r(base, c.ops, c.imageLen);
+    TEST_ASSERT_TRUE_MESSAGE(st(r.run(t)) == st(c.want), c.what);
+    TEST_ASSERT_TRUE_MESSAGE(r.ordered, c.what);
+  }
+  {
+    Bytes o;
+    putRecord(o, 8, 4, nullptr, 0);
+    putRecord(o, -12, 4, lit, 4);
+    Rebuild r(base, o, 12);
+    delta::Trailer t;
+    t.baseLen = 64;
+    t.imageLen = 12;
+    t.opsLen = static_cast<uint32_t>(o.size());
+    r.run(t);
+    const uint8_t want[12] = {8, 9, 10, 11, 0, 1, 2, 3, 1, 2, 3, 4};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(want, r.image.data(), 12);
+  }
+}
+
+void test_apply_surfaces_io_failures() {
+  Rng rng{0xC0FFEEu};
+  Bytes base(8192);
+  for (auto& b : base) b = static_cast<uint8_t>(rng.next());
+  Bytes img = base;
+  img[4000] ^= 0xFF;
+  const Bytes ops = encode(base, img);
+  const delta::Trailer t = trailerFor(base, img, ops);
+
+  Rebuild readFail(base, ops, img.size());
+  readFail.failRead = true;
+  TEST_ASSERT_EQUAL_INT(st(delta::ApplyStatus::ReadFail), st(readFail.run(t)));
+
+  Rebuild writeFail(base, ops, img.size());
+  writeFail.failWriteAt = 3;
+  TEST_ASSERT_EQUAL_INT(st(delta::ApplyStatus::WriteFail), st(writeFail.run(t)));
+
+  // Ops shorter than the trailer claims read as a failed flash read.
+  Bytes cut(ops.begin(), ops.end() - 1);
+  Rebuild opsShort(base, cut, img.size());
+  TEST_ASSERT_EQUAL_INT(st(delta::ApplyStatus::ReadFail), st(opsShort.run(t)));
+}
+
+void test_slot_layout() {
+  constexpr uint32_t kSlot = 0x1E0000, kSector = 4096;
+  uint32_t at = 0;
+  // A 1.5 MB image and a 20 KB patch share the slot.
+  TEST_ASSERT_TRUE(delta::slotLayout(kSlot, 1500096, 20000, kSector, at));
+  TEST_ASSERT_EQUAL_UINT32(kSlot - 20000, at);
+  // The image's last sector may end exactly where the patch's first begins.
+  const uint32_t patch = 4096 * 2 + 100;  // starts mid-sector
+  const uint32_t floor = (kSlot - patch) / kSector * kSector;
+  TEST_ASSERT_TRUE(delta::slotLayout(kSlot, floor, patch, kSector, at));
+  TEST_ASSERT_FALSE(delta::slotLayout(kSlot, floor + 1, patch, kSector, at));
+  // Nothing that can't fit, and no empty parts.
+  TEST_ASSERT_FALSE(delta::slotLayout(kSlot, 1500096, kSlot + 1, kSector, at));
+  TEST_ASSERT_FALSE(delta::slotLayout(kSlot, 1900000, 100000, kSector, at));
+  TEST_ASSERT_FALSE(delta::slotLayout(kSlot, 0, 100, kSector, at));
+  TEST_ASSERT_FALSE(delta::slotLayout(kSlot, 100, 0, kSector, at));
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_trailer_round_trip);
+  RUN_TEST(test_trailer_matches_offer);
+  RUN_TEST(test_apply_script_fixture);
+  RUN_TEST(test_apply_synthetic_release);
+  RUN_TEST(test_apply_rejects_bad_records);
+  RUN_TEST(test_apply_surfaces_io_failures);
+  RUN_TEST(test_slot_layout);
+  return UNITY_END();
+}
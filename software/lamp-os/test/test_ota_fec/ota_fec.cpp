@@ -0,0 +1,433 @@
+// Native tests for the mesh OTA window erasure code (MSG_FW_REPAIR): the
+// GF(2^8) Cauchy coder, the receiver's repair-slot pool, the frame codec, and
+// a lossy-link simulation that runs one session end to end with and without
+// repair rows and compares REQ round trips, frames on air and wall time.
+//
+// The session model extends the shared one in test/ota_sim/session_model.hpp
+// with the distributor's per-window repair emission and FirmwareReceiver's
+// repair decode. Real image bytes flow through the production ota_fec.cpp
+// encode and decode, so the run also checks that every rebuilt chunk matches
+// the source.
+
+#include <unity.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "components/network/protocol/lamp_protocol.hpp"
+#include "../../src/components/firmware/ota_fec.cpp"
+#include "../../src/components/firmware/req_holes.cpp"
+#include "../ota_sim/session_model.hpp"
+
+namespace lp = lamp_protocol;
+namespace fec = lamp::ota_fec;
+using ota_sim::kReceiver;
+using ota_sim::kSender;
+using ota_sim::Rng;
+using ota_sim::SessionStats;
+
+void setUp() {}
+void tearDown() {}
+
+namespace {
+
+constexpr uint8_t kWindow = lp::FW_FEC_WINDOW_CHUNKS;
+
+std::vector<uint8_t> makeImage(size_t len, uint32_t seed) {
+  Rng rng{seed};
+  std::vector<uint8_t> img(len);
+  for (auto& b : img) b = static_cast<uint8_t>(rng.next());
+  return img;
+}
+
+// Repair rows for one window of `img`, encoded the distributor's way.
+std::vector<std::vector<uint8_t>> encodeWindow(const std::vector<uint8_t>& img,
+                                               uint16_t chunkSize,
+                                               uint16_t windowStart, uint8_t stride,
+                                               const std::vector<uint8_t>& rows) {
+  const size_t total = (img.size() + chunkSize - 1) / chunkSize;
+  const uint8_t n = fec::windowLen(windowStart, stride, total);
+  const size_t base = static_cast<size_t>(windowStart) * chunkSize;
+  const size_t len = std::min<size_t>(chunkSize, img.size() - base);
+  std::vector<std::vector<uint8_t>> out;
+  for (uint8_t row : rows) {
+    std::vector<uint8_t> acc(len, 0);
+    for (uint8_t c = 0; c < n; ++c) {
+      const size_t off = base + static_cast<size_t>(c) * stride * chunkSize;
+      const size_t clen = std::min<size_t>(chunkSize, img.size() - off);
+      fec::accumulate(acc.data(), len, row, c, &img[off], clen);
+    }
+    out.push_back(acc);
+  }
+  return out;
+}
+
+constexpr uint16_t kSimChunk = 64;
+
+// Distributor: the shared cursor model plus the repair encoder. Rows
+// accumulate over each block's first forward pass (stride interleaved
+// windows; the distributor re-reads them from flash instead, same bytes) and
+// go out behind its last chunk, ahead of the next block.
+struct Sender : ota_sim::Sender {
+  const std::vector<uint8_t>& img;
+  uint8_t  rowsPerWindow;
+  uint8_t  stride;
+  uint16_t fecNext = 0;
+  uint16_t fecBlock = 0;
+  uint8_t  fecLanes = 0;
+  uint8_t  rowsDue = 0;
+  uint8_t  rowsSent = 0;
+  std::vector<std::vector<uint8_t>> acc;  // [lane * rowsPerWindow + row]
+
+  Sender(const std::vector<uint8_t>& image, uint16_t n, uint8_t rows, uint8_t d)
+      : ota_sim::Sender(n), img(image), rowsPerWindow(rows), stride(d),
+        acc(static_cast<size_t>(rows) * d, std::vector<uint8_t>(kSimChunk, 0)) {}
+
+  uint16_t blockChunks() const { return static_cast<uint16_t>(kWindow * stride); }
+
+  size_t chunkLen(uint16_t idx) const {
+    const size_t off = static_cast<size_t>(idx) * kSimChunk;
+    return std::min<size_t>(kSimChunk, img.size() - off);
+  }
+
+  void sent(uint16_t chunkIdx) {
+    if (rowsPerWindow != 0 && chunkIdx == fecNext) {
+      const uint16_t pos = chunkIdx % blockChunks();
+      const uint8_t lane = static_cast<uint8_t>(pos % stride);
+      const uint8_t col = static_cast<uint8_t>(pos / stride);
+      if (pos == 0) {
+        for (auto& a : acc) std::fill(a.begin(), a.end(), 0);
+      }
+      const size_t off = static_cast<size_t>(chunkIdx) * kSimChunk;
+      for (uint8_t r = 0; r < rowsPerWindow; ++r) {
+        fec::accumulate(acc[lane * rowsPerWindow + r].data(), kSimChunk, r, col,
+                        &img[off], chunkLen(chunkIdx));
+      }
+      ++fecNext;
+      if (fecNext % blockChunks() == 0 || fecNext == total) {
+        fecBlock = static_cast<uint16_t>(chunkIdx - pos);
+        fecLanes = static_cast<uint8_t>(std::min<size_t>(stride, total - fecBlock));
+        rowsDue = static_cast<uint8_t>(fecLanes * rowsPerWindow);
+        rowsSent = 0;
+      }
+    }
+    ota_sim::Sender::sent(chunkIdx);
+  }
+
+  bool repairDue() const { return rowsDue != 0; }
+
+  // Serialises the next due repair row, one row of every lane before the
+  // next row, so a burst here also spreads across windows.
+  size_t buildRepair(uint8_t* buf, size_t cap, uint16_t seq) {
+    const uint8_t row = static_cast<uint8_t>(rowsSent / fecLanes);
+    const uint8_t lane = static_cast<uint8_t>(rowsSent % fecLanes);
+    const uint16_t window = static_cast<uint16_t>(fecBlock + lane);
+    const uint16_t len = static_cast<uint16_t>(chunkLen(window));
+    ++rowsSent;
+    --rowsDue;
+    return lp::buildFwRepair(buf, cap, seq, kSender, kReceiver, window,
+                             fec::windowLen(window, stride, total), stride, row,
+                             acc[lane * rowsPerWindow + row].data(), len);
+  }
+};
+
+// Receiver: the shared bitmap and REQ triggers, plus the image bytes and
+// FirmwareReceiver's repair pool.
+struct Receiver : ota_sim::Receiver {
+  const std::vector<uint8_t>* src;  // what the chunks on air carry
+  std::vector<uint8_t> image;
+  std::vector<uint8_t> slotBuf;
+  fec::RepairPool pool;
+  uint32_t rebuilt = 0;
+
+  Receiver(const std::vector<uint8_t>& source, size_t n, bool mask)
+      : ota_sim::Receiver(n, mask), src(&source), image(source.size(), 0xFF),
+        slotBuf(fec::RepairPool::kSlots * kSimChunk) {}
+
+  size_t chunkLen(size_t idx) const {
+    return std::min<size_t>(kSimChunk, image.size() - idx * kSimChunk);
+  }
+
+  bool writeChunk(uint16_t idx, const uint8_t* bytes, size_t len, uint32_t nowMs) {
+    std::memcpy(&image[static_cast<size_t>(idx) * kSimChunk], bytes, len);
+    return mark(idx, nowMs);
+  }
+
+  bool onChunk(uint16_t idx, uint32_t nowMs) {
+    return writeChunk(idx, &(*src)[static_cast<size_t>(idx) * kSimChunk],
+                      chunkLen(idx), nowMs);
+  }
+
+  void onRepair(const uint8_t* buf, size_t n) {
+    lp::ParsedFwRepair r;
+    TEST_ASSERT_TRUE(lp::parseFwRepair(buf, n, r));
+    uint8_t cols[kWindow];
+    if (fec::windowMissing(bitmap.data(), bitmap.size(), total, r.windowStart,
+                           r.stride, cols) == 0) {
+      return;
+    }
+    const int slot = pool.claim(r.windowStart, r.stride, r.row);
+    if (slot < 0) return;
+    std::memcpy(&slotBuf[static_cast<size_t>(slot) * kSimChunk], r.bytes, r.len);
+  }
+
+  // One decode per millisecond, as FirmwareReceiver::tick does.
+  void tick(uint32_t nowMs) { decodeOne(nowMs); }
+  // onDoneOnLoop rebuilds whatever it can before judging the bitmap.
+  void onDone(uint32_t nowMs) {
+    while (decodeOne(nowMs)) {}
+  }
+
+  bool decodeOne(uint32_t nowMs) {
+    fec::DecodePlan p;
+    if (!pool.plan(bitmap.data(), bitmap.size(), total, p)) return false;
+    const size_t len = chunkLen(p.windowStart);
+    uint8_t* rep[fec::RepairPool::kSlots];
+    for (uint8_t k = 0; k < p.m; ++k) rep[k] = &slotBuf[p.slot[k] * kSimChunk];
+    uint8_t k = 0;
+    for (uint8_t c = 0; c < p.windowLen; ++c) {
+      if (k < p.m && p.col[k] == c) {
+        ++k;
+        continue;
+      }
+      const size_t idx = p.windowStart + static_cast<size_t>(c) * p.stride;
+      fec::eliminate(rep, p.row, p.m, len, c, &image[idx * kSimChunk], chunkLen(idx));
+    }
+    TEST_ASSERT_TRUE(fec::solve(rep, p.row, p.col, p.m, len));
+    for (uint8_t j = 0; j < p.m; ++j) {
+      const uint16_t idx = static_cast<uint16_t>(p.windowStart + p.col[j] * p.stride);
+      writeChunk(idx, rep[j], chunkLen(idx), nowMs);
+      rebuilt++;
+    }
+    pool.release(p);
+    return true;
+  }
+};
+
+SessionStats runSession(bool useMask, uint8_t rowsPerWindow, uint8_t stride,
+                        uint32_t spacingMs, uint32_t seed,
+                        uint16_t totalChunks = 2000) {
+  // Short last chunk, so the tail window's padding is exercised.
+  const size_t imageLen = static_cast<size_t>(totalChunks) * kSimChunk - 23;
+  const std::vector<uint8_t> img = makeImage(imageLen, seed ^ 0x5EEDu);
+  Sender tx(img, totalChunks, rowsPerWindow, stride);
+  Receiver rx(img, totalChunks, useMask);
+  SessionStats st = ota_sim::runOne(tx, rx, seed, spacingMs);
+  st.intact = rx.image == img;
+  st.rebuilt = rx.rebuilt;
+  return st;
+}
+
+}  // namespace
+
+void test_coefficients_are_cauchy() {
+  // Non-zero everywhere, and distinct along a row and down a column.
+  for (uint16_t row = 0; row < lp::FW_FEC_MAX_ROWS; ++row) {
+    for (uint8_t c = 0; c < kWindow; ++c) {
+      const uint8_t v = fec::coefficient(static_cast<uint8_t>(row), c);
+      TEST_ASSERT_NOT_EQUAL(0, v);
+      for (uint8_t d = c + 1; d < kWindow; ++d) {
+        TEST_ASSERT_NOT_EQUAL(v, fec::coefficient(static_cast<uint8_t>(row), d));
+      }
+    }
+  }
+  TEST_ASSERT_NOT_EQUAL(fec::coefficient(0, 3), fec::coefficient(1, 3));
+}
+
+// Every loss pattern the held rows can cover rebuilds byte-exact, whichever
+// rows survived.
+void test_any_m_rows_rebuild_any_m_chunks() {
+  const uint16_t chunkSize = 40;
+  const std::vector<uint8_t> img = makeImage(3 * kWindow * chunkSize - 17, 7);
+  const size_t total = (img.size() + chunkSize - 1) / chunkSize;
+  Rng rng{99};
+  for (int trial = 0; trial < 200; ++trial) {
+    const uint16_t w = static_cast<uint16_t>((trial % 3) * kWindow);
+    const uint8_t n = fec::windowLen(w, 1, total);
+    const uint8_t m = static_cast<uint8_t>(1 + rng.next() % (n < 6 ? n : 6));
+    // m distinct lost columns and m distinct rows out of the first 40.
+    std::vector<uint8_t> cols, rows;
+    while (cols.size() < m) {
+      const uint8_t c = static_cast<uint8_t>(rng.next() % n);
+      if (std::find(cols.begin(), cols.end(), c) == cols.end()) cols.push_back(c);
+    }
+    std::sort(cols.begin(), cols.end());
+    while (rows.size() < m) {
+      const uint8_t r = static_cast<uint8_t>(rng.next() % 40);
+      if (std::find(rows.begin(), rows.end(), r) == rows.end()) rows.push_back(r);
+    }
+    auto rep = encodeWindow(img, chunkSize, w, 1, rows);
+    const size_t len = rep[0].size();
+    std::vector<uint8_t*> ptrs;
+    for (auto& r : rep) ptrs.push_back(r.data());
+    for (uint8_t c = 0; c < n; ++c) {
+      if (std::find(cols.begin(), cols.end(), c) != cols.end()) continue;
+      const size_t off = (w + c) * chunkSize;
+      fec::eliminate(ptrs.data(), rows.data(), m, len, c, &img[off],
+                     std::min<size_t>(chunkSize, img.size() - off));
+    }
+    TEST_ASSERT_TRUE(fec::solve(ptrs.data(), rows.data(), cols.data(), m, len));
+    for (uint8_t k = 0; k < m; ++k) {
+      const size_t off = (w + cols[k]) * chunkSize;
+      const size_t clen = std::min<size_t>(chunkSize, img.size() - off);
+      TEST_ASSERT_EQUAL_UINT8_ARRAY(&img[off], ptrs[k], clen);
+    }
+  }
+  // A repeated row carries no new information.
+  uint8_t a[4] = {0}, b[4] = {0};
+  uint8_t* p[2] = {a, b};
+  const uint8_t rows[2] = {5, 5};
+  const uint8_t cols[2] = {0, 1};
+  TEST_ASSERT_FALSE(fec::solve(p, rows, cols, 2, sizeof(a)));
+}
+
+void test_repair_pool_plans_and_evicts() {
+  fec::RepairPool pool;
+  const size_t total = 40;  // windows at 0, 16 and a short one at 32
+  std::vector<uint8_t> bitmap((total + 7) / 8, 0xFF);
+  auto clear = [&](size_t idx) {
+    bitmap[idx / 8] &= static_cast<uint8_t>(~(1u << (idx % 8)));
+  };
+  clear(3);
+  clear(7);
+  clear(20);
+  TEST_ASSERT_EQUAL_UINT8(8, fec::windowLen(32, 1, total));
+  uint8_t cols[kWindow];
+  TEST_ASSERT_EQUAL_UINT8(2, fec::windowMissing(bitmap.data(), bitmap.size(), total, 0, 1, cols));
+  TEST_ASSERT_EQUAL_UINT8(3, cols[0]);
+  TEST_ASSERT_EQUAL_UINT8(7, cols[1]);
+
+  TEST_ASSERT_EQUAL_INT(0, pool.claim(0, 1, 0));
+  TEST_ASSERT_EQUAL_INT(-1, pool.claim(0, 1, 0));  // same row twice
+  TEST_ASSERT_EQUAL_INT(1, pool.claim(16, 1, 0));
+  fec::DecodePlan p;
+  // Window 0 lacks 2 chunks on 1 row; window 16 lacks 1 on 1.
+  TEST_ASSERT_TRUE(pool.plan(bitmap.data(), bitmap.size(), total, p));
+  TEST_ASSERT_EQUAL_UINT16(16, p.windowStart);
+  TEST_ASSERT_EQUAL_UINT8(1, p.m);
+  TEST_ASSERT_EQUAL_UINT8(4, p.col[0]);
+  TEST_ASSERT_EQUAL_UINT8(1, p.slot[0]);
+  // Busy slots are neither re-planned nor evicted.
+  TEST_ASSERT_FALSE(pool.plan(bitmap.data(), bitmap.size(), total, p));
+  pool.release(p);
+  TEST_ASSERT_EQUAL_UINT8(1, pool.held());
+
+  TEST_ASSERT_EQUAL_INT(1, pool.claim(0, 1, 1));
+  TEST_ASSERT_TRUE(pool.plan(bitmap.data(), bitmap.size(), total, p));
+  TEST_ASSERT_EQUAL_UINT16(0, p.windowStart);
+  TEST_ASSERT_EQUAL_UINT8(2, p.m);
+  pool.release(p);
+  TEST_ASSERT_EQUAL_UINT8(0, pool.held());
+
+  // Full pool: a newer window evicts the lowest one, an older one is dropped.
+  for (uint8_t r = 0; r < fec::RepairPool::kSlots; ++r) {
+    TEST_ASSERT_TRUE(pool.claim(16, 1, r) >= 0);
+  }
+  TEST_ASSERT_EQUAL_INT(-1, pool.claim(0, 1, 9));
+  TEST_ASSERT_TRUE(pool.claim(32, 1, 0) >= 0);
+  TEST_ASSERT_EQUAL_UINT8(fec::RepairPool::kSlots, pool.held());
+  // Rows for a window with nothing missing are freed by plan().
+  bitmap.assign(bitmap.size(), 0xFF);
+  TEST_ASSERT_FALSE(pool.plan(bitmap.data(), bitmap.size(), total, p));
+  TEST_ASSERT_EQUAL_UINT8(0, pool.held());
+}
+
+void test_repair_frame_round_trip() {
+  uint8_t payload[100];
+  for (size_t i = 0; i < sizeof(payload); ++i) payload[i] = static_cast<uint8_t>(i * 7);
+  uint8_t buf[lp::FW_REPAIR_MAX_SIZE];
+  const size_t n = lp::buildFwRepair(buf, sizeof(buf), 42, kSender, kReceiver, 66, 16,
+                                     /*stride=*/4, 3, payload, sizeof(payload));
+  TEST_ASSERT_EQUAL_size_t(lp::FW_REPAIR_FIXED_SIZE + sizeof(payload), n);
+  lp::ParsedFwRepair r;
+  TEST_ASSERT_TRUE(lp::parseFwRepair(buf, n, r));
+  TEST_ASSERT_EQUAL_UINT16(42, r.seq);
+  TEST_ASSERT_EQUAL_UINT16(66, r.windowStart);
+  TEST_ASSERT_EQUAL_UINT8(16, r.windowLen);
+  TEST_ASSERT_EQUAL_UINT8(4, r.stride);
+  TEST_ASSERT_EQUAL_UINT8(3, r.row);
+  TEST_ASSERT_EQUAL_UINT16(sizeof(payload), r.len);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(payload, r.bytes, sizeof(payload));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(kReceiver, r.targetMac, 6);
+  // The FS flavour is a different type; a FW parse rejects it.
+  const size_t fs = lp::buildFwRepair(buf, sizeof(buf), 1, kSender, kReceiver, 0, 5, 1, 0,
+                                      payload, 10, lp::PROTOCOL_VERSION_EMIT,
+                                      lp::MSG_FS_REPAIR);
+  TEST_ASSERT_FALSE(lp::parseFwRepair(buf, fs, r));
+  TEST_ASSERT_TRUE(lp::parseFwRepair(buf, fs, r, lp::MSG_FS_REPAIR));
+  // Window start off its block (contiguous, then interleaved), zero and
+  // oversize stride, oversize window, out-of-range row, short frame.
+  TEST_ASSERT_EQUAL_size_t(0, lp::buildFwRepair(buf, sizeof(buf), 1, kSender, kReceiver,
+                                                8, 16, 1, 0, payload, 10));
+  TEST_ASSERT_EQUAL_size_t(0, lp::buildFwRepair(buf, sizeof(buf), 1, kSender, kReceiver,
+                                                68, 16, 4, 0, payload, 10));
+  TEST_ASSERT_EQUAL_size_t(0, lp::buildFwRepair(buf, sizeof(buf), 1, kSender, kReceiver,
+                                                0, 16, 0, 0, payload, 10));
+  TEST_ASSERT_EQUAL_size_t(0, lp::buildFwRepair(buf, sizeof(buf), 1, kSender, kReceiver,
+                                                0, 16, lp::FW_FEC_MAX_STRIDE + 1, 0,
+                                                payload, 10));
+  TEST_ASSERT_EQUAL_size_t(0, lp::buildFwRepair(buf, sizeof(buf), 1, kSender, kReceiver,
+                                                0, 17, 1, 0, payload, 10));
+  TEST_ASSERT_EQUAL_size_t(0, lp::buildFwRepair(buf, sizeof(buf), 1, kSender, kReceiver,
+                                                0, 16, 1, lp::FW_FEC_MAX_ROWS, payload, 10));
+  const size_t ok = lp::buildFwRepair(buf, sizeof(buf), 1, kSender, kReceiver, 0, 16, 1, 0,
+                                      payload, 10);
+  TEST_ASSERT_FALSE(lp::parseFwRepair(buf, ok - 1, r));
+  buf[20] = 0;  // windowLen 0
+  TEST_ASSERT_FALSE(lp::parseFwRepair(buf, ok, r));
+}
+
+// Same seeds, same channel, 20 ms cadence. The hole-mask REQ path against
+// the shipped code (kRowsPerWindow rows per window, kStride-way interleave)
+// and a one-row variant. The code heals a good part of the loss in-stream, so
+// the session needs fewer REQ round trips, for a few percent more frames.
+void test_lossy_link_repair_vs_req() {
+  struct Sum {
+    uint32_t frames = 0, reqs = 0, ms = 0, repairs = 0, rebuilt = 0;
+    void add(const SessionStats& s) {
+      TEST_ASSERT_TRUE(s.complete);
+      TEST_ASSERT_TRUE(s.intact);
+      frames += s.frames; reqs += s.reqs; ms += s.elapsedMs;
+      repairs += s.repairs; rebuilt += s.rebuilt;
+    }
+  };
+  constexpr uint32_t kSeeds = 8;
+  Sum mask, one, shipped;
+  for (uint32_t seed = 1; seed <= kSeeds; ++seed) {
+    const uint32_t s = seed * 2654435761u;
+    mask.add(runSession(true, 0, 1, 20, s));
+    one.add(runSession(true, 1, fec::kStride, 20, s));
+    shipped.add(runSession(true, fec::kRowsPerWindow, fec::kStride, 20, s));
+  }
+  auto show = [&](const char* name, const Sum& x) {
+    printf("%-10s frames %u repairs %u rebuilt %u REQs %u %u ms\n", name,
+           (unsigned)(x.frames / kSeeds), (unsigned)(x.repairs / kSeeds),
+           (unsigned)(x.rebuilt / kSeeds), (unsigned)(x.reqs / kSeeds),
+           (unsigned)(x.ms / kSeeds));
+  };
+  show("hole REQ", mask);
+  show("fec 1 row", one);
+  show("fec", shipped);
+
+  // Every repair went somewhere: more rebuilt with more rows.
+  TEST_ASSERT_TRUE(shipped.rebuilt > one.rebuilt);
+  TEST_ASSERT_TRUE(one.rebuilt > 0);
+  // The point: REQ round trips drop by at least a quarter.
+  TEST_ASSERT_TRUE(shipped.reqs * 4 <= mask.reqs * 3);
+  // The price: under 10% more frames and under 5% more wall time.
+  TEST_ASSERT_TRUE(shipped.frames * 10 <= mask.frames * 11);
+  TEST_ASSERT_TRUE(shipped.ms * 20 <= mask.ms * 21);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_coefficients_are_cauchy);
+  RUN_TEST(test_any_m_rows_rebuild_any_m_chunks);
+  RUN_TEST(test_repair_pool_plans_and_evicts);
+  RUN_TEST(test_repair_frame_round_trip);
+  RUN_TEST(test_lossy_link_repair_vs_req);
+  return UNITY_END();
+}
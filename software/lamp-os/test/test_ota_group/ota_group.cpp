@@ -0,0 +1,222 @@
+// Native tests for one-to-many mesh OTA sessions (HELLO_CAP_FW_GROUP): the
+// group MAC the stream is addressed to and the receive filter on it, the
+// distributor's merged hole queue, and a lossy-link simulation that serves
+// several receivers from one stream and compares it against serving them one
+// session at a time.
+//
+// The session model is the shared one in test/ota_sim/session_model.hpp in
+// its group form: the distributor's hole queue merged across members (a run
+// REQ joining as its mask) and a late member's replay ahead of DONE. Every
+// receiver sits behind its own Gilbert-Elliott channel, so members lose
+// different chunks.
+
+#include <unity.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "components/network/protocol/lamp_protocol.hpp"
+#include "../../src/components/firmware/req_holes.cpp"
+#include "../ota_sim/session_model.hpp"
+
+namespace lp = lamp_protocol;
+using lamp::ReqHoleQueue;
+using ota_sim::Channel;
+using ota_sim::kGroupGatherMs;
+using ota_sim::kSender;
+using ota_sim::Receiver;
+using ota_sim::Rng;
+using ota_sim::SessionStats;
+
+void setUp() {}
+void tearDown() {}
+
+namespace {
+
+constexpr uint32_t kSpacingMs = 20;  // kStreamingChunkSpacingMaskMs
+// OFFER to ACCEPT: the receiver's upfront partition erase.
+constexpr uint32_t kEraseMs   = 2500;
+constexpr uint16_t kSimChunks = 2000;
+
+// One stream to every receiver in `rx`, starting at startMs. Receivers whose
+// ACCEPT lands later join mid-stream. Channels are per receiver and used for
+// both directions.
+SessionStats runSession(std::vector<Receiver>& rx, std::vector<Channel>& air,
+                        bool group, uint32_t startMs) {
+  ota_sim::Sender tx(kSimChunks, group);
+  return ota_sim::runSession(tx, rx, air, kSpacingMs, startMs);
+}
+
+Channel channelFor(uint32_t seed, size_t member) {
+  return Channel{Rng{seed ^ (0x9E3779B9u * static_cast<uint32_t>(member + 1))}};
+}
+
+// A group of n from seed, all accepting after the erase, against the same n
+// receivers (same channels) served one session after another.
+void runBoth(uint32_t seed, size_t n, SessionStats& grp, SessionStats& seq) {
+  std::vector<Receiver> rx;
+  std::vector<Channel> air;
+  for (size_t i = 0; i < n; ++i) {
+    rx.emplace_back(kSimChunks, true, static_cast<uint8_t>(i));
+    rx.back().acceptMs = kEraseMs;
+    air.push_back(channelFor(seed, i));
+  }
+  grp = runSession(rx, air, true, std::max(kGroupGatherMs, kEraseMs));
+  for (const Receiver& r : rx) TEST_ASSERT_TRUE(r.full());
+
+  seq = SessionStats{};
+  seq.complete = true;
+  for (size_t i = 0; i < n; ++i) {
+    std::vector<Receiver> one{Receiver(kSimChunks, true, static_cast<uint8_t>(i))};
+    std::vector<Channel> oneAir{channelFor(seed, i)};
+    one[0].acceptMs = kEraseMs;
+    const SessionStats s = runSession(one, oneAir, false, kEraseMs);
+    seq.complete = seq.complete && s.complete;
+    seq.elapsedMs += s.elapsedMs;
+    seq.frames += s.frames;
+    seq.reqs += s.reqs;
+  }
+}
+
+}  // namespace
+
+// The group MAC is the distributor's own MAC with the multicast bit set: no
+// lamp's unicast address, and distinct per distributor.
+void test_group_mac() {
+  uint8_t g[6];
+  lp::fwGroupMac(kSender, g);
+  TEST_ASSERT_EQUAL_UINT8(kSender[0] | 0x01, g[0]);
+  TEST_ASSERT_EQUAL_MEMORY(kSender + 1, g + 1, 5);
+  TEST_ASSERT_TRUE(lp::isFwGroupTarget(g, kSender));
+
+  // Another distributor's group, or the sender's own unicast MAC, isn't it.
+  const uint8_t other[6] = {0x20, 0x11, 0x12, 0x13, 0x14, 0x15};
+  TEST_ASSERT_FALSE(lp::isFwGroupTarget(g, other));
+  TEST_ASSERT_FALSE(lp::isFwGroupTarget(kSender, kSender));
+  // A multicast source (broadcast included) has no group.
+  const uint8_t bcast[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+  TEST_ASSERT_FALSE(lp::isFwGroupTarget(bcast, bcast));
+}
+
+// The mesh_link filter for CHUNK/REPAIR/DONE: our own and broadcast frames
+// always, a group-addressed one only while we're in that distributor's
+// session.
+void test_stream_filter() {
+  uint8_t g[6];
+  lp::fwGroupMac(kSender, g);
+  const uint8_t me[6]    = {0x30, 0x31, 0x32, 0x33, 0x34, 0x35};
+  const uint8_t other[6] = {0x20, 0x11, 0x12, 0x13, 0x14, 0x15};
+  const uint8_t bcast[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+  uint8_t otherGroup[6];
+  lp::fwGroupMac(other, otherGroup);
+
+  TEST_ASSERT_TRUE(lp::isFwStreamForUs(me, kSender, me, false));
+  TEST_ASSERT_TRUE(lp::isFwStreamForUs(bcast, kSender, me, false));
+  TEST_ASSERT_FALSE(lp::isFwStreamForUs(other, kSender, me, true));
+
+  TEST_ASSERT_TRUE(lp::isFwStreamForUs(g, kSender, me, true));
+  TEST_ASSERT_FALSE(lp::isFwStreamForUs(g, kSender, me, false));
+  // Another distributor's group frame, even relayed under our sender's
+  // source, and a group frame claiming to come from someone else.
+  TEST_ASSERT_FALSE(lp::isFwStreamForUs(otherGroup, kSender, me, true));
+  TEST_ASSERT_FALSE(lp::isFwStreamForUs(g, other, me, true));
+}
+
+// Merged REQs serve the union once, in index order; a lower base re-bases the
+// queue and drops what no longer fits the window.
+void test_hole_queue_merge() {
+  ReqHoleQueue q;
+  const uint8_t a[] = {0x05};  // base 100: 100, 102
+  const uint8_t b[] = {0x06};  // base 100: 101, 102
+  TEST_ASSERT_TRUE(q.merge(100, a, sizeof(a), 1000, 2000));  // empty: load
+  TEST_ASSERT_EQUAL_UINT16(2, q.remaining());
+  TEST_ASSERT_TRUE(q.merge(100, b, sizeof(b), 1000, 2000));
+  TEST_ASSERT_EQUAL_UINT16(3, q.remaining());
+  TEST_ASSERT_EQUAL_UINT16(100, q.front());
+
+  // Holes at or past the forward position stay with the forward pass.
+  const uint8_t c[] = {0x01};
+  TEST_ASSERT_TRUE(q.merge(1000, c, sizeof(c), 1000, 2000));
+  TEST_ASSERT_EQUAL_UINT16(3, q.remaining());
+
+  // Re-base to 0: 100..102 still fit the 256-chunk window.
+  const uint8_t d[] = {0x01};  // base 0: 0
+  TEST_ASSERT_TRUE(q.merge(0, d, sizeof(d), 1000, 2000));
+  TEST_ASSERT_EQUAL_UINT16(4, q.remaining());
+  TEST_ASSERT_EQUAL_UINT16(0, q.front());
+
+  uint16_t next = 0;
+  TEST_ASSERT_TRUE(q.served(0, next));
+  TEST_ASSERT_EQUAL_UINT16(100, next);
+  TEST_ASSERT_TRUE(q.served(100, next));
+  TEST_ASSERT_EQUAL_UINT16(101, next);
+
+  // A REQ far above the base doesn't fit and is dropped; one far below
+  // re-bases and pushes the old holes out. Either receiver REQs again.
+  const uint8_t e[] = {0x01};
+  TEST_ASSERT_TRUE(q.merge(600, e, sizeof(e), 1000, 2000));
+  TEST_ASSERT_EQUAL_UINT16(2, q.remaining());
+  ReqHoleQueue r;
+  const uint8_t f[] = {0x01};
+  TEST_ASSERT_TRUE(r.merge(500, f, sizeof(f), 1000, 2000));
+  TEST_ASSERT_TRUE(r.merge(100, f, sizeof(f), 1000, 2000));
+  TEST_ASSERT_EQUAL_UINT16(1, r.remaining());
+  TEST_ASSERT_EQUAL_UINT16(100, r.front());
+}
+
+// Four receivers, each behind its own lossy channel. One stream with merged
+// hole REQs against four back-to-back sessions: the shared forward pass is
+// sent once, and only the members' lost chunks are paid per member.
+void test_group_vs_sequential() {
+  constexpr uint32_t kSeeds = 4;
+  constexpr size_t kMembers = 4;
+  SessionStats grp, seq, gSum, sSum;
+  for (uint32_t seed = 1; seed <= kSeeds; ++seed) {
+    runBoth(seed * 2654435761u, kMembers, grp, seq);
+    TEST_ASSERT_TRUE(grp.complete);
+    TEST_ASSERT_TRUE(seq.complete);
+    gSum.frames += grp.frames; gSum.reqs += grp.reqs; gSum.elapsedMs += grp.elapsedMs;
+    sSum.frames += seq.frames; sSum.reqs += seq.reqs; sSum.elapsedMs += seq.elapsedMs;
+  }
+  printf("%u receivers: group frames %u REQs %u %u ms; sequential frames %u "
+         "REQs %u %u ms\n",
+         (unsigned)kMembers, (unsigned)(gSum.frames / kSeeds),
+         (unsigned)(gSum.reqs / kSeeds), (unsigned)(gSum.elapsedMs / kSeeds),
+         (unsigned)(sSum.frames / kSeeds), (unsigned)(sSum.reqs / kSeeds),
+         (unsigned)(sSum.elapsedMs / kSeeds));
+  // Under half the airtime and under half the wall time of one-at-a-time.
+  TEST_ASSERT_TRUE(gSum.frames * 2 <= sSum.frames);
+  TEST_ASSERT_TRUE(gSum.elapsedMs * 2 <= sSum.elapsedMs);
+}
+
+// A member whose ACCEPT lands after the stream started gets the chunks it
+// missed replayed ahead of DONE, in the same session.
+void test_late_member_is_replayed() {
+  const uint32_t seed = 0xC0FFEEu;
+  std::vector<Receiver> rx;
+  std::vector<Channel> air;
+  for (size_t i = 0; i < 3; ++i) {
+    rx.emplace_back(kSimChunks, true, static_cast<uint8_t>(i));
+    rx.back().acceptMs = kEraseMs;
+    air.push_back(channelFor(seed, i));
+  }
+  rx[2].acceptMs = 15000;  // ~600 chunks into the stream
+  const SessionStats st = runSession(rx, air, true, kGroupGatherMs);
+  TEST_ASSERT_TRUE(st.complete);
+  for (const Receiver& r : rx) TEST_ASSERT_TRUE(r.full());
+  // The replay covers the prefix once, not the whole image again.
+  TEST_ASSERT_TRUE(st.frames < 2u * kSimChunks);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_group_mac);
+  RUN_TEST(test_stream_filter);
+  RUN_TEST(test_hole_queue_merge);
+  RUN_TEST(test_group_vs_sequential);
+  RUN_TEST(test_late_member_is_replayed);
+  return UNITY_END();
+}
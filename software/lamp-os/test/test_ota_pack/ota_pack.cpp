@@ -0,0 +1,332 @@
+// Native tests for packed OTA chunks (ota_pack.hpp): every unit of a planned
+// stream decodes back to its slice within the chunk budget, the decoder's
+// bounds checks, and a lossy-link simulation that streams an FS image and a
+// firmware-like image raw and packed and compares frames and wall time.
+//
+// The session model is the shared one in test/ota_sim/session_model.hpp at
+// the exact-hole cadence (20 ms, hole-mask REQ). Only the chunk count differs
+// between the raw and packed runs, so the times it prints are the model's,
+// not a measurement of FirmwareDistributor and FirmwareReceiver.
+
+#include <unity.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+#include "components/network/protocol/lamp_protocol.hpp"
+#include "../../src/components/firmware/ota_pack.cpp"
+#include "../../src/components/firmware/req_holes.cpp"
+#include "../ota_sim/session_model.hpp"
+
+namespace lp = lamp_protocol;
+namespace pk = lamp::ota_pack;
+using ota_sim::Rng;
+using ota_sim::SessionStats;
+
+void setUp() {}
+void tearDown() {}
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+lamp::firmware::FirmwareByteReader readerOf(const Bytes& b) {
+  return [&b](size_t off, size_t want, uint8_t* out) -> int {
+    if (off > b.size() || want > b.size() - off) return -1;
+    std::memcpy(out, b.data() + off, want);
+    return static_cast<int>(want);
+  };
+}
+
+// A 192 KB spiffs image the way mkspiffs lays one out: 4 KB blocks whose
+// first page is the object lookup table, 256-byte pages with a 5-byte object
+// header, the web UI's gzipped files as page payload (random bytes: gzip
+// leaves nothing to match) and 0xFF everywhere unused.
+Bytes makeFsImage() {
+  constexpr size_t kPart = 0x30000, kBlock = 4096, kPage = 256, kHdr = 5;
+  Bytes img(kPart, 0xFF);
+  Rng rng{0xF5F5F5F5u};
+  size_t page = 1;
+  uint16_t id = 1;
+  for (size_t fileLen : {3900u, 4100u, 3700u, 4300u, 3600u, 4000u, 3800u, 4200u,
+                         3900u, 4100u, 3700u, 4300u, 3600u, 4000u, 3800u, 4200u,
+                         2900u, 1600u}) {
+    for (uint16_t span = 0; fileLen > 0; ++span) {
+      if (page % (kBlock / kPage) == 0) ++page;  // lookup page
+      uint8_t* p = &img[page * kPage];
+      p[0] = static_cast<uint8_t>(id);
+      p[1] = static_cast<uint8_t>(id >> 8);
+      p[2] = static_cast<uint8_t>(span);
+      p[3] = static_cast<uint8_t>(span >> 8);
+      p[4] = 0xFC;
+      const size_t n = fileLen < kPage - kHdr ? fileLen : kPage - kHdr;
+      for (size_t i = 0; i < n; ++i) p[kHdr + i] = static_cast<uint8_t>(rng.next());
+      fileLen -= n;
+      // The block's lookup page names the page's object.
+      const size_t block = page / (kBlock / kPage);
+      const size_t slot = page % (kBlock / kPage);
+      img[block * kBlock + slot * 2]     = static_cast<uint8_t>(id);
+      img[block * kBlock + slot * 2 + 1] = static_cast<uint8_t>(id >> 8);
+      ++page;
+    }
+    ++id;
+  }
+  return img;
+}
+
+// A 1.5 MB stand-in for an app image: instruction-like words drawn from a
+// skewed vocabulary with random call targets, a rodata stretch of log
+// strings and pointer tables, and a run of random bytes (certificates,
+// compressed assets). The packed ratio is only as real as this mix.
+Bytes makeFirmwareImage() {
+  Rng rng{0xA5A5F00Du};
+  Bytes img;
+  img.reserve(1500000);
+  std::vector<uint32_t> vocab(4096);
+  for (auto& w : vocab) w = rng.next() & 0xFFFFFF;
+  while (img.size() < 1000000) {
+    const uint32_t r = rng.next();
+    uint32_t w;
+    if (r % 8 == 0) {
+      w = 0x05 | ((rng.next() & 0x3FFFF) << 6);  // call with a random target
+    } else {
+      w = vocab[r % 2 == 0 ? (r >> 8) % 48 : (r >> 8) % vocab.size()];
+    }
+    img.push_back(static_cast<uint8_t>(w));
+    img.push_back(static_cast<uint8_t>(w >> 8));
+    if ((r >> 4) % 3 != 0) img.push_back(static_cast<uint8_t>(w >> 16));
+  }
+  static const char* const kWords[] = {
+      "[fw_receiver] ", "[fwdist] ", "chunk ", "OFFER ", "failed ", "peer ",
+      "%02X:%02X:%02X:%02X:%02X:%02X ", "v=0x%08X ", "len=%u ", "state=%u\n",
+      "expression ", "brightness ", "[mesh] ", "HELLO ", "timeout ", "ok\n"};
+  while (img.size() < 1300000) {
+    if (rng.next() % 4 == 0) {
+      const uint32_t ptr = 0x3F400000u + (rng.next() & 0xFFFFC);
+      for (int k = 0; k < 4; ++k) img.push_back(static_cast<uint8_t>(ptr >> (8 * k)));
+    } else {
+      const char* s = kWords[rng.next() % (sizeof(kWords) / sizeof(kWords[0]))];
+      img.insert(img.end(), s, s + std::strlen(s));
+    }
+  }
+  while (img.size() < 1500000) img.push_back(static_cast<uint8_t>(rng.next()));
+  return img;
+}
+
+// Plans the stream, then packs and decodes every unit the way the
+// distributor and receiver do, checking each against its slice. Returns the
+// unit count.
+size_t checkStream(const Bytes& stream, uint16_t chunkSize) {
+  auto ws = std::make_unique<pk::Workspace>();
+  std::vector<uint32_t> starts;
+  const auto read = readerOf(stream);
+  TEST_ASSERT_TRUE(pk::plan(read, static_cast<uint32_t>(stream.size()), chunkSize,
+                            *ws, starts));
+  TEST_ASSERT_TRUE(starts.size() >= 2);
+  TEST_ASSERT_EQUAL_UINT32(0, starts.front());
+  TEST_ASSERT_EQUAL_UINT32(stream.size(), starts.back());
+  const size_t units = starts.size() - 1;
+  uint32_t maxUnits = 0;
+  TEST_ASSERT_TRUE(lp::offerChunkCountOk(static_cast<uint32_t>(stream.size()),
+                                         static_cast<uint16_t>(chunkSize - pk::kSlack),
+                                         maxUnits));
+  TEST_ASSERT_TRUE(units <= maxUnits);
+  uint8_t decoded[pk::kMaxSpan];
+  for (size_t i = 0; i < units; ++i) {
+    size_t consumed = 0;
+    const size_t len = pk::packAt(read, static_cast<uint32_t>(stream.size()),
+                                  starts[i], chunkSize, *ws, consumed);
+    TEST_ASSERT_TRUE(len > 0 && len <= chunkSize);
+    TEST_ASSERT_EQUAL_size_t(starts[i + 1] - starts[i], consumed);
+    size_t outLen = 0;
+    TEST_ASSERT_TRUE(pk::unpack(ws->out, len, decoded, sizeof(decoded), outLen));
+    TEST_ASSERT_EQUAL_size_t(consumed, outLen);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(stream.data() + starts[i], decoded, outLen);
+    if (i + 1 < units) TEST_ASSERT_TRUE(outLen >= chunkSize - pk::kSlack);
+  }
+  return units;
+}
+
+constexpr uint32_t kSpacingMs = 20;  // kStreamingChunkSpacingMaskMs
+
+// One session of `total` chunks or units over the shared model's channel.
+SessionStats runSession(uint16_t total, uint32_t seed) {
+  ota_sim::Sender tx(total);
+  ota_sim::Receiver rx(total);
+  return ota_sim::runOne(tx, rx, seed, kSpacingMs);
+}
+
+}  // namespace
+
+void test_units_tile_and_round_trip() {
+  Rng rng{0x1234ABCDu};
+  Bytes random(20000);
+  for (auto& b : random) b = static_cast<uint8_t>(rng.next());
+  Bytes erased(50000, 0xFF);
+  Bytes text;
+  while (text.size() < 30000) {
+    const char* s = (rng.next() % 2) ? "the lamp glows " : "over the mesh, ";
+    text.insert(text.end(), s, s + std::strlen(s));
+  }
+  for (uint16_t cs : {pk::kMinChunkSize, static_cast<uint16_t>(200),
+                      lp::FW_CHUNK_SIZE_MAX}) {
+    // Incompressible data still fills each unit to within the slack.
+    checkStream(random, cs);
+    // A unit never decodes past one sector, however well it packs.
+    TEST_ASSERT_EQUAL_size_t((erased.size() + pk::kMaxSpan - 1) / pk::kMaxSpan,
+                             checkStream(erased, cs));
+    checkStream(text, cs);
+    for (size_t len : {1u, 3u, 4u, 5u, 17u, 300u, 4096u, 4097u}) {
+      checkStream(Bytes(random.begin(), random.begin() + len), cs);
+      checkStream(Bytes(erased.begin(), erased.begin() + len), cs);
+    }
+  }
+  // Too small a chunk to pack.
+  auto ws = std::make_unique<pk::Workspace>();
+  std::vector<uint32_t> starts;
+  TEST_ASSERT_FALSE(pk::plan(readerOf(text), static_cast<uint32_t>(text.size()),
+                             pk::kMinChunkSize - 1, *ws, starts));
+  TEST_ASSERT_TRUE(starts.empty());
+}
+
+void test_plan_stops_on_read_failure() {
+  Bytes stream(10000, 0x42);
+  auto ws = std::make_unique<pk::Workspace>();
+  std::vector<uint32_t> starts;
+  const lamp::firmware::FirmwareByteReader failing =
+      [](size_t off, size_t want, uint8_t* out) -> int {
+    if (off >= 4096) return -1;
+    std::memset(out, 0x42, want);
+    return static_cast<int>(want);
+  };
+  TEST_ASSERT_FALSE(pk::plan(failing, static_cast<uint32_t>(stream.size()), 200, *ws,
+                             starts));
+  TEST_ASSERT_TRUE(starts.empty());
+  size_t consumed = 1;
+  TEST_ASSERT_EQUAL_size_t(0, pk::packAt(failing, 10000, 5000, 200, *ws, consumed));
+  TEST_ASSERT_EQUAL_size_t(0, consumed);
+  TEST_ASSERT_EQUAL_size_t(0, pk::packAt(readerOf(stream), 10000, 10000, 200, *ws,
+                                         consumed));
+}
+
+// planSome in small slices, as the distributor's streaming task runs it,
+// lands on exactly the plan one plan() pass makes.
+void test_plan_in_slices_matches_one_pass() {
+  const Bytes fs = makeFsImage();
+  const auto read = readerOf(fs);
+  const uint32_t len = static_cast<uint32_t>(fs.size());
+  auto ws = std::make_unique<pk::Workspace>();
+  std::vector<uint32_t> whole;
+  TEST_ASSERT_TRUE(pk::plan(read, len, lp::FW_CHUNK_SIZE_MAX, *ws, whole));
+  for (size_t slice : {1u, 4u, 7u}) {
+    std::vector<uint32_t> starts;
+    uint32_t pos = 0;
+    size_t steps = 0;
+    pk::PlanStep r;
+    while ((r = pk::planSome(read, len, lp::FW_CHUNK_SIZE_MAX, *ws, starts, pos,
+                             slice)) == pk::PlanStep::More) {
+      TEST_ASSERT_TRUE(starts.size() <= (steps + 1) * slice);
+      ++steps;
+    }
+    TEST_ASSERT_EQUAL_INT((int)pk::PlanStep::Done, (int)r);
+    TEST_ASSERT_EQUAL_size_t(whole.size(), starts.size());
+    TEST_ASSERT_TRUE(starts == whole);
+  }
+  // A read failure mid-way fails the slice it lands in and drops the partial
+  // plan.
+  const lamp::firmware::FirmwareByteReader failing =
+      [&fs](size_t off, size_t want, uint8_t* out) -> int {
+    if (off >= 20000) return -1;
+    std::memcpy(out, fs.data() + off, want);
+    return static_cast<int>(want);
+  };
+  std::vector<uint32_t> starts;
+  uint32_t pos = 0;
+  pk::PlanStep r;
+  while ((r = pk::planSome(failing, len, lp::FW_CHUNK_SIZE_MAX, *ws, starts, pos, 4)) ==
+         pk::PlanStep::More) {
+  }
+  TEST_ASSERT_EQUAL_INT((int)pk::PlanStep::Failed, (int)r);
+  TEST_ASSERT_TRUE(starts.empty());
+}
+
+void test_unpack_rejects_malformed() {
+  uint8_t out[pk::kMaxSpan];
+  size_t outLen = 0;
+  struct Case {
+    const char* what;
+    Bytes unit;
+    size_t cap;
+  };
+  const std::vector<Case> cases = {
+      {"empty", {}, sizeof(out)},
+      {"literals past the unit", {0x30, 'a', 'b'}, sizeof(out)},
+      {"literal extension cut off", {0xF0}, sizeof(out)},
+      {"offset cut short", {0x10, 'a', 0x01}, sizeof(out)},
+      {"zero distance", {0x10, 'a', 0x00, 0x00}, sizeof(out)},
+      {"distance before the unit", {0x10, 'a', 0x02, 0x00}, sizeof(out)},
+      {"match extension cut off", {0x1F, 'a', 0x01, 0x00}, sizeof(out)},
+      {"literals past the buffer", {0x30, 'a', 'b', 'c'}, 2},
+      {"match past the buffer", {0x10, 'a', 0x01, 0x00}, 4},
+      {"no output", {0x00}, sizeof(out)},
+  };
+  for (const Case& c : cases) {
+    TEST_ASSERT_FALSE_MESSAGE(pk::unpack(c.unit.data(), c.unit.size(), out, c.cap, outLen),
+                              c.what);
+  }
+  // A run: one literal, then a match that overlaps its own output.
+  const Bytes run = {0x16, 'z', 0x01, 0x00};
+  TEST_ASSERT_TRUE(pk::unpack(run.data(), run.size(), out, sizeof(out), outLen));
+  TEST_ASSERT_EQUAL_size_t(11, outLen);
+  for (size_t i = 0; i < outLen; ++i) TEST_ASSERT_EQUAL_UINT8('z', out[i]);
+}
+
+// Same seeds, same channel, 1444-byte chunks: the packed stream needs fewer
+// frames, so the session ends sooner.
+void test_lossy_link_packed_vs_raw() {
+  struct Image {
+    const char* name;
+    Bytes bytes;
+  };
+  const Image images[] = {{"fs image", makeFsImage()},
+                          {"firmware-like image", makeFirmwareImage()}};
+  for (const Image& im : images) {
+    const uint16_t cs = lp::FW_CHUNK_SIZE_MAX;
+    const uint16_t raw =
+        static_cast<uint16_t>((im.bytes.size() + cs - 1) / cs);
+    const uint16_t packed = static_cast<uint16_t>(checkStream(im.bytes, cs));
+    uint32_t rawFrames = 0, rawMs = 0, packedFrames = 0, packedMs = 0;
+    for (uint32_t seed = 1; seed <= 8; ++seed) {
+      const SessionStats a = runSession(raw, seed * 2654435761u);
+      const SessionStats b = runSession(packed, seed * 2654435761u);
+      TEST_ASSERT_TRUE(a.complete);
+      TEST_ASSERT_TRUE(b.complete);
+      rawFrames += a.frames;
+      rawMs += a.elapsedMs;
+      packedFrames += b.frames;
+      packedMs += b.elapsedMs;
+    }
+    std::printf("%s (%zu bytes): raw %u chunks, %u frames, %u ms; "
+                "packed %u units (%.1f%%), %u frames, %u ms\n",
+                im.name, im.bytes.size(), (unsigned)raw, (unsigned)(rawFrames / 8),
+                (unsigned)(rawMs / 8), (unsigned)packed, 100.0 * packed / raw,
+                (unsigned)(packedFrames / 8), (unsigned)(packedMs / 8));
+    TEST_ASSERT_TRUE(packed < raw);
+    TEST_ASSERT_TRUE(packedFrames < rawFrames);
+    TEST_ASSERT_TRUE(packedMs < rawMs);
+  }
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_units_tile_and_round_trip);
+  RUN_TEST(test_plan_stops_on_read_failure);
+  RUN_TEST(test_plan_in_slices_matches_one_pass);
+  RUN_TEST(test_unpack_rejects_malformed);
+  RUN_TEST(test_lossy_link_packed_vs_raw);
+  return UNITY_END();
+}
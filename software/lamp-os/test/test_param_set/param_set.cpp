@@ -0,0 +1,104 @@
+#include <unity.h>
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "expressions/param_set.hpp"
+
+using namespace lamp;
+
+// Copied around the receive -> trigger path by value; must stay a flat blob.
+static_assert(std::is_trivially_copyable_v<ParamSet>);
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_find_param_key_exact_match_only() {
+  TEST_ASSERT_NOT_EQUAL(kNoParamKey, findParamKey("size"));
+  TEST_ASSERT_EQUAL_STRING("size", paramKeyName(findParamKey("size")));
+  TEST_ASSERT_EQUAL(kNoParamKey, findParamKey("siz"));
+  TEST_ASSERT_EQUAL(kNoParamKey, findParamKey("sizes"));
+  TEST_ASSERT_EQUAL(kNoParamKey, findParamKey(""));
+  TEST_ASSERT_EQUAL(kNoParamKey, findParamKey(nullptr));
+  // Every table row resolves to itself.
+  for (ParamKey k = 0; k < kParamKeyCount; k++) {
+    TEST_ASSERT_EQUAL(k, findParamKey(kParamKeyNames[k]));
+  }
+}
+
+void test_find_param_key_bounded_length() {
+  // A key slice out of a larger buffer (not NUL-terminated at len).
+  const char buf[] = "posMinposMax";
+  TEST_ASSERT_EQUAL(findParamKey("posMin"), findParamKey(buf, 6));
+  TEST_ASSERT_EQUAL(findParamKey("posMax"), findParamKey(buf + 6, 6));
+  TEST_ASSERT_EQUAL(kNoParamKey, findParamKey(buf, 4));  // "posM"
+}
+
+void test_set_get_erase() {
+  ParamSet p;
+  TEST_ASSERT_TRUE(p.empty());
+  TEST_ASSERT_TRUE(p.set("count", 3));
+  TEST_ASSERT_TRUE(p.set("count", 5));  // overwrite
+  TEST_ASSERT_EQUAL_size_t(1, p.size());
+  TEST_ASSERT_EQUAL_UINT32(5, p.get("count", 0));
+  TEST_ASSERT_EQUAL_UINT32(7, p.get("size", 7));  // absent -> fallback
+  TEST_ASSERT_NULL(p.find("size"));
+  p.erase("count");
+  TEST_ASSERT_TRUE(p.empty());
+}
+
+void test_unknown_key_is_refused() {
+  ParamSet p;
+  TEST_ASSERT_FALSE(p.set("notAParam", 1));
+  TEST_ASSERT_FALSE(p.set(kNoParamKey, 1));
+  TEST_ASSERT_TRUE(p.empty());
+  ParamSet literal = {{"size", 2}, {"bogus", 9}};
+  TEST_ASSERT_EQUAL_size_t(1, literal.size());
+}
+
+void test_set_if_absent_keeps_present_value() {
+  ParamSet p = {{"opacity", 40}};
+  TEST_ASSERT_FALSE(p.setIfAbsent("opacity", 100));
+  TEST_ASSERT_TRUE(p.setIfAbsent("easing", 4));
+  TEST_ASSERT_EQUAL_UINT32(40, p.get("opacity", 0));
+  TEST_ASSERT_EQUAL_UINT32(4, p.get("easing", 0));
+}
+
+// Iteration is alphabetical, the order the std::map it replaced serialized in.
+void test_iteration_is_sorted_by_name() {
+  ParamSet p = {{"size", 1}, {"count", 2}, {"posMin", 3}, {"easing", 4}};
+  std::vector<std::string> names;
+  std::vector<uint32_t> values;
+  for (const ParamSet::Entry e : p) {
+    names.push_back(e.name());
+    values.push_back(e.value);
+  }
+  TEST_ASSERT_EQUAL_size_t(4, names.size());
+  TEST_ASSERT_EQUAL_STRING("count", names[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("easing", names[1].c_str());
+  TEST_ASSERT_EQUAL_STRING("posMin", names[2].c_str());
+  TEST_ASSERT_EQUAL_STRING("size", names[3].c_str());
+  TEST_ASSERT_EQUAL_UINT32(2, values[0]);
+  TEST_ASSERT_EQUAL_UINT32(1, values[3]);
+}
+
+void test_equality_ignores_stale_erased_values() {
+  ParamSet a = {{"size", 1}, {"count", 2}};
+  ParamSet b = {{"size", 1}};
+  TEST_ASSERT_TRUE(a != b);
+  a.erase("count");  // value slot still holds 2, but it's absent
+  TEST_ASSERT_TRUE(a == b);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_find_param_key_exact_match_only);
+  RUN_TEST(test_find_param_key_bounded_length);
+  RUN_TEST(test_set_get_erase);
+  RUN_TEST(test_unknown_key_is_refused);
+  RUN_TEST(test_set_if_absent_keeps_present_value);
+  RUN_TEST(test_iteration_is_sorted_by_name);
+  RUN_TEST(test_equality_ignores_stale_erased_values);
+  return UNITY_END();
+}
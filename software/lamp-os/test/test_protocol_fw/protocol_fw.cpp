@@ -188,6 +188,88 @@ void test_fw_offer_auth_trailer_backcompat() {
   TEST_ASSERT_EQUAL_UINT16(3, out.totalChunks);
 }
 
+// Delta OFFER: the trailer after the auth one names the rebuilt image and the
+// base; a receiver that stops at the auth trailer still sees a full OFFER.
+void test_fw_offer_delta_trailer_roundtrip() {
+  static_assert(lp::FW_OFFER_DELTA_SIZE == 176, "FW OFFER delta size pin");
+  uint8_t buf[lp::FW_OFFER_DELTA_SIZE];
+  const uint8_t sha[lp::FW_SHA256_PREFIX_LEN] = {0};
+  uint8_t digest[lp::FW_SHA256_FULL_LEN] = {1};
+  uint8_t sig[lp::FW_SIG_LEN] = {2};
+  uint8_t baseId[lp::FW_DELTA_BASE_ID_LEN];
+  for (size_t i = 0; i < sizeof(baseId); ++i) baseId[i] = static_cast<uint8_t>(0x30 + i);
+  size_t n = lp::buildFwOffer(buf, sizeof(buf), 9, kWispMac, kLampMac,
+                              0x00010006, 18000, lp::FW_CHUNK_SIZE_MAX, "standard-beta",
+                              13, sha, 96, 13, lp::PROTOCOL_VERSION_EMIT,
+                              lp::MSG_FW_OFFER, digest, sig);
+  TEST_ASSERT_EQUAL_UINT32(lp::FW_OFFER_AUTH_SIZE, n);
+  // Only onto an authenticated OFFER, and only with room for it.
+  TEST_ASSERT_EQUAL_UINT32(0, lp::appendFwOfferDelta(buf, sizeof(buf), lp::FW_OFFER_FIXED_SIZE,
+                                                     1500000, 1499000, baseId));
+  TEST_ASSERT_EQUAL_UINT32(0, lp::appendFwOfferDelta(buf, lp::FW_OFFER_DELTA_SIZE - 1, n,
+                                                     1500000, 1499000, baseId));
+  n = lp::appendFwOfferDelta(buf, sizeof(buf), n, 1500000, 1499000, baseId);
+  TEST_ASSERT_EQUAL_UINT32(lp::FW_OFFER_DELTA_SIZE, n);
+
+  lp::ParsedFwOffer out;
+  TEST_ASSERT_TRUE(lp::parseFwOffer(buf, n, out));
+  TEST_ASSERT_TRUE(out.hasAuth);
+  TEST_ASSERT_TRUE(out.isDelta);
+  TEST_ASSERT_EQUAL_UINT32(18000u, out.totalLen);
+  TEST_ASSERT_EQUAL_UINT32(1500000u, out.deltaImageLen);
+  TEST_ASSERT_EQUAL_UINT32(1499000u, out.deltaBaseLen);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(baseId, out.deltaBaseId, lp::FW_DELTA_BASE_ID_LEN);
+
+  // An older receiver's view: the auth prefix alone is a full-image OFFER.
+  lp::ParsedFwOffer legacy;
+  TEST_ASSERT_TRUE(lp::parseFwOffer(buf, lp::FW_OFFER_AUTH_SIZE, legacy));
+  TEST_ASSERT_TRUE(legacy.hasAuth);
+  TEST_ASSERT_FALSE(legacy.isDelta);
+  TEST_ASSERT_EQUAL_UINT32(0u, legacy.deltaImageLen);
+}
+
+// Pack trailer: after a delta trailer, or after a zero-filled one on a
+// full-image OFFER, which then still parses as no delta.
+void test_fw_offer_pack_trailer_roundtrip() {
+  static_assert(lp::FW_OFFER_PACK_SIZE == 180, "FW OFFER pack size pin");
+  uint8_t buf[lp::FW_OFFER_PACK_SIZE];
+  std::memset(buf, 0xEE, sizeof(buf));
+  const uint8_t sha[lp::FW_SHA256_PREFIX_LEN] = {0};
+  uint8_t digest[lp::FW_SHA256_FULL_LEN] = {1};
+  uint8_t sig[lp::FW_SIG_LEN] = {2};
+  size_t n = lp::buildFwOffer(buf, sizeof(buf), 9, kWispMac, kLampMac,
+                              0x00010006, 196608, lp::FW_CHUNK_SIZE_MAX, "standard-beta",
+                              13, sha, 96, 80, lp::PROTOCOL_VERSION_EMIT,
+                              lp::MSG_FW_OFFER, digest, sig);
+  TEST_ASSERT_EQUAL_UINT32(lp::FW_OFFER_AUTH_SIZE, n);
+  TEST_ASSERT_EQUAL_UINT32(0, lp::appendFwOfferPack(buf, sizeof(buf), lp::FW_OFFER_FIXED_SIZE, 1));
+  TEST_ASSERT_EQUAL_UINT32(0, lp::appendFwOfferPack(buf, lp::FW_OFFER_PACK_SIZE - 1, n, 1));
+  TEST_ASSERT_EQUAL_UINT32(0, lp::appendFwOfferPack(buf, sizeof(buf), n, 0));
+  n = lp::appendFwOfferPack(buf, sizeof(buf), n, 1);
+  TEST_ASSERT_EQUAL_UINT32(lp::FW_OFFER_PACK_SIZE, n);
+
+  lp::ParsedFwOffer out;
+  TEST_ASSERT_TRUE(lp::parseFwOffer(buf, n, out));
+  TEST_ASSERT_FALSE(out.isDelta);
+  TEST_ASSERT_EQUAL_UINT8(1, out.packFormat);
+  TEST_ASSERT_EQUAL_UINT16(80, out.totalChunks);
+  TEST_ASSERT_EQUAL_UINT8(0, buf[lp::FW_OFFER_PACK_SIZE - 1]);
+
+  // Packed delta.
+  uint8_t baseId[lp::FW_DELTA_BASE_ID_LEN] = {7};
+  n = lp::appendFwOfferDelta(buf, sizeof(buf), lp::FW_OFFER_AUTH_SIZE, 1500000, 1499000, baseId);
+  TEST_ASSERT_EQUAL_UINT32(lp::FW_OFFER_DELTA_SIZE, n);
+  n = lp::appendFwOfferPack(buf, sizeof(buf), n, 1);
+  TEST_ASSERT_TRUE(lp::parseFwOffer(buf, n, out));
+  TEST_ASSERT_TRUE(out.isDelta);
+  TEST_ASSERT_EQUAL_UINT32(1500000u, out.deltaImageLen);
+  TEST_ASSERT_EQUAL_UINT8(1, out.packFormat);
+
+  // A receiver that stops at the delta trailer sees raw chunks.
+  TEST_ASSERT_TRUE(lp::parseFwOffer(buf, lp::FW_OFFER_DELTA_SIZE, out));
+  TEST_ASSERT_EQUAL_UINT8(0, out.packFormat);
+}
+
 // --- MSG_FW_ACCEPT ---
 
 void test_fw_accept_roundtrip() {
@@ -217,7 +299,8 @@ void test_fw_accept_status_codes() {
   uint8_t buf[lp::FW_ACCEPT_FIXED_SIZE];
   for (auto code : {lp::FwAcceptStatus::Accept,
                     lp::FwAcceptStatus::DeclineBusy,
-                    lp::FwAcceptStatus::DeclineAlreadyCurrent}) {
+                    lp::FwAcceptStatus::DeclineAlreadyCurrent,
+                    lp::FwAcceptStatus::DeclineDeltaBase}) {
     lp::buildFwAccept(buf, sizeof(buf), 1, kLampMac, kWispMac,
                       0, 0, code, 0);
     lp::ParsedFwAccept out;
@@ -394,6 +477,68 @@ void test_fw_req_too_short_rejected() {
   TEST_ASSERT_FALSE(lp::parseFwReq(buf, lp::FW_REQ_FIXED_SIZE - 1, out));
 }
 
+void test_fw_req_mask_roundtrip() {
+  uint8_t buf[lp::FW_REQ_MASK_MAX_SIZE];
+  // Holes at 500, 503 and 517; the fixed body keeps the covering run.
+  const uint8_t mask[3] = {0x09, 0x00, 0x20};
+  const size_t n = lp::buildFwReqMask(
+      buf, sizeof(buf), /*seq=*/11, kLampMac, kWispMac,
+      /*firstChunkIdx=*/500, /*chunkCount=*/18, lp::FwReqReason::Gap,
+      mask, sizeof(mask));
+  TEST_ASSERT_EQUAL_UINT32(lp::FW_REQ_FIXED_SIZE + 1 + 3, n);
+  TEST_ASSERT_EQUAL_UINT8(3, buf[24]);
+
+  lp::ParsedFwReq out;
+  TEST_ASSERT_TRUE(lp::parseFwReq(buf, n, out));
+  TEST_ASSERT_EQUAL_UINT16(500, out.firstChunkIdx);
+  TEST_ASSERT_EQUAL_UINT16(18, out.chunkCount);
+  TEST_ASSERT_EQUAL_UINT8(3, out.maskLen);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(mask, out.mask, 3);
+
+  // An old distributor reads only the fixed body: the same run REQ.
+  lp::ParsedFwReq legacy;
+  TEST_ASSERT_TRUE(lp::parseFwReq(buf, lp::FW_REQ_FIXED_SIZE, legacy));
+  TEST_ASSERT_EQUAL_UINT16(500, legacy.firstChunkIdx);
+  TEST_ASSERT_EQUAL_UINT16(18, legacy.chunkCount);
+  TEST_ASSERT_EQUAL_UINT8(0, legacy.maskLen);
+
+  // FS REQ shares the trailer.
+  TEST_ASSERT_TRUE(lp::buildFwReqMask(buf, sizeof(buf), 12, kLampMac, kWispMac,
+                                      500, 18, lp::FwReqReason::Gap, mask, 3,
+                                      lp::PROTOCOL_VERSION_EMIT, lp::MSG_FS_REQ));
+  TEST_ASSERT_TRUE(lp::parseFwReq(buf, n, out, lp::MSG_FS_REQ));
+  TEST_ASSERT_EQUAL_UINT8(3, out.maskLen);
+}
+
+void test_fw_req_mask_rejects_malformed() {
+  uint8_t buf[lp::FW_REQ_MASK_MAX_SIZE];
+  const uint8_t noFirst[1] = {0x02};
+  const uint8_t trailingZero[2] = {0x01, 0x00};
+  uint8_t tooLong[lp::FW_REQ_MASK_MAX_BYTES + 1] = {0x01};
+  tooLong[lp::FW_REQ_MASK_MAX_BYTES] = 0x80;
+  TEST_ASSERT_EQUAL_UINT32(0u, lp::buildFwReqMask(buf, sizeof(buf), 1, kLampMac,
+      kWispMac, 0, 1, lp::FwReqReason::Gap, noFirst, 1));
+  TEST_ASSERT_EQUAL_UINT32(0u, lp::buildFwReqMask(buf, sizeof(buf), 1, kLampMac,
+      kWispMac, 0, 1, lp::FwReqReason::Gap, trailingZero, 2));
+  TEST_ASSERT_EQUAL_UINT32(0u, lp::buildFwReqMask(buf, sizeof(buf), 1, kLampMac,
+      kWispMac, 0, 1, lp::FwReqReason::Gap, tooLong, sizeof(tooLong)));
+
+  const uint8_t mask[2] = {0x01, 0x04};
+  const size_t n = lp::buildFwReqMask(buf, sizeof(buf), 1, kLampMac, kWispMac,
+                                      0, 11, lp::FwReqReason::Gap, mask, 2);
+  TEST_ASSERT_EQUAL_UINT32(lp::FW_REQ_FIXED_SIZE + 3, n);
+  lp::ParsedFwReq out;
+  // Truncated mask, zero or oversized maskLen, first chunk not a hole.
+  TEST_ASSERT_FALSE(lp::parseFwReq(buf, n - 1, out));
+  buf[24] = 0;
+  TEST_ASSERT_FALSE(lp::parseFwReq(buf, n, out));
+  buf[24] = lp::FW_REQ_MASK_MAX_BYTES + 1;
+  TEST_ASSERT_FALSE(lp::parseFwReq(buf, n, out));
+  buf[24] = 2;
+  buf[25] = 0x02;
+  TEST_ASSERT_FALSE(lp::parseFwReq(buf, n, out));
+}
+
 // --- MSG_FW_DONE ---
 
 void test_fw_done_roundtrip() {
@@ -458,7 +603,8 @@ void test_fw_result_status_codes_roundtrip() {
                     lp::FwResultStatus::OtaBeginFail,
                     lp::FwResultStatus::OtaEndFail,
                     lp::FwResultStatus::SetBootFail,
-                    lp::FwResultStatus::OfferShaMismatch}) {
+                    lp::FwResultStatus::OfferShaMismatch,
+                    lp::FwResultStatus::DeltaApplyFail}) {
     lp::buildFwResult(buf, sizeof(buf), 1, kLampMac, kWispMac, code, 0, 0);
     lp::ParsedFwResult out;
     TEST_ASSERT_TRUE(lp::parseFwResult(buf, lp::FW_RESULT_FIXED_SIZE, out));
@@ -545,6 +691,8 @@ int main(int argc, char** argv) {
   RUN_TEST(test_fw_offer_legacy_no_auth_trailer);
   RUN_TEST(test_fw_offer_auth_trailer_roundtrip);
   RUN_TEST(test_fw_offer_auth_trailer_backcompat);
+  RUN_TEST(test_fw_offer_delta_trailer_roundtrip);
+  RUN_TEST(test_fw_offer_pack_trailer_roundtrip);
 
   RUN_TEST(test_fw_accept_roundtrip);
   RUN_TEST(test_fw_accept_status_codes);
@@ -562,6 +710,8 @@ int main(int argc, char** argv) {
   RUN_TEST(test_fw_req_chunk_count_zero_rejected_by_builder);
   RUN_TEST(test_fw_req_chunk_count_over_cap_rejected_by_builder);
   RUN_TEST(test_fw_req_too_short_rejected);
+  RUN_TEST(test_fw_req_mask_roundtrip);
+  RUN_TEST(test_fw_req_mask_rejects_malformed);
 
   RUN_TEST(test_fw_done_roundtrip);
   RUN_TEST(test_fw_done_too_short_rejected);
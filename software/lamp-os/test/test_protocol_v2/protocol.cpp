@@ -685,6 +685,103 @@ void test_hello_absent_variant_is_unknown() {
                           static_cast<uint8_t>(out.variant));
 }
 
+void test_hello_caps_round_trip() {
+  uint8_t buf[lp::HELLO_MAX_SIZE];
+  const size_t n = lp::buildHello(buf, sizeof(buf), 22, kSrcMac,
+                                  kHelloShade, kHelloBase, 0xBEEF,
+                                  "caps", 4, lp::kOtaStateIdle,
+                                  nullptr, nullptr, 0, false, nullptr,
+                                  lp::LampVariant::Unknown,
+                                  lp::HELLO_CAP_BINARY_INVOCATION, 0xA1B2C3D4u);
+  // Idle + CAPS TLV: tlv_count(1) + type(1) + len(1) + value(5).
+  TEST_ASSERT_EQUAL_UINT32(lp::HELLO_FIXED_SIZE + 1 + 4 + 1 + 2 + lp::HELLO_CAPS_LEN, n);
+  lp::ParsedHello out;
+  TEST_ASSERT_TRUE(lp::parseHello(buf, n, out));
+  TEST_ASSERT_EQUAL_UINT8(lp::HELLO_CAP_BINARY_INVOCATION, out.caps);
+  TEST_ASSERT_EQUAL_HEX32(0xA1B2C3D4u, out.invocationSchema);
+}
+
+void test_hello_absent_caps_is_zero() {
+  uint8_t buf[lp::HELLO_MAX_SIZE];
+  const size_t n = lp::buildHello(buf, sizeof(buf), 23, kSrcMac,
+                                  kHelloShade, kHelloBase, 0xBEEF,
+                                  "old", 3, lp::kOtaStateIdle);
+  lp::ParsedHello out;
+  out.caps = 0xFF;
+  out.invocationSchema = 1;
+  TEST_ASSERT_TRUE(lp::parseHello(buf, n, out));
+  TEST_ASSERT_EQUAL_UINT8(0, out.caps);
+  TEST_ASSERT_EQUAL_UINT32(0, out.invocationSchema);
+}
+
+// Every TLV at once, longest name: still inside HELLO_MAX_SIZE.
+void test_hello_all_tlvs_fit_max_size() {
+  uint8_t buf[lp::HELLO_MAX_SIZE];
+  const char name[] = "0123456789abcdef0123456789abcdef";
+  const uint8_t digest[lp::HELLO_FS_DIGEST_LEN] = {1, 2, 3, 4, 5, 6, 7, 8};
+  const lp::HelloHealth health;
+  const size_t n = lp::buildHello(buf, sizeof(buf), 24, kSrcMac,
+                                  kHelloShade, kHelloBase, 0xBEEF,
+                                  name, lp::HELLO_MAX_NAME, lp::kOtaStateSending,
+                                  "standard-beta", digest, 480, true, kSrcMac,
+                                  lp::LampVariant::Staff,
+                                  lp::HELLO_CAP_BINARY_INVOCATION |
+                                      lp::HELLO_CAP_BINARY_CONTROL_OP,
+                                  7, &health);
+  TEST_ASSERT_EQUAL_UINT32(lp::HELLO_MAX_SIZE, n);
+  lp::ParsedHello out;
+  TEST_ASSERT_TRUE(lp::parseHello(buf, n, out));
+  TEST_ASSERT_EQUAL_UINT8(lp::HELLO_CAP_BINARY_INVOCATION | lp::HELLO_CAP_BINARY_CONTROL_OP,
+                          out.caps);
+  TEST_ASSERT_EQUAL_UINT32(7, out.invocationSchema);
+  TEST_ASSERT_TRUE(out.hasHealth);
+}
+
+void test_hello_health_round_trip() {
+  lp::HelloHealth health;
+  health.frameP99Us = 23450;  // carried in 100 us units, rounded up
+  health.frameDrops = 12;
+  health.slotDrops = 3;
+  health.heapLowKb = 61;
+  health.heapLargestKb = 28;
+  health.relayPerMin = 140;
+  uint8_t buf[lp::HELLO_MAX_SIZE];
+  const size_t n = lp::buildHello(buf, sizeof(buf), 25, kSrcMac,
+                                  kHelloShade, kHelloBase, 0xBEEF,
+                                  "hp", 2, lp::kOtaStateIdle,
+                                  nullptr, nullptr, 0, false, nullptr,
+                                  lp::LampVariant::Unknown, 0, 0, &health);
+  TEST_ASSERT_EQUAL_UINT32(lp::HELLO_FIXED_SIZE + 1 + 2 + 1 + 2 + lp::HELLO_HEALTH_LEN, n);
+  lp::ParsedHello out;
+  TEST_ASSERT_TRUE(lp::parseHello(buf, n, out));
+  TEST_ASSERT_TRUE(out.hasHealth);
+  TEST_ASSERT_EQUAL_UINT32(23500, out.health.frameP99Us);
+  TEST_ASSERT_EQUAL_UINT16(12, out.health.frameDrops);
+  TEST_ASSERT_EQUAL_UINT16(3, out.health.slotDrops);
+  TEST_ASSERT_EQUAL_UINT16(61, out.health.heapLowKb);
+  TEST_ASSERT_EQUAL_UINT16(28, out.health.heapLargestKb);
+  TEST_ASSERT_EQUAL_UINT16(140, out.health.relayPerMin);
+
+  // A stalled lamp's p99 saturates rather than wrapping.
+  health.frameP99Us = 10000000;
+  uint8_t v[lp::HELLO_HEALTH_LEN];
+  lp::encodeHelloHealth(health, v);
+  lp::HelloHealth back;
+  lp::decodeHelloHealth(v, back);
+  TEST_ASSERT_EQUAL_UINT32(0xFFFFu * 100, back.frameP99Us);
+}
+
+void test_hello_absent_health_is_false() {
+  uint8_t buf[lp::HELLO_MAX_SIZE];
+  const size_t n = lp::buildHello(buf, sizeof(buf), 26, kSrcMac,
+                                  kHelloShade, kHelloBase, 0xBEEF,
+                                  "old", 3, lp::kOtaStateIdle);
+  lp::ParsedHello out;
+  out.hasHealth = true;
+  TEST_ASSERT_TRUE(lp::parseHello(buf, n, out));
+  TEST_ASSERT_FALSE(out.hasHealth);
+}
+
 // A malformed trailer (TLV claims more bytes than the frame holds)
 // must be rejected, not crash.
 void test_hello_tlv_with_oversized_length_is_rejected() {
@@ -727,6 +824,11 @@ int main(int argc, char** argv) {
   RUN_TEST(test_hello_absent_ota_sending_to_is_false);
   RUN_TEST(test_hello_variant_round_trip);
   RUN_TEST(test_hello_absent_variant_is_unknown);
+  RUN_TEST(test_hello_caps_round_trip);
+  RUN_TEST(test_hello_absent_caps_is_zero);
+  RUN_TEST(test_hello_health_round_trip);
+  RUN_TEST(test_hello_absent_health_is_false);
+  RUN_TEST(test_hello_all_tlvs_fit_max_size);
   RUN_TEST(test_hello_unknown_tlv_is_skipped);
   RUN_TEST(test_hello_tlv_with_oversized_length_is_rejected);
 
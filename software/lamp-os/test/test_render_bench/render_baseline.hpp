@@ -0,0 +1,47 @@
+#pragma once
+// Checked-in render budgets for test_render_bench. One row per scripted
+// scenario; render_bench.cpp fails when a measured frame exceeds its row.
+//
+// The counters are exact and host-independent (same sources, same virtual
+// clock, same seeds), so they are pinned tight: a new per-frame heap
+// allocation or an extra strip write is a regression even when it is cheap.
+// Frame time is host CPU time, not ESP32 time, so its ceilings carry wide
+// slack over a typical dev-machine run to stay green on a loaded CI box; they
+// catch order-of-magnitude regressions (an accidental O(n^2) pass, a per-pixel
+// std::map lookup), not a few percent.
+//
+// To re-baseline after an intentional change, run the bench, read the
+// "[bench]" report lines and update the matching row in the same commit.
+
+#include <cstdint>
+#include <cstring>
+
+namespace bench {
+
+struct RenderBaseline {
+  const char* scenario;
+  uint32_t maxAllocsPerFrame;    // operator new calls inside one tick()
+  uint32_t maxPixelWritesPerFrame;  // pixels encoded to a driver, summed
+  uint32_t maxShowsPerFrame;     // show() calls, summed over drivers
+  uint32_t maxMeanFrameUs;       // host CPU, mean over the measured window
+  uint32_t maxWorstFrameUs;      // host CPU, single slowest measured frame
+};
+
+inline constexpr RenderBaseline kRenderBaselines[] = {
+  // scenario       allocs  writes  shows  meanUs  worstUs
+  {"idle",               0,      0,     0,    100,   10000},
+  {"expressions",        0,     90,     3,   1000,   10000},
+  {"wisp_fade",          0,     90,     3,    200,   10000},
+  {"greeting",           0,     18,     1,    200,   10000},
+  // Quiet entry snapshots the frozen shade + base frames once (2 allocs).
+  {"ota_quiet",          2,     40,     1,    200,   10000},
+};
+
+inline const RenderBaseline* findBaseline(const char* scenario) {
+  for (const RenderBaseline& b : kRenderBaselines) {
+    if (std::strcmp(b.scenario, scenario) == 0) return &b;
+  }
+  return nullptr;
+}
+
+}  // namespace bench
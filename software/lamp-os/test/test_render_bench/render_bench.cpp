@@ -0,0 +1,446 @@
+// Headless render bench for the Compositor. Boots a real lamp::Compositor
+// over real FrameBuffers backed by the recording Adafruit_NeoPixel stub,
+// drives tick() off the virtual millis() clock one MINIMUM_FRAME_DRAW_TIME_MS
+// step per frame, and runs scripted scenarios through the production render
+// path: idle, every registered expression at once, the wisp paint fade, a
+// social greeting and the OTA quiet-mode indicator.
+//
+// Per scenario it reports per-frame CPU time, per-behavior control()/draw()
+// cost and heap allocations per frame, then fails when a frame exceeds the
+// checked-in budgets in render_baseline.hpp. The allocation and strip-write
+// counts are deterministic; frame time is host CPU and only guards against
+// order-of-magnitude regressions (see render_baseline.hpp).
+//
+// Production code: src/core/compositor.{hpp,cpp}, src/core/frame_buffer.cpp,
+// the behaviors and expressions included below.
+
+#include <unity.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../../src/behaviors/configurator.cpp"
+#include "../../src/behaviors/fade_in.cpp"
+#include "../../src/behaviors/idle.cpp"
+#include "../../src/components/firmware/ota_indicator.cpp"
+#include "../../src/components/firmware/ota_quiet_mode.cpp"
+#include "../../src/components/network/mesh/lamp_roster.cpp"
+#include "../../src/components/transient_override/color_override.cpp"
+#include "../../src/core/animated_behavior.cpp"
+#include "../../src/core/compositor.cpp"
+#include "../../src/core/frame_buffer.cpp"
+#include "../../src/expressions/bloom/bloom_expression.cpp"
+#include "../../src/expressions/breathing/breathing_expression.cpp"
+#include "../../src/expressions/expression.cpp"
+#include "../../src/expressions/expression_registry.cpp"
+#include "../../src/expressions/glitchy/glitchy_expression.cpp"
+#include "../../src/expressions/pulse/pulse_expression.cpp"
+#include "../../src/expressions/shifty/shifty_expression.cpp"
+#include "../../src/expressions/shimmer/shimmer_expression.cpp"
+#include "../../src/expressions/spotty/spotty_expression.cpp"
+#include "../../src/lamps/lioness/lions_greeting_behavior.cpp"
+#include "../../src/util/color.cpp"
+#include "../../src/util/fade.cpp"
+#include "../../src/util/gradient.cpp"
+#include "../../src/util/gradient_cache.cpp"
+#include "expressions/expr_variant_sets.hpp"
+#include "render_baseline.hpp"
+
+using namespace lamp;
+
+// ---- allocation counter -------------------------------------------------
+// Counts every global operator new while armed. Armed only around
+// Compositor::tick() so bench bookkeeping never shows up in the figures.
+// Backed by malloc, which the default operator delete pairs with.
+
+namespace {
+std::atomic<bool> g_countAllocs{false};
+std::atomic<uint32_t> g_allocs{0};
+}  // namespace
+
+void* operator new(std::size_t n) {
+  if (g_countAllocs.load(std::memory_order_relaxed)) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) { return ::operator new(n); }
+
+// ---- production seams ---------------------------------------------------
+// The firmware state machines and the mesh/manager plumbing live in ESP-only
+// translation units. The bench never runs an OTA session or a cascade, so
+// the seams report idle.
+
+FirmwareReceiver firmwareReceiver;
+
+namespace lamp {
+FirmwareDistributor firmwareDistributor;
+bool FirmwareDistributor::isInProgress() const { return false; }
+bool FirmwareDistributor::getLastSession(uint8_t*, uint16_t&) const { return false; }
+
+OverrideAggregate overrides;
+void ExpressionManager::onExpressionFired(Expression*) {}
+bool ExpressionManager::triggerExpression(const std::string&) { return false; }
+bool ExpressionManager::triggerInvocation(const ExpressionInvocation&,
+                                          const uint8_t*, bool) { return false; }
+}  // namespace lamp
+
+namespace {
+
+struct FakePeer {
+  uint8_t mac[6];
+  Color base;
+  const char* lampId;
+};
+std::vector<FakePeer> g_arrivals;
+
+}  // namespace
+
+namespace lamp {
+void BehaviorContext::forEachNearby(const std::function<bool(const PeerView&)>&) {}
+void BehaviorContext::forEachArrival(uint32_t,
+                                     const std::function<bool(const PeerView&)>& cb) {
+  if (g_arrivals.empty()) return;
+  const FakePeer& fp = g_arrivals.front();
+  PeerView pv;
+  pv.mac = fp.mac;
+  pv.hasMac = true;
+  pv.baseColor = fp.base;
+  std::strncpy(pv.lampId, fp.lampId, sizeof(pv.lampId) - 1);
+  if (cb(pv)) g_arrivals.erase(g_arrivals.begin());
+}
+}  // namespace lamp
+
+// ---- per-behavior timing ------------------------------------------------
+
+namespace {
+
+using BenchClock = std::chrono::steady_clock;
+
+inline uint64_t elapsedNs(BenchClock::time_point t0) {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(BenchClock::now() - t0)
+          .count());
+}
+
+struct BehaviorCost {
+  std::string label;
+  uint64_t controlNs = 0;
+  uint64_t drawNs = 0;
+  uint32_t controls = 0;
+  uint32_t draws = 0;
+};
+
+// Times control()/draw() of a concrete behavior. A subclass rather than a
+// forwarding wrapper so pointer identity holds: the compositor compares its
+// entries against context_.baseConfigurator to place the wisp composite.
+template <class B>
+class Timed : public B {
+ public:
+  using B::B;
+  BehaviorCost cost;
+
+  void control() override {
+    const auto t0 = BenchClock::now();
+    B::control();
+    cost.controlNs += elapsedNs(t0);
+    cost.controls++;
+  }
+  void draw() override {
+    const auto t0 = BenchClock::now();
+    B::draw();
+    cost.drawNs += elapsedNs(t0);
+    cost.draws++;
+  }
+};
+
+// Shade 40px on one driver; base is the lioness layout (Main 32 + Lions 18)
+// so the greeting scenario has its slice. 90 pixels over three drivers.
+constexpr uint16_t kShadePx = 40;
+constexpr uint16_t kMainPx = 32;
+constexpr uint16_t kLionsPx = 18;
+constexpr uint32_t kWarmupFrames = 120;
+constexpr uint32_t kMeasuredFrames = 600;
+
+const Color kShadeColor(0xFF, 0x60, 0x10, 0x20);
+const Color kBaseColor(0x20, 0x10, 0xC0, 0x00);
+
+struct Rig {
+  Adafruit_NeoPixel neoShade;
+  Adafruit_NeoPixel neoMain;
+  Adafruit_NeoPixel neoLions;
+  FrameBuffer shade;
+  FrameBuffer base;
+  Compositor compositor;
+  std::vector<std::unique_ptr<AnimatedBehavior>> owned;
+  std::vector<BehaviorCost*> costs;
+  Timed<ConfiguratorBehavior>* shadeConfigurator = nullptr;
+  Timed<ConfiguratorBehavior>* baseConfigurator = nullptr;
+
+  template <class B, class... Args>
+  Timed<B>* make(const std::string& label, Args&&... args) {
+    auto* b = new Timed<B>(std::forward<Args>(args)...);
+    b->cost.label = label;
+    owned.emplace_back(b);
+    costs.push_back(&b->cost);
+    return b;
+  }
+
+  std::vector<Adafruit_NeoPixel*> drivers() {
+    return {&neoShade, &neoMain, &neoLions};
+  }
+};
+
+// Boots the lamp the way initBehaviors does: configurators as the base scene,
+// one idle underlay and one fade-in per surface, then runs the startup fade
+// on the virtual clock until the compositor hands over to the behavior stack.
+void bootRig(Rig& rig) {
+  set_mock_millis(0);
+  rig.shade.begin(std::vector<Color>(kShadePx, kShadeColor),
+                  std::vector<StripSegment>{{&rig.neoShade, "Shade", 0, kShadePx}});
+  rig.base.begin(std::vector<Color>(kMainPx + kLionsPx, kBaseColor),
+                 std::vector<StripSegment>{{&rig.neoMain, "Main", 0, kMainPx},
+                                           {&rig.neoLions, "Lions", kMainPx, kLionsPx}});
+
+  rig.shadeConfigurator = rig.make<ConfiguratorBehavior>("configurator/shade", &rig.shade, 120);
+  rig.shadeConfigurator->colors = rig.shade.defaultColors;
+  rig.baseConfigurator = rig.make<ConfiguratorBehavior>("configurator/base", &rig.base, 120);
+  rig.baseConfigurator->colors = rig.base.defaultColors;
+
+  std::vector<AnimatedBehavior*> underlay = {
+      rig.make<IdleBehavior>("idle/shade", &rig.shade, 0, true),
+      rig.make<IdleBehavior>("idle/base", &rig.base, 0, true)};
+  std::vector<AnimatedBehavior*> startup = {
+      rig.make<FadeInBehavior>("fade_in/shade", &rig.shade, STARTUP_ANIMATION_FRAMES),
+      rig.make<FadeInBehavior>("fade_in/base", &rig.base, STARTUP_ANIMATION_FRAMES)};
+
+  rig.compositor.begin({rig.baseConfigurator, rig.shadeConfigurator},
+                       {&rig.shade, &rig.base}, underlay, startup);
+  rig.compositor.setExpressionBand(2, 2);
+  BehaviorContext& ctx = rig.compositor.behaviorContext();
+  ctx.expressionFrameBuffers = {&rig.shade, &rig.base};
+  ctx.baseConfigurator = rig.baseConfigurator;
+  ctx.shadeConfigurator = rig.shadeConfigurator;
+
+  while (!rig.compositor.startupComplete) {
+    set_mock_millis(millis() + MINIMUM_FRAME_DRAW_TIME_MS);
+    rig.compositor.tick();
+  }
+}
+
+struct FrameStats {
+  uint32_t frames = 0;
+  uint64_t totalNs = 0;
+  uint64_t worstNs = 0;
+  uint32_t maxAllocs = 0;
+  uint64_t totalAllocs = 0;
+  uint32_t maxPixelWrites = 0;
+  uint32_t maxShows = 0;
+};
+
+// One frame: advance the clock a full frame slot so every tick() both
+// computes and flushes, and count what the tick did.
+void stepFrame(Rig& rig, FrameStats* stats) {
+  set_mock_millis(millis() + MINIMUM_FRAME_DRAW_TIME_MS);
+  for (Adafruit_NeoPixel* d : rig.drivers()) d->reset();
+
+  g_allocs.store(0, std::memory_order_relaxed);
+  g_countAllocs.store(true, std::memory_order_relaxed);
+  const auto t0 = BenchClock::now();
+  rig.compositor.tick();
+  const uint64_t ns = elapsedNs(t0);
+  g_countAllocs.store(false, std::memory_order_relaxed);
+
+  if (!stats) return;
+  uint32_t writes = 0;
+  uint32_t shows = 0;
+  for (Adafruit_NeoPixel* d : rig.drivers()) {
+    writes += d->writtenPixels(Adafruit_NeoPixel::kMaxPixels, 4);
+    shows += static_cast<uint32_t>(d->showCount);
+  }
+  const uint32_t allocs = g_allocs.load(std::memory_order_relaxed);
+  stats->frames++;
+  stats->totalNs += ns;
+  if (ns > stats->worstNs) stats->worstNs = ns;
+  stats->totalAllocs += allocs;
+  if (allocs > stats->maxAllocs) stats->maxAllocs = allocs;
+  if (writes > stats->maxPixelWrites) stats->maxPixelWrites = writes;
+  if (shows > stats->maxShows) stats->maxShows = shows;
+}
+
+// Runs warm-up (first-touch vector growth, fade/ease settling in) unmeasured,
+// then the measured window; `script` runs before each frame, outside the
+// timed region, to feed the scenario's inputs.
+FrameStats runScenario(Rig& rig, const std::function<void(uint32_t)>& script) {
+  for (uint32_t f = 0; f < kWarmupFrames; ++f) {
+    script(f);
+    stepFrame(rig, nullptr);
+  }
+  for (BehaviorCost* c : rig.costs) *c = BehaviorCost{c->label};
+  FrameStats stats;
+  for (uint32_t f = 0; f < kMeasuredFrames; ++f) {
+    script(kWarmupFrames + f);
+    stepFrame(rig, &stats);
+  }
+  return stats;
+}
+
+void reportAndCheck(const char* scenario, const Rig& rig, const FrameStats& s) {
+  const bench::RenderBaseline* base = bench::findBaseline(scenario);
+  TEST_ASSERT_NOT_NULL_MESSAGE(base, "scenario missing from render_baseline.hpp");
+  TEST_ASSERT_EQUAL_UINT32(kMeasuredFrames, s.frames);
+
+  const uint32_t meanUs = static_cast<uint32_t>(s.totalNs / s.frames / 1000);
+  const uint32_t worstUs = static_cast<uint32_t>(s.worstNs / 1000);
+  std::printf("[bench] %-12s frames=%u meanUs=%u worstUs=%u allocs/frame max=%u "
+              "total=%llu writes/frame max=%u shows/frame max=%u\n",
+              scenario, (unsigned)s.frames, (unsigned)meanUs, (unsigned)worstUs,
+              (unsigned)s.maxAllocs, (unsigned long long)s.totalAllocs,
+              (unsigned)s.maxPixelWrites, (unsigned)s.maxShows);
+  for (const BehaviorCost* c : rig.costs) {
+    if (c->controls == 0 && c->draws == 0) continue;
+    std::printf("[bench]   %-22s control=%6.2fus x%-4u draw=%6.2fus x%u\n",
+                c->label.c_str(),
+                c->controls ? c->controlNs / 1000.0 / c->controls : 0.0,
+                (unsigned)c->controls,
+                c->draws ? c->drawNs / 1000.0 / c->draws : 0.0,
+                (unsigned)c->draws);
+  }
+
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32_MESSAGE(base->maxAllocsPerFrame, s.maxAllocs,
+                                           "heap allocation inside tick()");
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32_MESSAGE(base->maxPixelWritesPerFrame,
+                                           s.maxPixelWrites, "pixels encoded");
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32_MESSAGE(base->maxShowsPerFrame, s.maxShows,
+                                           "show() calls");
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32_MESSAGE(base->maxMeanFrameUs, meanUs,
+                                           "mean frame time");
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32_MESSAGE(base->maxWorstFrameUs, worstUs,
+                                           "worst frame time");
+}
+
+}  // namespace
+
+void setUp() {
+  g_arrivals.clear();
+  overrides = OverrideAggregate{};
+}
+void tearDown() {}
+
+// Steady state: configurators hold the saved colors, nothing animates. The
+// frame-buffer dedup should keep the strips quiet.
+void test_idle() {
+  Rig rig;
+  bootRig(rig);
+  const FrameStats s = runScenario(rig, [](uint32_t) {});
+  reportAndCheck("idle", rig, s);
+}
+
+// Every expression the largest variant registers, on both surfaces, firing
+// back-to-back (zero interval) so each is mid-animation for the whole window.
+void test_all_expressions() {
+  Rig rig;
+  bootRig(rig);
+
+  struct Entry {
+    const ExpressionDescriptor* descriptor;
+    Expression* (*makeTimed)(Rig&, FrameBuffer*);
+  };
+  const std::vector<Entry> entries = {
+#define BENCH_EXPR_ENTRY(Name)                                              \
+  {&Name##Expression::classDescriptor(), [](Rig& r, FrameBuffer* fb) -> Expression* { \
+     return r.make<Name##Expression>(                                       \
+         std::string(Name##Expression::classDescriptor().id) +              \
+             (fb == &r.shade ? "/shade" : "/base"),                         \
+         fb);                                                               \
+   }},
+      LAMPOS_STAFF_EXPRESSIONS(BENCH_EXPR_ENTRY)
+#undef BENCH_EXPR_ENTRY
+  };
+
+  ExpressionRegistry registry;
+  for (const Entry& e : entries) registry.add(*e.descriptor);
+  TEST_ASSERT_EQUAL_UINT32(entries.size(), registry.all().size());
+
+  const std::vector<Color> palette = {Color(0xFF, 0, 0, 0), Color(0, 0xFF, 0x40, 0),
+                                      Color(0x10, 0x20, 0xFF, 0x08)};
+  for (const Entry& e : entries) {
+    for (FrameBuffer* fb : {&rig.shade, &rig.base}) {
+      Expression* expr = e.makeTimed(rig, fb);
+      expr->configure(palette, 0, 0, TARGET_BOTH);
+      ParamSet params;
+      registry.applyDefaults(*e.descriptor, params, fb->pixelCount);
+      expr->configureFromParameters(params);
+      rig.compositor.addBehavior(expr);
+    }
+  }
+
+  const FrameStats s = runScenario(rig, [](uint32_t) {});
+  reportAndCheck("expressions", rig, s);
+}
+
+// Wisp STATE arrives, holds, then a fresh STATE drops this lamp: presence
+// eases in, the color eases to a second paint, then everything eases home.
+void test_wisp_fade() {
+  Rig rig;
+  bootRig(rig);
+  Compositor& c = rig.compositor;
+  const FrameStats s = runScenario(rig, [&c](uint32_t f) {
+    if (f == 0) c.applyWispState(Color(0, 0xC0, 0x30, 0), Color(0xC0, 0, 0x60, 0), millis());
+    if (f == 240) c.applyWispState(Color(0xF0, 0x80, 0, 0), Color(0, 0x40, 0xF0, 0), millis());
+    if (f == 480) c.clearWispState(millis());
+  });
+  reportAndCheck("wisp_fade", rig, s);
+}
+
+// Lioness arrival greeting over the base scene; a new arrival is queued each
+// time the previous greeting finishes so the pulse runs the whole window.
+void test_greeting() {
+  Rig rig;
+  bootRig(rig);
+  auto* greeting = rig.make<lioness::LionsGreetingBehavior>("lions_greeting", &rig.base);
+  rig.compositor.addBehavior(greeting);
+  const FrameStats s = runScenario(rig, [greeting](uint32_t f) {
+    if (greeting->animationState == STOPPED && g_arrivals.empty()) {
+      FakePeer p{{0x02, 0, 0, 0, 0, static_cast<uint8_t>(f)},
+                 Color(0xF0, 0x30, 0, 0), "02:00:00:00:00:01"};
+      g_arrivals.push_back(p);
+    }
+  });
+  reportAndCheck("greeting", rig, s);
+}
+
+// Visible OTA quiet mode entered at the start of the measured window: the
+// compositor skips the behavior stack and paints the indicator, settling the
+// frozen frame into the dim surface.
+void test_ota_quiet() {
+  Rig rig;
+  bootRig(rig);
+  const FrameStats s = runScenario(rig, [](uint32_t f) {
+    if (f == kWarmupFrames) {
+      ota_quiet_mode::enterQuiet(/*tearDownRadio=*/false, /*visible=*/true);
+    }
+  });
+  ota_quiet_mode::exitQuiet();
+  reportAndCheck("ota_quiet", rig, s);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_idle);
+  RUN_TEST(test_all_expressions);
+  RUN_TEST(test_wisp_fade);
+  RUN_TEST(test_greeting);
+  RUN_TEST(test_ota_quiet);
+  return UNITY_END();
+}
@@ -0,0 +1,227 @@
+// Native-host tests for the Core 0 → Core 1 mesh receive queue.
+//
+// Pins:
+//   1. SpscFrameRing: FIFO order, in-place wrap past the end of the array,
+//      refuse-when-full (queued frames are never overwritten), scan() frees
+//      nothing, drain(max) frees only what it walked.
+//   2. RxFrameQueue: a burst of frames of one type is delivered whole (the
+//      PendingTypedSlot it replaced kept only the newest), frames are
+//      trimmed to their policy size, NewestPerSource coalesces within one
+//      batch only.
+//   3. a producer thread and a consumer thread hammering the ring lose or
+//      reorder nothing that push() accepted.
+//
+// Production code: src/core/spsc_frame_ring.hpp, src/core/rx_frame_queue.hpp.
+
+#include <unity.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "core/rx_frame_queue.hpp"
+
+namespace lamp {
+
+// Test DTOs shaped like the production ones (leading sourceMac, trimmed
+// payload), so the policy machinery runs without the mesh headers.
+struct TestCommand {
+  uint8_t sourceMac[6];
+  uint16_t payloadLen;
+  uint8_t payload[200];
+};
+struct TestQuery {
+  uint8_t sourceMac[6];
+};
+
+template <>
+struct RxFramePolicy<TestCommand> {
+  static constexpr uint8_t kTag = 1;
+  static constexpr RxCoalesce kCoalesce = RxCoalesce::None;
+  static size_t bytes(const TestCommand& v) { return offsetof(TestCommand, payload) + v.payloadLen; }
+};
+template <>
+struct RxFramePolicy<TestQuery> {
+  static constexpr uint8_t kTag = 2;
+  static constexpr RxCoalesce kCoalesce = RxCoalesce::NewestPerSource;
+  static size_t bytes(const TestQuery&) { return sizeof(TestQuery); }
+};
+
+}  // namespace lamp
+
+using namespace lamp;
+
+using Queue = RxFrameQueue<1024, TestCommand, TestQuery>;
+
+namespace {
+
+TestCommand command(uint8_t mac, uint8_t id, uint16_t len) {
+  TestCommand c{};
+  std::memset(c.sourceMac, mac, 6);
+  c.payloadLen = len;
+  for (uint16_t i = 0; i < len; i++) c.payload[i] = static_cast<uint8_t>(id + i);
+  return c;
+}
+
+TestQuery query(uint8_t mac) {
+  TestQuery q{};
+  std::memset(q.sourceMac, mac, 6);
+  return q;
+}
+
+}  // namespace
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_ring_fifo_and_wrap() {
+  SpscFrameRing<64> ring;
+  // 4 + 20 = 24 B per frame: the third push has 16 B left before the end and
+  // must wrap. Drain between pushes so space is there after the wrap.
+  uint8_t out[20];
+  for (uint8_t round = 0; round < 10; round++) {
+    uint8_t data[20];
+    std::memset(data, round, sizeof(data));
+    TEST_ASSERT_TRUE(ring.push(7, data, sizeof(data)));
+    size_t got = ring.drain([&](const RxFrame& f, size_t) {
+      TEST_ASSERT_EQUAL_UINT8(7, f.tag);
+      TEST_ASSERT_EQUAL_UINT16(20, f.len);
+      std::memcpy(out, f.data, f.len);
+    });
+    TEST_ASSERT_EQUAL_size_t(1, got);
+    for (uint8_t b : out) TEST_ASSERT_EQUAL_UINT8(round, b);
+  }
+  TEST_ASSERT_TRUE(ring.empty());
+}
+
+void test_ring_refuses_when_full_and_keeps_queued() {
+  SpscFrameRing<64> ring;
+  const uint8_t a[12] = {1}, b[12] = {2}, c[12] = {3}, d[12] = {4}, e[12] = {5};
+  TEST_ASSERT_TRUE(ring.push(1, a, 12));
+  TEST_ASSERT_TRUE(ring.push(1, b, 12));
+  TEST_ASSERT_TRUE(ring.push(1, c, 12));
+  TEST_ASSERT_TRUE(ring.push(1, d, 12));  // 4 x 16 B = full
+  TEST_ASSERT_FALSE(ring.push(1, e, 12));
+  TEST_ASSERT_EQUAL_UINT32(1, ring.dropped());
+  // Oversize and reserved-tag frames are refused too.
+  uint8_t big[SpscFrameRing<64>::kMaxFrameBytes + 1] = {};
+  TEST_ASSERT_FALSE(ring.push(1, big, sizeof(big)));
+  TEST_ASSERT_FALSE(ring.push(SpscFrameRing<64>::kWrapTag, a, 1));
+
+  std::vector<uint8_t> firsts;
+  ring.drain([&](const RxFrame& f, size_t) { firsts.push_back(f.data[0]); });
+  TEST_ASSERT_EQUAL_size_t(4, firsts.size());
+  for (size_t i = 0; i < 4; i++) TEST_ASSERT_EQUAL_UINT8(i + 1, firsts[i]);
+}
+
+void test_scan_frees_nothing_and_drain_honors_max() {
+  SpscFrameRing<256> ring;
+  for (uint8_t i = 0; i < 5; i++) ring.push(1, &i, 1);
+  TEST_ASSERT_EQUAL_size_t(5, ring.scan([](const RxFrame&, size_t) {}));
+  TEST_ASSERT_EQUAL_size_t(5, ring.scan([](const RxFrame&, size_t) {}));
+  std::vector<uint8_t> seen;
+  TEST_ASSERT_EQUAL_size_t(2, ring.drain([&](const RxFrame& f, size_t) { seen.push_back(f.data[0]); }, 2));
+  TEST_ASSERT_EQUAL_size_t(3, ring.drain([&](const RxFrame& f, size_t) { seen.push_back(f.data[0]); }));
+  TEST_ASSERT_EQUAL_size_t(5, seen.size());
+  for (uint8_t i = 0; i < 5; i++) TEST_ASSERT_EQUAL_UINT8(i, seen[i]);
+}
+
+// The failure this replaces: a cascade fan-in posting several commands
+// between two loop ticks kept only the last.
+void test_command_burst_is_delivered_whole() {
+  static Queue q;
+  for (uint8_t i = 0; i < 6; i++) TEST_ASSERT_TRUE(q.post(command(0x10 + i, i, 20)));
+  std::vector<uint8_t> macs;
+  const size_t n = q.drain([&](const RxFrame& f) {
+    TestCommand c;
+    TEST_ASSERT_TRUE(Queue::load(f, c));
+    TEST_ASSERT_EQUAL_UINT16(20, c.payloadLen);
+    TEST_ASSERT_EQUAL_UINT8(c.sourceMac[0] - 0x10 + 19, c.payload[19]);
+    macs.push_back(c.sourceMac[0]);
+  });
+  TEST_ASSERT_EQUAL_size_t(6, n);
+  for (uint8_t i = 0; i < 6; i++) TEST_ASSERT_EQUAL_UINT8(0x10 + i, macs[i]);
+  TEST_ASSERT_TRUE(q.empty());
+}
+
+void test_frames_are_trimmed_to_policy_bytes() {
+  static Queue q;
+  q.post(command(1, 0, 3));
+  q.drain([&](const RxFrame& f) {
+    TEST_ASSERT_EQUAL_UINT16(offsetof(TestCommand, payload) + 3, f.len);
+    TestQuery wrongType;
+    TEST_ASSERT_FALSE(Queue::load(f, wrongType));
+  });
+}
+
+void test_newest_per_source_coalesces_within_batch() {
+  static Queue q;
+  q.post(query(0xA));
+  q.post(command(0xA, 1, 4));  // other tag, same mac: not coalesced with queries
+  q.post(query(0xB));
+  q.post(query(0xA));
+  std::vector<uint8_t> order;  // tag * 16 + mac
+  TEST_ASSERT_EQUAL_size_t(3, q.drain([&](const RxFrame& f) {
+    order.push_back(static_cast<uint8_t>(f.tag * 16 + f.data[0]));
+  }));
+  TEST_ASSERT_EQUAL_size_t(3, order.size());
+  TEST_ASSERT_EQUAL_UINT8(0x1A, order[0]);  // command
+  TEST_ASSERT_EQUAL_UINT8(0x2B, order[1]);  // query from B
+  TEST_ASSERT_EQUAL_UINT8(0x2A, order[2]);  // newest query from A, in its slot
+
+  // The next batch starts fresh: one more query from A is delivered.
+  q.post(query(0xA));
+  TEST_ASSERT_EQUAL_size_t(1, q.drain([](const RxFrame&) {}));
+}
+
+void test_two_thread_stress_loses_nothing_accepted() {
+  static SpscFrameRing<512> ring;
+  constexpr uint32_t kFrames = 200000;
+  std::atomic<bool> done{false};
+  std::vector<uint32_t> accepted;
+  accepted.reserve(kFrames);
+  std::thread producer([&] {
+    for (uint32_t i = 0; i < kFrames; i++) {
+      // Vary the length so frames wrap at every offset.
+      uint8_t data[40];
+      const size_t len = 4 + (i % 37);
+      std::memcpy(data, &i, 4);
+      std::memset(data + 4, static_cast<uint8_t>(i), len - 4);
+      if (ring.push(static_cast<uint8_t>(1 + (i & 3)), data, len)) accepted.push_back(i);
+    }
+    done.store(true, std::memory_order_release);
+  });
+  std::vector<uint32_t> received;
+  received.reserve(kFrames);
+  bool bad = false;
+  auto consume = [&](const RxFrame& f, size_t) {
+    uint32_t id;
+    std::memcpy(&id, f.data, 4);
+    if (f.tag != 1 + (id & 3) || f.len != 4 + (id % 37)) bad = true;
+    for (size_t k = 4; k < f.len; k++) {
+      if (f.data[k] != static_cast<uint8_t>(id)) bad = true;
+    }
+    received.push_back(id);
+  };
+  while (!done.load(std::memory_order_acquire)) ring.drain(consume);
+  ring.drain(consume);
+  producer.join();
+  TEST_ASSERT_FALSE(bad);
+  TEST_ASSERT_EQUAL_size_t(accepted.size(), received.size());
+  TEST_ASSERT_TRUE(accepted == received);
+  TEST_ASSERT_EQUAL_UINT32(kFrames - accepted.size(), ring.dropped());
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_ring_fifo_and_wrap);
+  RUN_TEST(test_ring_refuses_when_full_and_keeps_queued);
+  RUN_TEST(test_scan_frees_nothing_and_drain_honors_max);
+  RUN_TEST(test_command_burst_is_delivered_whole);
+  RUN_TEST(test_frames_are_trimmed_to_policy_bytes);
+  RUN_TEST(test_newest_per_source_coalesces_within_batch);
+  RUN_TEST(test_two_thread_stress_loses_nothing_accepted);
+  return UNITY_END();
+}
@@ -0,0 +1,224 @@
+// Native-host tests for revisioned BLE page reads (section_delta.hpp).
+//
+//  1. Request parsing: "name@rev" splits, a bare name stays bare, and a
+//     malformed rev is not treated as revisioned.
+//  2. Whole-value envelope: not-modified is just the rev; a changed rev
+//     wraps the body, paged through PageSource across part boundaries.
+//  3. SectionDeltaIndex: unchanged entries keep their rev across rebuilds,
+//     a delta carries every key but only the changed entries, removals show
+//     as a missing key, and retire() keeps history for a reconnect.
+
+#include <unity.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "components/network/ble/section_delta.hpp"
+
+using ble_control::PageSource;
+using ble_control::SectionDeltaIndex;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+namespace {
+
+struct Entry {
+  std::string key;
+  std::string body;  // app-visible fields, hashed
+};
+
+uint32_t fnv(const std::string& s) {
+  uint32_t h = 2166136261u;
+  for (unsigned char c : s) h = (h ^ c) * 16777619u;
+  return h;
+}
+
+// Builds an array JSON the way buildNearbyJson does, staging each entry.
+std::string build(SectionDeltaIndex& index, const std::vector<Entry>& entries) {
+  std::string out = "[";
+  index.begin();
+  for (size_t i = 0; i < entries.size(); i++) {
+    if (i) out += ',';
+    const size_t off = out.size();
+    out += "{\"k\":\"";
+    const size_t keyOff = out.size();
+    out += entries[i].key;
+    out += "\",\"v\":\"";
+    out += entries[i].body;
+    out += "\"}";
+    index.add(off, out.size() - off, keyOff, entries[i].key.size(),
+              fnv(entries[i].key), fnv(entries[i].body));
+  }
+  out += ']';
+  return out;
+}
+
+std::string delta(const SectionDeltaIndex& index, const std::string& json,
+                  uint32_t since) {
+  std::string out;
+  index.appendDelta(json, since, out);
+  return out;
+}
+
+std::string drain(const PageSource& src, size_t chunk) {
+  std::string out;
+  for (size_t off = 0; off < src.size(); off += chunk) {
+    const size_t take = std::min(chunk, src.size() - off);
+    char buf[64];
+    if (const char* p = src.contiguous(off, take)) {
+      out.append(p, take);
+    } else {
+      TEST_ASSERT_EQUAL_UINT32(take, src.copy(off, buf, take));
+      out.append(buf, take);
+    }
+  }
+  return out;
+}
+
+}  // namespace
+
+void test_parse_revisioned_request() {
+  std::string_view name;
+  uint32_t rev = 7;
+  TEST_ASSERT_TRUE(ble_control::parseRevisionedRequest("nearby@42", name, rev));
+  TEST_ASSERT_TRUE(name == "nearby");
+  TEST_ASSERT_EQUAL_UINT32(42, rev);
+
+  TEST_ASSERT_TRUE(ble_control::parseRevisionedRequest("expr@4294967295", name, rev));
+  TEST_ASSERT_EQUAL_UINT32(4294967295u, rev);
+
+  // Bare names and malformed revs fall through as the whole request.
+  TEST_ASSERT_FALSE(ble_control::parseRevisionedRequest("expr", name, rev));
+  TEST_ASSERT_TRUE(name == "expr");
+  TEST_ASSERT_FALSE(ble_control::parseRevisionedRequest("expr@", name, rev));
+  TEST_ASSERT_FALSE(ble_control::parseRevisionedRequest("expr@1x", name, rev));
+  TEST_ASSERT_FALSE(ble_control::parseRevisionedRequest("expr@4294967296", name, rev));
+  TEST_ASSERT_TRUE(name == "expr@4294967296");
+}
+
+void test_full_envelope_not_modified_and_changed() {
+  const std::string body = "{\"name\":\"lamp\",\"brightness\":40}";
+  const uint32_t rev = ble_control::sectionContentRev(body);
+  TEST_ASSERT_NOT_EQUAL(0, rev);
+
+  std::string head;
+  TEST_ASSERT_FALSE(ble_control::appendFullHead(head, rev, rev));
+  TEST_ASSERT_EQUAL_STRING(("{\"rev\":" + std::to_string(rev) + "}").c_str(),
+                           head.c_str());
+
+  head.clear();
+  TEST_ASSERT_TRUE(ble_control::appendFullHead(head, rev, 0));
+  const PageSource src{{head, body, ble_control::kFullTail}};
+  const std::string expect =
+      "{\"rev\":" + std::to_string(rev) + ",\"full\":" + body + "}";
+  TEST_ASSERT_EQUAL_UINT32(expect.size(), src.size());
+  // Chunk sizes that straddle the head/body/tail boundaries.
+  for (size_t chunk : {1u, 7u, 13u, 64u}) {
+    TEST_ASSERT_EQUAL_STRING(expect.c_str(), drain(src, chunk).c_str());
+  }
+}
+
+void test_delta_sends_only_changed_entries() {
+  SectionDeltaIndex index;
+  index.seed(100);
+  std::string json = build(index, {{"a", "1"}, {"b", "1"}, {"c", "1"}});
+  TEST_ASSERT_TRUE(index.commit(false));
+  const uint32_t r1 = index.rev();
+  TEST_ASSERT_EQUAL_UINT32(101, r1);
+
+  // An app holding nothing gets everything.
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"rev\":101,\"keys\":[\"a\",\"b\",\"c\"],\"upsert\":["
+      "{\"k\":\"a\",\"v\":\"1\"},{\"k\":\"b\",\"v\":\"1\"},{\"k\":\"c\",\"v\":\"1\"}]}",
+      delta(index, json, 0).c_str());
+  // Up to date: just the rev.
+  TEST_ASSERT_EQUAL_STRING("{\"rev\":101}", delta(index, json, r1).c_str());
+
+  // Rebuild with identical content: no bump.
+  json = build(index, {{"a", "1"}, {"b", "1"}, {"c", "1"}});
+  TEST_ASSERT_FALSE(index.commit(false));
+  TEST_ASSERT_EQUAL_UINT32(r1, index.rev());
+
+  // b changes, c leaves, d arrives.
+  json = build(index, {{"a", "1"}, {"b", "2"}, {"d", "1"}});
+  TEST_ASSERT_TRUE(index.commit(false));
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"rev\":102,\"keys\":[\"a\",\"b\",\"d\"],\"upsert\":["
+      "{\"k\":\"b\",\"v\":\"2\"},{\"k\":\"d\",\"v\":\"1\"}]}",
+      delta(index, json, r1).c_str());
+
+  // A removal alone still bumps; the app sees it as a missing key.
+  json = build(index, {{"a", "1"}, {"b", "2"}});
+  TEST_ASSERT_TRUE(index.commit(false));
+  TEST_ASSERT_EQUAL_STRING("{\"rev\":103,\"keys\":[\"a\",\"b\"],\"upsert\":[]}",
+                           delta(index, json, 102).c_str());
+}
+
+void test_forced_bump_keeps_entry_revs() {
+  SectionDeltaIndex index;
+  index.seed(10);
+  std::string json = build(index, {{"a", "1"}});
+  index.commit(false);
+  json = build(index, {{"a", "1"}});
+  TEST_ASSERT_TRUE(index.commit(true));
+  TEST_ASSERT_EQUAL_UINT32(12, index.rev());
+  TEST_ASSERT_EQUAL_STRING("{\"rev\":12,\"keys\":[\"a\"],\"upsert\":[]}",
+                           delta(index, json, 11).c_str());
+}
+
+void test_unknown_rev_gets_everything() {
+  SectionDeltaIndex index;
+  index.seed(500);
+  const std::string json = build(index, {{"a", "1"}});
+  index.commit(false);
+  // A rev from another boot, ahead of this one's range.
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"rev\":501,\"keys\":[\"a\"],\"upsert\":[{\"k\":\"a\",\"v\":\"1\"}]}",
+      delta(index, json, 90000).c_str());
+}
+
+void test_retire_serves_nothing_and_keeps_history() {
+  SectionDeltaIndex index;
+  index.seed(0);
+  std::string json = build(index, {{"a", "1"}, {"b", "1"}});
+  index.commit(false);
+  const uint32_t held = index.rev();
+
+  index.retire();
+  json = "[]";
+  TEST_ASSERT_EQUAL_STRING("{\"rev\":1,\"keys\":[],\"upsert\":[]}",
+                           delta(index, json, 0).c_str());
+
+  // Reconnect: a forced bump, and only b (changed while away) is resent.
+  json = build(index, {{"a", "1"}, {"b", "2"}});
+  TEST_ASSERT_TRUE(index.commit(true));
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"rev\":2,\"keys\":[\"a\",\"b\"],\"upsert\":[{\"k\":\"b\",\"v\":\"2\"}]}",
+      delta(index, json, held).c_str());
+}
+
+void test_delta_bound_covers_output() {
+  SectionDeltaIndex index;
+  index.seed(4000000000u);
+  const std::string json =
+      build(index, {{"AA:BB:CC:DD:EE:01", "x"}, {"AA:BB:CC:DD:EE:02", "y"}});
+  index.commit(false);
+  const std::string out = delta(index, json, 0);
+  TEST_ASSERT_TRUE(out.size() <= index.deltaBound(json));
+}
+
+int main(int argc, char** argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_parse_revisioned_request);
+  RUN_TEST(test_full_envelope_not_modified_and_changed);
+  RUN_TEST(test_delta_sends_only_changed_entries);
+  RUN_TEST(test_forced_bump_keeps_entry_revs);
+  RUN_TEST(test_unknown_rev_gets_everything);
+  RUN_TEST(test_retire_serves_nothing_and_keeps_history);
+  RUN_TEST(test_delta_bound_covers_output);
+  return UNITY_END();
+}
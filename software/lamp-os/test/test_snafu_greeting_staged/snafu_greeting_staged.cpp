@@ -15,7 +15,8 @@
 #include <functional>
 #include <string>
 #include <vector>
-#include <map>
+
+#include "expressions/param_set.hpp"
 
 // ---- Time control -------------------------------------------------------
 
@@ -42,7 +43,7 @@ struct ExpressionInvocation {
   std::string type;
   std::vector<Color> colors;
   uint8_t target = 3;
-  std::map<std::string, uint32_t> parameters;
+  lamp::ParamSet parameters;
   uint32_t delayMs = 0;
 };
 
@@ -0,0 +1,153 @@
+// Native microbenchmark + equivalence check for FrameBuffer's fused strip
+// encode (gamma x brightness table, written straight into the driver's wire
+// buffer) against the flush it replaced: whole-buffer compare, gamma8 per
+// channel, pack a uint32, then Adafruit setPixelColor unpacks it, scales by
+// brightness and shuffles the bytes into the strip's order.
+//
+// The legacy path is mirrored inline from Adafruit_NeoPixel::setPixelColor
+// (the stub only records calls) and reads gamma from a table, as the real
+// gamma8 does, so the timing compares like with like. Output must match
+// byte-for-byte for every byte order and brightness; timings are reported,
+// not asserted.
+//
+// Production code: src/core/frame_buffer.cpp.
+
+#include <unity.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "../../src/core/frame_buffer.cpp"
+
+using namespace lamp;
+using lampos::led::ByteOrder;
+
+namespace {
+
+constexpr uint16_t kPixels = 255;
+constexpr int kIterations = 2000;
+
+uint8_t g_gamma[256];
+
+void buildGamma() {
+  for (int v = 0; v < 256; v++) g_gamma[v] = Adafruit_NeoPixel::gamma8(static_cast<uint8_t>(v));
+}
+
+// Mirror of Adafruit setPixelColor(n, uint32_t): unpack, scale by the stored
+// brightness (b + 1, 0 = none), write at the NEO_* offsets. Out of line, as
+// the library's is.
+__attribute__((noinline)) void legacySetPixelColor(uint8_t* wire,
+                                                   const lampos::led::WireLayout& l,
+                                                   uint8_t stored, uint16_t n,
+                                                   uint32_t packed) {
+  uint8_t r = (uint8_t)(packed >> 16), g = (uint8_t)(packed >> 8), b = (uint8_t)packed;
+  uint8_t w = (uint8_t)(packed >> 24);
+  if (stored) {
+    r = (r * stored) >> 8;
+    g = (g * stored) >> 8;
+    b = (b * stored) >> 8;
+    w = (w * stored) >> 8;
+  }
+  uint8_t* p = wire + n * l.bytesPerPixel;
+  p[l.r] = r;
+  p[l.g] = g;
+  p[l.b] = b;
+  if (l.w != lampos::led::kNoWhiteByte) p[l.w] = w;
+}
+
+// Mirror of the pre-LUT flush body for one segment: gamma8 x4, pack, hand to
+// setPixelColor.
+void legacyEncode(const std::vector<Color>& buffer, ByteOrder order,
+                  uint8_t brightness, uint8_t* wire) {
+  const lampos::led::WireLayout l = lampos::led::wireLayout(order);
+  const uint8_t stored = static_cast<uint8_t>(brightness + 1);
+  for (uint16_t n = 0; n < buffer.size(); n++) {
+    const Color& c = buffer[n];
+    legacySetPixelColor(wire, l, stored, n,
+                        (uint32_t)((g_gamma[c.w] << 24) | (g_gamma[c.r] << 16) |
+                                   (g_gamma[c.g] << 8) | g_gamma[c.b]));
+  }
+}
+
+std::vector<Color> gradientFrame(uint32_t seed) {
+  std::vector<Color> out(kPixels);
+  for (uint16_t i = 0; i < kPixels; i++) {
+    const uint32_t v = (i * 2654435761u) ^ seed;
+    out[i] = Color(v & 0xFF, (v >> 8) & 0xFF, (v >> 16) & 0xFF, (v >> 24) & 0xFF);
+  }
+  return out;
+}
+
+}  // namespace
+
+void setUp() { buildGamma(); }
+void tearDown() {}
+
+void test_fused_encode_matches_legacy_bytes() {
+  const ByteOrder orders[] = {ByteOrder::GRBW, ByteOrder::GRB, ByteOrder::BGR};
+  const uint8_t levels[] = {0, 1, 64, 127, 200, 254, 255};
+  const std::vector<Color> frame = gradientFrame(0x5EED);
+
+  for (ByteOrder order : orders) {
+    for (uint8_t level : levels) {
+      Adafruit_NeoPixel neo;
+      FrameBuffer fb;
+      fb.begin({}, std::vector<StripSegment>{{&neo, "s", 0, kPixels, false, order}});
+      fb.setBrightness(level);
+      fb.buffer = frame;
+      fb.flush();
+
+      std::vector<uint8_t> expected(kPixels * 4, Adafruit_NeoPixel::kUnwritten);
+      legacyEncode(frame, order, level, expected.data());
+      TEST_ASSERT_EQUAL_UINT8_ARRAY(expected.data(), neo.pixels, expected.size());
+    }
+  }
+}
+
+// Every pixel changes every frame (alternating two frames), so both paths do
+// their full production job: the legacy flush mirror compares, encodes all
+// and copies previousBuffer; the real flush diffs, encodes and shows.
+void test_report_encode_cost() {
+  const std::vector<Color> frames[2] = {gradientFrame(0xC0FFEE), gradientFrame(0xBADF00D)};
+  Adafruit_NeoPixel neo;
+  FrameBuffer fb;
+  fb.begin({}, std::vector<StripSegment>{{&neo, "s", 0, kPixels}});
+  fb.setBrightness(180);
+  std::vector<uint8_t> wire(kPixels * 4);
+  std::vector<Color> legacyBuffer(kPixels);
+  std::vector<Color> legacyPrevious(kPixels);
+
+  using Clock = std::chrono::steady_clock;
+  const auto t0 = Clock::now();
+  for (int it = 0; it < kIterations; it++) {
+    legacyBuffer = frames[it & 1];
+    if (legacyBuffer == legacyPrevious) continue;
+    legacyEncode(legacyBuffer, ByteOrder::GRBW, 180, wire.data());
+    legacyPrevious = legacyBuffer;
+  }
+  const auto t1 = Clock::now();
+  for (int it = 0; it < kIterations; it++) {
+    fb.buffer = frames[it & 1];
+    fb.flush();
+  }
+  const auto t2 = Clock::now();
+
+  const double px = static_cast<double>(kIterations) * kPixels;
+  const double legacyNs =
+      std::chrono::duration<double, std::nano>(t1 - t0).count() / px;
+  const double fusedNs =
+      std::chrono::duration<double, std::nano>(t2 - t1).count() / px;
+  std::printf("[bench] strip flush GRBW %u px x %d: legacy=%.2f ns/px fused=%.2f ns/px\n",
+              (unsigned)kPixels, kIterations, legacyNs, fusedNs);
+  // Same bytes out of both (the equivalence test covers every order/level).
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(wire.data(), neo.pixels, wire.size());
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_fused_encode_matches_legacy_bytes);
+  RUN_TEST(test_report_encode_cost);
+  return UNITY_END();
+}
@@ -1,5 +1,6 @@
 #include <lampos/crypto.hpp>
 
+#include <algorithm>
 #include <cstring>
 
 #include <mbedtls/gcm.h>
@@ -40,51 +41,129 @@ bool deriveKey(const uint8_t* salt, size_t saltLen,
   return rc == 0;
 }
 
-}  // namespace
-
-bool decryptPayload(const uint8_t* p, size_t n,
-                    const uint8_t* uuidLE16, const char* name,
-                    const std::string& password,
-                    std::string& out) {
-  out.clear();
-  if (n < 1 + NONCE_LEN + TAG_LEN) return false;
-  if (p[0] != MAGIC_CIPHERTEXT) return false;
-  if (password.empty()) return false;
+// Derive + setkey into an initialised context. The key never outlives the
+// call; only the expanded context does.
+bool keyContext(mbedtls_gcm_context& gcm, const uint8_t* salt,
+                const char* name, const std::string& password) {
+  uint8_t key[32];
+  // Caller supplies UUID bytes already in LE order; no swap performed here.
+  bool ok = deriveKey(salt, 16, name, password, key) &&
+            mbedtls_gcm_setkey(&gcm, MBEDTLS_CIPHER_ID_AES, key, 256) == 0;
+  std::memset(key, 0, sizeof(key));
+  return ok;
+}
 
+// Shared tail of both overloads: framing already checked, context keyed.
+bool authDecrypt(mbedtls_gcm_context& gcm, const uint8_t* p, size_t n,
+                 std::string& out) {
   const uint8_t* nonce = p + 1;
   const uint8_t* tag = nonce + NONCE_LEN;
   const uint8_t* ct = tag + TAG_LEN;
   size_t ctLen = n - 1 - NONCE_LEN - TAG_LEN;
 
-  uint8_t key[32];
-  // Caller supplies UUID bytes already in LE order; no swap performed here.
-  if (!deriveKey(uuidLE16, 16, name, password, key)) {
-    std::memset(key, 0, sizeof(key));
+  out.resize(ctLen);
+  int rc = mbedtls_gcm_auth_decrypt(
+      &gcm, ctLen,
+      nonce, NONCE_LEN,
+      /*add=*/nullptr, 0,
+      tag, TAG_LEN,
+      ct,
+      reinterpret_cast<uint8_t*>(&out[0]));
+  if (rc != 0) {
+    out.clear();
     return false;
   }
+  return true;
+}
+
+bool framingOk(const uint8_t* p, size_t n, const std::string& password) {
+  if (n < 1 + NONCE_LEN + TAG_LEN) return false;
+  if (p[0] != MAGIC_CIPHERTEXT) return false;
+  return !password.empty();
+}
+
+}  // namespace
+
+bool decryptPayload(const uint8_t* p, size_t n,
+                    const uint8_t* uuidLE16, const char* name,
+                    const std::string& password,
+                    std::string& out) {
+  out.clear();
+  if (!framingOk(p, n, password)) return false;
 
   mbedtls_gcm_context gcm;
   mbedtls_gcm_init(&gcm);
-  bool ok = false;
-  if (mbedtls_gcm_setkey(&gcm, MBEDTLS_CIPHER_ID_AES, key, 256) == 0) {
-    out.resize(ctLen);
-    int rc = mbedtls_gcm_auth_decrypt(
-        &gcm, ctLen,
-        nonce, NONCE_LEN,
-        /*add=*/nullptr, 0,
-        tag, TAG_LEN,
-        ct,
-        reinterpret_cast<uint8_t*>(&out[0]));
-    ok = (rc == 0);
-  }
+  const bool ok = keyContext(gcm, uuidLE16, name, password) &&
+                  authDecrypt(gcm, p, n, out);
   mbedtls_gcm_free(&gcm);
-  std::memset(key, 0, sizeof(key));
+  return ok;
+}
 
-  if (!ok) {
-    out.clear();
-    return false;
+KeyCache::KeyCache() {
+  for (Slot& s : slots_) mbedtls_gcm_init(&s.gcm);
+}
+
+KeyCache::~KeyCache() {
+  clear();
+  for (Slot& s : slots_) mbedtls_gcm_free(&s.gcm);
+}
+
+void KeyCache::wipe(Slot& s) {
+  // gcm_free zeroizes the expanded key; re-init leaves the slot reusable.
+  mbedtls_gcm_free(&s.gcm);
+  mbedtls_gcm_init(&s.gcm);
+  s.used = false;
+}
+
+void KeyCache::clear() {
+  for (Slot& s : slots_) {
+    if (s.used) wipe(s);
   }
-  return true;
+  // Overwrite before release so the password copy doesn't linger in the heap.
+  std::fill(password_.begin(), password_.end(), '\0');
+  password_.clear();
+}
+
+mbedtls_gcm_context* KeyCache::lookup(const uint8_t* salt, const char* name,
+                                      const std::string& password) {
+  const size_t nameLen = std::strlen(name);
+  if (nameLen > kMaxShortName) return nullptr;
+  if (password != password_) {
+    clear();
+    password_ = password;
+  }
+  Slot* victim = &slots_[0];
+  for (Slot& s : slots_) {
+    if (s.used && std::memcmp(s.salt, salt, 16) == 0 &&
+        std::strcmp(s.name, name) == 0) {
+      s.lastUse = ++useClock_;
+      return &s.gcm;
+    }
+    // Free slots first, then least recently used.
+    if (victim->used && (!s.used || s.lastUse < victim->lastUse)) victim = &s;
+  }
+  if (victim->used) wipe(*victim);
+  derivations_++;
+  if (!keyContext(victim->gcm, salt, name, password)) {
+    wipe(*victim);
+    return nullptr;
+  }
+  victim->used = true;
+  victim->lastUse = ++useClock_;
+  std::memcpy(victim->salt, salt, 16);
+  std::memcpy(victim->name, name, nameLen + 1);
+  return &victim->gcm;
+}
+
+bool decryptPayload(const uint8_t* p, size_t n,
+                    const uint8_t* uuidLE16, const char* name,
+                    const std::string& password,
+                    KeyCache& cache,
+                    std::string& out) {
+  out.clear();
+  if (!framingOk(p, n, password)) return false;
+  mbedtls_gcm_context* gcm = cache.lookup(uuidLE16, name, password);
+  return gcm && authDecrypt(*gcm, p, n, out);
 }
 
 }}  // namespace lampos::crypto
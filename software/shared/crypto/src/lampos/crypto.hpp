@@ -4,6 +4,8 @@
 #include <cstdint>
 #include <string>
 
+#include <mbedtls/gcm.h>
+
 namespace lampos { namespace crypto {
 
 constexpr uint8_t MAGIC_PLAINTEXT  = 0x01;
@@ -25,4 +27,65 @@ bool decryptPayload(const uint8_t* payload, size_t len,
                     const std::string& password,
                     std::string& out);
 
+/// Bounded cache of keyed AES-256-GCM contexts for the overload of
+/// decryptPayload below. The derived key depends only on (password, salt,
+/// charShortName), so a burst of writes to one characteristic pays the HKDF
+/// derive + gcm_setkey once instead of per write.
+///
+/// Keyed on (salt, charShortName) under a single password: a call with a
+/// different password drops every slot first. When full, the least recently
+/// used slot is re-keyed, so a password change invalidates the cache on the
+/// next decrypt even when the owner can't reach it from the changing task.
+/// clear() wipes every slot; the owner calls it on disconnect (and on a
+/// password change it sees) so key material doesn't outlive either. Not
+/// thread-safe: one cache per decrypting task.
+class KeyCache {
+ public:
+  static constexpr size_t kSlots = 4;
+  static constexpr size_t kMaxShortName = 23;
+
+  KeyCache();
+  ~KeyCache();
+  KeyCache(const KeyCache&) = delete;
+  KeyCache& operator=(const KeyCache&) = delete;
+
+  void clear();
+
+  /// HKDF derivations run since construction. Test / bench seam.
+  uint32_t derivations() const { return derivations_; }
+
+ private:
+  friend bool decryptPayload(const uint8_t*, size_t, const uint8_t*,
+                             const char*, const std::string&, KeyCache&,
+                             std::string&);
+
+  struct Slot {
+    bool used = false;
+    uint32_t lastUse = 0;
+    uint8_t salt[16] = {0};
+    char name[kMaxShortName + 1] = {0};
+    mbedtls_gcm_context gcm;
+  };
+
+  // Keyed context for (salt, name) under `password`, deriving into a slot
+  // on a miss. nullptr when derivation fails or the name is too long to key.
+  mbedtls_gcm_context* lookup(const uint8_t* salt, const char* name,
+                              const std::string& password);
+  void wipe(Slot& s);
+
+  Slot slots_[kSlots];
+  std::string password_;
+  uint32_t useClock_ = 0;
+  uint32_t derivations_ = 0;
+};
+
+/// decryptPayload with the derive + setkey served from [cache]. Same wire
+/// format, checks, and result as the uncached overload.
+bool decryptPayload(const uint8_t* payload, size_t len,
+                    const uint8_t* charUuidLE16,    // 16 bytes
+                    const char* charShortName,
+                    const std::string& password,
+                    KeyCache& cache,
+                    std::string& out);
+
 }}  // namespace lampos::crypto
@@ -36,6 +36,25 @@ inline const char* byteOrderToString(ByteOrder b) {
   return "GRB";
 }
 
+// Byte position of each channel within one pixel of the driver's pixel array,
+// matching the Adafruit NEO_* offsets for the order. RGB-only strips carry no
+// white byte (w == kNoWhiteByte); their W channel is dropped on the wire.
+constexpr uint8_t kNoWhiteByte = 0xFF;
+
+struct WireLayout {
+  uint8_t bytesPerPixel;
+  uint8_t r, g, b, w;
+};
+
+constexpr WireLayout wireLayout(ByteOrder b) {
+  switch (b) {
+    case ByteOrder::GRBW: return {4, 1, 0, 2, 3};
+    case ByteOrder::GRB:  return {3, 1, 0, 2, kNoWhiteByte};
+    case ByteOrder::BGR:  return {3, 2, 1, 0, kNoWhiteByte};
+  }
+  return {4, 1, 0, 2, 3};
+}
+
 // NEO_* value WITHOUT the KHZ term; callers add `+ NEO_KHZ800`.
 // Absent in native test builds (no Adafruit header).
 #ifdef LAMPOS_LED_HAS_NEOPIXEL
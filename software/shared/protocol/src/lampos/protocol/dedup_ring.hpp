@@ -82,4 +82,111 @@ class DedupRing {
   LAMP_PROTOCOL_PORTMUX_TYPE mux_ = LAMP_PROTOCOL_PORTMUX_INIT;
 };
 
+// DedupRing with the same record() contract and ring-ordered eviction (the
+// oldest tuple goes first, so the two answer identically for any input), but
+// lookup goes through an open-addressed index instead of a CAPACITY-long
+// compare loop. The critical section is a hash probe plus, once the ring is
+// full, a backward-shift delete of the evicted tuple: a handful of slots
+// whatever CAPACITY is, where DedupRing's grows with it. For the relay-heavy
+// rings, which want more headroom in a dense crowd without a longer
+// interrupts-off window on the recv task.
+//
+// Memory stays fixed: CAPACITY 12-byte entries plus a uint16_t index of
+// kBuckets (the next power of two >= 2 * CAPACITY, so the load factor stays
+// <= 0.5 and probes stay short). The hash is computed outside the lock.
+template <size_t CAPACITY = 64>
+class HashedDedupRing {
+  static_assert(CAPACITY > 0 && CAPACITY < 0x8000, "index slots are uint16_t");
+
+ public:
+  bool record(const uint8_t mac[6], uint8_t msgType, uint16_t seq) {
+    const uint16_t home = bucketOf(mac, msgType, seq);
+    LAMP_PROTOCOL_PORTMUX_ENTER(&mux_);
+    for (size_t b = home;; b = (b + 1) & kMask) {
+      const uint16_t ref = index_[b];
+      if (ref == kEmpty) break;
+      const Entry& e = entries_[ref - 1];
+      if (e.msgType == msgType && e.seq == seq && std::memcmp(e.mac, mac, 6) == 0) {
+        LAMP_PROTOCOL_PORTMUX_EXIT(&mux_);
+        return false;
+      }
+    }
+    if (count_ == CAPACITY) {
+      unindex(head_);
+    } else {
+      ++count_;
+    }
+    Entry& slot = entries_[head_];
+    slot.msgType = msgType;
+    slot.seq = seq;
+    slot.home = home;
+    std::memcpy(slot.mac, mac, 6);
+    // Probe again: the delete above may have shifted entries into the chain.
+    size_t b = home;
+    while (index_[b] != kEmpty) b = (b + 1) & kMask;
+    index_[b] = static_cast<uint16_t>(head_ + 1);
+    head_ = (head_ + 1) % CAPACITY;
+    LAMP_PROTOCOL_PORTMUX_EXIT(&mux_);
+    return true;
+  }
+
+ private:
+  static constexpr size_t bucketsFor(size_t n) {
+    size_t b = 1;
+    while (b < 2 * n) b <<= 1;
+    return b;
+  }
+  static constexpr size_t kBuckets = bucketsFor(CAPACITY);
+  static constexpr size_t kMask = kBuckets - 1;
+  static constexpr uint16_t kEmpty = 0;  // index_ holds entry index + 1
+
+  struct Entry {
+    uint8_t mac[6] = {0, 0, 0, 0, 0, 0};
+    uint8_t msgType = 0;
+    uint16_t seq = 0;
+    uint16_t home = 0;  // bucket the tuple hashed to, for the shift-delete
+  };
+
+  // FNV-1a over the 9 key bytes, folded to a bucket.
+  static uint16_t bucketOf(const uint8_t mac[6], uint8_t msgType, uint16_t seq) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < 6; i++) {
+      h ^= mac[i];
+      h *= 16777619u;
+    }
+    h ^= msgType;
+    h *= 16777619u;
+    h ^= static_cast<uint8_t>(seq);
+    h *= 16777619u;
+    h ^= static_cast<uint8_t>(seq >> 8);
+    h *= 16777619u;
+    return static_cast<uint16_t>((h ^ (h >> 16)) & kMask);
+  }
+
+  // Drop entry `slot` from the index, shifting later members of its probe
+  // chain back so lookups never need tombstones.
+  void unindex(size_t slot) {
+    const uint16_t ref = static_cast<uint16_t>(slot + 1);
+    size_t hole = entries_[slot].home;
+    while (index_[hole] != ref) hole = (hole + 1) & kMask;
+    for (size_t b = (hole + 1) & kMask; index_[b] != kEmpty; b = (b + 1) & kMask) {
+      const size_t want = entries_[index_[b] - 1].home;
+      // Move b into the hole unless its home lies cyclically in (hole, b].
+      const bool homeBetween = hole <= b ? (want > hole && want <= b)
+                                         : (want > hole || want <= b);
+      if (!homeBetween) {
+        index_[hole] = index_[b];
+        hole = b;
+      }
+    }
+    index_[hole] = kEmpty;
+  }
+
+  Entry entries_[CAPACITY];
+  uint16_t index_[kBuckets] = {};
+  size_t head_ = 0;
+  size_t count_ = 0;
+  LAMP_PROTOCOL_PORTMUX_TYPE mux_ = LAMP_PROTOCOL_PORTMUX_INIT;
+};
+
 }  // namespace lamp_protocol
@@ -17,7 +17,8 @@
 //                   MSG_WISP_STATE (0x28).
 //   override.hpp    MSG_OVERRIDE_COLORS (0x21) / RESTORE_COLORS (0x22) /
 //                   OVERRIDE_BRIGHTNESS (0x23) / RESTORE_BRIGHTNESS (0x24).
-//   dedup_ring.hpp  DedupRing (gossip-relay dup suppressor; not a message).
+//   dedup_ring.hpp  DedupRing / HashedDedupRing (gossip-relay dup
+//                   suppressors; not a message).
 //   paint_timing.hpp  Wisp paint watchdog/keep-alive constants (not a
 //                     message; compile-time timing shared lamp+wisp).
 //
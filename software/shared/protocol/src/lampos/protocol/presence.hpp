@@ -23,7 +23,9 @@
 //              HELLO_TLV_FW_MAX_CHUNK (0x04, 2B),
 //              HELLO_TLV_NEED_FS (0x05, 1B),
 //              HELLO_TLV_OTA_SENDING_TO (0x06, 6B),
-//              HELLO_TLV_VARIANT (0x07, 1B).
+//              HELLO_TLV_VARIANT (0x07, 1B),
+//              HELLO_TLV_CAPS (0x08, HELLO_CAPS_LEN=5B),
+//              HELLO_TLV_HEALTH (0x09, HELLO_HEALTH_LEN=12B).
 //              Unknown types are skipped by their len byte (forward-compat).
 //
 // Fixed prefix through nameLen is HELLO_FIXED_SIZE (24) + 1; the whole frame
@@ -89,6 +91,85 @@ constexpr size_t  HELLO_OTA_SENDING_TO_LEN = 6;
 // peers, which read as LampVariant::Unknown.
 constexpr uint8_t HELLO_TLV_VARIANT = 0x07;
 
+// value: 5 bytes, [caps 1][invocationSchema 4 LE]. `caps` is a bitfield of
+// optional wire features the sender understands (HELLO_CAP_*). The schema id
+// qualifies HELLO_CAP_BINARY_INVOCATION: the binary MSG_COMMAND / MSG_EVENT
+// invocation body indexes compile-time tables (expression types, param keys),
+// so a sender only uses it toward peers advertising the SAME schema id; it
+// changes whenever either table does. Absent on older peers (caps=0 → JSON).
+// HELLO_CAP_BINARY_CONTROL_OP needs no schema: its op codes are fixed and
+// append-only, so a sender just checks the bit. HELLO_CAP_FW_REQ_BITMAP
+// says the sender both serves and sends the exact-hole MSG_FW_REQ/MSG_FS_REQ
+// mask trailer (fw_ota.hpp), so an OTA pair where both set it recovers losses
+// chunk-for-chunk instead of by covering run. HELLO_CAP_FW_FEC says the sender
+// decodes MSG_FW_REPAIR/MSG_FS_REPAIR window parity and emits it toward peers
+// that set the bit, so most losses heal without a REQ round trip.
+// HELLO_CAP_FW_GROUP says the sender joins one-to-many OTA sessions: it takes
+// CHUNK/REPAIR/DONE addressed to its session distributor's group MAC
+// (fw_ota.hpp), so one broadcast stream serves every member.
+// HELLO_CAP_FW_DELTA says the sender rebuilds an image from a patch against
+// its running one (a delta OFFER, fw_ota.hpp), so a distributor holding a
+// patch for the sender's firmwareVersion streams that instead.
+// HELLO_CAP_FW_PACKED says the sender decodes packed CHUNK payloads (a pack
+// OFFER trailer, fw_ota.hpp), so a distributor streams that peer LZ units
+// that each carry several KB of the image instead of raw slices. Parsers
+// read caps from a 1-byte value too and ignore bytes past the 5th, so the TLV
+// can grow in place.
+constexpr uint8_t HELLO_TLV_CAPS = 0x08;
+constexpr size_t  HELLO_CAPS_LEN = 5;
+constexpr uint8_t HELLO_CAP_BINARY_INVOCATION = 0x01;
+constexpr uint8_t HELLO_CAP_BINARY_CONTROL_OP = 0x02;
+constexpr uint8_t HELLO_CAP_FW_REQ_BITMAP     = 0x04;
+constexpr uint8_t HELLO_CAP_FW_FEC            = 0x08;
+constexpr uint8_t HELLO_CAP_FW_GROUP          = 0x10;
+constexpr uint8_t HELLO_CAP_FW_DELTA          = 0x20;
+constexpr uint8_t HELLO_CAP_FW_PACKED         = 0x40;
+
+// value: 12 bytes, six u16 LE health figures (HelloHealth): frame-time p99
+// in 100 us units, frames dropped, pending-slot drops, heap low-water KiB,
+// largest free block KiB, relays per minute. Counts cover the window since
+// the sender's previous health TLV and saturate at 0xFFFF. Sent on a low
+// cadence (a fraction of HELLOs), so receivers keep the last one they saw.
+// Parsers ignore bytes past the 12th, so the TLV can grow in place.
+constexpr uint8_t HELLO_TLV_HEALTH = 0x09;
+constexpr size_t  HELLO_HEALTH_LEN = 12;
+
+struct HelloHealth {
+  uint32_t frameP99Us = 0;
+  uint16_t frameDrops = 0;
+  uint16_t slotDrops = 0;
+  uint16_t heapLowKb = 0;
+  uint16_t heapLargestKb = 0;
+  uint16_t relayPerMin = 0;
+};
+
+inline uint16_t saturateU16(uint32_t v) {
+  return v > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(v);
+}
+
+inline void encodeHelloHealth(const HelloHealth& h, uint8_t out[HELLO_HEALTH_LEN]) {
+  const uint16_t v[6] = {saturateU16((h.frameP99Us + 99) / 100), h.frameDrops,
+                         h.slotDrops, h.heapLowKb, h.heapLargestKb, h.relayPerMin};
+  for (size_t i = 0; i < 6; ++i) {
+    out[2 * i]     = static_cast<uint8_t>(v[i] & 0xFF);
+    out[2 * i + 1] = static_cast<uint8_t>(v[i] >> 8);
+  }
+}
+
+inline void decodeHelloHealth(const uint8_t in[HELLO_HEALTH_LEN], HelloHealth& h) {
+  uint16_t v[6];
+  for (size_t i = 0; i < 6; ++i) {
+    v[i] = static_cast<uint16_t>(in[2 * i]) |
+           (static_cast<uint16_t>(in[2 * i + 1]) << 8);
+  }
+  h.frameP99Us    = static_cast<uint32_t>(v[0]) * 100;
+  h.frameDrops    = v[1];
+  h.slotDrops     = v[2];
+  h.heapLowKb     = v[3];
+  h.heapLargestKb = v[4];
+  h.relayPerMin   = v[5];
+}
+
 // Lamp hardware/behavior variant, carried in HELLO_TLV_VARIANT. Append-only:
 // a new variant takes the next value, and older firmware reads it as Unknown.
 enum class LampVariant : uint8_t {
@@ -121,7 +202,9 @@ constexpr uint8_t kOtaStateIdle      = 0;
 constexpr uint8_t kOtaStateSending   = 1;
 constexpr uint8_t kOtaStateReceiving = 2;
 
-constexpr size_t HELLO_MAX_SIZE = 128;  // see TLV trailer note above
+// See the TLV trailer note above. A 32-byte name with every TLV present,
+// HEALTH included, is exactly 128.
+constexpr size_t HELLO_MAX_SIZE = 128;
 
 struct ParsedHello {
   uint16_t seq;
@@ -159,6 +242,13 @@ struct ParsedHello {
   // HELLO_TLV_VARIANT, the peer's lamp variant. Unknown when the TLV is absent
   // (legacy / BLE-only peers).
   LampVariant variant = LampVariant::Unknown;
+  // HELLO_TLV_CAPS. Both 0 when absent (older peer): no optional features.
+  uint8_t  caps = 0;
+  uint32_t invocationSchema = 0;
+  // HELLO_TLV_HEALTH. hasHealth=false on HELLOs between health reports and
+  // from older peers.
+  bool        hasHealth = false;
+  HelloHealth health;
 };
 
 // Build a HELLO frame into `buf`. `name` is utf-8, NOT null-terminated on the wire.
@@ -167,6 +257,8 @@ struct ParsedHello {
 // kOtaStateIdle to omit the TLV entirely (more compact for the common case).
 // `maxChunk` lands in HELLO_TLV_FW_MAX_CHUNK; 0 omits the TLV (a peer that
 // never receives firmware OTA, e.g. the wisp, has nothing to advertise).
+// `caps` + `invocationSchema` land in HELLO_TLV_CAPS; caps=0 omits the TLV.
+// `health` lands in HELLO_TLV_HEALTH; nullptr omits the TLV.
 // Returns 0 on bad args, total bytes written on success.
 inline size_t buildHello(uint8_t* buf, size_t bufLen, uint16_t seq,
                          const uint8_t sourceMac[6],
@@ -179,7 +271,10 @@ inline size_t buildHello(uint8_t* buf, size_t bufLen, uint16_t seq,
                          uint16_t maxChunk = 0,
                          bool needsFs = false,
                          const uint8_t* otaSendingTo = nullptr,
-                         LampVariant variant = LampVariant::Unknown) {
+                         LampVariant variant = LampVariant::Unknown,
+                         uint8_t caps = 0,
+                         uint32_t invocationSchema = 0,
+                         const HelloHealth* health = nullptr) {
   if (!buf || !sourceMac || !shadeRGBW || !baseRGBW) return 0;
   if (nameLen > HELLO_MAX_NAME) nameLen = HELLO_MAX_NAME;
   // TLV trailer: tlv_count(1) + (type(1) + len(1) + value(N)) per emitted TLV.
@@ -193,13 +288,17 @@ inline size_t buildHello(uint8_t* buf, size_t bufLen, uint16_t seq,
   const bool emitNeedFs    = needsFs;
   const bool emitSendingTo = (otaSendingTo != nullptr);
   const bool emitVariant   = (variant != LampVariant::Unknown);
+  const bool emitCaps      = (caps != 0);
+  const bool emitHealth    = (health != nullptr);
   const size_t tlvBytes = 1 + (emitOtaState ? 3 : 0) +
                           (emitFwChannel ? (2 + HELLO_FW_CHANNEL_LEN) : 0) +
                           (emitFsDigest ? (2 + HELLO_FS_DIGEST_LEN) : 0) +
                           (emitMaxChunk ? 4 : 0) +
                           (emitNeedFs ? 3 : 0) +
                           (emitSendingTo ? (2 + HELLO_OTA_SENDING_TO_LEN) : 0) +
-                          (emitVariant ? 3 : 0);
+                          (emitVariant ? 3 : 0) +
+                          (emitCaps ? (2 + HELLO_CAPS_LEN) : 0) +
+                          (emitHealth ? (2 + HELLO_HEALTH_LEN) : 0);
   const size_t total = HELLO_FIXED_SIZE + 1 + nameLen + tlvBytes;
   if (bufLen < total) return 0;
   buf[0] = MAGIC_0;
@@ -227,7 +326,9 @@ inline size_t buildHello(uint8_t* buf, size_t bufLen, uint16_t seq,
                                     (emitMaxChunk ? 1 : 0) +
                                     (emitNeedFs ? 1 : 0) +
                                     (emitSendingTo ? 1 : 0) +
-                                    (emitVariant ? 1 : 0));  // tlv_count
+                                    (emitVariant ? 1 : 0) +
+                                    (emitCaps ? 1 : 0) +
+                                    (emitHealth ? 1 : 0));  // tlv_count
   if (emitOtaState) {
     buf[off++] = HELLO_TLV_OTA_STATE;
     buf[off++] = 1;          // len
@@ -270,6 +371,21 @@ inline size_t buildHello(uint8_t* buf, size_t bufLen, uint16_t seq,
     buf[off++] = 1;  // len
     buf[off++] = static_cast<uint8_t>(variant);
   }
+  if (emitCaps) {
+    buf[off++] = HELLO_TLV_CAPS;
+    buf[off++] = static_cast<uint8_t>(HELLO_CAPS_LEN);  // len = 5
+    buf[off++] = caps;
+    buf[off++] = static_cast<uint8_t>(invocationSchema & 0xFF);
+    buf[off++] = static_cast<uint8_t>((invocationSchema >> 8) & 0xFF);
+    buf[off++] = static_cast<uint8_t>((invocationSchema >> 16) & 0xFF);
+    buf[off++] = static_cast<uint8_t>((invocationSchema >> 24) & 0xFF);
+  }
+  if (emitHealth) {
+    buf[off++] = HELLO_TLV_HEALTH;
+    buf[off++] = static_cast<uint8_t>(HELLO_HEALTH_LEN);  // len = 12
+    encodeHelloHealth(*health, &buf[off]);
+    off += HELLO_HEALTH_LEN;
+  }
   return total;
 }
 
@@ -298,6 +414,9 @@ inline bool parseHello(const uint8_t* data, size_t len, ParsedHello& out) {
   out.needsFs = false;
   out.hasOtaSendingTo = false;
   out.variant = LampVariant::Unknown;
+  out.caps = 0;
+  out.invocationSchema = 0;
+  out.hasHealth = false;
   size_t off = HELLO_FIXED_SIZE + 1 + nameLen;
   if (len <= off) return true;
   const uint8_t tlvCount = data[off++];
@@ -331,6 +450,17 @@ inline bool parseHello(const uint8_t* data, size_t len, ParsedHello& out) {
       out.hasOtaSendingTo = true;
     } else if (tlvType == HELLO_TLV_VARIANT && tlvLen == 1) {
       out.variant = static_cast<LampVariant>(data[off]);
+    } else if (tlvType == HELLO_TLV_CAPS && tlvLen >= 1) {
+      out.caps = data[off];
+      if (tlvLen >= HELLO_CAPS_LEN) {
+        out.invocationSchema = static_cast<uint32_t>(data[off + 1]) |
+                               (static_cast<uint32_t>(data[off + 2]) << 8) |
+                               (static_cast<uint32_t>(data[off + 3]) << 16) |
+                               (static_cast<uint32_t>(data[off + 4]) << 24);
+      }
+    } else if (tlvType == HELLO_TLV_HEALTH && tlvLen >= HELLO_HEALTH_LEN) {
+      decodeHelloHealth(&data[off], out.health);
+      out.hasHealth = true;
     }
     off += tlvLen;
   }
@@ -18,11 +18,13 @@ using lampos::crypto::NONCE_LEN;
 using lampos::crypto::TAG_LEN;
 constexpr size_t MAX_RECENT_NONCES = 32;
 
-/// Sliding window of recently-seen nonces for replay detection.
+/// Sliding window of recently-seen nonces for replay detection, plus the
+/// derived wispOp GCM key so a burst of sealed ops derives once.
 /// RAM-only: a forced reboot clears it.
 /// ponytail: reboot replay is accepted; config ops are low-value/idempotent.
 struct RecentNonces {
   std::deque<std::array<uint8_t, NONCE_LEN>> entries;
+  lampos::crypto::KeyCache keys;
 };
 
 /// Returns true on success and writes the plaintext to [out]. Derive +
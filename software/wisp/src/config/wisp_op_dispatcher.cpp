@@ -57,6 +57,8 @@ DispatchResult WispOpDispatcher::dispatch(const uint8_t* payload, size_t len) {
     }
     const DispatchResult result = dispatchJson(plain.c_str(), plain.size());
     if (isApplied(result)) config_.bumpOpSeq();
+    // Drop the old password's key now rather than on the next sealed op.
+    if (result == DispatchResult::AppliedPasswordChange) nonces_->keys.clear();
     return result;
   }
 
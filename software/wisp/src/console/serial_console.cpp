@@ -5,6 +5,7 @@
 
 #include "config/wisp_config.hpp"
 #include "config/zone_selector.hpp"
+#include "fleet/fleet_health.hpp"
 #include "fleet/lamp_inventory.hpp"
 #include "net/mesh_link.hpp"
 #include "net/stage_beacon.hpp"
@@ -73,6 +74,36 @@ void SerialConsole::dumpInventory() {
 #endif
 }
 
+void SerialConsole::dumpFleetHealth() {
+  const uint32_t nowMs = millis();
+  auto roster = inventory_.snapshot();
+  FleetHealthSummary s;
+  for (const auto& e : roster) {
+    accumulateFleetHealth(s, e, nowMs);
+    if (!healthFresh(e, nowMs)) {
+      Serial.printf("[wisp.fleet] %02X:%02X:%02X:%02X:%02X:%02X  %-12s  no report\n",
+                    e.mac[0], e.mac[1], e.mac[2], e.mac[3], e.mac[4], e.mac[5],
+                    e.name);
+      continue;
+    }
+    const lamp_protocol::HelloHealth& h = e.health;
+    Serial.printf("[wisp.fleet] %02X:%02X:%02X:%02X:%02X:%02X  %-12s  "
+                  "p99=%luus drop=%u slot=%u heapLow=%uK largest=%uK "
+                  "relay=%u/min flags=0x%02X age=%lums\n",
+                  e.mac[0], e.mac[1], e.mac[2], e.mac[3], e.mac[4], e.mac[5],
+                  e.name, (unsigned long)h.frameP99Us, h.frameDrops, h.slotDrops,
+                  h.heapLowKb, h.heapLargestKb, h.relayPerMin,
+                  healthFlags(h, e.otaState),
+                  (unsigned long)(nowMs - e.healthAtMs));
+  }
+  Serial.printf("[wisp.fleet] lamps=%u reporting=%u hot=%u drop=%u frag=%u "
+                "lowHeap=%u slot=%u ota=%u worstP99=%luus minHeapLow=%uK "
+                "relay=%lu/min\n",
+                s.lamps, s.reporting, s.overloaded, s.dropping, s.fragmenting,
+                s.lowHeap, s.slotDrops, s.ota, (unsigned long)s.worstP99Us,
+                s.minHeapLowKb, (unsigned long)s.relayPerMin);
+}
+
 void SerialConsole::handleCommand(const String& cmd) {
   if (cmd.length() == 0) return;
   if (cmd == "paint:on") {
@@ -94,6 +125,8 @@ void SerialConsole::handleCommand(const String& cmd) {
     stage_.refreshAdvert();
   } else if (cmd == "stage:off") {
     stage_.stop();
+  } else if (cmd == "fleet") {
+    dumpFleetHealth();
   } else if (cmd == "wifi:show") {
     Serial.printf("[wifi] ssid='%s' connected=%d ip=%s\n",
                   wifi_.ssid().c_str(), wifi_.isConnected() ? 1 : 0,
@@ -29,6 +29,9 @@ public:
   // Print current lamp roster + zone state to Serial.
   void dumpInventory();
 
+  // Print each lamp's latest health report + the fleet roll-up (`fleet`).
+  void dumpFleetHealth();
+
 private:
   void handleCommand(const String& cmd);
   static String formatVersion(uint32_t v);
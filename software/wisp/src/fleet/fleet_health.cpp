@@ -0,0 +1,48 @@
+#include "fleet/fleet_health.hpp"
+
+#include <cstring>
+
+namespace wisp {
+
+uint8_t healthFlags(const lamp_protocol::HelloHealth& h, uint8_t otaState) {
+  uint8_t f = 0;
+  if (h.frameP99Us > kOverloadedP99Us) f |= kHealthOverloaded;
+  if (h.frameDrops >= kDroppingFrames) f |= kHealthDropping;
+  // 0 KiB means the sender had no heap sample yet; not a finding.
+  if (h.heapLargestKb != 0 && h.heapLargestKb < kFragmentingLargestKb) {
+    f |= kHealthFragmenting;
+  }
+  if (h.heapLowKb != 0 && h.heapLowKb < kLowHeapKb) f |= kHealthLowHeap;
+  if (h.slotDrops != 0) f |= kHealthSlotDrops;
+  if (otaState != lamp_protocol::kOtaStateIdle) f |= kHealthOta;
+  return f;
+}
+
+bool healthFresh(const InventoryEntry& e, uint32_t nowMs) {
+  return e.hasHealth && nowMs - e.healthAtMs <= kHealthStaleMs;
+}
+
+void accumulateFleetHealth(FleetHealthSummary& s, const InventoryEntry& e,
+                           uint32_t nowMs) {
+  s.lamps++;
+  if (!healthFresh(e, nowMs)) return;
+  const lamp_protocol::HelloHealth& h = e.health;
+  const uint8_t f = healthFlags(h, e.otaState);
+  s.reporting++;
+  if (f & kHealthOverloaded) s.overloaded++;
+  if (f & kHealthDropping) s.dropping++;
+  if (f & kHealthFragmenting) s.fragmenting++;
+  if (f & kHealthLowHeap) s.lowHeap++;
+  if (f & kHealthSlotDrops) s.slotDrops++;
+  if (f & kHealthOta) s.ota++;
+  if (h.frameP99Us > s.worstP99Us) {
+    s.worstP99Us = h.frameP99Us;
+    std::memcpy(s.worstMac, e.mac, 6);
+  }
+  if (h.heapLowKb != 0 && (s.minHeapLowKb == 0 || h.heapLowKb < s.minHeapLowKb)) {
+    s.minHeapLowKb = h.heapLowKb;
+  }
+  s.relayPerMin += h.relayPerMin;
+}
+
+}  // namespace wisp
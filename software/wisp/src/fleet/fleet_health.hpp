@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+#include "fleet/lamp_inventory.hpp"
+#include "wire/lamp_protocol.hpp"
+
+namespace wisp {
+
+// A lamp's last HELLO_TLV_HEALTH report counts for this long. Lamps report
+// about once a minute, so three missed reports age a lamp out of the table.
+constexpr uint32_t kHealthStaleMs = 180000;
+
+// Per-lamp flags, derived from one health report (plus the OTA state every
+// HELLO carries).
+enum HealthFlag : uint8_t {
+  kHealthOverloaded  = 0x01,  // frame p99 past two frame periods
+  kHealthDropping    = 0x02,  // frames held for two periods or more, per window
+  kHealthFragmenting = 0x04,  // free heap in pieces: largest block small
+  kHealthLowHeap     = 0x08,  // boot low-water near exhaustion
+  kHealthSlotDrops   = 0x10,  // pending slots / rx queue losing events
+  kHealthOta         = 0x20,  // sending or receiving firmware
+};
+
+constexpr uint32_t kOverloadedP99Us     = 33000;
+constexpr uint16_t kDroppingFrames      = 30;
+constexpr uint16_t kFragmentingLargestKb = 16;
+constexpr uint16_t kLowHeapKb           = 24;
+
+uint8_t healthFlags(const lamp_protocol::HelloHealth& h, uint8_t otaState);
+
+// Fleet roll-up over the inventory, for wispStatus and the serial console.
+// Only lamps with a fresh report count toward anything but `lamps`.
+struct FleetHealthSummary {
+  uint16_t lamps = 0;
+  uint16_t reporting = 0;
+  uint16_t overloaded = 0;
+  uint16_t dropping = 0;
+  uint16_t fragmenting = 0;
+  uint16_t lowHeap = 0;
+  uint16_t slotDrops = 0;
+  uint16_t ota = 0;
+  // The reporting lamp with the highest frame p99; worstP99Us 0 when none.
+  uint32_t worstP99Us = 0;
+  uint8_t  worstMac[6] = {0};
+  // Lowest heap low-water among reporting lamps; 0 when none.
+  uint16_t minHeapLowKb = 0;
+  uint32_t relayPerMin = 0;  // summed across reporting lamps
+};
+
+// Folds one inventory entry into `s`.
+void accumulateFleetHealth(FleetHealthSummary& s, const InventoryEntry& e,
+                           uint32_t nowMs);
+
+// Whether `e` carries a report young enough to count.
+bool healthFresh(const InventoryEntry& e, uint32_t nowMs);
+
+}  // namespace wisp
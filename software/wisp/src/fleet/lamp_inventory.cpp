@@ -1,5 +1,6 @@
 #include "fleet/lamp_inventory.hpp"
 
+#include "fleet/fleet_health.hpp"
 #include "fleet/freertos_shim.hpp"
 
 #include <cstring>
@@ -47,7 +48,9 @@ void LampInventory::evictOldestIfFullLocked() {
 void LampInventory::recordHello(const uint8_t mac[6], const char* name,
                                 const uint8_t baseRGBW[4], const uint8_t shadeRGBW[4],
                                 uint32_t firmwareVersion, uint32_t nowMs,
-                                int8_t rssi) {
+                                int8_t rssi,
+                                const lamp_protocol::HelloHealth* health,
+                                uint8_t otaState) {
   // Bounded take, runs on the WiFi recv task; mustn't stall a loop-task reader.
   if (xSemaphoreTake(asHandle(mutex_), pdMS_TO_TICKS(2)) != pdTRUE) return;
 
@@ -55,6 +58,7 @@ void LampInventory::recordHello(const uint8_t mac[6], const char* name,
   if (idx == count_) {
     evictOldestIfFullLocked();
     InventoryEntry& e = entries_[count_++];
+    e = InventoryEntry{};  // slot may still hold a pruned lamp's health
     std::memcpy(e.mac, mac, 6);
     copyName(e.name, name);
     std::memcpy(e.baseColor, baseRGBW, 4);
@@ -62,6 +66,12 @@ void LampInventory::recordHello(const uint8_t mac[6], const char* name,
     e.firmwareVersion = firmwareVersion;
     e.lastSeenMs = nowMs;
     e.rssi = rssi;
+    e.otaState = otaState;
+    if (health) {
+      e.health = *health;
+      e.healthAtMs = nowMs;
+      e.hasHealth = true;
+    }
   } else {
     copyName(entries_[idx].name, name);
     std::memcpy(entries_[idx].baseColor, baseRGBW, 4);
@@ -74,6 +84,13 @@ void LampInventory::recordHello(const uint8_t mac[6], const char* name,
     if (rssi != INT8_MIN) {
       entries_[idx].rssi = rssi;
     }
+    entries_[idx].otaState = otaState;
+    // Health rides only some HELLOs; one without it keeps the last report.
+    if (health) {
+      entries_[idx].health = *health;
+      entries_[idx].healthAtMs = nowMs;
+      entries_[idx].hasHealth = true;
+    }
   }
   xSemaphoreGive(asHandle(mutex_));
 }
@@ -112,6 +129,13 @@ size_t LampInventory::copyObservations(LampObservation* out, size_t max) {
   return n;
 }
 
+void LampInventory::summarizeHealth(uint32_t nowMs, FleetHealthSummary& out) {
+  out = FleetHealthSummary{};
+  xSemaphoreTake(asHandle(mutex_), portMAX_DELAY);
+  for (size_t i = 0; i < count_; i++) accumulateFleetHealth(out, entries_[i], nowMs);
+  xSemaphoreGive(asHandle(mutex_));
+}
+
 size_t LampInventory::size() {
   xSemaphoreTake(asHandle(mutex_), portMAX_DELAY);
   size_t n = count_;
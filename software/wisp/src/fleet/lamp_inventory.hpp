@@ -9,6 +9,8 @@
 
 namespace wisp {
 
+struct FleetHealthSummary;
+
 // Matches the lamp prune window so lamps disappear from both at the same wall-clock moment.
 #ifndef LAMP_PRUNE_TIME_MS
 #define LAMP_PRUNE_TIME_MS 240000
@@ -41,6 +43,14 @@ struct InventoryEntry {
   // surface RSSI keep this sentinel and won't be chosen as the closer
   // wisp until a real measurement lands.
   int8_t rssi = INT8_MIN;
+  // OTA state from the latest HELLO (lamp_protocol::kOtaState*).
+  uint8_t otaState = lamp_protocol::kOtaStateIdle;
+  // Latest HELLO_TLV_HEALTH report and when it landed. Lamps attach one to
+  // about every other HELLO, so a HELLO without it keeps the previous report
+  // (fleet/fleet_health.hpp ages it out).
+  bool hasHealth = false;
+  uint32_t healthAtMs = 0;
+  lamp_protocol::HelloHealth health;
 };
 
 static_assert(std::is_trivially_copyable<InventoryEntry>::value,
@@ -56,7 +66,8 @@ static_assert(std::is_trivially_copyable<InventoryEntry>::value,
  *
  * Consumers:
  *   - serial dump every 10s for bench debug (snapshot);
- *   - PaintDistributor + WispRoster claim recompute (copyObservations).
+ *   - PaintDistributor + WispRoster claim recompute (copyObservations);
+ *   - StatusEmitter fleet health roll-up (summarizeHealth).
  */
 class LampInventory {
  public:
@@ -68,10 +79,13 @@ class LampInventory {
   // `name` is a null-terminated string, truncated at HELLO_MAX_NAME.
   // `rssi` is the signed ESP-NOW RX RSSI for the frame that delivered this
   // hello, or INT8_MIN to mean "no measurement available" (test rigs etc.).
+  // `health` is the HELLO's health report, nullptr when it carried none.
   void recordHello(const uint8_t mac[6], const char* name,
                    const uint8_t baseRGBW[4], const uint8_t shadeRGBW[4],
                    uint32_t firmwareVersion, uint32_t nowMs,
-                   int8_t rssi = INT8_MIN);
+                   int8_t rssi = INT8_MIN,
+                   const lamp_protocol::HelloHealth* health = nullptr,
+                   uint8_t otaState = lamp_protocol::kOtaStateIdle);
 
   // Drop entries older than maxAgeMs. Call periodically from loop().
   void prune(uint32_t nowMs, uint32_t maxAgeMs);
@@ -87,6 +101,10 @@ class LampInventory {
   // Cheap count for diagnostics; doesn't allocate.
   size_t size();
 
+  // Fleet health roll-up over every entry (fleet/fleet_health.hpp). No
+  // allocation; one pass under the lock.
+  void summarizeHealth(uint32_t nowMs, FleetHealthSummary& out);
+
   static constexpr size_t MAX_LAMPS = 100;
 
  private:
@@ -160,7 +160,7 @@ void setup() {
 
   // carriedFw* zero-fill; wire layout retained for back-compat with older lamps.
   statusEmitter.begin(&mesh, &zoneSelector, &auroraClient, &wispConfig,
-                      &currentPalette, &wispSeq, &wifi);
+                      &currentPalette, &wispSeq, &wifi, &inventory);
   wifi.setOnChangeCallback([] { statusEmitter.triggerOnChange(); });
   presenceBeacon.begin(&mesh, &paintDistributor, &currentPalette,
                        &auroraClient, &wispRoster, &wispSeq, &statusEmitter,
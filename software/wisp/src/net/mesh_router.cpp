@@ -26,7 +26,8 @@ void MeshRouter::onPacket(const uint8_t* srcMac, const uint8_t* data,
     if (!lamp_protocol::parseHello(data, len, h)) return;
     inventory_.recordHello(h.sourceMac, h.name, h.base, h.shade,
                            h.firmwareVersion, millis(),
-                           helloRssiForRecord(srcMac, h.sourceMac, rssi));
+                           helloRssiForRecord(srcMac, h.sourceMac, rssi),
+                           h.hasHealth ? &h.health : nullptr, h.otaState);
     return;
   }
   if (msgType == lamp_protocol::MSG_WISP_CLAIM) {
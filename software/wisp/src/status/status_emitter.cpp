@@ -6,6 +6,8 @@
 #include <esp_system.h>
 #include <lampos/led_types.hpp>
 
+#include "fleet/fleet_health.hpp"
+#include "fleet/lamp_inventory.hpp"
 #include "paint/current_palette.hpp"
 #include "net/mesh_link.hpp"
 #include "net/wifi_link.hpp"
@@ -28,7 +30,7 @@ constexpr size_t kPaletteIdPrefixLen = lamp_protocol::WISP_HELLO_PALETTE_ID_PREF
 void StatusEmitter::begin(MeshLink* mesh, ZoneSelector* zone,
                           AuroraPaletteClient* aurora, WispConfig* config,
                           CurrentPalette* palette, SeqSource* seq,
-                          WifiLink* wifi) {
+                          WifiLink* wifi, LampInventory* inventory) {
   mesh_ = mesh;
   zone_ = zone;
   aurora_ = aurora;
@@ -36,6 +38,7 @@ void StatusEmitter::begin(MeshLink* mesh, ZoneSelector* zone,
   palette_ = palette;
   seq_ = seq;
   wifi_ = wifi;
+  inventory_ = inventory;
 }
 
 void StatusEmitter::startTimer() {
@@ -171,13 +174,15 @@ void StatusEmitter::emitStatus() {
     opSeq = config_->opSeq();
     brightness = config_->brightness();
   }
+  FleetHealthSummary fleet;
+  if (inventory_) inventory_->summarizeHealth(millis(), fleet);
   const WispStatusFields fields{
       currentZone, zoneSrc, obsBuf, obsCount,
       wifiConn, auroraConn, paletteIdPrefix, lastSeenMs,
       sourceName, offR, offG, offB, offW, hasOffColor, shuffleSeed,
       driftIntervalMs, driftFadePct, wispName, hasPassword,
       ledType, pixelCount, opSeq, brightness,
-      wifiChannelMismatch, wifiApChannel };
+      wifiChannelMismatch, wifiApChannel, &fleet };
 
   char jsonBuf[kStatusJsonBufLen];
   const size_t jsonLen = buildWispStatusJson(
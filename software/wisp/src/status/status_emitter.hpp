@@ -28,6 +28,7 @@ class AuroraPaletteClient;
 namespace wisp {
 
 class CurrentPalette;
+class LampInventory;
 class MeshLink;
 class WifiLink;
 class WispConfig;
@@ -38,7 +39,7 @@ class StatusEmitter {
  public:
   void begin(MeshLink* mesh, ZoneSelector* zone, AuroraPaletteClient* aurora,
              WispConfig* config, CurrentPalette* palette, SeqSource* seq,
-             WifiLink* wifi);
+             WifiLink* wifi, LampInventory* inventory);
 
   // One-shot wiring of the 30s heartbeat timer. Call once after begin().
   void startTimer();
@@ -68,6 +69,7 @@ class StatusEmitter {
   CurrentPalette* palette_ = nullptr;
   SeqSource* seq_ = nullptr;
   WifiLink* wifi_ = nullptr;
+  LampInventory* inventory_ = nullptr;
   StatusEmitterTimerHandle statusTimer_ = nullptr;
 
   // Set from the timer task / triggerOnChange, cleared in pump() on the loop task.
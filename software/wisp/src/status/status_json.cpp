@@ -1,5 +1,6 @@
 #include "status/status_json.hpp"
 #include <ArduinoJson.h>
+#include "fleet/fleet_health.hpp"
 #include <cstdio>
 #include <cstring>
 
@@ -100,6 +101,28 @@ size_t buildWispStatusJson(const WispStatusFields& f, char* out,
   if (f.brightness != kDefaultBrightness) {
     addIfFits(doc, cap, "brightness", f.brightness);
   }
+  // Diagnostics only: below every field the app renders from. All-or-nothing
+  // so the app never reads a partial roll-up; zero counts are omitted.
+  if (f.fleet && f.fleet->reporting > 0) {
+    const FleetHealthSummary& s = *f.fleet;
+    JsonObject o = doc["fleet"].to<JsonObject>();
+    o["n"]   = s.lamps;
+    o["rep"] = s.reporting;
+    if (s.overloaded)  o["hot"]     = s.overloaded;
+    if (s.dropping)    o["drop"]    = s.dropping;
+    if (s.fragmenting) o["frag"]    = s.fragmenting;
+    if (s.lowHeap)     o["lowHeap"] = s.lowHeap;
+    if (s.slotDrops)   o["slot"]    = s.slotDrops;
+    if (s.ota)         o["ota"]     = s.ota;
+    char worst[7];
+    std::snprintf(worst, sizeof(worst), "%02x%02x%02x",
+                  s.worstMac[3], s.worstMac[4], s.worstMac[5]);
+    o["p99Us"] = s.worstP99Us;
+    o["worst"] = worst;
+    if (s.minHeapLowKb) o["heapKb"] = s.minHeapLowKb;
+    o["relay"] = s.relayPerMin;
+    if (measureJson(doc) > cap) doc.remove("fleet");
+  }
   return serializeJson(doc, out, outCap);
 }
 
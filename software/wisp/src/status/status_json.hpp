@@ -5,6 +5,8 @@
 
 namespace wisp {
 
+struct FleetHealthSummary;
+
 struct WispStatusFields {
   int          currentZone;
   const char*  zoneSource;
@@ -28,6 +30,9 @@ struct WispStatusFields {
   uint8_t      brightness = 100;
   bool         wifiChannelMismatch = false;
   int          wifiApChannel = 0;
+  // Fleet health roll-up (fleet/fleet_health.hpp); nullptr or no reporting
+  // lamps omits the `fleet` object.
+  const FleetHealthSummary* fleet = nullptr;
 };
 
 // Serialize a wispStatus JSON into `out` (capacity `outCap`). A guaranteed
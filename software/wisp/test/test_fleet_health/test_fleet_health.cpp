@@ -0,0 +1,97 @@
+// Native tests for the fleet health roll-up.
+//
+// Pins the contract:
+//   - healthFlags thresholds, with 0 KiB heap figures read as "no sample".
+//   - accumulateFleetHealth counts every lamp but only fresh reports
+//     toward flags, worst p99, minimum heap and relay totals.
+//   - reports older than kHealthStaleMs stop counting.
+
+#include <unity.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include "fleet/fleet_health.hpp"
+
+namespace {
+
+wisp::InventoryEntry lamp(uint8_t last, uint32_t p99Us, uint16_t heapLowKb,
+                          uint32_t atMs) {
+  wisp::InventoryEntry e;
+  const uint8_t m[6] = {0xAA, 0xAA, 0xAA, 0xAA, 0xAA, last};
+  std::memcpy(e.mac, m, 6);
+  e.lastSeenMs = atMs;
+  e.hasHealth = true;
+  e.healthAtMs = atMs;
+  e.health.frameP99Us = p99Us;
+  e.health.heapLowKb = heapLowKb;
+  e.health.heapLargestKb = 60;
+  e.health.relayPerMin = 10;
+  return e;
+}
+
+}  // namespace
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_flags_thresholds(void) {
+  lamp_protocol::HelloHealth h;
+  TEST_ASSERT_EQUAL_UINT8(0, wisp::healthFlags(h, lamp_protocol::kOtaStateIdle));
+
+  h.frameP99Us = wisp::kOverloadedP99Us;
+  h.frameDrops = wisp::kDroppingFrames - 1;
+  h.heapLargestKb = wisp::kFragmentingLargestKb;
+  h.heapLowKb = wisp::kLowHeapKb;
+  TEST_ASSERT_EQUAL_UINT8(0, wisp::healthFlags(h, lamp_protocol::kOtaStateIdle));
+
+  h.frameP99Us++;
+  h.frameDrops++;
+  h.heapLargestKb--;
+  h.heapLowKb--;
+  h.slotDrops = 1;
+  TEST_ASSERT_EQUAL_UINT8(wisp::kHealthOverloaded | wisp::kHealthDropping |
+                              wisp::kHealthFragmenting | wisp::kHealthLowHeap |
+                              wisp::kHealthSlotDrops | wisp::kHealthOta,
+                          wisp::healthFlags(h, lamp_protocol::kOtaStateSending));
+}
+
+void test_accumulate_picks_worst_and_minimum(void) {
+  wisp::FleetHealthSummary s;
+  wisp::accumulateFleetHealth(s, lamp(1, 17000, 80, 1000), 2000);
+  wisp::accumulateFleetHealth(s, lamp(2, 52000, 20, 1000), 2000);
+  wisp::accumulateFleetHealth(s, lamp(3, 20000, 0, 1000), 2000);  // no heap sample
+
+  wisp::InventoryEntry silent;  // never sent a report
+  wisp::accumulateFleetHealth(s, silent, 2000);
+
+  TEST_ASSERT_EQUAL_UINT16(4, s.lamps);
+  TEST_ASSERT_EQUAL_UINT16(3, s.reporting);
+  TEST_ASSERT_EQUAL_UINT16(1, s.overloaded);
+  TEST_ASSERT_EQUAL_UINT16(1, s.lowHeap);
+  TEST_ASSERT_EQUAL_UINT32(52000, s.worstP99Us);
+  TEST_ASSERT_EQUAL_UINT8(2, s.worstMac[5]);
+  TEST_ASSERT_EQUAL_UINT16(20, s.minHeapLowKb);
+  TEST_ASSERT_EQUAL_UINT32(30, s.relayPerMin);
+}
+
+void test_stale_reports_stop_counting(void) {
+  const wisp::InventoryEntry e = lamp(1, 52000, 20, 1000);
+  TEST_ASSERT_TRUE(wisp::healthFresh(e, 1000 + wisp::kHealthStaleMs));
+  TEST_ASSERT_FALSE(wisp::healthFresh(e, 1001 + wisp::kHealthStaleMs));
+
+  wisp::FleetHealthSummary s;
+  wisp::accumulateFleetHealth(s, e, 1001 + wisp::kHealthStaleMs);
+  TEST_ASSERT_EQUAL_UINT16(1, s.lamps);
+  TEST_ASSERT_EQUAL_UINT16(0, s.reporting);
+  TEST_ASSERT_EQUAL_UINT32(0, s.worstP99Us);
+  TEST_ASSERT_EQUAL_UINT16(0, s.overloaded);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_flags_thresholds);
+  RUN_TEST(test_accumulate_picks_worst_and_minimum);
+  RUN_TEST(test_stale_reports_stop_counting);
+  return UNITY_END();
+}
@@ -6,6 +6,8 @@
 //   - recordHello keeps the stored RSSI when the update carries INT8_MIN.
 //   - prune drops aged entries from the observation feed.
 //   - roster full → oldest entry evicted for the newcomer.
+//   - a HELLO without a health report keeps the last one; a reused slot
+//     starts without one.
 
 #include <unity.h>
 
@@ -13,6 +15,7 @@
 #include <cstdint>
 #include <cstring>
 
+#include "fleet/fleet_health.hpp"
 #include "fleet/lamp_inventory.hpp"
 
 namespace {
@@ -115,6 +118,47 @@ void test_full_roster_evicts_oldest(void) {
   TEST_ASSERT_TRUE(sawNewest);
 }
 
+void test_health_survives_hellos_without_it(void) {
+  wisp::LampInventory inv;
+  uint8_t m[6];
+  mac(m, 1);
+  lamp_protocol::HelloHealth h;
+  h.frameP99Us = 41000;
+  h.heapLowKb = 40;
+  inv.recordHello(m, "lamp", kColor, kColor, 1, 1000, -60, &h,
+                  lamp_protocol::kOtaStateReceiving);
+  hear(inv, 1, -60, 31000);
+
+  const std::vector<wisp::InventoryEntry> snap = inv.snapshot();
+  TEST_ASSERT_EQUAL_size_t(1, snap.size());
+  TEST_ASSERT_TRUE(snap[0].hasHealth);
+  TEST_ASSERT_EQUAL_UINT32(1000, snap[0].healthAtMs);
+  TEST_ASSERT_EQUAL_UINT32(41000, snap[0].health.frameP99Us);
+  // OTA state is on every HELLO, so the plain one cleared it.
+  TEST_ASSERT_EQUAL_UINT8(lamp_protocol::kOtaStateIdle, snap[0].otaState);
+
+  wisp::FleetHealthSummary s;
+  inv.summarizeHealth(31000, s);
+  TEST_ASSERT_EQUAL_UINT16(1, s.reporting);
+  TEST_ASSERT_EQUAL_UINT16(1, s.overloaded);
+}
+
+void test_reused_slot_starts_without_health(void) {
+  wisp::LampInventory inv;
+  uint8_t m[6];
+  mac(m, 1);
+  lamp_protocol::HelloHealth h;
+  h.frameP99Us = 41000;
+  inv.recordHello(m, "lamp", kColor, kColor, 1, 1000, -60, &h);
+  inv.prune(/*nowMs=*/100000, /*maxAgeMs=*/30000);
+  TEST_ASSERT_EQUAL_size_t(0, inv.size());
+
+  hear(inv, 2, -60, 100000);
+  const std::vector<wisp::InventoryEntry> snap = inv.snapshot();
+  TEST_ASSERT_EQUAL_size_t(1, snap.size());
+  TEST_ASSERT_FALSE(snap[0].hasHealth);
+}
+
 int main(int, char**) {
   UNITY_BEGIN();
   RUN_TEST(test_copy_observations_fills_mac_and_rssi);
@@ -122,5 +166,7 @@ int main(int, char**) {
   RUN_TEST(test_record_hello_preserves_rssi_on_unmeasured_update);
   RUN_TEST(test_prune_drops_aged_entries);
   RUN_TEST(test_full_roster_evicts_oldest);
+  RUN_TEST(test_health_survives_hellos_without_it);
+  RUN_TEST(test_reused_slot_starts_without_health);
   return UNITY_END();
 }
@@ -1,6 +1,8 @@
 #include <unity.h>
 #include <ArduinoJson.h>
 #include <cstdint>
+#include <cstring>
+#include "fleet/fleet_health.hpp"
 #include "status/status_json.hpp"
 #include "wire/lamp_protocol.hpp"
 
@@ -326,6 +328,60 @@ void test_wifi_mismatch_untruncated_length() {
   TEST_ASSERT_TRUE(d["brightness"].isNull());
 }
 
+// The fleet roll-up rides when it fits, omits zero counts, and is the first
+// thing shed under pressure, whole.
+void test_fleet_emitted_and_shed_first() {
+  wisp::FleetHealthSummary fleet;
+  fleet.lamps = 12;
+  fleet.reporting = 11;
+  fleet.overloaded = 2;
+  fleet.worstP99Us = 52000;
+  const uint8_t worstMac[6] = {0xDE, 0xAD, 0xBE, 0xEF, 0x00, 0x2A};
+  std::memcpy(fleet.worstMac, worstMac, 6);
+  fleet.minHeapLowKb = 20;
+  fleet.relayPerMin = 300;
+  wisp::WispStatusFields f{ 3, "nvs", nullptr, 0,
+                            false, false, "", 1000u, "manual",
+                            0, 0, 0, 0, false, /*shuffleSeed=*/0,
+                            /*driftIntervalMs=*/120000, /*driftFadePct=*/50,
+                            /*name=*/"", /*hasPassword=*/false,
+                            /*ledType=*/"GRB", /*pixelCount=*/30,
+                            /*opSeq=*/0, /*brightness=*/40,
+                            /*wifiChannelMismatch=*/false, /*wifiApChannel=*/0,
+                            &fleet };
+  char out[512];
+  const size_t cap = lamp_protocol::CONTROL_MAX_PAYLOAD;
+  size_t n = wisp::buildWispStatusJson(f, out, sizeof(out), cap);
+  TEST_ASSERT_TRUE(n > 0 && n <= cap);
+  JsonDocument d;
+  TEST_ASSERT_FALSE(deserializeJson(d, out));
+  JsonObjectConst o = d["fleet"].as<JsonObjectConst>();
+  TEST_ASSERT_FALSE(o.isNull());
+  TEST_ASSERT_EQUAL_INT(12, o["n"].as<int>());
+  TEST_ASSERT_EQUAL_INT(11, o["rep"].as<int>());
+  TEST_ASSERT_EQUAL_INT(2, o["hot"].as<int>());
+  TEST_ASSERT_TRUE(o["drop"].isNull());
+  TEST_ASSERT_EQUAL_UINT32(52000, o["p99Us"].as<uint32_t>());
+  TEST_ASSERT_EQUAL_STRING("ef002a", o["worst"].as<const char*>());
+  TEST_ASSERT_EQUAL_INT(20, o["heapKb"].as<int>());
+
+  // Tight budget: fleet goes, brightness (the lowest app field) stays.
+  const size_t tight = n - 1;
+  n = wisp::buildWispStatusJson(f, out, sizeof(out), tight);
+  TEST_ASSERT_TRUE(n > 0 && n <= tight);
+  JsonDocument d2;
+  TEST_ASSERT_FALSE(deserializeJson(d2, out));
+  TEST_ASSERT_TRUE(d2["fleet"].isNull());
+  TEST_ASSERT_EQUAL_INT(40, d2["brightness"].as<int>());
+
+  // No lamp reporting yet: omitted.
+  fleet.reporting = 0;
+  n = wisp::buildWispStatusJson(f, out, sizeof(out), cap);
+  JsonDocument d3;
+  TEST_ASSERT_FALSE(deserializeJson(d3, out));
+  TEST_ASSERT_TRUE(d3["fleet"].isNull());
+}
+
 int main(int, char**) {
   UNITY_BEGIN();
   RUN_TEST(test_core_worst_case_pinned_under_cap);
@@ -341,5 +397,6 @@ int main(int, char**) {
   RUN_TEST(test_non_default_palette_and_drift_emitted);
   RUN_TEST(test_off_mode_emits_offcolor_not_drift);
   RUN_TEST(test_observed_zones_truncate_greedily);
+  RUN_TEST(test_fleet_emitted_and_shed_first);
   return UNITY_END();
 }
@@ -123,6 +123,73 @@ void test_magic_byte_wrong_fails() {
     TEST_ASSERT_FALSE(ok);
 }
 
+// KeyCache: the derive + setkey runs once per (password, char), not per write.
+static bool cachedDecrypt(lampos::crypto::KeyCache& cache, const char* name,
+                          const char* password, std::string& out) {
+    return lampos::crypto::decryptPayload(kWirePayload, kWirePayloadLen,
+                                          kWispOpSaltLE, name, password,
+                                          cache, out);
+}
+
+void test_key_cache_derives_once_for_a_burst() {
+    lampos::crypto::KeyCache cache;
+    for (int i = 0; i < 5; i++) {
+        std::string out;
+        TEST_ASSERT_TRUE(cachedDecrypt(cache, kCharShortName, "testpass", out));
+        TEST_ASSERT_EQUAL_STRING(kExpectedPlaintext, out.c_str());
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, cache.derivations());
+}
+
+void test_key_cache_failed_tag_keeps_key() {
+    lampos::crypto::KeyCache cache;
+    uint8_t bad[kWirePayloadLen];
+    std::memcpy(bad, kWirePayload, kWirePayloadLen);
+    bad[14] ^= 0xFF;
+    std::string out;
+    TEST_ASSERT_FALSE(lampos::crypto::decryptPayload(
+        bad, kWirePayloadLen, kWispOpSaltLE, kCharShortName, "testpass", cache, out));
+    TEST_ASSERT_EQUAL_INT(0, (int)out.size());
+    TEST_ASSERT_TRUE(cachedDecrypt(cache, kCharShortName, "testpass", out));
+    TEST_ASSERT_EQUAL_UINT32(1, cache.derivations());
+}
+
+void test_key_cache_password_change_rederives() {
+    lampos::crypto::KeyCache cache;
+    std::string out;
+    TEST_ASSERT_TRUE(cachedDecrypt(cache, kCharShortName, "testpass", out));
+    TEST_ASSERT_FALSE(cachedDecrypt(cache, kCharShortName, "newpass", out));
+    TEST_ASSERT_EQUAL_UINT32(2, cache.derivations());
+    // The old password's key is gone, not just shadowed.
+    TEST_ASSERT_TRUE(cachedDecrypt(cache, kCharShortName, "testpass", out));
+    TEST_ASSERT_EQUAL_UINT32(3, cache.derivations());
+}
+
+void test_key_cache_clear_rederives() {
+    lampos::crypto::KeyCache cache;
+    std::string out;
+    TEST_ASSERT_TRUE(cachedDecrypt(cache, kCharShortName, "testpass", out));
+    cache.clear();
+    TEST_ASSERT_TRUE(cachedDecrypt(cache, kCharShortName, "testpass", out));
+    TEST_ASSERT_EQUAL_UINT32(2, cache.derivations());
+}
+
+void test_key_cache_evicts_least_recent_char() {
+    lampos::crypto::KeyCache cache;
+    std::string out;
+    TEST_ASSERT_TRUE(cachedDecrypt(cache, kCharShortName, "testpass", out));
+    // Other chars' keys can't open this payload, but each takes a slot.
+    const char* others[] = {"a", "b", "c"};
+    for (const char* n : others) cachedDecrypt(cache, n, "testpass", out);
+    TEST_ASSERT_TRUE(cachedDecrypt(cache, kCharShortName, "testpass", out));
+    TEST_ASSERT_EQUAL_UINT32(4, cache.derivations());  // still cached: 4 slots
+    cachedDecrypt(cache, "d", "testpass", out);         // evicts "a"
+    TEST_ASSERT_TRUE(cachedDecrypt(cache, kCharShortName, "testpass", out));
+    TEST_ASSERT_EQUAL_UINT32(5, cache.derivations());
+    cachedDecrypt(cache, "a", "testpass", out);
+    TEST_ASSERT_EQUAL_UINT32(6, cache.derivations());
+}
+
 int main(int, char**) {
     UNITY_BEGIN();
     RUN_TEST(test_known_vector_decrypts_correctly);
@@ -132,5 +199,10 @@ int main(int, char**) {
     RUN_TEST(test_duplicate_nonce_rejected);
     RUN_TEST(test_payload_too_short_fails);
     RUN_TEST(test_magic_byte_wrong_fails);
+    RUN_TEST(test_key_cache_derives_once_for_a_burst);
+    RUN_TEST(test_key_cache_failed_tag_keeps_key);
+    RUN_TEST(test_key_cache_password_change_rederives);
+    RUN_TEST(test_key_cache_clear_rederives);
+    RUN_TEST(test_key_cache_evicts_least_recent_char);
     return UNITY_END();
 }